@@ -0,0 +1,334 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+/*
+  ==============================================================================
+
+   Draws a set of typical scenes into offscreen images with the software
+   renderer, and prints how long each one takes. No window is opened, so this
+   can be run on a headless machine.
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+//==============================================================================
+struct Scene
+{
+    const char* name;
+    std::function<void (Graphics&, int width, int height, Random&)> draw;
+};
+
+static Image createSourceImage (Image::PixelFormat format, int size)
+{
+    Image image (format, size, size, true);
+    Graphics g (image);
+
+    g.setGradientFill (ColourGradient (Colours::orange.withAlpha (0.8f), 0.0f, 0.0f,
+                                       Colours::darkblue, (float) size, (float) size, false));
+    g.fillEllipse (image.getBounds().toFloat());
+    g.setColour (Colours::white);
+    g.drawLine (0.0f, 0.0f, (float) size, (float) size, 4.0f);
+
+    return image;
+}
+
+static Colour randomColour (Random& r, bool opaque)
+{
+    auto colour = Colour ((uint32) r.nextInt());
+    return opaque ? colour.withAlpha (1.0f) : colour.withAlpha (0.1f + 0.8f * r.nextFloat());
+}
+
+static Rectangle<float> randomRectangle (Random& r, int width, int height)
+{
+    return { r.nextFloat() * (float) width * 0.8f, r.nextFloat() * (float) height * 0.8f,
+             (float) width * (0.1f + 0.2f * r.nextFloat()), (float) height * (0.1f + 0.2f * r.nextFloat()) };
+}
+
+static Array<Scene> createScenes()
+{
+    auto argbSource = createSourceImage (Image::ARGB, 256);
+    auto rgbSource  = createSourceImage (Image::RGB, 256);
+
+    Array<Scene> scenes;
+
+    scenes.add ({ "Opaque rectangles", [] (Graphics& g, int w, int h, Random& r)
+    {
+        for (int i = 0; i < 200; ++i)
+        {
+            g.setColour (randomColour (r, true));
+            g.fillRect (randomRectangle (r, w, h).toNearestInt());
+        }
+    }});
+
+    scenes.add ({ "Translucent rectangles", [] (Graphics& g, int w, int h, Random& r)
+    {
+        for (int i = 0; i < 200; ++i)
+        {
+            g.setColour (randomColour (r, false));
+            g.fillRect (randomRectangle (r, w, h).toNearestInt());
+        }
+    }});
+
+    scenes.add ({ "Anti-aliased ellipses", [] (Graphics& g, int w, int h, Random& r)
+    {
+        for (int i = 0; i < 200; ++i)
+        {
+            g.setColour (randomColour (r, false));
+            g.fillEllipse (randomRectangle (r, w, h));
+        }
+    }});
+
+    scenes.add ({ "Linear gradients", [] (Graphics& g, int w, int h, Random& r)
+    {
+        for (int i = 0; i < 50; ++i)
+        {
+            auto area = randomRectangle (r, w, h);
+            g.setGradientFill (ColourGradient (randomColour (r, false), area.getTopLeft(),
+                                               randomColour (r, false), area.getBottomRight(), false));
+            g.fillRect (area);
+        }
+    }});
+
+    scenes.add ({ "Radial gradients", [] (Graphics& g, int w, int h, Random& r)
+    {
+        for (int i = 0; i < 50; ++i)
+        {
+            auto area = randomRectangle (r, w, h);
+            g.setGradientFill (ColourGradient (randomColour (r, false), area.getCentre(),
+                                               randomColour (r, false), area.getTopLeft(), true));
+            g.fillRect (area);
+        }
+    }});
+
+    scenes.add ({ "Rotated radial gradients", [] (Graphics& g, int w, int h, Random& r)
+    {
+        for (int i = 0; i < 50; ++i)
+        {
+            auto area = randomRectangle (r, w, h);
+            ColourGradient gradient (randomColour (r, false), area.getCentre(),
+                                     randomColour (r, false), area.getTopLeft(), true);
+
+            Graphics::ScopedSaveState state (g);
+            g.addTransform (AffineTransform::rotation (r.nextFloat(), area.getCentreX(), area.getCentreY()));
+            g.setGradientFill (gradient);
+            g.fillRect (area);
+        }
+    }});
+
+    scenes.add ({ "Image blits", [argbSource, rgbSource] (Graphics& g, int w, int h, Random& r)
+    {
+        for (int i = 0; i < 100; ++i)
+        {
+            g.setOpacity (i % 2 == 0 ? 1.0f : 0.5f);
+            g.drawImageAt (i % 3 == 0 ? rgbSource : argbSource, r.nextInt (w) - 128, r.nextInt (h) - 128);
+        }
+    }});
+
+    scenes.add ({ "Tiled image fills", [argbSource] (Graphics& g, int w, int h, Random& r)
+    {
+        for (int i = 0; i < 50; ++i)
+        {
+            g.setTiledImageFill (argbSource, r.nextInt (256), r.nextInt (256), 0.5f + 0.5f * r.nextFloat());
+            g.fillRect (randomRectangle (r, w, h));
+        }
+    }});
+
+    scenes.add ({ "Transformed images", [argbSource] (Graphics& g, int w, int h, Random& r)
+    {
+        g.setImageResamplingQuality (Graphics::mediumResamplingQuality);
+
+        for (int i = 0; i < 50; ++i)
+            g.drawImageTransformed (argbSource, AffineTransform::rotation (r.nextFloat() * MathConstants<float>::twoPi)
+                                                                 .scaled (0.5f + r.nextFloat())
+                                                                 .translated (r.nextFloat() * (float) w, r.nextFloat() * (float) h));
+    }});
+
+    scenes.add ({ "Text", [] (Graphics& g, int w, int h, Random& r)
+    {
+        for (int i = 0; i < 200; ++i)
+        {
+            g.setColour (randomColour (r, true));
+            g.setFont (10.0f + r.nextFloat() * 20.0f);
+            g.drawSingleLineText ("The quick brown fox jumps over the lazy dog", r.nextInt (w), r.nextInt (h));
+        }
+    }});
+
+    scenes.add ({ "Glyph arrangements", [] (Graphics& g, int w, int h, Random& r)
+    {
+        for (int i = 0; i < 300; ++i)
+        {
+            Rectangle<float> area ((float) r.nextInt (w), (float) r.nextInt (h), 100.0f + (float) r.nextInt (200), 40.0f);
+
+            GlyphArrangement glyphs;
+            glyphs.addFittedText (Font (8.0f + (float) r.nextInt (24)), "Label " + String (i) + ": some typical text",
+                                  area.getX(), area.getY(), area.getWidth(), area.getHeight(), Justification::centredLeft, 2);
+
+            g.setColour (randomColour (r, true));
+            glyphs.draw (g);
+        }
+    }});
+
+    scenes.add ({ "Text layouts", [] (Graphics& g, int w, int h, Random& r)
+    {
+        for (int i = 0; i < 50; ++i)
+        {
+            AttributedString text;
+            text.append ("A paragraph of wrapped text with ", Font (10.0f + (float) r.nextInt (10)), randomColour (r, true));
+            text.append ("some bold words ", Font (14.0f, Font::bold), randomColour (r, true));
+            text.append ("and some that are in a different size and colour, to make several runs.",
+                         Font (10.0f + (float) r.nextInt (20)), randomColour (r, true));
+
+            TextLayout layout;
+            layout.createLayout (text, 150.0f + (float) r.nextInt (200));
+            layout.draw (g, { (float) r.nextInt (w), (float) r.nextInt (h), layout.getWidth(), layout.getHeight() });
+        }
+    }});
+
+    scenes.add ({ "Table cells", [] (Graphics& g, int w, int h, Random&)
+    {
+        Font cellFont (13.0f);
+        g.setFont (cellFont);
+        g.setColour (Colours::black);
+
+        for (int row = 0; row < h / 20; ++row)
+            for (int column = 0; column < w / 160; ++column)
+                g.drawText ("Row " + String (row) + ", column " + String (column),
+                            column * 160, row * 20, 156, 20, Justification::centredLeft, true);
+    }});
+
+    scenes.add ({ "Cached vector icons", [] (Graphics& g, int w, int h, Random& r)
+    {
+        Path icon;
+        icon.addStar ({ 20.0f, 20.0f }, 7, 8.0f, 18.0f);
+        icon.addEllipse (14.0f, 14.0f, 12.0f, 12.0f);
+        icon.setUsingNonZeroWinding (false);
+
+        g.setPathCachingEnabled (true);
+
+        for (int y = 0; y < h; y += 48)
+        {
+            for (int x = 0; x < w; x += 48)
+            {
+                g.setColour (randomColour (r, true));
+                g.fillPath (icon, AffineTransform::translation ((float) x, (float) y));
+                g.strokePath (icon, PathStrokeType (1.5f), AffineTransform::translation ((float) x, (float) y));
+            }
+        }
+    }});
+
+    return scenes;
+}
+
+//==============================================================================
+static double timeScene (const Scene& scene, Image::PixelFormat format, int width, int height,
+                         int numIterations, int numThreads)
+{
+    Image target (format, width, height, true);
+    double totalSeconds = 0;
+
+    for (int i = 0; i < numIterations; ++i)
+    {
+        Random random (i);
+        auto startTicks = Time::getHighResolutionTicks();
+
+        {
+            LowLevelGraphicsSoftwareRenderer context (target);
+            context.setNumRenderingThreads (numThreads);
+
+            Graphics g (context);
+            scene.draw (g, width, height, random);
+        }
+
+        totalSeconds += Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks);
+    }
+
+    return totalSeconds * 1000.0 / numIterations;
+}
+
+//==============================================================================
+int main (int argc, char** argv)
+{
+    ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--help|-h"))
+    {
+        std::cout << argv[0] << " [--help|-h] [--size=WIDTHxHEIGHT] [--iterations=NUM] [--threads=NUM] [--scene=NAME]" << std::endl;
+        return 0;
+    }
+
+    ScopedJuceInitialiser_GUI juceInitialiser;
+
+    int width = 1920, height = 1080, numIterations = 10, numThreads = 1;
+
+    if (args.containsOption ("--size"))
+    {
+        auto size = args.getValueForOption ("--size");
+        width  = jmax (1, size.upToFirstOccurrenceOf ("x", false, true).getIntValue());
+        height = jmax (1, size.fromFirstOccurrenceOf ("x", false, true).getIntValue());
+    }
+
+    if (args.containsOption ("--iterations"))
+        numIterations = jmax (1, args.getValueForOption ("--iterations").getIntValue());
+
+    if (args.containsOption ("--threads"))
+        numThreads = jmax (1, args.getValueForOption ("--threads").getIntValue());
+
+    auto sceneToRun = args.getValueForOption ("--scene");
+
+    std::cout << "Rendering " << width << "x" << height << ", " << numIterations << " iterations, "
+              << numThreads << " thread(s)" << std::endl << std::endl
+              << String ("Scene").paddedRight (' ', 28) << String ("ARGB (ms)").paddedLeft (' ', 12)
+              << String ("RGB (ms)").paddedLeft (' ', 12) << std::endl;
+
+    for (auto& scene : createScenes())
+    {
+        if (sceneToRun.isNotEmpty() && ! String (scene.name).containsIgnoreCase (sceneToRun))
+            continue;
+
+        auto argbTime = timeScene (scene, Image::ARGB, width, height, numIterations, numThreads);
+        auto rgbTime  = timeScene (scene, Image::RGB,  width, height, numIterations, numThreads);
+
+        std::cout << String (scene.name).paddedRight (' ', 28)
+                  << String (argbTime, 2).paddedLeft (' ', 12)
+                  << String (rgbTime, 2).paddedLeft (' ', 12) << std::endl;
+    }
+
+    auto glyphCacheStats = RenderingHelpers::SoftwareRendererSavedState::GlyphCacheType::getInstance().getNumHitsAndMisses();
+
+    std::cout << std::endl << "Glyph cache: " << glyphCacheStats.x << " hits, " << glyphCacheStats.y << " misses" << std::endl;
+
+    auto layoutCacheStats = TextLayoutCache::getNumHitsAndMisses();
+
+    std::cout << "Text layout cache: " << layoutCacheStats.x << " hits, " << layoutCacheStats.y << " misses" << std::endl;
+
+    auto pathCacheStats = PathCache::getNumHitsAndMisses();
+
+    std::cout << "Path cache: " << pathCacheStats.x << " hits, " << pathCacheStats.y << " misses" << std::endl;
+
+    return 0;
+}
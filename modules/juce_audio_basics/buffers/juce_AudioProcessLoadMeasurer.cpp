@@ -27,9 +27,43 @@
 namespace juce
 {
 
-AudioProcessLoadMeasurer::AudioProcessLoadMeasurer() {}
+AudioProcessLoadMeasurer::AudioProcessLoadMeasurer()
+{
+    resetTimingStatistics();
+}
+
 AudioProcessLoadMeasurer::~AudioProcessLoadMeasurer() {}
 
+AudioProcessLoadMeasurer::AudioProcessLoadMeasurer (const AudioProcessLoadMeasurer& other)
+{
+    operator= (other);
+}
+
+AudioProcessLoadMeasurer& AudioProcessLoadMeasurer::operator= (const AudioProcessLoadMeasurer& other)
+{
+    cpuUsageMs = other.cpuUsageMs;
+    timeToCpuScale = other.timeToCpuScale;
+    msPerBlock = other.msPerBlock;
+    xruns = other.xruns;
+    lastCallbackStartMs = other.lastCallbackStartMs;
+
+    numCallbacks = other.numCallbacks.load();
+    numIntervals = other.numIntervals.load();
+    totalLoad = other.totalLoad.load();
+    peakLoad = other.peakLoad.load();
+    totalJitterMs = other.totalJitterMs.load();
+    maxJitterMs = other.maxJitterMs.load();
+    numOverruns = other.numOverruns.load();
+
+    for (int i = 0; i < numHistogramBands; ++i)
+    {
+        loadHistogram[i] = other.loadHistogram[i].load();
+        jitterHistogram[i] = other.jitterHistogram[i].load();
+    }
+
+    return *this;
+}
+
 void AudioProcessLoadMeasurer::reset()
 {
     reset (0, 0);
@@ -50,6 +84,58 @@ void AudioProcessLoadMeasurer::reset (double sampleRate, int blockSize)
         msPerBlock = 0;
         timeToCpuScale = 0;
     }
+
+    lastCallbackStartMs = 0;
+    resetTimingStatistics();
+}
+
+void AudioProcessLoadMeasurer::resetTimingStatistics()
+{
+    numCallbacks = 0;
+    numIntervals = 0;
+    totalLoad = 0;
+    peakLoad = 0;
+    totalJitterMs = 0;
+    maxJitterMs = 0;
+    numOverruns = 0;
+
+    for (int i = 0; i < numHistogramBands; ++i)
+    {
+        loadHistogram[i] = 0;
+        jitterHistogram[i] = 0;
+    }
+}
+
+namespace LoadMeasurerHelpers
+{
+    static int getHistogramBand (double proportionOfBlock) noexcept
+    {
+        return jlimit (0, AudioProcessLoadMeasurer::numHistogramBands - 1,
+                       (int) (proportionOfBlock * (AudioProcessLoadMeasurer::numHistogramBands - 1)));
+    }
+
+    // The audio thread updates the statistics while resetTimingStatistics() may be clearing
+    // them from another thread, so each update has to be a single atomic read-modify-write.
+    // The counters can just be incremented, but std::atomic<double> has no fetch_add, so
+    // the totals and maximums use a compare-exchange loop.
+    template <typename Type>
+    static void addTo (std::atomic<Type>& value, Type amount) noexcept
+    {
+        auto oldValue = value.load (std::memory_order_relaxed);
+
+        while (! value.compare_exchange_weak (oldValue, oldValue + amount, std::memory_order_relaxed))
+        {}
+    }
+
+    template <typename Type>
+    static void updateMaximum (std::atomic<Type>& value, Type newValue) noexcept
+    {
+        auto oldValue = value.load (std::memory_order_relaxed);
+
+        while (newValue > oldValue
+                && ! value.compare_exchange_weak (oldValue, newValue, std::memory_order_relaxed))
+        {}
+    }
 }
 
 void AudioProcessLoadMeasurer::registerBlockRenderTime (double milliseconds)
@@ -59,6 +145,58 @@ void AudioProcessLoadMeasurer::registerBlockRenderTime (double milliseconds)
 
     if (milliseconds > msPerBlock)
         ++xruns;
+
+    if (msPerBlock > 0)
+    {
+        using namespace LoadMeasurerHelpers;
+        auto load = milliseconds * timeToCpuScale;
+
+        ++numCallbacks;
+        addTo (totalLoad, load);
+        updateMaximum (peakLoad, load);
+        ++loadHistogram[getHistogramBand (load)];
+
+        if (load > 1.0)
+            ++numOverruns;
+    }
+}
+
+void AudioProcessLoadMeasurer::registerCallbackStart (double startTimeMs)
+{
+    if (lastCallbackStartMs > 0 && msPerBlock > 0)
+    {
+        using namespace LoadMeasurerHelpers;
+        auto jitter = std::abs ((startTimeMs - lastCallbackStartMs) - msPerBlock);
+
+        ++numIntervals;
+        addTo (totalJitterMs, jitter);
+        updateMaximum (maxJitterMs, jitter);
+        ++jitterHistogram[getHistogramBand (jitter * timeToCpuScale)];
+    }
+
+    lastCallbackStartMs = startTimeMs;
+}
+
+AudioProcessLoadMeasurer::TimingStatistics AudioProcessLoadMeasurer::getTimingStatistics() const
+{
+    TimingStatistics stats;
+
+    stats.numCallbacks = numCallbacks;
+    stats.averageLoad = stats.numCallbacks > 0 ? totalLoad / (double) stats.numCallbacks : 0.0;
+    stats.peakLoad = peakLoad;
+
+    auto intervals = numIntervals.load();
+    stats.averageJitterMs = intervals > 0 ? totalJitterMs / (double) intervals : 0.0;
+    stats.maxJitterMs = maxJitterMs;
+    stats.numXRuns = numOverruns;
+
+    for (int i = 0; i < numHistogramBands; ++i)
+    {
+        stats.loadHistogram.add (loadHistogram[i]);
+        stats.jitterHistogram.add (jitterHistogram[i]);
+    }
+
+    return stats;
 }
 
 double AudioProcessLoadMeasurer::getLoadAsProportion() const   { return jlimit (0.0, 1.0, timeToCpuScale * cpuUsageMs); }
@@ -69,6 +207,7 @@ int AudioProcessLoadMeasurer::getXRunCount() const             { return xruns; }
 AudioProcessLoadMeasurer::ScopedTimer::ScopedTimer (AudioProcessLoadMeasurer& p)
    : owner (p), startTime (Time::getMillisecondCounterHiRes())
 {
+    owner.registerCallbackStart (startTime);
 }
 
 AudioProcessLoadMeasurer::ScopedTimer::~ScopedTimer()
@@ -76,4 +215,155 @@ AudioProcessLoadMeasurer::ScopedTimer::~ScopedTimer()
     owner.registerBlockRenderTime (Time::getMillisecondCounterHiRes() - startTime);
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AudioProcessLoadMeasurerTests  : public UnitTest
+{
+public:
+    AudioProcessLoadMeasurerTests()  : UnitTest ("AudioProcessLoadMeasurer", "Audio") {}
+
+    void runTest() override
+    {
+        beginTest ("Timing statistics");
+        {
+            AudioProcessLoadMeasurer measurer;
+            measurer.reset (48000.0, 480);  // 10ms blocks
+
+            // (each of these is in the middle of a 5% band, to avoid any rounding problems)
+            for (auto ms : { 0.6, 2.6, 2.7, 7.3, 15.0 })
+                measurer.registerBlockRenderTime (ms);
+
+            auto stats = measurer.getTimingStatistics();
+
+            expect (stats.numCallbacks == 5);
+            expectWithinAbsoluteError (stats.averageLoad, (0.06 + 0.26 + 0.27 + 0.73 + 1.5) / 5.0, 1.0e-9);
+            expectWithinAbsoluteError (stats.peakLoad, 1.5, 1.0e-9);
+            expectEquals (stats.numXRuns, 1);
+            expectEquals (measurer.getXRunCount(), 1);
+
+            expectEquals (stats.loadHistogram.size(), AudioProcessLoadMeasurer::numHistogramBands);
+            expectEquals (stats.jitterHistogram.size(), AudioProcessLoadMeasurer::numHistogramBands);
+
+            for (int i = 0; i < AudioProcessLoadMeasurer::numHistogramBands; ++i)
+            {
+                auto expected = (i == 1 || i == 14 || i == 20) ? 1 : (i == 5 ? 2 : 0);
+                expectEquals (stats.loadHistogram[i], expected, "band " + String (i));
+                expectEquals (stats.jitterHistogram[i], 0, "band " + String (i));
+            }
+
+            // the jitter can only be measured when a ScopedTimer says when the callbacks start
+            expectEquals (stats.averageJitterMs, 0.0);
+            expectEquals (stats.maxJitterMs, 0.0);
+        }
+
+        beginTest ("Jitter");
+        {
+            AudioProcessLoadMeasurer measurer;
+            measurer.reset (48000.0, 480);
+
+            for (int i = 0; i < 3; ++i)
+            {
+                AudioProcessLoadMeasurer::ScopedTimer timer (measurer);
+                Thread::sleep (2);
+            }
+
+            auto stats = measurer.getTimingStatistics();
+            expect (stats.numCallbacks == 3);
+            expect (stats.averageJitterMs > 0.0 && stats.averageJitterMs <= stats.maxJitterMs);
+            expectEquals (sum (stats.jitterHistogram), 2);
+        }
+
+        beginTest ("Resetting and copying");
+        {
+            AudioProcessLoadMeasurer measurer;
+            measurer.reset (48000.0, 480);
+
+            measurer.registerBlockRenderTime (2.6);
+            measurer.registerBlockRenderTime (12.5);
+
+            AudioProcessLoadMeasurer copy (measurer);
+            auto copiedStats = copy.getTimingStatistics();
+            expect (copiedStats.numCallbacks == 2);
+            expectEquals (copiedStats.numXRuns, 1);
+            expectEquals (copiedStats.loadHistogram[5], 1);
+            expectEquals (copy.getLoadAsProportion(), measurer.getLoadAsProportion());
+
+            measurer.resetTimingStatistics();
+            auto stats = measurer.getTimingStatistics();
+            expect (stats.numCallbacks == 0);
+            expectEquals (stats.averageLoad, 0.0);
+            expectEquals (stats.peakLoad, 0.0);
+            expectEquals (stats.numXRuns, 0);
+            expectEquals (sum (stats.loadHistogram), 0);
+
+            // the load and xrun count are kept, and the copy isn't affected
+            expectEquals (measurer.getXRunCount(), 1);
+            expect (measurer.getLoadAsProportion() > 0.0);
+            expect (copy.getTimingStatistics().numCallbacks == 2);
+
+            measurer.registerBlockRenderTime (7.3);
+            copy = measurer;
+            expect (copy.getTimingStatistics().numCallbacks == 1);
+            expectEquals (copy.getTimingStatistics().loadHistogram[14], 1);
+        }
+
+        beginTest ("Resetting while measuring");
+        {
+            AudioProcessLoadMeasurer measurer;
+            measurer.reset (48000.0, 480);
+
+            {
+                MeasuringThread audioThread (measurer);
+                audioThread.startThread();
+
+                for (int i = 0; i < 100; ++i)
+                {
+                    measurer.resetTimingStatistics();
+                    auto peakLoad = measurer.getTimingStatistics().peakLoad;
+                    expect (peakLoad == 0.0 || std::abs (peakLoad - 0.26) < 1.0e-9);
+                }
+            }
+
+            measurer.resetTimingStatistics();
+            measurer.registerBlockRenderTime (0.6);
+            measurer.registerBlockRenderTime (7.3);
+
+            auto stats = measurer.getTimingStatistics();
+            expect (stats.numCallbacks == 2);
+            expectWithinAbsoluteError (stats.averageLoad, 0.395, 1.0e-9);
+            expectEquals (sum (stats.loadHistogram), 2);
+        }
+    }
+
+private:
+    struct MeasuringThread  : public Thread
+    {
+        MeasuringThread (AudioProcessLoadMeasurer& m)  : Thread ("LoadMeasurer test"), measurer (m) {}
+        ~MeasuringThread() override   { stopThread (1000); }
+
+        void run() override
+        {
+            while (! threadShouldExit())
+                measurer.registerBlockRenderTime (2.6);
+        }
+
+        AudioProcessLoadMeasurer& measurer;
+    };
+
+    static int sum (const Array<int>& values)
+    {
+        int total = 0;
+
+        for (auto v : values)
+            total += v;
+
+        return total;
+    }
+};
+
+static AudioProcessLoadMeasurerTests audioProcessLoadMeasurerTests;
+
+#endif
+
 } // namespace juce
@@ -41,6 +41,17 @@ public:
     /** Destructor. */
     ~AudioProcessLoadMeasurer();
 
+    /** Creates a copy of another measurer's state.
+        The copy isn't taken atomically, so if the other measurer is being used by an
+        audio callback, the timing statistics may include part of a callback.
+    */
+    AudioProcessLoadMeasurer (const AudioProcessLoadMeasurer&);
+
+    /** Copies the state of another measurer.
+        @see AudioProcessLoadMeasurer (const AudioProcessLoadMeasurer&)
+    */
+    AudioProcessLoadMeasurer& operator= (const AudioProcessLoadMeasurer&);
+
     //==============================================================================
     /** Resets the state. */
     void reset();
@@ -57,6 +68,52 @@ public:
     /** Returns the number of over- (or under-) runs recorded since the state was reset. */
     int getXRunCount() const;
 
+    //==============================================================================
+    /** The number of bands in each of the histograms in a TimingStatistics object. */
+    static constexpr int numHistogramBands = 21;
+
+    /** A summary of the timing of the callbacks that have been measured. */
+    struct JUCE_API  TimingStatistics
+    {
+        /** The number of callbacks measured. */
+        int64 numCallbacks = 0;
+
+        /** The average and the highest proportion of a block's duration spent inside a callback. */
+        double averageLoad = 0, peakLoad = 0;
+
+        /** The average and the largest difference between the time from one callback to
+            the next and the duration of a block, in milliseconds.
+        */
+        double averageJitterMs = 0, maxJitterMs = 0;
+
+        /** The number of callbacks that took longer than the duration of a block. */
+        int numXRuns = 0;
+
+        /** The number of callbacks in each band of load, where each band covers 5% of
+            the block duration, and the last band counts the callbacks that overran.
+        */
+        Array<int> loadHistogram;
+
+        /** The number of callbacks in each band of jitter, measured as a proportion of the
+            block duration in the same bands as the loadHistogram.
+        */
+        Array<int> jitterHistogram;
+    };
+
+    /** Returns a summary of the callbacks measured since the last reset.
+
+        The jitter is only measured when a ScopedTimer is used, as it needs to know
+        when each callback started. This can be called from any thread.
+    */
+    TimingStatistics getTimingStatistics() const;
+
+    /** Clears the timing statistics, without changing the load or the xrun count.
+
+        This can be called from any thread. If a callback is being measured at the same
+        time, some of its figures may be counted in the new statistics.
+    */
+    void resetTimingStatistics();
+
     //==============================================================================
     /** This class measures the time between its construction and destruction and
         adds it to an AudioProcessLoadMeasurer.
@@ -90,6 +147,16 @@ public:
 private:
     double cpuUsageMs = 0, timeToCpuScale = 0, msPerBlock = 0;
     int xruns = 0;
+
+    std::atomic<int64> numCallbacks { 0 }, numIntervals { 0 };
+    std::atomic<double> totalLoad { 0 }, peakLoad { 0 }, totalJitterMs { 0 }, maxJitterMs { 0 };
+    std::atomic<int> numOverruns { 0 };
+    std::atomic<int> loadHistogram[numHistogramBands], jitterHistogram[numHistogramBands];
+    double lastCallbackStartMs = 0;
+
+    void registerCallbackStart (double startTimeMs);
+
+    JUCE_LEAK_DETECTOR (AudioProcessLoadMeasurer)
 };
 
 
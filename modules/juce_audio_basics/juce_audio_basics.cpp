@@ -60,7 +60,9 @@
 #include "utilities/juce_IIRFilter.cpp"
 #include "utilities/juce_LagrangeInterpolator.cpp"
 #include "utilities/juce_CatmullRomInterpolator.cpp"
+#include "utilities/juce_SincResampler.cpp"
 #include "utilities/juce_SmoothedValue.cpp"
+#include "utilities/juce_LoudnessMeter.cpp"
 #include "midi/juce_MidiBuffer.cpp"
 #include "midi/juce_MidiFile.cpp"
 #include "midi/juce_MidiKeyboardState.cpp"
@@ -77,6 +79,7 @@
 #include "mpe/juce_MPESynthesiser.cpp"
 #include "mpe/juce_MPEUtils.cpp"
 #include "sources/juce_BufferingAudioSource.cpp"
+#include "sources/juce_StreamingAudioSource.cpp"
 #include "sources/juce_ChannelRemappingAudioSource.cpp"
 #include "sources/juce_IIRFilterAudioSource.cpp"
 #include "sources/juce_MemoryAudioSource.cpp"
@@ -89,9 +89,11 @@
 #include "utilities/juce_IIRFilter.h"
 #include "utilities/juce_LagrangeInterpolator.h"
 #include "utilities/juce_CatmullRomInterpolator.h"
+#include "utilities/juce_SincResampler.h"
 #include "utilities/juce_SmoothedValue.h"
 #include "utilities/juce_Reverb.h"
 #include "utilities/juce_ADSR.h"
+#include "utilities/juce_LoudnessMeter.h"
 #include "midi/juce_MidiMessage.h"
 #include "midi/juce_MidiBuffer.h"
 #include "midi/juce_MidiMessageSequence.h"
@@ -110,6 +112,7 @@
 #include "sources/juce_AudioSource.h"
 #include "sources/juce_PositionableAudioSource.h"
 #include "sources/juce_BufferingAudioSource.h"
+#include "sources/juce_StreamingAudioSource.h"
 #include "sources/juce_ChannelRemappingAudioSource.h"
 #include "sources/juce_IIRFilterAudioSource.h"
 #include "sources/juce_MemoryAudioSource.h"
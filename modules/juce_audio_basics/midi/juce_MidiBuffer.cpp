@@ -85,15 +85,49 @@ namespace MidiBufferHelpers
     }
 }
 
+//==============================================================================
+MidiBufferIterator& MidiBufferIterator::operator++() noexcept
+{
+    data += MidiBufferHelpers::getEventTotalSize (data);
+    return *this;
+}
+
+MidiBufferIterator MidiBufferIterator::operator++ (int) noexcept
+{
+    auto copy = *this;
+    ++(*this);
+    return copy;
+}
+
+MidiMessageMetadata MidiBufferIterator::operator*() const noexcept
+{
+    return { data + sizeof (int32) + sizeof (uint16),
+             MidiBufferHelpers::getEventDataSize (data),
+             MidiBufferHelpers::getEventTime (data) };
+}
+
 //==============================================================================
 MidiBuffer::MidiBuffer() noexcept {}
 MidiBuffer::~MidiBuffer() {}
 
-MidiBuffer::MidiBuffer (const MidiBuffer& other) noexcept  : data (other.data) {}
+MidiBuffer::MidiBuffer (const MidiBuffer& other) noexcept
+    : data (other.data),
+      overflowPolicy (other.overflowPolicy),
+      reservedBytes (other.reservedBytes),
+      lastEventOffset (other.lastEventOffset)
+{
+    if (reservedBytes > data.size())
+        data.ensureStorageAllocated (reservedBytes);
+}
 
 MidiBuffer& MidiBuffer::operator= (const MidiBuffer& other) noexcept
 {
-    data = other.data;
+    if (this != &other)
+    {
+        clear();
+        addEvents (other, 0, -1, 0);
+    }
+
     return *this;
 }
 
@@ -102,9 +136,27 @@ MidiBuffer::MidiBuffer (const MidiMessage& message) noexcept
     addEvent (message, 0);
 }
 
-void MidiBuffer::swapWith (MidiBuffer& other) noexcept      { data.swapWith (other.data); }
-void MidiBuffer::clear() noexcept                           { data.clearQuick(); }
-void MidiBuffer::ensureSize (size_t minimumNumBytes)        { data.ensureStorageAllocated ((int) minimumNumBytes); }
+void MidiBuffer::swapWith (MidiBuffer& other) noexcept
+{
+    data.swapWith (other.data);
+    std::swap (overflowPolicy, other.overflowPolicy);
+    std::swap (reservedBytes, other.reservedBytes);
+    std::swap (numDroppedEvents, other.numDroppedEvents);
+    std::swap (lastEventOffset, other.lastEventOffset);
+}
+
+void MidiBuffer::clear() noexcept
+{
+    data.clearQuick();
+    lastEventOffset = -1;
+}
+
+void MidiBuffer::ensureSize (size_t minimumNumBytes)
+{
+    reservedBytes = jmax (reservedBytes, (int) minimumNumBytes);
+    data.ensureStorageAllocated ((int) minimumNumBytes);
+}
+
 bool MidiBuffer::isEmpty() const noexcept                   { return data.size() == 0; }
 
 void MidiBuffer::clear (const int startSample, const int numSamples)
@@ -112,30 +164,91 @@ void MidiBuffer::clear (const int startSample, const int numSamples)
     uint8* const start = MidiBufferHelpers::findEventAfter (data.begin(), data.end(), startSample - 1);
     uint8* const end   = MidiBufferHelpers::findEventAfter (start,        data.end(), startSample + numSamples - 1);
 
-    data.removeRange ((int) (start - data.begin()), (int) (end - data.begin()));
+    if (start != end)
+    {
+        // removeRange() might shrink the storage, which would lose any space that was
+        // reserved with ensureSize()
+        data.removeRangeQuick ((int) (start - data.begin()), (int) (end - start));
+        lastEventOffset = -1;
+    }
 }
 
-void MidiBuffer::addEvent (const MidiMessage& m, const int sampleNumber)
+bool MidiBuffer::hasSpaceFor (const int numBytes) const noexcept
 {
-    addEvent (m.getRawData(), m.getRawDataSize(), sampleNumber);
+    return overflowPolicy == OverflowPolicy::allocateMoreSpace
+            || data.size() + numBytes <= reservedBytes;
 }
 
-void MidiBuffer::addEvent (const void* const newData, const int maxBytes, const int sampleNumber)
+int MidiBuffer::findLastEventOffset() const noexcept
+{
+    if (data.size() == 0)
+        return -1;
+
+    const int headerSize = (int) (sizeof (int32) + sizeof (uint16));
+
+    if (lastEventOffset >= 0
+         && lastEventOffset + headerSize <= data.size()
+         && lastEventOffset + MidiBufferHelpers::getEventTotalSize (data.begin() + lastEventOffset) == data.size())
+        return lastEventOffset;
+
+    const uint8* const endData = data.end();
+
+    for (const uint8* d = data.begin();;)
+    {
+        const uint8* const nextOne = d + MidiBufferHelpers::getEventTotalSize (d);
+
+        if (nextOne >= endData)
+        {
+            lastEventOffset = (int) (d - data.begin());
+            return lastEventOffset;
+        }
+
+        d = nextOne;
+    }
+}
+
+bool MidiBuffer::addEvent (const MidiMessage& m, const int sampleNumber)
+{
+    return addEvent (m.getRawData(), m.getRawDataSize(), sampleNumber);
+}
+
+bool MidiBuffer::addEvent (const void* const newData, const int maxBytes, const int sampleNumber)
 {
     const int numBytes = MidiBufferHelpers::findActualEventLength (static_cast<const uint8*> (newData), maxBytes);
 
-    if (numBytes > 0)
+    if (numBytes <= 0)
+        return false;
+
+    const int newItemSize = numBytes + (int) (sizeof (int32) + sizeof (uint16));
+
+    if (! hasSpaceFor (newItemSize))
     {
-        const size_t newItemSize = (size_t) numBytes + sizeof (int32) + sizeof (uint16);
-        const int offset = (int) (MidiBufferHelpers::findEventAfter (data.begin(), data.end(), sampleNumber) - data.begin());
+        ++numDroppedEvents;
+        return false;
+    }
 
-        data.insertMultiple (offset, 0, (int) newItemSize);
+    const int lastOffset = findLastEventOffset();
+    int offset;
 
-        uint8* const d = data.begin() + offset;
-        writeUnaligned<int32>  (d, sampleNumber);
-        writeUnaligned<uint16> (d + 4, static_cast<uint16> (numBytes));
-        memcpy (d + 6, newData, (size_t) numBytes);
+    if (lastOffset < 0 || MidiBufferHelpers::getEventTime (data.begin() + lastOffset) <= sampleNumber)
+    {
+        // The usual case: the event goes at the end, so there's no need to search for it
+        offset = data.size();
+        lastEventOffset = offset;
+    }
+    else
+    {
+        offset = (int) (MidiBufferHelpers::findEventAfter (data.begin(), data.end(), sampleNumber) - data.begin());
+        lastEventOffset = lastOffset + newItemSize;
     }
+
+    data.insertMultiple (offset, 0, newItemSize);
+
+    uint8* const d = data.begin() + offset;
+    writeUnaligned<int32>  (d, sampleNumber);
+    writeUnaligned<uint16> (d + 4, static_cast<uint16> (numBytes));
+    memcpy (d + 6, newData, (size_t) numBytes);
+    return true;
 }
 
 void MidiBuffer::addEvents (const MidiBuffer& otherBuffer,
@@ -143,17 +256,92 @@ void MidiBuffer::addEvents (const MidiBuffer& otherBuffer,
                             const int numSamples,
                             const int sampleDeltaToAdd)
 {
-    Iterator i (otherBuffer);
-    i.setNextSamplePosition (startSample);
+    if (&otherBuffer == this)
+    {
+        const MidiBuffer copy (otherBuffer);
+        addEvents (copy, startSample, numSamples, sampleDeltaToAdd);
+        return;
+    }
+
+    auto* const sourceStart = otherBuffer.findNextSamplePosition (startSample).getData();
+    auto* const sourceEnd   = numSamples < 0 ? otherBuffer.data.end()
+                                             : otherBuffer.findNextSamplePosition (startSample + numSamples).getData();
+
+    if (sourceStart >= sourceEnd)
+        return;
+
+    const int numBytes = (int) (sourceEnd - sourceStart);
+
+    if (! hasSpaceFor (numBytes))
+    {
+        // Add as many of the events as will fit, and count the rest as dropped
+        for (auto i = MidiBufferIterator (sourceStart); i.getData() < sourceEnd; ++i)
+        {
+            const auto event = *i;
+            addEvent (event.data, event.numBytes, event.samplePosition + sampleDeltaToAdd);
+        }
+
+        return;
+    }
+
+    const int lastOffset = findLastEventOffset();
+    const bool needsMerging = lastOffset >= 0
+                                && MidiBufferHelpers::getEventTime (data.begin() + lastOffset)
+                                     > MidiBufferHelpers::getEventTime (sourceStart) + sampleDeltaToAdd;
+
+    const int firstNewEventOffset = data.size();
+    data.addArray (sourceStart, numBytes);
+
+    uint8* d = data.begin() + firstNewEventOffset;
+    uint8* const endData = data.end();
+
+    for (;;)
+    {
+        if (sampleDeltaToAdd != 0)
+            writeUnaligned<int32> (d, MidiBufferHelpers::getEventTime (d) + sampleDeltaToAdd);
+
+        uint8* const nextOne = d + MidiBufferHelpers::getEventTotalSize (d);
+
+        if (nextOne >= endData)
+            break;
+
+        d = nextOne;
+    }
+
+    lastEventOffset = (int) (d - data.begin());
 
-    const uint8* eventData;
-    int eventSize, position;
+    if (needsMerging)
+        mergeAppendedEvents (firstNewEventOffset);
+}
 
-    while (i.getNextEvent (eventData, eventSize, position)
-            && (position < startSample + numSamples || numSamples < 0))
+void MidiBuffer::mergeAppendedEvents (const int firstNewEventOffset) noexcept
+{
+    // Both the old events and the newly appended ones are sorted, so this merges them in place
+    // by rotating each run of new events into position. Events that have the same time as
+    // existing ones end up after them, in the same way as if they'd been added with addEvent().
+    uint8* existing = data.begin();
+    uint8* newEvents = existing + firstNewEventOffset;
+    uint8* const endData = data.end();
+
+    while (existing < newEvents && newEvents < endData)
     {
-        addEvent (eventData, eventSize, position + sampleDeltaToAdd);
+        existing = MidiBufferHelpers::findEventAfter (existing, newEvents, MidiBufferHelpers::getEventTime (newEvents));
+
+        if (existing >= newEvents)
+            break;
+
+        const int nextExistingTime = MidiBufferHelpers::getEventTime (existing);
+        uint8* endOfRun = newEvents;
+
+        while (endOfRun < endData && MidiBufferHelpers::getEventTime (endOfRun) < nextExistingTime)
+            endOfRun += MidiBufferHelpers::getEventTotalSize (endOfRun);
+
+        std::rotate (existing, newEvents, endOfRun);
+        existing += endOfRun - newEvents;
+        newEvents = endOfRun;
     }
+
+    lastEventOffset = -1;
 }
 
 int MidiBuffer::getNumEvents() const noexcept
@@ -174,20 +362,22 @@ int MidiBuffer::getFirstEventTime() const noexcept
 
 int MidiBuffer::getLastEventTime() const noexcept
 {
-    if (data.size() == 0)
-        return 0;
+    const int lastOffset = findLastEventOffset();
+    return lastOffset >= 0 ? MidiBufferHelpers::getEventTime (data.begin() + lastOffset) : 0;
+}
 
-    const uint8* const endData = data.end();
+MidiBufferIterator MidiBuffer::begin() const noexcept       { return MidiBufferIterator (data.begin()); }
+MidiBufferIterator MidiBuffer::end() const noexcept         { return MidiBufferIterator (data.end()); }
 
-    for (const uint8* d = data.begin();;)
-    {
-        const uint8* const nextOne = d + MidiBufferHelpers::getEventTotalSize (d);
+MidiBufferIterator MidiBuffer::findNextSamplePosition (const int samplePosition) const noexcept
+{
+    const uint8* d = data.begin();
+    const uint8* const dataEnd = data.end();
 
-        if (nextOne >= endData)
-            return MidiBufferHelpers::getEventTime (d);
+    while (d < dataEnd && MidiBufferHelpers::getEventTime (d) < samplePosition)
+        d += MidiBufferHelpers::getEventTotalSize (d);
 
-        d = nextOne;
-    }
+    return MidiBufferIterator (d);
 }
 
 //==============================================================================
@@ -200,11 +390,7 @@ MidiBuffer::Iterator::~Iterator() noexcept{}
 
 void MidiBuffer::Iterator::setNextSamplePosition (const int samplePosition) noexcept
 {
-    data = buffer.data.begin();
-    const uint8* const dataEnd = buffer.data.end();
-
-    while (data < dataEnd && MidiBufferHelpers::getEventTime (data) < samplePosition)
-        data += MidiBufferHelpers::getEventTotalSize (data);
+    data = buffer.findNextSamplePosition (samplePosition).getData();
 }
 
 bool MidiBuffer::Iterator::getNextEvent (const uint8* &midiData, int& numBytes, int& samplePosition) noexcept
@@ -234,4 +420,268 @@ bool MidiBuffer::Iterator::getNextEvent (MidiMessage& result, int& samplePositio
     return true;
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct MidiBufferTest  : public juce::UnitTest
+{
+    MidiBufferTest() : juce::UnitTest ("MidiBuffer", "Audio") {}
+
+    static Array<int> getTimes (const MidiBuffer& buffer)
+    {
+        Array<int> times;
+
+        for (const auto metadata : buffer)
+            times.add (metadata.samplePosition);
+
+        return times;
+    }
+
+    static Array<int> getNoteNumbers (const MidiBuffer& buffer)
+    {
+        Array<int> notes;
+
+        for (const auto metadata : buffer)
+            notes.add (metadata.getMessage().getNoteNumber());
+
+        return notes;
+    }
+
+    static MidiBuffer addEventsOneAtATime (const MidiBuffer& dest, const MidiBuffer& source,
+                                           int startSample, int numSamples, int delta)
+    {
+        MidiBuffer result (dest);
+        MidiBuffer::Iterator i (source);
+        i.setNextSamplePosition (startSample);
+
+        const uint8* eventData;
+        int eventSize, position;
+
+        while (i.getNextEvent (eventData, eventSize, position)
+                && (position < startSample + numSamples || numSamples < 0))
+            result.addEvent (eventData, eventSize, position + delta);
+
+        return result;
+    }
+
+    static bool haveSameEvents (const MidiBuffer& a, const MidiBuffer& b)
+    {
+        return a.data == b.data;
+    }
+
+    void runTest() override
+    {
+        beginTest ("Adding events");
+        {
+            MidiBuffer b;
+            expect (b.isEmpty());
+            expectEquals (b.getLastEventTime(), 0);
+
+            expect (b.addEvent (MidiMessage::noteOn (1, 1, 0.5f), 10));
+            expect (b.addEvent (MidiMessage::noteOn (1, 2, 0.5f), 20));
+            expect (b.addEvent (MidiMessage::noteOn (1, 3, 0.5f), 5));
+            expect (b.addEvent (MidiMessage::noteOn (1, 4, 0.5f), 10));
+            expect (b.addEvent (MidiMessage::noteOn (1, 5, 0.5f), 20));
+
+            expectEquals (b.getNumEvents(), 5);
+            expectEquals (b.getFirstEventTime(), 5);
+            expectEquals (b.getLastEventTime(), 20);
+            expect (getTimes (b) == Array<int> (5, 10, 10, 20, 20));
+            expect (getNoteNumbers (b) == Array<int> (3, 1, 4, 2, 5));
+
+            const uint8 invalidData[] = { 0x01, 0x02 };
+            expect (! b.addEvent (invalidData, 2, 30));
+            expectEquals (b.getNumEvents(), 5);
+
+            b.clear (10, 10);
+            expect (getNoteNumbers (b) == Array<int> (3, 2, 5));
+            expectEquals (b.getLastEventTime(), 20);
+
+            b.clear();
+            expect (b.isEmpty());
+            expectEquals (b.getLastEventTime(), 0);
+        }
+
+        beginTest ("Iterating");
+        {
+            MidiBuffer b;
+            expect (b.begin() == b.end());
+
+            const uint8 sysex[] = { 0xf0, 0x01, 0x02, 0x03, 0xf7 };
+            b.addEvent (MidiMessage::controllerEvent (2, 7, 100), 3);
+            b.addEvent (sysex, (int) sizeof (sysex), 8);
+
+            auto i = b.begin();
+            auto first = *i;
+            expectEquals (first.samplePosition, 3);
+            expectEquals (first.numBytes, 3);
+            expect (first.getMessage().isControllerOfType (7));
+
+            auto second = *++i;
+            expectEquals (second.samplePosition, 8);
+            expectEquals (second.numBytes, (int) sizeof (sysex));
+            expect (memcmp (second.data, sysex, sizeof (sysex)) == 0);
+            expect (++i == b.end());
+
+            expect ((*b.findNextSamplePosition (4)).data == second.data);
+            expect (b.findNextSamplePosition (9) == b.end());
+            expectEquals ((int) std::distance (b.begin(), b.end()), b.getNumEvents());
+        }
+
+        beginTest ("Adding events from another buffer");
+        {
+            Random r (getRandom());
+
+            for (int iteration = 0; iteration < 200; ++iteration)
+            {
+                MidiBuffer dest, source;
+
+                for (int i = r.nextInt (20); --i >= 0;)
+                    dest.addEvent (MidiMessage::noteOn (1, r.nextInt (128), 0.5f), r.nextInt (100));
+
+                for (int i = r.nextInt (20); --i >= 0;)
+                    source.addEvent (MidiMessage::noteOff (2, r.nextInt (128)), r.nextInt (100));
+
+                const int start = r.nextInt (50), num = r.nextInt (100) - 10, delta = r.nextInt (200) - 50;
+
+                auto expected = addEventsOneAtATime (dest, source, start, num, delta);
+                dest.addEvents (source, start, num, delta);
+
+                expect (haveSameEvents (dest, expected));
+                expectEquals (dest.getLastEventTime(), expected.getLastEventTime());
+            }
+        }
+
+        beginTest ("Copying");
+        {
+            MidiBuffer a, b;
+            a.addEvent (MidiMessage::noteOn (1, 60, 0.5f), 1);
+            a.addEvent (MidiMessage::noteOff (1, 60), 2);
+            b.addEvent (MidiMessage::allNotesOff (1), 0);
+
+            b = a;
+            expect (haveSameEvents (a, b));
+            expectEquals (b.getLastEventTime(), 2);
+
+            b.addEvents (b, 0, -1, 10);
+            expect (getTimes (b) == Array<int> (1, 2, 11, 12));
+        }
+
+        beginTest ("Dropping events when full");
+        {
+            MidiBuffer b;
+            b.ensureSize (27);
+            b.setOverflowPolicy (MidiBuffer::OverflowPolicy::dropNewEvents);
+
+            expect (b.addEvent (MidiMessage::noteOn (1, 1, 0.5f), 0));
+            expect (b.addEvent (MidiMessage::noteOn (1, 2, 0.5f), 1));
+            expect (b.addEvent (MidiMessage::noteOn (1, 3, 0.5f), 2));
+            expect (! b.addEvent (MidiMessage::noteOn (1, 4, 0.5f), 3));
+            expectEquals (b.getNumEvents(), 3);
+            expectEquals (b.getNumDroppedEvents(), 1);
+
+            MidiBuffer source;
+
+            for (int i = 0; i < 4; ++i)
+                source.addEvent (MidiMessage::noteOff (1, i), i);
+
+            b.clear();
+            b.addEvent (MidiMessage::noteOn (1, 1, 0.5f), 0);
+            b.addEvents (source, 0, -1, 0);
+            expect (getNoteNumbers (b) == Array<int> (1, 0, 1));
+            expectEquals (b.getNumDroppedEvents(), 3);
+
+            b = source;
+            expectEquals (b.getNumEvents(), 3);
+            expectEquals (b.getNumDroppedEvents(), 4);
+
+            b.resetNumDroppedEvents();
+            expectEquals (b.getNumDroppedEvents(), 0);
+        }
+
+        beginTest ("Clearing a range");
+        {
+            MidiBuffer b;
+
+            for (int i = 0; i < 10; ++i)
+                b.addEvent (MidiMessage::noteOn (1, i, 0.5f), i);
+
+            b.clear (3, 4);
+            expect (getTimes (b) == Array<int> (0, 1, 2, 7, 8, 9));
+            expectEquals (b.getLastEventTime(), 9);
+
+            b.clear (8, 100);
+            b.clear (-10, 11);
+            b.clear (5, 0);
+            expect (getTimes (b) == Array<int> (1, 2, 7));
+
+            // clearing a range shouldn't ever give up the space that was reserved
+            MidiBuffer reserved;
+            reserved.ensureSize (1024);
+            reserved.setOverflowPolicy (MidiBuffer::OverflowPolicy::dropNewEvents);
+
+            for (int i = 0; i < 100; ++i)
+                reserved.addEvent (MidiMessage::noteOn (1, i, 0.5f), i);
+
+            auto* storage = reserved.data.begin();
+
+            reserved.clear (5, 90);
+            expect (getTimes (reserved) == Array<int> (0, 1, 2, 3, 4, 95, 96, 97, 98, 99));
+            expect (getNoteNumbers (reserved) == getTimes (reserved));
+
+            reserved.clear (0, 97);
+            expect (getTimes (reserved) == Array<int> (97, 98, 99));
+
+            reserved.addEvent (MidiMessage::noteOn (1, 1, 0.5f), 1);
+            expect (getTimes (reserved) == Array<int> (1, 97, 98, 99));
+            expectEquals (reserved.getNumDroppedEvents(), 0);
+
+            // filling it up again should use the same block of memory
+            for (int i = 100; i < 300; ++i)
+                reserved.addEvent (MidiMessage::noteOn (1, 1, 0.5f), i);
+
+            expect (reserved.getNumDroppedEvents() > 0);
+            expect (reserved.data.begin() == storage);
+        }
+
+        beginTest ("Swapping");
+        {
+            MidiBuffer a, b;
+            a.ensureSize (18);
+            a.setOverflowPolicy (MidiBuffer::OverflowPolicy::dropNewEvents);
+
+            a.addEvent (MidiMessage::noteOn (1, 1, 0.5f), 0);
+            a.addEvent (MidiMessage::noteOn (1, 2, 0.5f), 1);
+            a.addEvent (MidiMessage::noteOn (1, 3, 0.5f), 2);
+            b.addEvent (MidiMessage::noteOff (1, 4), 3);
+            expectEquals (a.getNumDroppedEvents(), 1);
+
+            a.swapWith (b);
+
+            expect (getNoteNumbers (a) == Array<int> (4));
+            expect (a.getOverflowPolicy() == MidiBuffer::OverflowPolicy::allocateMoreSpace);
+            expectEquals (a.getNumDroppedEvents(), 0);
+
+            expect (getNoteNumbers (b) == Array<int> (1, 2));
+            expect (b.getOverflowPolicy() == MidiBuffer::OverflowPolicy::dropNewEvents);
+            expectEquals (b.getNumDroppedEvents(), 1);
+
+            // the reserved space has moved along with the storage..
+            expect (! b.addEvent (MidiMessage::noteOn (1, 5, 0.5f), 4));
+            expectEquals (b.getNumDroppedEvents(), 2);
+
+            b.clear();
+            expect (b.addEvent (MidiMessage::noteOn (1, 5, 0.5f), 4));
+
+            // ..and the other buffer can grow again
+            for (int i = 0; i < 10; ++i)
+                expect (a.addEvent (MidiMessage::noteOn (1, i, 0.5f), i));
+        }
+    }
+};
+
+static MidiBufferTest midiBufferTests;
+
+#endif
+
 } // namespace juce
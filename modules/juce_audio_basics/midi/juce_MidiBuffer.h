@@ -23,6 +23,86 @@
 namespace juce
 {
 
+//==============================================================================
+/**
+    A view of one of the events in a MidiBuffer, as returned by a MidiBufferIterator.
+
+    The data pointer points directly into the buffer, so it's only valid until the
+    buffer is next changed.
+
+    @see MidiBuffer, MidiBufferIterator
+
+    @tags{Audio}
+*/
+struct JUCE_API  MidiMessageMetadata
+{
+    MidiMessageMetadata() noexcept = default;
+
+    MidiMessageMetadata (const uint8* dataIn, int numBytesIn, int positionIn) noexcept
+        : data (dataIn), numBytes (numBytesIn), samplePosition (positionIn)
+    {
+    }
+
+    /** Creates a MidiMessage from this event, with its timestamp set to the sample position. */
+    MidiMessage getMessage() const      { return MidiMessage (data, numBytes, samplePosition); }
+
+    /** The raw midi data. */
+    const uint8* data = nullptr;
+
+    /** The number of bytes of midi data. */
+    int numBytes = 0;
+
+    /** The event's position, as a sample index in the buffer. */
+    int samplePosition = 0;
+};
+
+//==============================================================================
+/**
+    An iterator over the events in a MidiBuffer, which is returned by MidiBuffer::begin()
+    and MidiBuffer::end(), so that you can write:
+
+    @code
+    for (const auto metadata : midiBuffer)
+        doSomething (metadata.data, metadata.numBytes, metadata.samplePosition);
+    @endcode
+
+    Like a MidiBuffer::Iterator, this becomes invalid as soon as the buffer is changed.
+
+    @tags{Audio}
+*/
+class JUCE_API  MidiBufferIterator
+{
+public:
+    using difference_type   = std::ptrdiff_t;
+    using value_type        = MidiMessageMetadata;
+    using reference         = MidiMessageMetadata;
+    using pointer           = void;
+    using iterator_category = std::forward_iterator_tag;
+
+    MidiBufferIterator() noexcept = default;
+
+    /** Creates an iterator which points to an event in a MidiBuffer's data. */
+    explicit MidiBufferIterator (const uint8* dataIn) noexcept  : data (dataIn) {}
+
+    bool operator== (const MidiBufferIterator& other) const noexcept    { return data == other.data; }
+    bool operator!= (const MidiBufferIterator& other) const noexcept    { return data != other.data; }
+
+    /** Moves on to the next event. */
+    MidiBufferIterator& operator++() noexcept;
+
+    /** Moves on to the next event, returning the iterator's previous state. */
+    MidiBufferIterator operator++ (int) noexcept;
+
+    /** Returns a view of the current event. */
+    MidiMessageMetadata operator*() const noexcept;
+
+    /** Returns the address of the current event in the buffer's data. */
+    const uint8* getData() const noexcept       { return data; }
+
+private:
+    const uint8* data = nullptr;
+};
+
 //==============================================================================
 /**
     Holds a sequence of time-stamped midi events.
@@ -35,6 +115,12 @@ namespace juce
     appropriate container. MidiBuffer is designed for lower-level streams of raw
     midi data.
 
+    To use a MidiBuffer on the audio thread without it ever allocating, reserve enough
+    space with ensureSize() and call setOverflowPolicy (OverflowPolicy::dropNewEvents) - any
+    events that don't fit will then be counted and thrown away rather than making the
+    buffer grow. Adding an event that belongs at the end of the buffer takes constant time,
+    and addEvents() copies or merges whole blocks of events at once.
+
     @see MidiMessage
 
     @tags{Audio}
@@ -52,7 +138,12 @@ public:
     /** Creates a copy of another MidiBuffer. */
     MidiBuffer (const MidiBuffer&) noexcept;
 
-    /** Makes a copy of another MidiBuffer. */
+    /** Makes a copy of another MidiBuffer's events.
+
+        This re-uses the buffer's existing storage if it's big enough, and keeps its own
+        overflow policy - if the policy is dropNewEvents, any events that don't fit
+        will be dropped.
+    */
     MidiBuffer& operator= (const MidiBuffer&) noexcept;
 
     /** Destructor */
@@ -65,7 +156,7 @@ public:
     /** Removes all events between two times from the buffer.
 
         All events for which (start <= event position < start + numSamples) will
-        be removed.
+        be removed. Like clear(), this keeps all of the buffer's storage.
     */
     void clear (int start, int numSamples);
 
@@ -92,8 +183,11 @@ public:
         already in the buffer, the new event will be placed after the existing ones.
 
         To retrieve events, use a MidiBuffer::Iterator object
+
+        @returns    true if the event was added, or false if it was dropped because the
+                    buffer was full - see setOverflowPolicy()
     */
-    void addEvent (const MidiMessage& midiMessage, int sampleNumber);
+    bool addEvent (const MidiMessage& midiMessage, int sampleNumber);
 
     /** Adds an event to the buffer from raw midi data.
 
@@ -110,8 +204,11 @@ public:
         add an event at all.
 
         To retrieve events, use a MidiBuffer::Iterator object
+
+        @returns    true if the event was added, or false if the data was invalid or the
+                    event was dropped because the buffer was full - see setOverflowPolicy()
     */
-    void addEvent (const void* rawMidiData,
+    bool addEvent (const void* rawMidiData,
                    int maxBytesOfMidiData,
                    int sampleNumber);
 
@@ -128,6 +225,9 @@ public:
                                     startSample will be taken.
         @param sampleDeltaToAdd     a value which will be added to the source timestamps of the events
                                     that are added to this buffer
+
+        The events are copied as a single block when they all belong after the events that are
+        already in this buffer, and are otherwise merged in, keeping both sets of events in order.
     */
     void addEvents (const MidiBuffer& otherBuffer,
                     int startSample,
@@ -148,16 +248,62 @@ public:
     /** Exchanges the contents of this buffer with another one.
 
         This is a quick operation, because no memory allocating or copying is done, it
-        just swaps the internal state of the two buffers.
+        just swaps the internal state of the two buffers. The overflow policy, the space
+        reserved with ensureSize() and the number of dropped events all belong to the
+        storage, so they're swapped along with it.
     */
     void swapWith (MidiBuffer&) noexcept;
 
     /** Preallocates some memory for the buffer to use.
         This helps to avoid needing to reallocate space when the buffer has messages
         added to it.
+
+        If the overflow policy is dropNewEvents, this sets the number of bytes that the
+        buffer is allowed to use.
     */
     void ensureSize (size_t minimumNumBytes);
 
+    //==============================================================================
+    /** The things that can happen when an event is added to a buffer that has no room left for it. */
+    enum class OverflowPolicy
+    {
+        allocateMoreSpace,  /**< The buffer's storage grows as needed. This is the default. */
+        dropNewEvents       /**< The buffer never allocates more space than was reserved by
+                                 ensureSize(), and events that don't fit are dropped. */
+    };
+
+    /** Changes what happens when events are added to a buffer that's full. */
+    void setOverflowPolicy (OverflowPolicy newPolicy) noexcept      { overflowPolicy = newPolicy; }
+
+    /** Returns the buffer's overflow policy. */
+    OverflowPolicy getOverflowPolicy() const noexcept               { return overflowPolicy; }
+
+    /** Returns the number of events that have been dropped because the buffer was full.
+        This isn't reset when the buffer is cleared - use resetNumDroppedEvents() for that.
+    */
+    int getNumDroppedEvents() const noexcept                        { return numDroppedEvents; }
+
+    /** Resets the count returned by getNumDroppedEvents(). */
+    void resetNumDroppedEvents() noexcept                           { numDroppedEvents = 0; }
+
+    //==============================================================================
+    /** Returns an iterator pointing to the first event in the buffer. */
+    MidiBufferIterator begin() const noexcept;
+
+    /** Returns an iterator pointing one past the last event in the buffer. */
+    MidiBufferIterator end() const noexcept;
+
+    /** Returns an iterator pointing to the first event in the buffer. */
+    MidiBufferIterator cbegin() const noexcept                      { return begin(); }
+
+    /** Returns an iterator pointing one past the last event in the buffer. */
+    MidiBufferIterator cend() const noexcept                        { return end(); }
+
+    /** Returns an iterator pointing to the first event whose sample position is greater
+        than or equal to the given position, or end() if there isn't one.
+    */
+    MidiBufferIterator findNextSamplePosition (int samplePosition) const noexcept;
+
     //==============================================================================
     /**
         Used to iterate through the events in a MidiBuffer.
@@ -231,6 +377,18 @@ public:
     Array<uint8> data;
 
 private:
+    //==============================================================================
+    OverflowPolicy overflowPolicy = OverflowPolicy::allocateMoreSpace;
+    int reservedBytes = 0, numDroppedEvents = 0;
+
+    // The offset of the last event, which lets events be appended without searching the
+    // whole buffer. It's checked against the data before being used, and -1 means unknown.
+    mutable int lastEventOffset = -1;
+
+    int findLastEventOffset() const noexcept;
+    bool hasSpaceFor (int numBytes) const noexcept;
+    void mergeAppendedEvents (int firstNewEventOffset) noexcept;
+
     JUCE_LEAK_DETECTOR (MidiBuffer)
 };
 
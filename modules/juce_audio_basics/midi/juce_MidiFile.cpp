@@ -306,7 +306,7 @@ void MidiFile::readNextTrack (const uint8* data, int size, bool createMatchingNo
         time += delay;
 
         int messSize = 0;
-        const MidiMessage mm (data, size, messSize, lastStatusByte, time);
+        MidiMessage mm (data, size, messSize, lastStatusByte, time);
 
         if (messSize <= 0)
             break;
@@ -314,12 +314,12 @@ void MidiFile::readNextTrack (const uint8* data, int size, bool createMatchingNo
         size -= messSize;
         data += messSize;
 
-        result.addEvent (mm);
-
         auto firstByte = *(mm.getRawData());
 
         if ((firstByte & 0xf0) != 0xf0)
             lastStatusByte = firstByte;
+
+        result.addEvent (std::move (mm));
     }
 
     // sort so that we put all the note-offs before note-ons that have the same time
@@ -336,7 +336,7 @@ void MidiFile::readNextTrack (const uint8* data, int size, bool createMatchingNo
         return a->message.isNoteOff() && b->message.isNoteOn();
     });
 
-    addTrack (result);
+    tracks.add (new MidiMessageSequence (std::move (result)));
 
     if (createMatchingNoteOffs)
         tracks.getLast()->updateMatchedPairs();
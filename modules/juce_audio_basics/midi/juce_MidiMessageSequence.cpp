@@ -23,6 +23,27 @@
 namespace juce
 {
 
+namespace MidiMessageSequenceHelpers
+{
+    static bool isEarlier (const MidiMessageSequence::MidiEventHolder* a,
+                           const MidiMessageSequence::MidiEventHolder* b) noexcept
+    {
+        return a->message.getTimeStamp() < b->message.getTimeStamp();
+    }
+
+    template <typename Predicate>
+    static void removeEventsIf (OwnedArray<MidiMessageSequence::MidiEventHolder>& list, Predicate shouldRemove)
+    {
+        // Moves the events to keep to the front in a single pass, rather than removing
+        // them one at a time, which would shuffle the rest of the list down each time
+        auto* keptEnd = std::stable_partition (list.begin(), list.end(),
+                                               [&] (const MidiMessageSequence::MidiEventHolder* e) { return ! shouldRemove (e->message); });
+
+        auto numToKeep = (int) (keptEnd - list.begin());
+        list.removeRange (numToKeep, list.size() - numToKeep);
+    }
+}
+
 MidiMessageSequence::MidiEventHolder::MidiEventHolder (const MidiMessage& mm) : message (mm) {}
 MidiMessageSequence::MidiEventHolder::MidiEventHolder (MidiMessage&& mm) : message (std::move (mm)) {}
 MidiMessageSequence::MidiEventHolder::~MidiEventHolder() {}
@@ -105,6 +126,11 @@ int MidiMessageSequence::getIndexOfMatchingKeyUp (int index) const noexcept
     {
         if (auto* noteOff = meh->noteOffObject)
         {
+            // The note-off can't be earlier than its note-on, so start looking at its timestamp
+            for (int i = jmax (index, getNextIndexAtTime (noteOff->message.getTimeStamp())); i < list.size(); ++i)
+                if (list.getUnchecked(i) == noteOff)
+                    return i;
+
             for (int i = index; i < list.size(); ++i)
                 if (list.getUnchecked(i) == noteOff)
                     return i;
@@ -123,14 +149,10 @@ int MidiMessageSequence::getIndexOf (const MidiEventHolder* event) const noexcep
 
 int MidiMessageSequence::getNextIndexAtTime (double timeStamp) const noexcept
 {
-    auto numEvents = list.size();
-    int i;
+    auto found = std::lower_bound (list.begin(), list.end(), timeStamp,
+                                   [] (const MidiEventHolder* e, double t) { return e->message.getTimeStamp() < t; });
 
-    for (i = 0; i < numEvents; ++i)
-        if (list.getUnchecked(i)->message.getTimeStamp() >= timeStamp)
-            break;
-
-    return i;
+    return (int) (found - list.begin());
 }
 
 //==============================================================================
@@ -190,6 +212,9 @@ void MidiMessageSequence::deleteEvent (int index, bool deleteMatchingNoteUp)
 
 void MidiMessageSequence::addSequence (const MidiMessageSequence& other, double timeAdjustment)
 {
+    auto numExistingEvents = list.size();
+    list.ensureStorageAllocated (numExistingEvents + other.getNumEvents());
+
     for (auto* m : other)
     {
         auto newOne = new MidiEventHolder (m->message);
@@ -197,7 +222,7 @@ void MidiMessageSequence::addSequence (const MidiMessageSequence& other, double
         list.add (newOne);
     }
 
-    sort();
+    mergeAddedEvents (numExistingEvents);
 }
 
 void MidiMessageSequence::addSequence (const MidiMessageSequence& other,
@@ -205,6 +230,8 @@ void MidiMessageSequence::addSequence (const MidiMessageSequence& other,
                                        double firstAllowableTime,
                                        double endOfAllowableDestTimes)
 {
+    auto numExistingEvents = list.size();
+
     for (auto* m : other)
     {
         auto t = m->message.getTimeStamp() + timeAdjustment;
@@ -217,7 +244,22 @@ void MidiMessageSequence::addSequence (const MidiMessageSequence& other,
         }
     }
 
-    sort();
+    mergeAddedEvents (numExistingEvents);
+}
+
+void MidiMessageSequence::mergeAddedEvents (int numExistingEvents)
+{
+    // When both halves are already in order, they can be merged in linear time rather than
+    // sorting the whole list again. Like the stable sort, this keeps existing events ahead
+    // of new ones that have the same time. The existing events are usually sorted, but
+    // can be out of order if their timestamps have been changed without calling sort().
+    auto* firstNewEvent = list.begin() + numExistingEvents;
+
+    if (std::is_sorted (list.begin(), firstNewEvent, MidiMessageSequenceHelpers::isEarlier)
+         && std::is_sorted (firstNewEvent, list.end(), MidiMessageSequenceHelpers::isEarlier))
+        std::inplace_merge (list.begin(), firstNewEvent, list.end(), MidiMessageSequenceHelpers::isEarlier);
+    else
+        sort();
 }
 
 void MidiMessageSequence::sort() noexcept
@@ -228,43 +270,63 @@ void MidiMessageSequence::sort() noexcept
 
 void MidiMessageSequence::updateMatchedPairs() noexcept
 {
+    // This makes a single pass through the list, remembering the most recent unmatched
+    // note-on for each channel and note number. When a second note-on arrives before a
+    // note-off, a note-off is inserted just before it to end the earlier note.
+    MidiEventHolder* unmatchedNoteOns[16][128] = {};
+    Array<std::pair<int, MidiEventHolder*>> insertedNoteOffs;
+
     for (int i = 0; i < list.size(); ++i)
     {
         auto* meh = list.getUnchecked(i);
-        auto& m1 = meh->message;
+        auto& m = meh->message;
 
-        if (m1.isNoteOn())
+        if (m.isNoteOff())
         {
-            meh->noteOffObject = nullptr;
-            auto note = m1.getNoteNumber();
-            auto chan = m1.getChannel();
-            auto len = list.size();
+            auto& noteOn = unmatchedNoteOns[m.getChannel() - 1][m.getNoteNumber()];
 
-            for (int j = i + 1; j < len; ++j)
+            if (noteOn != nullptr)
             {
-                auto* meh2 = list.getUnchecked(j);
-                auto& m = meh2->message;
+                noteOn->noteOffObject = meh;
+                noteOn = nullptr;
+            }
+        }
+        else if (m.isNoteOn())
+        {
+            auto chan = m.getChannel();
+            auto note = m.getNoteNumber();
+            auto& noteOn = unmatchedNoteOns[chan - 1][note];
 
-                if (m.getNoteNumber() == note && m.getChannel() == chan)
-                {
-                    if (m.isNoteOff())
-                    {
-                        meh->noteOffObject = meh2;
-                        break;
-                    }
-
-                    if (m.isNoteOn())
-                    {
-                        auto newEvent = new MidiEventHolder (MidiMessage::noteOff (chan, note));
-                        list.insert (j, newEvent);
-                        newEvent->message.setTimeStamp (m.getTimeStamp());
-                        meh->noteOffObject = newEvent;
-                        break;
-                    }
-                }
+            if (noteOn != nullptr)
+            {
+                auto newEvent = new MidiEventHolder (MidiMessage::noteOff (chan, note));
+                newEvent->message.setTimeStamp (m.getTimeStamp());
+                noteOn->noteOffObject = newEvent;
+                insertedNoteOffs.add ({ i, newEvent });
             }
+
+            meh->noteOffObject = nullptr;
+            noteOn = meh;
         }
     }
+
+    if (insertedNoteOffs.isEmpty())
+        return;
+
+    OwnedArray<MidiEventHolder> newList;
+    newList.ensureStorageAllocated (list.size() + insertedNoteOffs.size());
+    int nextInsertion = 0;
+
+    for (int i = 0; i < list.size(); ++i)
+    {
+        while (nextInsertion < insertedNoteOffs.size() && insertedNoteOffs.getReference (nextInsertion).first == i)
+            newList.add (insertedNoteOffs.getReference (nextInsertion++).second);
+
+        newList.add (list.getUnchecked (i));
+    }
+
+    list.clear (false);
+    list.swapWith (newList);
 }
 
 void MidiMessageSequence::addTimeToMessages (double delta) noexcept
@@ -294,16 +356,12 @@ void MidiMessageSequence::extractSysExMessages (MidiMessageSequence& destSequenc
 
 void MidiMessageSequence::deleteMidiChannelMessages (const int channelNumberToRemove)
 {
-    for (int i = list.size(); --i >= 0;)
-        if (list.getUnchecked(i)->message.isForChannel (channelNumberToRemove))
-            list.remove(i);
+    MidiMessageSequenceHelpers::removeEventsIf (list, [=] (const MidiMessage& m) { return m.isForChannel (channelNumberToRemove); });
 }
 
 void MidiMessageSequence::deleteSysExMessages()
 {
-    for (int i = list.size(); --i >= 0;)
-        if (list.getUnchecked(i)->message.isSysEx())
-            list.remove(i);
+    MidiMessageSequenceHelpers::removeEventsIf (list, [] (const MidiMessage& m) { return m.isSysEx(); });
 }
 
 //==============================================================================
@@ -395,6 +453,63 @@ struct MidiMessageSequenceTest  : public juce::UnitTest
         expectEquals (s.getNumEvents(), 7);
         expectEquals (s.getIndexOfMatchingKeyUp (0), -1); // Truncated note, should be no note off
         expectEquals (s.getTimeOfMatchingKeyUp (1), 5.0);
+
+        beginTest ("Overlapping notes");
+        MidiMessageSequence s3;
+        s3.addEvent (MidiMessage::noteOn  (1, 60, 0.5f).withTimeStamp (0.0));
+        s3.addEvent (MidiMessage::noteOn  (2, 60, 0.5f).withTimeStamp (1.0));
+        s3.addEvent (MidiMessage::noteOn  (1, 60, 0.5f).withTimeStamp (2.0));
+        s3.addEvent (MidiMessage::noteOn  (1, 60, 0.0f).withTimeStamp (3.0));
+        s3.addEvent (MidiMessage::noteOff (2, 60).withTimeStamp (3.0));
+        s3.updateMatchedPairs();
+
+        expectEquals (s3.getNumEvents(), 6);
+        expect (s3.getEventPointer (2)->message.isNoteOff());
+        expectEquals (s3.getEventTime (2), 2.0);
+        expectEquals (s3.getIndexOfMatchingKeyUp (0), 2); // Ended by an inserted note-off
+        expectEquals (s3.getIndexOfMatchingKeyUp (1), 5);
+        expectEquals (s3.getIndexOfMatchingKeyUp (3), 4); // Ended by a note-on with zero velocity
+
+        beginTest ("Times with duplicate timestamps");
+        expectEquals (s3.getNextIndexAtTime (2.0), 2);
+        expectEquals (s3.getNextIndexAtTime (3.0), 4);
+        expectEquals (s3.getNextIndexAtTime (-1.0), 0);
+
+        beginTest ("Deleting channel messages");
+        s3.deleteMidiChannelMessages (1);
+        expectEquals (s3.getNumEvents(), 2);
+        expect (s3.getEventPointer (0)->message.isNoteOn());
+        expectEquals (s3.getEventPointer (1)->message.getChannel(), 2);
+
+        beginTest ("Merging into an unsorted sequence");
+        {
+            MidiMessageSequence unsorted;
+            unsorted.addEvent (MidiMessage::noteOn (1, 60, 0.5f).withTimeStamp (1.0));
+            unsorted.addEvent (MidiMessage::noteOn (1, 61, 0.5f).withTimeStamp (2.0));
+
+            // changing a timestamp doesn't re-sort the sequence..
+            unsorted.getEventPointer (0)->message.setTimeStamp (5.0);
+
+            MidiMessageSequence other;
+            other.addEvent (MidiMessage::noteOn (1, 62, 0.5f).withTimeStamp (3.0));
+
+            // ..but adding another sequence should leave it all in order
+            unsorted.addSequence (other, 0.0);
+
+            expectEquals (unsorted.getNumEvents(), 3);
+            expectEquals (unsorted.getEventTime (0), 2.0);
+            expectEquals (unsorted.getEventTime (1), 3.0);
+            expectEquals (unsorted.getEventTime (2), 5.0);
+
+            unsorted.getEventPointer (2)->message.setTimeStamp (0.5);
+            unsorted.addSequence (other, 1.0, 0.0, 10.0);
+
+            expectEquals (unsorted.getNumEvents(), 4);
+            expectEquals (unsorted.getEventTime (0), 0.5);
+            expectEquals (unsorted.getEventTime (1), 2.0);
+            expectEquals (unsorted.getEventTime (2), 3.0);
+            expectEquals (unsorted.getEventTime (3), 4.0);
+        }
     }
 };
 
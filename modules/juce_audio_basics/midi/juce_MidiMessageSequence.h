@@ -126,6 +126,8 @@ public:
     /** Returns the index of the first event on or after the given timestamp.
         If the time is beyond the end of the sequence, this will return the
         number of events.
+
+        This does a binary search, so it relies on the sequence being sorted.
     */
     int getNextIndexAtTime (double timeStamp) const noexcept;
 
@@ -293,6 +295,7 @@ private:
     OwnedArray<MidiEventHolder> list;
 
     MidiEventHolder* addEvent (MidiEventHolder*, double);
+    void mergeAddedEvents (int numExistingEvents);
 
     JUCE_LEAK_DETECTOR (MidiMessageSequence)
 };
@@ -23,136 +23,724 @@
 namespace juce
 {
 
+struct MixerAudioSource::Input  : public ReferenceCountedObject
+{
+    Input (AudioSource* s, bool shouldDelete)  : source (s), deleteWhenRemoved (shouldDelete) {}
+
+    void prepare (double sampleRate, int blockSize, double rampLengthSeconds)
+    {
+        for (auto* v : { &smoothedGain, &smoothedPan })
+            v->reset (sampleRate, rampLengthSeconds);
+
+        smoothedGain.setCurrentAndTargetValue (gain.load());
+        smoothedPan.setCurrentAndTargetValue (pan.load());
+        scratch.setSize (2, blockSize);
+    }
+
+    void updateTargets() noexcept
+    {
+        smoothedGain.setTargetValue (gain.load (std::memory_order_relaxed));
+        smoothedPan.setTargetValue (pan.load (std::memory_order_relaxed));
+    }
+
+    bool hasUnityGain() const noexcept
+    {
+        return ! (smoothedGain.isSmoothing() || smoothedPan.isSmoothing())
+                 && smoothedGain.getCurrentValue() == 1.0f
+                 && smoothedPan.getCurrentValue() == 0.0f;
+    }
+
+    AudioSource* const source;
+    const bool deleteWhenRemoved;
+    std::atomic<float> gain { 1.0f }, pan { 0.0f };
+    std::atomic<bool> renderInParallel { false };
+
+    // these are only used by the audio thread
+    SmoothedValue<float> smoothedGain, smoothedPan;
+    AudioBuffer<float> scratch;
+    bool isParallelJob = false;
+
+    JUCE_DECLARE_NON_COPYABLE (Input)
+};
+
+//==============================================================================
+/*  The list of inputs is never changed once the audio thread can see it - instead, a
+    new list is made and swapped in. The list also holds on to the render threads, so that
+    they can't be deleted while the audio thread is using them.
+*/
+struct MixerAudioSource::InputList  : public ReferenceCountedObject
+{
+    InputList() = default;
+
+    InputList (const InputList& other)
+        : ReferenceCountedObject(), inputs (other.inputs), renderThreads (other.renderThreads)
+    {
+        jobs.ensureStorageAllocated (inputs.size() + 1);
+    }
+
+    ReferenceCountedArray<Input> inputs;
+    ReferenceCountedObjectPtr<RenderThreads> renderThreads;
+    Array<Input*> jobs;  // used by the audio thread while it renders a block
+
+    JUCE_LEAK_DETECTOR (InputList)
+};
+
+//==============================================================================
+class MixerAudioSource::RenderThread  : public Thread
+{
+public:
+    RenderThread (MixerAudioSource& m, int index)
+        : Thread ("Mixer render " + String (index + 1)), mixer (m)
+    {
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            if (wakeUp.wait (100))
+                while (mixer.renderNextParallelJob())
+                {}
+        }
+    }
+
+    WaitableEvent wakeUp;
+
+private:
+    MixerAudioSource& mixer;
+
+    JUCE_DECLARE_NON_COPYABLE (RenderThread)
+};
+
+struct MixerAudioSource::RenderThreads  : public ReferenceCountedObject
+{
+    RenderThreads (MixerAudioSource& mixer, int numThreads)
+    {
+        for (int i = 0; i < numThreads; ++i)
+            threads.add (new RenderThread (mixer, i))->startThread (Thread::realtimeAudioPriority);
+    }
+
+    ~RenderThreads()
+    {
+        for (auto* t : threads)
+        {
+            t->signalThreadShouldExit();
+            t->wakeUp.signal();
+        }
+
+        for (auto* t : threads)
+            t->stopThread (4000);
+    }
+
+    void wakeUp (int numJobs)
+    {
+        for (int i = jmin (numJobs, threads.size()); --i >= 0;)
+            threads.getUnchecked (i)->wakeUp.signal();
+    }
+
+    OwnedArray<RenderThread> threads;
+
+    JUCE_DECLARE_NON_COPYABLE (RenderThreads)
+};
+
+//==============================================================================
 MixerAudioSource::MixerAudioSource()
-   : currentSampleRate (0.0), bufferSizeExpected (0)
+    : inputList (new InputList())
 {
+    activeList = inputList.get();
 }
 
 MixerAudioSource::~MixerAudioSource()
 {
     removeAllInputs();
+    activeList = nullptr;
+    inputList = nullptr;
 }
 
 //==============================================================================
+MixerAudioSource::Input* MixerAudioSource::findInput (AudioSource* source) const
+{
+    for (auto* input : inputList->inputs)
+        if (input->source == source)
+            return input;
+
+    return nullptr;
+}
+
+void MixerAudioSource::publish (InputList* newList)
+{
+    ReferenceCountedObjectPtr<InputList> oldList (inputList);
+
+    inputList = newList;
+    activeList = newList;
+
+    // If the audio thread is half-way through a callback, it may still be using the
+    // old list, so we need to wait for it to finish before the old list can go..
+    auto count = callbackCount.load();
+
+    if ((count & 1) != 0)
+        while (callbackCount.load() == count)
+            Thread::yield();
+}
+
 void MixerAudioSource::addInputSource (AudioSource* input, const bool deleteWhenRemoved)
 {
-    if (input != nullptr && ! inputs.contains (input))
+    if (input == nullptr)
+        return;
+
+    double localRate;
+    int localBufferSize;
+    double localRampLength;
+
     {
-        double localRate;
-        int localBufferSize;
+        const ScopedLock sl (lock);
 
-        {
-            const ScopedLock sl (lock);
-            localRate = currentSampleRate;
-            localBufferSize = bufferSizeExpected;
-        }
+        if (findInput (input) != nullptr)
+            return;
 
-        if (localRate > 0.0)
-            input->prepareToPlay (localBufferSize, localRate);
+        localRate = currentSampleRate;
+        localBufferSize = bufferSizeExpected;
+        localRampLength = rampLengthSeconds;
+    }
 
-        const ScopedLock sl (lock);
+    ReferenceCountedObjectPtr<Input> newInput (new Input (input, deleteWhenRemoved));
 
-        inputsToDelete.setBit (inputs.size(), deleteWhenRemoved);
-        inputs.add (input);
+    if (localRate > 0.0)
+    {
+        input->prepareToPlay (localBufferSize, localRate);
+        newInput->prepare (localRate, localBufferSize, localRampLength);
     }
+
+    const ScopedLock sl (lock);
+
+    std::unique_ptr<InputList> newList (new InputList (*inputList));
+    newList->inputs.add (newInput);
+    publish (newList.release());
 }
 
 void MixerAudioSource::removeInputSource (AudioSource* const input)
 {
-    if (input != nullptr)
-    {
-        std::unique_ptr<AudioSource> toDelete;
-
-        {
-            const ScopedLock sl (lock);
-            const int index = inputs.indexOf (input);
+    if (input == nullptr)
+        return;
 
-            if (index < 0)
-                return;
+    ReferenceCountedObjectPtr<Input> removed;
 
-            if (inputsToDelete [index])
-                toDelete.reset (input);
+    {
+        const ScopedLock sl (lock);
+        removed = findInput (input);
 
-            inputsToDelete.shiftBits (-1, index);
-            inputs.remove (index);
-        }
+        if (removed == nullptr)
+            return;
 
-        input->releaseResources();
+        std::unique_ptr<InputList> newList (new InputList (*inputList));
+        newList->inputs.removeObject (removed);
+        publish (newList.release());
     }
+
+    std::unique_ptr<AudioSource> toDelete (removed->deleteWhenRemoved ? input : nullptr);
+    input->releaseResources();
 }
 
 void MixerAudioSource::removeAllInputs()
 {
-    OwnedArray<AudioSource> toDelete;
+    ReferenceCountedArray<Input> removed;
 
     {
         const ScopedLock sl (lock);
+        removed = inputList->inputs;
 
-        for (int i = inputs.size(); --i >= 0;)
-            if (inputsToDelete[i])
-                toDelete.add (inputs.getUnchecked(i));
-
-        inputs.clear();
+        std::unique_ptr<InputList> newList (new InputList (*inputList));
+        newList->inputs.clear();
+        publish (newList.release());
     }
 
+    OwnedArray<AudioSource> toDelete;
+
+    for (auto* input : removed)
+        if (input->deleteWhenRemoved)
+            toDelete.add (input->source);
+
     for (int i = toDelete.size(); --i >= 0;)
         toDelete.getUnchecked(i)->releaseResources();
 }
 
+//==============================================================================
+void MixerAudioSource::setInputGain (AudioSource* input, float newGain)
+{
+    const ScopedLock sl (lock);
+
+    if (auto* i = findInput (input))
+        i->gain = newGain;
+}
+
+void MixerAudioSource::setInputPan (AudioSource* input, float newPan)
+{
+    const ScopedLock sl (lock);
+
+    if (auto* i = findInput (input))
+        i->pan = jlimit (-1.0f, 1.0f, newPan);
+}
+
+void MixerAudioSource::setInputRendersInParallel (AudioSource* input, bool shouldRenderInParallel)
+{
+    const ScopedLock sl (lock);
+
+    if (auto* i = findInput (input))
+        i->renderInParallel = shouldRenderInParallel;
+}
+
+void MixerAudioSource::setRampLength (double newLengthSeconds)
+{
+    const ScopedLock sl (lock);
+    rampLengthSeconds = jmax (0.0, newLengthSeconds);
+}
+
+void MixerAudioSource::setNumberOfRenderThreads (int numThreads)
+{
+    const ScopedLock sl (lock);
+    auto& current = inputList->renderThreads;
+
+    if (numThreads == (current != nullptr ? current->threads.size() : 0))
+        return;
+
+    std::unique_ptr<InputList> newList (new InputList (*inputList));
+    newList->renderThreads = numThreads > 0 ? new RenderThreads (*this, numThreads) : nullptr;
+    publish (newList.release());
+}
+
+//==============================================================================
 void MixerAudioSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
 {
     tempBuffer.setSize (2, samplesPerBlockExpected);
+    rampBuffer.setSize (3, samplesPerBlockExpected);
 
     const ScopedLock sl (lock);
 
     currentSampleRate = sampleRate;
     bufferSizeExpected = samplesPerBlockExpected;
 
-    for (int i = inputs.size(); --i >= 0;)
-        inputs.getUnchecked(i)->prepareToPlay (samplesPerBlockExpected, sampleRate);
+    for (int i = inputList->inputs.size(); --i >= 0;)
+    {
+        auto* input = inputList->inputs.getObjectPointerUnchecked (i);
+        input->source->prepareToPlay (samplesPerBlockExpected, sampleRate);
+        input->prepare (sampleRate, samplesPerBlockExpected, rampLengthSeconds);
+    }
 }
 
 void MixerAudioSource::releaseResources()
 {
     const ScopedLock sl (lock);
 
-    for (int i = inputs.size(); --i >= 0;)
-        inputs.getUnchecked(i)->releaseResources();
+    for (int i = inputList->inputs.size(); --i >= 0;)
+    {
+        auto* input = inputList->inputs.getObjectPointerUnchecked (i);
+        input->source->releaseResources();
+        input->scratch.setSize (2, 0);
+    }
 
     tempBuffer.setSize (2, 0);
+    rampBuffer.setSize (3, 0);
 
     currentSampleRate = 0;
     bufferSizeExpected = 0;
 }
 
+//==============================================================================
+bool MixerAudioSource::renderNextParallelJob()
+{
+    auto state = jobState.load (std::memory_order_acquire);
+
+    for (;;)
+    {
+        auto nextJob = (int) (state & 0xffff);
+        auto numJobs = (int) ((state >> 16) & 0xffff);
+
+        if (nextJob >= numJobs)
+            return false;
+
+        if (jobState.compare_exchange_weak (state, state + 1, std::memory_order_acq_rel))
+        {
+            auto& job = *currentJobs[nextJob];
+            job.source->getNextAudioBlock (AudioSourceChannelInfo (&job.scratch, 0, currentJobNumSamples));
+            ++numJobsDone;
+            return true;
+        }
+    }
+}
+
+static float getChannelBalance (float pan, int channel, int numChannels) noexcept
+{
+    if (numChannels < 2 || channel > 1)
+        return 1.0f;
+
+    return channel == 0 ? jmin (1.0f, 1.0f - pan)
+                        : jmin (1.0f, 1.0f + pan);
+}
+
+void MixerAudioSource::mixInput (Input& input, const AudioBuffer<float>& source, const AudioSourceChannelInfo& info)
+{
+    auto numSamples = info.numSamples;
+    auto numChannels = info.buffer->getNumChannels();
+
+    if (input.smoothedGain.isSmoothing() || input.smoothedPan.isSmoothing())
+    {
+        // While the gain or pan is changing, build a gain curve for each channel: the first
+        // curve is for channels that aren't affected by the pan, then the left and right ones
+        rampBuffer.setSize (3, numSamples, false, false, true);
+        auto* gains = rampBuffer.getWritePointer (0);
+        auto* leftGains = rampBuffer.getWritePointer (1);
+        auto* rightGains = rampBuffer.getWritePointer (2);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto gain = input.smoothedGain.getNextValue();
+            auto pan  = input.smoothedPan.getNextValue();
+
+            gains[i] = gain;
+            leftGains[i]  = gain * getChannelBalance (pan, 0, 2);
+            rightGains[i] = gain * getChannelBalance (pan, 1, 2);
+        }
+
+        if (source.hasBeenCleared())
+            return;
+
+        for (int chan = 0; chan < numChannels; ++chan)
+            FloatVectorOperations::addWithMultiply (info.buffer->getWritePointer (chan, info.startSample),
+                                                    source.getReadPointer (chan),
+                                                    rampBuffer.getReadPointer (numChannels > 1 && chan < 2 ? chan + 1 : 0),
+                                                    numSamples);
+        return;
+    }
+
+    if (source.hasBeenCleared())
+        return;
+
+    auto gain = input.smoothedGain.getCurrentValue();
+    auto pan  = input.smoothedPan.getCurrentValue();
+
+    for (int chan = 0; chan < numChannels; ++chan)
+    {
+        auto channelGain = gain * getChannelBalance (pan, chan, numChannels);
+        auto* dest = info.buffer->getWritePointer (chan, info.startSample);
+        auto* src  = source.getReadPointer (chan);
+
+        if (channelGain == 1.0f)
+            FloatVectorOperations::add (dest, src, numSamples);
+        else if (channelGain != 0.0f)
+            FloatVectorOperations::addWithMultiply (dest, src, channelGain, numSamples);
+    }
+}
+
 void MixerAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
 {
-    const ScopedLock sl (lock);
+    ++callbackCount;
+
+    auto* list = activeList.load();
+    auto numChannels = info.buffer->getNumChannels();
+    bool outputWritten = false;
+
+    auto& jobs = list->jobs;
+    jobs.clearQuick();
+
+    for (auto* input : list->inputs)
+    {
+        input->updateTargets();
+        input->isParallelJob = list->renderThreads != nullptr
+                                 && input->renderInParallel.load (std::memory_order_relaxed);
+
+        if (input->isParallelJob)
+        {
+            input->scratch.setSize (jmax (1, numChannels), info.numSamples, false, false, true);
+            jobs.add (input);
+        }
+    }
+
+    if (! jobs.isEmpty())
+    {
+        // Publish the jobs for this block - the render threads and the audio thread all
+        // take them from the same queue, so it doesn't matter which thread gets there first.
+        currentJobs = jobs.begin();
+        currentJobNumSamples = info.numSamples;
+        numJobsDone = 0;
+
+        auto blockNumber = (uint32) (jobState.load() >> 32) + 1;
+        jobState.store (((uint64) blockNumber << 32) | ((uint64) jobs.size() << 16), std::memory_order_release);
+        list->renderThreads->wakeUp (jobs.size());
+    }
+
+    for (auto* input : list->inputs)
+    {
+        if (input->isParallelJob)
+            continue;
+
+        if (! outputWritten && input->hasUnityGain())
+        {
+            input->source->getNextAudioBlock (info);
+            outputWritten = true;
+            continue;
+        }
+
+        tempBuffer.setSize (jmax (1, numChannels), info.numSamples, false, false, true);
+        input->source->getNextAudioBlock (AudioSourceChannelInfo (&tempBuffer, 0, info.numSamples));
+
+        if (! outputWritten)
+        {
+            info.clearActiveBufferRegion();
+            outputWritten = true;
+        }
+
+        mixInput (*input, tempBuffer, info);
+    }
+
+    if (! jobs.isEmpty())
+    {
+        while (renderNextParallelJob())
+        {}
+
+        while (numJobsDone.load() < jobs.size())
+            Thread::yield();
+
+        if (! outputWritten)
+        {
+            info.clearActiveBufferRegion();
+            outputWritten = true;
+        }
+
+        // The parallel inputs are added in a fixed order, so the result doesn't depend on
+        // which threads rendered them
+        for (auto* job : jobs)
+            mixInput (*job, job->scratch, info);
+    }
+
+    if (! outputWritten)
+        info.clearActiveBufferRegion();
+
+    ++callbackCount;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class MixerAudioSourceTests  : public UnitTest
+{
+public:
+    MixerAudioSourceTests()  : UnitTest ("MixerAudioSource", "Audio") {}
 
-    if (inputs.size() > 0)
+    void runTest() override
     {
-        inputs.getUnchecked(0)->getNextAudioBlock (info);
+        beginTest ("Summing inputs");
+        {
+            MixerAudioSource mixer;
+            AudioBuffer<float> buffer (2, 64);
+            buffer.clear();
+            mixer.prepareToPlay (64, 44100.0);
+
+            buffer.setSample (0, 0, 1.0f);
+            render (mixer, buffer);
+            expect (buffer.getMagnitude (0, 64) == 0.0f);
+
+            mixer.addInputSource (new ConstantSource (0.1f), true);
+            mixer.addInputSource (new ConstantSource (0.2f), true);
+            mixer.addInputSource (new ConstantSource (0.3f), true);
+            render (mixer, buffer);
+            expectOutputIs (buffer, 0.6f, 0.6f);
+
+            mixer.releaseResources();
+        }
+
+        beginTest ("Gain and pan");
+        {
+            MixerAudioSource mixer;
+            ConstantSource a (1.0f), b (0.5f);
+            AudioBuffer<float> buffer (2, 64);
+
+            mixer.setRampLength (0.01);
+            mixer.prepareToPlay (64, 1000.0);
+            mixer.addInputSource (&a, false);
+            mixer.addInputSource (&b, false);
+
+            mixer.setInputGain (&a, 0.5f);
+            render (mixer, buffer);
+
+            // the gain change should be ramped over 10 samples
+            expect (buffer.getSample (0, 0) < 1.5f && buffer.getSample (0, 0) > 1.4f);
+            expect (buffer.getSample (0, 5) < 1.4f && buffer.getSample (0, 5) > 1.0f);
+            expectWithinAbsoluteError (buffer.getSample (0, 9), 1.0f, 1.0e-5f);
+            expectWithinAbsoluteError (buffer.getSample (0, 63), 1.0f, 1.0e-6f);
+
+            render (mixer, buffer);
+            expectOutputIs (buffer, 1.0f, 1.0f);
+
+            mixer.setInputPan (&b, -1.0f);
+            render (mixer, buffer);
+            render (mixer, buffer);
+            expectOutputIs (buffer, 1.0f, 0.5f);
+
+            mixer.setInputPan (&b, 0.5f);
+            render (mixer, buffer);
+            render (mixer, buffer);
+            expectOutputIs (buffer, 0.75f, 1.0f);
+
+            mixer.removeAllInputs();
+            mixer.releaseResources();
+        }
 
-        if (inputs.size() > 1)
+        beginTest ("Parallel rendering");
         {
-            tempBuffer.setSize (jmax (1, info.buffer->getNumChannels()),
-                                info.buffer->getNumSamples());
+            MixerAudioSource mixer;
+            AudioBuffer<float> buffer (2, 256);
+            OwnedArray<ConstantSource> sources;
+            float expected = 0.0f;
 
-            AudioSourceChannelInfo info2 (&tempBuffer, 0, info.numSamples);
+            mixer.setNumberOfRenderThreads (3);
+            mixer.prepareToPlay (256, 44100.0);
 
-            for (int i = 1; i < inputs.size(); ++i)
+            for (int i = 0; i < 16; ++i)
             {
-                inputs.getUnchecked(i)->getNextAudioBlock (info2);
+                auto value = (float) (i + 1) / 128.0f;
+                auto gain = (i % 3 == 0) ? 0.5f : 1.0f;
+                auto* source = sources.add (new ConstantSource (value, 2000));
+
+                mixer.addInputSource (source, false);
+                mixer.setInputGain (source, gain);
+                mixer.setInputRendersInParallel (source, (i & 1) == 0);
+                expected += value * gain;
+            }
+
+            for (int block = 0; block < 100; ++block)
+                render (mixer, buffer);
+
+            expectOutputIs (buffer, expected, expected);
+
+            mixer.setNumberOfRenderThreads (0);
+            render (mixer, buffer);
+            expectOutputIs (buffer, expected, expected);
+
+            mixer.removeAllInputs();
+            mixer.releaseResources();
+        }
+
+        beginTest ("Adding and removing inputs while playing");
+        {
+            MixerAudioSource mixer;
+            mixer.setNumberOfRenderThreads (2);
+            mixer.prepareToPlay (128, 44100.0);
 
-                for (int chan = 0; chan < info.buffer->getNumChannels(); ++chan)
-                    info.buffer->addFrom (chan, info.startSample, tempBuffer, chan, 0, info.numSamples);
+            std::atomic<int> numDeleted { 0 };
+            std::atomic<int> numDeletedWhileRendering { 0 };
+
+            {
+                AudioThread audioThread (mixer);
+                Random r (0x4d495845);
+
+                for (int i = 0; i < 500; ++i)
+                {
+                    auto* source = new ConstantSource (0.01f, 200);
+                    source->numDeleted = &numDeleted;
+                    source->numDeletedWhileRendering = &numDeletedWhileRendering;
+
+                    mixer.addInputSource (source, true);
+                    mixer.setInputRendersInParallel (source, r.nextBool());
+                    mixer.setInputGain (source, r.nextFloat());
+
+                    if (i % 3 == 0)
+                        mixer.removeInputSource (source);
+
+                    if (i % 50 == 49)
+                        mixer.removeAllInputs();
+                }
             }
+
+            mixer.removeAllInputs();
+            mixer.releaseResources();
+
+            expectEquals (numDeleted.load(), 500);
+            expectEquals (numDeletedWhileRendering.load(), 0);
         }
     }
-    else
+
+private:
+    struct ConstantSource  : public AudioSource
     {
-        info.clearActiveBufferRegion();
+        ConstantSource (float v, int work = 0)  : value (v), amountOfWork (work) {}
+
+        ~ConstantSource() override
+        {
+            if (numDeleted != nullptr)
+                ++*numDeleted;
+
+            if (isRendering && numDeletedWhileRendering != nullptr)
+                ++*numDeletedWhileRendering;
+        }
+
+        void prepareToPlay (int, double) override {}
+        void releaseResources() override {}
+
+        void getNextAudioBlock (const AudioSourceChannelInfo& info) override
+        {
+            isRendering = true;
+
+            for (int chan = 0; chan < info.buffer->getNumChannels(); ++chan)
+                FloatVectorOperations::fill (info.buffer->getWritePointer (chan, info.startSample),
+                                             value, info.numSamples);
+
+            // pretend that this is an expensive source..
+            auto x = 1.0;
+
+            for (int i = 0; i < amountOfWork; ++i)
+                x = std::sqrt (x + 1.0);
+
+            ignoreUnused (x);
+            isRendering = false;
+        }
+
+        const float value;
+        const int amountOfWork;
+        std::atomic<bool> isRendering { false };
+        std::atomic<int>* numDeleted = nullptr;
+        std::atomic<int>* numDeletedWhileRendering = nullptr;
+    };
+
+    struct AudioThread  : public Thread
+    {
+        AudioThread (MixerAudioSource& m)  : Thread ("Mixer test"), mixer (m)
+        {
+            startThread();
+        }
+
+        ~AudioThread() override
+        {
+            stopThread (4000);
+        }
+
+        void run() override
+        {
+            AudioBuffer<float> buffer (2, 128);
+
+            while (! threadShouldExit())
+                mixer.getNextAudioBlock (AudioSourceChannelInfo (buffer));
+        }
+
+        MixerAudioSource& mixer;
+    };
+
+    static void render (MixerAudioSource& mixer, AudioBuffer<float>& buffer)
+    {
+        mixer.getNextAudioBlock (AudioSourceChannelInfo (buffer));
     }
-}
+
+    void expectOutputIs (const AudioBuffer<float>& buffer, float left, float right)
+    {
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            expectWithinAbsoluteError (buffer.getSample (0, i), left, 1.0e-5f);
+            expectWithinAbsoluteError (buffer.getSample (1, i), right, 1.0e-5f);
+        }
+    }
+};
+
+static MixerAudioSourceTests mixerAudioSourceTests;
+
+#endif
 
 } // namespace juce
@@ -31,6 +31,15 @@ namespace juce
     prepareToPlay() and releaseResources() methods are called before and after adding
     them to the mixer.
 
+    The audio thread never has to wait for a lock: changes to the set of inputs are
+    made by building a new list and swapping it in, and the methods that remove inputs
+    wait until the audio thread has finished with the old list before they return.
+
+    Each input has a gain and a balance, which are smoothly ramped when they change. Inputs
+    that are expensive to render can be marked with setInputRendersInParallel(), and if
+    the mixer has some render threads (see setNumberOfRenderThreads()), these inputs will
+    be rendered at the same time as each other, and as the other inputs.
+
     @tags{Audio}
 */
 class JUCE_API  MixerAudioSource  : public AudioSource
@@ -60,6 +69,9 @@ public:
     /** Removes an input source.
         If the source was added by calling addInputSource() with the deleteWhenRemoved
         flag set, it will be deleted by this method.
+
+        This mustn't be called from inside the mixer's getNextAudioBlock() method, e.g.
+        by one of its inputs, because it waits for the audio thread to stop using the input.
     */
     void removeInputSource (AudioSource* input);
 
@@ -69,6 +81,38 @@ public:
     */
     void removeAllInputs();
 
+    //==============================================================================
+    /** Changes the gain that is applied to one of the inputs.
+        The change is ramped smoothly over the length set by setRampLength().
+    */
+    void setInputGain (AudioSource* input, float newGain);
+
+    /** Changes the balance of one of the inputs, from -1.0 (left) to 1.0 (right).
+
+        At 0, both channels are left at full level; moving towards one side gradually
+        turns the other channel down. This only affects the first two channels, and does
+        nothing if the mixer is producing a mono output.
+    */
+    void setInputPan (AudioSource* input, float newPan);
+
+    /** Marks an input as being expensive to render, e.g. a resampler or a decoder, so
+        that it'll be rendered on one of the mixer's render threads if it has any.
+        @see setNumberOfRenderThreads
+    */
+    void setInputRendersInParallel (AudioSource* input, bool shouldRenderInParallel);
+
+    /** Changes the time over which gain and pan changes are ramped. The default is 50ms. */
+    void setRampLength (double newLengthSeconds);
+
+    /** Sets the number of threads that will render the inputs that have been marked with
+        setInputRendersInParallel().
+
+        The audio thread helps to render these inputs too, so there's no point having more
+        threads than there are spare CPU cores. The default is 0, which means that all the
+        inputs are rendered by the audio thread.
+    */
+    void setNumberOfRenderThreads (int numThreads);
+
     //==============================================================================
     /** Implementation of the AudioSource method.
         This will call prepareToPlay() on all its input sources.
@@ -86,12 +130,30 @@ public:
 
 private:
     //==============================================================================
-    Array<AudioSource*> inputs;
-    BigInteger inputsToDelete;
+    struct Input;
+    struct InputList;
+    struct RenderThreads;
+    class RenderThread;
+
+    ReferenceCountedObjectPtr<InputList> inputList;
+    std::atomic<InputList*> activeList { nullptr };
+    std::atomic<uint32> callbackCount { 0 };
     CriticalSection lock;
-    AudioBuffer<float> tempBuffer;
-    double currentSampleRate;
-    int bufferSizeExpected;
+    AudioBuffer<float> tempBuffer, rampBuffer;
+    double currentSampleRate = 0, rampLengthSeconds = 0.05;
+    int bufferSizeExpected = 0;
+
+    // the parallel jobs for the current block: the job state holds a block counter,
+    // the number of jobs, and the index of the next job to be claimed
+    std::atomic<uint64> jobState { 0 };
+    std::atomic<int> numJobsDone { 0 };
+    Input* const* currentJobs = nullptr;
+    int currentJobNumSamples = 0;
+
+    Input* findInput (AudioSource*) const;
+    void publish (InputList*);
+    bool renderNextParallelJob();
+    void mixInput (Input&, const AudioBuffer<float>&, const AudioSourceChannelInfo&);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MixerAudioSource)
 };
@@ -27,15 +27,9 @@ ResamplingAudioSource::ResamplingAudioSource (AudioSource* const inputSource,
                                               const bool deleteInputWhenDeleted,
                                               const int channels)
     : input (inputSource, deleteInputWhenDeleted),
-      ratio (1.0),
-      lastRatio (1.0),
-      bufferPos (0),
-      sampsInBuffer (0),
-      subSampleOffset (0),
       numChannels (channels)
 {
     jassert (input != nullptr);
-    zeromem (coefficients, sizeof (coefficients));
 }
 
 ResamplingAudioSource::~ResamplingAudioSource() {}
@@ -44,10 +38,18 @@ void ResamplingAudioSource::setResamplingRatio (const double samplesInPerOutputS
 {
     jassert (samplesInPerOutputSample > 0);
 
+    // build the filter tables here, rather than on the audio thread
+    SincResampler::preloadCoefficients (quality, jmax (1.0e-6, samplesInPerOutputSample));
+
     const SpinLock::ScopedLockType sl (ratioLock);
     ratio = jmax (0.0, samplesInPerOutputSample);
 }
 
+void ResamplingAudioSource::setResamplingQuality (SincResampler::Quality newQuality)
+{
+    quality = newQuality;
+}
+
 void ResamplingAudioSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
 {
     const SpinLock::ScopedLockType sl (ratioLock);
@@ -55,12 +57,21 @@ void ResamplingAudioSource::prepareToPlay (int samplesPerBlockExpected, double s
     auto scaledBlockSize = roundToInt (samplesPerBlockExpected * ratio);
     input->prepareToPlay (scaledBlockSize, sampleRate * ratio);
 
-    buffer.setSize (numChannels, scaledBlockSize + 32);
+    resamplers.clear();
 
-    filterStates.calloc (numChannels);
-    srcBuffers.calloc (numChannels);
-    destBuffers.calloc (numChannels);
-    createLowPass (ratio);
+    for (int i = 0; i < numChannels; ++i)
+    {
+        auto* r = resamplers.add (new SincResampler (quality));
+        r->setRatio (ratio);
+    }
+
+    lastRatio = ratio;
+
+    unusedOutputSize = jmax (1, samplesPerBlockExpected);
+    unusedOutput.malloc ((size_t) unusedOutputSize);
+
+    if (numChannels > 0)
+        buffer.setSize (numChannels, scaledBlockSize + resamplers.getFirst()->getLookAhead() * 2 + 2);
 
     flushBuffers();
 }
@@ -68,10 +79,9 @@ void ResamplingAudioSource::prepareToPlay (int samplesPerBlockExpected, double s
 void ResamplingAudioSource::flushBuffers()
 {
     buffer.clear();
-    bufferPos = 0;
-    sampsInBuffer = 0;
-    subSampleOffset = 0.0;
-    resetFilters();
+
+    for (auto* r : resamplers)
+        r->reset();
 }
 
 void ResamplingAudioSource::releaseResources()
@@ -82,24 +92,6 @@ void ResamplingAudioSource::releaseResources()
 
 void ResamplingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
 {
-
-#if 0
-    // For temporarily disabling
-    AudioSourceChannelInfo readInfo (&buffer, 0, info.numSamples);
-    input->getNextAudioBlock (readInfo);
-
-    for (int i = 0; i < info.buffer->getNumChannels(); ++i)
-    {
-        if (i >= readInfo.buffer->getNumChannels())
-        {
-            break;
-        }
-        info.buffer->copyFrom (i, info.startSample, readInfo.buffer->getReadPointer (i), info.numSamples);
-    }
-    
-    return;
-#endif
-    
     double localRatio;
 
     {
@@ -107,178 +99,204 @@ void ResamplingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& inf
         localRatio = ratio;
     }
 
+    if (resamplers.isEmpty())
+    {
+        info.clearActiveBufferRegion();
+        return;
+    }
+
     if (lastRatio != localRatio)
     {
-        createLowPass (localRatio);
+        for (auto* r : resamplers)
+            r->setRatio (localRatio);
+
         lastRatio = localRatio;
     }
 
-    const int sampsNeeded = roundToInt (info.numSamples * localRatio) + 3;
+    // all the channels' resamplers are kept in step, so they'll all need the same input
+    auto sampsNeeded = resamplers.getFirst()->getNumInputSamplesNeeded (info.numSamples);
 
-    int bufferSize = buffer.getNumSamples();
+    if (buffer.getNumSamples() < sampsNeeded)
+        buffer.setSize (buffer.getNumChannels(), sampsNeeded + 32, false, false, true);
 
-    if (bufferSize < sampsNeeded + 8)
+    if (sampsNeeded > 0)
     {
-        bufferPos %= bufferSize;
-        bufferSize = sampsNeeded + 32;
-        buffer.setSize (buffer.getNumChannels(), bufferSize, true, true);
+        AudioSourceChannelInfo readInfo (&buffer, 0, sampsNeeded);
+        input->getNextAudioBlock (readInfo);
     }
 
-    bufferPos %= bufferSize;
-
-    int endOfBufferPos = bufferPos + sampsInBuffer;
     const int channelsToProcess = jmin (numChannels, info.buffer->getNumChannels());
 
-    while (sampsNeeded > sampsInBuffer)
+    for (int channel = 0; channel < numChannels; ++channel)
     {
-        endOfBufferPos %= bufferSize;
-
-        int numToDo = jmin (sampsNeeded - sampsInBuffer,
-                            bufferSize - endOfBufferPos);
-
-        AudioSourceChannelInfo readInfo (&buffer, endOfBufferPos, numToDo);
-        input->getNextAudioBlock (readInfo);
+        auto* resampler = resamplers.getUnchecked (channel);
+        auto* source = buffer.getReadPointer (channel);
 
-        if (localRatio > 1.0001)
+        if (channel < channelsToProcess)
         {
-            // for down-sampling, pre-apply the filter..
-
-            for (int i = channelsToProcess; --i >= 0;)
-                applyFilter (buffer.getWritePointer (i, endOfBufferPos), numToDo, filterStates[i]);
+            resampler->process (source, info.buffer->getWritePointer (channel, info.startSample), info.numSamples);
+        }
+        else
+        {
+            // a channel that isn't being used still has to keep up with the others, so it's
+            // resampled into a scratch buffer, in chunks if the block is bigger than expected
+            for (int done = 0; done < info.numSamples;)
+            {
+                auto num = jmin (unusedOutputSize, info.numSamples - done);
+                source += resampler->process (source, unusedOutput, num);
+                done += num;
+            }
         }
-
-        sampsInBuffer += numToDo;
-        endOfBufferPos += numToDo;
     }
+}
 
-    for (int channel = 0; channel < channelsToProcess; ++channel)
-    {
-        destBuffers[channel] = info.buffer->getWritePointer (channel, info.startSample);
-        srcBuffers[channel] = buffer.getReadPointer (channel);
-    }
+//==============================================================================
+#if JUCE_UNIT_TESTS
 
-    int nextPos = (bufferPos + 1) % bufferSize;
+class ResamplingAudioSourceTests  : public UnitTest
+{
+public:
+    ResamplingAudioSourceTests()  : UnitTest ("ResamplingAudioSource", "Audio") {}
 
-    for (int m = info.numSamples; --m >= 0;)
+    void runTest() override
     {
-        jassert (sampsInBuffer > 0 && nextPos != endOfBufferPos);
+        beginTest ("Channels that aren't being output");
+        {
+            // The second channel is skipped for the first half of the blocks, some of which are
+            // bigger than the prepared block size, but it should stay in step with the first.
+            TestSource referenceInput, input;
+            ResamplingAudioSource reference (&referenceInput, false), resampler (&input, false);
 
-        const float alpha = (float) subSampleOffset;
+            for (auto* r : { &reference, &resampler })
+            {
+                r->setResamplingRatio (1.2345678);
+                r->prepareToPlay (256, 44100.0);
+            }
 
-        for (int channel = 0; channel < channelsToProcess; ++channel)
-            *destBuffers[channel]++ = srcBuffers[channel][bufferPos]
-                                        + alpha * (srcBuffers[channel][nextPos] - srcBuffers[channel][bufferPos]);
+            AudioBuffer<float> expected (2, 1000), stereo (2, 1000), mono (1, 1000);
+            auto random = getRandom();
 
-        subSampleOffset += localRatio;
+            for (int block = 0; block < 40; ++block)
+            {
+                auto numSamples = random.nextInt (1000) + 1;
+                auto skipSecondChannel = block < 20;
+                auto& output = skipSecondChannel ? mono : stereo;
 
-        while (subSampleOffset >= 1.0)
-        {
-            if (++bufferPos >= bufferSize)
-                bufferPos = 0;
+                reference.getNextAudioBlock (AudioSourceChannelInfo (&expected, 0, numSamples));
+                resampler.getNextAudioBlock (AudioSourceChannelInfo (&output, 0, numSamples));
 
-            --sampsInBuffer;
+                for (int chan = 0; chan < output.getNumChannels(); ++chan)
+                    expect (memcmp (output.getReadPointer (chan), expected.getReadPointer (chan),
+                                    (size_t) numSamples * sizeof (float)) == 0);
+            }
 
-            nextPos = (bufferPos + 1) % bufferSize;
-            subSampleOffset -= 1.0;
+            expect (input.position == referenceInput.position);
         }
-    }
 
-    if (localRatio < 0.9999)
-    {
-        // for up-sampling, apply the filter after transposing..
-        for (int i = channelsToProcess; --i >= 0;)
-            applyFilter (info.buffer->getWritePointer (i, info.startSample), info.numSamples, filterStates[i]);
-    }
-    else if (localRatio <= 1.0001 && info.numSamples > 0)
-    {
-        // if the filter's not currently being applied, keep it stoked with the last couple of samples to avoid discontinuities
-        for (int i = channelsToProcess; --i >= 0;)
+        beginTest ("Changing the ratio while running");
         {
-            const float* const endOfBuffer = info.buffer->getReadPointer (i, info.startSample + info.numSamples - 1);
-            FilterState& fs = filterStates[i];
+            // Resampling a constant level should give the same level, whatever the ratio is
+            // and however often it changes.
+            TestSource input (0.5f);
+            ResamplingAudioSource resampler (&input, false, 1);
+            resampler.prepareToPlay (512, 44100.0);
 
-            if (info.numSamples > 1)
-            {
-                fs.y2 = fs.x2 = *(endOfBuffer - 1);
-            }
-            else
+            AudioBuffer<float> output (1, 512);
+            double expectedNumInputSamples = 0;
+
+            for (int block = 0; block < 60; ++block)
             {
-                fs.y2 = fs.y1;
-                fs.x2 = fs.x1;
+                auto ratio = block < 20 ? 1.0 : (block < 40 ? 2.13 : 0.61);
+
+                if (block % 20 == 0)
+                {
+                    resampler.setResamplingRatio (ratio);
+                    expectEquals (resampler.getResamplingRatio(), ratio);
+                }
+
+                resampler.getNextAudioBlock (AudioSourceChannelInfo (&output, 0, 512));
+                expectedNumInputSamples += 512 * ratio;
+
+                // (the first block starts with the silence that's in the filter before the input arrives)
+                if (block > 0)
+                    expect (isConstant (output, 0.5f));
             }
 
-            fs.y1 = fs.x1 = *endOfBuffer;
+            SincResampler defaultResampler;
+            expect (std::abs (input.position - expectedNumInputSamples) <= defaultResampler.getLookAhead() + 2);
         }
-    }
 
-    jassert (sampsInBuffer >= 0);
-}
+        beginTest ("Changing the quality");
+        {
+            TestSource input (0.5f);
+            ResamplingAudioSource resampler (&input, false, 1);
+            expect (resampler.getResamplingQuality() == SincResampler::Quality::high);
 
-void ResamplingAudioSource::createLowPass (const double frequencyRatio)
-{
-    const double proportionalRate = (frequencyRatio > 1.0) ? 0.5 / frequencyRatio
-                                                           : 0.5 * frequencyRatio;
-
-    const double n = 1.0 / std::tan (MathConstants<double>::pi * jmax (0.001, proportionalRate));
-    const double nSquared = n * n;
-    const double c1 = 1.0 / (1.0 + MathConstants<double>::sqrt2 * n + nSquared);
-
-    setFilterCoefficients (c1,
-                           c1 * 2.0f,
-                           c1,
-                           1.0,
-                           c1 * 2.0 * (1.0 - nSquared),
-                           c1 * (1.0 - MathConstants<double>::sqrt2 * n + nSquared));
-}
+            resampler.setResamplingRatio (1.5);
+            resampler.prepareToPlay (512, 44100.0);
 
-void ResamplingAudioSource::setFilterCoefficients (double c1, double c2, double c3, double c4, double c5, double c6)
-{
-    const double a = 1.0 / c4;
-
-    c1 *= a;
-    c2 *= a;
-    c3 *= a;
-    c5 *= a;
-    c6 *= a;
-
-    coefficients[0] = c1;
-    coefficients[1] = c2;
-    coefficients[2] = c3;
-    coefficients[3] = c4;
-    coefficients[4] = c5;
-    coefficients[5] = c6;
-}
+            AudioBuffer<float> output (1, 512);
 
-void ResamplingAudioSource::resetFilters()
-{
-    if (filterStates != nullptr)
-        filterStates.clear ((size_t) numChannels);
-}
+            for (int block = 0; block < 4; ++block)
+                resampler.getNextAudioBlock (AudioSourceChannelInfo (&output, 0, 512));
 
-void ResamplingAudioSource::applyFilter (float* samples, int num, FilterState& fs)
-{
-    while (--num >= 0)
+            expect (isConstant (output, 0.5f));
+
+            // the new quality is used once the source has been prepared again..
+            resampler.setResamplingQuality (SincResampler::Quality::low);
+            expect (resampler.getResamplingQuality() == SincResampler::Quality::low);
+
+            resampler.prepareToPlay (512, 44100.0);
+            input.position = 0;
+            resampler.getNextAudioBlock (AudioSourceChannelInfo (&output, 0, 512));
+
+            SincResampler lowQuality (SincResampler::Quality::low);
+            lowQuality.setRatio (1.5);
+            expectEquals ((int) input.position, lowQuality.getNumInputSamplesNeeded (512));
+
+            for (int block = 0; block < 3; ++block)
+                resampler.getNextAudioBlock (AudioSourceChannelInfo (&output, 0, 512));
+
+            expect (isConstant (output, 0.5f));
+        }
+    }
+
+private:
+    // Produces a different sine on each channel, or a constant level if one is given.
+    struct TestSource  : public AudioSource
     {
-        const double in = *samples;
+        TestSource (float constantLevel = 0)  : level (constantLevel) {}
+
+        void prepareToPlay (int, double) override {}
+        void releaseResources() override {}
 
-        double out = coefficients[0] * in
-                     + coefficients[1] * fs.x1
-                     + coefficients[2] * fs.x2
-                     - coefficients[4] * fs.y1
-                     - coefficients[5] * fs.y2;
+        void getNextAudioBlock (const AudioSourceChannelInfo& info) override
+        {
+            for (int chan = 0; chan < info.buffer->getNumChannels(); ++chan)
+            {
+                auto* dest = info.buffer->getWritePointer (chan, info.startSample);
 
-       #if JUCE_INTEL
-        if (! (out < -1.0e-8 || out > 1.0e-8))
-            out = 0;
-       #endif
+                for (int i = 0; i < info.numSamples; ++i)
+                    dest[i] = level != 0 ? level
+                                         : (float) std::sin ((double) (position + i) * 0.01 * (chan + 1));
+            }
+
+            position += info.numSamples;
+        }
 
-        fs.x2 = fs.x1;
-        fs.x1 = in;
-        fs.y2 = fs.y1;
-        fs.y1 = out;
+        float level;
+        int64 position = 0;
+    };
 
-        *samples++ = (float) out;
+    static bool isConstant (const AudioBuffer<float>& buffer, float level)
+    {
+        auto range = buffer.findMinMax (0, 0, buffer.getNumSamples());
+        return std::abs (range.getStart() - level) < 1.0e-3f && std::abs (range.getEnd() - level) < 1.0e-3f;
     }
-}
+};
+
+static ResamplingAudioSourceTests resamplingAudioSourceTests;
+
+#endif
 
 } // namespace juce
@@ -27,7 +27,10 @@ namespace juce
 /**
     A type of AudioSource that takes an input source and changes its sample rate.
 
-    @see AudioSource, LagrangeInterpolator, CatmullRomInterpolator
+    Each channel is converted with a SincResampler, whose quality can be chosen
+    with setResamplingQuality().
+
+    @see AudioSource, SincResampler, LagrangeInterpolator, CatmullRomInterpolator
 
     @tags{Audio}
 */
@@ -65,6 +68,19 @@ public:
     */
     double getResamplingRatio() const noexcept                  { return ratio; }
 
+    /** Changes the quality of the filter that's used for resampling.
+
+        Higher qualities use more CPU, and need to read a little further ahead from the
+        input source. The default is SincResampler::Quality::high.
+
+        This can be called from any thread, but the new setting only takes effect the
+        next time prepareToPlay() is called.
+    */
+    void setResamplingQuality (SincResampler::Quality newQuality);
+
+    /** Returns the quality setting that was set by setResamplingQuality(). */
+    SincResampler::Quality getResamplingQuality() const noexcept    { return quality; }
+
     /** Clears any buffers and filters that the resampler is using. */
     void flushBuffers();
 
@@ -76,28 +92,14 @@ public:
 private:
     //==============================================================================
     OptionalScopedPointer<AudioSource> input;
-    double ratio, lastRatio;
+    double ratio = 1.0, lastRatio = 1.0;
+    std::atomic<SincResampler::Quality> quality { SincResampler::Quality::high };
     AudioBuffer<float> buffer;
-    int bufferPos, sampsInBuffer;
-    double subSampleOffset;
-    double coefficients[6];
+    OwnedArray<SincResampler> resamplers;
+    HeapBlock<float> unusedOutput;
+    int unusedOutputSize = 0;
     SpinLock ratioLock;
     const int numChannels;
-    HeapBlock<float*> destBuffers;
-    HeapBlock<const float*> srcBuffers;
-
-    void setFilterCoefficients (double c1, double c2, double c3, double c4, double c5, double c6);
-    void createLowPass (double proportionalRate);
-
-    struct FilterState
-    {
-        double x1, x2, y1, y2;
-    };
-
-    HeapBlock<FilterState> filterStates;
-    void resetFilters();
-
-    void applyFilter (float* samples, int num, FilterState& fs);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ResamplingAudioSource)
 };
@@ -0,0 +1,705 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+namespace StreamingAudioSourceHelpers
+{
+    enum
+    {
+        maxChunkSize    = 8192,     // the most that a worker will read from a source in one go
+        minChunkSize    = 2048,     // streams aren't topped up until at least this much space is free
+        idleWaitMs      = 10        // how long the workers wait before polling again when there's nothing to do
+    };
+}
+
+//==============================================================================
+class AudioStreamingEngine::Worker  : public Thread
+{
+public:
+    Worker (AudioStreamingEngine& e, int index)
+        : Thread ("Audio streaming " + String (index + 1)), engine (e)
+    {
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+            if (! engine.readNextChunk())
+                engine.workAvailable.wait (StreamingAudioSourceHelpers::idleWaitMs);
+    }
+
+private:
+    AudioStreamingEngine& engine;
+
+    JUCE_DECLARE_NON_COPYABLE (Worker)
+};
+
+//==============================================================================
+AudioStreamingEngine::AudioStreamingEngine (int numberOfWorkerThreads, int workerThreadPriority)
+{
+    jassert (numberOfWorkerThreads > 0);
+
+    for (int i = 0; i < jmax (1, numberOfWorkerThreads); ++i)
+        workers.add (new Worker (*this, i))->startThread (workerThreadPriority);
+}
+
+AudioStreamingEngine::~AudioStreamingEngine()
+{
+    // All the StreamingAudioSources that use this engine must be deleted before it is!
+    jassert (streams.isEmpty());
+
+    for (auto* w : workers)
+        w->signalThreadShouldExit();
+
+    for (auto* w : workers)
+        w->stopThread (4000);
+}
+
+int AudioStreamingEngine::getNumWorkerThreads() const noexcept
+{
+    return workers.size();
+}
+
+void AudioStreamingEngine::addStream (StreamingAudioSource& stream)
+{
+    {
+        const ScopedLock sl (lock);
+        streams.addIfNotAlreadyThere (&stream);
+    }
+
+    workAvailable.signal();
+}
+
+void AudioStreamingEngine::removeStream (StreamingAudioSource& stream)
+{
+    {
+        const ScopedLock sl (lock);
+        streams.removeFirstMatchingValue (&stream);
+    }
+
+    // it can't be claimed again now, but a worker may still be in the middle of reading it
+    while (stream.isBeingFilled)
+        Thread::sleep (1);
+}
+
+bool AudioStreamingEngine::readNextChunk()
+{
+    StreamingAudioSource* mostUrgent = nullptr;
+    int numWaiting = 0;
+
+    {
+        const ScopedLock sl (lock);
+        double lowestLevel = 0;
+
+        for (auto* s : streams)
+        {
+            double secondsBuffered = 0;
+
+            if (! s->isBeingFilled && s->needsFilling (secondsBuffered))
+            {
+                ++numWaiting;
+
+                if (mostUrgent == nullptr || secondsBuffered < lowestLevel)
+                {
+                    mostUrgent = s;
+                    lowestLevel = secondsBuffered;
+                }
+            }
+        }
+
+        if (mostUrgent == nullptr)
+            return false;
+
+        mostUrgent->isBeingFilled = true;
+    }
+
+    // if there's more to do, another worker can get on with it while this one is busy
+    if (numWaiting > 1)
+        workAvailable.signal();
+
+    auto didRead = mostUrgent->readNextChunk();
+    mostUrgent->isBeingFilled = false;
+
+    if (didRead)
+        ++numChunksRead;
+
+    return didRead;
+}
+
+AudioStreamingEngine::Statistics AudioStreamingEngine::getStatistics() const
+{
+    Statistics stats;
+    stats.numChunksRead = numChunksRead;
+
+    const ScopedLock sl (lock);
+    stats.numStreams = streams.size();
+
+    for (auto* s : streams)
+    {
+        stats.numUnderruns += s->numUnderruns;
+        stats.numSamplesMissed += s->numSamplesMissed;
+        stats.lowestBufferLevel = jmin (stats.lowestBufferLevel, s->lowestBufferLevel.load());
+    }
+
+    return stats;
+}
+
+void AudioStreamingEngine::resetStatistics()
+{
+    numChunksRead = 0;
+
+    const ScopedLock sl (lock);
+
+    for (auto* s : streams)
+        s->resetStatistics();
+}
+
+//==============================================================================
+StreamingAudioSource::StreamingAudioSource (PositionableAudioSource* s,
+                                            AudioStreamingEngine& e,
+                                            bool deleteSourceWhenDeleted,
+                                            int bufferSizeSamples,
+                                            int numChannels,
+                                            bool prefillBufferOnPrepareToPlay)
+    : source (s, deleteSourceWhenDeleted),
+      engine (e),
+      numberOfSamplesToBuffer (jmax (1024, bufferSizeSamples)),
+      numberOfChannels (numChannels),
+      prefillBuffer (prefillBufferOnPrepareToPlay)
+{
+    jassert (source != nullptr);
+
+    jassert (numberOfSamplesToBuffer > 1024); // not much point using this class if you're
+                                              //  not using a larger buffer..
+}
+
+StreamingAudioSource::~StreamingAudioSource()
+{
+    releaseResources();
+}
+
+//==============================================================================
+void StreamingAudioSource::prepareToPlay (int samplesPerBlockExpected, double newSampleRate)
+{
+    auto bufferSizeNeeded = jmax (samplesPerBlockExpected * 2, numberOfSamplesToBuffer);
+
+    if (newSampleRate != sampleRate
+         || bufferSizeNeeded != buffer.getNumSamples()
+         || ! isPrepared)
+    {
+        engine.removeStream (*this);
+
+        isPrepared = true;
+        sampleRate = newSampleRate;
+
+        source->prepareToPlay (samplesPerBlockExpected, newSampleRate);
+
+        buffer.setSize (numberOfChannels, bufferSizeNeeded);
+        buffer.clear();
+
+        validStart = 0;
+        validEnd = 0;
+        bufferGeneration = seekGeneration - 1; // makes the engine start again from the current position
+
+        engine.addStream (*this);
+
+        if (prefillBuffer)
+        {
+            auto numToPrefill = jmin (((int) newSampleRate) / 4, buffer.getNumSamples() / 2);
+
+            while (! isRangeReady (getPositionToReadFrom(), numToPrefill))
+                bufferReadyEvent.wait (StreamingAudioSourceHelpers::idleWaitMs);
+        }
+    }
+}
+
+void StreamingAudioSource::releaseResources()
+{
+    isPrepared = false;
+    engine.removeStream (*this);
+
+    buffer.setSize (numberOfChannels, 0);
+    source->releaseResources();
+}
+
+void StreamingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
+{
+    auto generation = seekGeneration.load();
+    auto pos = playPosition.load();
+
+    if (generation != playGeneration.load())
+    {
+        pos = seekPosition.load();
+        playPosition = pos;
+        playGeneration = generation;
+    }
+
+    auto bufferSize = buffer.getNumSamples();
+    auto end = pos;
+    int validFrom = 0, validTo = 0;
+
+    if (bufferSize > 0 && bufferGeneration.load() == generation)
+    {
+        auto start = validStart.load();
+        end = validEnd.load();
+
+        validFrom = (int) (jlimit (start, end, pos) - pos);
+        validTo   = (int) (jlimit (start, end, pos + info.numSamples) - pos);
+
+        if (validFrom < validTo)
+        {
+            auto startIndex = (int) ((pos + validFrom) % bufferSize);
+            auto numBeforeWrap = jmin (validTo - validFrom, bufferSize - startIndex);
+
+            // This copies the raw data rather than using AudioBuffer::copyFrom(), which would
+            // read the isClear flag that the engine's threads set when they write to the buffer
+            for (int chan = jmin (numberOfChannels, info.buffer->getNumChannels()); --chan >= 0;)
+            {
+                auto* dest = info.buffer->getWritePointer (chan, info.startSample + validFrom);
+                auto* src = buffer.getReadPointer (chan);
+
+                FloatVectorOperations::copy (dest, src + startIndex, numBeforeWrap);
+
+                if (numBeforeWrap < validTo - validFrom)
+                    FloatVectorOperations::copy (dest + numBeforeWrap, src, validTo - validFrom - numBeforeWrap);
+            }
+
+            // if a seek made the engine start refilling the buffer while we were
+            // copying it, the data can't be trusted
+            if (bufferGeneration.load() != generation)
+                validFrom = validTo = 0;
+        }
+    }
+
+    if (validFrom >= validTo)
+    {
+        info.clearActiveBufferRegion();
+    }
+    else
+    {
+        if (validFrom > 0)
+            info.buffer->clear (info.startSample, validFrom);
+
+        if (validTo < info.numSamples)
+            info.buffer->clear (info.startSample + validTo, info.numSamples - validTo);
+    }
+
+    // Samples before the start, or beyond the end of a source that isn't looping, are
+    // meant to be silent - any others that are missing weren't read in time.
+    auto wantedFrom = (int) (jmax ((int64) 0, pos) - pos);
+    auto wantedTo = isLooping() ? info.numSamples
+                                : (int) (jlimit (pos, pos + info.numSamples, getTotalLength()) - pos);
+
+    auto numWanted = jmax (0, wantedTo - wantedFrom);
+    auto numMissed = numWanted - jmax (0, jmin (wantedTo, validTo) - jmax (wantedFrom, validFrom));
+
+    if (numMissed > 0)
+    {
+        ++numUnderruns;
+        numSamplesMissed += numMissed;
+    }
+
+    if (bufferSize > 0)
+    {
+        auto level = (float) jmax ((int64) 0, end - (pos + info.numSamples)) / (float) bufferSize;
+
+        if (level < lowestBufferLevel.load())
+            lowestBufferLevel = level;
+    }
+
+    // like a BufferingAudioSource, this waits for the data rather than skipping
+    // over it if none of it has arrived yet
+    if (validFrom < validTo || numMissed == 0)
+        playPosition = pos + info.numSamples;
+}
+
+bool StreamingAudioSource::isRangeReady (int64 start, int numSamples) const
+{
+    auto wantedStart = jmax ((int64) 0, start);
+    auto wantedEnd = start + numSamples;
+
+    if (! isLooping())
+        wantedEnd = jmin (wantedEnd, getTotalLength());
+
+    if (wantedEnd <= wantedStart)
+        return true;
+
+    return bufferGeneration.load() == seekGeneration.load()
+            && validStart.load() <= wantedStart
+            && validEnd.load() >= wantedEnd;
+}
+
+bool StreamingAudioSource::waitForNextAudioBlockReady (const AudioSourceChannelInfo& info, uint32 timeout)
+{
+    if (source == nullptr || source->getTotalLength() <= 0)
+        return false;
+
+    auto startTime = Time::getMillisecondCounter();
+
+    for (;;)
+    {
+        if (isRangeReady (getPositionToReadFrom(), info.numSamples))
+            return true;
+
+        auto elapsed = Time::getMillisecondCounter() - startTime;
+
+        if (elapsed >= timeout)
+            return false;
+
+        bufferReadyEvent.wait ((int) (timeout - elapsed));
+    }
+}
+
+//==============================================================================
+int64 StreamingAudioSource::getPositionToReadFrom() const noexcept
+{
+    return seekGeneration.load() != playGeneration.load() ? seekPosition.load()
+                                                          : playPosition.load();
+}
+
+int64 StreamingAudioSource::getNextReadPosition() const
+{
+    auto pos = getPositionToReadFrom();
+    auto length = source->getTotalLength();
+
+    return (source->isLooping() && pos > 0 && length > 0) ? pos % length
+                                                          : pos;
+}
+
+void StreamingAudioSource::setNextReadPosition (int64 newPosition)
+{
+    seekPosition = newPosition;
+    ++seekGeneration;
+
+    engine.workAvailable.signal();
+}
+
+float StreamingAudioSource::getBufferLevel() const noexcept
+{
+    auto bufferSize = buffer.getNumSamples();
+
+    if (bufferSize == 0 || bufferGeneration.load() != seekGeneration.load())
+        return 0.0f;
+
+    auto numAhead = validEnd.load() - jmax ((int64) 0, getPositionToReadFrom());
+    return jlimit (0.0f, 1.0f, (float) numAhead / (float) bufferSize);
+}
+
+void StreamingAudioSource::resetStatistics() noexcept
+{
+    numUnderruns = 0;
+    numSamplesMissed = 0;
+    lowestBufferLevel = 1.0f;
+}
+
+//==============================================================================
+bool StreamingAudioSource::needsFilling (double& secondsBuffered) const
+{
+    auto bufferSize = buffer.getNumSamples();
+
+    if (bufferSize == 0)
+        return false;
+
+    auto target = jmax ((int64) 0, getPositionToReadFrom());
+    auto end = validEnd.load();
+
+    if (bufferGeneration.load() != seekGeneration.load()
+         || wasSourceLooping != isLooping()
+         || end < target)
+    {
+        secondsBuffered = 0;
+        return true;
+    }
+
+    if (! isLooping() && end >= getTotalLength())
+        return false;
+
+    secondsBuffered = (double) (end - target) / jmax (1.0, sampleRate);
+    return target + bufferSize - end >= jmin ((int) StreamingAudioSourceHelpers::minChunkSize, bufferSize / 4);
+}
+
+bool StreamingAudioSource::readNextChunk()
+{
+    auto bufferSize = buffer.getNumSamples();
+    auto generation = seekGeneration.load();
+    auto target = jmax ((int64) 0, getPositionToReadFrom());
+    auto looping = isLooping();
+
+    if (bufferGeneration.load() != generation || looping != wasSourceLooping)
+    {
+        wasSourceLooping = looping;
+        validEnd = target;
+        validStart = target;
+        bufferGeneration = generation;
+    }
+
+    auto start = validStart.load();
+    auto end = validEnd.load();
+
+    if (end < target)
+    {
+        // the audio thread has overtaken the buffer, so skip to where it's got to
+        validEnd = target;
+        validStart = target;
+        start = end = target;
+    }
+
+    auto numToRead = (int) jmin ((int64) StreamingAudioSourceHelpers::maxChunkSize, target + bufferSize - end);
+
+    if (! looping)
+        numToRead = (int) jmin ((int64) numToRead, getTotalLength() - end);
+
+    if (numToRead <= 0)
+        return false;
+
+    auto newEnd = end + numToRead;
+
+    // the slots that are about to be overwritten only held samples that have already been played
+    validStart = jmax (start, newEnd - bufferSize);
+
+    auto bufferIndex = (int) (end % bufferSize);
+    auto numBeforeWrap = jmin (numToRead, bufferSize - bufferIndex);
+
+    readBufferSection (end, numBeforeWrap, bufferIndex);
+
+    if (numBeforeWrap < numToRead)
+        readBufferSection (end + numBeforeWrap, numToRead - numBeforeWrap, 0);
+
+    validEnd = newEnd;
+    bufferReadyEvent.signal();
+    return true;
+}
+
+void StreamingAudioSource::readBufferSection (int64 start, int length, int bufferOffset)
+{
+    if (source->getNextReadPosition() != start)
+        source->setNextReadPosition (start);
+
+    AudioSourceChannelInfo info (&buffer, bufferOffset, length);
+    source->getNextAudioBlock (info);
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class StreamingAudioSourceTests  : public UnitTest
+{
+public:
+    StreamingAudioSourceTests()  : UnitTest ("StreamingAudioSource", "Audio") {}
+
+    void runTest() override
+    {
+        beginTest ("Reading many streams");
+        {
+            AudioStreamingEngine engine (3);
+            OwnedArray<StreamingAudioSource> streams;
+            Array<int64> positions;
+
+            for (int i = 0; i < 24; ++i)
+            {
+                streams.add (new StreamingAudioSource (new TestSource (300000, false), engine, true, 16384));
+                streams.getLast()->setNextReadPosition (i * 1000);
+                streams.getLast()->prepareToPlay (512, 44100.0);
+                positions.add (i * 1000);
+            }
+
+            AudioBuffer<float> block (2, 512);
+
+            for (int n = 0; n < 200; ++n)
+            {
+                for (int i = 0; i < streams.size(); ++i)
+                {
+                    AudioSourceChannelInfo info (&block, 0, 512);
+                    expect (streams[i]->waitForNextAudioBlockReady (info, 5000));
+                    streams[i]->getNextAudioBlock (info);
+                    expect (matches (block, 0, 512, positions[i], 300000, false));
+
+                    positions.set (i, positions[i] + 512);
+                    expectEquals (streams[i]->getNextReadPosition(), positions[i]);
+                }
+            }
+
+            auto stats = engine.getStatistics();
+            expectEquals (stats.numStreams, streams.size());
+            expectEquals (stats.numUnderruns, 0);
+            expect (stats.numChunksRead > 0);
+
+            streams.clear();
+            expectEquals (engine.getStatistics().numStreams, 0);
+        }
+
+        beginTest ("Seeking");
+        {
+            AudioStreamingEngine engine (2);
+            StreamingAudioSource stream (new TestSource (100000, false), engine, true, 8192);
+            stream.prepareToPlay (256, 48000.0);
+
+            AudioBuffer<float> block (2, 300);
+            auto random = getRandom();
+
+            for (int n = 0; n < 100; ++n)
+            {
+                auto pos = (int64) random.nextInt (110000) - 5000;
+                stream.setNextReadPosition (pos);
+                expectEquals (stream.getNextReadPosition(), pos);
+
+                for (int i = 0; i < 5; ++i)
+                {
+                    AudioSourceChannelInfo info (&block, 0, 300);
+                    expect (stream.waitForNextAudioBlockReady (info, 5000));
+                    stream.getNextAudioBlock (info);
+                    expect (matches (block, 0, 300, pos, 100000, false));
+                    pos += 300;
+                }
+
+                expectEquals (stream.getNextReadPosition(), pos);
+            }
+
+            expectEquals (stream.getNumUnderruns(), 0);
+        }
+
+        beginTest ("Looping");
+        {
+            AudioStreamingEngine engine (1);
+            StreamingAudioSource stream (new TestSource (5000, true), engine, true, 4096);
+            stream.prepareToPlay (512, 44100.0);
+
+            AudioBuffer<float> block (2, 700);
+            int64 pos = 0;
+
+            for (int n = 0; n < 50; ++n)
+            {
+                AudioSourceChannelInfo info (&block, 0, 700);
+                expect (stream.waitForNextAudioBlockReady (info, 5000));
+                stream.getNextAudioBlock (info);
+                expect (matches (block, 0, 700, pos, 5000, true));
+                pos += 700;
+                expectEquals (stream.getNextReadPosition(), pos % 5000);
+            }
+        }
+
+        beginTest ("Underruns");
+        {
+            AudioStreamingEngine engine (1);
+            auto* slowSource = new TestSource (1000000, false);
+            StreamingAudioSource stream (slowSource, engine, true, 32768, 2, false);
+            stream.prepareToPlay (512, 44100.0);
+
+            AudioBuffer<float> block (2, 512);
+            AudioSourceChannelInfo info (&block, 0, 512);
+
+            slowSource->delayMs = 200;
+            stream.setNextReadPosition (500000);
+            stream.getNextAudioBlock (info);
+
+            // nothing could have been read yet, so this should be silent, and the position shouldn't move
+            expectEquals (block.getMagnitude (0, 512), 0.0f);
+            expectEquals (stream.getNumUnderruns(), 1);
+            expectEquals (stream.getNumSamplesMissed(), (int64) 512);
+            expectEquals (stream.getNextReadPosition(), (int64) 500000);
+
+            slowSource->delayMs = 0;
+            expect (stream.waitForNextAudioBlockReady (info, 5000));
+            stream.getNextAudioBlock (info);
+            expect (matches (block, 0, 512, 500000, 1000000, false));
+
+            stream.resetStatistics();
+            expectEquals (stream.getNumUnderruns(), 0);
+        }
+    }
+
+private:
+    struct TestSource  : public PositionableAudioSource
+    {
+        TestSource (int64 len, bool loop)  : length (len), looping (loop) {}
+
+        static float getSample (int64 pos, int channel) noexcept
+        {
+            return (float) (pos % 10007) + (float) channel * 20000.0f;
+        }
+
+        void prepareToPlay (int, double) override   {}
+        void releaseResources() override            {}
+
+        void getNextAudioBlock (const AudioSourceChannelInfo& info) override
+        {
+            if (delayMs > 0)
+                Thread::sleep (delayMs);
+
+            for (int ch = 0; ch < info.buffer->getNumChannels(); ++ch)
+            {
+                auto* dest = info.buffer->getWritePointer (ch, info.startSample);
+
+                for (int i = 0; i < info.numSamples; ++i)
+                {
+                    auto p = position + i;
+
+                    if (looping)
+                        p %= length;
+
+                    dest[i] = (p >= 0 && p < length) ? getSample (p, ch) : 0.0f;
+                }
+            }
+
+            position += info.numSamples;
+        }
+
+        void setNextReadPosition (int64 newPosition) override   { position = newPosition; }
+        int64 getNextReadPosition() const override              { return position; }
+        int64 getTotalLength() const override                   { return length; }
+        bool isLooping() const override                         { return looping; }
+
+        int64 position = 0, length;
+        bool looping;
+        std::atomic<int> delayMs { 0 };
+    };
+
+    static bool matches (const AudioBuffer<float>& block, int start, int num, int64 pos, int64 length, bool looping)
+    {
+        for (int ch = 0; ch < block.getNumChannels(); ++ch)
+        {
+            for (int i = 0; i < num; ++i)
+            {
+                auto p = pos + i;
+
+                if (looping)
+                    p %= length;
+
+                auto expected = (p >= 0 && p < length) ? TestSource::getSample (p, ch) : 0.0f;
+
+                if (block.getSample (ch, start + i) != expected)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+static StreamingAudioSourceTests streamingAudioSourceTests;
+
+#endif
+
+} // namespace juce
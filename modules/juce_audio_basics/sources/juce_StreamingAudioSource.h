@@ -0,0 +1,233 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+class StreamingAudioSource;
+
+//==============================================================================
+/**
+    A pool of background threads that read ahead for a set of StreamingAudioSources.
+
+    Each worker thread repeatedly picks whichever stream has the least audio buffered
+    ahead of its read position, and reads the next chunk of it, so the streams that are
+    closest to running dry always get served first. Any number of StreamingAudioSources
+    can share one engine, and using more than one worker thread lets slow reads (e.g.
+    from a disk that's busy, or a compressed format) overlap with each other.
+
+    @see StreamingAudioSource
+
+    @tags{Audio}
+*/
+class JUCE_API  AudioStreamingEngine
+{
+public:
+    //==============================================================================
+    /** Creates an engine and starts its worker threads.
+
+        @param numberOfWorkerThreads    the number of threads to read with
+        @param workerThreadPriority     the priority of the threads, from 0 to 10 - see Thread::startThread()
+    */
+    explicit AudioStreamingEngine (int numberOfWorkerThreads = 2,
+                                   int workerThreadPriority = 7);
+
+    /** Destructor.
+        All the StreamingAudioSources that use this engine must be deleted before it is.
+    */
+    ~AudioStreamingEngine();
+
+    /** Returns the number of worker threads that the engine is using. */
+    int getNumWorkerThreads() const noexcept;
+
+    //==============================================================================
+    /** Some statistics about how well the engine has been keeping up.
+        @see getStatistics
+    */
+    struct Statistics
+    {
+        int numStreams = 0;             /**< The number of sources that are currently using the engine. */
+        int numUnderruns = 0;           /**< The number of audio blocks that couldn't be completely filled. */
+        int64 numSamplesMissed = 0;     /**< The total number of samples that were replaced by silence. */
+        int64 numChunksRead = 0;        /**< The number of reads that the worker threads have done. */
+        float lowestBufferLevel = 1.0f; /**< The smallest proportion of its buffer that any stream has had
+                                             filled when the audio thread read from it. */
+    };
+
+    /** Returns statistics for all the streams that are currently using the engine,
+        since they were created or resetStatistics() was last called.
+    */
+    Statistics getStatistics() const;
+
+    /** Resets the statistics for all the engine's streams. */
+    void resetStatistics();
+
+private:
+    //==============================================================================
+    friend class StreamingAudioSource;
+    class Worker;
+
+    CriticalSection lock;
+    Array<StreamingAudioSource*> streams;
+    OwnedArray<Worker> workers;
+    WaitableEvent workAvailable;
+    std::atomic<int64> numChunksRead { 0 };
+
+    void addStream (StreamingAudioSource&);
+    void removeStream (StreamingAudioSource&);
+    bool readNextChunk();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioStreamingEngine)
+};
+
+//==============================================================================
+/**
+    An AudioSource which reads ahead from another source using an AudioStreamingEngine.
+
+    This can be used in the same way as a BufferingAudioSource, but instead of each source
+    being polled in turn by a TimeSliceThread, the engine's threads prioritise the sources
+    that are about to run out of data. The audio thread never has to wait for a lock to
+    read from the buffer: the data is passed through a single-producer, single-consumer
+    ring buffer whose read and write positions are atomic.
+
+    If the audio thread gets to some data before it has been read, it plays silence
+    instead, and this is counted as an underrun - see getNumUnderruns() and
+    AudioStreamingEngine::getStatistics().
+
+    @see AudioStreamingEngine, BufferingAudioSource, AudioTransportSource
+
+    @tags{Audio}
+*/
+class JUCE_API  StreamingAudioSource  : public PositionableAudioSource
+{
+public:
+    //==============================================================================
+    /** Creates a StreamingAudioSource.
+
+        @param source                       the input source to read from
+        @param engine                       the engine that will do the reading. This object must
+                                            not be deleted until after any StreamingAudioSources that
+                                            are using it have been deleted!
+        @param deleteSourceWhenDeleted      if true, then the input source object will
+                                            be deleted when this object is deleted
+        @param numberOfSamplesToBuffer      the size of buffer to use for reading ahead
+        @param numberOfChannels             the number of channels that will be played
+        @param prefillBufferOnPrepareToPlay if true, then calling prepareToPlay on this object will
+                                            block until the buffer has been filled
+    */
+    StreamingAudioSource (PositionableAudioSource* source,
+                          AudioStreamingEngine& engine,
+                          bool deleteSourceWhenDeleted,
+                          int numberOfSamplesToBuffer,
+                          int numberOfChannels = 2,
+                          bool prefillBufferOnPrepareToPlay = true);
+
+    /** Destructor.
+
+        The input source may be deleted depending on whether the deleteSourceWhenDeleted
+        flag was set in the constructor.
+    */
+    ~StreamingAudioSource() override;
+
+    //==============================================================================
+    /** Implementation of the AudioSource method. */
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+
+    /** Implementation of the AudioSource method. */
+    void releaseResources() override;
+
+    /** Implementation of the AudioSource method. */
+    void getNextAudioBlock (const AudioSourceChannelInfo&) override;
+
+    //==============================================================================
+    /** Implements the PositionableAudioSource method. */
+    void setNextReadPosition (int64 newPosition) override;
+
+    /** Implements the PositionableAudioSource method. */
+    int64 getNextReadPosition() const override;
+
+    /** Implements the PositionableAudioSource method. */
+    int64 getTotalLength() const override       { return source->getTotalLength(); }
+
+    /** Implements the PositionableAudioSource method. */
+    bool isLooping() const override             { return source->isLooping(); }
+
+    /** Blocks until the data for the next call to getNextAudioBlock() has been read,
+        or until the timeout expires.
+
+        This is useful for offline rendering.
+    */
+    bool waitForNextAudioBlockReady (const AudioSourceChannelInfo& info, uint32 timeout);
+
+    //==============================================================================
+    /** Returns the number of audio blocks that were partly or completely silent because
+        the data hadn't been read in time.
+    */
+    int getNumUnderruns() const noexcept                { return numUnderruns.load(); }
+
+    /** Returns the total number of samples that were replaced by silence because
+        the data hadn't been read in time.
+    */
+    int64 getNumSamplesMissed() const noexcept          { return numSamplesMissed.load(); }
+
+    /** Returns the proportion of the buffer that is currently filled ahead of the read position. */
+    float getBufferLevel() const noexcept;
+
+    /** Resets the underrun counts and the lowest buffer level. */
+    void resetStatistics() noexcept;
+
+private:
+    //==============================================================================
+    friend class AudioStreamingEngine;
+
+    OptionalScopedPointer<PositionableAudioSource> source;
+    AudioStreamingEngine& engine;
+    int numberOfSamplesToBuffer, numberOfChannels;
+    AudioBuffer<float> buffer;
+    WaitableEvent bufferReadyEvent;
+    double sampleRate = 0;
+    bool isPrepared = false, prefillBuffer, wasSourceLooping = false;
+
+    // A seek is requested by setting seekPosition and incrementing seekGeneration. The
+    // audio thread picks it up by copying these into playPosition and playGeneration.
+    std::atomic<int64> seekPosition { 0 }, playPosition { 0 };
+    std::atomic<uint32> seekGeneration { 0 }, playGeneration { 0 };
+
+    // These describe the buffer's contents, and are only changed by the engine's threads.
+    std::atomic<int64> validStart { 0 }, validEnd { 0 };
+    std::atomic<uint32> bufferGeneration { 0 };
+    std::atomic<bool> isBeingFilled { false };
+
+    std::atomic<int> numUnderruns { 0 };
+    std::atomic<int64> numSamplesMissed { 0 };
+    std::atomic<float> lowestBufferLevel { 1.0f };
+
+    int64 getPositionToReadFrom() const noexcept;
+    bool needsFilling (double& secondsBuffered) const;
+    bool readNextChunk();
+    void readBufferSection (int64 start, int length, int bufferOffset);
+    bool isRangeReady (int64 start, int numSamples) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StreamingAudioSource)
+};
+
+} // namespace juce
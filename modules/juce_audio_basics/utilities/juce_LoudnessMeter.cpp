@@ -0,0 +1,548 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce
+{
+
+namespace LoudnessMeterHelpers
+{
+    // The absolute gate, below which blocks are ignored by the integrated loudness and
+    // loudness range, and the width of each of the histograms' bins.
+    static constexpr double absoluteGate = -70.0;
+    static constexpr double binWidth = 0.1;
+
+    static double powerToLoudness (double power) noexcept
+    {
+        return power > 0 ? -0.691 + 10.0 * std::log10 (power)
+                         : (double) LoudnessMeter::minusInfinityLUFS;
+    }
+
+    static float toLoudness (double power) noexcept
+    {
+        return (float) jmax ((double) LoudnessMeter::minusInfinityLUFS, powerToLoudness (power));
+    }
+
+    static void setIfGreater (std::atomic<float>& value, float newValue) noexcept
+    {
+        if (newValue > value)
+            value = newValue;
+    }
+}
+
+//==============================================================================
+void LoudnessMeter::Histogram::clear() noexcept
+{
+    zeromem (counts, sizeof (counts));
+    zeromem (powerSums, sizeof (powerSums));
+    totalCount = 0;
+    totalPower = 0;
+}
+
+void LoudnessMeter::Histogram::add (double power) noexcept
+{
+    using namespace LoudnessMeterHelpers;
+    auto loudness = powerToLoudness (power);
+
+    if (loudness < absoluteGate)
+        return;
+
+    auto bin = jmin ((int) numHistogramBins - 1, (int) ((loudness - absoluteGate) / binWidth));
+    ++counts[bin];
+    powerSums[bin] += power;
+    ++totalCount;
+    totalPower += power;
+}
+
+double LoudnessMeter::Histogram::getGatedMeanPower (double relativeGate) const noexcept
+{
+    using namespace LoudnessMeterHelpers;
+
+    if (totalCount == 0)
+        return 0;
+
+    auto threshold = powerToLoudness (totalPower / totalCount) + relativeGate;
+    double sum = 0;
+    int count = 0;
+
+    for (int i = 0; i < numHistogramBins; ++i)
+    {
+        if (counts[i] > 0 && powerToLoudness (powerSums[i] / counts[i]) >= threshold)
+        {
+            sum += powerSums[i];
+            count += counts[i];
+        }
+    }
+
+    return count > 0 ? sum / count : 0;
+}
+
+double LoudnessMeter::Histogram::getPercentile (double relativeGate, double proportion) const noexcept
+{
+    using namespace LoudnessMeterHelpers;
+
+    if (totalCount == 0)
+        return 0;
+
+    auto threshold = powerToLoudness (totalPower / totalCount) + relativeGate;
+    int firstBin = 0, numAboveGate = 0;
+
+    for (int i = numHistogramBins; --i >= 0;)
+    {
+        if (counts[i] > 0 && powerToLoudness (powerSums[i] / counts[i]) < threshold)
+        {
+            firstBin = i + 1;
+            break;
+        }
+
+        numAboveGate += counts[i];
+    }
+
+    auto rank = (int) std::floor (proportion * (numAboveGate - 1) + 0.5);
+
+    for (int i = firstBin; i < numHistogramBins; ++i)
+    {
+        rank -= counts[i];
+
+        if (rank < 0)
+            return powerToLoudness (powerSums[i] / counts[i]);
+    }
+
+    return 0;
+}
+
+//==============================================================================
+LoudnessMeter::LoudnessMeter()
+{
+    reset();
+}
+
+LoudnessMeter::~LoudnessMeter() {}
+
+void LoudnessMeter::prepare (double newSampleRate, int numChannels)
+{
+    jassert (newSampleRate > 0 && numChannels > 0);
+    sampleRate = newSampleRate;
+    auto pi = MathConstants<double>::pi;
+
+    // BS.1770 gives the K-weighting coefficients for 48kHz, so these are re-derived for
+    // other rates from the analogue prototypes of its two stages
+    {
+        auto K = std::tan (pi * 1681.974450955533 / sampleRate);
+        auto Q = 0.7071752369554196;
+        auto Vh = std::pow (10.0, 3.999843853973347 / 20.0);
+        auto Vb = std::pow (Vh, 0.4996667741545416);
+        auto a0 = 1.0 + K / Q + K * K;
+
+        shelfFilter = { (Vh + Vb * K / Q + K * K) / a0,
+                        2.0 * (K * K - Vh) / a0,
+                        (Vh - Vb * K / Q + K * K) / a0,
+                        2.0 * (K * K - 1.0) / a0,
+                        (1.0 - K / Q + K * K) / a0 };
+    }
+
+    {
+        auto K = std::tan (pi * 38.13547087602444 / sampleRate);
+        auto Q = 0.5003270373238773;
+        auto a0 = 1.0 + K / Q + K * K;
+
+        highPassFilter = { 1.0, -2.0, 1.0,
+                           2.0 * (K * K - 1.0) / a0,
+                           (1.0 - K / Q + K * K) / a0 };
+    }
+
+    // The true-peak interpolator is a windowed-sinc filter, split into one set of
+    // coefficients for each of the positions between the input samples
+    numPhases = sampleRate < 96000.0 ? 4 : (sampleRate < 192000.0 ? 2 : 1);
+    tapsPerPhase = numPhases > 1 ? 12 : 1;
+    truePeakCoefficients.resize (numPhases * tapsPerPhase);
+
+    for (int phase = 0; phase < numPhases; ++phase)
+    {
+        auto* c = truePeakCoefficients.getRawDataPointer() + phase * tapsPerPhase;
+        double sum = 0;
+
+        for (int i = 0; i < tapsPerPhase; ++i)
+        {
+            auto t = i - tapsPerPhase / 2 + phase / (double) numPhases;
+            auto sinc = t == 0 ? 1.0 : std::sin (pi * t) / (pi * t);
+            auto window = 0.5 + 0.5 * std::cos (pi * t / (tapsPerPhase / 2));
+            c[i] = (float) (sinc * window);
+            sum += c[i];
+        }
+
+        for (int i = 0; i < tapsPerPhase; ++i)
+            c[i] = (float) (c[i] / sum);
+    }
+
+    channels.resize (numChannels);
+    truePeakHistory.malloc ((size_t) (numChannels * 2 * tapsPerPhase));
+
+    weights.removeRange (numChannels, weights.size());
+
+    while (weights.size() < numChannels)
+        weights.add (1.0f);
+
+    samplesPerSubBlock = jmax (1, roundToInt (sampleRate * 0.1));
+    reset();
+}
+
+void LoudnessMeter::reset() noexcept
+{
+    for (auto& c : channels)
+        c = {};
+
+    if (truePeakHistory != nullptr)
+        zeromem (truePeakHistory, sizeof (float) * (size_t) (channels.size() * 2 * tapsPerPhase));
+
+    samplesInSubBlock = 0;
+    numSubBlocks = 0;
+    zeromem (subBlockPowers, sizeof (subBlockPowers));
+    momentaryHistogram.clear();
+    shortTermHistogram.clear();
+
+    auto silence = minusInfinityLUFS;
+    momentaryLoudness = silence;
+    shortTermLoudness = silence;
+    integratedLoudness = silence;
+    maximumMomentaryLoudness = silence;
+    maximumShortTermLoudness = silence;
+    loudnessRange = 0;
+    truePeak = 0;
+    samplePeak = 0;
+}
+
+void LoudnessMeter::setChannelWeight (int channel, float weight) noexcept
+{
+    if (isPositiveAndBelow (channel, weights.size()))
+        weights.set (channel, weight);
+}
+
+//==============================================================================
+void LoudnessMeter::process (const AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+{
+    jassert (startSample >= 0 && startSample + numSamples <= buffer.getNumSamples());
+
+    const float* channelData[64];
+    auto numChannels = jmin (buffer.getNumChannels(), channels.size(), (int) numElementsInArray (channelData));
+
+    for (int i = 0; i < numChannels; ++i)
+        channelData[i] = buffer.getReadPointer (i, startSample);
+
+    process (channelData, numChannels, numSamples);
+}
+
+void LoudnessMeter::process (const float* const* channelData, int numChannels, int numSamples) noexcept
+{
+    jassert (sampleRate > 0); // you need to call prepare() first!
+    numChannels = jmin (numChannels, channels.size());
+
+    for (int offset = 0; offset < numSamples;)
+    {
+        auto numThisTime = jmin (numSamples - offset, samplesPerSubBlock - samplesInSubBlock);
+
+        for (int i = 0; i < numChannels; ++i)
+            processChannel (i, channelData[i] + offset, numThisTime);
+
+        offset += numThisTime;
+        samplesInSubBlock += numThisTime;
+
+        if (samplesInSubBlock >= samplesPerSubBlock)
+        {
+            finishSubBlock();
+            samplesInSubBlock = 0;
+        }
+    }
+
+    for (auto& c : channels)
+    {
+        LoudnessMeterHelpers::setIfGreater (truePeak, c.truePeak);
+        LoudnessMeterHelpers::setIfGreater (samplePeak, c.samplePeak);
+    }
+}
+
+void LoudnessMeter::processChannel (int channel, const float* data, int numSamples) noexcept
+{
+    auto& c = channels.getReference (channel);
+
+    // K-weighting, as two transposed direct-form II biquads
+    auto& s = shelfFilter;
+    auto& h = highPassFilter;
+    auto s1 = c.shelf1, s2 = c.shelf2, h1 = c.highPass1, h2 = c.highPass2;
+    double sumOfSquares = 0;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto x = (double) data[i];
+
+        auto y = s.b0 * x + s1;
+        s1 = s.b1 * x - s.a1 * y + s2;
+        s2 = s.b2 * x - s.a2 * y;
+
+        auto z = h.b0 * y + h1;
+        h1 = h.b1 * y - h.a1 * z + h2;
+        h2 = h.b2 * y - h.a2 * z;
+
+        sumOfSquares += z * z;
+    }
+
+    c.shelf1 = s1;  c.shelf2 = s2;
+    c.highPass1 = h1;  c.highPass2 = h2;
+    c.sumOfSquares += sumOfSquares;
+
+    auto range = FloatVectorOperations::findMinAndMax (data, numSamples);
+    c.samplePeak = jmax (c.samplePeak, -range.getStart(), range.getEnd());
+
+    // True peak: the intermediate positions are interpolated, as the samples themselves
+    // are already covered by the sample peak
+    if (numPhases > 1)
+    {
+        auto* history = truePeakHistory + channel * 2 * tapsPerPhase;
+        auto* coefficients = truePeakCoefficients.getRawDataPointer();
+        auto position = c.historyPosition;
+        auto peak = c.truePeak;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            position = (position == 0 ? tapsPerPhase : position) - 1;
+            history[position] = history[position + tapsPerPhase] = data[i];
+            auto* window = history + position;
+
+            for (int phase = 1; phase < numPhases; ++phase)
+            {
+                auto* phaseCoefficients = coefficients + phase * tapsPerPhase;
+                float sum = 0;
+
+                for (int j = 0; j < tapsPerPhase; ++j)
+                    sum += phaseCoefficients[j] * window[j];
+
+                peak = jmax (peak, std::abs (sum));
+            }
+        }
+
+        c.historyPosition = position;
+        c.truePeak = jmax (peak, c.samplePeak);
+    }
+    else
+    {
+        c.truePeak = c.samplePeak;
+    }
+}
+
+double LoudnessMeter::getMeanSubBlockPower (int numToAverage) const noexcept
+{
+    double sum = 0;
+
+    for (int i = 1; i <= numToAverage; ++i)
+        sum += subBlockPowers[(numSubBlocks - i) % numSubBlocksPerShortTerm];
+
+    return sum / numToAverage;
+}
+
+void LoudnessMeter::finishSubBlock() noexcept
+{
+    using namespace LoudnessMeterHelpers;
+    double power = 0;
+
+    for (int i = 0; i < channels.size(); ++i)
+    {
+        auto& c = channels.getReference (i);
+        power += weights.getUnchecked (i) * c.sumOfSquares;
+        c.sumOfSquares = 0;
+    }
+
+    subBlockPowers[numSubBlocks % numSubBlocksPerShortTerm] = power / samplesPerSubBlock;
+
+    // This just needs to avoid overflowing while keeping its place in the ring
+    if (++numSubBlocks >= 1000 * numSubBlocksPerShortTerm)
+        numSubBlocks -= 999 * numSubBlocksPerShortTerm;
+
+    if (numSubBlocks >= numSubBlocksPerMomentary)
+    {
+        auto momentaryPower = getMeanSubBlockPower (numSubBlocksPerMomentary);
+        momentaryHistogram.add (momentaryPower);
+
+        momentaryLoudness = toLoudness (momentaryPower);
+        setIfGreater (maximumMomentaryLoudness, momentaryLoudness);
+        integratedLoudness = toLoudness (momentaryHistogram.getGatedMeanPower (-10.0));
+    }
+
+    if (numSubBlocks >= numSubBlocksPerShortTerm)
+    {
+        auto shortTermPower = getMeanSubBlockPower (numSubBlocksPerShortTerm);
+        shortTermHistogram.add (shortTermPower);
+
+        shortTermLoudness = toLoudness (shortTermPower);
+        setIfGreater (maximumShortTermLoudness, shortTermLoudness);
+        loudnessRange = (float) (shortTermHistogram.getPercentile (-20.0, 0.95)
+                                   - shortTermHistogram.getPercentile (-20.0, 0.1));
+    }
+}
+
+LoudnessMeter::Measurement LoudnessMeter::getMeasurement() const noexcept
+{
+    Measurement m;
+    m.integratedLoudness = integratedLoudness;
+    m.loudnessRange = loudnessRange;
+    m.maximumMomentaryLoudness = maximumMomentaryLoudness;
+    m.maximumShortTermLoudness = maximumShortTermLoudness;
+    m.truePeak = truePeak;
+    m.samplePeak = samplePeak;
+    return m;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct LoudnessMeterTests  : public UnitTest
+{
+    LoudnessMeterTests()  : UnitTest ("LoudnessMeter", "Audio") {}
+
+    struct Segment
+    {
+        float levelDb;
+        double seconds;
+    };
+
+    // Feeds the meter a sine wave at the same level in each channel, whose level changes
+    // for each segment, as in the EBU Tech 3341 and 3342 test signals
+    static void measureSine (LoudnessMeter& meter, double sampleRate, int numChannels, double frequency,
+                             std::initializer_list<Segment> segments, double initialPhase = 0)
+    {
+        meter.prepare (sampleRate, numChannels);
+
+        const int blockSize = 480;
+        AudioBuffer<float> buffer (numChannels, blockSize);
+        auto phase = initialPhase;
+        auto phaseStep = MathConstants<double>::twoPi * frequency / sampleRate;
+
+        for (auto& segment : segments)
+        {
+            auto gain = Decibels::decibelsToGain (segment.levelDb);
+
+            for (auto numLeft = roundToInt (segment.seconds * sampleRate); numLeft > 0;)
+            {
+                auto numThisTime = jmin (numLeft, blockSize);
+
+                for (int i = 0; i < numThisTime; ++i)
+                {
+                    auto sample = (float) (gain * std::sin (phase));
+                    phase += phaseStep;
+
+                    for (int chan = 0; chan < numChannels; ++chan)
+                        buffer.setSample (chan, i, sample);
+                }
+
+                meter.process (buffer, 0, numThisTime);
+                numLeft -= numThisTime;
+            }
+        }
+    }
+
+    void expectLoudness (float actual, float expected, float tolerance = 0.1f)
+    {
+        expectWithinAbsoluteError (actual, expected, tolerance);
+    }
+
+    void runTest() override
+    {
+        LoudnessMeter meter;
+
+        beginTest ("Silence");
+        {
+            measureSine (meter, 48000.0, 2, 1000.0, { { -200.0f, 5.0 } });
+            expectEquals (meter.getIntegratedLoudness(), LoudnessMeter::minusInfinityLUFS);
+            expectEquals (meter.getLoudnessRange(), 0.0f);
+            expectEquals (meter.getTruePeak(), 0.0f);
+        }
+
+        beginTest ("BS.1770 calibration");
+        {
+            // A 0dBFS 997Hz sine in one channel should read -3.01 LKFS
+            meter.prepare (48000.0, 2);
+            measureSine (meter, 48000.0, 1, 997.0, { { 0.0f, 10.0 } });
+            expectLoudness (meter.getIntegratedLoudness(), -3.01f);
+        }
+
+        beginTest ("EBU Tech 3341 test signals 1 and 2");
+        {
+            for (auto sampleRate : { 44100.0, 48000.0, 96000.0 })
+            {
+                measureSine (meter, sampleRate, 2, 1000.0, { { -23.0f, 20.0 } });
+                expectLoudness (meter.getMomentaryLoudness(), -23.0f);
+                expectLoudness (meter.getShortTermLoudness(), -23.0f);
+                expectLoudness (meter.getIntegratedLoudness(), -23.0f);
+
+                measureSine (meter, sampleRate, 2, 1000.0, { { -33.0f, 20.0 } });
+                expectLoudness (meter.getMomentaryLoudness(), -33.0f);
+                expectLoudness (meter.getShortTermLoudness(), -33.0f);
+                expectLoudness (meter.getIntegratedLoudness(), -33.0f);
+            }
+        }
+
+        beginTest ("EBU Tech 3341 test signals 3 and 4 (gating)");
+        {
+            measureSine (meter, 48000.0, 2, 1000.0, { { -36.0f, 10.0 }, { -23.0f, 60.0 }, { -36.0f, 10.0 } });
+            expectLoudness (meter.getIntegratedLoudness(), -23.0f);
+
+            measureSine (meter, 48000.0, 2, 1000.0, { { -72.0f, 10.0 }, { -36.0f, 10.0 }, { -23.0f, 60.0 },
+                                                      { -36.0f, 10.0 }, { -72.0f, 10.0 } });
+            expectLoudness (meter.getIntegratedLoudness(), -23.0f);
+        }
+
+        beginTest ("EBU Tech 3342 loudness range");
+        {
+            measureSine (meter, 48000.0, 2, 1000.0, { { -20.0f, 20.0 }, { -30.0f, 20.0 } });
+            expectLoudness (meter.getLoudnessRange(), 10.0f, 1.0f);
+
+            measureSine (meter, 48000.0, 2, 1000.0, { { -20.0f, 20.0 }, { -15.0f, 20.0 } });
+            expectLoudness (meter.getLoudnessRange(), 5.0f, 1.0f);
+
+            measureSine (meter, 48000.0, 2, 1000.0, { { -40.0f, 20.0 }, { -20.0f, 20.0 } });
+            expectLoudness (meter.getLoudnessRange(), 20.0f, 1.0f);
+        }
+
+        beginTest ("True peak");
+        {
+            // A sine at a quarter of the sample rate, whose peaks fall halfway between
+            // the samples, so the sample peak is 3dB below the true peak
+            measureSine (meter, 48000.0, 2, 12000.0, { { -6.0f, 1.0 } }, MathConstants<double>::pi / 4.0);
+
+            auto expectedPeak = Decibels::decibelsToGain (-6.0f);
+            expectWithinAbsoluteError (Decibels::gainToDecibels (meter.getTruePeak()), -6.0f, 0.2f);
+            expectWithinAbsoluteError (meter.getSamplePeak(), expectedPeak * std::sqrt (0.5f), 0.001f);
+
+            auto m = meter.getMeasurement();
+            expectEquals (m.truePeak, meter.getTruePeak());
+            expectEquals (m.samplePeak, meter.getSamplePeak());
+
+            meter.reset();
+            expectEquals (meter.getTruePeak(), 0.0f);
+        }
+    }
+};
+
+static LoudnessMeterTests loudnessMeterTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Measures loudness and true-peak levels, as specified by ITU-R BS.1770-4 and
+    EBU R128.
+
+    The meter applies the BS.1770 K-weighting filter to each channel, and from that
+    measures the momentary (400ms), short-term (3s) and gated integrated loudness of
+    everything it has been given since it was last reset, along with the loudness range
+    (LRA, as defined by EBU Tech 3342) and the true-peak level, which is found by
+    oversampling the signal 4x (or 2x at 88.2 and 96kHz).
+
+    Loudness values are in LUFS, and are updated every 100ms. If there isn't enough
+    audio to measure a value yet, or it's silent, the loudness will be reported as
+    LoudnessMeter::minusInfinityLUFS.
+
+    process() doesn't allocate or lock, so it can be called on the audio thread, and the
+    getter methods can be called from any thread while it's running. The integrated
+    loudness and loudness range are gathered into histograms with a resolution of
+    0.1 LU, so the meter uses the same amount of memory however long it runs for.
+
+    To measure an audio file, see LoudnessAnalyser.
+
+    @tags{Audio}
+*/
+class JUCE_API  LoudnessMeter
+{
+public:
+    //==============================================================================
+    /** Creates a meter. You'll need to call prepare() before using it. */
+    LoudnessMeter();
+
+    /** Destructor. */
+    ~LoudnessMeter();
+
+    /** The loudness that's reported for silence, or when there's not enough audio to measure. */
+    static constexpr float minusInfinityLUFS = -100.0f;
+
+    //==============================================================================
+    /** Sets the sample rate and number of channels that will be measured, and resets
+        the meter. This may allocate memory.
+    */
+    void prepare (double sampleRate, int numChannels);
+
+    /** Clears all the measurements and filter states. */
+    void reset() noexcept;
+
+    /** Changes the weighting applied to one of the channels when they're summed.
+
+        By default all channels have a weight of 1.0. For a 5.1 signal, BS.1770 specifies
+        a weight of 1.41 for the surround channels, and the LFE channel should be given
+        a weight of 0.
+    */
+    void setChannelWeight (int channel, float weight) noexcept;
+
+    //==============================================================================
+    /** Measures some more audio. Any channels beyond the number that the meter was
+        prepared with are ignored.
+    */
+    void process (const float* const* channelData, int numChannels, int numSamples) noexcept;
+
+    /** Measures a section of an AudioBuffer. */
+    void process (const AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept;
+
+    //==============================================================================
+    /** Returns the loudness of the last 400ms, in LUFS. */
+    float getMomentaryLoudness() const noexcept             { return momentaryLoudness; }
+
+    /** Returns the loudness of the last 3 seconds, in LUFS. */
+    float getShortTermLoudness() const noexcept             { return shortTermLoudness; }
+
+    /** Returns the gated loudness of everything since the meter was reset, in LUFS. */
+    float getIntegratedLoudness() const noexcept            { return integratedLoudness; }
+
+    /** Returns the loudness range since the meter was reset, in LU. */
+    float getLoudnessRange() const noexcept                 { return loudnessRange; }
+
+    /** Returns the highest true-peak level across all the channels since the meter was
+        reset, as a gain (use Decibels::gainToDecibels() to convert it to dBTP).
+    */
+    float getTruePeak() const noexcept                      { return truePeak; }
+
+    /** Returns the highest absolute sample value since the meter was reset. */
+    float getSamplePeak() const noexcept                    { return samplePeak; }
+
+    //==============================================================================
+    /** A summary of all the meter's measurements. */
+    struct Measurement
+    {
+        float integratedLoudness = minusInfinityLUFS;        /**< In LUFS. */
+        float loudnessRange = 0;                                                    /**< In LU. */
+        float maximumMomentaryLoudness = minusInfinityLUFS;  /**< In LUFS. */
+        float maximumShortTermLoudness = minusInfinityLUFS;  /**< In LUFS. */
+        float truePeak = 0;                                                         /**< As a gain. */
+        float samplePeak = 0;                                                       /**< As a gain. */
+    };
+
+    /** Returns a summary of everything measured since the meter was reset. */
+    Measurement getMeasurement() const noexcept;
+
+private:
+    //==============================================================================
+    enum { numSubBlocksPerMomentary = 4, numSubBlocksPerShortTerm = 30, numHistogramBins = 800 };
+
+    struct Biquad
+    {
+        double b0, b1, b2, a1, a2;
+    };
+
+    struct ChannelState
+    {
+        double shelf1, shelf2, highPass1, highPass2, sumOfSquares;
+        float truePeak, samplePeak;
+        int historyPosition;
+    };
+
+    struct Histogram
+    {
+        int counts[numHistogramBins];
+        double powerSums[numHistogramBins];
+        int totalCount;
+        double totalPower;
+
+        void clear() noexcept;
+        void add (double power) noexcept;
+        double getGatedMeanPower (double relativeGate) const noexcept;
+        double getPercentile (double relativeGate, double proportion) const noexcept;
+    };
+
+    double sampleRate = 0;
+    Biquad shelfFilter {}, highPassFilter {};
+    Array<ChannelState> channels;
+    Array<float> weights;
+
+    int numPhases = 1, tapsPerPhase = 1;
+    Array<float> truePeakCoefficients;
+    HeapBlock<float> truePeakHistory;
+
+    int samplesPerSubBlock = 0, samplesInSubBlock = 0;
+    double subBlockPowers[numSubBlocksPerShortTerm] = {};
+    int numSubBlocks = 0;
+    Histogram momentaryHistogram, shortTermHistogram;
+
+    std::atomic<float> momentaryLoudness, shortTermLoudness, integratedLoudness, loudnessRange,
+                       maximumMomentaryLoudness, maximumShortTermLoudness, truePeak, samplePeak;
+
+    void processChannel (int channel, const float* data, int numSamples) noexcept;
+    void finishSubBlock() noexcept;
+    double getMeanSubBlockPower (int numToAverage) const noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LoudnessMeter)
+};
+
+} // namespace juce
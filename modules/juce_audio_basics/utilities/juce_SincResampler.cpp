@@ -0,0 +1,846 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+namespace SincResamplerHelpers
+{
+    struct QualitySettings
+    {
+        int halfLength;             // number of taps on each side of the centre, at the full bandwidth
+        double attenuation;         // stop-band attenuation in dB
+        int numInterpolatedRows;    // number of phases in the tables used for arbitrary ratios
+    };
+
+    static QualitySettings getSettings (SincResampler::Quality quality) noexcept
+    {
+        switch (quality)
+        {
+            case SincResampler::Quality::low:       return { 8,  60.0,  128 };
+            case SincResampler::Quality::medium:    return { 16, 80.0,  256 };
+            case SincResampler::Quality::best:      return { 64, 120.0, 1024 };
+            case SincResampler::Quality::high:
+            default:                                return { 32, 100.0, 512 };
+        }
+    }
+
+    enum
+    {
+        maxDecimation           = 16,       // beyond this ratio, the filter doesn't get any longer
+        bandwidthSteps          = 256,      // the bandwidths of tables for arbitrary ratios are rounded down to this
+        maxExactDenominator     = 1024,
+        maxExactTableSize       = 1 << 18,  // in floats
+        maxInterpolatedSize     = 1 << 19,  // in floats
+        historyChunkSize        = 1024,
+        maxCachedTables         = 16
+    };
+
+    static double besselI0 (double x) noexcept
+    {
+        auto halfX = x * 0.5;
+        double sum = 1.0, term = 1.0;
+
+        for (int k = 1; k < 500; ++k)
+        {
+            auto t = halfX / k;
+            term *= t * t;
+            sum += term;
+
+            if (term < sum * 1.0e-17)
+                break;
+        }
+
+        return sum;
+    }
+
+    static int getFilterLookAhead (int halfLength, double bandwidth) noexcept
+    {
+        // an even length keeps the total number of taps a multiple of 4 for the SIMD code
+        auto length = (int) std::ceil (halfLength / bandwidth - 1.0e-9);
+        return (length + 1) & ~1;
+    }
+
+    //==============================================================================
+    static float dotProduct (const float* x, const float* c, int num) noexcept
+    {
+        jassert (num % 4 == 0);
+
+       #if JUCE_USE_VDSP_FRAMEWORK
+        float result;
+        vDSP_dotpr (x, 1, c, 1, &result, (vDSP_Length) num);
+        return result;
+       #elif JUCE_USE_SSE_INTRINSICS
+        auto sum = _mm_setzero_ps();
+
+        for (int i = 0; i < num; i += 4)
+            sum = _mm_add_ps (sum, _mm_mul_ps (_mm_loadu_ps (x + i), _mm_loadu_ps (c + i)));
+
+        sum = _mm_add_ps (sum, _mm_movehl_ps (sum, sum));
+        sum = _mm_add_ss (sum, _mm_shuffle_ps (sum, sum, 1));
+        return _mm_cvtss_f32 (sum);
+       #elif JUCE_USE_ARM_NEON
+        auto sum = vdupq_n_f32 (0);
+
+        for (int i = 0; i < num; i += 4)
+            sum = vmlaq_f32 (sum, vld1q_f32 (x + i), vld1q_f32 (c + i));
+
+        auto pair = vadd_f32 (vget_low_f32 (sum), vget_high_f32 (sum));
+        return vget_lane_f32 (vpadd_f32 (pair, pair), 0);
+       #else
+        float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+        for (int i = 0; i < num; i += 4)
+        {
+            s0 += x[i]     * c[i];
+            s1 += x[i + 1] * c[i + 1];
+            s2 += x[i + 2] * c[i + 2];
+            s3 += x[i + 3] * c[i + 3];
+        }
+
+        return (s0 + s2) + (s1 + s3);
+       #endif
+    }
+
+    static void dualDotProduct (const float* x, const float* c1, const float* c2, int num,
+                                float& result1, float& result2) noexcept
+    {
+        jassert (num % 4 == 0);
+
+       #if JUCE_USE_VDSP_FRAMEWORK
+        vDSP_dotpr (x, 1, c1, 1, &result1, (vDSP_Length) num);
+        vDSP_dotpr (x, 1, c2, 1, &result2, (vDSP_Length) num);
+       #elif JUCE_USE_SSE_INTRINSICS
+        auto sum1 = _mm_setzero_ps();
+        auto sum2 = _mm_setzero_ps();
+
+        for (int i = 0; i < num; i += 4)
+        {
+            auto in = _mm_loadu_ps (x + i);
+            sum1 = _mm_add_ps (sum1, _mm_mul_ps (in, _mm_loadu_ps (c1 + i)));
+            sum2 = _mm_add_ps (sum2, _mm_mul_ps (in, _mm_loadu_ps (c2 + i)));
+        }
+
+        // transpose the two sums so that they can be added horizontally together
+        auto lo = _mm_unpacklo_ps (sum1, sum2);
+        auto hi = _mm_unpackhi_ps (sum1, sum2);
+        auto sums = _mm_add_ps (lo, hi);
+        sums = _mm_add_ps (sums, _mm_movehl_ps (sums, sums));
+        result1 = _mm_cvtss_f32 (sums);
+        result2 = _mm_cvtss_f32 (_mm_shuffle_ps (sums, sums, 1));
+       #elif JUCE_USE_ARM_NEON
+        auto sum1 = vdupq_n_f32 (0);
+        auto sum2 = vdupq_n_f32 (0);
+
+        for (int i = 0; i < num; i += 4)
+        {
+            auto in = vld1q_f32 (x + i);
+            sum1 = vmlaq_f32 (sum1, in, vld1q_f32 (c1 + i));
+            sum2 = vmlaq_f32 (sum2, in, vld1q_f32 (c2 + i));
+        }
+
+        auto pairs = vpadd_f32 (vadd_f32 (vget_low_f32 (sum1), vget_high_f32 (sum1)),
+                                vadd_f32 (vget_low_f32 (sum2), vget_high_f32 (sum2)));
+        result1 = vget_lane_f32 (pairs, 0);
+        result2 = vget_lane_f32 (pairs, 1);
+       #else
+        float a0 = 0, a1 = 0, b0 = 0, b1 = 0;
+
+        for (int i = 0; i < num; i += 2)
+        {
+            a0 += x[i]     * c1[i];
+            a1 += x[i + 1] * c1[i + 1];
+            b0 += x[i]     * c2[i];
+            b1 += x[i + 1] * c2[i + 1];
+        }
+
+        result1 = a0 + a1;
+        result2 = b0 + b1;
+       #endif
+    }
+}
+
+//==============================================================================
+struct SincResampler::Table
+{
+    Table (Quality q, int64 num, int64 den, int bandwidthIndexToUse)
+        : quality (q), numerator (num), denominator (den), bandwidthIndex (bandwidthIndexToUse)
+    {
+        using namespace SincResamplerHelpers;
+
+        auto settings = getSettings (quality);
+        isInterpolated = (denominator == 0);
+
+        auto bandwidth = isInterpolated ? bandwidthIndex / (double) bandwidthSteps
+                                        : jlimit (1.0 / maxDecimation, 1.0, denominator / (double) numerator);
+
+        lookAhead = getFilterLookAhead (settings.halfLength, bandwidth);
+        numTaps = lookAhead * 2;
+
+        if (isInterpolated)
+        {
+            numRows = settings.numInterpolatedRows;
+
+            while ((numRows + 1) * numTaps > maxInterpolatedSize && numRows > 64)
+                numRows /= 2;
+
+            phaseShift = 32;
+
+            for (auto n = numRows; n > 1; n >>= 1)
+                --phaseShift;
+
+            phaseResolution = (uint64) 1 << 32;
+            phaseMask = ((uint64) 1 << phaseShift) - 1;
+            fractionScale = 1.0f / (float) ((uint64) 1 << phaseShift);
+
+            // the extra row is the first one shifted by a sample, so that
+            // the last row has a neighbour to be interpolated with
+            coefficients.malloc ((size_t) ((numRows + 1) * numTaps));
+        }
+        else
+        {
+            numRows = (int) denominator;
+            phaseResolution = (uint64) denominator;
+            coefficients.calloc ((size_t) (numRows * numTaps));
+
+            if (numerator == denominator)
+            {
+                isIdentity = true;
+                coefficients[lookAhead - 1] = 1.0f;
+                return;
+            }
+        }
+
+        // The filter is a Kaiser-windowed sinc, whose transition band ends at the lower of
+        // the two Nyquist frequencies. The width of that band is whatever the Kaiser formula
+        // says we can get with this number of taps for the attenuation that we want.
+        auto transitionWidth = (settings.attenuation - 8.0) / (2.285 * 2.0 * settings.halfLength * MathConstants<double>::pi);
+        auto cutoff = bandwidth * (1.0 - transitionWidth * 0.5);
+        auto beta = 0.1102 * (settings.attenuation - 8.7);
+        auto i0Beta = besselI0 (beta);
+
+        HeapBlock<double> row ((size_t) numTaps);
+        auto numRowsToFill = isInterpolated ? numRows + 1 : numRows;
+
+        for (int r = 0; r < numRowsToFill; ++r)
+        {
+            auto fraction = r / (double) numRows;
+            double sum = 0;
+
+            for (int i = 0; i < numTaps; ++i)
+            {
+                auto distance = i - (lookAhead - 1) - fraction;
+                auto x = distance / lookAhead;
+                auto window = x * x < 1.0 ? besselI0 (beta * std::sqrt (1.0 - x * x)) / i0Beta
+                                          : 1.0 / i0Beta;
+
+                auto phase = MathConstants<double>::pi * cutoff * distance;
+                auto sinc = std::abs (phase) < 1.0e-9 ? 1.0 : std::sin (phase) / phase;
+
+                row[i] = sinc * window;
+                sum += row[i];
+            }
+
+            // each phase is normalised to unity gain at DC, so that a constant signal stays constant
+            auto* dest = coefficients + r * numTaps;
+
+            for (int i = 0; i < numTaps; ++i)
+                dest[i] = (float) (row[i] / sum);
+        }
+    }
+
+    const float* getRow (int index) const noexcept      { return coefficients + index * numTaps; }
+
+    const Quality quality;
+    const int64 numerator, denominator;
+    const int bandwidthIndex;
+
+    int numTaps = 0, lookAhead = 0, numRows = 0, phaseShift = 0;
+    uint64 phaseResolution = 1, phaseMask = 0;
+    float fractionScale = 0;
+    bool isInterpolated = false, isIdentity = false;
+    HeapBlock<float> coefficients;
+
+    // (this is only used while holding the TableCache's lock)
+    mutable uint32 lastUseCount = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (Table)
+};
+
+//==============================================================================
+/*  The tables that are shared between all the resamplers.
+
+    A table can take a long time to build, so it's built without holding the lock, and
+    then added to the list. The lock is only held while the list is searched or changed,
+    so a resampler on the audio thread that looks up a table which has already been built
+    will never have to wait for another thread to finish building one.
+*/
+struct SincResampler::TableCache
+{
+    TableCache()    { tables.reserve (SincResamplerHelpers::maxCachedTables + 1); }
+
+    std::shared_ptr<const Table> find (Quality quality, int64 numerator, int64 denominator, int bandwidthIndex)
+    {
+        const SpinLock::ScopedLockType sl (lock);
+        return findLocked (quality, numerator, denominator, bandwidthIndex);
+    }
+
+    std::shared_ptr<const Table> add (std::shared_ptr<const Table> newTable)
+    {
+        // Any tables that are removed are kept until the lock has been released, so
+        // that they don't get deleted while it's held.
+        std::vector<std::shared_ptr<const Table>> removedTables;
+        const SpinLock::ScopedLockType sl (lock);
+
+        // another thread might have built the same table in the meantime..
+        if (auto existing = findLocked (newTable->quality, newTable->numerator,
+                                        newTable->denominator, newTable->bandwidthIndex))
+            return existing;
+
+        while (tables.size() >= (size_t) SincResamplerHelpers::maxCachedTables)
+        {
+            auto oldest = tables.end();
+
+            for (auto t = tables.begin(); t != tables.end(); ++t)
+                if (t->use_count() == 1 && (oldest == tables.end() || (*t)->lastUseCount < (*oldest)->lastUseCount))
+                    oldest = t;
+
+            if (oldest == tables.end())
+                break;
+
+            removedTables.push_back (std::move (*oldest));
+            tables.erase (oldest);
+        }
+
+        newTable->lastUseCount = ++useCounter;
+        tables.push_back (newTable);
+        return newTable;
+    }
+
+private:
+    std::shared_ptr<const Table> findLocked (Quality quality, int64 numerator, int64 denominator, int bandwidthIndex)
+    {
+        for (auto& t : tables)
+        {
+            if (t->quality == quality && t->numerator == numerator
+                 && t->denominator == denominator && t->bandwidthIndex == bandwidthIndex)
+            {
+                t->lastUseCount = ++useCounter;
+                return t;
+            }
+        }
+
+        return {};
+    }
+
+    SpinLock lock;
+    std::vector<std::shared_ptr<const Table>> tables;
+    uint32 useCounter = 0;
+};
+
+//==============================================================================
+std::shared_ptr<const SincResampler::Table> SincResampler::getTable (Quality quality, double ratio, bool allowExactTable)
+{
+    using namespace SincResamplerHelpers;
+
+    int64 numerator = 0, denominator = 0;
+    int bandwidthIndex = 0;
+
+    if (allowExactTable)
+    {
+        for (int64 den = 1; den <= maxExactDenominator; ++den)
+        {
+            auto num = (int64) std::llround (ratio * (double) den);
+
+            if (num > 0 && std::abs (num / (double) den - ratio) <= ratio * 1.0e-12)
+            {
+                auto bandwidth = jlimit (1.0 / maxDecimation, 1.0, den / (double) num);
+
+                if (den * getFilterLookAhead (getSettings (quality).halfLength, bandwidth) * 2 <= maxExactTableSize)
+                {
+                    numerator = num;
+                    denominator = den;
+                }
+
+                break;
+            }
+        }
+    }
+
+    if (denominator == 0)
+        bandwidthIndex = jlimit ((int) bandwidthSteps / maxDecimation, (int) bandwidthSteps,
+                                 (int) std::floor (bandwidthSteps / ratio));
+
+    static TableCache cache;
+
+    if (auto existing = cache.find (quality, numerator, denominator, bandwidthIndex))
+        return existing;
+
+    return cache.add (std::make_shared<const Table> (quality, numerator, denominator, bandwidthIndex));
+}
+
+void SincResampler::preloadCoefficients (Quality quality, double inputSamplesPerOutputSample)
+{
+    auto ratio = jlimit (1.0 / 65536.0, 65536.0, inputSamplesPerOutputSample);
+
+    // When the ratio changes while a resampler is running, it may need to use the
+    // interpolated table instead of the exact one, so that has to be built too
+    if (! getTable (quality, ratio, true)->isInterpolated)
+        getTable (quality, ratio, false);
+}
+
+//==============================================================================
+SincResampler::SincResampler (Quality q)  : quality (q)
+{
+    setQuality (q);
+}
+
+SincResampler::~SincResampler() {}
+
+void SincResampler::setQuality (Quality newQuality)
+{
+    quality = newQuality;
+
+    // enough room for the longest filter this quality can use, plus a block of new input
+    historySize = SincResamplerHelpers::getSettings (quality).halfLength * 2 * SincResamplerHelpers::maxDecimation
+                    + SincResamplerHelpers::historyChunkSize;
+    history.malloc ((size_t) historySize);
+
+    table.reset();
+    updateTable();
+    reset();
+}
+
+void SincResampler::setRatio (double inputSamplesPerOutputSample)
+{
+    jassert (inputSamplesPerOutputSample > 0);
+
+    auto newRatio = jlimit (1.0 / 65536.0, 65536.0, inputSamplesPerOutputSample);
+
+    if (ratio != newRatio)
+    {
+        ratio = newRatio;
+        updateTable();
+    }
+}
+
+void SincResampler::updateTable()
+{
+    auto oldTable = table;
+    auto newTable = getTable (quality, ratio, true);
+
+    if (oldTable != nullptr)
+    {
+        // The position between input samples has to carry across to the new table, which
+        // is only possible for an exact ratio if the phase lands exactly on one of its rows
+        if (! newTable->isInterpolated && (phase * newTable->phaseResolution) % oldTable->phaseResolution != 0)
+            newTable = getTable (quality, ratio, false);
+
+        phase = phase * newTable->phaseResolution / oldTable->phaseResolution;
+
+        // keep the history aligned with the first tap of the new filter
+        readPos += oldTable->lookAhead - newTable->lookAhead;
+
+        if (readPos < 0)
+        {
+            auto numToInsert = -readPos;
+            jassert (numInHistory + numToInsert <= historySize);
+
+            memmove (history + numToInsert, history, (size_t) numInHistory * sizeof (float));
+            FloatVectorOperations::clear (history, numToInsert);
+            numInHistory += numToInsert;
+            readPos = 0;
+        }
+    }
+
+    table = newTable;
+
+    if (table->isInterpolated)
+    {
+        auto step = std::floor (ratio);
+        samplesStep = (int) step;
+        phaseStep = (uint64) std::llround ((ratio - step) * (double) table->phaseResolution);
+
+        if (phaseStep >= table->phaseResolution)
+        {
+            ++samplesStep;
+            phaseStep -= table->phaseResolution;
+        }
+    }
+    else
+    {
+        samplesStep = (int) (table->numerator / table->denominator);
+        phaseStep = (uint64) (table->numerator % table->denominator);
+    }
+}
+
+void SincResampler::reset() noexcept
+{
+    phase = 0;
+    readPos = 0;
+
+    // this leaves the first input sample in the middle of the filter
+    numInHistory = table->lookAhead - 1;
+    FloatVectorOperations::clear (history, numInHistory);
+}
+
+int SincResampler::getLookAhead() const noexcept
+{
+    return table->lookAhead;
+}
+
+//==============================================================================
+uint64 SincResampler::getNumSamplesToAdvance (int numOutputSamples) const noexcept
+{
+    auto n = (uint64) numOutputSamples;
+    return n * (uint64) samplesStep + (n * phaseStep + phase) / table->phaseResolution;
+}
+
+int SincResampler::getNumInputSamplesNeeded (int numOutputSamples) const noexcept
+{
+    if (numOutputSamples <= 0)
+        return 0;
+
+    auto endOfLastFilter = (int64) readPos + (int64) getNumSamplesToAdvance (numOutputSamples - 1) + table->numTaps;
+    return (int) jmax ((int64) 0, endOfLastFilter - numInHistory);
+}
+
+int SincResampler::getNumOutputSamplesAvailable (int numInputSamples) const noexcept
+{
+    auto numOut = jmax (0, (int) ((numInHistory + numInputSamples - readPos - table->numTaps) / ratio) + 1);
+
+    while (numOut > 0 && getNumInputSamplesNeeded (numOut) > numInputSamples)
+        --numOut;
+
+    while (getNumInputSamplesNeeded (numOut + 1) <= numInputSamples)
+        ++numOut;
+
+    return numOut;
+}
+
+int SincResampler::process (const float* in, float* out, int numOut) noexcept
+{
+    return processInternal<false> (in, out, numOut, 1.0f);
+}
+
+int SincResampler::processAdding (const float* in, float* out, int numOut, float gain) noexcept
+{
+    return processInternal<true> (in, out, numOut, gain);
+}
+
+template <bool adding>
+int SincResampler::processInternal (const float* in, float* out, int numOut, float gain) noexcept
+{
+    using namespace SincResamplerHelpers;
+
+    auto numIn = getNumInputSamplesNeeded (numOut);
+    auto numInLeft = numIn;
+    auto& t = *table;
+    auto numTaps = t.numTaps;
+
+    while (numOut > 0)
+    {
+        if (numInHistory == 0 && readPos > 0)
+        {
+            // the last block skipped past the end of the input it was given
+            auto numToSkip = jmin (readPos, numInLeft);
+            in += numToSkip;
+            numInLeft -= numToSkip;
+            readPos -= numToSkip;
+        }
+
+        auto numToCopy = jmin (numInLeft, historySize - numInHistory);
+        FloatVectorOperations::copy (history + numInHistory, in, numToCopy);
+        in += numToCopy;
+        numInLeft -= numToCopy;
+        numInHistory += numToCopy;
+
+        auto numOutBefore = numOut;
+
+        while (numOut > 0 && readPos + numTaps <= numInHistory)
+        {
+            auto* x = history + readPos;
+            float sample;
+
+            if (t.isIdentity)
+            {
+                sample = x[t.lookAhead - 1];
+            }
+            else if (t.isInterpolated)
+            {
+                auto row = (int) (phase >> t.phaseShift);
+                auto fraction = (float) (phase & t.phaseMask) * t.fractionScale;
+
+                float s1, s2;
+                dualDotProduct (x, t.getRow (row), t.getRow (row + 1), numTaps, s1, s2);
+                sample = s1 + fraction * (s2 - s1);
+            }
+            else
+            {
+                sample = dotProduct (x, t.getRow ((int) phase), numTaps);
+            }
+
+            if (adding)
+                *out++ += gain * sample;
+            else
+                *out++ = sample;
+
+            --numOut;
+            readPos += samplesStep;
+            phase += phaseStep;
+
+            if (phase >= t.phaseResolution)
+            {
+                phase -= t.phaseResolution;
+                ++readPos;
+            }
+        }
+
+        auto numToDiscard = jmin (readPos, numInHistory);
+
+        if (numToDiscard > 0)
+        {
+            numInHistory -= numToDiscard;
+            readPos -= numToDiscard;
+            memmove (history, history + numToDiscard, (size_t) numInHistory * sizeof (float));
+        }
+
+        if (numToCopy == 0 && numOut == numOutBefore)
+        {
+            jassertfalse; // this shouldn't be possible!
+            break;
+        }
+    }
+
+    jassert (numInLeft == 0);
+    return numIn;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class SincResamplerTests  : public UnitTest
+{
+public:
+    SincResamplerTests()  : UnitTest ("SincResampler", "Audio") {}
+
+    void runTest() override
+    {
+        const SincResampler::Quality qualities[] = { SincResampler::Quality::low, SincResampler::Quality::medium,
+                                                     SincResampler::Quality::high, SincResampler::Quality::best };
+        const char* qualityNames[] = { "low", "medium", "high", "best" };
+        const double minimumTHDPlusN[] = { 60.0, 80.0, 100.0, 120.0 };
+
+        const double rates[][2] = { { 44100.0, 48000.0 }, { 48000.0, 44100.0 },
+                                    { 44100.0, 96000.0 }, { 96000.0, 44100.0 },
+                                    { 44100.0, 37801.2345 }, { 48000.0, 36000.0 }, { 44100.0, 17640.0 } };
+
+        for (int q = 0; q < 4; ++q)
+        {
+            beginTest (String ("THD+N, ") + qualityNames[q] + " quality");
+
+            for (auto& r : rates)
+            {
+                auto thdn = measureTHDPlusN (qualities[q], r[0], r[1], 1000.0);
+                logMessage (String (r[0]) + " -> " + String (r[1]) + ": " + String (thdn, 1) + " dB");
+                expect (thdn > minimumTHDPlusN[q]);
+            }
+        }
+
+        beginTest ("Alias rejection");
+        {
+            const double minimumRejection[] = { 60.0, 80.0, 100.0, 120.0 };
+
+            for (int q = 0; q < 4; ++q)
+            {
+                // a 30kHz tone has nowhere to go at 44.1kHz, so should be filtered out completely
+                auto rejection = measureRejection (qualities[q], 96000.0, 44100.0, 30000.0);
+                logMessage (String (qualityNames[q]) + ": " + String (rejection, 1) + " dB");
+                expect (rejection > minimumRejection[q]);
+            }
+        }
+
+        beginTest ("Block sizes");
+        {
+            for (auto r : { 44100.0 / 48000.0, 96000.0 / 44100.0, 1.2345678, 0.5 })
+            {
+                const int numOut = 20000;
+                SincResampler single, streamed;
+                single.setRatio (r);
+                streamed.setRatio (r);
+
+                auto numIn = single.getNumInputSamplesNeeded (numOut);
+                auto input = makeSine (0.01, numIn, 0.5);
+                HeapBlock<float> expected (numOut), output (numOut);
+
+                expectEquals (single.process (input, expected, numOut), numIn);
+
+                auto random = getRandom();
+                int inPos = 0, outPos = 0;
+
+                while (outPos < numOut)
+                {
+                    auto num = jmin (numOut - outPos, random.nextInt (700) + 1);
+                    auto numNeeded = streamed.getNumInputSamplesNeeded (num);
+                    auto numAvailable = streamed.getNumOutputSamplesAvailable (numNeeded);
+                    expect (numAvailable >= num && streamed.getNumInputSamplesNeeded (numAvailable) == numNeeded);
+
+                    inPos += streamed.process (input + inPos, output + outPos, num);
+                    outPos += num;
+                }
+
+                expectEquals (inPos, numIn);
+                expect (memcmp (expected, output, numOut * sizeof (float)) == 0);
+            }
+        }
+
+        beginTest ("Ratio of 1");
+        {
+            const int num = 5000;
+            auto input = makeSine (0.0123, num, 0.5);
+            HeapBlock<float> output (num);
+
+            SincResampler resampler;
+            resampler.setRatio (2.0);
+            resampler.setRatio (1.0);
+
+            auto numIn = resampler.getNumInputSamplesNeeded (num);
+            expectEquals (numIn, num + resampler.getLookAhead());
+
+            HeapBlock<float> paddedInput (numIn, true);
+            FloatVectorOperations::copy (paddedInput, input, num);
+
+            resampler.process (paddedInput, output, num);
+            expect (memcmp (input.get(), output.get(), num * sizeof (float)) == 0);
+        }
+
+        beginTest ("Performance");
+        {
+            for (int q = 0; q < 4; ++q)
+            {
+                for (auto r : { 44100.0 / 48000.0, 1.2345678 })
+                {
+                    SincResampler resampler (qualities[q]);
+                    resampler.setRatio (r);
+
+                    const int blockSize = 512, numBlocks = 2000;
+                    auto input = makeSine (0.01, (int) (blockSize * r) + resampler.getLookAhead() + 2, 0.5);
+                    HeapBlock<float> output (blockSize);
+
+                    auto start = Time::getMillisecondCounterHiRes();
+
+                    for (int i = 0; i < numBlocks; ++i)
+                        resampler.process (input, output, blockSize);
+
+                    auto elapsed = (Time::getMillisecondCounterHiRes() - start) / 1000.0;
+                    auto samplesPerSecond = (blockSize * numBlocks) / jmax (elapsed, 1.0e-6);
+
+                    logMessage (String (qualityNames[q]) + ", ratio " + String (r, 4) + ": "
+                                  + String (samplesPerSecond / 1.0e6, 1) + " million samples per second");
+                }
+            }
+        }
+    }
+
+private:
+    static HeapBlock<float> makeSine (double cyclesPerSample, int numSamples, double amplitude)
+    {
+        HeapBlock<float> data (numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = (float) (amplitude * std::sin (MathConstants<double>::twoPi * cyclesPerSample * i));
+
+        return data;
+    }
+
+    static HeapBlock<float> resample (SincResampler::Quality quality, double inRate, double outRate,
+                                      double frequency, int numOut, int& numToSkip)
+    {
+        SincResampler resampler (quality);
+        resampler.setRatio (inRate / outRate);
+
+        auto numIn = resampler.getNumInputSamplesNeeded (numOut);
+        auto input = makeSine (frequency / inRate, numIn, 0.5);
+        HeapBlock<float> output (numOut);
+        resampler.process (input, output, numOut);
+
+        // skip the part that's affected by the sine starting suddenly at zero
+        numToSkip = (int) (2 * resampler.getLookAhead() * outRate / inRate) + 2;
+        return output;
+    }
+
+    // Fits a sine at the expected frequency to the output, and returns the ratio
+    // of its level to whatever is left over, in dB.
+    static double measureTHDPlusN (SincResampler::Quality quality, double inRate, double outRate, double frequency)
+    {
+        const int numOut = 16384;
+        int start;
+        auto output = resample (quality, inRate, outRate, frequency, numOut, start);
+
+        auto w = MathConstants<double>::twoPi * frequency / outRate;
+        double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0;
+
+        for (int i = start; i < numOut; ++i)
+        {
+            auto s = std::sin (w * i), c = std::cos (w * i);
+            ss += s * s;  sc += s * c;  cc += c * c;
+            ys += output[i] * s;  yc += output[i] * c;
+        }
+
+        auto det = ss * cc - sc * sc;
+        auto a = (ys * cc - yc * sc) / det;
+        auto b = (yc * ss - ys * sc) / det;
+
+        double signal = 0, residual = 0;
+
+        for (int i = start; i < numOut; ++i)
+        {
+            auto fitted = a * std::sin (w * i) + b * std::cos (w * i);
+            signal += fitted * fitted;
+            residual += (output[i] - fitted) * (output[i] - fitted);
+        }
+
+        return 10.0 * std::log10 (signal / jmax (residual, 1.0e-30));
+    }
+
+    static double measureRejection (SincResampler::Quality quality, double inRate, double outRate, double frequency)
+    {
+        const int numOut = 16384;
+        int start;
+        auto output = resample (quality, inRate, outRate, frequency, numOut, start);
+
+        double level = 0;
+
+        for (int i = start; i < numOut; ++i)
+            level += output[i] * output[i];
+
+        level /= (numOut - start);
+        return 10.0 * std::log10 (0.125 / jmax (level, 1.0e-30));
+    }
+};
+
+static SincResamplerTests sincResamplerTests;
+
+#endif
+
+} // namespace juce
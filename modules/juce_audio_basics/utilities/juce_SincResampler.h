@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A high-quality resampler for a stream of floats, using a polyphase windowed-sinc filter.
+
+    Unlike LagrangeInterpolator and CatmullRomInterpolator, this filters out everything
+    above the lower of the input and output Nyquist frequencies, so it doesn't add any
+    audible aliasing or imaging when converting between sample rates like 44.1, 48 and
+    96kHz. The quality setting trades the filter's length (and so its CPU cost and the
+    amount of look-ahead it needs) against how steep its cut-off is and how much it
+    attenuates the frequencies that it removes.
+
+    When the ratio is a simple fraction, as it is for all the usual sample rate
+    conversions, the filter's coefficients are calculated exactly for each of the
+    positions that the output samples can fall on. For other ratios, they're interpolated
+    from a finely-spaced table. Either way, the tables are shared between all the
+    resamplers that use the same settings.
+
+    Like the other interpolators, the resampler is stateful, so each channel needs its
+    own SincResampler object, and reset() should be called when there's a break in the
+    continuity of the input.
+
+    @see ResamplingAudioSource, LagrangeInterpolator
+
+    @tags{Audio}
+*/
+class JUCE_API  SincResampler
+{
+public:
+    //==============================================================================
+    /** The different trade-offs between quality and CPU use that the resampler can use. */
+    enum class Quality
+    {
+        low,        /**< 16 taps, about 60dB of stop-band attenuation. */
+        medium,     /**< 32 taps, about 80dB of stop-band attenuation. */
+        high,       /**< 64 taps, about 100dB of stop-band attenuation. */
+        best        /**< 128 taps, about 120dB of stop-band attenuation, and the flattest pass-band. */
+    };
+
+    /** Creates a resampler with a ratio of 1.0. */
+    explicit SincResampler (Quality quality = Quality::high);
+
+    /** Destructor. */
+    ~SincResampler();
+
+    //==============================================================================
+    /** Changes the quality setting.
+        This resets the resampler, and may need to allocate memory.
+    */
+    void setQuality (Quality newQuality);
+
+    /** Returns the current quality setting. */
+    Quality getQuality() const noexcept                     { return quality; }
+
+    /** Changes the number of input samples that are used for each output sample.
+
+        Values above 1.0 lower the sample rate, and values below it raise it. When lowering
+        the sample rate, the filter gets longer in proportion to the ratio, up to a ratio of
+        16 - beyond that, some aliasing will get through.
+
+        The ratio can be changed while the resampler is running, and the stream will carry
+        on from the same position. The first time that a particular ratio is used, the
+        coefficient table for it may need to be built, which allocates memory - to avoid
+        this happening on an audio thread, you can call preloadCoefficients() beforehand.
+    */
+    void setRatio (double inputSamplesPerOutputSample);
+
+    /** Returns the current ratio. */
+    double getRatio() const noexcept                        { return ratio; }
+
+    /** Resets the state of the resampler.
+        Call this when there's a break in the continuity of the input data stream.
+    */
+    void reset() noexcept;
+
+    /** Returns the number of input samples that the resampler reads ahead of the
+        position of the output sample that it's calculating.
+
+        The output isn't delayed by the filter - the first output sample corresponds to
+        the first input sample - but to produce it, this many extra input samples need to
+        have been supplied. At the end of a stream, supplying this many zeros will flush
+        out the remaining output.
+    */
+    int getLookAhead() const noexcept;
+
+    //==============================================================================
+    /** Returns the number of input samples that need to be passed to process() to
+        create a given number of output samples.
+    */
+    int getNumInputSamplesNeeded (int numOutputSamples) const noexcept;
+
+    /** Returns the number of output samples that could be produced by passing a given
+        number of input samples to process().
+    */
+    int getNumOutputSamplesAvailable (int numInputSamples) const noexcept;
+
+    /** Resamples a block of samples.
+
+        @param inputSamples                 the input data. This must contain the number of samples
+                                            returned by getNumInputSamplesNeeded() for the number
+                                            of samples that are being created
+        @param outputSamples                the buffer to write the results into
+        @param numOutputSamplesToProduce    the number of output samples to create
+        @returns the number of input samples that were used
+    */
+    int process (const float* inputSamples, float* outputSamples, int numOutputSamplesToProduce) noexcept;
+
+    /** Resamples a block of samples, adding the results to the output data with a gain.
+        @see process
+    */
+    int processAdding (const float* inputSamples, float* outputSamples, int numOutputSamplesToProduce, float gain) noexcept;
+
+    //==============================================================================
+    /** Builds the shared coefficient tables that a resampler with the given settings
+        will need, so that calling setRatio() later won't have to.
+
+        Up to 16 tables are kept, and the ones that were used least recently are
+        discarded first, so the tables for a ratio will still be there when it's
+        used, as long as it happens before many other ratios have been preloaded.
+    */
+    static void preloadCoefficients (Quality quality, double inputSamplesPerOutputSample);
+
+private:
+    //==============================================================================
+    struct Table;
+    struct TableCache;
+
+    Quality quality;
+    double ratio = 1.0;
+    std::shared_ptr<const Table> table;
+
+    HeapBlock<float> history;
+    int historySize = 0, numInHistory = 0, readPos = 0;
+    uint64 phase = 0, phaseStep = 0;
+    int samplesStep = 1;
+
+    static std::shared_ptr<const Table> getTable (Quality, double ratio, bool allowExactTable);
+    void updateTable();
+    uint64 getNumSamplesToAdvance (int numOutputSamples) const noexcept;
+
+    template <bool adding>
+    int processInternal (const float*, float*, int, float) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SincResampler)
+};
+
+} // namespace juce
@@ -174,7 +174,8 @@ void AudioDeviceManager::createAudioDeviceTypes (OwnedArray<AudioIODeviceType>&
     addIfNotNull (list, AudioIODeviceType::createAudioIODeviceType_ASIO());
     addIfNotNull (list, AudioIODeviceType::createAudioIODeviceType_CoreAudio());
     addIfNotNull (list, AudioIODeviceType::createAudioIODeviceType_iOSAudio());
-    addIfNotNull (list, AudioIODeviceType::createAudioIODeviceType_ALSA());
+    addIfNotNull (list, AudioIODeviceType::createAudioIODeviceType_ALSA (false));
+    addIfNotNull (list, AudioIODeviceType::createAudioIODeviceType_ALSA (true));
     addIfNotNull (list, AudioIODeviceType::createAudioIODeviceType_JACK());
     addIfNotNull (list, AudioIODeviceType::createAudioIODeviceType_Bela());
     addIfNotNull (list, AudioIODeviceType::createAudioIODeviceType_Oboe());
@@ -780,6 +781,8 @@ void AudioDeviceManager::audioDeviceAboutToStartInt (AudioIODevice* const device
     loadMeasurer.reset (device->getCurrentSampleRate(),
                         device->getCurrentBufferSizeSamples());
 
+    deviceXRunsAtStatisticsReset = jmax (0, device->getXRunCount());
+
     {
         const ScopedLock sl (audioCallbackLock);
 
@@ -815,6 +818,22 @@ double AudioDeviceManager::getCpuUsage() const
     return loadMeasurer.getLoadAsProportion();
 }
 
+AudioProcessLoadMeasurer::TimingStatistics AudioDeviceManager::getCallbackTimingStatistics() const
+{
+    auto stats = loadMeasurer.getTimingStatistics();
+
+    if (currentAudioDevice != nullptr)
+        stats.numXRuns += jmax (0, currentAudioDevice->getXRunCount() - deviceXRunsAtStatisticsReset);
+
+    return stats;
+}
+
+void AudioDeviceManager::resetCallbackTimingStatistics()
+{
+    loadMeasurer.resetTimingStatistics();
+    deviceXRunsAtStatisticsReset = currentAudioDevice != nullptr ? jmax (0, currentAudioDevice->getXRunCount()) : 0;
+}
+
 //==============================================================================
 void AudioDeviceManager::setMidiInputEnabled (const String& name, const bool enabled)
 {
@@ -1020,4 +1039,190 @@ int AudioDeviceManager::getXRunCount() const noexcept
     return jmax (0, deviceXRuns) + loadMeasurer.getXRunCount();
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AudioDeviceManagerTests  : public UnitTest
+{
+public:
+    AudioDeviceManagerTests()  : UnitTest ("AudioDeviceManager", "Audio") {}
+
+    void runTest() override
+    {
+        beginTest ("Callback timing statistics");
+        {
+            ScopedJuceInitialiser_GUI libraryInitialiser;
+
+            AudioDeviceManager manager;
+            manager.addAudioDeviceType (new MockDeviceType());
+            manager.setCurrentAudioDeviceType ("Mock", true);
+            expect (manager.initialiseWithDefaultDevices (0, 2).isEmpty());
+
+            auto* device = dynamic_cast<MockDevice*> (manager.getCurrentAudioDevice());
+            expect (device != nullptr && device->isPlaying());
+
+            if (device == nullptr)
+                return;
+
+            device->numXRuns = 5;
+            manager.resetCallbackTimingStatistics();
+
+            SleepingCallback callback;
+            manager.addAudioCallback (&callback);
+
+            device->processBlocks (20);
+            auto stats = manager.getCallbackTimingStatistics();
+
+            expect (stats.numCallbacks == 20);
+            expectEquals (stats.numXRuns, 0);
+            expect (stats.loadHistogram.size() == AudioProcessLoadMeasurer::numHistogramBands);
+
+            int numInLoadHistogram = 0;
+
+            for (auto n : stats.loadHistogram)
+                numInLoadHistogram += n;
+
+            expectEquals (numInLoadHistogram, 20);
+
+            // A callback that takes longer than a block (about 10ms here) is counted as an xrun,
+            // as are the xruns reported by the device since the statistics were reset.
+            callback.sleepMs = 30;
+            device->processBlocks (1);
+            callback.sleepMs = 0;
+            device->numXRuns = 7;
+
+            stats = manager.getCallbackTimingStatistics();
+            expect (stats.numCallbacks == 21);
+            expectEquals (stats.numXRuns, 3);
+            expect (stats.peakLoad > 1.0);
+            expectEquals (stats.loadHistogram.getLast(), 1);
+
+            manager.resetCallbackTimingStatistics();
+            stats = manager.getCallbackTimingStatistics();
+            expect (stats.numCallbacks == 0);
+            expectEquals (stats.numXRuns, 0);
+
+            // ..and when the device restarts, it's the xruns since then that count
+            manager.closeAudioDevice();
+            manager.restartLastAudioDevice();
+            device = dynamic_cast<MockDevice*> (manager.getCurrentAudioDevice());
+            expect (device != nullptr);
+
+            if (device == nullptr)
+                return;
+
+            device->numXRuns += 2;
+            device->processBlocks (3);
+            stats = manager.getCallbackTimingStatistics();
+            expect (stats.numCallbacks == 3);
+            expectEquals (stats.numXRuns, 2);
+
+            manager.removeAudioCallback (&callback);
+            manager.closeAudioDevice();
+            expectEquals (manager.getCallbackTimingStatistics().numXRuns, 0);
+        }
+    }
+
+private:
+    //==============================================================================
+    // A device that only calls its callback when processBlocks() is called
+    struct MockDevice  : public AudioIODevice
+    {
+        MockDevice()  : AudioIODevice ("Mock Device", "Mock") {}
+
+        StringArray getOutputChannelNames() override          { return { "Left", "Right" }; }
+        StringArray getInputChannelNames() override           { return {}; }
+        Array<double> getAvailableSampleRates() override      { return { 48000.0 }; }
+        Array<int> getAvailableBufferSizes() override         { return { blockSize }; }
+        int getDefaultBufferSize() override                   { return blockSize; }
+
+        String open (const BigInteger&, const BigInteger& outputs, double, int) override
+        {
+            activeOutputs = outputs;
+            opened = true;
+            return {};
+        }
+
+        void close() override                                 { stop(); opened = false; }
+        bool isOpen() override                                { return opened; }
+
+        void start (AudioIODeviceCallback* newCallback) override
+        {
+            if (newCallback != nullptr)
+                newCallback->audioDeviceAboutToStart (this);
+
+            callback = newCallback;
+        }
+
+        void stop() override
+        {
+            if (auto* oldCallback = callback)
+            {
+                callback = nullptr;
+                oldCallback->audioDeviceStopped();
+            }
+        }
+
+        bool isPlaying() override                             { return callback != nullptr; }
+        String getLastError() override                        { return {}; }
+        int getCurrentBufferSizeSamples() override            { return blockSize; }
+        double getCurrentSampleRate() override                { return 48000.0; }
+        int getCurrentBitDepth() override                     { return 32; }
+        BigInteger getActiveOutputChannels() const override   { return activeOutputs; }
+        BigInteger getActiveInputChannels() const override    { return {}; }
+        int getOutputLatencyInSamples() override              { return 0; }
+        int getInputLatencyInSamples() override               { return 0; }
+        int getXRunCount() const noexcept override            { return numXRuns; }
+
+        void processBlocks (int numBlocks)
+        {
+            AudioBuffer<float> buffer (2, blockSize);
+
+            for (int i = 0; i < numBlocks && callback != nullptr; ++i)
+                callback->audioDeviceIOCallback (nullptr, 0, buffer.getArrayOfWritePointers(), 2, blockSize);
+        }
+
+        enum { blockSize = 512 };
+
+        AudioIODeviceCallback* callback = nullptr;
+        BigInteger activeOutputs;
+        bool opened = false;
+        int numXRuns = 4;  // (e.g. a server that's shared with other apps may have counted some already)
+    };
+
+    struct MockDeviceType  : public AudioIODeviceType
+    {
+        MockDeviceType()  : AudioIODeviceType ("Mock") {}
+
+        void scanForDevices() override                                      {}
+        StringArray getDeviceNames (bool wantInputNames) const override     { return wantInputNames ? StringArray() : StringArray ("Mock Device"); }
+        int getDefaultDeviceIndex (bool) const override                     { return 0; }
+        int getIndexOfDevice (AudioIODevice* device, bool asInput) const override  { return device != nullptr && ! asInput ? 0 : -1; }
+        bool hasSeparateInputsAndOutputs() const override                   { return false; }
+
+        AudioIODevice* createDevice (const String& outputDeviceName, const String&) override
+        {
+            return outputDeviceName == "Mock Device" ? new MockDevice() : nullptr;
+        }
+    };
+
+    struct SleepingCallback  : public AudioIODeviceCallback
+    {
+        void audioDeviceIOCallback (const float**, int, float**, int, int) override
+        {
+            if (sleepMs > 0)
+                Thread::sleep (sleepMs);
+        }
+
+        void audioDeviceAboutToStart (AudioIODevice*) override  {}
+        void audioDeviceStopped() override                      {}
+
+        int sleepMs = 0;
+    };
+};
+
+static AudioDeviceManagerTests audioDeviceManagerTests;
+
+#endif
+
 } // namespace juce
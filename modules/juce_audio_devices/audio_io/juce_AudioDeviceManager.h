@@ -304,6 +304,23 @@ public:
     */
     double getCpuUsage() const;
 
+    /** Returns a summary of the load and timing jitter of the audio callbacks, with a
+        histogram of each, measured since the device was started or since
+        resetCallbackTimingStatistics() was last called.
+
+        The numXRuns value includes any xruns reported by the device itself. As that means
+        asking the current device, this must only be called on the message thread (or
+        whichever thread you use to open and close devices), where the device can't be
+        deleted while it's being used. It can be polled from a timer to keep an eye on how
+        much headroom the audio callbacks have.
+    */
+    AudioProcessLoadMeasurer::TimingStatistics getCallbackTimingStatistics() const;
+
+    /** Clears the statistics returned by getCallbackTimingStatistics().
+        Like getCallbackTimingStatistics(), this must only be called on the message thread.
+    */
+    void resetCallbackTimingStatistics();
+
     //==============================================================================
     /** Enables or disables a midi input device.
 
@@ -494,6 +511,7 @@ private:
     int testSoundPosition = 0;
 
     AudioProcessLoadMeasurer loadMeasurer;
+    std::atomic<int> deviceXRunsAtStatisticsReset { 0 };
 
     LevelMeter::Ptr inputLevelGetter   { new LevelMeter() },
                     outputLevelGetter  { new LevelMeter() };
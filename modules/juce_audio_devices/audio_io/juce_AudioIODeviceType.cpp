@@ -63,7 +63,7 @@ AudioIODeviceType* AudioIODeviceType::createAudioIODeviceType_ASIO()
 #endif
 
 #if ! (JUCE_LINUX && JUCE_ALSA)
-AudioIODeviceType* AudioIODeviceType::createAudioIODeviceType_ALSA()            { return nullptr; }
+AudioIODeviceType* AudioIODeviceType::createAudioIODeviceType_ALSA (bool)        { return nullptr; }
 #endif
 
 #if ! (JUCE_LINUX && JUCE_JACK)
@@ -155,8 +155,14 @@ public:
     static AudioIODeviceType* createAudioIODeviceType_DirectSound();
     /** Creates an ASIO device type if it's available on this platform, or returns null. */
     static AudioIODeviceType* createAudioIODeviceType_ASIO();
-    /** Creates an ALSA device type if it's available on this platform, or returns null. */
-    static AudioIODeviceType* createAudioIODeviceType_ALSA();
+    /** Creates an ALSA device type if it's available on this platform, or returns null.
+
+        If lowLatencyMode is true, this returns a separate type whose devices use mmap
+        transfers, fewer periods, and a SCHED_FIFO audio thread with the process's memory
+        locked, and which write a latency and xrun report to the Logger when they're closed.
+        This needs the JUCE_ALSA_LOW_LATENCY flag to be enabled, or it'll return null.
+    */
+    static AudioIODeviceType* createAudioIODeviceType_ALSA (bool lowLatencyMode = false);
     /** Creates a JACK device type if it's available on this platform, or returns null. */
     static AudioIODeviceType* createAudioIODeviceType_JACK();
     /** Creates an Android device type if it's available on this platform, or returns null. */
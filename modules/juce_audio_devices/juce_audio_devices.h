@@ -117,6 +117,15 @@
  #define JUCE_ALSA 1
 #endif
 
+/** Config: JUCE_ALSA_LOW_LATENCY
+    Enables an extra "ALSA (Low Latency)" device type, whose devices use mmap transfers
+    and a SCHED_FIFO audio thread with locked memory (Linux only). The audio thread
+    can only be promoted if the user's rtprio and memlock limits allow it.
+*/
+#ifndef JUCE_ALSA_LOW_LATENCY
+ #define JUCE_ALSA_LOW_LATENCY 0
+#endif
+
 /** Config: JUCE_JACK
     Enables JACK audio devices (Linux only).
 */
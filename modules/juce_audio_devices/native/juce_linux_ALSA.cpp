@@ -149,13 +149,14 @@ static void silentErrorHandler (const char*, int, const char*, int, const char*,
 class ALSADevice
 {
 public:
-    ALSADevice (const String& devID, bool forInput)
+    ALSADevice (const String& devID, bool forInput, bool useLowLatencyMode)
         : handle (nullptr),
           bitDepth (16),
           numChannelsRunning (0),
           latency (0),
           deviceID (devID),
           isInput (forInput),
+          lowLatencyMode (useLowLatencyMode),
           isInterleaved (true)
     {
         JUCE_ALSA_LOG ("snd_pcm_open (" << deviceID.toUTF8().getAddress() << ", forInput=" << (int) forInput << ")");
@@ -210,7 +211,21 @@ public:
             return false;
         }
 
-        if (snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED) >= 0) // works better for plughw..
+        isMMap = false;
+
+        // In low-latency mode, we try to use mmap transfers, which let us convert the samples
+        // straight into the device's ring buffer rather than going via our scratch buffer
+        if (lowLatencyMode && snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_MMAP_INTERLEAVED) >= 0)
+        {
+            isInterleaved = true;
+            isMMap = true;
+        }
+        else if (lowLatencyMode && snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_MMAP_NONINTERLEAVED) >= 0)
+        {
+            isInterleaved = false;
+            isMMap = true;
+        }
+        else if (snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED) >= 0) // works better for plughw..
             isInterleaved = true;
         else if (snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_RW_NONINTERLEAVED) >= 0)
             isInterleaved = false;
@@ -258,7 +273,7 @@ public:
         }
 
         int dir = 0;
-        unsigned int periods = 4;
+        unsigned int periods = lowLatencyMode ? 2 : 4;
         snd_pcm_uframes_t samplesPerPeriod = (snd_pcm_uframes_t) bufferSize;
 
         if (JUCE_ALSA_FAILED (snd_pcm_hw_params_set_rate_near (handle, hwParams, &sampleRate, 0))
@@ -281,6 +296,8 @@ public:
         JUCE_ALSA_LOG ("frames: " << (int) frames << ", periods: " << (int) periods
                           << ", samplesPerPeriod: " << (int) samplesPerPeriod);
 
+        numPeriods = (int) periods;
+
         snd_pcm_sw_params_t* swParams;
         snd_pcm_sw_params_alloca (&swParams);
         snd_pcm_uframes_t boundary;
@@ -313,6 +330,10 @@ public:
     bool writeToOutputDevice (AudioBuffer<float>& outputChannelBuffer, const int numSamples)
     {
         jassert (numChannelsRunning <= outputChannelBuffer.getNumChannels());
+
+        if (isMMap)
+            return transferUsingMMap (outputChannelBuffer, numSamples);
+
         float* const* const data = outputChannelBuffer.getArrayOfWritePointers();
         snd_pcm_sframes_t numDone = 0;
 
@@ -351,6 +372,10 @@ public:
     bool readFromInputDevice (AudioBuffer<float>& inputChannelBuffer, const int numSamples)
     {
         jassert (numChannelsRunning <= inputChannelBuffer.getNumChannels());
+
+        if (isMMap)
+            return transferUsingMMap (inputChannelBuffer, numSamples);
+
         float* const* const data = inputChannelBuffer.getArrayOfWritePointers();
 
         if (isInterleaved)
@@ -399,6 +424,9 @@ public:
         return true;
     }
 
+    bool isUsingMMap() const noexcept       { return isMMap; }
+    int getNumPeriods() const noexcept      { return numPeriods; }
+
     //==============================================================================
     snd_pcm_t* handle;
     String error;
@@ -408,11 +436,121 @@ public:
 private:
     //==============================================================================
     String deviceID;
-    const bool isInput;
-    bool isInterleaved;
+    const bool isInput, lowLatencyMode;
+    bool isInterleaved, isMMap = false;
+    int numPeriods = 0;
     MemoryBlock scratch;
     std::unique_ptr<AudioData::Converter> converter;
 
+    //==============================================================================
+    bool transferUsingMMap (AudioBuffer<float>& buffer, const int numSamples)
+    {
+        float* const* const data = buffer.getArrayOfWritePointers();
+        int numDone = 0;
+
+        while (numDone < numSamples)
+        {
+            auto avail = snd_pcm_avail_update (handle);
+
+            if (avail < 0)
+            {
+                if (! recoverFromError ((int) avail))
+                    return false;
+
+                continue;
+            }
+
+            if (avail == 0)
+            {
+                // a capture stream has to be started before any data can arrive..
+                if (snd_pcm_state (handle) == SND_PCM_STATE_PREPARED)
+                {
+                    if (JUCE_ALSA_FAILED (snd_pcm_start (handle)))
+                        return false;
+
+                    continue;
+                }
+
+                auto waitResult = snd_pcm_wait (handle, 1000);
+
+                if (waitResult < 0 && ! recoverFromError (waitResult))
+                    return false;
+
+                if (waitResult == 0)
+                {
+                    JUCE_ALSA_LOG ("Timed out waiting for the device: numDone: " << numDone << ", numSamples: " << numSamples);
+
+                    // Like a short read or write, this isn't treated as a failure, but the part
+                    // of an input block that never arrived mustn't hold whatever was there before
+                    if (isInput)
+                        for (int i = 0; i < numChannelsRunning; ++i)
+                            buffer.clear (i, numDone, numSamples - numDone);
+
+                    return true;
+                }
+
+                continue;
+            }
+
+            const snd_pcm_channel_area_t* areas = nullptr;
+            snd_pcm_uframes_t offset = 0;
+            auto frames = (snd_pcm_uframes_t) (numSamples - numDone);
+
+            auto err = snd_pcm_mmap_begin (handle, &areas, &offset, &frames);
+
+            if (err < 0)
+            {
+                if (! recoverFromError (err))
+                    return false;
+
+                continue;
+            }
+
+            for (int i = 0; i < numChannelsRunning; ++i)
+            {
+                auto& area = areas[i];
+                auto* deviceData = static_cast<char*> (area.addr) + (area.first + offset * area.step) / 8;
+
+                if (isInput)
+                    converter->convertSamples (data[i] + numDone, 0, deviceData, 0, (int) frames);
+                else
+                    converter->convertSamples (deviceData, 0, data[i] + numDone, 0, (int) frames);
+            }
+
+            auto numCommitted = snd_pcm_mmap_commit (handle, offset, frames);
+
+            if (numCommitted < 0)
+            {
+                if (! recoverFromError ((int) numCommitted))
+                    return false;
+
+                continue;
+            }
+
+            numDone += (int) numCommitted;
+
+            // unlike snd_pcm_writei, committing doesn't start a playback stream
+            if (! isInput && snd_pcm_state (handle) == SND_PCM_STATE_PREPARED)
+                if (JUCE_ALSA_FAILED (snd_pcm_start (handle)))
+                    return false;
+        }
+
+        return true;
+    }
+
+    bool recoverFromError (int err)
+    {
+        if (err == -(EPIPE))
+        {
+            if (isInput)
+                overrunCount++;
+            else
+                underrunCount++;
+        }
+
+        return ! JUCE_ALSA_FAILED (snd_pcm_recover (handle, err, 1 /* silent */));
+    }
+
     //==============================================================================
     template <class SampleType>
     struct ConverterHelper
@@ -482,14 +620,43 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ALSADevice)
 };
 
+//==============================================================================
+/*  In low-latency mode, the process's memory is kept locked while any devices are
+    open, so that the audio thread can't be held up by a page fault.
+*/
+struct ALSAMemoryLock
+{
+    ALSAMemoryLock()
+    {
+        const SpinLock::ScopedLockType sl (getLock());
+
+        if (getNumLocks()++ == 0 && mlockall (MCL_CURRENT | MCL_FUTURE) != 0)
+            JUCE_ALSA_LOG ("mlockall failed - check the memlock limit in /etc/security/limits.conf");
+    }
+
+    ~ALSAMemoryLock()
+    {
+        const SpinLock::ScopedLockType sl (getLock());
+
+        if (--getNumLocks() == 0)
+            munlockall();
+    }
+
+    static SpinLock& getLock()      { static SpinLock lock; return lock; }
+    static int& getNumLocks()       { static int numLocks = 0; return numLocks; }
+
+    JUCE_DECLARE_NON_COPYABLE (ALSAMemoryLock)
+};
+
 //==============================================================================
 class ALSAThread  : public Thread
 {
 public:
-    ALSAThread (const String& inputDeviceID, const String& outputDeviceID)
+    ALSAThread (const String& inputDeviceID, const String& outputDeviceID, bool useLowLatencyMode)
         : Thread ("JUCE ALSA"),
           inputId (inputDeviceID),
-          outputId (outputDeviceID)
+          outputId (outputDeviceID),
+          lowLatencyMode (useLowLatencyMode)
     {
         initialiseRatesAndChannels();
     }
@@ -546,7 +713,7 @@ public:
 
         if (inputChannelDataForCallback.size() > 0 && inputId.isNotEmpty())
         {
-            inputDevice.reset (new ALSADevice (inputId, true));
+            inputDevice.reset (new ALSADevice (inputId, true, lowLatencyMode));
 
             if (inputDevice->error.isNotEmpty())
             {
@@ -583,7 +750,7 @@ public:
 
         if (outputChannelDataForCallback.size() > 0 && outputId.isNotEmpty())
         {
-            outputDevice.reset (new ALSADevice (outputId, false));
+            outputDevice.reset (new ALSADevice (outputId, false, lowLatencyMode));
 
             if (outputDevice->error.isNotEmpty())
             {
@@ -620,6 +787,11 @@ public:
         if (outputDevice != nullptr && JUCE_ALSA_FAILED (snd_pcm_prepare (outputDevice->handle)))
             return;
 
+        stats = {};
+
+        if (lowLatencyMode)
+            memoryLock.reset (new ALSAMemoryLock());
+
         startThread (9);
 
         int count = 1000;
@@ -659,6 +831,10 @@ public:
 
         stopThread (6000);
 
+        if (lowLatencyMode && numCallbacks > 0)
+            Logger::writeToLog (getLatencyReport());
+
+        memoryLock.reset();
         inputDevice.reset();
         outputDevice.reset();
 
@@ -676,6 +852,9 @@ public:
 
     void run() override
     {
+        if (lowLatencyMode)
+            stats.isRealtime = switchToFifoScheduling();
+
         while (! threadShouldExit())
         {
             if (inputDevice != nullptr && inputDevice->handle != nullptr)
@@ -707,6 +886,9 @@ public:
             if (threadShouldExit())
                 break;
 
+            if (lowLatencyMode)
+                stats.addCallback (Time::getHighResolutionTicks(), bufferSize / sampleRate);
+
             {
                 const ScopedLock sl (callbackLock);
                 ++numCallbacks;
@@ -748,6 +930,15 @@ public:
 
                 audioIoInProgress = false;
             }
+
+            if (lowLatencyMode)
+            {
+                auto* device = outputDevice != nullptr ? outputDevice.get() : inputDevice.get();
+                snd_pcm_sframes_t delay = 0;
+
+                if (device->handle != nullptr && snd_pcm_delay (device->handle, &delay) >= 0)
+                    stats.addDelay ((int) delay);
+            }
         }
 
         audioIoInProgress = false;
@@ -777,6 +968,31 @@ public:
         return result;
     }
 
+    String getLatencyReport() const
+    {
+        String report ("ALSA low-latency mode: ");
+
+        report << sampleRate << " Hz, " << bufferSize << " samples";
+
+        if (auto* device = outputDevice != nullptr ? outputDevice.get() : inputDevice.get())
+            report << " x " << device->getNumPeriods() << " periods, "
+                   << (device->isUsingMMap() ? "mmap" : "read/write") << " transfers";
+
+        report << ", " << (stats.isRealtime ? "SCHED_FIFO" : "not real-time")
+               << "\n  callbacks: " << stats.numCallbacks
+               << ", xruns: " << getXRunCount();
+
+        if (stats.numDelays > 0)
+            report << "\n  " << (outputDevice != nullptr ? "playback" : "capture") << " delay (samples): min "
+                   << stats.minDelay << ", average " << roundToInt ((double) stats.totalDelay / (double) stats.numDelays)
+                   << ", max " << stats.maxDelay;
+
+        report << "\n  callback interval: worst jitter " << String (stats.maxJitterSeconds * 1000.0, 3)
+               << " ms, longest " << String (stats.maxIntervalSeconds * 1000.0, 3) << " ms";
+
+        return report;
+    }
+
     //==============================================================================
     String error;
     double sampleRate = 0;
@@ -790,10 +1006,45 @@ public:
 private:
     //==============================================================================
     const String inputId, outputId;
+    const bool lowLatencyMode;
     std::unique_ptr<ALSADevice> outputDevice, inputDevice;
+    std::unique_ptr<ALSAMemoryLock> memoryLock;
     int numCallbacks = 0;
     bool audioIoInProgress = false;
 
+    // These measurements are only made in low-latency mode, and are written to the
+    // Logger when the device is closed
+    struct LatencyStats
+    {
+        void addCallback (int64 ticks, double expectedInterval) noexcept
+        {
+            if (lastCallbackTicks != 0)
+            {
+                auto interval = Time::highResolutionTicksToSeconds (ticks - lastCallbackTicks);
+                maxIntervalSeconds = jmax (maxIntervalSeconds, interval);
+                maxJitterSeconds = jmax (maxJitterSeconds, std::abs (interval - expectedInterval));
+            }
+
+            lastCallbackTicks = ticks;
+            ++numCallbacks;
+        }
+
+        void addDelay (int delay) noexcept
+        {
+            minDelay = numDelays == 0 ? delay : jmin (minDelay, delay);
+            maxDelay = jmax (maxDelay, delay);
+            totalDelay += delay;
+            ++numDelays;
+        }
+
+        int64 numCallbacks = 0, numDelays = 0, totalDelay = 0, lastCallbackTicks = 0;
+        int minDelay = 0, maxDelay = 0;
+        double maxIntervalSeconds = 0, maxJitterSeconds = 0;
+        bool isRealtime = false;
+    };
+
+    LatencyStats stats;
+
     CriticalSection callbackLock;
 
     AudioBuffer<float> inputChannelBuffer, outputChannelBuffer;
@@ -813,6 +1064,22 @@ private:
         return true;
     }
 
+    static bool switchToFifoScheduling()
+    {
+        auto minPriority = sched_get_priority_min (SCHED_FIFO);
+        auto maxPriority = sched_get_priority_max (SCHED_FIFO);
+
+        sched_param param;
+        zerostruct (param);
+        param.sched_priority = minPriority + (maxPriority - minPriority) * 8 / 10;
+
+        if (pthread_setschedparam (pthread_self(), SCHED_FIFO, &param) == 0)
+            return true;
+
+        JUCE_ALSA_LOG ("Couldn't use SCHED_FIFO - check the rtprio limit in /etc/security/limits.conf");
+        return false;
+    }
+
     void initialiseRatesAndChannels()
     {
         sampleRates.clear();
@@ -845,11 +1112,13 @@ public:
     ALSAAudioIODevice (const String& deviceName,
                        const String& deviceTypeName,
                        const String& inputDeviceID,
-                       const String& outputDeviceID)
+                       const String& outputDeviceID,
+                       bool useLowLatencyMode)
         : AudioIODevice (deviceName, deviceTypeName),
           inputId (inputDeviceID),
           outputId (outputDeviceID),
-          internal (inputDeviceID, outputDeviceID)
+          lowLatencyMode (useLowLatencyMode),
+          internal (inputDeviceID, outputDeviceID, useLowLatencyMode)
     {
     }
 
@@ -880,7 +1149,7 @@ public:
         return r;
     }
 
-    int getDefaultBufferSize() override                      { return 512; }
+    int getDefaultBufferSize() override                      { return lowLatencyMode ? 128 : 512; }
 
     String open (const BigInteger& inputChannels,
                  const BigInteger& outputChannels,
@@ -962,6 +1231,7 @@ public:
     String inputId, outputId;
 
 private:
+    const bool lowLatencyMode;
     bool isOpen_ = false, isStarted = false;
     ALSAThread internal;
 };
@@ -971,9 +1241,10 @@ private:
 class ALSAAudioIODeviceType  : public AudioIODeviceType
 {
 public:
-    ALSAAudioIODeviceType (bool onlySoundcards, const String& deviceTypeName)
+    ALSAAudioIODeviceType (bool onlySoundcards, const String& deviceTypeName, bool useLowLatencyMode = false)
         : AudioIODeviceType (deviceTypeName),
-          listOnlySoundcards (onlySoundcards)
+          listOnlySoundcards (onlySoundcards),
+          lowLatencyMode (useLowLatencyMode)
     {
        #if ! JUCE_ALSA_LOGGING
         snd_lib_error_set_handler (&silentErrorHandler);
@@ -1054,7 +1325,8 @@ public:
         if (inputIndex >= 0 || outputIndex >= 0)
             return new ALSAAudioIODevice (deviceName, getTypeName(),
                                           inputIds [inputIndex],
-                                          outputIds [outputIndex]);
+                                          outputIds [outputIndex],
+                                          lowLatencyMode);
 
         return nullptr;
     }
@@ -1063,7 +1335,7 @@ private:
     //==============================================================================
     StringArray inputNames, outputNames, inputIds, outputIds;
     bool hasScanned = false;
-    const bool listOnlySoundcards;
+    const bool listOnlySoundcards, lowLatencyMode;
 
     bool testDevice (const String& id, const String& outputName, const String& inputName)
     {
@@ -1299,9 +1571,16 @@ AudioIODeviceType* createAudioIODeviceType_ALSA_PCMDevices()
     return new ALSAAudioIODeviceType (false, "ALSA");
 }
 
-AudioIODeviceType* AudioIODeviceType::createAudioIODeviceType_ALSA()
+AudioIODeviceType* AudioIODeviceType::createAudioIODeviceType_ALSA (bool lowLatencyMode)
 {
-    return createAudioIODeviceType_ALSA_PCMDevices();
+    if (! lowLatencyMode)
+        return createAudioIODeviceType_ALSA_PCMDevices();
+
+   #if JUCE_ALSA_LOW_LATENCY
+    return new ALSAAudioIODeviceType (false, "ALSA (Low Latency)", true);
+   #else
+    return nullptr;
+   #endif
 }
 
 } // namespace juce
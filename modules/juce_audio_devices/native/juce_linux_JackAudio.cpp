@@ -195,6 +195,8 @@ public:
 
             inChans.calloc (totalNumberOfInputChannels + 2);
             outChans.calloc (totalNumberOfOutputChannels + 2);
+            activeInputPorts.ensureStorageAllocated (totalNumberOfInputChannels);
+            activeOutputPorts.ensureStorageAllocated (totalNumberOfOutputChannels);
         }
     }
 
@@ -373,25 +375,19 @@ public:
 private:
     void process (const int numSamples)
     {
-        int numActiveInChans = 0, numActiveOutChans = 0;
+        const ScopedLock sl (callbackLock);
 
-        for (int i = 0; i < totalNumberOfInputChannels; ++i)
-        {
-            if (activeInputChannels[i])
-                if (jack_default_audio_sample_t* in
-                        = (jack_default_audio_sample_t*) juce::jack_port_get_buffer ((jack_port_t*) inputPorts.getUnchecked(i), numSamples))
-                    inChans [numActiveInChans++] = (float*) in;
-        }
+        // The lists of active ports are only rebuilt when the connections change, but JACK
+        // doesn't allow the buffer addresses to be cached, so these are fetched for each cycle
+        int numActiveInChans = 0, numActiveOutChans = 0;
 
-        for (int i = 0; i < totalNumberOfOutputChannels; ++i)
-        {
-            if (activeOutputChannels[i])
-                if (jack_default_audio_sample_t* out
-                        = (jack_default_audio_sample_t*) juce::jack_port_get_buffer ((jack_port_t*) outputPorts.getUnchecked(i), numSamples))
-                    outChans [numActiveOutChans++] = (float*) out;
-        }
+        for (auto* port : activeInputPorts)
+            if (auto* in = (jack_default_audio_sample_t*) juce::jack_port_get_buffer (port, (jack_nframes_t) numSamples))
+                inChans [numActiveInChans++] = (float*) in;
 
-        const ScopedLock sl (callbackLock);
+        for (auto* port : activeOutputPorts)
+            if (auto* out = (jack_default_audio_sample_t*) juce::jack_port_get_buffer (port, (jack_nframes_t) numSamples))
+                outChans [numActiveOutChans++] = (float*) out;
 
         if (callback != nullptr)
         {
@@ -444,6 +440,20 @@ private:
             activeOutputChannels = newOutputChannels;
             activeInputChannels  = newInputChannels;
 
+            {
+                const ScopedLock sl (callbackLock);
+                activeInputPorts.clearQuick();
+                activeOutputPorts.clearQuick();
+
+                for (int i = 0; i < inputPorts.size(); ++i)
+                    if (activeInputChannels[i])
+                        activeInputPorts.add ((jack_port_t*) inputPorts.getUnchecked (i));
+
+                for (int i = 0; i < outputPorts.size(); ++i)
+                    if (activeOutputChannels[i])
+                        activeOutputPorts.add ((jack_port_t*) outputPorts.getUnchecked (i));
+            }
+
             if (oldCallback != nullptr)
                 start (oldCallback);
 
@@ -490,9 +500,10 @@ private:
     int totalNumberOfInputChannels;
     int totalNumberOfOutputChannels;
     Array<void*> inputPorts, outputPorts;
+    Array<jack_port_t*> activeInputPorts, activeOutputPorts;
     BigInteger activeInputChannels, activeOutputChannels;
 
-    int xruns;
+    std::atomic<int> xruns { 0 };
 };
 
 
@@ -36,6 +36,27 @@ AudioTransportSource::~AudioTransportSource()
 void AudioTransportSource::setSource (PositionableAudioSource* const newSource,
                                       int readAheadSize, TimeSliceThread* readAheadThread,
                                       double sourceSampleRateToCorrectFor, int maxNumChannels)
+{
+    // If you want to use a read-ahead buffer, you must also provide a TimeSliceThread
+    // for it to use!
+    jassert (readAheadSize <= 0 || newSource == nullptr || readAheadThread != nullptr);
+
+    setSourceInternal (newSource, readAheadSize, readAheadThread, nullptr,
+                       sourceSampleRateToCorrectFor, maxNumChannels);
+}
+
+void AudioTransportSource::setSource (PositionableAudioSource* const newSource,
+                                      int readAheadSize, AudioStreamingEngine& streamingEngine,
+                                      double sourceSampleRateToCorrectFor, int maxNumChannels)
+{
+    setSourceInternal (newSource, readAheadSize, nullptr, &streamingEngine,
+                       sourceSampleRateToCorrectFor, maxNumChannels);
+}
+
+void AudioTransportSource::setSourceInternal (PositionableAudioSource* const newSource,
+                                              int readAheadSize, TimeSliceThread* readAheadThread,
+                                              AudioStreamingEngine* streamingEngine,
+                                              double sourceSampleRateToCorrectFor, int maxNumChannels)
 {
     if (source == newSource)
     {
@@ -49,24 +70,26 @@ void AudioTransportSource::setSource (PositionableAudioSource* const newSource,
     sourceSampleRate = sourceSampleRateToCorrectFor;
 
     ResamplingAudioSource* newResamplerSource = nullptr;
-    BufferingAudioSource* newBufferingSource = nullptr;
+    PositionableAudioSource* newBufferingSource = nullptr;
     PositionableAudioSource* newPositionableSource = nullptr;
     AudioSource* newMasterSource = nullptr;
 
     std::unique_ptr<ResamplingAudioSource> oldResamplerSource (resamplerSource);
-    std::unique_ptr<BufferingAudioSource> oldBufferingSource (bufferingSource);
+    std::unique_ptr<PositionableAudioSource> oldBufferingSource (bufferingSource);
     AudioSource* oldMasterSource = masterSource;
 
     if (newSource != nullptr)
     {
         newPositionableSource = newSource;
 
-        if (readAheadSize > 0)
+        if (readAheadSize > 0 && streamingEngine != nullptr)
+        {
+            newPositionableSource = newBufferingSource
+                = new StreamingAudioSource (newPositionableSource, *streamingEngine,
+                                            false, readAheadSize, maxNumChannels);
+        }
+        else if (readAheadSize > 0 && readAheadThread != nullptr)
         {
-            // If you want to use a read-ahead buffer, you must also provide a TimeSliceThread
-            // for it to use!
-            jassert (readAheadThread != nullptr);
-
             newPositionableSource = newBufferingSource
                 = new BufferingAudioSource (newPositionableSource, *readAheadThread,
                                             false, readAheadSize, maxNumChannels);
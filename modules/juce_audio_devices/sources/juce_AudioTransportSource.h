@@ -81,6 +81,28 @@ public:
                     double sourceSampleRateToCorrectFor = 0.0,
                     int maxNumChannels = 2);
 
+    /** Sets the reader that is being used as the input source, using an AudioStreamingEngine
+        to read ahead from it.
+
+        This works in the same way as the other setSource() method, but the reading-ahead is
+        done by a StreamingAudioSource instead of a BufferingAudioSource.
+
+        @param newSource                        the new input source to use. This may be a nullptr
+        @param readAheadBufferSize              the size of buffer to use for reading ahead
+        @param streamingEngine                  the engine that will do the reading. This must not be
+                                                deleted while the AudioTransportSource is still using it
+        @param sourceSampleRateToCorrectFor     if this is non-zero, it specifies the sample
+                                                rate of the source, and playback will be sample-rate
+                                                adjusted to maintain playback at the correct pitch. If
+                                                this is 0, no sample-rate adjustment will be performed
+        @param maxNumChannels                   the maximum number of channels that may need to be played
+    */
+    void setSource (PositionableAudioSource* newSource,
+                    int readAheadBufferSize,
+                    AudioStreamingEngine& streamingEngine,
+                    double sourceSampleRateToCorrectFor = 0.0,
+                    int maxNumChannels = 2);
+
     //==============================================================================
     /** Changes the current playback position in the source stream.
 
@@ -161,7 +183,7 @@ private:
     //==============================================================================
     PositionableAudioSource* source = nullptr;
     ResamplingAudioSource* resamplerSource = nullptr;
-    BufferingAudioSource* bufferingSource = nullptr;
+    PositionableAudioSource* bufferingSource = nullptr;
     PositionableAudioSource* positionableSource = nullptr;
     AudioSource* masterSource = nullptr;
 
@@ -173,6 +195,8 @@ private:
     bool isPrepared = false, inputStreamEOF = false;
 
     void releaseMasterResources();
+    void setSourceInternal (PositionableAudioSource*, int readAheadBufferSize, TimeSliceThread*,
+                            AudioStreamingEngine*, double sourceSampleRateToCorrectFor, int maxNumChannels);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioTransportSource)
 };
@@ -1011,27 +1011,33 @@ public:
         }
     }
 
-    void readMaxLevels (int64 startSampleInFile, int64 numSamples, Range<float>* results, int numChannelsToRead) override
+    void readLevels (int64 startSampleInFile, int numSections, int64 samplesPerSection,
+                     Range<float>* ranges, float* rmsLevels, int numChannelsToRead) override
     {
-        numSamples = jmin (numSamples, lengthInSamples - startSampleInFile);
+        auto numSamples = jmin (numSections * samplesPerSection, lengthInSamples - startSampleInFile);
 
         if (map == nullptr || numSamples <= 0 || ! mappedSection.contains (Range<int64> (startSampleInFile, startSampleInFile + numSamples)))
         {
             jassert (numSamples <= 0); // you must make sure that the window contains all the samples you're going to attempt to read.
 
-            for (int i = 0; i < numChannelsToRead; ++i)
-                results[i] = Range<float>();
+            for (int i = 0; i < numSections * numChannelsToRead; ++i)
+            {
+                ranges[i] = Range<float>();
+
+                if (rmsLevels != nullptr)
+                    rmsLevels[i] = 0;
+            }
 
             return;
         }
 
         switch (bitsPerSample)
         {
-            case 8:     scanMinAndMax<AudioData::UInt8> (startSampleInFile, numSamples, results, numChannelsToRead); break;
-            case 16:    scanMinAndMax<AudioData::Int16> (startSampleInFile, numSamples, results, numChannelsToRead); break;
-            case 24:    scanMinAndMax<AudioData::Int24> (startSampleInFile, numSamples, results, numChannelsToRead); break;
-            case 32:    if (usesFloatingPointData) scanMinAndMax<AudioData::Float32> (startSampleInFile, numSamples, results, numChannelsToRead);
-                        else                       scanMinAndMax<AudioData::Int32>   (startSampleInFile, numSamples, results, numChannelsToRead);
+            case 8:     scanLevels<AudioData::UInt8> (startSampleInFile, numSections, samplesPerSection, ranges, rmsLevels, numChannelsToRead); break;
+            case 16:    scanLevels<AudioData::Int16> (startSampleInFile, numSections, samplesPerSection, ranges, rmsLevels, numChannelsToRead); break;
+            case 24:    scanLevels<AudioData::Int24> (startSampleInFile, numSections, samplesPerSection, ranges, rmsLevels, numChannelsToRead); break;
+            case 32:    if (usesFloatingPointData) scanLevels<AudioData::Float32> (startSampleInFile, numSections, samplesPerSection, ranges, rmsLevels, numChannelsToRead);
+                        else                       scanLevels<AudioData::Int32>   (startSampleInFile, numSections, samplesPerSection, ranges, rmsLevels, numChannelsToRead);
                         break;
             default:    jassertfalse; break;
         }
@@ -1041,17 +1047,15 @@ private:
     const bool littleEndian;
 
     template <typename SampleType>
-    void scanMinAndMax (int64 startSampleInFile, int64 numSamples, Range<float>* results, int numChannelsToRead) const noexcept
+    void scanLevels (int64 startSampleInFile, int numSections, int64 samplesPerSection,
+                     Range<float>* ranges, float* rmsLevels, int numChannelsToRead) const noexcept
     {
-        for (int i = 0; i < numChannelsToRead; ++i)
-            results[i] = scanMinAndMaxForChannel<SampleType> (i, startSampleInFile, numSamples);
-    }
-
-    template <typename SampleType>
-    Range<float> scanMinAndMaxForChannel (int channel, int64 startSampleInFile, int64 numSamples) const noexcept
-    {
-        return littleEndian ? scanMinAndMaxInterleaved<SampleType, AudioData::LittleEndian> (channel, startSampleInFile, numSamples)
-                            : scanMinAndMaxInterleaved<SampleType, AudioData::BigEndian>    (channel, startSampleInFile, numSamples);
+        if (littleEndian)
+            scanLevelsInterleaved<SampleType, AudioData::LittleEndian> (startSampleInFile, numSections, samplesPerSection,
+                                                                        ranges, rmsLevels, numChannelsToRead);
+        else
+            scanLevelsInterleaved<SampleType, AudioData::BigEndian>    (startSampleInFile, numSections, samplesPerSection,
+                                                                        ranges, rmsLevels, numChannelsToRead);
     }
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MemoryMappedAiffReader)
@@ -828,27 +828,33 @@ public:
         }
     }
 
-    void readMaxLevels (int64 startSampleInFile, int64 numSamples, Range<float>* results, int numChannelsToRead) override
+    void readLevels (int64 startSampleInFile, int numSections, int64 samplesPerSection,
+                     Range<float>* ranges, float* rmsLevels, int numChannelsToRead) override
     {
-        numSamples = jmin (numSamples, lengthInSamples - startSampleInFile);
+        auto numSamples = jmin (numSections * samplesPerSection, lengthInSamples - startSampleInFile);
 
         if (map == nullptr || numSamples <= 0 || ! mappedSection.contains (Range<int64> (startSampleInFile, startSampleInFile + numSamples)))
         {
             jassert (numSamples <= 0); // you must make sure that the window contains all the samples you're going to attempt to read.
 
-            for (int i = 0; i < numChannelsToRead; ++i)
-                results[i] = {};
+            for (int i = 0; i < numSections * numChannelsToRead; ++i)
+            {
+                ranges[i] = {};
+
+                if (rmsLevels != nullptr)
+                    rmsLevels[i] = 0;
+            }
 
             return;
         }
 
         switch (bitsPerSample)
         {
-            case 8:     scanMinAndMax<AudioData::UInt8> (startSampleInFile, numSamples, results, numChannelsToRead); break;
-            case 16:    scanMinAndMax<AudioData::Int16> (startSampleInFile, numSamples, results, numChannelsToRead); break;
-            case 24:    scanMinAndMax<AudioData::Int24> (startSampleInFile, numSamples, results, numChannelsToRead); break;
-            case 32:    if (usesFloatingPointData) scanMinAndMax<AudioData::Float32> (startSampleInFile, numSamples, results, numChannelsToRead);
-                        else                       scanMinAndMax<AudioData::Int32>   (startSampleInFile, numSamples, results, numChannelsToRead);
+            case 8:     scanLevels<AudioData::UInt8> (startSampleInFile, numSections, samplesPerSection, ranges, rmsLevels, numChannelsToRead); break;
+            case 16:    scanLevels<AudioData::Int16> (startSampleInFile, numSections, samplesPerSection, ranges, rmsLevels, numChannelsToRead); break;
+            case 24:    scanLevels<AudioData::Int24> (startSampleInFile, numSections, samplesPerSection, ranges, rmsLevels, numChannelsToRead); break;
+            case 32:    if (usesFloatingPointData) scanLevels<AudioData::Float32> (startSampleInFile, numSections, samplesPerSection, ranges, rmsLevels, numChannelsToRead);
+                        else                       scanLevels<AudioData::Int32>   (startSampleInFile, numSections, samplesPerSection, ranges, rmsLevels, numChannelsToRead);
                         break;
             default:    jassertfalse; break;
         }
@@ -856,10 +862,11 @@ public:
 
 private:
     template <typename SampleType>
-    void scanMinAndMax (int64 startSampleInFile, int64 numSamples, Range<float>* results, int numChannelsToRead) const noexcept
+    void scanLevels (int64 startSampleInFile, int numSections, int64 samplesPerSection,
+                     Range<float>* ranges, float* rmsLevels, int numChannelsToRead) const noexcept
     {
-        for (int i = 0; i < numChannelsToRead; ++i)
-            results[i] = scanMinAndMaxInterleaved<SampleType, AudioData::LittleEndian> (i, startSampleInFile, numSamples);
+        scanLevelsInterleaved<SampleType, AudioData::LittleEndian> (startSampleInFile, numSections, samplesPerSection,
+                                                                    ranges, rmsLevels, numChannelsToRead);
     }
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MemoryMappedWavReader)
@@ -1119,6 +1126,72 @@ struct WaveAudioFormatTests : public UnitTest
             expect (reader != nullptr);
             expect (reader->metadataValues == metadataValues, "Somehow, the metadata is different!");
         }
+
+        beginTest ("Reading levels");
+        {
+            const int numChannels = 3, numSamples = 10000, samplesPerSection = 300;
+            auto numSections = (numSamples + samplesPerSection - 1) / samplesPerSection;
+
+            AudioBuffer<float> buffer (numChannels, numSamples);
+            auto random = getRandom();
+
+            for (int chan = 0; chan < numChannels; ++chan)
+                for (int i = 0; i < numSamples; ++i)
+                    buffer.setSample (chan, i, (random.nextFloat() * 2.0f - 1.0f) / (float) (chan + 1));
+
+            for (auto bitDepth : { 16, 24, 32 })
+            {
+                TemporaryFile tempFile (".wav");
+
+                {
+                    std::unique_ptr<AudioFormatWriter> writer (format.createWriterFor (tempFile.getFile().createOutputStream(),
+                                                                                       44100.0, numChannels, bitDepth, {}, 0));
+                    expect (writer != nullptr);
+                    expect (writer->writeFromAudioSampleBuffer (buffer, 0, numSamples));
+                }
+
+                std::unique_ptr<AudioFormatReader> reader (format.createReaderFor (tempFile.getFile().createInputStream(), true));
+                std::unique_ptr<MemoryMappedAudioFormatReader> mappedReader (format.createMemoryMappedReader (tempFile.getFile()));
+                expect (reader != nullptr && mappedReader != nullptr && mappedReader->mapEntireFile());
+
+                AudioBuffer<float> decoded (numChannels, numSamples);
+                reader->read (&decoded, 0, numSamples, 0, true, true);
+
+                for (auto* r : { reader.get(), (AudioFormatReader*) mappedReader.get() })
+                {
+                    HeapBlock<Range<float>> ranges (numSections * numChannels);
+                    HeapBlock<float> rmsLevels (numSections * numChannels);
+                    r->readLevels (0, numSections, samplesPerSection, ranges, rmsLevels, numChannels);
+
+                    for (int section = 0; section < numSections; ++section)
+                    {
+                        auto start = section * samplesPerSection;
+                        auto num = jmin (samplesPerSection, numSamples - start);
+
+                        for (int chan = 0; chan < numChannels; ++chan)
+                        {
+                            auto expected = decoded.findMinMax (chan, start, num);
+                            auto& actual = ranges[section * numChannels + chan];
+
+                            expectWithinAbsoluteError (actual.getStart(), expected.getStart(), 1.0e-6f);
+                            expectWithinAbsoluteError (actual.getEnd(), expected.getEnd(), 1.0e-6f);
+                            expectWithinAbsoluteError (rmsLevels[section * numChannels + chan],
+                                                       decoded.getRMSLevel (chan, start, num), 1.0e-4f);
+                        }
+                    }
+
+                    Range<float> levels[numChannels];
+                    r->readMaxLevels (1234, 5678, levels, numChannels);
+
+                    for (int chan = 0; chan < numChannels; ++chan)
+                    {
+                        auto expected = decoded.findMinMax (chan, 1234, 5678);
+                        expectWithinAbsoluteError (levels[chan].getStart(), expected.getStart(), 1.0e-6f);
+                        expectWithinAbsoluteError (levels[chan].getEnd(), expected.getEnd(), 1.0e-6f);
+                    }
+                }
+            }
+        }
     }
 
 private:
@@ -44,6 +44,90 @@ static void convertFixedToFloat (int* const* channels, int numChannels, int numS
             FloatVectorOperations::convertFixedToFloat (reinterpret_cast<float*> (d), d, 1.0f / 0x7fffffff, numSamples);
 }
 
+//==============================================================================
+/*  Gathers the levels of one channel of a section in the reader's raw format, so that
+    the min and max only need converting to floats once per section.
+*/
+template <typename SampleType>
+struct LevelAccumulator
+{
+    void reset() noexcept
+    {
+        numSamples = 0;
+        sumOfSquares = 0;
+    }
+
+    void add (const SampleType* data, int num) noexcept
+    {
+        if (num <= 0)
+            return;
+
+        if (numSamples == 0)
+            lowest = highest = data[0];
+
+        auto mn = lowest, mx = highest;
+        sumOfSquares += addToSumOfSquares (data, num, mn, mx);
+
+        lowest = mn;
+        highest = mx;
+        numSamples += num;
+    }
+
+    Range<float> getRange() const noexcept
+    {
+        return numSamples > 0 ? Range<float> (toFloat (lowest), toFloat (highest)) : Range<float>();
+    }
+
+    float getRMS() const noexcept
+    {
+        return numSamples > 0 ? toFloat (std::sqrt (sumOfSquares / (double) numSamples)) : 0.0f;
+    }
+
+    SampleType lowest = {}, highest = {};
+    double sumOfSquares = 0;
+    int64 numSamples = 0;
+
+private:
+    // Fixed-point data is left-justified 32-bit, so it's squared at 24-bit resolution,
+    // which keeps the sum inside an int64 while letting the loop be vectorised.
+    static double addToSumOfSquares (const int* data, int num, int& mn, int& mx) noexcept
+    {
+        jassert (num <= 65536);
+        int64 sum = 0;
+
+        for (int i = 0; i < num; ++i)
+        {
+            auto v = data[i];
+            mn = jmin (mn, v);
+            mx = jmax (mx, v);
+
+            auto v24 = (int64) (v >> 8);
+            sum += v24 * v24;
+        }
+
+        return (double) sum * 65536.0;
+    }
+
+    static double addToSumOfSquares (const float* data, int num, float& mn, float& mx) noexcept
+    {
+        double sum = 0;
+
+        for (int i = 0; i < num; ++i)
+        {
+            auto v = data[i];
+            mn = jmin (mn, v);
+            mx = jmax (mx, v);
+            sum += (double) v * (double) v;
+        }
+
+        return sum;
+    }
+
+    static float toFloat (int v) noexcept       { return v * (float) (1.0 / (1.0 + std::numeric_limits<int>::max())); }
+    static float toFloat (float v) noexcept     { return v; }
+    static float toFloat (double v) noexcept    { return (float) (std::is_same<SampleType, int>::value ? v / (1.0 + std::numeric_limits<int>::max()) : v); }
+};
+
 bool AudioFormatReader::read (float* const* destChannels, int numDestChannels,
                               int64 startSampleInSource, int numSamplesToRead)
 {
@@ -208,43 +292,7 @@ void AudioFormatReader::readMaxLevels (int64 startSampleInFile, int64 numSamples
         return;
     }
 
-    auto bufferSize = (int) jmin (numSamples, (int64) 4096);
-    AudioBuffer<float> tempSampleBuffer ((int) channelsToRead, bufferSize);
-
-    auto floatBuffer = tempSampleBuffer.getArrayOfWritePointers();
-    auto intBuffer = reinterpret_cast<int* const*> (floatBuffer);
-    bool isFirstBlock = true;
-
-    while (numSamples > 0)
-    {
-        auto numToDo = (int) jmin (numSamples, (int64) bufferSize);
-
-        if (! read (intBuffer, channelsToRead, startSampleInFile, numToDo, false))
-            break;
-
-        for (int i = 0; i < channelsToRead; ++i)
-        {
-            Range<float> r;
-
-            if (usesFloatingPointData)
-            {
-                r = FloatVectorOperations::findMinAndMax (floatBuffer[i], numToDo);
-            }
-            else
-            {
-                auto intRange = Range<int>::findMinAndMax (intBuffer[i], numToDo);
-
-                r = Range<float> (intRange.getStart() / (float) std::numeric_limits<int>::max(),
-                                  intRange.getEnd()   / (float) std::numeric_limits<int>::max());
-            }
-
-            results[i] = isFirstBlock ? r : results[i].getUnionWith (r);
-        }
-
-        isFirstBlock = false;
-        numSamples -= numToDo;
-        startSampleInFile += numToDo;
-    }
+    readLevels (startSampleInFile, 1, numSamples, results, nullptr, channelsToRead);
 }
 
 void AudioFormatReader::readMaxLevels (int64 startSampleInFile, int64 numSamples,
@@ -269,6 +317,82 @@ void AudioFormatReader::readMaxLevels (int64 startSampleInFile, int64 numSamples
     highestRight = levels[1].getEnd();
 }
 
+void AudioFormatReader::readLevels (int64 startSample, int numSections, int64 samplesPerSection,
+                                    Range<float>* ranges, float* rmsLevels, int numChannelsToRead)
+{
+    jassert (numChannelsToRead > 0 && numChannelsToRead <= (int) numChannels);
+    jassert (samplesPerSection > 0);
+
+    if (usesFloatingPointData)
+        readLevelsOfType<float> (startSample, numSections, samplesPerSection, ranges, rmsLevels, numChannelsToRead);
+    else
+        readLevelsOfType<int> (startSample, numSections, samplesPerSection, ranges, rmsLevels, numChannelsToRead);
+}
+
+template <typename SampleType>
+void AudioFormatReader::readLevelsOfType (int64 startSample, int numSections, int64 samplesPerSection,
+                                          Range<float>* ranges, float* rmsLevels, int numChannelsToRead)
+{
+    const int bufferSize = 4096;
+    auto endSample = jmin (lengthInSamples, startSample + numSections * samplesPerSection);
+
+    HeapBlock<SampleType> buffer ((size_t) (numChannelsToRead * bufferSize));
+    HeapBlock<int*> channelData ((size_t) numChannelsToRead);
+    HeapBlock<LevelAccumulator<SampleType>> levels ((size_t) numChannelsToRead, true);
+
+    for (int i = 0; i < numChannelsToRead; ++i)
+        channelData[i] = reinterpret_cast<int*> (buffer + i * bufferSize);
+
+    int section = 0;
+    int64 numDoneInSection = 0;
+
+    auto finishSection = [&]
+    {
+        for (int i = 0; i < numChannelsToRead; ++i)
+        {
+            auto index = section * numChannelsToRead + i;
+            ranges[index] = levels[i].getRange();
+
+            if (rmsLevels != nullptr)
+                rmsLevels[index] = levels[i].getRMS();
+
+            levels[i].reset();
+        }
+
+        ++section;
+        numDoneInSection = 0;
+    };
+
+    // Each block that's read is split wherever a section ends, so that short sections
+    // don't each need a call to read(), and long ones don't need a huge buffer.
+    for (auto position = startSample; position < endSample;)
+    {
+        auto numToRead = (int) jmin ((int64) bufferSize, endSample - position);
+
+        if (! read (channelData, numChannelsToRead, position, numToRead, false))
+            break;
+
+        for (int offset = 0; offset < numToRead;)
+        {
+            auto numThisTime = (int) jmin ((int64) (numToRead - offset), samplesPerSection - numDoneInSection);
+
+            for (int i = 0; i < numChannelsToRead; ++i)
+                levels[i].add (reinterpret_cast<const SampleType*> (channelData[i]) + offset, numThisTime);
+
+            offset += numThisTime;
+            numDoneInSection += numThisTime;
+
+            if (numDoneInSection >= samplesPerSection)
+                finishSection();
+        }
+
+        position += numToRead;
+    }
+
+    while (section < numSections)
+        finishSection();
+}
+
 int64 AudioFormatReader::searchForLevel (int64 startSample,
                                          int64 numSamplesToSearch,
                                          double magnitudeRangeMinimum,
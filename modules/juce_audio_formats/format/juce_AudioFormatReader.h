@@ -188,6 +188,32 @@ public:
                                 float& lowestLeft,  float& highestLeft,
                                 float& lowestRight, float& highestRight);
 
+    /** Measures the lowest, highest and RMS sample levels of a series of consecutive,
+        equal-length sections of the audio stream.
+
+        This measures all the sections in a single pass over the data, so it's much
+        quicker than calling readMaxLevels() for each one, e.g. when building a
+        waveform overview. Any part of a section that lies beyond the end of the stream
+        isn't included in its levels.
+
+        @param startSample          the offset into the audio stream of the first section
+        @param numSections          the number of sections to measure
+        @param samplesPerSection    the length of each section
+        @param ranges               an array of numSections * numChannelsToRead elements, which
+                                    will be filled with the lowest and highest levels of each
+                                    channel of each section, in the order
+                                    ranges[section * numChannelsToRead + channel]
+        @param rmsLevels            an optional array in the same layout as ranges, which will
+                                    be filled with the RMS levels. This can be nullptr if you
+                                    don't need them
+        @param numChannelsToRead    the number of channels of data to scan. This must be
+                                    more than zero, but not more than the total number of channels
+                                    that the reader contains
+        @see readMaxLevels
+    */
+    virtual void readLevels (int64 startSample, int numSections, int64 samplesPerSection,
+                             Range<float>* ranges, float* rmsLevels, int numChannelsToRead);
+
     /** Scans the source looking for a sample whose magnitude is in a specified range.
 
         This will read from the source, either forwards or backwards between two sample
@@ -448,6 +474,9 @@ public:
 private:
     String formatName;
 
+    template <typename SampleType>
+    void readLevelsOfType (int64, int, int64, Range<float>*, float*, int);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioFormatReader)
 };
 
@@ -126,6 +126,68 @@ bool AudioFormatWriter::writeFromAudioReader (AudioFormatReader& reader,
     return true;
 }
 
+bool AudioFormatWriter::writeFromAudioReaderWithResampling (AudioFormatReader& reader,
+                                                            int64 startSample,
+                                                            int64 numSamplesToRead,
+                                                            SincResampler::Quality quality)
+{
+    jassert (reader.sampleRate > 0 && sampleRate > 0);
+
+    if (reader.sampleRate <= 0 || sampleRate <= 0)
+        return false;
+
+    if (reader.sampleRate == sampleRate)
+        return writeFromAudioReader (reader, startSample, numSamplesToRead);
+
+    if (numSamplesToRead < 0)
+        numSamplesToRead = reader.lengthInSamples;
+
+    auto ratio = reader.sampleRate / sampleRate;
+    auto numSamplesToWrite = (int64) std::llround ((double) numSamplesToRead / ratio);
+    auto endSample = startSample + numSamplesToRead;
+
+    const int bufferSize = 16384;
+    OwnedArray<SincResampler> resamplers;
+
+    for (int i = 0; i < (int) numChannels; ++i)
+        resamplers.add (new SincResampler (quality))->setRatio (ratio);
+
+    if (resamplers.isEmpty())
+        return false;
+
+    AudioBuffer<float> inputBuffer ((int) numChannels, resamplers.getFirst()->getNumInputSamplesNeeded (bufferSize) + 2);
+    AudioBuffer<float> outputBuffer ((int) numChannels, bufferSize);
+
+    while (numSamplesToWrite > 0)
+    {
+        auto numToDo = (int) jmin (numSamplesToWrite, (int64) bufferSize);
+        auto numNeeded = resamplers.getFirst()->getNumInputSamplesNeeded (numToDo);
+
+        if (inputBuffer.getNumSamples() < numNeeded)
+            inputBuffer.setSize ((int) numChannels, numNeeded);
+
+        // the filter needs to read a little beyond the end of the section, so that part is silent
+        auto numToRead = (int) jlimit ((int64) 0, (int64) numNeeded, endSample - startSample);
+
+        if (numToRead > 0
+             && ! reader.read (inputBuffer.getArrayOfWritePointers(), (int) numChannels, startSample, numToRead))
+            return false;
+
+        inputBuffer.clear (numToRead, numNeeded - numToRead);
+
+        for (int i = 0; i < (int) numChannels; ++i)
+            resamplers.getUnchecked (i)->process (inputBuffer.getReadPointer (i), outputBuffer.getWritePointer (i), numToDo);
+
+        if (! writeFromAudioSampleBuffer (outputBuffer, 0, numToDo))
+            return false;
+
+        numSamplesToWrite -= numToDo;
+        startSample += numNeeded;
+    }
+
+    return true;
+}
+
 bool AudioFormatWriter::writeFromAudioSource (AudioSource& source, int numSamplesToRead, const int samplesPerBlock)
 {
     AudioBuffer<float> tempBuffer (getNumChannels(), samplesPerBlock);
@@ -358,4 +420,94 @@ void AudioFormatWriter::ThreadedWriter::setFlushInterval (int numSamplesPerFlush
     buffer->setFlushInterval (numSamplesPerFlush);
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AudioFormatWriterTests  : public UnitTest
+{
+public:
+    AudioFormatWriterTests()  : UnitTest ("AudioFormatWriter", "Audio") {}
+
+    void runTest() override
+    {
+        const int numChannels = 2, numSamples = 40000, startSample = 1000, numToRead = 38000;
+
+        AudioBuffer<float> source (numChannels, numSamples);
+
+        for (int chan = 0; chan < numChannels; ++chan)
+            for (int i = 0; i < numSamples; ++i)
+                source.setSample (chan, i, (float) (0.5 * std::sin (i * 0.013 * (chan + 1))));
+
+        MemoryBlock sourceData;
+        writeWav (source, 48000.0, sourceData);
+        std::unique_ptr<AudioFormatReader> reader (WavAudioFormat().createReaderFor (new MemoryInputStream (sourceData, false), true));
+
+        beginTest ("Writing from a reader with resampling");
+        {
+            // This is long enough to need several of the writer's blocks.
+            auto quality = SincResampler::Quality::medium;
+            auto result = resample (*reader, 44100.0, quality, startSample, numToRead);
+
+            auto ratio = 48000.0 / 44100.0;
+            auto numOut = (int) std::llround (numToRead / ratio);
+            expectEquals (result.getNumSamples(), numOut);
+
+            for (int chan = 0; chan < numChannels; ++chan)
+            {
+                SincResampler resampler (quality);
+                resampler.setRatio (ratio);
+
+                // the filter reads past the end of the section, where it should only find silence
+                AudioBuffer<float> input (1, resampler.getNumInputSamplesNeeded (numOut));
+                input.clear();
+                input.copyFrom (0, 0, source, chan, startSample, numToRead);
+
+                HeapBlock<float> expected (numOut);
+                resampler.process (input.getReadPointer (0), expected, numOut);
+
+                expect (memcmp (result.getReadPointer (chan), expected, (size_t) numOut * sizeof (float)) == 0);
+            }
+        }
+
+        beginTest ("Writing from a reader at the same rate");
+        {
+            auto result = resample (*reader, 48000.0, SincResampler::Quality::high, startSample, numToRead);
+            expectEquals (result.getNumSamples(), numToRead);
+
+            for (int chan = 0; chan < numChannels; ++chan)
+                expect (memcmp (result.getReadPointer (chan), source.getReadPointer (chan, startSample),
+                                (size_t) numToRead * sizeof (float)) == 0);
+        }
+    }
+
+private:
+    static void writeWav (const AudioBuffer<float>& buffer, double sampleRate, MemoryBlock& data)
+    {
+        std::unique_ptr<AudioFormatWriter> writer (WavAudioFormat().createWriterFor (new MemoryOutputStream (data, false), sampleRate,
+                                                                                     (unsigned int) buffer.getNumChannels(), 32, {}, 0));
+        writer->writeFromAudioSampleBuffer (buffer, 0, buffer.getNumSamples());
+    }
+
+    AudioBuffer<float> resample (AudioFormatReader& reader, double newSampleRate, SincResampler::Quality quality,
+                                 int64 startSample, int64 numToRead)
+    {
+        MemoryBlock data;
+
+        {
+            std::unique_ptr<AudioFormatWriter> writer (WavAudioFormat().createWriterFor (new MemoryOutputStream (data, false), newSampleRate,
+                                                                                         reader.numChannels, 32, {}, 0));
+            expect (writer->writeFromAudioReaderWithResampling (reader, startSample, numToRead, quality));
+        }
+
+        std::unique_ptr<AudioFormatReader> result (WavAudioFormat().createReaderFor (new MemoryInputStream (data, false), true));
+        AudioBuffer<float> buffer ((int) result->numChannels, (int) result->lengthInSamples);
+        result->read (&buffer, 0, buffer.getNumSamples(), 0, true, true);
+        return buffer;
+    }
+};
+
+static AudioFormatWriterTests audioFormatWriterTests;
+
+#endif
+
 } // namespace juce
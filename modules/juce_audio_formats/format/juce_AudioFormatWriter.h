@@ -142,6 +142,25 @@ public:
                                int64 startSample,
                                int64 numSamplesToRead);
 
+    /** Reads a section of samples from an AudioFormatReader, converts them from the
+        reader's sample rate to this writer's rate, and writes them to the output.
+
+        The conversion is done with a SincResampler for each channel. The number of
+        samples that get written is the number read, scaled by the ratio of the two rates.
+        Any of the filter's look-ahead that runs beyond the end of the section that's being
+        read is padded with silence, so the last few samples will fade out if the section
+        doesn't end at the end of the reader's data.
+
+        If numSamplesToRead < 0, it will write the entire length of the reader.
+
+        @returns false if it can't read or write properly during the operation
+        @see SincResampler
+    */
+    bool writeFromAudioReaderWithResampling (AudioFormatReader& reader,
+                                             int64 startSample,
+                                             int64 numSamplesToRead,
+                                             SincResampler::Quality quality = SincResampler::Quality::high);
+
     /** Reads some samples from an AudioSource, and writes these to the output.
 
         The source must already have been initialised with the AudioSource::prepareToPlay() method
@@ -0,0 +1,286 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+int AudioPeakScanner::Result::getNumSections() const noexcept
+{
+    return numChannels > 0 ? sectionLevels.size() / numChannels : 0;
+}
+
+Range<float> AudioPeakScanner::Result::getSectionLevels (int channel, int section) const noexcept
+{
+    if (isPositiveAndBelow (channel, numChannels))
+        return sectionLevels[section * numChannels + channel];
+
+    return {};
+}
+
+float AudioPeakScanner::Result::getPeak() const noexcept
+{
+    float peak = 0;
+
+    for (auto& r : channelLevels)
+        peak = jmax (peak, std::abs (r.getStart()), std::abs (r.getEnd()));
+
+    return peak;
+}
+
+//==============================================================================
+AudioPeakScanner::Result AudioPeakScanner::scan (AudioFormatReader& reader, int samplesPerSection)
+{
+    jassert (samplesPerSection > 0);
+
+    Result result;
+    result.numChannels = (int) reader.numChannels;
+    result.sampleRate = reader.sampleRate;
+    result.lengthInSamples = jmax ((int64) 0, reader.lengthInSamples);
+    result.samplesPerSection = samplesPerSection = jmax (1, samplesPerSection);
+
+    auto numChannels = result.numChannels;
+    auto numSections = (int) ((result.lengthInSamples + samplesPerSection - 1) / samplesPerSection);
+
+    if (numChannels <= 0 || numSections <= 0)
+        return result;
+
+    result.sectionLevels.resize (numSections * numChannels);
+    Array<float> sectionRMS;
+    sectionRMS.resize (numSections * numChannels);
+
+    // The sections are read in batches so that a large file can be scanned without a
+    // stream reader needing one huge buffer.
+    const int sectionsPerBatch = jmax (1, 65536 / samplesPerSection);
+
+    for (int section = 0; section < numSections; section += sectionsPerBatch)
+    {
+        auto index = section * numChannels;
+
+        reader.readLevels (section * (int64) samplesPerSection,
+                           jmin (sectionsPerBatch, numSections - section),
+                           samplesPerSection,
+                           result.sectionLevels.getRawDataPointer() + index,
+                           sectionRMS.getRawDataPointer() + index,
+                           numChannels);
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        Range<float> levels;
+        double sumOfSquares = 0;
+
+        for (int section = 0; section < numSections; ++section)
+        {
+            auto index = section * numChannels + channel;
+            auto sectionLength = jmin ((int64) samplesPerSection, result.lengthInSamples - section * (int64) samplesPerSection);
+            auto rms = (double) sectionRMS.getUnchecked (index);
+
+            levels = section == 0 ? result.sectionLevels.getUnchecked (index)
+                                  : levels.getUnionWith (result.sectionLevels.getUnchecked (index));
+            sumOfSquares += rms * rms * (double) sectionLength;
+        }
+
+        result.channelLevels.add (levels);
+        result.rmsLevels.add ((float) std::sqrt (sumOfSquares / (double) result.lengthInSamples));
+    }
+
+    return result;
+}
+
+Array<AudioPeakScanner::Result> AudioPeakScanner::scan (const Array<AudioFormatReader*>& readers,
+                                                         int samplesPerSection, int maxNumThreads)
+{
+    Array<Result> results;
+    results.resize (readers.size());
+
+    ThreadPool::runInParallel (readers.size(), maxNumThreads, [&] (int index)
+    {
+        if (auto* reader = readers.getUnchecked (index))
+            results.getReference (index) = scan (*reader, samplesPerSection);
+    });
+
+    return results;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct AudioPeakScannerTests  : public UnitTest
+{
+    AudioPeakScannerTests()  : UnitTest ("AudioPeakScanner", "Audio") {}
+
+    void runTest() override
+    {
+        beginTest ("Scanning one reader");
+        {
+            auto buffer = createTestSignal (2, 10007);
+            MemoryBlock wavData;
+            std::unique_ptr<AudioFormatReader> reader (createReader (buffer, wavData));
+
+            auto result = AudioPeakScanner::scan (*reader, samplesPerSection);
+
+            expectEquals (result.numChannels, 2);
+            expectEquals (result.sampleRate, 44100.0);
+            expect (result.lengthInSamples == 10007);
+            expectEquals (result.samplesPerSection, (int) samplesPerSection);
+            expectEquals (result.getNumSections(), 40);
+
+            for (int section = 0; section < result.getNumSections(); ++section)
+            {
+                Range<float> expected[2];
+                reader->readMaxLevels (section * samplesPerSection, samplesPerSection, expected, 2);
+
+                for (int chan = 0; chan < 2; ++chan)
+                    expect (result.getSectionLevels (chan, section) == expected[chan]);
+            }
+
+            float peak = 0;
+
+            for (int chan = 0; chan < 2; ++chan)
+            {
+                auto levels = buffer.findMinMax (chan, 0, buffer.getNumSamples());
+                peak = jmax (peak, std::abs (levels.getStart()), std::abs (levels.getEnd()));
+
+                expect (result.channelLevels[chan] == levels);
+                expectWithinAbsoluteError (result.rmsLevels[chan], buffer.getRMSLevel (chan, 0, buffer.getNumSamples()), 1.0e-5f);
+            }
+
+            expectEquals (result.getPeak(), peak);
+        }
+
+        beginTest ("Scanning several readers on a pool of threads");
+        {
+            OwnedArray<AudioBuffer<float>> buffers;
+            OwnedArray<MemoryBlock> wavData;
+            OwnedArray<AudioFormatReader> ownedReaders;
+            Array<AudioFormatReader*> readers;
+
+            for (int i = 0; i < 6; ++i)
+            {
+                if (i == 2)
+                {
+                    readers.add (nullptr);
+                    continue;
+                }
+
+                auto* buffer = buffers.add (new AudioBuffer<float> (createTestSignal (1 + i % 3, 3000 + 1711 * i)));
+                readers.add (ownedReaders.add (createReader (*buffer, *wavData.add (new MemoryBlock()))));
+            }
+
+            auto results = AudioPeakScanner::scan (readers, samplesPerSection, 3);
+            expectEquals (results.size(), readers.size());
+
+            for (int i = 0; i < readers.size(); ++i)
+            {
+                auto& result = results.getReference (i);
+
+                if (auto* reader = readers.getUnchecked (i))
+                {
+                    auto expected = AudioPeakScanner::scan (*reader, samplesPerSection);
+
+                    expectEquals (result.numChannels, expected.numChannels);
+                    expect (result.lengthInSamples == expected.lengthInSamples);
+                    expect (result.sectionLevels == expected.sectionLevels);
+                    expect (result.channelLevels == expected.channelLevels);
+                    expect (result.rmsLevels == expected.rmsLevels);
+                }
+                else
+                {
+                    expectEquals (result.numChannels, 0);
+                    expectEquals (result.getNumSections(), 0);
+                }
+            }
+        }
+
+        beginTest ("Scanning a subsection of a reader");
+        {
+            auto buffer = createTestSignal (2, 9000);
+            TemporaryFile tempFile (".wav");
+
+            {
+                std::unique_ptr<AudioFormatWriter> writer (WavAudioFormat().createWriterFor (tempFile.getFile().createOutputStream(),
+                                                                                             44100.0, 2, 32, {}, 0));
+                expect (writer != nullptr && writer->writeFromAudioSampleBuffer (buffer, 0, buffer.getNumSamples()));
+            }
+
+            std::unique_ptr<MemoryMappedAudioFormatReader> mappedReader (WavAudioFormat().createMemoryMappedReader (tempFile.getFile()));
+            expect (mappedReader != nullptr && mappedReader->mapEntireFile());
+
+            const int subsectionStart = 1000, subsectionLength = 5000;
+            AudioSubsectionReader subsection (mappedReader.get(), subsectionStart, subsectionLength, false);
+
+            auto result = AudioPeakScanner::scan (subsection, samplesPerSection);
+            expectEquals (result.getNumSections(), 20);
+
+            for (int section = 0; section < result.getNumSections(); ++section)
+            {
+                auto start = section * samplesPerSection;
+                auto num = jmin ((int) samplesPerSection, subsectionLength - start);
+
+                for (int chan = 0; chan < 2; ++chan)
+                    expect (result.getSectionLevels (chan, section) == buffer.findMinMax (chan, subsectionStart + start, num));
+            }
+
+            for (int chan = 0; chan < 2; ++chan)
+                expectWithinAbsoluteError (result.rmsLevels[chan], buffer.getRMSLevel (chan, subsectionStart, subsectionLength), 1.0e-5f);
+        }
+    }
+
+    AudioBuffer<float> createTestSignal (int numChannels, int numSamples)
+    {
+        AudioBuffer<float> buffer (numChannels, numSamples);
+        auto random = getRandom();
+
+        for (int chan = 0; chan < numChannels; ++chan)
+            for (int i = 0; i < numSamples; ++i)
+                buffer.setSample (chan, i, (random.nextFloat() * 2.0f - 1.0f) / (float) (chan + 1));
+
+        return buffer;
+    }
+
+    // Writes 32-bit float data, so that the reader gives back exactly what was written.
+    static AudioFormatReader* createReader (const AudioBuffer<float>& buffer, MemoryBlock& wavData)
+    {
+        WavAudioFormat format;
+
+        {
+            std::unique_ptr<AudioFormatWriter> writer (format.createWriterFor (new MemoryOutputStream (wavData, false),
+                                                                               44100.0, (unsigned int) buffer.getNumChannels(),
+                                                                               32, {}, 0));
+            writer->writeFromAudioSampleBuffer (buffer, 0, buffer.getNumSamples());
+        }
+
+        return format.createReaderFor (new MemoryInputStream (wavData, false), true);
+    }
+
+    enum { samplesPerSection = 256 };
+};
+
+static AudioPeakScannerTests audioPeakScannerTests;
+
+#endif
+
+} // namespace juce
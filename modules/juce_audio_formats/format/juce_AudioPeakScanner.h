@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Measures the peak and RMS levels of audio files, along with the lowest and highest
+    levels of each of a series of short sections, which is what's needed to draw a
+    waveform overview.
+
+    This can scan a single reader on the calling thread, or a batch of readers using
+    a pool of threads, and the results can be given to AudioThumbnail::loadFrom()
+    so that a set of thumbnails can be generated up-front rather than one at a time
+    on the thumbnail cache's background thread.
+
+    @code
+    auto results = AudioPeakScanner::scan (readers, 512);
+
+    for (int i = 0; i < results.size(); ++i)
+        thumbnails[i]->loadFrom (results.getReference (i));
+    @endcode
+
+    @see AudioFormatReader::readLevels, LoudnessAnalyser
+
+    @tags{Audio}
+*/
+class JUCE_API  AudioPeakScanner
+{
+public:
+    //==============================================================================
+    /** The levels measured from one reader. */
+    struct JUCE_API  Result
+    {
+        /** The number of channels that were scanned. */
+        int numChannels = 0;
+
+        /** The reader's sample rate. */
+        double sampleRate = 0;
+
+        /** The number of samples that were scanned. */
+        int64 lengthInSamples = 0;
+
+        /** The length of each of the sections. */
+        int samplesPerSection = 0;
+
+        /** The lowest and highest levels of each channel of each section, in the order
+            sectionLevels[section * numChannels + channel].
+        */
+        Array<Range<float>> sectionLevels;
+
+        /** The lowest and highest levels of each channel over the whole reader. */
+        Array<Range<float>> channelLevels;
+
+        /** The RMS level of each channel over the whole reader. */
+        Array<float> rmsLevels;
+
+        /** Returns the number of sections that were measured. */
+        int getNumSections() const noexcept;
+
+        /** Returns the lowest and highest levels of one channel of a section. */
+        Range<float> getSectionLevels (int channel, int section) const noexcept;
+
+        /** Returns the highest absolute level of any channel. */
+        float getPeak() const noexcept;
+    };
+
+    //==============================================================================
+    /** Scans the whole of a reader.
+
+        If the reader is a MemoryMappedAudioFormatReader, you'll need to map the whole
+        file before calling this.
+
+        @param reader               the reader to scan
+        @param samplesPerSection    the length of each of the sections to measure
+    */
+    static Result scan (AudioFormatReader& reader, int samplesPerSection);
+
+    /** Scans the whole of each of a set of readers, using a pool of threads.
+
+        The readers are scanned by ThreadPool::runInParallel(), one job per reader, so
+        none of them can be used by anything else until this returns.
+
+        @param readers              the readers to scan - any null entries will be given an
+                                    empty Result
+        @param samplesPerSection    the length of each of the sections to measure
+        @param maxNumThreads        the maximum number of readers to scan at once, or 0 to use
+                                    one thread per CPU core
+        @returns a result for each of the readers, in the same order
+    */
+    static Array<Result> scan (const Array<AudioFormatReader*>& readers,
+                               int samplesPerSection, int maxNumThreads = 0);
+
+private:
+    AudioPeakScanner() = delete;
+};
+
+} // namespace juce
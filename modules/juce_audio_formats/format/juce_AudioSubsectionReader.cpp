@@ -69,4 +69,35 @@ void AudioSubsectionReader::readMaxLevels (int64 startSampleInFile, int64 numSam
     source->readMaxLevels (startSampleInFile + startSample, numSamples, results, numChannelsToRead);
 }
 
+void AudioSubsectionReader::readLevels (int64 startSampleInFile, int numSections, int64 samplesPerSection,
+                                        Range<float>* ranges, float* rmsLevels, int numChannelsToRead)
+{
+    if (startSampleInFile < 0 || samplesPerSection <= 0)
+    {
+        AudioFormatReader::readLevels (startSampleInFile, numSections, samplesPerSection,
+                                       ranges, rmsLevels, numChannelsToRead);
+        return;
+    }
+
+    // Sections that lie entirely inside the subsection can be passed straight to the
+    // source, so that it can use a faster implementation if it has one. Any that run
+    // past the end are left to the default version, which only reads what's available.
+    auto numWholeSections = (int) jlimit ((int64) 0, (int64) numSections,
+                                          (length - startSampleInFile) / samplesPerSection);
+
+    if (numWholeSections > 0)
+        source->readLevels (startSampleInFile + startSample, numWholeSections, samplesPerSection,
+                            ranges, rmsLevels, numChannelsToRead);
+
+    if (numWholeSections < numSections)
+    {
+        auto offset = numWholeSections * numChannelsToRead;
+
+        AudioFormatReader::readLevels (startSampleInFile + numWholeSections * samplesPerSection,
+                                       numSections - numWholeSections, samplesPerSection,
+                                       ranges + offset, rmsLevels != nullptr ? rmsLevels + offset : nullptr,
+                                       numChannelsToRead);
+    }
+}
+
 } // namespace juce
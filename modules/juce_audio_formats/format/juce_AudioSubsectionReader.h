@@ -73,6 +73,9 @@ public:
     void readMaxLevels (int64 startSample, int64 numSamples,
                         Range<float>* results, int numChannelsToRead) override;
 
+    void readLevels (int64 startSample, int numSections, int64 samplesPerSection,
+                     Range<float>* ranges, float* rmsLevels, int numChannelsToRead) override;
+
 
 private:
     //==============================================================================
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+LoudnessMeter::Measurement LoudnessAnalyser::analyse (AudioFormatReader& reader,
+                                                      int64 startSample, int64 numSamples)
+{
+    auto numChannels = (int) reader.numChannels;
+
+    if (numChannels <= 0 || reader.sampleRate <= 0)
+        return {};
+
+    auto endSample = numSamples < 0 ? reader.lengthInSamples
+                                    : jmin (reader.lengthInSamples, startSample + numSamples);
+
+    LoudnessMeter meter;
+    meter.prepare (reader.sampleRate, numChannels);
+
+    if (numChannels == 5 || numChannels == 6)
+    {
+        auto surroundIndex = numChannels - 2;
+
+        if (numChannels == 6)
+            meter.setChannelWeight (3, 0.0f);
+
+        meter.setChannelWeight (surroundIndex,     1.41f);
+        meter.setChannelWeight (surroundIndex + 1, 1.41f);
+    }
+
+    const int blockSize = 16384;
+    AudioBuffer<float> buffer (numChannels, blockSize);
+
+    for (auto position = jmax ((int64) 0, startSample); position < endSample;)
+    {
+        auto numThisTime = (int) jmin ((int64) blockSize, endSample - position);
+        reader.read (&buffer, 0, numThisTime, position, true, true);
+        meter.process (buffer, 0, numThisTime);
+        position += numThisTime;
+    }
+
+    return meter.getMeasurement();
+}
+
+Array<LoudnessMeter::Measurement> LoudnessAnalyser::analyse (const Array<AudioFormatReader*>& readers,
+                                                             int maxNumThreads)
+{
+    Array<LoudnessMeter::Measurement> results;
+    results.resize (readers.size());
+
+    ThreadPool::runInParallel (readers.size(), maxNumThreads, [&] (int index)
+    {
+        if (auto* reader = readers.getUnchecked (index))
+            results.getReference (index) = analyse (*reader);
+    });
+
+    return results;
+}
+
+} // namespace juce
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Measures the loudness and true-peak level of audio files, using a LoudnessMeter.
+
+    This can measure a single reader on the calling thread, or a batch of readers
+    using a pool of threads, e.g. to find the gain needed to normalise a set of files
+    to a target loudness.
+
+    @code
+    auto measurement = LoudnessAnalyser::analyse (*reader);
+    auto gainDb = -23.0f - measurement.integratedLoudness;
+    @endcode
+
+    @see LoudnessMeter
+
+    @tags{Audio}
+*/
+class JUCE_API  LoudnessAnalyser
+{
+public:
+    //==============================================================================
+    /** Measures a section of a reader.
+
+        Five and six-channel readers are assumed to use the usual L, R, C, (LFE), Ls, Rs
+        order, so that the surround channels get the extra weight that BS.1770 gives
+        them and the LFE channel is ignored. Other channel counts are weighted equally.
+
+        @param reader           the reader to measure
+        @param startSample      the first sample to measure
+        @param numSamples       the number of samples to measure, or -1 to carry on to the
+                                end of the reader
+    */
+    static LoudnessMeter::Measurement analyse (AudioFormatReader& reader,
+                                               int64 startSample = 0,
+                                               int64 numSamples = -1);
+
+    /** Measures the whole of each of a set of readers, using a pool of threads.
+
+        Like AudioPeakScanner::scan(), this gives each reader a job of its own, so the
+        readers can't be used elsewhere until it returns.
+
+        @param readers          the readers to measure - any null entries will be given a
+                                default Measurement
+        @param maxNumThreads    the maximum number of readers to measure at once, or 0 to use
+                                one thread per CPU core
+        @returns a measurement for each of the readers, in the same order
+    */
+    static Array<LoudnessMeter::Measurement> analyse (const Array<AudioFormatReader*>& readers,
+                                                      int maxNumThreads = 0);
+
+private:
+    LoudnessAnalyser() = delete;
+};
+
+} // namespace juce
@@ -102,12 +102,107 @@ protected:
     template <typename SampleType, typename Endianness>
     Range<float> scanMinAndMaxInterleaved (int channel, int64 startSampleInFile, int64 numSamples) const noexcept
     {
-        using SourceType = AudioData::Pointer <SampleType, Endianness, AudioData::Interleaved, AudioData::Const>;
+        Range<float> result;
+        scanChannelsInterleaved<SampleType, Endianness> (channel, 1, startSampleInFile, numSamples, &result, nullptr);
+        return result;
+    }
+
+    /** Used by AudioFormatReader subclasses to implement readLevels() for interleaved data.
 
-        return SourceType (addBytesToPointer (sampleToPointer (startSampleInFile), ((int) bitsPerSample / 8) * channel), (int) numChannels)
-                .findMinAndMax ((size_t) numSamples);
+        Each section is measured in a single pass over the mapped memory, which finds the
+        levels of all its channels at once, working in the file's own sample format. The
+        caller must make sure that the sections have been mapped.
+    */
+    template <typename SampleType, typename Endianness>
+    void scanLevelsInterleaved (int64 startSampleInFile, int numSections, int64 samplesPerSection,
+                                Range<float>* ranges, float* rmsLevels, int numChannelsToRead) const noexcept
+    {
+        for (int section = 0; section < numSections; ++section)
+        {
+            auto start = startSampleInFile + section * samplesPerSection;
+            auto num = jlimit ((int64) 0, samplesPerSection, lengthInSamples - start);
+            auto index = section * numChannelsToRead;
+
+            for (int channel = 0; channel < numChannelsToRead; channel += maxChannelsPerScan)
+                scanChannelsInterleaved<SampleType, Endianness> (channel, jmin ((int) maxChannelsPerScan, numChannelsToRead - channel),
+                                                                 start, num, ranges + index + channel,
+                                                                 rmsLevels != nullptr ? rmsLevels + index + channel : nullptr);
+        }
     }
 
+private:
+    enum { maxChannelsPerScan = 8 };
+
+    template <typename SampleType, typename Endianness>
+    void scanChannelsInterleaved (int firstChannel, int numChans, int64 startSampleInFile, int64 numSamples,
+                                  Range<float>* ranges, float* rmsLevels) const noexcept
+    {
+        if (numSamples <= 0)
+        {
+            for (int i = 0; i < numChans; ++i)
+            {
+                ranges[i] = {};
+
+                if (rmsLevels != nullptr)
+                    rmsLevels[i] = 0;
+            }
+
+            return;
+        }
+
+        auto* firstFrame = static_cast<char*> (const_cast<void*> (sampleToPointer (startSampleInFile)))
+                             + firstChannel * (int) SampleType::bytesPerSample;
+
+        if (SampleType::isFloat)
+            scanFrames<SampleType, Endianness, float> (firstFrame, numChans, numSamples, ranges, rmsLevels);
+        else
+            scanFrames<SampleType, Endianness, int32> (firstFrame, numChans, numSamples, ranges, rmsLevels);
+    }
+
+    template <typename SampleType, typename Endianness, typename ValueType>
+    void scanFrames (char* frame, int numChans, int64 numSamples, Range<float>* ranges, float* rmsLevels) const noexcept
+    {
+        ValueType lowest[maxChannelsPerScan], highest[maxChannelsPerScan];
+        double sumOfSquares[maxChannelsPerScan] = {};
+
+        for (int i = 0; i < numChans; ++i)
+        {
+            SampleType s (frame + i * (int) SampleType::bytesPerSample);
+            lowest[i] = highest[i] = readSample<Endianness> (s, ValueType());
+        }
+
+        for (int64 n = 0; n < numSamples; ++n)
+        {
+            for (int i = 0; i < numChans; ++i)
+            {
+                SampleType s (frame + i * (int) SampleType::bytesPerSample);
+                auto v = readSample<Endianness> (s, ValueType());
+
+                lowest[i]  = jmin (lowest[i], v);
+                highest[i] = jmax (highest[i], v);
+                sumOfSquares[i] += (double) v * (double) v;
+            }
+
+            frame += bytesPerFrame;
+        }
+
+        auto scale = std::is_same<ValueType, float>::value ? 1.0 : 1.0 / (1.0 + AudioData::Int32::maxValue);
+
+        for (int i = 0; i < numChans; ++i)
+        {
+            ranges[i] = Range<float> ((float) (lowest[i] * scale), (float) (highest[i] * scale));
+
+            if (rmsLevels != nullptr)
+                rmsLevels[i] = (float) (std::sqrt (sumOfSquares[i] / (double) numSamples) * scale);
+        }
+    }
+
+    template <typename Endianness, typename SampleType>
+    static float readSample (SampleType& s, float) noexcept     { return Endianness::getAsFloat (s); }
+
+    template <typename Endianness, typename SampleType>
+    static int32 readSample (SampleType& s, int32) noexcept     { return Endianness::getAsInt32 (s); }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MemoryMappedAudioFormatReader)
 };
 
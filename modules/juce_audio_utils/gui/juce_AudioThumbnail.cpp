@@ -245,16 +245,14 @@ private:
                 for (int i = 0; i < (int) numChannels; ++i)
                     levels[i] = levelData + i * numThumbSamps;
 
-                HeapBlock<Range<float>> levelsRead (numChannels);
+                HeapBlock<Range<float>> levelsRead ((unsigned int) numThumbSamps * numChannels);
 
-                for (int i = 0; i < numThumbSamps; ++i)
-                {
-                    reader->readMaxLevels ((firstThumbIndex + i) * owner.samplesPerThumbSample,
-                                           owner.samplesPerThumbSample, levelsRead, (int) numChannels);
+                reader->readLevels (firstThumbIndex * (int64) owner.samplesPerThumbSample, numThumbSamps,
+                                    owner.samplesPerThumbSample, levelsRead, nullptr, (int) numChannels);
 
+                for (int i = 0; i < numThumbSamps; ++i)
                     for (int j = 0; j < (int) numChannels; ++j)
-                        levels[j][i].setFloat (levelsRead[j]);
-                }
+                        levels[j][i].setFloat (levelsRead[i * (int) numChannels + j]);
 
                 {
                     const ScopedUnlock su (readerLock);
@@ -618,6 +616,38 @@ bool AudioThumbnail::loadFrom (InputStream& rawInput)
     return true;
 }
 
+bool AudioThumbnail::loadFrom (const AudioPeakScanner::Result& levels)
+{
+    if (levels.samplesPerSection != samplesPerThumbSample || levels.numChannels <= 0)
+    {
+        jassertfalse; // the levels need to have been scanned with this thumbnail's resolution
+        return false;
+    }
+
+    reset (levels.numChannels, levels.sampleRate, levels.lengthInSamples);
+
+    auto numSections = levels.getNumSections();
+
+    if (numSections > 0)
+    {
+        const HeapBlock<MinMaxValue> thumbData (numSections * numChannels);
+        const HeapBlock<MinMaxValue*> thumbChannels (numChannels);
+
+        for (int chan = 0; chan < numChannels; ++chan)
+        {
+            auto* dest = thumbData + numSections * chan;
+            thumbChannels[chan] = dest;
+
+            for (int i = 0; i < numSections; ++i)
+                dest[i].setFloat (levels.getSectionLevels (chan, i));
+        }
+
+        setLevels (thumbChannels, 0, numChannels, numSections);
+    }
+
+    return true;
+}
+
 void AudioThumbnail::saveTo (OutputStream& output) const
 {
     const ScopedLock sl (lock);
@@ -823,4 +853,64 @@ void AudioThumbnail::drawChannels (Graphics& g, const Rectangle<int>& area, doub
     }
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct AudioThumbnailTests  : public UnitTest
+{
+    AudioThumbnailTests()  : UnitTest ("AudioThumbnail", "Audio") {}
+
+    void runTest() override
+    {
+        beginTest ("Loading the levels from an AudioPeakScanner");
+
+        const int numChannels = 2, numSamples = 7000, samplesPerThumbSample = 128;
+
+        AudioBuffer<float> buffer (numChannels, numSamples);
+        auto random = getRandom();
+
+        for (int chan = 0; chan < numChannels; ++chan)
+            for (int i = 0; i < numSamples; ++i)
+                buffer.setSample (chan, i, random.nextFloat() * 2.0f - 1.0f);
+
+        WavAudioFormat format;
+        MemoryBlock wavData;
+
+        {
+            std::unique_ptr<AudioFormatWriter> writer (format.createWriterFor (new MemoryOutputStream (wavData, false),
+                                                                               44100.0, numChannels, 32, {}, 0));
+            expect (writer != nullptr && writer->writeFromAudioSampleBuffer (buffer, 0, numSamples));
+        }
+
+        std::unique_ptr<AudioFormatReader> reader (format.createReaderFor (new MemoryInputStream (wavData, false), true));
+        expect (reader != nullptr);
+
+        AudioFormatManager formatManager;
+        AudioThumbnailCache cache (4);
+
+        AudioThumbnail added (samplesPerThumbSample, formatManager, cache);
+        added.reset (numChannels, 44100.0, numSamples);
+        added.addBlock (0, buffer, 0, numSamples);
+
+        AudioThumbnail loaded (samplesPerThumbSample, formatManager, cache);
+        expect (loaded.loadFrom (AudioPeakScanner::scan (*reader, samplesPerThumbSample)));
+
+        expect (loaded.isFullyLoaded());
+        expectEquals (loaded.getNumChannels(), numChannels);
+        expect (loaded.getNumSamplesFinished() == added.getNumSamplesFinished());
+        expectEquals (loaded.getApproximatePeak(), added.getApproximatePeak());
+
+        MemoryOutputStream addedData, loadedData;
+        added.saveTo (addedData);
+        loaded.saveTo (loadedData);
+
+        expect (addedData.getDataSize() > 0);
+        expect (loadedData.getMemoryBlock() == addedData.getMemoryBlock());
+    }
+};
+
+static AudioThumbnailTests audioThumbnailTests;
+
+#endif
+
 } // namespace juce
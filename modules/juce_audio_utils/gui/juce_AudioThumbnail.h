@@ -121,6 +121,15 @@ public:
     */
     bool loadFrom (InputStream& input) override;
 
+    /** Fills the thumbnail with levels that were measured by an AudioPeakScanner.
+
+        This lets a batch of thumbnails be generated in parallel with AudioPeakScanner::scan(),
+        rather than each one being scanned in turn by the cache's background thread. The
+        levels must have been scanned using this thumbnail's samples-per-thumbnail-sample
+        as their section length, otherwise this will return false.
+    */
+    bool loadFrom (const AudioPeakScanner::Result& levels);
+
     /** Saves the low res thumbnail data to an output stream.
 
         The data that is written can later be reloaded using loadFrom().
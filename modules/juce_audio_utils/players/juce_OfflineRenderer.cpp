@@ -0,0 +1,674 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+struct OfflineRenderer::PlayHead  : public AudioPlayHead
+{
+    PlayHead (const Settings& s) noexcept  : settings (s) {}
+
+    bool getCurrentPosition (CurrentPositionInfo& result) override
+    {
+        result.resetToDefault();
+
+        result.bpm                = settings.bpm;
+        result.timeSigNumerator   = settings.timeSigNumerator;
+        result.timeSigDenominator = settings.timeSigDenominator;
+        result.timeInSamples      = position;
+        result.timeInSeconds      = position / settings.sampleRate;
+        result.ppqPosition        = result.timeInSeconds * settings.bpm / 60.0;
+        result.isPlaying          = true;
+
+        auto quarterNotesPerBar = settings.timeSigNumerator * 4.0 / jmax (1, settings.timeSigDenominator);
+
+        if (quarterNotesPerBar > 0)
+            result.ppqPositionOfLastBarStart = std::floor (result.ppqPosition / quarterNotesPerBar) * quarterNotesPerBar;
+
+        return true;
+    }
+
+    const Settings& settings;
+    int64 position = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (PlayHead)
+};
+
+//==============================================================================
+/*  Hands the rendered audio over to a background thread which writes it, so that
+    encoding the audio doesn't hold up the rendering. Unlike an
+    AudioFormatWriter::ThreadedWriter, this doesn't take ownership of the writer,
+    and it waits for space rather than dropping blocks when the FIFO is full.
+*/
+class OfflineRenderer::OutputPipe  : private Thread
+{
+public:
+    OutputPipe (AudioFormatWriter& w, int numSamplesToBuffer)
+        : Thread ("Offline render writer"),
+          writer (w),
+          buffer (jmax (1, (int) w.getNumChannels()), jmax (1, numSamplesToBuffer)),
+          fifo (buffer.getNumSamples()),
+          isPipelined (numSamplesToBuffer > 0)
+    {
+        if (isPipelined)
+            startThread();
+    }
+
+    ~OutputPipe()
+    {
+        finish();
+    }
+
+    bool write (const AudioBuffer<float>& source, int numSamples)
+    {
+        if (! isPipelined)
+        {
+            int done = 0;
+
+            while (done < numSamples && ! writeFailed)
+            {
+                auto numToDo = jmin (numSamples - done, buffer.getNumSamples());
+                copyFrom (source, done, 0, numToDo);
+                writeFailed = ! writer.writeFromAudioSampleBuffer (buffer, 0, numToDo);
+                done += numToDo;
+            }
+
+            return ! writeFailed;
+        }
+
+        int done = 0;
+
+        while (done < numSamples)
+        {
+            if (writeFailed)
+                return false;
+
+            int start1, size1, start2, size2;
+            fifo.prepareToWrite (numSamples - done, start1, size1, start2, size2);
+
+            if (size1 + size2 == 0)
+            {
+                spaceAvailable.wait (20);
+                continue;
+            }
+
+            copyFrom (source, done, start1, size1);
+            copyFrom (source, done + size1, start2, size2);
+            fifo.finishedWrite (size1 + size2);
+            dataAvailable.signal();
+
+            done += size1 + size2;
+        }
+
+        return true;
+    }
+
+    /** Waits for all the queued audio to be written. */
+    bool finish()
+    {
+        if (isPipelined)
+        {
+            isFinishing = true;
+            dataAvailable.signal();
+            waitForThreadToExit (-1);
+        }
+
+        return ! writeFailed;
+    }
+
+private:
+    AudioFormatWriter& writer;
+    AudioBuffer<float> buffer;
+    AbstractFifo fifo;
+    WaitableEvent dataAvailable, spaceAvailable;
+    std::atomic<bool> isFinishing { false }, writeFailed { false };
+    const bool isPipelined;
+
+    void copyFrom (const AudioBuffer<float>& source, int sourceStart, int destStart, int numSamples) noexcept
+    {
+        if (numSamples <= 0)
+            return;
+
+        for (int i = 0; i < buffer.getNumChannels(); ++i)
+        {
+            if (i < source.getNumChannels())
+                buffer.copyFrom (i, destStart, source, i, sourceStart, numSamples);
+            else
+                buffer.clear (i, destStart, numSamples);
+        }
+    }
+
+    void run() override
+    {
+        for (;;)
+        {
+            // This needs to be read before checking the FIFO, so that no audio is left behind
+            bool noMoreToCome = isFinishing;
+
+            int start1, size1, start2, size2;
+            fifo.prepareToRead (fifo.getNumReady(), start1, size1, start2, size2);
+
+            if (size1 + size2 == 0)
+            {
+                if (noMoreToCome)
+                    break;
+
+                dataAvailable.wait (20);
+                continue;
+            }
+
+            if ((size1 > 0 && ! writer.writeFromAudioSampleBuffer (buffer, start1, size1))
+                 || (size2 > 0 && ! writer.writeFromAudioSampleBuffer (buffer, start2, size2)))
+                writeFailed = true;
+
+            fifo.finishedRead (size1 + size2);
+            spaceAvailable.signal();
+
+            if (writeFailed)
+                break;
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (OutputPipe)
+};
+
+//==============================================================================
+OfflineRenderer::OfflineRenderer (const Settings& settingsToUse)
+    : settings (settingsToUse)
+{
+    jassert (settings.sampleRate > 0 && settings.blockSize > 0);
+}
+
+OfflineRenderer::~OfflineRenderer() {}
+
+//==============================================================================
+int64 OfflineRenderer::render (AudioProcessor& processor, AudioFormatWriter& writer,
+                               const MidiMessageSequence* midiInput)
+{
+    auto previousState = prepare (processor);
+    auto numWritten = renderPrepared (processor, writer, midiInput);
+    release (processor, previousState);
+
+    finishRender();
+    return numWritten;
+}
+
+int64 OfflineRenderer::render (AudioSource& source, AudioFormatWriter& writer)
+{
+    source.prepareToPlay (settings.blockSize, settings.sampleRate);
+
+    AudioBuffer<float> buffer (jmax (1, (int) writer.getNumChannels()), settings.blockSize);
+
+    auto numWritten = renderBlocks (writer, buffer, [&] (int64, int numSamples)
+    {
+        AudioSourceChannelInfo info (&buffer, 0, numSamples);
+        info.clearActiveBufferRegion();
+        source.getNextAudioBlock (info);
+    });
+
+    source.releaseResources();
+
+    finishRender();
+    return numWritten;
+}
+
+Array<int64> OfflineRenderer::renderInParallel (const Array<Stem>& stems, int maxNumThreads)
+{
+    Array<ProcessorState> previousStates;
+
+    for (auto& stem : stems)
+    {
+        jassert (stem.processor != nullptr && stem.writer != nullptr);
+        previousStates.add (prepare (*stem.processor));
+    }
+
+    Array<int64> results;
+    results.resize (stems.size());
+
+    ThreadPool::runInParallel (stems.size(), maxNumThreads, [&] (int index)
+    {
+        auto& stem = stems.getReference (index);
+        results.getReference (index) = renderPrepared (*stem.processor, *stem.writer, stem.midiInput);
+    });
+
+    for (int i = 0; i < stems.size(); ++i)
+        release (*stems.getReference (i).processor, previousStates.getReference (i));
+
+    finishRender();
+    return results;
+}
+
+//==============================================================================
+OfflineRenderer::ProcessorState OfflineRenderer::prepare (AudioProcessor& processor)
+{
+    ProcessorState previousState { processor.isNonRealtime(), processor.getProcessingPrecision() };
+
+    processor.setNonRealtime (true);
+    processor.setProcessingPrecision (AudioProcessor::singlePrecision);
+    processor.setRateAndBufferSizeDetails (settings.sampleRate, settings.blockSize);
+    processor.prepareToPlay (settings.sampleRate, settings.blockSize);
+
+    return previousState;
+}
+
+void OfflineRenderer::release (AudioProcessor& processor, ProcessorState previousState)
+{
+    processor.releaseResources();
+    processor.setNonRealtime (previousState.wasNonRealtime);
+    processor.setProcessingPrecision (previousState.precision);
+}
+
+void OfflineRenderer::finishRender() noexcept
+{
+    // A stop() that arrives before a render starts must still stop it, so the flag is
+    // only cleared once the render that it applied to has finished
+    lastRenderWasStopped = shouldStop.exchange (false);
+}
+
+int64 OfflineRenderer::renderPrepared (AudioProcessor& processor, AudioFormatWriter& writer,
+                                       const MidiMessageSequence* midiInput)
+{
+    PlayHead playHead (settings);
+    auto* oldPlayHead = processor.getPlayHead();
+    processor.setPlayHead (&playHead);
+
+    AudioBuffer<float> buffer (jmax (1, processor.getTotalNumInputChannels(),
+                                     processor.getTotalNumOutputChannels()),
+                               settings.blockSize);
+
+    MidiBuffer midiBuffer;
+    int nextMidiEvent = 0;
+
+    auto numWritten = renderBlocks (writer, buffer, [&] (int64 position, int numSamples)
+    {
+        buffer.clear();
+        midiBuffer.clear();
+
+        if (midiInput != nullptr)
+        {
+            for (auto numEvents = midiInput->getNumEvents(); nextMidiEvent < numEvents; ++nextMidiEvent)
+            {
+                auto& message = midiInput->getEventPointer (nextMidiEvent)->message;
+                auto eventSample = (int64) std::floor (message.getTimeStamp() * settings.sampleRate + 0.5);
+
+                if (eventSample >= position + numSamples)
+                    break;
+
+                midiBuffer.addEvent (message, (int) jmax ((int64) 0, eventSample - position));
+            }
+        }
+
+        playHead.position = position;
+        AudioBuffer<float> block (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), numSamples);
+
+        const ScopedLock sl (processor.getCallbackLock());
+
+        if (processor.isSuspended())
+            block.clear();
+        else
+            processor.processBlock (block, midiBuffer);
+    });
+
+    processor.setPlayHead (oldPlayHead);
+    return numWritten;
+}
+
+int64 OfflineRenderer::renderBlocks (AudioFormatWriter& writer, AudioBuffer<float>& buffer,
+                                     std::function<void (int64, int)> renderNextBlock)
+{
+    OutputPipe output (writer, settings.numSamplesToBuffer);
+
+    auto endOfTail = settings.lengthInSamples + jmax ((int64) 0, settings.maximumTailLengthInSamples);
+    int64 position = 0;
+
+    while (position < endOfTail && ! shouldStop)
+    {
+        auto numSamples = (int) jmin ((int64) settings.blockSize, endOfTail - position);
+        renderNextBlock (position, numSamples);
+
+        if (position >= settings.lengthInSamples
+             && buffer.getMagnitude (0, numSamples) < settings.silenceThreshold)
+            break;
+
+        if (! output.write (buffer, numSamples))
+            break;
+
+        position += numSamples;
+    }
+
+    output.finish();
+    return position;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class OfflineRendererTests  : public UnitTest
+{
+public:
+    OfflineRendererTests()  : UnitTest ("OfflineRenderer", "Audio") {}
+
+    void runTest() override
+    {
+        for (auto numSamplesToBuffer : { 0, 256 })
+        {
+            auto settings = createSettings (numSamplesToBuffer);
+            auto suffix = numSamplesToBuffer > 0 ? String (" (pipelined)") : String();
+
+            beginTest ("Rendering a source" + suffix);
+            {
+                settings.lengthInSamples = 1050;
+                OfflineRenderer renderer (settings);
+                TestSource source;
+
+                MemoryBlock data;
+                expect (renderer.render (source, *createWriter (data, 2)) == 1050);
+                expect (! renderer.wasStopped());
+                expect (source.wasReleased);
+
+                auto result = readBack (data);
+                expectEquals (result.getNumSamples(), 1050);
+
+                for (int i = 0; i < result.getNumSamples(); ++i)
+                {
+                    if (result.getSample (0, i) != TestSource::getSample (i) || result.getSample (1, i) != 0.5f)
+                    {
+                        expect (false, "mismatch at sample " + String (i));
+                        return;
+                    }
+                }
+            }
+
+            beginTest ("Tails" + suffix);
+            {
+                // The source goes silent at sample 1000, so the tail ends there..
+                settings.lengthInSamples = 500;
+                settings.maximumTailLengthInSamples = 10000;
+
+                TestSource source;
+                source.numSamplesBeforeSilence = 1000;
+
+                MemoryBlock data;
+                expect (OfflineRenderer (settings).render (source, *createWriter (data, 2)) == 1000);
+                expectEquals (readBack (data).getNumSamples(), 1000);
+
+                // ..but one that never goes quiet is cut off at the maximum tail length.
+                settings.maximumTailLengthInSamples = 250;
+                source.numSamplesBeforeSilence = -1;
+
+                MemoryBlock data2;
+                expect (OfflineRenderer (settings).render (source, *createWriter (data2, 2)) == 750);
+                expectEquals (readBack (data2).getNumSamples(), 750);
+
+                // A silent block before the end of the requested length is still written.
+                source.numSamplesBeforeSilence = 200;
+
+                MemoryBlock data3;
+                expect (OfflineRenderer (settings).render (source, *createWriter (data3, 2)) == 500);
+            }
+
+            beginTest ("Stopping" + suffix);
+            {
+                settings.lengthInSamples = 1000;
+                settings.maximumTailLengthInSamples = 0;
+                OfflineRenderer renderer (settings);
+
+                // The block in which stop() is called is the last one to be rendered..
+                TestSource source;
+                source.stopAtSample = 300;
+                source.rendererToStop = &renderer;
+
+                MemoryBlock data;
+                expect (renderer.render (source, *createWriter (data, 2)) == 400);
+                expect (renderer.wasStopped());
+                expectEquals (readBack (data).getNumSamples(), 400);
+
+                // ..the next render isn't affected..
+                source.rendererToStop = nullptr;
+                MemoryBlock data2;
+                expect (renderer.render (source, *createWriter (data2, 2)) == 1000);
+                expect (! renderer.wasStopped());
+
+                // ..and calling stop() before a render starts still stops it.
+                renderer.stop();
+                MemoryBlock data3;
+                expect (renderer.render (source, *createWriter (data3, 2)) == 0);
+                expect (renderer.wasStopped());
+            }
+
+            beginTest ("Rendering a processor with midi" + suffix);
+            {
+                settings.lengthInSamples = 1000;
+                OfflineRenderer renderer (settings);
+
+                TestProcessor processor (0.25f);
+                processor.setProcessingPrecision (AudioProcessor::doublePrecision);
+
+                MidiMessageSequence midi;
+                midi.addEvent (MidiMessage::noteOn (1, 60, (uint8) 100).withTimeStamp (0.0));
+                midi.addEvent (MidiMessage::noteOn (1, 61, (uint8) 80).withTimeStamp (0.1234));
+                midi.addEvent (MidiMessage::noteOn (1, 62, (uint8) 60).withTimeStamp (0.5));
+                midi.addEvent (MidiMessage::noteOn (1, 63, (uint8) 40).withTimeStamp (0.999));
+                midi.addEvent (MidiMessage::noteOn (1, 64, (uint8) 20).withTimeStamp (2.0));
+
+                MemoryBlock data;
+                expect (renderer.render (processor, *createWriter (data, 2), &midi) == 1000);
+
+                auto result = readBack (data);
+                expectEquals (result.getNumSamples(), 1000);
+
+                // (at 1kHz, each event should land on the nearest sample to its timestamp)
+                Array<int> expectedPositions (0, 123, 500, 999);
+                Array<float> expectedValues (100 / 127.0f, 80 / 127.0f, 60 / 127.0f, 40 / 127.0f);
+
+                for (int i = 0; i < result.getNumSamples(); ++i)
+                {
+                    auto index = expectedPositions.indexOf (i);
+                    auto expected = index >= 0 ? expectedValues[index] : 0.0f;
+
+                    if (result.getSample (0, i) != expected || result.getSample (1, i) != 0.25f)
+                    {
+                        expect (false, "mismatch at sample " + String (i));
+                        return;
+                    }
+                }
+
+                expect (processor.wasNonRealtimeWhenProcessing);
+                expectEquals (processor.lastPosition.bpm, 140.0);
+                expect (processor.lastPosition.timeInSamples == 900);
+
+                // the processor's own settings should have been put back
+                expect (! processor.isNonRealtime());
+                expect (processor.getProcessingPrecision() == AudioProcessor::doublePrecision);
+                expect (processor.getPlayHead() == nullptr);
+                expect (processor.wasReleased);
+            }
+
+            beginTest ("Rendering in parallel" + suffix);
+            {
+                settings.lengthInSamples = 777;
+                OfflineRenderer renderer (settings);
+
+                OwnedArray<TestProcessor> processors;
+                OwnedArray<MemoryBlock> blocks;
+                std::vector<std::unique_ptr<AudioFormatWriter>> writers;
+                Array<OfflineRenderer::Stem> stems;
+
+                MidiMessageSequence midi;
+                midi.addEvent (MidiMessage::noteOn (1, 60, (uint8) 127).withTimeStamp (0.3));
+
+                for (int i = 0; i < 5; ++i)
+                {
+                    auto* processor = processors.add (new TestProcessor ((float) (i + 1) * 0.1f));
+                    writers.push_back (createWriter (*blocks.add (new MemoryBlock()), 2));
+
+                    OfflineRenderer::Stem stem;
+                    stem.processor = processor;
+                    stem.writer = writers.back().get();
+                    stem.midiInput = (i % 2) == 0 ? &midi : nullptr;
+                    stems.add (stem);
+                }
+
+                auto results = renderer.renderInParallel (stems, 3);
+                writers.clear();
+
+                expectEquals (results.size(), 5);
+
+                for (int i = 0; i < 5; ++i)
+                {
+                    expect (results[i] == 777);
+
+                    auto result = readBack (*blocks[i]);
+                    expectEquals (result.getNumSamples(), 777);
+                    expectEquals (result.getSample (1, 776), (float) (i + 1) * 0.1f);
+                    expectEquals (result.getSample (0, 300), (i % 2) == 0 ? 1.0f : 0.0f);
+                    expectEquals (result.getMagnitude (0, 0, 300), 0.0f);
+                    expect (processors[i]->wasReleased);
+                }
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    // Produces a ramp on its first channel and a constant on the second.
+    struct TestSource  : public AudioSource
+    {
+        static float getSample (int64 position) noexcept    { return (float) (position % 100) / 1000.0f; }
+
+        void prepareToPlay (int, double) override           { position = 0; wasReleased = false; }
+        void releaseResources() override                    { wasReleased = true; }
+
+        void getNextAudioBlock (const AudioSourceChannelInfo& info) override
+        {
+            if (rendererToStop != nullptr && position <= stopAtSample && stopAtSample < position + info.numSamples)
+                rendererToStop->stop();
+
+            for (int i = 0; i < info.numSamples; ++i, ++position)
+            {
+                auto isSilent = numSamplesBeforeSilence >= 0 && position >= numSamplesBeforeSilence;
+
+                info.buffer->setSample (0, info.startSample + i, isSilent ? 0.0f : getSample (position));
+                info.buffer->setSample (1, info.startSample + i, isSilent ? 0.0f : 0.5f);
+            }
+        }
+
+        int64 position = 0, numSamplesBeforeSilence = -1, stopAtSample = -1;
+        OfflineRenderer* rendererToStop = nullptr;
+        bool wasReleased = false;
+    };
+
+    // Writes each midi note-on's velocity at its position on the first channel, and a
+    // constant level on the second.
+    struct TestProcessor  : public AudioProcessor
+    {
+        TestProcessor (float levelToUse)
+            : AudioProcessor (BusesProperties().withOutput ("Output", AudioChannelSet::stereo())),
+              level (levelToUse)
+        {
+        }
+
+        const String getName() const override                       { return "Test"; }
+        void prepareToPlay (double, int) override                   { wasReleased = false; }
+        void releaseResources() override                            { wasReleased = true; }
+        double getTailLengthSeconds() const override                { return 0; }
+        bool acceptsMidi() const override                           { return true; }
+        bool producesMidi() const override                          { return false; }
+        bool supportsDoublePrecisionProcessing() const override     { return true; }
+        AudioProcessorEditor* createEditor() override               { return nullptr; }
+        bool hasEditor() const override                             { return false; }
+        int getNumPrograms() override                               { return 1; }
+        int getCurrentProgram() override                            { return 0; }
+        void setCurrentProgram (int) override                       {}
+        const String getProgramName (int) override                  { return {}; }
+        void changeProgramName (int, const String&) override        {}
+        void getStateInformation (MemoryBlock&) override            {}
+        void setStateInformation (const void*, int) override        {}
+
+        void processBlock (AudioBuffer<float>& buffer, MidiBuffer& midi) override
+        {
+            buffer.clear();
+
+            for (const auto metadata : midi)
+            {
+                auto message = metadata.getMessage();
+
+                if (message.isNoteOn())
+                    buffer.setSample (0, metadata.samplePosition, message.getFloatVelocity());
+            }
+
+            FloatVectorOperations::fill (buffer.getWritePointer (1), level, buffer.getNumSamples());
+
+            wasNonRealtimeWhenProcessing = isNonRealtime();
+
+            if (auto* currentPlayHead = getPlayHead())
+                currentPlayHead->getCurrentPosition (lastPosition);
+        }
+
+        void processBlock (AudioBuffer<double>&, MidiBuffer&) override
+        {
+            jassertfalse; // the renderer should always use single precision
+        }
+
+        const float level;
+        bool wasNonRealtimeWhenProcessing = false, wasReleased = false;
+        AudioPlayHead::CurrentPositionInfo lastPosition;
+    };
+
+    //==============================================================================
+    static OfflineRenderer::Settings createSettings (int numSamplesToBuffer)
+    {
+        OfflineRenderer::Settings settings;
+        settings.sampleRate = 1000.0;
+        settings.blockSize = 100;
+        settings.bpm = 140.0;
+        settings.numSamplesToBuffer = numSamplesToBuffer;
+        return settings;
+    }
+
+    static std::unique_ptr<AudioFormatWriter> createWriter (MemoryBlock& data, int numChannels)
+    {
+        // (32-bit WAV files hold floats, so the samples come back exactly as they were rendered)
+        return std::unique_ptr<AudioFormatWriter> (WavAudioFormat().createWriterFor (new MemoryOutputStream (data, false),
+                                                                                    1000.0, (unsigned int) numChannels,
+                                                                                    32, {}, 0));
+    }
+
+    static AudioBuffer<float> readBack (const MemoryBlock& data)
+    {
+        std::unique_ptr<AudioFormatReader> reader (WavAudioFormat().createReaderFor (new MemoryInputStream (data, false), true));
+        AudioBuffer<float> result ((int) reader->numChannels, (int) reader->lengthInSamples);
+        reader->read (&result, 0, result.getNumSamples(), 0, true, true);
+        return result;
+    }
+};
+
+static OfflineRendererTests offlineRendererTests;
+
+#endif
+
+} // namespace juce
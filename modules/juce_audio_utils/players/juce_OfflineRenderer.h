@@ -0,0 +1,198 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Renders an AudioProcessor (e.g. an AudioProcessorGraph) or an AudioSource into an
+    AudioFormatWriter as quickly as possible, rather than in real time.
+
+    The processor is put into non-realtime mode and given a play head which reports
+    a steady tempo, and it can be fed midi from a MidiMessageSequence. The audio is
+    handed over to a background thread to be encoded and written, so that rendering
+    the next blocks can carry on while the writer is busy.
+
+    Once the requested length has been rendered, the renderer can carry on rendering
+    an effect tail until the output falls silent, and a render can be cut short from
+    another thread with stop().
+
+    @code
+    OfflineRenderer::Settings settings;
+    settings.sampleRate = 48000.0;
+    settings.lengthInSamples = 48000 * 10;
+    settings.maximumTailLengthInSamples = 48000 * 5;
+
+    OfflineRenderer renderer (settings);
+    renderer.render (myGraph, *myWriter, &myMidiSequence);
+    @endcode
+
+    @see AudioProcessorPlayer, AudioFormatWriter
+
+    @tags{Audio}
+*/
+class JUCE_API  OfflineRenderer
+{
+public:
+    //==============================================================================
+    /** The options that control a render. */
+    struct JUCE_API  Settings
+    {
+        /** The sample rate to render at. */
+        double sampleRate = 44100.0;
+
+        /** The number of samples that the processor or source is asked for at a time. */
+        int blockSize = 512;
+
+        /** The number of samples to render. */
+        int64 lengthInSamples = 0;
+
+        /** After lengthInSamples has been rendered, the renderer keeps going for up to
+            this many samples, stopping as soon as a block is rendered whose level is
+            below silenceThreshold. The silent block isn't written.
+        */
+        int64 maximumTailLengthInSamples = 0;
+
+        /** The gain below which a block of the tail is treated as silent. */
+        float silenceThreshold = Decibels::decibelsToGain (-90.0f);
+
+        /** The tempo that's reported by the play head. */
+        double bpm = 120.0;
+
+        /** The time signature that's reported by the play head. */
+        int timeSigNumerator = 4, timeSigDenominator = 4;
+
+        /** The number of samples that can be queued up for the writer's background thread.
+            If this is 0, the audio is written on the rendering thread instead.
+        */
+        int numSamplesToBuffer = 65536;
+    };
+
+    //==============================================================================
+    /** Creates a renderer which will use the given settings. */
+    explicit OfflineRenderer (const Settings& settingsToUse);
+
+    /** Destructor. */
+    ~OfflineRenderer();
+
+    //==============================================================================
+    /** Renders a processor into a writer.
+
+        The processor is prepared, run in non-realtime mode with single precision, and
+        then released, and its previous play head, non-realtime flag and processing
+        precision are restored afterwards. Its output channels are written to
+        the writer - if the writer has more channels than the processor, the extra ones
+        will be silent.
+
+        When rendering an AudioProcessorGraph, call this on the message thread, because
+        that's where the graph builds its rendering sequence when it's prepared.
+
+        @param processor    the processor to render - this mustn't be playing anywhere else
+        @param writer       the writer to send the audio to
+        @param midiInput    an optional sequence of midi events whose timestamps are in seconds,
+                            which will be passed to the processor at the appropriate times
+        @returns the number of samples that were written
+    */
+    int64 render (AudioProcessor& processor,
+                  AudioFormatWriter& writer,
+                  const MidiMessageSequence* midiInput = nullptr);
+
+    /** Renders an AudioSource into a writer.
+
+        The source is prepared, rendered and then released. Only the length, tail and
+        writing settings apply, as sources have no play head or midi input.
+
+        @returns the number of samples that were written
+    */
+    int64 render (AudioSource& source, AudioFormatWriter& writer);
+
+    //==============================================================================
+    /** Describes one of a set of independent renders for renderInParallel(). */
+    struct JUCE_API  Stem
+    {
+        /** The processor to render. Each stem must have its own processor. */
+        AudioProcessor* processor = nullptr;
+
+        /** The writer to send the audio to. Each stem must have its own writer. */
+        AudioFormatWriter* writer = nullptr;
+
+        /** An optional sequence of midi events, with timestamps in seconds. */
+        const MidiMessageSequence* midiInput = nullptr;
+    };
+
+    /** Renders a set of independent stems at the same time, using a pool of threads.
+
+        The processors are all prepared and released on the calling thread, which should
+        be the message thread if any of them are AudioProcessorGraphs.
+
+        @param stems                the stems to render
+        @param maxNumThreads        the maximum number of stems to render at once, or 0 to use
+                                    one thread per CPU core
+        @returns the number of samples written for each stem
+    */
+    Array<int64> renderInParallel (const Array<Stem>& stems, int maxNumThreads = 0);
+
+    //==============================================================================
+    /** Stops any renders that are in progress as soon as they finish their current block.
+
+        This can be called from any thread. The audio rendered so far will still be written.
+        If no render is in progress, the next one to start will stop straight away, so that
+        a render which is cancelled just before it begins doesn't get missed.
+    */
+    void stop() noexcept                    { shouldStop = true; }
+
+    /** Returns true if the last render was ended by a call to stop(). */
+    bool wasStopped() const noexcept        { return lastRenderWasStopped; }
+
+    /** Returns the settings that the renderer is using. */
+    const Settings& getSettings() const noexcept        { return settings; }
+
+private:
+    //==============================================================================
+    struct PlayHead;
+    class OutputPipe;
+
+    // The state of a processor that prepare() changes, so that release() can put it back
+    struct ProcessorState
+    {
+        bool wasNonRealtime;
+        AudioProcessor::ProcessingPrecision precision;
+    };
+
+    const Settings settings;
+    std::atomic<bool> shouldStop { false }, lastRenderWasStopped { false };
+
+    ProcessorState prepare (AudioProcessor&);
+    void release (AudioProcessor&, ProcessorState);
+    void finishRender() noexcept;
+    int64 renderPrepared (AudioProcessor&, AudioFormatWriter&, const MidiMessageSequence*);
+    int64 renderBlocks (AudioFormatWriter&, AudioBuffer<float>&, std::function<void (int64, int)>);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};
+
+} // namespace juce
@@ -864,21 +864,38 @@ public:
 
         @param startIndex       the index of the first element to remove
         @param numberToRemove   how many elements should be removed
-        @see remove, removeFirstMatchingValue, removeAllInstancesOf, removeIf
+        @see remove, removeFirstMatchingValue, removeAllInstancesOf, removeIf, removeRangeQuick
     */
     void removeRange (int startIndex, int numberToRemove)
     {
         const ScopedLockType lock (getLock());
 
+        if (removeRangeQuick (startIndex, numberToRemove))
+            minimiseStorageAfterRemoval();
+    }
+
+    /** Removes a range of elements from the array without freeing any of the array's
+        allocated storage.
+
+        This is the same as removeRange(), except that the storage is never shrunk, so
+        elements can be added again later without it being reallocated.
+
+        @returns true if any elements were removed
+        @see removeRange, clearQuick
+    */
+    bool removeRangeQuick (int startIndex, int numberToRemove)
+    {
+        const ScopedLockType lock (getLock());
+
         auto endIndex = jlimit (0, values.size(), startIndex + numberToRemove);
         startIndex    = jlimit (0, values.size(), startIndex);
         numberToRemove = endIndex - startIndex;
 
-        if (numberToRemove > 0)
-        {
-            values.removeElements (startIndex, numberToRemove);
-            minimiseStorageAfterRemoval();
-        }
+        if (numberToRemove <= 0)
+            return false;
+
+        values.removeElements (startIndex, numberToRemove);
+        return true;
     }
 
     /** Removes the last n elements from the array.
@@ -58,32 +58,123 @@ bool NamedValueSet::NamedValue::operator!= (const NamedValue& other) const noexc
 NamedValueSet::NamedValueSet() noexcept {}
 NamedValueSet::~NamedValueSet() noexcept {}
 
-NamedValueSet::NamedValueSet (const NamedValueSet& other)  : values (other.values) {}
+NamedValueSet::NamedValueSet (const NamedValueSet& other)
+   : values (other.values), hashIndex (other.hashIndex) {}
 
 NamedValueSet::NamedValueSet (NamedValueSet&& other) noexcept
-   : values (std::move (other.values)) {}
+   : values (std::move (other.values)), hashIndex (std::move (other.hashIndex)) {}
 
 NamedValueSet::NamedValueSet (std::initializer_list<NamedValue> list)
    : values (std::move (list))
 {
+    rebuildHashIndex();
 }
 
 NamedValueSet& NamedValueSet::operator= (const NamedValueSet& other)
 {
     clear();
     values = other.values;
+    hashIndex = other.hashIndex;
     return *this;
 }
 
 NamedValueSet& NamedValueSet::operator= (NamedValueSet&& other) noexcept
 {
     other.values.swapWith (values);
+    other.hashIndex.swapWith (hashIndex);
     return *this;
 }
 
 void NamedValueSet::clear()
 {
     values.clear();
+    hashIndex.clear();
+}
+
+//==============================================================================
+static inline int getIdentifierHash (const Identifier& name) noexcept
+{
+    // Identifiers are pooled, so the address of the string data is a unique key
+    auto h = (uint64) (pointer_sized_uint) name.getCharPointer().getAddress();
+    h ^= (h >> 17);
+    h *= 0x9e3779b97f4a7c15ULL;
+    return (int) (h >> 33);
+}
+
+int NamedValueSet::findIndex (const Identifier& name) const noexcept
+{
+    if (hashIndex.isEmpty())
+    {
+        auto numValues = values.size();
+
+        for (int i = 0; i < numValues; ++i)
+            if (values.getReference (i).name == name)
+                return i;
+
+        return -1;
+    }
+
+    auto mask = hashIndex.size() - 1;
+
+    for (auto slot = getIdentifierHash (name) & mask;; slot = (slot + 1) & mask)
+    {
+        auto index = hashIndex.getUnchecked (slot);
+
+        if (index < 0 || values.getReference (index).name == name)
+            return index;
+    }
+}
+
+void NamedValueSet::insertIntoHashIndex (int valueIndex) noexcept
+{
+    auto mask = hashIndex.size() - 1;
+    auto slot = getIdentifierHash (values.getReference (valueIndex).name) & mask;
+
+    while (hashIndex.getUnchecked (slot) >= 0)
+        slot = (slot + 1) & mask;
+
+    hashIndex.set (slot, valueIndex);
+}
+
+void NamedValueSet::rebuildHashIndex()
+{
+    hashIndex.clearQuick();
+
+    auto numValues = values.size();
+
+    if (numValues <= hashIndexThreshold)
+        return;
+
+    // keep the table at most half full so that probe sequences stay short
+    int tableSize = 2 * hashIndexThreshold;
+
+    while (tableSize < numValues * 2)
+        tableSize *= 2;
+
+    hashIndex.insertMultiple (0, -1, tableSize);
+
+    for (int i = 0; i < numValues; ++i)
+        insertIntoHashIndex (i);
+}
+
+void NamedValueSet::addValue (NamedValue&& newValue)
+{
+    values.add (std::move (newValue));
+    auto numValues = values.size();
+
+    if (hashIndex.isEmpty())
+    {
+        if (numValues > hashIndexThreshold)
+            rebuildHashIndex();
+    }
+    else if (numValues * 2 > hashIndex.size())
+    {
+        rebuildHashIndex();
+    }
+    else
+    {
+        insertIntoHashIndex (numValues - 1);
+    }
 }
 
 bool NamedValueSet::operator== (const NamedValueSet& other) const noexcept
@@ -149,9 +240,10 @@ var NamedValueSet::getWithDefault (const Identifier& name, const var& defaultRet
 
 var* NamedValueSet::getVarPointer (const Identifier& name) const noexcept
 {
-    for (auto& i : values)
-        if (i.name == name)
-            return &(i.value);
+    auto index = findIndex (name);
+
+    if (index >= 0)
+        return &(values.getReference (index).value);
 
     return {};
 }
@@ -167,7 +259,7 @@ bool NamedValueSet::set (const Identifier& name, var&& newValue)
         return true;
     }
 
-    values.add ({ name, std::move (newValue) });
+    addValue ({ name, std::move (newValue) });
     return true;
 }
 
@@ -182,7 +274,7 @@ bool NamedValueSet::set (const Identifier& name, const var& newValue)
         return true;
     }
 
-    values.add ({ name, newValue });
+    addValue ({ name, newValue });
     return true;
 }
 
@@ -193,29 +285,23 @@ bool NamedValueSet::contains (const Identifier& name) const noexcept
 
 int NamedValueSet::indexOf (const Identifier& name) const noexcept
 {
-    auto numValues = values.size();
-
-    for (int i = 0; i < numValues; ++i)
-        if (values.getReference(i).name == name)
-            return i;
-
-    return -1;
+    return findIndex (name);
 }
 
 bool NamedValueSet::remove (const Identifier& name)
 {
-    auto numValues = values.size();
+    auto index = findIndex (name);
 
-    for (int i = 0; i < numValues; ++i)
-    {
-        if (values.getReference(i).name == name)
-        {
-            values.remove (i);
-            return true;
-        }
-    }
+    if (index < 0)
+        return false;
+
+    values.remove (index);
+
+    // removal shuffles the indexes of all the later items, so the index has to be rebuilt
+    if (! hashIndex.isEmpty())
+        rebuildHashIndex();
 
-    return false;
+    return true;
 }
 
 Identifier NamedValueSet::getName (const int index) const noexcept
@@ -247,6 +333,7 @@ var* NamedValueSet::getVarPointerAt (int index) const noexcept
 void NamedValueSet::setFromXmlAttributes (const XmlElement& xml)
 {
     values.clearQuick();
+    hashIndex.clearQuick();
 
     for (auto* att = xml.attributes.get(); att != nullptr; att = att->nextListItem)
     {
@@ -263,6 +350,8 @@ void NamedValueSet::setFromXmlAttributes (const XmlElement& xml)
 
         values.add ({ att->name, var (att->value) });
     }
+
+    rebuildHashIndex();
 }
 
 void NamedValueSet::copyToXmlAttributes (XmlElement& xml) const
@@ -286,4 +375,104 @@ void NamedValueSet::copyToXmlAttributes (XmlElement& xml) const
     }
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NamedValueSetTests  : public UnitTest
+{
+public:
+    NamedValueSetTests() : UnitTest ("NamedValueSet", "Containers") {}
+
+    void runTest() override
+    {
+        const int numItems = 200;
+        Array<Identifier> names;
+
+        for (int i = 0; i < numItems; ++i)
+            names.add ("prop" + String (i));
+
+        beginTest ("Lookup and ordering");
+        {
+            NamedValueSet set;
+
+            for (int i = 0; i < numItems; ++i)
+            {
+                expect (set.set (names[i], i));
+                expect (! set.set (names[i], i));
+            }
+
+            expectEquals (set.size(), numItems);
+
+            for (int i = 0; i < numItems; ++i)
+            {
+                expectEquals (set.indexOf (names[i]), i);
+                expect (set.getName (i) == names[i]);
+                expectEquals ((int) set[names[i]], i);
+            }
+
+            expect (! set.contains ("missing"));
+            expectEquals (set.indexOf ("missing"), -1);
+        }
+
+        beginTest ("Removal");
+        {
+            NamedValueSet set;
+
+            for (int i = 0; i < numItems; ++i)
+                set.set (names[i], i);
+
+            for (int i = 0; i < numItems; i += 2)
+                expect (set.remove (names[i]));
+
+            expectEquals (set.size(), numItems / 2);
+
+            for (int i = 0; i < numItems; ++i)
+            {
+                expect (set.contains (names[i]) == ((i & 1) != 0));
+
+                if ((i & 1) != 0)
+                    expectEquals (set.indexOf (names[i]), i / 2);
+            }
+
+            while (set.size() > 1)
+                expect (set.remove (set.getName (0)));
+
+            expect (set.contains (names[numItems - 1]));
+            expect (! set.contains (names[1]));
+        }
+
+        beginTest ("Copying and comparison");
+        {
+            NamedValueSet set;
+
+            for (int i = 0; i < numItems; ++i)
+                set.set (names[i], i);
+
+            NamedValueSet copy (set);
+            expect (copy == set);
+
+            NamedValueSet reversed;
+
+            for (int i = numItems; --i >= 0;)
+                reversed.set (names[i], i);
+
+            expect (reversed == set);
+
+            reversed.set (names[0], -1);
+            expect (reversed != set);
+
+            NamedValueSet moved (std::move (copy));
+            expectEquals ((int) moved[names[numItems - 1]], numItems - 1);
+
+            moved.clear();
+            expect (moved.isEmpty());
+            expect (! moved.contains (names[0]));
+        }
+    }
+};
+
+static NamedValueSetTests namedValueSetTests;
+
+#endif
+
 } // namespace juce
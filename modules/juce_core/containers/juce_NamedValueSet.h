@@ -29,6 +29,11 @@ namespace juce
     This can be used as a basic structure to hold a set of var object, which can
     be retrieved by using their identifier.
 
+    Small sets are searched linearly, but once a set grows beyond a handful of
+    items it also maintains a hash index of its names, so that lookups in sets
+    with many properties stay fast. The order in which items were added is always
+    preserved.
+
     @tags{Core}
 */
 class JUCE_API  NamedValueSet
@@ -164,6 +169,14 @@ public:
 private:
     //==============================================================================
     Array<NamedValue> values;
+    Array<int> hashIndex;
+
+    enum { hashIndexThreshold = 16 };
+
+    int findIndex (const Identifier&) const noexcept;
+    void addValue (NamedValue&&);
+    void rebuildHashIndex();
+    void insertIntoHashIndex (int valueIndex) noexcept;
 };
 
 } // namespace juce
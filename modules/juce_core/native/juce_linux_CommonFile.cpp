@@ -72,8 +72,7 @@ class DirectoryIterator::NativeIterator::Pimpl
 {
 public:
     Pimpl (const File& directory, const String& wc)
-        : parentDir (File::addTrailingSeparator (directory.getFullPathName())),
-          wildCard (wc), dir (opendir (directory.getFullPathName().toUTF8()))
+        : wildCard (wc), dir (opendir (directory.getFullPathName().toUTF8()))
     {
     }
 
@@ -105,7 +104,7 @@ public:
                 {
                     filenameFound = CharPointer_UTF8 (de->d_name);
 
-                    updateStatInfoForFile (parentDir + filenameFound, isDir, fileSize, modTime, creationTime, isReadOnly);
+                    updateStatInfoForEntry (*de, isDir, fileSize, modTime, creationTime, isReadOnly);
 
                     if (isHidden != nullptr)
                         *isHidden = filenameFound.startsWithChar ('.');
@@ -119,9 +118,42 @@ public:
     }
 
 private:
-    String parentDir, wildCard;
+    String wildCard;
     DIR* dir;
 
+    // The entries are looked up relative to the open directory, which saves the kernel from
+    // having to resolve the whole path again for each one, and if the caller only wants to
+    // know whether it's a directory, the type in the dirent is used without calling stat.
+    void updateStatInfoForEntry (const struct dirent& de, bool* isDir, int64* fileSize,
+                                 Time* modTime, Time* creationTime, bool* isReadOnly)
+    {
+        auto fd = dirfd (dir);
+
+        if (fileSize != nullptr || modTime != nullptr || creationTime != nullptr
+             || (isDir != nullptr && (de.d_type == DT_UNKNOWN || de.d_type == DT_LNK)))
+        {
+            juce_statStruct info;
+
+           #if JUCE_LINUX
+            const bool statOk = fstatat64 (fd, de.d_name, &info, 0) == 0;
+           #else
+            const bool statOk = fstatat (fd, de.d_name, &info, 0) == 0;
+           #endif
+
+            if (isDir != nullptr)         *isDir        = statOk && ((info.st_mode & S_IFDIR) != 0);
+            if (fileSize != nullptr)      *fileSize     = statOk ? (int64) info.st_size : 0;
+            if (modTime != nullptr)       *modTime      = Time (statOk ? (int64) info.st_mtime  * 1000 : 0);
+            if (creationTime != nullptr)  *creationTime = Time (statOk ? getCreationTime (info) * 1000 : 0);
+        }
+        else if (isDir != nullptr)
+        {
+            *isDir = (de.d_type == DT_DIR);
+        }
+
+        if (isReadOnly != nullptr)
+            *isReadOnly = faccessat (fd, de.d_name, W_OK, 0) != 0;
+    }
+
     JUCE_DECLARE_NON_COPYABLE (Pimpl)
 };
 
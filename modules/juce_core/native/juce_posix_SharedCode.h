@@ -277,6 +277,7 @@ namespace
     static int64 getCreationTime (const juce_statStruct& s) noexcept     { return (int64) s.st_ctime; }
    #endif
 
+   #if JUCE_MAC || JUCE_IOS
     void updateStatInfoForFile (const String& path, bool* isDir, int64* fileSize,
                                 Time* modTime, Time* creationTime, bool* isReadOnly)
     {
@@ -294,6 +295,7 @@ namespace
         if (isReadOnly != nullptr)
             *isReadOnly = access (path.toUTF8(), W_OK) != 0;
     }
+   #endif
 
     Result getResultForErrno()
     {
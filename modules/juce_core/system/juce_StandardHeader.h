@@ -54,6 +54,8 @@
 #include <sstream>
 #include <iomanip>
 #include <map>
+#include <list>
+#include <unordered_map>
 
 //==============================================================================
 #include "juce_CompilerSupport.h"
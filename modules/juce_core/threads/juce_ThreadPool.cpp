@@ -174,6 +174,29 @@ void ThreadPool::addJob (std::function<void()> jobToRun)
     addJob (new LambdaJobWrapper (jobToRun), true);
 }
 
+void ThreadPool::runInParallel (int numItems, int maxNumThreads, std::function<void (int)> processItem)
+{
+    if (numItems <= 0)
+        return;
+
+    ThreadPool pool (jlimit (1, numItems, maxNumThreads > 0 ? maxNumThreads : SystemStats::getNumCpus()));
+    std::atomic<int> numItemsLeft { numItems };
+    WaitableEvent allFinished;
+
+    for (int i = 0; i < numItems; ++i)
+    {
+        pool.addJob ([&, i]
+        {
+            processItem (i);
+
+            if (--numItemsLeft == 0)
+                allFinished.signal();
+        });
+    }
+
+    allFinished.wait();
+}
+
 int ThreadPool::getNumJobs() const noexcept
 {
     return jobs.size();
@@ -315,6 +315,20 @@ public:
     */
     bool setThreadPriorities (int newPriority);
 
+    //==============================================================================
+    /** Calls a function once for each index from 0 to numItems - 1, using a temporary
+        pool of threads, and waits until all the calls have returned.
+
+        Each index gets a job of its own, so the function can be called for several
+        different indexes at once, but is only called once for each of them.
+
+        @param numItems         the number of times to call the function
+        @param maxNumThreads    the maximum number of threads to use, or 0 to use one
+                                thread per CPU core
+        @param processItem      the function to call, which is given the index of an item
+    */
+    static void runInParallel (int numItems, int maxNumThreads, std::function<void (int)> processItem);
+
 
 private:
     //==============================================================================
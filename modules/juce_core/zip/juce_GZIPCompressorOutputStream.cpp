@@ -113,14 +113,256 @@ private:
 };
 
 //==============================================================================
-GZIPCompressorOutputStream::GZIPCompressorOutputStream (OutputStream& s, int compressionLevel, int windowBits)
-   : GZIPCompressorOutputStream (&s, compressionLevel, false, windowBits)
+/*  Compresses fixed-size blocks on a thread pool, pigz-style. Each block is deflated as
+    raw data with the tail of the previous block as its dictionary, and ends with a sync
+    flush so that the blocks can simply be concatenated. The zlib or gzip wrapper and the
+    combined checksum are added around them here.
+*/
+class GZIPCompressorOutputStream::ParallelCompressorHelper
+{
+public:
+    ParallelCompressorHelper (int level, int bits, int numThreads, int blockSizeBytes)
+        : compLevel ((level < 0 || level > 9) ? -1 : level),
+          blockSize ((size_t) jmax (blockSizeBytes, 1024)),
+          maxBlocksInFlight (2 * numThreads),
+          pool (numThreads)
+    {
+        if (bits == 0)                { format = zlibFormat; windowSizeBits = 15; }
+        else if (bits < 0)            { format = rawFormat;  windowSizeBits = -bits; }
+        else if (bits > 15)           { format = gzipFormat; windowSizeBits = bits - 16; }
+        else                          { format = zlibFormat; windowSizeBits = bits; }
+
+        windowSizeBits = jlimit (9, 15, windowSizeBits);
+        checksum = (format == gzipFormat) ? zlibNamespace::crc32 (0, nullptr, 0)
+                                          : zlibNamespace::adler32 (0, nullptr, 0);
+    }
+
+    ~ParallelCompressorHelper()
+    {
+        pool.removeAllJobs (true, -1);
+    }
+
+    bool write (const uint8* data, size_t dataSize, OutputStream& out)
+    {
+        // When you call flush() on a gzip stream, the stream is closed, and you can
+        // no longer continue to write data to it!
+        jassert (! finished);
+
+        while (dataSize > 0)
+        {
+            if (currentBlock == nullptr)
+                currentBlock.reset (new Block (blockSize));
+
+            auto numToCopy = jmin (dataSize, blockSize - currentBlock->inputSize);
+            memcpy (addBytesToPointer (currentBlock->input.getData(), currentBlock->inputSize), data, numToCopy);
+            currentBlock->inputSize += numToCopy;
+            data += numToCopy;
+            dataSize -= numToCopy;
+
+            if (currentBlock->inputSize == blockSize && ! startNextBlock (false, out))
+                return false;
+        }
+
+        return true;
+    }
+
+    void finish (OutputStream& out)
+    {
+        if (finished)
+            return;
+
+        finished = true;
+
+        if (currentBlock == nullptr)
+            currentBlock.reset (new Block (0));
+
+        if (startNextBlock (true, out) && writeCompletedBlocks (out, true))
+            writeTrailer (out);
+    }
+
+private:
+    enum Format { rawFormat, zlibFormat, gzipFormat };
+
+    struct Block
+    {
+        Block (size_t size)  : input (jmax ((size_t) 1, size)) {}
+
+        MemoryBlock input, dictionary, output;
+        size_t inputSize = 0, outputSize = 0;
+        zlibNamespace::uLong checksum = 0;
+        bool isLastBlock = false, succeeded = false;
+        WaitableEvent finished { true };
+    };
+
+    const int compLevel;
+    Format format;
+    int windowSizeBits;
+    const size_t blockSize;
+    const int maxBlocksInFlight;
+    std::unique_ptr<Block> currentBlock;
+    OwnedArray<Block> blocksInFlight;
+    MemoryBlock previousInputTail;
+    zlibNamespace::uLong checksum;
+    uint64 totalInputSize = 0;
+    bool headerWritten = false, finished = false, failed = false;
+    ThreadPool pool;
+
+    bool startNextBlock (bool isLastBlock, OutputStream& out)
+    {
+        auto* block = currentBlock.release();
+        block->isLastBlock = isLastBlock;
+        block->dictionary = previousInputTail;
+
+        auto tailSize = jmin (block->inputSize, (size_t) 1 << windowSizeBits);
+        previousInputTail.replaceWith (addBytesToPointer (block->input.getData(), block->inputSize - tailSize), tailSize);
+
+        blocksInFlight.add (block);
+
+        pool.addJob ([this, block]
+        {
+            block->succeeded = compressBlock (*block);
+            block->finished.signal();
+        });
+
+        return writeCompletedBlocks (out, false);
+    }
+
+    bool compressBlock (Block& block) const
+    {
+        using namespace zlibNamespace;
+
+        auto* input = static_cast<Bytef*> (block.input.getData());
+
+        block.checksum = (format == gzipFormat) ? crc32 (crc32 (0, nullptr, 0), input, (z_uInt) block.inputSize)
+                                                : adler32 (adler32 (0, nullptr, 0), input, (z_uInt) block.inputSize);
+
+        z_stream stream;
+        zerostruct (stream);
+
+        if (deflateInit2 (&stream, compLevel, Z_DEFLATED, -windowSizeBits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            return false;
+
+        if (block.dictionary.getSize() > 0)
+            deflateSetDictionary (&stream, static_cast<const Bytef*> (block.dictionary.getData()),
+                                  (z_uInt) block.dictionary.getSize());
+
+        // (a sync flush adds a few bytes on top of the usual worst-case size)
+        block.output.setSize (deflateBound (&stream, (uLong) block.inputSize) + 64);
+
+        stream.next_in  = input;
+        stream.avail_in = (z_uInt) block.inputSize;
+
+        auto flushMode = block.isLastBlock ? Z_FINISH : Z_SYNC_FLUSH;
+        bool ok = true;
+
+        for (;;)
+        {
+            if (block.outputSize == block.output.getSize())
+                block.output.setSize (block.output.getSize() * 2);
+
+            stream.next_out  = static_cast<Bytef*> (block.output.getData()) + block.outputSize;
+            stream.avail_out = (z_uInt) (block.output.getSize() - block.outputSize);
+
+            auto result = deflate (&stream, flushMode);
+            block.outputSize = block.output.getSize() - stream.avail_out;
+
+            if (result == Z_STREAM_END)
+                break;
+
+            if (result != Z_OK && result != Z_BUF_ERROR)
+            {
+                ok = false;
+                break;
+            }
+
+            if (! block.isLastBlock && stream.avail_in == 0 && stream.avail_out > 0)
+                break;
+        }
+
+        deflateEnd (&stream);
+        block.input.reset();
+        block.dictionary.reset();
+        return ok;
+    }
+
+    bool writeCompletedBlocks (OutputStream& out, bool waitForAllBlocks)
+    {
+        using namespace zlibNamespace;
+
+        while (! blocksInFlight.isEmpty())
+        {
+            auto* block = blocksInFlight.getFirst();
+
+            if (waitForAllBlocks || blocksInFlight.size() > maxBlocksInFlight)
+                block->finished.wait();
+            else if (! block->finished.wait (0))
+                break;
+
+            failed = failed || ! block->succeeded || ! (writeHeader (out) && out.write (block->output.getData(), block->outputSize));
+
+            checksum = (format == gzipFormat) ? crc32_combine   (checksum, block->checksum, (z_off_t) block->inputSize)
+                                              : adler32_combine (checksum, block->checksum, (z_off_t) block->inputSize);
+            totalInputSize += block->inputSize;
+
+            blocksInFlight.remove (0);
+        }
+
+        return ! failed;
+    }
+
+    bool writeHeader (OutputStream& out)
+    {
+        if (headerWritten)
+            return true;
+
+        headerWritten = true;
+
+        if (format == gzipFormat)
+        {
+            const uint8 header[] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff };
+            return out.write (header, sizeof (header));
+        }
+
+        if (format == zlibFormat)
+        {
+            auto level = compLevel < 0 ? 6 : compLevel;
+            auto levelFlags = level < 2 ? 0 : (level < 6 ? 1 : (level == 6 ? 2 : 3));
+            auto header = (((windowSizeBits - 8) << 4 | 8) << 8) | (levelFlags << 6);
+            header += 31 - (header % 31);
+
+            return out.writeByte ((char) (header >> 8)) && out.writeByte ((char) header);
+        }
+
+        return true;
+    }
+
+    void writeTrailer (OutputStream& out)
+    {
+        if (format == gzipFormat)
+        {
+            out.writeInt ((int) checksum);
+            out.writeInt ((int) (uint32) totalInputSize);
+        }
+        else if (format == zlibFormat)
+        {
+            out.writeIntBigEndian ((int) checksum);
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (ParallelCompressorHelper)
+};
+
+//==============================================================================
+GZIPCompressorOutputStream::GZIPCompressorOutputStream (OutputStream& s, int level, int bits)
+   : GZIPCompressorOutputStream (&s, level, false, bits)
 {
 }
 
-GZIPCompressorOutputStream::GZIPCompressorOutputStream (OutputStream* out, int compressionLevel, bool deleteDestStream, int windowBits)
+GZIPCompressorOutputStream::GZIPCompressorOutputStream (OutputStream* out, int level, bool deleteDestStream, int bits)
    : destStream (out, deleteDestStream),
-     helper (new GZIPCompressorHelper (compressionLevel, windowBits))
+     helper (new GZIPCompressorHelper (level, bits)),
+     compressionLevel (level),
+     windowBits (bits)
 {
     jassert (out != nullptr);
 }
@@ -130,9 +372,35 @@ GZIPCompressorOutputStream::~GZIPCompressorOutputStream()
     flush();
 }
 
+void GZIPCompressorOutputStream::setNumThreadsToUse (int numThreads, int blockSizeBytes)
+{
+    // This can only be changed before any data has been written!
+    jassert (! hasWrittenData);
+
+    if (hasWrittenData)
+        return;
+
+    if (numThreads > 1)
+    {
+        parallelHelper.reset (new ParallelCompressorHelper (compressionLevel, windowBits, numThreads, blockSizeBytes));
+        helper.reset();
+    }
+    else if (helper == nullptr)
+    {
+        parallelHelper.reset();
+        helper.reset (new GZIPCompressorHelper (compressionLevel, windowBits));
+    }
+}
+
 void GZIPCompressorOutputStream::flush()
 {
-    helper->finish (*destStream);
+    hasWrittenData = true;
+
+    if (parallelHelper != nullptr)
+        parallelHelper->finish (*destStream);
+    else
+        helper->finish (*destStream);
+
     destStream->flush();
 }
 
@@ -140,6 +408,11 @@ bool GZIPCompressorOutputStream::write (const void* destBuffer, size_t howMany)
 {
     jassert (destBuffer != nullptr && (ssize_t) howMany >= 0);
 
+    hasWrittenData = true;
+
+    if (parallelHelper != nullptr)
+        return parallelHelper->write (static_cast<const uint8*> (destBuffer), howMany, *destStream);
+
     return helper->write (static_cast<const uint8*> (destBuffer), howMany, *destStream);
 }
 
@@ -200,6 +473,52 @@ struct GZIPTests  : public UnitTest
                                 original.getData(),
                                 original.getDataSize()) == 0);
         }
+
+        beginTest ("Multithreaded GZIP");
+
+        struct FormatPair { int windowBits; GZIPDecompressorInputStream::Format format; };
+
+        for (auto formats : { FormatPair { 0, GZIPDecompressorInputStream::zlibFormat },
+                              FormatPair { GZIPCompressorOutputStream::windowBitsGZIP, GZIPDecompressorInputStream::gzipFormat },
+                              FormatPair { GZIPCompressorOutputStream::windowBitsRaw, GZIPDecompressorInputStream::deflateFormat } })
+        {
+            for (int i = 10; --i >= 0;)
+            {
+                MemoryOutputStream original, compressed, uncompressed;
+
+                {
+                    GZIPCompressorOutputStream zipper (compressed, rng.nextInt (10), formats.windowBits);
+                    zipper.setNumThreadsToUse (rng.nextInt (4) + 2, 1024 + rng.nextInt (5000));
+
+                    for (int j = rng.nextInt (100); --j >= 0;)
+                    {
+                        // use a small alphabet so that matches span the block boundaries
+                        MemoryBlock data ((unsigned int) (rng.nextInt (2000) + 1));
+
+                        for (int k = (int) data.getSize(); --k >= 0;)
+                            data[k] = (char) ('a' + rng.nextInt (4));
+
+                        original << data;
+                        zipper   << data;
+                    }
+                }
+
+                {
+                    MemoryInputStream compressedInput (compressed.getData(), compressed.getDataSize(), false);
+                    GZIPDecompressorInputStream unzipper (&compressedInput, false, formats.format);
+
+                    uncompressed << unzipper;
+                }
+
+                expectEquals ((int) uncompressed.getDataSize(),
+                              (int) original.getDataSize());
+
+                if (original.getDataSize() == uncompressed.getDataSize())
+                    expect (memcmp (uncompressed.getData(),
+                                    original.getData(),
+                                    original.getDataSize()) == 0);
+            }
+        }
     }
 };
 
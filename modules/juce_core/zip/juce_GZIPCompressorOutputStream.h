@@ -82,6 +82,19 @@ public:
     */
     void flush() override;
 
+    /** Makes the stream compress its data on a pool of background threads.
+
+        The incoming data is split into blocks of the given size, which are deflated
+        concurrently, each one using the end of the previous block as a preset dictionary.
+        The compressed blocks are then joined together with a combined checksum, so the
+        result is still a single stream that GZIPDecompressorInputStream (or any other
+        zlib-compatible decoder) can read. The output will be slightly larger than the
+        single-threaded version, as each block has to be flushed to a byte boundary.
+
+        This must be called before any data has been written to the stream.
+    */
+    void setNumThreadsToUse (int numThreads, int blockSizeBytes = 128 * 1024);
+
     int64 getPosition() override;
     bool setPosition (int64) override;
     bool write (const void*, size_t) override;
@@ -102,6 +115,12 @@ private:
     class GZIPCompressorHelper;
     std::unique_ptr<GZIPCompressorHelper> helper;
 
+    class ParallelCompressorHelper;
+    std::unique_ptr<ParallelCompressorHelper> parallelHelper;
+
+    const int compressionLevel, windowBits;
+    bool hasWrittenData = false;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GZIPCompressorOutputStream)
 };
 
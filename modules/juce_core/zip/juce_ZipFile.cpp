@@ -35,6 +35,12 @@ inline uint32 readUnalignedLittleEndianInt (const void* buffer)
     return ByteOrder::littleEndianInt (&data);
 }
 
+inline uint64 readUnalignedLittleEndianInt64 (const void* buffer)
+{
+    auto data = readUnaligned<uint64> (buffer);
+    return ByteOrder::littleEndianInt64 (&data);
+}
+
 struct ZipFile::ZipEntryHolder
 {
     ZipEntryHolder (const char* buffer, int fileNameLen)
@@ -51,6 +57,43 @@ struct ZipFile::ZipEntryHolder
 
         entry.isSymbolicLink = (fileType == 0xA);
         entry.filename = String::fromUTF8 (buffer + 46, fileNameLen);
+
+        readZip64ExtraField (buffer + 46 + fileNameLen, readUnalignedLittleEndianShort (buffer + 30));
+    }
+
+    void readZip64ExtraField (const char* extraField, int extraFieldLen) noexcept
+    {
+        while (extraFieldLen >= 4)
+        {
+            auto headerID  = readUnalignedLittleEndianShort (extraField);
+            auto fieldSize = (int) readUnalignedLittleEndianShort (extraField + 2);
+            extraField += 4;
+            extraFieldLen -= 4;
+
+            if (fieldSize > extraFieldLen)
+                return;
+
+            if (headerID == 0x0001)
+            {
+                // The Zip64 field only contains the values that didn't fit into the standard header
+                auto* data = extraField;
+                auto* dataEnd = extraField + fieldSize;
+
+                for (auto* value : { &entry.uncompressedSize, &compressedSize, &streamOffset })
+                {
+                    if (*value == 0xffffffff && data + 8 <= dataEnd)
+                    {
+                        *value = (int64) readUnalignedLittleEndianInt64 (data);
+                        data += 8;
+                    }
+                }
+
+                return;
+            }
+
+            extraField += fieldSize;
+            extraFieldLen -= fieldSize;
+        }
     }
 
     static Time parseFileTime (uint32 time, uint32 date) noexcept
@@ -93,11 +136,33 @@ static int64 findCentralDirectoryFileHeader (InputStream& input, int& numEntries
         {
             if (readUnalignedLittleEndianInt (buffer + i) == 0x06054b50)
             {
-                in.setPosition (pos + i);
+                auto endOfDirectoryPos = pos + i;
+                in.setPosition (endOfDirectoryPos);
                 in.read (buffer, 22);
                 numEntries = readUnalignedLittleEndianShort (buffer + 10);
                 auto offset = (int64) readUnalignedLittleEndianInt (buffer + 16);
 
+                if ((numEntries == 0xffff || offset == 0xffffffff) && endOfDirectoryPos >= 20)
+                {
+                    // Look for a Zip64 end-of-central-directory locator, which immediately
+                    // precedes the standard end-of-directory record
+                    char zip64Buffer[56] = {};
+                    in.setPosition (endOfDirectoryPos - 20);
+
+                    if (in.read (zip64Buffer, 20) == 20
+                         && readUnalignedLittleEndianInt (zip64Buffer) == 0x07064b50)
+                    {
+                        in.setPosition ((int64) readUnalignedLittleEndianInt64 (zip64Buffer + 8));
+
+                        if (in.read (zip64Buffer, 56) == 56
+                             && readUnalignedLittleEndianInt (zip64Buffer) == 0x06064b50)
+                        {
+                            numEntries = (int) readUnalignedLittleEndianInt64 (zip64Buffer + 32);
+                            offset = (int64) readUnalignedLittleEndianInt64 (zip64Buffer + 48);
+                        }
+                    }
+                }
+
                 if (offset >= 4)
                 {
                     in.setPosition (offset);
@@ -142,15 +207,14 @@ struct ZipFile::ZipInputStream  : public InputStream
            #endif
         }
 
-        char buffer[30];
-
-        if (inputStream != nullptr
-             && inputStream->setPosition (zei.streamOffset)
-             && inputStream->read (buffer, 30) == 30
-             && ByteOrder::littleEndianInt (buffer) == 0x04034b50)
+        if (inputStream == file.inputStream)
         {
-            headerSize = 30 + ByteOrder::littleEndianShort (buffer + 26)
-                            + ByteOrder::littleEndianShort (buffer + 28);
+            const ScopedLock sl (file.lock);
+            readLocalHeader();
+        }
+        else
+        {
+            readLocalHeader();
         }
     }
 
@@ -219,6 +283,20 @@ private:
     InputStream* inputStream;
     std::unique_ptr<InputStream> streamToDelete;
 
+    void readLocalHeader()
+    {
+        char buffer[30];
+
+        if (inputStream != nullptr
+             && inputStream->setPosition (zipEntryHolder.streamOffset)
+             && inputStream->read (buffer, 30) == 30
+             && ByteOrder::littleEndianInt (buffer) == 0x04034b50)
+        {
+            headerSize = 30 + ByteOrder::littleEndianShort (buffer + 26)
+                            + ByteOrder::littleEndianShort (buffer + 28);
+        }
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ZipInputStream)
 };
 
@@ -370,14 +448,14 @@ void ZipFile::init()
 
                     auto* buffer = static_cast<const char*> (headerData.getData()) + pos;
                     auto fileNameLen = readUnalignedLittleEndianShort (buffer + 28);
+                    auto extraFieldLen = readUnalignedLittleEndianShort (buffer + 30);
 
-                    if (pos + 46 + fileNameLen > size)
+                    if (pos + 46 + fileNameLen + extraFieldLen > size)
                         break;
 
                     entries.add (new ZipEntryHolder (buffer, fileNameLen));
 
-                    pos += 46 + fileNameLen
-                            + readUnalignedLittleEndianShort (buffer + 30)
+                    pos += 46 + fileNameLen + extraFieldLen
                             + readUnalignedLittleEndianShort (buffer + 32);
                 }
             }
@@ -385,29 +463,99 @@ void ZipFile::init()
     }
 }
 
+static String getEntryPathForTarget (const ZipFile::ZipEntry& entry)
+{
+   #if JUCE_WINDOWS
+    return entry.filename;
+   #else
+    return entry.filename.replaceCharacter ('\\', '/');
+   #endif
+}
+
 Result ZipFile::uncompressTo (const File& targetDirectory,
-                              const bool shouldOverwriteFiles)
+                              const bool shouldOverwriteFiles,
+                              const int numThreadsToUse)
 {
-    for (int i = 0; i < entries.size(); ++i)
+    auto numEntries = entries.size();
+
+    if (numThreadsToUse <= 1 || numEntries <= 1)
     {
-        auto result = uncompressEntry (i, targetDirectory, shouldOverwriteFiles);
+        for (int i = 0; i < numEntries; ++i)
+        {
+            auto result = uncompressEntry (i, targetDirectory, shouldOverwriteFiles);
+
+            if (result.failed())
+                return result;
+        }
 
-        if (result.failed())
-            return result;
+        return Result::ok();
     }
 
-    return Result::ok();
+    // Create all the folders up-front, so that the worker threads never race each other
+    // to create the same one..
+    File lastFolderCreated;
+
+    for (auto* zei : entries)
+    {
+        auto entryPath = getEntryPathForTarget (zei->entry);
+
+        if (entryPath.isEmpty())
+            continue;
+
+        auto targetFile = targetDirectory.getChildFile (entryPath);
+        auto folder = (entryPath.endsWithChar ('/') || entryPath.endsWithChar ('\\')) ? targetFile
+                                                                                     : targetFile.getParentDirectory();
+
+        if (folder != lastFolderCreated)
+        {
+            auto result = folder.createDirectory();
+
+            if (result.failed())
+                return result;
+
+            lastFolderCreated = folder;
+        }
+    }
+
+    CriticalSection resultLock;
+    auto overallResult = Result::ok();
+    int firstFailedIndex = numEntries;
+    std::atomic<int> numEntriesRemaining { numEntries };
+    WaitableEvent allEntriesDone;
+
+    ThreadPool pool (jmin (numThreadsToUse, numEntries));
+
+    for (int i = 0; i < numEntries; ++i)
+    {
+        pool.addJob ([&, i]
+        {
+            auto result = uncompressEntry (i, targetDirectory, shouldOverwriteFiles);
+
+            if (result.failed())
+            {
+                // report the same failure that a serial extraction would have hit first
+                const ScopedLock sl (resultLock);
+
+                if (i < firstFailedIndex)
+                {
+                    firstFailedIndex = i;
+                    overallResult = result;
+                }
+            }
+
+            if (--numEntriesRemaining == 0)
+                allEntriesDone.signal();
+        });
+    }
+
+    allEntriesDone.wait();
+    return overallResult;
 }
 
 Result ZipFile::uncompressEntry (int index, const File& targetDirectory, bool shouldOverwriteFiles)
 {
     auto* zei = entries.getUnchecked (index);
-
-   #if JUCE_WINDOWS
-    auto entryPath = zei->entry.filename;
-   #else
-    auto entryPath = zei->entry.filename.replaceCharacter ('\\', '/');
-   #endif
+    auto entryPath = getEntryPathForTarget (zei->entry);
 
     if (entryPath.isEmpty())
         return Result::ok();
@@ -469,9 +617,12 @@ struct ZipFile::Builder::Item
         symbolicLink = (file.exists() && file.isSymbolicLink());
     }
 
-    bool writeData (OutputStream& target, const int64 overallStartPosition)
+    /** Reads and compresses the item into a temporary buffer. This doesn't touch the
+        target stream, so can be called for several items concurrently.
+    */
+    bool compressData()
     {
-        MemoryOutputStream compressedData ((size_t) file.getSize());
+        MemoryOutputStream out (compressedData, false);
 
         if (symbolicLink)
         {
@@ -480,43 +631,51 @@ struct ZipFile::Builder::Item
             uncompressedSize = relativePath.length();
 
             checksum = zlibNamespace::crc32 (0, (uint8_t*) relativePath.toRawUTF8(), (unsigned int) uncompressedSize);
-            compressedData << relativePath;
+            out << relativePath;
         }
         else if (compressionLevel > 0)
         {
-            GZIPCompressorOutputStream compressor (compressedData, compressionLevel,
+            GZIPCompressorOutputStream compressor (out, compressionLevel,
                                                    GZIPCompressorOutputStream::windowBitsRaw);
             if (! writeSource (compressor))
                 return false;
         }
         else
         {
-            if (! writeSource (compressedData))
+            if (! writeSource (out))
                 return false;
         }
 
-        compressedSize = (int64) compressedData.getDataSize();
+        compressedSize = (int64) out.getDataSize();
+        return true;
+    }
+
+    bool writeData (OutputStream& target, const int64 overallStartPosition)
+    {
         headerStart = target.getPosition() - overallStartPosition;
 
         target.writeInt (0x04034b50);
-        writeFlagsAndSizes (target);
-        target << storedPathname
-               << compressedData;
+        writeFlagsAndSizes (target, false);
+        target << storedPathname;
+        writeZip64ExtraField (target, false);
 
-        return true;
+        auto ok = target.write (compressedData.getData(), compressedData.getSize());
+        compressedData.reset();
+        return ok;
     }
 
     bool writeDirectoryEntry (OutputStream& target)
     {
         target.writeInt (0x02014b50);
         target.writeShort (symbolicLink ? 0x0314 : 0x0014);
-        writeFlagsAndSizes (target);
+        writeFlagsAndSizes (target, true);
         target.writeShort (0); // comment length
         target.writeShort (0); // start disk num
         target.writeShort (0); // internal attributes
         target.writeInt ((int) (symbolicLink ? 0xA1ED0000 : 0)); // external attributes
-        target.writeInt ((int) (uint32) headerStart);
+        target.writeInt ((int) (uint32) (needsZip64Offset() ? 0xffffffff : headerStart));
         target << storedPathname;
+        writeZip64ExtraField (target, true);
 
         return true;
     }
@@ -526,6 +685,7 @@ private:
     std::unique_ptr<InputStream> stream;
     String storedPathname;
     Time fileTime;
+    MemoryBlock compressedData;
     int64 compressedSize = 0, uncompressedSize = 0, headerStart = 0;
     int compressionLevel = 0;
     unsigned long checksum = 0;
@@ -568,17 +728,48 @@ private:
         return true;
     }
 
-    void writeFlagsAndSizes (OutputStream& target) const
+    bool needsZip64Sizes() const noexcept     { return compressedSize >= 0xffffffff || uncompressedSize >= 0xffffffff; }
+    bool needsZip64Offset() const noexcept    { return headerStart >= 0xffffffff; }
+
+    int getZip64ExtraFieldSize (bool isDirectoryEntry) const noexcept
+    {
+        auto size = (needsZip64Sizes() ? 16 : 0) + ((isDirectoryEntry && needsZip64Offset()) ? 8 : 0);
+        return size > 0 ? size + 4 : 0;
+    }
+
+    void writeFlagsAndSizes (OutputStream& target, bool isDirectoryEntry) const
     {
-        target.writeShort (10); // version needed
+        auto zip64Sizes = needsZip64Sizes();
+
+        target.writeShort (getZip64ExtraFieldSize (isDirectoryEntry) > 0 ? 45 : 10); // version needed
         target.writeShort ((short) (1 << 11)); // this flag indicates UTF-8 filename encoding
         target.writeShort ((! symbolicLink && compressionLevel > 0) ? (short) 8 : (short) 0); //symlink target path is not compressed
         writeTimeAndDate (target, fileTime);
         target.writeInt ((int) checksum);
-        target.writeInt ((int) (uint32) compressedSize);
-        target.writeInt ((int) (uint32) uncompressedSize);
+        target.writeInt ((int) (uint32) (zip64Sizes ? 0xffffffff : compressedSize));
+        target.writeInt ((int) (uint32) (zip64Sizes ? 0xffffffff : uncompressedSize));
         target.writeShort ((short) storedPathname.toUTF8().sizeInBytes() - 1);
-        target.writeShort (0); // extra field length
+        target.writeShort ((short) getZip64ExtraFieldSize (isDirectoryEntry));
+    }
+
+    void writeZip64ExtraField (OutputStream& target, bool isDirectoryEntry) const
+    {
+        auto fieldSize = getZip64ExtraFieldSize (isDirectoryEntry);
+
+        if (fieldSize == 0)
+            return;
+
+        target.writeShort (0x0001);
+        target.writeShort ((short) (fieldSize - 4));
+
+        if (needsZip64Sizes())
+        {
+            target.writeInt64 (uncompressedSize);
+            target.writeInt64 (compressedSize);
+        }
+
+        if (isDirectoryEntry && needsZip64Offset())
+            target.writeInt64 (headerStart);
     }
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Item)
@@ -602,19 +793,68 @@ void ZipFile::Builder::addEntry (InputStream* stream, int compression, const Str
     items.add (new Item ({}, stream, compression, path, time));
 }
 
-bool ZipFile::Builder::writeToStream (OutputStream& target, double* const progress) const
+bool ZipFile::Builder::writeToStream (OutputStream& target, double* const progress, const int numThreadsToUse) const
 {
     auto fileStart = target.getPosition();
+    auto numItems = items.size();
+
+    Array<bool> compressionResults;
+    OwnedArray<WaitableEvent> compressionFinished;
+    std::unique_ptr<ThreadPool> pool;
+    int numItemsQueued = 0;
+
+    if (numThreadsToUse > 1 && numItems > 1)
+    {
+        compressionResults.insertMultiple (0, false, numItems);
+
+        for (int i = 0; i < numItems; ++i)
+            compressionFinished.add (new WaitableEvent (true));
+
+        pool.reset (new ThreadPool (jmin (numThreadsToUse, numItems)));
+    }
 
-    for (int i = 0; i < items.size(); ++i)
+    for (int i = 0; i < numItems; ++i)
     {
         if (progress != nullptr)
-            *progress = (i + 0.5) / items.size();
+            *progress = (i + 0.5) / numItems;
+
+        auto* item = items.getUnchecked (i);
+        bool compressedOK;
+
+        if (pool != nullptr)
+        {
+            // Keep a limited number of items in flight, as each one holds its compressed
+            // data in memory until it has been written to the target stream
+            for (auto maxQueued = jmin (numItems, i + 2 * pool->getNumThreads()); numItemsQueued < maxQueued; ++numItemsQueued)
+            {
+                auto index = numItemsQueued;
+
+                pool->addJob ([this, &compressionResults, &compressionFinished, index]
+                {
+                    compressionResults.getReference (index) = items.getUnchecked (index)->compressData();
+                    compressionFinished.getUnchecked (index)->signal();
+                });
+            }
+
+            compressionFinished.getUnchecked (i)->wait();
+            compressedOK = compressionResults.getUnchecked (i);
+        }
+        else
+        {
+            compressedOK = item->compressData();
+        }
+
+        if (! (compressedOK && item->writeData (target, fileStart)))
+        {
+            if (pool != nullptr)
+                pool->removeAllJobs (true, -1);
 
-        if (! items.getUnchecked (i)->writeData (target, fileStart))
             return false;
+        }
     }
 
+    pool.reset();
+
     auto directoryStart = target.getPosition();
 
     for (auto* item : items)
@@ -622,14 +862,35 @@ bool ZipFile::Builder::writeToStream (OutputStream& target, double* const progre
             return false;
 
     auto directoryEnd = target.getPosition();
+    auto directorySize = directoryEnd - directoryStart;
+    auto directoryOffset = directoryStart - fileStart;
+
+    if (numItems >= 0xffff || directorySize >= 0xffffffff || directoryOffset >= 0xffffffff)
+    {
+        target.writeInt (0x06064b50); // Zip64 end of central directory record
+        target.writeInt64 (44);
+        target.writeShort (45); // version made by
+        target.writeShort (45); // version needed
+        target.writeInt (0);
+        target.writeInt (0);
+        target.writeInt64 (numItems);
+        target.writeInt64 (numItems);
+        target.writeInt64 (directorySize);
+        target.writeInt64 (directoryOffset);
+
+        target.writeInt (0x07064b50); // Zip64 end of central directory locator
+        target.writeInt (0);
+        target.writeInt64 (directoryEnd - fileStart);
+        target.writeInt (1);
+    }
 
     target.writeInt (0x06054b50);
     target.writeShort (0);
     target.writeShort (0);
-    target.writeShort ((short) items.size());
-    target.writeShort ((short) items.size());
-    target.writeInt ((int) (directoryEnd - directoryStart));
-    target.writeInt ((int) (directoryStart - fileStart));
+    target.writeShort ((short) jmin (numItems, 0xffff));
+    target.writeShort ((short) jmin (numItems, 0xffff));
+    target.writeInt ((int) (uint32) jmin (directorySize, (int64) 0xffffffff));
+    target.writeInt ((int) (uint32) jmin (directoryOffset, (int64) 0xffffffff));
     target.writeShort (0);
 
     if (progress != nullptr)
@@ -645,37 +906,89 @@ struct ZIPTests   : public UnitTest
 {
     ZIPTests()   : UnitTest ("ZIP") {}
 
-    void runTest() override
+    static MemoryBlock createZipMemoryBlock (const StringArray& entryNames, int compressionLevel, int numThreads)
     {
-        beginTest ("ZIP");
-
         ZipFile::Builder builder;
-        StringArray entryNames { "first", "second", "third" };
-        HashMap<String, MemoryBlock> blocks;
 
         for (auto& entryName : entryNames)
-        {
-            auto& block = blocks.getReference (entryName);
-            MemoryOutputStream mo (block, false);
-            mo << entryName;
-            mo.flush();
-            builder.addEntry (new MemoryInputStream (block, false), 9, entryName, Time::getCurrentTime());
-        }
+            builder.addEntry (new MemoryInputStream (entryName.toRawUTF8(), entryName.getNumBytesAsUTF8(), true),
+                              compressionLevel, entryName, Time (2020, 0, 1, 12, 0));
 
         MemoryBlock data;
         MemoryOutputStream mo (data, false);
-        builder.writeToStream (mo, nullptr);
-        MemoryInputStream mi (data, false);
+        builder.writeToStream (mo, nullptr, numThreads);
 
-        ZipFile zip (mi);
+        return data;
+    }
 
+    void checkEntries (ZipFile& zip, const StringArray& entryNames)
+    {
         expectEquals (zip.getNumEntries(), entryNames.size());
 
         for (auto& entryName : entryNames)
         {
             auto* entry = zip.getEntry (entryName);
-            std::unique_ptr<InputStream> input (zip.createStreamForEntry (*entry));
-            expectEquals (input->readEntireStreamAsString(), entryName);
+            expect (entry != nullptr);
+
+            if (entry != nullptr)
+            {
+                std::unique_ptr<InputStream> input (zip.createStreamForEntry (*entry));
+                expectEquals (input->readEntireStreamAsString(), entryName);
+            }
+        }
+    }
+
+    void runTest() override
+    {
+        beginTest ("ZIP");
+        {
+            StringArray entryNames { "first", "second", "third" };
+            auto data = createZipMemoryBlock (entryNames, 9, 1);
+            MemoryInputStream mi (data, false);
+            ZipFile zip (mi);
+            checkEntries (zip, entryNames);
+        }
+
+        beginTest ("Multithreaded ZIP");
+        {
+            StringArray entryNames;
+
+            for (int i = 0; i < 200; ++i)
+                entryNames.add ("folder" + String (i % 7) + "/entry" + String (i) + String::repeatedString ("abc", i % 30));
+
+            auto data = createZipMemoryBlock (entryNames, 6, 4);
+            expect (data == createZipMemoryBlock (entryNames, 6, 1));
+
+            MemoryInputStream mi (data, false);
+            ZipFile zip (mi);
+            checkEntries (zip, entryNames);
+
+            auto targetDirectory = File::createTempFile ("zip_test");
+            expect (zip.uncompressTo (targetDirectory, true, 4).wasOk());
+
+            for (auto& entryName : entryNames)
+                expectEquals (targetDirectory.getChildFile (entryName).loadFileAsString(), entryName);
+
+            targetDirectory.deleteRecursively();
+        }
+
+        beginTest ("Zip64 directory");
+        {
+            StringArray entryNames;
+
+            for (int i = 0; i < 0x10010; ++i)
+                entryNames.add (String (i));
+
+            auto data = createZipMemoryBlock (entryNames, 0, 1);
+            MemoryInputStream mi (data, false);
+            ZipFile zip (mi);
+            expectEquals (zip.getNumEntries(), entryNames.size());
+
+            for (auto index : { 0, 0xffff, 0x1000f })
+            {
+                std::unique_ptr<InputStream> input (zip.createStreamForEntry (index));
+                expectEquals (input->readEntireStreamAsString(), String (index));
+            }
         }
     }
 };
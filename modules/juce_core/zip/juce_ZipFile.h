@@ -151,12 +151,18 @@ public:
         This will expand all the entries into a target directory. The relative
         paths of the entries are used.
 
+        If numThreadsToUse is greater than 1, the entries will be decompressed concurrently
+        on a temporary thread pool. This is only worthwhile if the ZipFile was created from
+        a File or InputSource, so that each entry can be read through its own stream.
+
         @param targetDirectory      the root folder to uncompress to
         @param shouldOverwriteFiles whether to overwrite existing files with similarly-named ones
+        @param numThreadsToUse      the number of threads that should be used to extract the entries
         @returns success if the file is successfully unzipped
     */
     Result uncompressTo (const File& targetDirectory,
-                         bool shouldOverwriteFiles = true);
+                         bool shouldOverwriteFiles = true,
+                         int numThreadsToUse = 1);
 
     /** Uncompresses one of the entries from the zip file.
 
@@ -218,8 +224,15 @@ public:
         /** Generates the zip file, writing it to the specified stream.
             If the progress parameter is non-null, it will be updated with an approximate
             progress status between 0 and 1.0
+
+            If numThreadsToUse is greater than 1, the items will be compressed concurrently
+            into temporary memory buffers, which are then written to the target stream in the
+            order in which the items were added.
+
+            Archives which are larger than 4GB, or which contain more than 65535 items, will be
+            written using the Zip64 extensions.
         */
-        bool writeToStream (OutputStream& target, double* progress) const;
+        bool writeToStream (OutputStream& target, double* progress, int numThreadsToUse = 1) const;
 
         //==============================================================================
     private:
@@ -246,7 +259,7 @@ private:
         OpenStreamCounter() = default;
         ~OpenStreamCounter();
 
-        int numOpenStreams = 0;
+        std::atomic<int> numOpenStreams { 0 };
     };
 
     OpenStreamCounter streamCounter;
@@ -32,6 +32,452 @@ struct InterprocessConnection::ConnectionThread  : public Thread
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConnectionThread)
 };
 
+//==============================================================================
+#if JUCE_LINUX
+
+/*  A pair of single-producer/single-consumer byte rings living in a POSIX shared memory
+    segment, one for each direction.
+
+    Each ring's data area is mapped twice, back-to-back, so that any run of bytes up to the
+    ring's capacity is contiguous in memory - that's what allows a message to be handed to
+    the receiver in place. Readers and writers only make a futex call when the other side
+    is actually asleep, so a busy stream of messages gets batched up without any syscalls.
+*/
+struct InterprocessConnection::SharedMemoryChannel
+{
+    ~SharedMemoryChannel()
+    {
+        close();
+
+        for (auto& r : rings)
+            if (r.data != nullptr)
+                munmap (r.data, 2 * (size_t) capacity);
+
+        if (segment != nullptr)
+            munmap (segment, (size_t) getPageSize());
+
+        if (isCreator)
+            shm_unlink (segmentName.toRawUTF8());
+    }
+
+    /*  If replaceExisting is false, a segment that's still owned by a running process is left
+        alone and this fails, but one that was left behind by a process that has died is replaced.
+    */
+    static SharedMemoryChannel* create (const String& pipeName, int requestedSize, bool replaceExisting)
+    {
+        auto name = getSegmentName (pipeName);
+
+        if (replaceExisting || ! isSegmentInUse (name))
+            shm_unlink (name.toRawUTF8());
+
+        auto size = (uint32) getPageSize();
+
+        while (size < (uint32) jmin (requestedSize, 1 << 30))
+            size <<= 1;
+
+        auto fd = shm_open (name.toRawUTF8(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+        if (fd < 0)
+            return nullptr;
+
+        std::unique_ptr<SharedMemoryChannel> channel (new SharedMemoryChannel (name, true));
+
+        if (ftruncate (fd, (off_t) getTotalSize (size)) != 0 || ! channel->map (fd, size, 0))
+        {
+            ::close (fd);
+            return nullptr;
+        }
+
+        ::close (fd);
+        channel->segment->capacity = size;
+        channel->segment->creatorProcessId = (int32) getpid();
+        channel->segment->magic.store (segmentMagic);
+        return channel.release();
+    }
+
+    static SharedMemoryChannel* open (const String& pipeName)
+    {
+        auto name = getSegmentName (pipeName);
+        auto fd = shm_open (name.toRawUTF8(), O_RDWR, 0);
+
+        if (fd < 0)
+            return nullptr;
+
+        std::unique_ptr<SharedMemoryChannel> channel (new SharedMemoryChannel (name, false));
+        struct stat info;
+
+        if (fstat (fd, &info) != 0 || info.st_size < getPageSize()
+             || ! channel->mapSegmentHeader (fd))
+        {
+            ::close (fd);
+            return nullptr;
+        }
+
+        auto* header = channel->segment;
+        auto size = header->capacity;
+        int32 noConnection = 0;
+
+        // a segment only serves one client, so refuse it if someone has already claimed it,
+        // or if the process that created it has gone away without removing it
+        if (header->magic.load() != segmentMagic
+             || (int64) info.st_size != (int64) getTotalSize (size)
+             || header->closed.load() != 0
+             || ! isProcessRunning (header->creatorProcessId)
+             || ! header->numConnections.compare_exchange_strong (noConnection, 1)
+             || ! channel->map (fd, size, 1))
+        {
+            ::close (fd);
+            return nullptr;
+        }
+
+        ::close (fd);
+        return channel.release();
+    }
+
+    static void removeSegment (const String& pipeName)
+    {
+        shm_unlink (getSegmentName (pipeName).toRawUTF8());
+    }
+
+    //==============================================================================
+    int write (const void* sourceData, int numBytes, int timeoutMs)
+    {
+        auto& ring = rings[0];
+        auto& header = *ring.header;
+        auto* source = static_cast<const char*> (sourceData);
+        int numWritten = 0;
+
+        while (numWritten < numBytes)
+        {
+            auto writePos = header.writePos.load (std::memory_order_relaxed);
+            auto freeSpace = getFreeSpace (header, writePos);
+
+            if (freeSpace == 0)
+            {
+                if (! waitUntil (header.spaceSequence, header.writerWaiting,
+                                 [&] { return getFreeSpace (header, writePos) > 0; },
+                                 timeoutMs, nullptr))
+                    break;
+
+                continue;
+            }
+
+            auto numThisTime = jmin ((uint32) (numBytes - numWritten), freeSpace);
+            memcpy (ring.data + (writePos & (capacity - 1)), source + numWritten, numThisTime);
+            header.writePos.store (writePos + numThisTime, std::memory_order_release);
+            numWritten += (int) numThisTime;
+
+            signal (header.dataSequence, header.readerWaiting);
+        }
+
+        return numWritten;
+    }
+
+    /*  Writes a message's header and data as a single unit. If the timeout runs out part-way
+        through, the reader would be left out of step with the stream, so the channel is closed.
+    */
+    bool writeMessage (const void* header, int headerSize, const void* data, int dataSize, int timeoutMs)
+    {
+        auto numWritten = write (header, headerSize, timeoutMs);
+
+        if (numWritten == headerSize)
+            numWritten += write (data, dataSize, timeoutMs);
+
+        if (numWritten == headerSize + dataSize)
+            return true;
+
+        if (numWritten > 0)
+            close();
+
+        return false;
+    }
+
+    /*  Blocks until numBytes are available to read, and returns a pointer to them, or nullptr
+        if the channel is closed or the thread is asked to stop. The data must be released
+        with advance() once it has been used.
+    */
+    const char* waitForData (int numBytes, Thread& thread)
+    {
+        jassert (isPositiveAndNotGreaterThan (numBytes, (int) capacity));
+
+        auto& ring = rings[1];
+        auto& header = *ring.header;
+        auto readPos = header.readPos.load (std::memory_order_relaxed);
+
+        if (! waitUntil (header.dataSequence, header.readerWaiting,
+                         [&] { return getNumReady (header, readPos) >= (uint32) numBytes; },
+                         -1, &thread))
+            return nullptr;
+
+        return ring.data + (readPos & (capacity - 1));
+    }
+
+    void advance (int numBytes)
+    {
+        auto& header = *rings[1].header;
+        header.readPos.store (header.readPos.load (std::memory_order_relaxed) + (uint32) numBytes,
+                              std::memory_order_release);
+        signal (header.spaceSequence, header.writerWaiting);
+    }
+
+    int read (void* destData, int numBytes, Thread& thread)
+    {
+        auto* dest = static_cast<char*> (destData);
+        int numRead = 0;
+
+        while (numRead < numBytes)
+        {
+            auto numThisTime = jmin (numBytes - numRead, (int) capacity);
+
+            if (auto* src = waitForData (numThisTime, thread))
+            {
+                memcpy (dest + numRead, src, (size_t) numThisTime);
+                advance (numThisTime);
+                numRead += numThisTime;
+            }
+            else
+            {
+                return -1;
+            }
+        }
+
+        return numRead;
+    }
+
+    int getCapacity() const noexcept    { return (int) capacity; }
+    bool isClosed() const noexcept      { return segment->closed.load() != 0; }
+
+    void close()
+    {
+        if (segment != nullptr && segment->closed.exchange (1) == 0)
+        {
+            for (auto& r : rings)
+            {
+                if (r.header != nullptr)
+                {
+                    ++(r.header->dataSequence);
+                    ++(r.header->spaceSequence);
+                    futexWake (r.header->dataSequence);
+                    futexWake (r.header->spaceSequence);
+                }
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    struct alignas (64) RingHeader
+    {
+        std::atomic<uint32> readPos, writePos;
+        std::atomic<int32> dataSequence, spaceSequence;   // used as futex words
+        std::atomic<int32> readerWaiting, writerWaiting;
+    };
+
+    struct SegmentHeader
+    {
+        std::atomic<uint32> magic;
+        uint32 capacity;
+        int32 creatorProcessId;
+        std::atomic<int32> numConnections, closed;
+        RingHeader rings[2];
+    };
+
+    struct Ring
+    {
+        RingHeader* header = nullptr;
+        char* data = nullptr;
+    };
+
+    enum { segmentMagic = 0x4a495044 };
+
+    SharedMemoryChannel (const String& name, bool creator)  : segmentName (name), isCreator (creator) {}
+
+    static String getSegmentName (const String& pipeName)
+    {
+        return "/juce_ipc_" + String::toHexString (pipeName.hashCode64());
+    }
+
+    static bool isProcessRunning (int32 processId)
+    {
+        return kill ((pid_t) processId, 0) == 0 || errno == EPERM;
+    }
+
+    static bool isSegmentInUse (const String& name)
+    {
+        auto fd = shm_open (name.toRawUTF8(), O_RDONLY, 0);
+
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        bool inUse = false;
+
+        if (fstat (fd, &info) == 0 && info.st_size >= getPageSize())
+        {
+            auto* m = mmap (nullptr, (size_t) getPageSize(), PROT_READ, MAP_SHARED, fd, 0);
+
+            if (m != MAP_FAILED)
+            {
+                auto* header = static_cast<const SegmentHeader*> (m);
+                inUse = header->magic.load() == segmentMagic && isProcessRunning (header->creatorProcessId);
+                munmap (m, (size_t) getPageSize());
+            }
+        }
+
+        ::close (fd);
+        return inUse;
+    }
+
+    static int getPageSize()                       { return (int) sysconf (_SC_PAGESIZE); }
+    static size_t getTotalSize (uint32 ringSize)   { return (size_t) getPageSize() + 2 * (size_t) ringSize; }
+
+    uint32 getFreeSpace (const RingHeader& h, uint32 writePos) const noexcept   { return capacity - (writePos - h.readPos.load (std::memory_order_acquire)); }
+    uint32 getNumReady (const RingHeader& h, uint32 readPos) const noexcept     { return h.writePos.load (std::memory_order_acquire) - readPos; }
+
+    bool mapSegmentHeader (int fd)
+    {
+        static_assert (sizeof (SegmentHeader) <= 4096, "The segment header must fit in one page");
+        static_assert (std::is_standard_layout<SegmentHeader>::value, "The segment header is shared between processes");
+
+        auto* m = mmap (nullptr, (size_t) getPageSize(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        if (m == MAP_FAILED)
+            return false;
+
+        segment = static_cast<SegmentHeader*> (m);
+        return true;
+    }
+
+    bool map (int fd, uint32 ringSize, int firstRingToWrite)
+    {
+        if (segment == nullptr && ! mapSegmentHeader (fd))
+            return false;
+
+        capacity = ringSize;
+
+        for (int i = 0; i < 2; ++i)
+        {
+            auto ringIndex = (firstRingToWrite + i) & 1;
+            auto& r = rings[i];
+            r.header = segment->rings + ringIndex;
+            r.data = mapMirrored (fd, (off_t) (getPageSize() + ringIndex * (int64) ringSize), ringSize);
+
+            if (r.data == nullptr)
+                return false;
+        }
+
+        return true;
+    }
+
+    static char* mapMirrored (int fd, off_t offset, uint32 size)
+    {
+        auto* base = mmap (nullptr, 2 * (size_t) size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (base == MAP_FAILED)
+            return nullptr;
+
+        auto* first  = mmap (base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, offset);
+        auto* second = mmap (static_cast<char*> (base) + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, offset);
+
+        if (first == MAP_FAILED || second == MAP_FAILED)
+        {
+            munmap (base, 2 * (size_t) size);
+            return nullptr;
+        }
+
+        return static_cast<char*> (base);
+    }
+
+    //==============================================================================
+    static void futexWait (std::atomic<int32>& word, int32 expectedValue, int timeoutMs)
+    {
+        struct timespec timeout;
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_nsec = (timeoutMs % 1000) * 1000000;
+
+        syscall (SYS_futex, reinterpret_cast<int32*> (&word), FUTEX_WAIT, expectedValue, &timeout, nullptr, 0);
+    }
+
+    static void futexWake (std::atomic<int32>& word)
+    {
+        syscall (SYS_futex, reinterpret_cast<int32*> (&word), FUTEX_WAKE, std::numeric_limits<int>::max(), nullptr, nullptr, 0);
+    }
+
+    static void signal (std::atomic<int32>& sequence, std::atomic<int32>& waitingFlag)
+    {
+        ++sequence;
+
+        if (waitingFlag.load() != 0)
+            futexWake (sequence);
+    }
+
+    template <typename Condition>
+    bool waitUntil (std::atomic<int32>& sequence, std::atomic<int32>& waitingFlag,
+                    Condition condition, int timeoutMs, Thread* threadToCheck)
+    {
+        auto endTime = Time::getMillisecondCounter() + (uint32) timeoutMs;
+
+        for (;;)
+        {
+            if (condition())
+                return true;
+
+            if (isClosed() || (threadToCheck != nullptr && threadToCheck->threadShouldExit()))
+                return false;
+
+            auto waitMs = 100;
+
+            if (timeoutMs >= 0)
+            {
+                auto remaining = (int) (endTime - Time::getMillisecondCounter());
+
+                if (remaining <= 0)
+                    return false;
+
+                waitMs = jmin (waitMs, remaining);
+            }
+
+            waitingFlag.store (1);
+            auto expectedSequence = sequence.load();
+
+            if (! condition() && ! isClosed())
+                futexWait (sequence, expectedSequence, waitMs);
+
+            waitingFlag.store (0);
+        }
+    }
+
+    //==============================================================================
+    SegmentHeader* segment = nullptr;
+    Ring rings[2];   // [0] is the one we write to, [1] is the one we read from
+    uint32 capacity = 0;
+    const String segmentName;
+    const bool isCreator;
+
+    JUCE_DECLARE_NON_COPYABLE (SharedMemoryChannel)
+};
+
+#else
+
+// Shared memory channels aren't implemented on this platform, so pipes are always used directly
+struct InterprocessConnection::SharedMemoryChannel
+{
+    static SharedMemoryChannel* create (const String&, int, bool)   { return nullptr; }
+    static SharedMemoryChannel* open (const String&)                { return nullptr; }
+    static void removeSegment (const String&)                       {}
+
+    int write (const void*, int, int)                               { return -1; }
+    bool writeMessage (const void*, int, const void*, int, int)     { return false; }
+    const char* waitForData (int, Thread&)                          { return nullptr; }
+    void advance (int)                                              {}
+    int read (void*, int, Thread&)                                  { return -1; }
+    int getCapacity() const noexcept                                { return 0; }
+    bool isClosed() const noexcept                                  { return true; }
+    void close()                                                    {}
+};
+
+#endif
+
 //==============================================================================
 InterprocessConnection::InterprocessConnection (bool callbacksOnMessageThread, uint32 magicMessageHeaderNumber)
     : useMessageThread (callbacksOnMessageThread),
@@ -79,6 +525,12 @@ bool InterprocessConnection::connectToPipe (const String& pipeName, int timeoutM
     {
         const ScopedLock sl (pipeAndSocketLock);
         pipeReceiveMessageTimeout = timeoutMs;
+
+        {
+            const ScopedLock sml (sharedMemoryLock);
+            sharedMemory.reset (SharedMemoryChannel::open (pipeName));
+        }
+
         initialiseWithPipe (newPipe.release());
         return true;
     }
@@ -86,16 +538,33 @@ bool InterprocessConnection::connectToPipe (const String& pipeName, int timeoutM
     return false;
 }
 
-bool InterprocessConnection::createPipe (const String& pipeName, int timeoutMs, bool mustNotExist)
+bool InterprocessConnection::createPipe (const String& pipeName, int timeoutMs,
+                                         bool mustNotExist, int sharedMemoryBufferSize)
 {
     disconnect();
 
+    // The segment has to be in place (or gone) before the pipe appears, otherwise a client that
+    // connected in between would end up using the pipe while this end was using shared memory.
+    // If the pipe can't be created, deleting the new channel removes its segment again.
+    std::unique_ptr<SharedMemoryChannel> newChannel;
+
+    if (sharedMemoryBufferSize > 0)
+        newChannel.reset (SharedMemoryChannel::create (pipeName, sharedMemoryBufferSize, ! mustNotExist));
+    else if (! mustNotExist)
+        SharedMemoryChannel::removeSegment (pipeName);
+
     std::unique_ptr<NamedPipe> newPipe (new NamedPipe());
 
     if (newPipe->createNewPipe (pipeName, mustNotExist))
     {
         const ScopedLock sl (pipeAndSocketLock);
         pipeReceiveMessageTimeout = timeoutMs;
+
+        {
+            const ScopedLock sml (sharedMemoryLock);
+            sharedMemory = std::move (newChannel);
+        }
+
         initialiseWithPipe (newPipe.release());
         return true;
     }
@@ -107,6 +576,14 @@ void InterprocessConnection::disconnect()
 {
     thread->signalThreadShouldExit();
 
+    // this is done without pipeAndSocketLock, as it needs to wake up a writer which may be holding it
+    {
+        const ScopedLock sml (sharedMemoryLock);
+
+        if (sharedMemory != nullptr)
+            sharedMemory->close();
+    }
+
     {
         const ScopedLock sl (pipeAndSocketLock);
         if (socket != nullptr)  socket->close();
@@ -123,6 +600,9 @@ void InterprocessConnection::deletePipeAndSocket()
     const ScopedLock sl (pipeAndSocketLock);
     socket.reset();
     pipe.reset();
+
+    const ScopedLock sml (sharedMemoryLock);
+    sharedMemory.reset();
 }
 
 bool InterprocessConnection::isConnected() const
@@ -131,9 +611,16 @@ bool InterprocessConnection::isConnected() const
 
     return ((socket != nullptr && socket->isConnected())
               || (pipe != nullptr && pipe->isOpen()))
+            && (sharedMemory == nullptr || ! sharedMemory->isClosed())
             && threadIsRunning;
 }
 
+bool InterprocessConnection::isUsingSharedMemory() const
+{
+    const ScopedLock sl (pipeAndSocketLock);
+    return sharedMemory != nullptr;
+}
+
 String InterprocessConnection::getConnectedHostName() const
 {
     {
@@ -155,6 +642,16 @@ bool InterprocessConnection::sendMessage (const MemoryBlock& message)
     uint32 messageHeader[2] = { ByteOrder::swapIfBigEndian (magicMessageHeader),
                                 ByteOrder::swapIfBigEndian ((uint32) message.getSize()) };
 
+    {
+        const ScopedLock sl (pipeAndSocketLock);
+
+        // the shared memory rings can take the header and data separately, so there's no need to join them up
+        if (sharedMemory != nullptr)
+            return sharedMemory->writeMessage (messageHeader, (int) sizeof (messageHeader),
+                                               message.getData(), (int) message.getSize(),
+                                               pipeReceiveMessageTimeout);
+    }
+
     MemoryBlock messageData (sizeof (messageHeader) + message.getSize());
     messageData.copyFrom (messageHeader, 0, sizeof (messageHeader));
     messageData.copyFrom (message.getData(), sizeof (messageHeader), message.getSize());
@@ -170,7 +667,15 @@ int InterprocessConnection::writeData (void* data, int dataSize)
         return socket->write (data, dataSize);
 
     if (pipe != nullptr)
-        return pipe->write (data, dataSize, pipeReceiveMessageTimeout);
+    {
+        auto numWritten = pipe->write (data, dataSize, pipeReceiveMessageTimeout);
+
+        // a message that was cut short would leave the other end out of step, so the pipe can't be used again
+        if (numWritten > 0 && numWritten < dataSize)
+            pipe->close();
+
+        return numWritten;
+    }
 
     return 0;
 }
@@ -246,30 +751,67 @@ void InterprocessConnection::connectionLostInt()
     }
 }
 
-struct DataDeliveryMessage  : public Message
+struct InterprocessConnection::DataDeliveryMessage  : public Message
 {
-    DataDeliveryMessage (InterprocessConnection* ipc, const MemoryBlock& d)
-        : owner (ipc), data (d)
-    {}
+    DataDeliveryMessage (InterprocessConnection* ipc)  : owner (ipc) {}
 
     void messageCallback() override
     {
         if (auto* ipc = owner.get())
-            ipc->messageReceived (data);
+            ipc->deliverPendingMessages();
     }
 
     WeakReference<InterprocessConnection> owner;
-    MemoryBlock data;
 };
 
-void InterprocessConnection::deliverDataInt (const MemoryBlock& data)
+void InterprocessConnection::deliverDataInt (MemoryBlock& data)
 {
     jassert (callbackConnectionState);
 
     if (useMessageThread)
-        (new DataDeliveryMessage (this, data))->post();
+    {
+        bool needsPosting;
+
+        // Messages that arrive while a delivery is still pending get batched up and
+        // handled by that same callback, rather than each one posting its own.
+        {
+            const ScopedLock sl (pendingMessagesLock);
+            needsPosting = pendingMessages.isEmpty();
+            pendingMessages.add (std::move (data));
+        }
+
+        if (needsPosting)
+            (new DataDeliveryMessage (this))->post();
+    }
     else
+    {
         messageReceived (data);
+    }
+}
+
+void InterprocessConnection::deliverPendingMessages()
+{
+    Array<MemoryBlock> messages;
+
+    {
+        const ScopedLock sl (pendingMessagesLock);
+        messages.swapWith (pendingMessages);
+    }
+
+    WeakReference<InterprocessConnection> safeThis (this);
+
+    for (auto& m : messages)
+    {
+        messageReceived (m);
+
+        if (safeThis == nullptr)
+            return;
+    }
+}
+
+void InterprocessConnection::messageReceivedInPlace (const void* data, size_t numBytes)
+{
+    messageReceived (MemoryBlock (data, numBytes));
 }
 
 //==============================================================================
@@ -278,6 +820,9 @@ int InterprocessConnection::readData (void* data, int num)
     if (socket != nullptr)
         return socket->read (data, num, true);
 
+    if (sharedMemory != nullptr)
+        return sharedMemory->read (data, num, *thread);
+
     if (pipe != nullptr)
         return pipe->read (data, num, pipeReceiveMessageTimeout);
 
@@ -297,6 +842,22 @@ bool InterprocessConnection::readNextMessage()
 
         if (bytesInMessage > 0)
         {
+            if (sharedMemory != nullptr && ! useMessageThread
+                 && bytesInMessage <= sharedMemory->getCapacity())
+            {
+                if (auto* data = sharedMemory->waitForData (bytesInMessage, *thread))
+                {
+                    messageReceivedInPlace (data, (size_t) bytesInMessage);
+                    sharedMemory->advance (bytesInMessage);
+                    return true;
+                }
+
+                if (sharedMemory->isClosed())
+                    connectionLostInt();
+
+                return false;
+            }
+
             MemoryBlock messageData ((size_t) bytesInMessage, true);
             int bytesRead = 0;
 
@@ -362,6 +923,12 @@ void InterprocessConnection::runThread()
                 connectionLostInt();
                 break;
             }
+
+            if (sharedMemory != nullptr && sharedMemory->isClosed())
+            {
+                connectionLostInt();
+                break;
+            }
         }
         else
         {
@@ -375,4 +942,176 @@ void InterprocessConnection::runThread()
     threadIsRunning = false;
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class InterprocessConnectionTests  : public UnitTest
+{
+public:
+    InterprocessConnectionTests()
+        : UnitTest ("InterprocessConnection", "Networking")
+    {}
+
+    void runTest() override
+    {
+        for (auto sharedMemorySize : { 0, 65536 })
+        {
+           #if JUCE_LINUX
+            const bool expectSharedMemory = sharedMemorySize > 0;
+           #else
+            const bool expectSharedMemory = false;
+           #endif
+
+            const String transport (expectSharedMemory ? "shared memory" : "pipe");
+            const auto pipeName = "juce_ipc_test_" + String::toHexString (getRandom().nextInt64());
+
+            beginTest ("Round trip using " + transport);
+            {
+                TestConnection server, client;
+                expect (server.createPipe (pipeName, -1, true, sharedMemorySize));
+                expect (client.connectToPipe (pipeName, -1));
+
+                expect (server.isUsingSharedMemory() == expectSharedMemory);
+                expect (client.isUsingSharedMemory() == expectSharedMemory);
+
+                // the last message is bigger than the shared memory buffers, so can't be passed in place
+                Array<MemoryBlock> messages { createMessage (1), createMessage (1000), createMessage (200000) };
+
+                for (auto& m : messages)
+                    expect (client.sendMessage (m));
+
+                expect (server.waitForMessages (messages.size()));
+                expect (server.getReceived() == messages);
+
+                for (auto& m : messages)
+                    expect (server.sendMessage (m));
+
+                expect (client.waitForMessages (messages.size()));
+                expect (client.getReceived() == messages);
+
+                // (a pipe's reader can't tell when the other end has gone, but a shared memory channel can)
+                client.disconnect();
+
+                if (expectSharedMemory)
+                    expect (server.connectionLostEvent.wait (5000));
+            }
+
+            beginTest ("Disconnecting during a send using " + transport);
+            {
+                TestConnection server, client;
+                expect (server.createPipe (pipeName, -1, true, sharedMemorySize));
+                expect (client.connectToPipe (pipeName, -1));
+
+                // The client's connection thread gets stuck in the first message callback, so the
+                // next message fills up the transport and leaves the sender waiting part-way through it
+                client.blockInMessageCallback = true;
+                expect (server.sendMessage (createMessage (4)));
+
+                SendThread sender (server, createMessage (1 << 20));
+                sender.startThread();
+
+                expect (! sender.finished.wait (500));
+
+                client.disconnect();
+
+                expect (sender.finished.wait (5000));
+                expect (! sender.result);
+                expect (! client.isConnected());
+                expect (client.connectionLostEvent.wait (0));
+
+                if (expectSharedMemory)
+                    expect (! server.isConnected());
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    struct TestConnection  : public InterprocessConnection
+    {
+        TestConnection() : InterprocessConnection (false) {}
+        ~TestConnection() override  { disconnect(); }
+
+        void connectionMade() override  {}
+        void connectionLost() override  { connectionLostEvent.signal(); }
+
+        void messageReceived (const MemoryBlock& message) override
+        {
+            if (blockInMessageCallback)
+            {
+                while (! Thread::currentThreadShouldExit())
+                    Thread::sleep (5);
+
+                return;
+            }
+
+            const ScopedLock sl (lock);
+            received.add (message);
+            messageEvent.signal();
+        }
+
+        bool waitForMessages (int numExpected)
+        {
+            for (;;)
+            {
+                {
+                    const ScopedLock sl (lock);
+
+                    if (received.size() >= numExpected)
+                        return true;
+                }
+
+                if (! messageEvent.wait (5000))
+                    return false;
+            }
+        }
+
+        Array<MemoryBlock> getReceived()
+        {
+            const ScopedLock sl (lock);
+            return received;
+        }
+
+        CriticalSection lock;
+        Array<MemoryBlock> received;
+        WaitableEvent messageEvent, connectionLostEvent;
+        std::atomic<bool> blockInMessageCallback { false };
+    };
+
+    struct SendThread  : public Thread
+    {
+        SendThread (InterprocessConnection& c, const MemoryBlock& m)
+            : Thread ("IPC test sender"), connection (c), message (m)
+        {}
+
+        ~SendThread() override  { stopThread (5000); }
+
+        void run() override
+        {
+            result = connection.sendMessage (message);
+            finished.signal();
+        }
+
+        InterprocessConnection& connection;
+        MemoryBlock message;
+        std::atomic<bool> result { true };
+        WaitableEvent finished;
+    };
+
+    MemoryBlock createMessage (int numBytes)
+    {
+        MemoryBlock m ((size_t) numBytes);
+        auto random = getRandom();
+
+        for (size_t i = 0; i < m.getSize(); ++i)
+            m[i] = (char) random.nextInt (256);
+
+        return m;
+    }
+};
+
+static InterprocessConnectionTests interprocessConnectionTests;
+
+#endif
+
 } // namespace juce
@@ -40,6 +40,11 @@ class MemoryBlock;
     To open a pipe and wait for another client to connect to it, use the createPipe()
     method.
 
+    On Linux, createPipe() can also set up a pair of shared-memory ring buffers alongside
+    the pipe. When it does, connectToPipe() will find them automatically, and all the
+    messages between the two ends will travel through shared memory rather than through
+    the kernel, which is much cheaper for high-rate streams of small messages.
+
     To act as a socket server and create connections for one or more client, see the
     InterprocessConnectionServer class.
 
@@ -95,6 +100,9 @@ public:
         an InterprocessConnection object and used createPipe() to create a pipe for this
         to connect to.
 
+        If the process that created the pipe asked for a shared-memory channel, this will
+        automatically attach to it, and isUsingSharedMemory() will return true.
+
         @param pipeName     the name to use for the pipe - this should be unique to your app
         @param pipeReceiveMessageTimeoutMs  a timeout length to be used when reading or writing
                                             to the pipe, or -1 for an infinite timeout.
@@ -112,10 +120,18 @@ public:
         @param pipeReceiveMessageTimeoutMs  a timeout length to be used when reading or writing
                                             to the pipe, or -1 for an infinite timeout
         @param mustNotExist   if set to true, the method will fail if the pipe already exists
+        @param sharedMemoryBufferSize   if this is greater than zero, a pair of shared-memory ring
+                              buffers of (at least) this many bytes will be created for the
+                              process that connects to the pipe to use. This is currently only
+                              supported on Linux, and is ignored on other platforms. A shared-memory
+                              channel serves a single connection: once the other end disconnects,
+                              connectionLost() is called and the pipe must be created again.
+                              When shared memory is in use, the timeout only applies to writing.
         @returns true if the pipe was created, or false if it fails (e.g. if another process is
                  already using using the pipe)
     */
-    bool createPipe (const String& pipeName, int pipeReceiveMessageTimeoutMs, bool mustNotExist = false);
+    bool createPipe (const String& pipeName, int pipeReceiveMessageTimeoutMs,
+                     bool mustNotExist = false, int sharedMemoryBufferSize = 0);
 
     /** Disconnects and closes any currently-open sockets or pipes. */
     void disconnect();
@@ -129,6 +145,11 @@ public:
     /** Returns the pipe that this connection is using (or nullptr if it uses a socket). */
     NamedPipe* getPipe() const noexcept                         { return pipe.get(); }
 
+    /** Returns true if messages are being exchanged through a shared-memory channel.
+        @see createPipe
+    */
+    bool isUsingSharedMemory() const;
+
     /** Returns the name of the machine at the other end of this connection.
         This may return an empty string if the name is unknown.
     */
@@ -175,6 +196,17 @@ public:
     */
     virtual void messageReceived (const MemoryBlock& message) = 0;
 
+    /** Called on the connection thread when a message arrives through a shared-memory channel.
+
+        This is only used if the connection was created without the callbacksOnMessageThread
+        flag. The data pointer refers directly to the shared buffer, and is only valid until
+        this method returns, so you can override it to consume messages without any copying
+        or allocation. The default implementation copies the data into a MemoryBlock and
+        passes it to messageReceived().
+
+        @see messageReceived, createPipe
+    */
+    virtual void messageReceivedInPlace (const void* data, size_t numBytes);
 
 private:
     //==============================================================================
@@ -186,13 +218,22 @@ private:
     const uint32 magicMessageHeader;
     int pipeReceiveMessageTimeout = -1;
 
+    struct SharedMemoryChannel;
+    CriticalSection sharedMemoryLock;
+    std::unique_ptr<SharedMemoryChannel> sharedMemory;
+
+    struct DataDeliveryMessage;
+    CriticalSection pendingMessagesLock;
+    Array<MemoryBlock> pendingMessages;
+
     friend class InterprocessConnectionServer;
     void initialiseWithSocket (StreamingSocket*);
     void initialiseWithPipe (NamedPipe*);
     void deletePipeAndSocket();
     void connectionMadeInt();
     void connectionLostInt();
-    void deliverDataInt (const MemoryBlock&);
+    void deliverDataInt (MemoryBlock&);
+    void deliverPendingMessages();
     bool readNextMessage();
     int readData (void*, int);
 
@@ -51,6 +51,12 @@
 
 #elif JUCE_LINUX
  #include <unistd.h>
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <sys/syscall.h>
+ #include <signal.h>
+ #include <linux/futex.h>
 #endif
 
 //==============================================================================
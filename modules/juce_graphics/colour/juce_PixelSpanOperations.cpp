@@ -0,0 +1,937 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+/*  All of these kernels work on pixel components that have been widened to 16 bits, and
+    use the same integer arithmetic as the PixelARGB and PixelRGB methods, i.e. for each
+    component:
+
+        src  = (src * extraAlpha) >> 8
+        dest = jmin (255, src + ((dest * (256 - srcAlpha)) >> 8))
+
+    None of the intermediate values can exceed 16 bits, and a saturating pack does the
+    jmin(), so the vectorised versions give exactly the same results as the scalar ones.
+*/
+namespace PixelSpanHelpers
+{
+    template <class DestPixelType>
+    static void blendScalar (DestPixelType* dest, const PixelARGB* src, int num, uint32 extraAlpha) noexcept
+    {
+        if (extraAlpha >= 256)
+        {
+            for (int i = 0; i < num; ++i)
+                dest[i].blend (src[i]);
+        }
+        else
+        {
+            for (int i = 0; i < num; ++i)
+                dest[i].blend (src[i], extraAlpha);
+        }
+    }
+
+    static forcedinline int getLinearGradientIndex (int x, int scale, int start, int numEntries) noexcept
+    {
+        return jlimit (0, numEntries, ((int) ((uint32) x * (uint32) scale - (uint32) start)) >> 12);
+    }
+
+    //==============================================================================
+   #if JUCE_USE_SSE_INTRINSICS
+    static forcedinline PixelARGB readARGB (const uint8* src) noexcept
+    {
+        PixelARGB p;
+        memcpy (reinterpret_cast<uint8*> (&p), src, sizeof (p));
+        return p;
+    }
+
+    static forcedinline __m128i blend16 (__m128i dest, __m128i src, __m128i inverseAlpha) noexcept
+    {
+        return _mm_add_epi16 (src, _mm_srli_epi16 (_mm_mullo_epi16 (dest, inverseAlpha), 8));
+    }
+
+    static forcedinline __m128i getInverseAlphas (__m128i src) noexcept
+    {
+        auto alphas = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (src, _MM_SHUFFLE (PixelARGB::indexA, PixelARGB::indexA, PixelARGB::indexA, PixelARGB::indexA)),
+                                           _MM_SHUFFLE (PixelARGB::indexA, PixelARGB::indexA, PixelARGB::indexA, PixelARGB::indexA));
+
+        return _mm_sub_epi16 (_mm_set1_epi16 (256), alphas);
+    }
+
+    // blends 16 bytes of pixel data onto the destination, where the source components are all the same
+    static forcedinline __m128i blendBytes (__m128i dest, __m128i srcLo, __m128i srcHi, __m128i inverseAlpha) noexcept
+    {
+        auto zero = _mm_setzero_si128();
+
+        return _mm_packus_epi16 (blend16 (_mm_unpacklo_epi8 (dest, zero), srcLo, inverseAlpha),
+                                 blend16 (_mm_unpackhi_epi8 (dest, zero), srcHi, inverseAlpha));
+    }
+
+    // blends 4 ARGB pixels onto 4 other ARGB pixels
+    template <bool useExtraAlpha>
+    static forcedinline __m128i blendPixels (__m128i dest, __m128i src, __m128i extraAlpha) noexcept
+    {
+        auto zero = _mm_setzero_si128();
+        auto srcLo = _mm_unpacklo_epi8 (src, zero);
+        auto srcHi = _mm_unpackhi_epi8 (src, zero);
+
+        if (useExtraAlpha)
+        {
+            srcLo = _mm_srli_epi16 (_mm_mullo_epi16 (srcLo, extraAlpha), 8);
+            srcHi = _mm_srli_epi16 (_mm_mullo_epi16 (srcHi, extraAlpha), 8);
+        }
+
+        return _mm_packus_epi16 (blend16 (_mm_unpacklo_epi8 (dest, zero), srcLo, getInverseAlphas (srcLo)),
+                                 blend16 (_mm_unpackhi_epi8 (dest, zero), srcHi, getInverseAlphas (srcHi)));
+    }
+
+    // the RGB pixels repeat every 48 bytes, so this holds 16 of them in three registers
+    struct RGBPattern
+    {
+        RGBPattern (PixelARGB colour) noexcept
+        {
+            PixelRGB p;
+            p.set (colour);
+
+            uint8 bytes[48];
+
+            for (int i = 0; i < 48; i += 3)
+                memcpy (bytes + i, &p, 3);
+
+            for (int i = 0; i < 3; ++i)
+                v[i] = _mm_loadu_si128 ((const __m128i*) (bytes + 16 * i));
+        }
+
+        __m128i v[3];
+    };
+
+    template <bool useExtraAlpha>
+    static void blendARGBSpan (PixelARGB* dest, const PixelARGB* src, int num, uint32 extraAlpha) noexcept
+    {
+        auto extra = _mm_set1_epi16 ((int16) extraAlpha);
+
+        for (; num >= 4; num -= 4)
+        {
+            auto d = _mm_loadu_si128 ((const __m128i*) dest);
+            auto s = _mm_loadu_si128 ((const __m128i*) src);
+            _mm_storeu_si128 ((__m128i*) dest, blendPixels<useExtraAlpha> (d, s, extra));
+            dest += 4;
+            src += 4;
+        }
+
+        blendScalar (dest, src, num, extraAlpha);
+    }
+
+    template <bool useExtraAlpha>
+    static void blendRGBSpan (PixelRGB* dest, const PixelARGB* src, int num, uint32 extraAlpha) noexcept
+    {
+        auto extra = _mm_set1_epi16 ((int16) extraAlpha);
+
+        for (; num >= 4; num -= 4)
+        {
+            // (the destination is widened to ARGB so that its components line up with the source)
+            uint32 d[4] = { dest[0].getNativeARGB(), dest[1].getNativeARGB(),
+                            dest[2].getNativeARGB(), dest[3].getNativeARGB() };
+
+            auto s = _mm_loadu_si128 ((const __m128i*) src);
+            _mm_storeu_si128 ((__m128i*) d, blendPixels<useExtraAlpha> (_mm_loadu_si128 ((const __m128i*) d), s, extra));
+
+            for (int i = 0; i < 4; ++i)
+                dest[i].set (readARGB ((const uint8*) (d + i)));
+
+            dest += 4;
+            src += 4;
+        }
+
+        blendScalar (dest, src, num, extraAlpha);
+    }
+
+    //==============================================================================
+   #if JUCE_PIXEL_SPAN_USE_AVX2
+    static const bool canUseAVX2 = SystemStats::hasAVX2();
+
+    JUCE_AVX2_TARGET static forcedinline __m256i blend16AVX2 (__m256i dest, __m256i src, __m256i inverseAlpha) noexcept
+    {
+        return _mm256_add_epi16 (src, _mm256_srli_epi16 (_mm256_mullo_epi16 (dest, inverseAlpha), 8));
+    }
+
+    JUCE_AVX2_TARGET static forcedinline __m256i getInverseAlphasAVX2 (__m256i src) noexcept
+    {
+        auto alphas = _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (src, _MM_SHUFFLE (PixelARGB::indexA, PixelARGB::indexA, PixelARGB::indexA, PixelARGB::indexA)),
+                                              _MM_SHUFFLE (PixelARGB::indexA, PixelARGB::indexA, PixelARGB::indexA, PixelARGB::indexA));
+
+        return _mm256_sub_epi16 (_mm256_set1_epi16 (256), alphas);
+    }
+
+    JUCE_AVX2_TARGET static void blendColourAVX2 (PixelARGB*& dest, PixelARGB colour, int& num) noexcept
+    {
+        auto zero = _mm256_setzero_si256();
+        auto src = _mm256_unpacklo_epi8 (_mm256_set1_epi32 ((int) colour.getNativeARGB()), zero);
+        auto inverseAlpha = _mm256_set1_epi16 ((int16) (256 - colour.getAlpha()));
+
+        for (; num >= 8; num -= 8)
+        {
+            auto d = _mm256_loadu_si256 ((const __m256i*) dest);
+
+            _mm256_storeu_si256 ((__m256i*) dest,
+                                 _mm256_packus_epi16 (blend16AVX2 (_mm256_unpacklo_epi8 (d, zero), src, inverseAlpha),
+                                                      blend16AVX2 (_mm256_unpackhi_epi8 (d, zero), src, inverseAlpha)));
+            dest += 8;
+        }
+    }
+
+    template <bool useExtraAlpha>
+    JUCE_AVX2_TARGET static void blendSpanAVX2 (PixelARGB*& dest, const PixelARGB*& src, int& num, uint32 extraAlpha) noexcept
+    {
+        auto zero = _mm256_setzero_si256();
+        auto extra = _mm256_set1_epi16 ((int16) extraAlpha);
+
+        for (; num >= 8; num -= 8)
+        {
+            auto d = _mm256_loadu_si256 ((const __m256i*) dest);
+            auto s = _mm256_loadu_si256 ((const __m256i*) src);
+            auto srcLo = _mm256_unpacklo_epi8 (s, zero);
+            auto srcHi = _mm256_unpackhi_epi8 (s, zero);
+
+            if (useExtraAlpha)
+            {
+                srcLo = _mm256_srli_epi16 (_mm256_mullo_epi16 (srcLo, extra), 8);
+                srcHi = _mm256_srli_epi16 (_mm256_mullo_epi16 (srcHi, extra), 8);
+            }
+
+            _mm256_storeu_si256 ((__m256i*) dest,
+                                 _mm256_packus_epi16 (blend16AVX2 (_mm256_unpacklo_epi8 (d, zero), srcLo, getInverseAlphasAVX2 (srcLo)),
+                                                      blend16AVX2 (_mm256_unpackhi_epi8 (d, zero), srcHi, getInverseAlphasAVX2 (srcHi))));
+            dest += 8;
+            src += 8;
+        }
+    }
+   #endif
+
+    //==============================================================================
+   #elif JUCE_USE_ARM_NEON
+    static forcedinline uint8x8_t blendNeon (uint8x8_t dest, uint16x8_t src, uint16x8_t inverseAlpha) noexcept
+    {
+        return vqmovn_u16 (vaddq_u16 (src, vshrq_n_u16 (vmulq_u16 (vmovl_u8 (dest), inverseAlpha), 8)));
+    }
+
+    template <bool useExtraAlpha>
+    static forcedinline void getSourceComponents (const uint8x8x4_t& s, uint16x8_t* src, uint16x8_t extra) noexcept
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            src[i] = vmovl_u8 (s.val[i]);
+
+            if (useExtraAlpha)
+                src[i] = vshrq_n_u16 (vmulq_u16 (src[i], extra), 8);
+        }
+    }
+
+    template <bool useExtraAlpha>
+    static void blendARGBSpan (PixelARGB* dest, const PixelARGB* src, int num, uint32 extraAlpha) noexcept
+    {
+        auto extra = vdupq_n_u16 ((uint16) extraAlpha);
+
+        for (; num >= 8; num -= 8)
+        {
+            auto d = vld4_u8 ((const uint8*) dest);
+            uint16x8_t s[4];
+            getSourceComponents<useExtraAlpha> (vld4_u8 ((const uint8*) src), s, extra);
+            auto inverseAlpha = vsubq_u16 (vdupq_n_u16 (256), s[PixelARGB::indexA]);
+
+            for (int i = 0; i < 4; ++i)
+                d.val[i] = blendNeon (d.val[i], s[i], inverseAlpha);
+
+            vst4_u8 ((uint8*) dest, d);
+            dest += 8;
+            src += 8;
+        }
+
+        blendScalar (dest, src, num, extraAlpha);
+    }
+
+    template <bool useExtraAlpha>
+    static void blendRGBSpan (PixelRGB* dest, const PixelARGB* src, int num, uint32 extraAlpha) noexcept
+    {
+        auto extra = vdupq_n_u16 ((uint16) extraAlpha);
+
+        for (; num >= 8; num -= 8)
+        {
+            auto d = vld3_u8 ((const uint8*) dest);
+            uint16x8_t s[4];
+            getSourceComponents<useExtraAlpha> (vld4_u8 ((const uint8*) src), s, extra);
+            auto inverseAlpha = vsubq_u16 (vdupq_n_u16 (256), s[PixelARGB::indexA]);
+
+            d.val[PixelRGB::indexR] = blendNeon (d.val[PixelRGB::indexR], s[PixelARGB::indexR], inverseAlpha);
+            d.val[PixelRGB::indexG] = blendNeon (d.val[PixelRGB::indexG], s[PixelARGB::indexG], inverseAlpha);
+            d.val[PixelRGB::indexB] = blendNeon (d.val[PixelRGB::indexB], s[PixelARGB::indexB], inverseAlpha);
+
+            vst3_u8 ((uint8*) dest, d);
+            dest += 8;
+            src += 8;
+        }
+
+        blendScalar (dest, src, num, extraAlpha);
+    }
+
+    //==============================================================================
+   #else
+    static void bilinearScalar (PixelARGB* dest, const uint8* src, uint32 subPixelX, uint32 subPixelY, int lineStride) noexcept
+    {
+        uint32 c[4] = { 256 * 128, 256 * 128, 256 * 128, 256 * 128 };
+        const uint8* corners[] = { src, src + 4, src + lineStride + 4, src + lineStride };
+        const uint32 weights[] = { (256 - subPixelX) * (256 - subPixelY), subPixelX * (256 - subPixelY),
+                                   subPixelX * subPixelY,                 (256 - subPixelX) * subPixelY };
+
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j)
+                c[j] += weights[i] * corners[i][j];
+
+        dest->setARGB ((uint8) (c[PixelARGB::indexA] >> 16),
+                       (uint8) (c[PixelARGB::indexR] >> 16),
+                       (uint8) (c[PixelARGB::indexG] >> 16),
+                       (uint8) (c[PixelARGB::indexB] >> 16));
+    }
+   #endif
+}
+
+//==============================================================================
+void JUCE_CALLTYPE PixelSpanOperations::fill (PixelARGB* dest, PixelARGB colour, int num) noexcept
+{
+   #if JUCE_USE_SSE_INTRINSICS
+    auto v = _mm_set1_epi32 ((int) colour.getNativeARGB());
+
+    for (; num >= 4; num -= 4)
+    {
+        _mm_storeu_si128 ((__m128i*) dest, v);
+        dest += 4;
+    }
+   #elif JUCE_USE_ARM_NEON
+    auto v = vdupq_n_u32 (colour.getNativeARGB());
+
+    for (; num >= 4; num -= 4)
+    {
+        vst1q_u32 ((uint32*) dest, v);
+        dest += 4;
+    }
+   #endif
+
+    while (--num >= 0)
+        (dest++)->set (colour);
+}
+
+void JUCE_CALLTYPE PixelSpanOperations::fill (PixelRGB* dest, PixelARGB colour, int num) noexcept
+{
+    if (colour.getRed() == colour.getGreen() && colour.getGreen() == colour.getBlue())
+    {
+        // if all the component values are the same, we can cheat..
+        memset ((void*) dest, colour.getRed(), (size_t) num * 3);
+        return;
+    }
+
+   #if JUCE_USE_SSE_INTRINSICS
+    const PixelSpanHelpers::RGBPattern pattern (colour);
+
+    for (; num >= 16; num -= 16)
+    {
+        auto d = (__m128i*) dest;
+        _mm_storeu_si128 (d,     pattern.v[0]);
+        _mm_storeu_si128 (d + 1, pattern.v[1]);
+        _mm_storeu_si128 (d + 2, pattern.v[2]);
+        dest += 16;
+    }
+   #elif JUCE_USE_ARM_NEON
+    uint8x8x3_t v;
+    v.val[PixelRGB::indexR] = vdup_n_u8 (colour.getRed());
+    v.val[PixelRGB::indexG] = vdup_n_u8 (colour.getGreen());
+    v.val[PixelRGB::indexB] = vdup_n_u8 (colour.getBlue());
+
+    for (; num >= 8; num -= 8)
+    {
+        vst3_u8 ((uint8*) dest, v);
+        dest += 8;
+    }
+   #endif
+
+    while (--num >= 0)
+        (dest++)->set (colour);
+}
+
+void JUCE_CALLTYPE PixelSpanOperations::blend (PixelARGB* dest, PixelARGB colour, int num) noexcept
+{
+   #if JUCE_USE_SSE_INTRINSICS
+    #if JUCE_PIXEL_SPAN_USE_AVX2
+     if (PixelSpanHelpers::canUseAVX2)
+         PixelSpanHelpers::blendColourAVX2 (dest, colour, num);
+    #endif
+
+    auto src = _mm_unpacklo_epi8 (_mm_set1_epi32 ((int) colour.getNativeARGB()), _mm_setzero_si128());
+    auto inverseAlpha = _mm_set1_epi16 ((int16) (256 - colour.getAlpha()));
+
+    for (; num >= 4; num -= 4)
+    {
+        auto d = _mm_loadu_si128 ((const __m128i*) dest);
+        _mm_storeu_si128 ((__m128i*) dest, PixelSpanHelpers::blendBytes (d, src, src, inverseAlpha));
+        dest += 4;
+    }
+   #elif JUCE_USE_ARM_NEON
+    auto inverseAlpha = vdupq_n_u16 ((uint16) (256 - colour.getAlpha()));
+    auto* components = reinterpret_cast<const uint8*> (&colour);
+    uint16x8_t src[4];
+
+    for (int i = 0; i < 4; ++i)
+        src[i] = vdupq_n_u16 (components[i]);
+
+    for (; num >= 8; num -= 8)
+    {
+        auto d = vld4_u8 ((const uint8*) dest);
+
+        for (int i = 0; i < 4; ++i)
+            d.val[i] = PixelSpanHelpers::blendNeon (d.val[i], src[i], inverseAlpha);
+
+        vst4_u8 ((uint8*) dest, d);
+        dest += 8;
+    }
+   #endif
+
+    while (--num >= 0)
+        (dest++)->blend (colour);
+}
+
+void JUCE_CALLTYPE PixelSpanOperations::blend (PixelRGB* dest, PixelARGB colour, int num) noexcept
+{
+   #if JUCE_USE_SSE_INTRINSICS
+    const PixelSpanHelpers::RGBPattern pattern (colour);
+    auto zero = _mm_setzero_si128();
+    auto inverseAlpha = _mm_set1_epi16 ((int16) (256 - colour.getAlpha()));
+    __m128i srcLo[3], srcHi[3];
+
+    for (int i = 0; i < 3; ++i)
+    {
+        srcLo[i] = _mm_unpacklo_epi8 (pattern.v[i], zero);
+        srcHi[i] = _mm_unpackhi_epi8 (pattern.v[i], zero);
+    }
+
+    for (; num >= 16; num -= 16)
+    {
+        auto d = (__m128i*) dest;
+
+        for (int i = 0; i < 3; ++i)
+            _mm_storeu_si128 (d + i, PixelSpanHelpers::blendBytes (_mm_loadu_si128 (d + i), srcLo[i], srcHi[i], inverseAlpha));
+
+        dest += 16;
+    }
+   #elif JUCE_USE_ARM_NEON
+    auto inverseAlpha = vdupq_n_u16 ((uint16) (256 - colour.getAlpha()));
+    uint16x8_t src[3];
+    src[PixelRGB::indexR] = vdupq_n_u16 (colour.getRed());
+    src[PixelRGB::indexG] = vdupq_n_u16 (colour.getGreen());
+    src[PixelRGB::indexB] = vdupq_n_u16 (colour.getBlue());
+
+    for (; num >= 8; num -= 8)
+    {
+        auto d = vld3_u8 ((const uint8*) dest);
+
+        for (int i = 0; i < 3; ++i)
+            d.val[i] = PixelSpanHelpers::blendNeon (d.val[i], src[i], inverseAlpha);
+
+        vst3_u8 ((uint8*) dest, d);
+        dest += 8;
+    }
+   #endif
+
+    while (--num >= 0)
+        (dest++)->blend (colour);
+}
+
+void JUCE_CALLTYPE PixelSpanOperations::blend (PixelARGB* dest, const PixelARGB* src, int num, uint32 extraAlpha) noexcept
+{
+    jassert (extraAlpha <= 256);
+
+   #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    #if JUCE_PIXEL_SPAN_USE_AVX2
+     if (PixelSpanHelpers::canUseAVX2)
+     {
+         if (extraAlpha >= 256)
+             PixelSpanHelpers::blendSpanAVX2<false> (dest, src, num, extraAlpha);
+         else
+             PixelSpanHelpers::blendSpanAVX2<true> (dest, src, num, extraAlpha);
+     }
+    #endif
+
+    if (extraAlpha >= 256)
+        PixelSpanHelpers::blendARGBSpan<false> (dest, src, num, extraAlpha);
+    else
+        PixelSpanHelpers::blendARGBSpan<true> (dest, src, num, extraAlpha);
+   #else
+    PixelSpanHelpers::blendScalar (dest, src, num, extraAlpha);
+   #endif
+}
+
+void JUCE_CALLTYPE PixelSpanOperations::blend (PixelRGB* dest, const PixelARGB* src, int num, uint32 extraAlpha) noexcept
+{
+    jassert (extraAlpha <= 256);
+
+   #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    if (extraAlpha >= 256)
+        PixelSpanHelpers::blendRGBSpan<false> (dest, src, num, extraAlpha);
+    else
+        PixelSpanHelpers::blendRGBSpan<true> (dest, src, num, extraAlpha);
+   #else
+    PixelSpanHelpers::blendScalar (dest, src, num, extraAlpha);
+   #endif
+}
+
+//==============================================================================
+void JUCE_CALLTYPE PixelSpanOperations::linearGradient (PixelARGB* dest, const PixelARGB* lookupTable, int numEntries,
+                                                        int x, int scale, int start, int num) noexcept
+{
+   #if JUCE_USE_SSE_INTRINSICS
+    auto zero = _mm_setzero_si128();
+    auto maxIndex = _mm_set1_epi32 (numEntries);
+    auto step = _mm_set1_epi32 ((int) ((uint32) scale * 4));
+    auto pos = _mm_add_epi32 (_mm_set1_epi32 ((int) ((uint32) x * (uint32) scale - (uint32) start)),
+                              _mm_set_epi32 ((int) ((uint32) scale * 3), (int) ((uint32) scale * 2), scale, 0));
+
+    for (; num >= 4; num -= 4)
+    {
+        auto index = _mm_srai_epi32 (pos, 12);
+        index = _mm_andnot_si128 (_mm_cmplt_epi32 (index, zero), index);
+
+        auto tooHigh = _mm_cmpgt_epi32 (index, maxIndex);
+        index = _mm_or_si128 (_mm_and_si128 (tooHigh, maxIndex), _mm_andnot_si128 (tooHigh, index));
+
+        int32 indexes[4];
+        _mm_storeu_si128 ((__m128i*) indexes, index);
+
+        dest[0] = lookupTable[indexes[0]];
+        dest[1] = lookupTable[indexes[1]];
+        dest[2] = lookupTable[indexes[2]];
+        dest[3] = lookupTable[indexes[3]];
+
+        pos = _mm_add_epi32 (pos, step);
+        dest += 4;
+        x += 4;
+    }
+   #endif
+
+    while (--num >= 0)
+        *dest++ = lookupTable[PixelSpanHelpers::getLinearGradientIndex (x++, scale, start, numEntries)];
+}
+
+void JUCE_CALLTYPE PixelSpanOperations::radialGradient (PixelARGB* dest, const PixelARGB* lookupTable, int numEntries,
+                                                        int x, double centreX, double dySquared,
+                                                        double maxDistSquared, double invScale, int num) noexcept
+{
+   #if JUCE_USE_SSE_INTRINSICS
+    // (the magic number makes the addition round to an integer in the lower 32 bits, as roundToInt() does)
+    auto magic = _mm_set1_pd (6755399441055744.0);
+    auto dy = _mm_set1_pd (dySquared);
+    auto maxDist = _mm_set1_pd (maxDistSquared);
+    auto scale = _mm_set1_pd (invScale);
+    auto centre = _mm_set1_pd (centreX);
+    auto lastIndex = _mm_set1_epi32 (numEntries);
+    auto pos = _mm_set_pd ((double) (x + 1), (double) x);
+
+    for (; num >= 2; num -= 2)
+    {
+        auto dx = _mm_sub_pd (pos, centre);
+        auto dist = _mm_add_pd (_mm_mul_pd (dx, dx), dy);
+
+        auto index    = _mm_shuffle_epi32 (_mm_castpd_si128 (_mm_add_pd (_mm_mul_pd (_mm_sqrt_pd (dist), scale), magic)), _MM_SHUFFLE (3, 1, 2, 0));
+        auto tooFar   = _mm_shuffle_epi32 (_mm_castpd_si128 (_mm_cmpge_pd (dist, maxDist)), _MM_SHUFFLE (3, 1, 2, 0));
+        index = _mm_or_si128 (_mm_and_si128 (tooFar, lastIndex), _mm_andnot_si128 (tooFar, index));
+
+        dest[0] = lookupTable[_mm_cvtsi128_si32 (index)];
+        dest[1] = lookupTable[_mm_cvtsi128_si32 (_mm_srli_si128 (index, 4))];
+
+        pos = _mm_add_pd (pos, _mm_set1_pd (2.0));
+        dest += 2;
+        x += 2;
+    }
+   #endif
+
+    while (--num >= 0)
+    {
+        auto dx = x++ - centreX;
+        auto dist = dx * dx + dySquared;
+
+        *dest++ = lookupTable[dist >= maxDistSquared ? numEntries : roundToInt (std::sqrt (dist) * invScale)];
+    }
+}
+
+void JUCE_CALLTYPE PixelSpanOperations::transformedRadialGradient (PixelARGB* dest, const PixelARGB* lookupTable, int numEntries,
+                                                                   int x, double m00, double m10, double lineX, double lineY,
+                                                                   double maxDistSquared, double invScale, int num) noexcept
+{
+   #if JUCE_USE_SSE_INTRINSICS
+    auto magic = _mm_set1_pd (6755399441055744.0);
+    auto maxDist = _mm_set1_pd (maxDistSquared);
+    auto scale = _mm_set1_pd (invScale);
+    auto mx = _mm_set1_pd (m00), my = _mm_set1_pd (m10);
+    auto lx = _mm_set1_pd (lineX), ly = _mm_set1_pd (lineY);
+    auto lastIndex = _mm_set1_epi32 (numEntries);
+    auto pos = _mm_set_pd ((double) (x + 1), (double) x);
+
+    for (; num >= 2; num -= 2)
+    {
+        auto dx = _mm_add_pd (_mm_mul_pd (mx, pos), lx);
+        auto dy = _mm_add_pd (_mm_mul_pd (my, pos), ly);
+        auto dist = _mm_add_pd (_mm_mul_pd (dx, dx), _mm_mul_pd (dy, dy));
+
+        auto index  = _mm_shuffle_epi32 (_mm_castpd_si128 (_mm_add_pd (_mm_mul_pd (_mm_sqrt_pd (dist), scale), magic)), _MM_SHUFFLE (3, 1, 2, 0));
+        auto tooFar = _mm_shuffle_epi32 (_mm_castpd_si128 (_mm_cmpge_pd (dist, maxDist)), _MM_SHUFFLE (3, 1, 2, 0));
+        auto tooHigh = _mm_or_si128 (tooFar, _mm_cmpgt_epi32 (index, lastIndex));
+        index = _mm_or_si128 (_mm_and_si128 (tooHigh, lastIndex), _mm_andnot_si128 (tooHigh, index));
+
+        dest[0] = lookupTable[_mm_cvtsi128_si32 (index)];
+        dest[1] = lookupTable[_mm_cvtsi128_si32 (_mm_srli_si128 (index, 4))];
+
+        pos = _mm_add_pd (pos, _mm_set1_pd (2.0));
+        dest += 2;
+        x += 2;
+    }
+   #endif
+
+    while (--num >= 0)
+    {
+        double px = x++;
+        auto dy = m10 * px + lineY;
+        auto dx = m00 * px + lineX;
+        auto dist = dx * dx + dy * dy;
+
+        *dest++ = lookupTable[dist >= maxDistSquared ? numEntries
+                                                     : jmin (numEntries, roundToInt (std::sqrt (dist) * invScale))];
+    }
+}
+
+//==============================================================================
+void JUCE_CALLTYPE PixelSpanOperations::bilinearInterpolate (PixelARGB* dest, const uint8* const* sourcePixels,
+                                                             const uint8* subPixelX, const uint8* subPixelY,
+                                                             int lineStride, int num) noexcept
+{
+   #if JUCE_USE_SSE_INTRINSICS
+    auto zero = _mm_setzero_si128();
+    auto half = _mm_set1_epi32 (32768);
+
+    for (int i = 0; i < num; ++i)
+    {
+        auto* src = sourcePixels[i];
+        auto fx = (int16) subPixelX[i];
+        auto fy = (int16) subPixelY[i];
+
+        // Each row is interpolated horizontally first, which can't overflow 16 bits, and the
+        // two rows are then combined at 32 bits, giving the same sum as weighting each corner.
+        auto wx = _mm_set_epi16 (fx, fx, fx, fx, (int16) (256 - fx), (int16) (256 - fx), (int16) (256 - fx), (int16) (256 - fx));
+        auto top    = _mm_mullo_epi16 (_mm_unpacklo_epi8 (_mm_loadl_epi64 ((const __m128i*) src), zero), wx);
+        auto bottom = _mm_mullo_epi16 (_mm_unpacklo_epi8 (_mm_loadl_epi64 ((const __m128i*) (src + lineStride)), zero), wx);
+        top    = _mm_add_epi16 (top,    _mm_srli_si128 (top, 8));
+        bottom = _mm_add_epi16 (bottom, _mm_srli_si128 (bottom, 8));
+
+        auto rows = _mm_unpacklo_epi64 (top, bottom);
+        auto wy = _mm_set_epi16 (fy, fy, fy, fy, (int16) (256 - fy), (int16) (256 - fy), (int16) (256 - fy), (int16) (256 - fy));
+        auto lo = _mm_mullo_epi16 (rows, wy);
+        auto hi = _mm_mulhi_epu16 (rows, wy);
+
+        auto sum = _mm_srli_epi32 (_mm_add_epi32 (_mm_add_epi32 (_mm_unpacklo_epi16 (lo, hi), _mm_unpackhi_epi16 (lo, hi)), half), 16);
+        sum = _mm_packs_epi32 (sum, sum);
+
+        auto result = (uint32) _mm_cvtsi128_si32 (_mm_packus_epi16 (sum, sum));
+        memcpy (reinterpret_cast<uint8*> (dest + i), &result, sizeof (result));
+    }
+   #elif JUCE_USE_ARM_NEON
+    for (int i = 0; i < num; ++i)
+    {
+        auto* src = sourcePixels[i];
+        auto fx = (uint16) subPixelX[i];
+        auto fy = (uint16) subPixelY[i];
+
+        auto top    = vget_low_u16 (vmovl_u8 (vld1_u8 (src)));
+        auto topR   = vget_high_u16 (vmovl_u8 (vld1_u8 (src)));
+        auto bottom  = vget_low_u16 (vmovl_u8 (vld1_u8 (src + lineStride)));
+        auto bottomR = vget_high_u16 (vmovl_u8 (vld1_u8 (src + lineStride)));
+
+        auto row0 = vmla_n_u16 (vmul_n_u16 (top,    (uint16) (256 - fx)), topR,    fx);
+        auto row1 = vmla_n_u16 (vmul_n_u16 (bottom, (uint16) (256 - fx)), bottomR, fx);
+
+        auto sum = vaddq_u32 (vmlal_n_u16 (vmull_n_u16 (row0, (uint16) (256 - fy)), row1, fy), vdupq_n_u32 (32768));
+        auto result = vmovn_u16 (vcombine_u16 (vshrn_n_u32 (sum, 16), vdup_n_u16 (0)));
+
+        vst1_lane_u32 ((uint32*) (dest + i), vreinterpret_u32_u8 (result), 0);
+    }
+   #else
+    for (int i = 0; i < num; ++i)
+        PixelSpanHelpers::bilinearScalar (dest + i, sourcePixels[i], subPixelX[i], subPixelY[i], lineStride);
+   #endif
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class PixelSpanOperationsTests  : public UnitTest
+{
+public:
+    PixelSpanOperationsTests()
+        : UnitTest ("PixelSpanOperations", "Graphics")
+    {}
+
+    void runTest() override
+    {
+        auto random = getRandom();
+
+        beginTest ("Fills");
+        {
+            for (int i = 0; i < numColours; ++i)
+            {
+                auto colour = createPixel (random);
+
+                if (i == 0)
+                    colour.setARGB (200, 90, 90, 90);  // (grey RGB fills take a different route)
+
+                checkSpans<PixelARGB> (random, "ARGB fill",
+                                       [&] (PixelARGB* d, const PixelARGB*, int n)  { PixelSpanOperations::fill (d, colour, n); },
+                                       [&] (PixelARGB& d, const PixelARGB&)         { d.set (colour); });
+
+                checkSpans<PixelRGB> (random, "RGB fill",
+                                      [&] (PixelRGB* d, const PixelARGB*, int n)    { PixelSpanOperations::fill (d, colour, n); },
+                                      [&] (PixelRGB& d, const PixelARGB&)           { d.set (colour); });
+            }
+        }
+
+        beginTest ("Colour blends");
+        {
+            for (int i = 0; i < numColours; ++i)
+            {
+                auto colour = createPixel (random);
+
+                checkSpans<PixelARGB> (random, "ARGB colour blend",
+                                       [&] (PixelARGB* d, const PixelARGB*, int n)  { PixelSpanOperations::blend (d, colour, n); },
+                                       [&] (PixelARGB& d, const PixelARGB&)         { d.blend (colour); });
+
+                checkSpans<PixelRGB> (random, "RGB colour blend",
+                                      [&] (PixelRGB* d, const PixelARGB*, int n)    { PixelSpanOperations::blend (d, colour, n); },
+                                      [&] (PixelRGB& d, const PixelARGB&)           { d.blend (colour); });
+            }
+        }
+
+        beginTest ("Span blends");
+        {
+            for (auto extraAlpha : { 256u, 255u, 128u, 1u, 0u, (uint32) random.nextInt (256) })
+            {
+                checkSpans<PixelARGB> (random, "ARGB span blend",
+                                       [&] (PixelARGB* d, const PixelARGB* s, int n)  { PixelSpanOperations::blend (d, s, n, extraAlpha); },
+                                       [&] (PixelARGB& d, const PixelARGB& s)         { if (extraAlpha >= 256) d.blend (s); else d.blend (s, extraAlpha); });
+
+                checkSpans<PixelRGB> (random, "RGB span blend",
+                                      [&] (PixelRGB* d, const PixelARGB* s, int n)    { PixelSpanOperations::blend (d, s, n, extraAlpha); },
+                                      [&] (PixelRGB& d, const PixelARGB& s)           { if (extraAlpha >= 256) d.blend (s); else d.blend (s, extraAlpha); });
+            }
+        }
+
+        beginTest ("Gradients");
+        {
+            const int numEntries = 255;
+            std::vector<PixelARGB> lookupTable;
+
+            for (int i = 0; i <= numEntries; ++i)
+                lookupTable.push_back (createPixel (random));
+
+            for (int i = 0; i < numColours; ++i)
+            {
+                auto startX = random.nextInt (1000) - 500;
+                auto scale = random.nextInt (1 << 16) - (1 << 15);
+                auto start = random.nextInt (1 << 20) - (1 << 19);
+
+                checkGradient (random, "linear gradient",
+                               [&] (PixelARGB* d, int n)  { PixelSpanOperations::linearGradient (d, lookupTable.data(), numEntries, startX, scale, start, n); },
+                               [&] (int x)
+                               {
+                                   return jlimit (0, numEntries, ((int) ((uint32) (startX + x) * (uint32) scale - (uint32) start)) >> 12);
+                               },
+                               lookupTable);
+
+                auto centreX = random.nextDouble() * 100.0;
+                auto dySquared = square (random.nextDouble() * 50.0);
+                auto maxDistSquared = square (10.0 + random.nextDouble() * 60.0);
+                auto invScale = numEntries / std::sqrt (maxDistSquared);
+
+                checkGradient (random, "radial gradient",
+                               [&] (PixelARGB* d, int n)  { PixelSpanOperations::radialGradient (d, lookupTable.data(), numEntries, startX, centreX,
+                                                                                                 dySquared, maxDistSquared, invScale, n); },
+                               [&] (int x)
+                               {
+                                   auto dx = (startX + x) - centreX;
+                                   auto dist = dx * dx + dySquared;
+                                   return dist >= maxDistSquared ? numEntries : roundToInt (std::sqrt (dist) * invScale);
+                               },
+                               lookupTable);
+
+                auto m00 = random.nextDouble() * 2.0 - 1.0, m10 = random.nextDouble() * 2.0 - 1.0;
+                auto lineX = random.nextDouble() * 100.0 - 50.0, lineY = random.nextDouble() * 100.0 - 50.0;
+
+                checkGradient (random, "transformed radial gradient",
+                               [&] (PixelARGB* d, int n)  { PixelSpanOperations::transformedRadialGradient (d, lookupTable.data(), numEntries, startX, m00, m10,
+                                                                                                            lineX, lineY, maxDistSquared, invScale, n); },
+                               [&] (int x)
+                               {
+                                   auto px = (double) (startX + x);
+                                   auto dx = m00 * px + lineX;
+                                   auto dy = m10 * px + lineY;
+                                   auto dist = dx * dx + dy * dy;
+                                   return dist >= maxDistSquared ? numEntries : jmin (numEntries, roundToInt (std::sqrt (dist) * invScale));
+                               },
+                               lookupTable);
+            }
+        }
+
+        beginTest ("Bilinear interpolation");
+        {
+            const int width = 64, lineStride = width * 4;
+            std::vector<uint8> image ((size_t) (lineStride * 2));
+
+            for (auto& b : image)
+                b = (uint8) random.nextInt (256);
+
+            for (int num = 0; num <= maxPixels; ++num)
+            {
+                std::vector<const uint8*> sourcePixels;
+                std::vector<uint8> subPixelX, subPixelY;
+
+                for (int i = 0; i < num; ++i)
+                {
+                    sourcePixels.push_back (image.data() + 4 * random.nextInt (width - 1));
+                    subPixelX.push_back ((uint8) random.nextInt (256));
+                    subPixelY.push_back ((uint8) random.nextInt (256));
+                }
+
+                std::vector<PixelARGB> actual ((size_t) num + 1);
+                actual[(size_t) num] = createPixel (random);
+                auto guard = actual[(size_t) num].getNativeARGB();
+
+                PixelSpanOperations::bilinearInterpolate (actual.data(), sourcePixels.data(), subPixelX.data(), subPixelY.data(), lineStride, num);
+
+                bool matches = actual[(size_t) num].getNativeARGB() == guard;
+
+                for (int i = 0; i < num; ++i)
+                    matches = matches && actual[(size_t) i].getNativeARGB()
+                                           == interpolate (sourcePixels[(size_t) i], subPixelX[(size_t) i], subPixelY[(size_t) i], lineStride).getNativeARGB();
+
+                expect (matches, "bilinear interpolation of " + String (num) + " pixels");
+            }
+        }
+    }
+
+private:
+    enum { maxPixels = 40, numColours = 20 };
+
+    static PixelARGB createPixel (Random& random)
+    {
+        // (premultiplied, with plenty of fully opaque and fully transparent ones)
+        auto r = random.nextInt (4);
+        auto alpha = (uint8) (r == 0 ? 0 : (r == 1 ? 255 : random.nextInt (256)));
+
+        return PixelARGB (alpha, (uint8) random.nextInt (alpha + 1),
+                                 (uint8) random.nextInt (alpha + 1),
+                                 (uint8) random.nextInt (alpha + 1));
+    }
+
+    /*  Runs a span operation on runs of every length up to maxPixels, and checks that each pixel
+        ends up exactly as the equivalent per-pixel operation leaves it, and that the pixel
+        after the end of the run isn't touched.
+    */
+    template <typename PixelType, typename SpanOperation, typename PixelOperation>
+    void checkSpans (Random& random, const String& operationName, SpanOperation spanOperation, PixelOperation pixelOperation)
+    {
+        for (int num = 0; num <= maxPixels; ++num)
+        {
+            std::vector<PixelType> actual ((size_t) num + 1), expected ((size_t) num + 1);
+            std::vector<PixelARGB> source ((size_t) num + 1);
+
+            for (size_t i = 0; i <= (size_t) num; ++i)
+            {
+                actual[i].set (createPixel (random));
+                expected[i] = actual[i];
+                source[i] = createPixel (random);
+            }
+
+            spanOperation (actual.data(), source.data(), num);
+
+            for (size_t i = 0; i < (size_t) num; ++i)
+                pixelOperation (expected[i], source[i]);
+
+            bool matches = true;
+
+            for (size_t i = 0; i <= (size_t) num; ++i)
+                matches = matches && actual[i].getNativeARGB() == expected[i].getNativeARGB();
+
+            expect (matches, operationName + " of " + String (num) + " pixels");
+        }
+    }
+
+    template <typename SpanOperation, typename IndexFunction>
+    void checkGradient (Random& random, const String& operationName, SpanOperation spanOperation,
+                        IndexFunction getIndex, const std::vector<PixelARGB>& lookupTable)
+    {
+        for (int num = 0; num <= maxPixels; ++num)
+        {
+            std::vector<PixelARGB> actual ((size_t) num + 1);
+            actual[(size_t) num] = createPixel (random);
+            auto guard = actual[(size_t) num].getNativeARGB();
+
+            spanOperation (actual.data(), num);
+
+            bool matches = actual[(size_t) num].getNativeARGB() == guard;
+
+            for (int i = 0; i < num; ++i)
+                matches = matches && actual[(size_t) i].getNativeARGB() == lookupTable[(size_t) getIndex (i)].getNativeARGB();
+
+            expect (matches, operationName + " of " + String (num) + " pixels");
+        }
+    }
+
+    static PixelARGB interpolate (const uint8* src, uint32 subPixelX, uint32 subPixelY, int lineStride)
+    {
+        uint32 c[4] = { 256 * 128, 256 * 128, 256 * 128, 256 * 128 };
+        const uint8* corners[] = { src, src + 4, src + lineStride + 4, src + lineStride };
+        const uint32 weights[] = { (256 - subPixelX) * (256 - subPixelY), subPixelX * (256 - subPixelY),
+                                   subPixelX * subPixelY,                 (256 - subPixelX) * subPixelY };
+
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j)
+                c[j] += weights[i] * corners[i][j];
+
+        PixelARGB p;
+        p.setARGB ((uint8) (c[PixelARGB::indexA] >> 16), (uint8) (c[PixelARGB::indexR] >> 16),
+                   (uint8) (c[PixelARGB::indexG] >> 16), (uint8) (c[PixelARGB::indexB] >> 16));
+        return p;
+    }
+};
+
+static PixelSpanOperationsTests pixelSpanOperationsTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A collection of operations on runs of adjacent pixels, accelerated with SIMD
+    instructions where possible.
+
+    These are used by the software renderer to fill the spans of an edge-table. Each
+    one produces exactly the same result as performing the equivalent PixelARGB or
+    PixelRGB operation on every pixel in turn, so the choice of instruction set never
+    affects what gets drawn.
+
+    All the pixel pointers must point to tightly-packed runs of pixels, i.e. the pixel
+    stride must be the size of the pixel type.
+
+    @see PixelARGB, PixelRGB
+
+    @tags{Graphics}
+*/
+class JUCE_API  PixelSpanOperations
+{
+public:
+    //==============================================================================
+    /** Replaces a run of pixels with a colour. */
+    static void JUCE_CALLTYPE fill (PixelARGB* dest, PixelARGB colour, int numPixels) noexcept;
+
+    /** Replaces a run of pixels with a colour. */
+    static void JUCE_CALLTYPE fill (PixelRGB* dest, PixelARGB colour, int numPixels) noexcept;
+
+    /** Blends a colour onto a run of pixels, as PixelARGB::blend() does. */
+    static void JUCE_CALLTYPE blend (PixelARGB* dest, PixelARGB colour, int numPixels) noexcept;
+
+    /** Blends a colour onto a run of pixels, as PixelRGB::blend() does. */
+    static void JUCE_CALLTYPE blend (PixelRGB* dest, PixelARGB colour, int numPixels) noexcept;
+
+    /** Blends a run of source pixels onto a run of destination pixels.
+
+        The extra alpha is in the range 0 to 256, where 256 does the same as the
+        PixelARGB::blend (const Pixel&) method, and lower values do the same as
+        PixelARGB::blend (const Pixel&, uint32).
+    */
+    static void JUCE_CALLTYPE blend (PixelARGB* dest, const PixelARGB* src, int numPixels, uint32 extraAlpha = 256) noexcept;
+
+    /** Blends a run of source pixels onto a run of destination pixels.
+        @see blend (PixelARGB*, const PixelARGB*, int, uint32)
+    */
+    static void JUCE_CALLTYPE blend (PixelRGB* dest, const PixelARGB* src, int numPixels, uint32 extraAlpha = 256) noexcept;
+
+    //==============================================================================
+    /** Looks up the colours for a run of pixels in a linear gradient.
+
+        For each pixel x, this picks lookupTable[jlimit (0, numEntries, (x * scale - start) >> 12)],
+        where x starts at startX and goes up by one for each pixel.
+    */
+    static void JUCE_CALLTYPE linearGradient (PixelARGB* dest, const PixelARGB* lookupTable, int numEntries,
+                                              int startX, int scale, int start, int numPixels) noexcept;
+
+    /** Looks up the colours for a run of pixels in a radial gradient.
+
+        For each pixel, the squared distance is (x - centreX)^2 + dySquared, where x starts
+        at startX and goes up by one for each pixel. Distances beyond maxDistSquared use the
+        last entry, and the others are scaled by invScale before being rounded to an index.
+    */
+    static void JUCE_CALLTYPE radialGradient (PixelARGB* dest, const PixelARGB* lookupTable, int numEntries,
+                                              int startX, double centreX, double dySquared,
+                                              double maxDistSquared, double invScale, int numPixels) noexcept;
+
+    /** Looks up the colours for a run of pixels in a radial gradient that has been transformed.
+
+        This is like radialGradient(), but the position of each pixel relative to the centre is
+        (x * m00 + lineX, x * m10 + lineY).
+    */
+    static void JUCE_CALLTYPE transformedRadialGradient (PixelARGB* dest, const PixelARGB* lookupTable, int numEntries,
+                                                         int startX, double m00, double m10, double lineX, double lineY,
+                                                         double maxDistSquared, double invScale, int numPixels) noexcept;
+
+    //==============================================================================
+    /** Bilinearly interpolates a list of pixels from an ARGB image.
+
+        Each destination pixel is a weighted average of the 2x2 block of source pixels whose
+        top-left pixel is sourcePixels[i], using the sub-pixel positions (0 to 255) given in
+        subPixelX[i] and subPixelY[i]. The source image must have a pixel stride of 4.
+    */
+    static void JUCE_CALLTYPE bilinearInterpolate (PixelARGB* dest, const uint8* const* sourcePixels,
+                                                   const uint8* subPixelX, const uint8* subPixelY,
+                                                   int sourceLineStride, int numPixels) noexcept;
+
+private:
+    PixelSpanOperations() = delete;
+};
+
+} // namespace juce
@@ -279,11 +279,8 @@ void Graphics::drawMultiLineText (const String& text, const int startX,
     if (text.isNotEmpty()
          && startX < context.getClipBounds().getRight())
     {
-        GlyphArrangement arr;
-        arr.addJustifiedText (context.getFont(), text,
-                              (float) startX, (float) baselineY, (float) maximumLineWidth,
-                              justification);
-        arr.draw (*this);
+        TextLayoutCache::getJustifiedText (context.getFont(), text, (float) maximumLineWidth, justification)
+            ->draw (*this, AffineTransform::translation ((float) startX, (float) baselineY));
     }
 }
 
@@ -292,14 +289,9 @@ void Graphics::drawText (const String& text, Rectangle<float> area,
 {
     if (text.isNotEmpty() && context.clipRegionIntersects (area.getSmallestIntegerContainer()))
     {
-        GlyphArrangement arr;
-        arr.addCurtailedLineOfText (context.getFont(), text, 0.0f, 0.0f,
-                                    area.getWidth(), useEllipsesIfTooBig);
-
-        arr.justifyGlyphs (0, arr.getNumGlyphs(),
-                           area.getX(), area.getY(), area.getWidth(), area.getHeight(),
-                           justificationType);
-        arr.draw (*this);
+        TextLayoutCache::getCurtailedText (context.getFont(), text, area.getWidth(), area.getHeight(),
+                                           justificationType, useEllipsesIfTooBig)
+            ->draw (*this, AffineTransform::translation (area.getX(), area.getY()));
     }
 }
 
@@ -322,15 +314,12 @@ void Graphics::drawFittedText (const String& text, Rectangle<int> area,
 {
     if (text.isNotEmpty() && (! area.isEmpty()) && context.clipRegionIntersects (area))
     {
-        GlyphArrangement arr;
-        arr.addFittedText (context.getFont(), text,
-                           (float) area.getX(), (float) area.getY(),
-                           (float) area.getWidth(), (float) area.getHeight(),
-                           justification,
-                           maximumNumberOfLines,
-                           minimumHorizontalScale);
-
-        arr.draw (*this);
+        TextLayoutCache::getFittedText (context.getFont(), text,
+                                        (float) area.getWidth(), (float) area.getHeight(),
+                                        justification,
+                                        maximumNumberOfLines,
+                                        minimumHorizontalScale)
+            ->draw (*this, AffineTransform::translation ((float) area.getX(), (float) area.getY()));
     }
 }
 
@@ -411,11 +400,30 @@ void Graphics::strokePath (const Path& path,
                            const PathStrokeType& strokeType,
                            const AffineTransform& transform) const
 {
+    if (context.isPathCachingEnabled())
+    {
+        if (! (context.isClipEmpty() || path.isEmpty()))
+            fillPath (*PathCache::getStrokedPath (path, strokeType, transform, context.getPhysicalPixelScaleFactor()));
+
+        return;
+    }
+
     Path stroke;
     strokeType.createStrokedPath (stroke, path, transform, context.getPhysicalPixelScaleFactor());
     fillPath (stroke);
 }
 
+void Graphics::setPathCachingEnabled (bool shouldCachePaths)
+{
+    saveStateIfPending();
+    context.setPathCachingEnabled (shouldCachePaths);
+}
+
+bool Graphics::isPathCachingEnabled() const
+{
+    return context.isPathCachingEnabled();
+}
+
 //==============================================================================
 void Graphics::drawRect (float x, float y, float width, float height, float lineThickness) const
 {
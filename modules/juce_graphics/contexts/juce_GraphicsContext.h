@@ -442,6 +442,25 @@ public:
                      const PathStrokeType& strokeType,
                      const AffineTransform& transform = {}) const;
 
+    /** Enables or disables caching of the paths that are filled and stroked.
+
+        While this is turned on, the rasterised shapes and stroke outlines of the paths
+        that are drawn are kept in the global PathCache, so that drawing the same path
+        again with the same transform can skip most of the work. This is worth turning on
+        for complicated shapes that are drawn repeatedly without changing, but not for
+        paths that are different every time they're drawn.
+
+        Like the other settings, this is saved and restored by saveState() and
+        restoreState(). It's off by default, and it's ignored by contexts that don't
+        support it.
+
+        @see PathCache, Drawable::setPathCachingEnabled
+    */
+    void setPathCachingEnabled (bool shouldCachePaths);
+
+    /** Returns true if path caching has been enabled with setPathCachingEnabled(). */
+    bool isPathCachingEnabled() const;
+
     /** Draws a line with an arrowhead at its end.
 
         @param line             the line to draw
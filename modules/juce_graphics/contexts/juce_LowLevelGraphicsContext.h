@@ -65,6 +65,13 @@ public:
     virtual void addTransform (const AffineTransform&) = 0;
     virtual float getPhysicalPixelScaleFactor() = 0;
 
+    /** If this context renders into an image in software, this returns true and sets the
+        transform that maps the current coordinate space onto the image's pixels. Anything
+        drawn by a LowLevelGraphicsSoftwareRenderer that uses the same transform will come
+        out with exactly the same pixels as it would in this context.
+    */
+    virtual bool getSoftwareRenderingTransform (AffineTransform&) const     { return false; }
+
     virtual bool clipToRectangle (const Rectangle<int>&) = 0;
     virtual bool clipToRectangleList (const RectangleList<int>&) = 0;
     virtual void excludeClipRectangle (const Rectangle<int>&) = 0;
@@ -85,6 +92,8 @@ public:
     virtual void setFill (const FillType&) = 0;
     virtual void setOpacity (float) = 0;
     virtual void setInterpolationQuality (Graphics::ResamplingQuality) = 0;
+    virtual void setPathCachingEnabled (bool)                       {}
+    virtual bool isPathCachingEnabled() const                       { return false; }
 
     //==============================================================================
     virtual void fillRect (const Rectangle<int>&, bool replaceExistingContents) = 0;
@@ -27,10 +27,448 @@
 namespace juce
 {
 
+namespace RenderingHelpers
+{
+
+//==============================================================================
+class SoftwareRendererThreadPool  : public ThreadPool,
+                                    private DeletedAtShutdown
+{
+public:
+    SoftwareRendererThreadPool()  : ThreadPool (jmax (1, SystemStats::getNumCpus() - 1)) {}
+    ~SoftwareRendererThreadPool() override   { clearSingletonInstance(); }
+
+    JUCE_DECLARE_SINGLETON (SoftwareRendererThreadPool, false)
+};
+
+JUCE_IMPLEMENT_SINGLETON (SoftwareRendererThreadPool)
+
+//==============================================================================
+enum
+{
+    glyphAtlasPageSize = 512,
+    maxSharedGlyphAtlasBytes = 16 * 1024 * 1024
+};
+
+struct SharedGlyphAtlasPages
+{
+    SpinLock lock;
+    ReferenceCountedArray<GlyphAtlas::Page> pages; // (the newest page is the last one)
+    int totalBytes = 0;
+};
+
+static SharedGlyphAtlasPages& getSharedGlyphAtlasPages()
+{
+    static SharedGlyphAtlasPages pages;
+    return pages;
+}
+
+GlyphAtlas::Page::Page (int w, int h, bool isSharedPage)
+    : pixels ((size_t) (w * h), true), width (w), height (h), isShared (isSharedPage)
+{
+}
+
+int GlyphAtlas::Page::findSpaceInRow (const Row& row, int spaceWidth) const noexcept
+{
+    int bestX = -1, bestGapWidth = 0;
+
+    for (auto& gap : row.gaps)
+    {
+        if (gap.getLength() >= spaceWidth && (bestX < 0 || gap.getLength() < bestGapWidth))
+        {
+            bestX = gap.getStart();
+            bestGapWidth = gap.getLength();
+        }
+    }
+
+    if (bestX < 0 && row.nextX + spaceWidth <= width)
+        return row.nextX;
+
+    return bestX;
+}
+
+bool GlyphAtlas::Page::allocate (int spaceWidth, int spaceHeight, Point<int>& position)
+{
+    Row* bestRow = nullptr;
+    int bestX = 0;
+
+    for (auto& row : rows)
+    {
+        if (row.height >= spaceHeight && (bestRow == nullptr || row.height < bestRow->height))
+        {
+            auto x = findSpaceInRow (row, spaceWidth);
+
+            if (x >= 0)
+            {
+                bestRow = &row;
+                bestX = x;
+            }
+        }
+    }
+
+    auto nextRowY = rows.isEmpty() ? 0 : rows.getLast().y + rows.getLast().height;
+
+    // a glyph that would waste a lot of the height of the best row starts a new one instead
+    if ((bestRow == nullptr || bestRow->height > spaceHeight + spaceHeight / 2 + 1)
+          && nextRowY + spaceHeight <= height)
+    {
+        rows.add ({ nextRowY, spaceHeight, 0, 0, {} });
+        bestRow = &rows.getReference (rows.size() - 1);
+        bestX = 0;
+    }
+
+    if (bestRow == nullptr)
+        return false;
+
+    if (bestX == bestRow->nextX)
+    {
+        bestRow->nextX += spaceWidth;
+    }
+    else
+    {
+        for (auto& gap : bestRow->gaps)
+        {
+            if (gap.getStart() == bestX)
+            {
+                gap.setStart (bestX + spaceWidth);
+
+                if (gap.isEmpty())
+                    bestRow->gaps.removeFirstMatchingValue (gap);
+
+                break;
+            }
+        }
+    }
+
+    ++(bestRow->numSpaces);
+    ++numSpaces;
+    position = { bestX, bestRow->y };
+    return true;
+}
+
+void GlyphAtlas::Page::release (Rectangle<int> area)
+{
+    --numSpaces;
+
+    for (int i = 0; i < rows.size(); ++i)
+    {
+        auto& row = rows.getReference (i);
+
+        if (row.y != area.getY())
+            continue;
+
+        if (--(row.numSpaces) == 0)
+        {
+            row.gaps.clearQuick();
+            row.nextX = 0;
+
+            // (empty rows at the bottom are removed, so that the space can be given a new height)
+            while (! rows.isEmpty() && rows.getLast().numSpaces == 0)
+                rows.removeLast();
+
+            return;
+        }
+
+        auto freed = area.getHorizontalRange();
+
+        for (int j = row.gaps.size(); --j >= 0;)
+        {
+            auto gap = row.gaps.getUnchecked (j);
+
+            if (gap.getEnd() == freed.getStart() || gap.getStart() == freed.getEnd())
+            {
+                freed = freed.getUnionWith (gap);
+                row.gaps.remove (j);
+            }
+        }
+
+        if (freed.getEnd() == row.nextX)
+            row.nextX = freed.getStart();
+        else
+            row.gaps.add (freed);
+
+        return;
+    }
+
+    jassertfalse; // this area doesn't belong to any of the page's rows!
+}
+
+GlyphAtlas::Space::Space (Page::Ptr pageToUse, Rectangle<int> areaToUse)
+    : page (std::move (pageToUse)), area (areaToUse)
+{
+}
+
+GlyphAtlas::Space::~Space()
+{
+    if (page->isSharedPage())
+        GlyphAtlas::release (*this);
+}
+
+void GlyphAtlas::release (Space& space)
+{
+    auto& page = *space.page;
+    auto area = space.area;
+
+    for (int y = area.getY(); y < area.getBottom(); ++y)
+        zeromem (page.getPixelPointer (area.getX(), y), (size_t) area.getWidth());
+
+    auto& shared = getSharedGlyphAtlasPages();
+    const SpinLock::ScopedLockType sl (shared.lock);
+
+    page.release (area);
+
+    // An empty page is freed, unless it's the newest one. (As the space still refers to the
+    // page, it won't actually be deleted until after the lock has been released)
+    if (page.numSpaces == 0 && &page != shared.pages.getLast().get())
+    {
+        shared.pages.removeObject (&page);
+        shared.totalBytes -= page.width * page.height;
+    }
+}
+
+GlyphAtlas::Space::Ptr GlyphAtlas::allocate (int width, int height)
+{
+    width  = jmax (1, width);
+    height = jmax (1, height);
+
+    if (width > glyphAtlasPageSize || height > glyphAtlasPageSize)
+        return new Space (new Page (width, height, false), { width, height });
+
+    auto& shared = getSharedGlyphAtlasPages();
+    Point<int> position;
+
+    const SpinLock::ScopedLockType sl (shared.lock);
+
+    for (auto* page : shared.pages)
+        if (page->allocate (width, height, position))
+            return new Space (page, { position.x, position.y, width, height });
+
+    if (shared.totalBytes + glyphAtlasPageSize * glyphAtlasPageSize > maxSharedGlyphAtlasBytes)
+        return new Space (new Page (width, height, false), { width, height });
+
+    auto* newPage = shared.pages.add (new Page (glyphAtlasPageSize, glyphAtlasPageSize, true));
+    shared.totalBytes += glyphAtlasPageSize * glyphAtlasPageSize;
+
+    auto succeeded = newPage->allocate (width, height, position);
+    jassert (succeeded);
+    ignoreUnused (succeeded);
+
+    return new Space (newPage, { position.x, position.y, width, height });
+}
+
+//==============================================================================
+enum
+{
+    minBandHeight = 16,
+    bandsPerThread = 4,
+    maxPendingCommands = 16384
+};
+
+SoftwareRendererDisplayList::SoftwareRendererDisplayList (const Image& mainTarget, int numThreadsToUse)
+    : numThreads (jmax (1, numThreadsToUse))
+{
+    targets.add ({ mainTarget, {} });
+
+    // if anything else starts drawing into the target, our operations need to be done first
+    if (auto* pixelData = mainTarget.getPixelData())
+        pixelData->listeners.add (this);
+}
+
+SoftwareRendererDisplayList::~SoftwareRendererDisplayList()
+{
+    flush();
+
+    if (auto* pixelData = targets.getReference (0).image.getPixelData())
+        pixelData->listeners.remove (this);
+}
+
+int SoftwareRendererDisplayList::getTargetIndex (const Image& image) const noexcept
+{
+    for (int i = 0; i < targets.size(); ++i)
+        if (targets.getReference (i).image.getPixelData() == image.getPixelData())
+            return i;
+
+    return -1;
+}
+
+bool SoftwareRendererDisplayList::isTarget (const Image& image) const noexcept
+{
+    return getTargetIndex (image) >= 0;
+}
+
+Point<int> SoftwareRendererDisplayList::getTargetOffset (const Image& image) const noexcept
+{
+    auto index = getTargetIndex (image);
+    return index >= 0 ? targets.getReference (index).offset : Point<int>();
+}
+
+void SoftwareRendererDisplayList::add (const Image& target, Point<int> targetOffset, const RegionType& region,
+                                       Rectangle<int> areaAffected, Operation operation)
+{
+    if (areaAffected.isEmpty())
+        return;
+
+    if (commands.size() >= (size_t) maxPendingCommands)
+        flush();
+
+    auto targetIndex = getTargetIndex (target);
+
+    if (targetIndex < 0)
+    {
+        targetIndex = targets.size();
+        targets.add ({ target, targetOffset });
+    }
+
+    // (regions are copy-on-write, so holding a reference to this one keeps it unchanged)
+    commands.push_back ({ targetIndex, const_cast<RegionType*> (&region),
+                          areaAffected + targetOffset, std::move (operation) });
+}
+
+Image SoftwareRendererDisplayList::prepareSourceImage (const Image& source)
+{
+    auto* pixelData = source.getPixelData();
+
+    if (pixelData == nullptr)
+        return source;
+
+    // Image types that aren't simply held in memory may need to do some work to provide
+    // access to their pixels, which can't be done on the rendering threads..
+    auto typeID = std::unique_ptr<ImageType> (pixelData->createType())->getTypeID();
+
+    if (typeID != SoftwareImageType().getTypeID() && typeID != NativeImageType().getTypeID())
+        return SoftwareImageType().convert (source);
+
+    if (! watchedImages.contains (pixelData))
+    {
+        pixelData->listeners.add (this);
+        watchedImages.add (pixelData);
+    }
+
+    return source;
+}
+
+void SoftwareRendererDisplayList::imageDataChanged (ImagePixelData*)
+{
+    // One of our sources (or the target) is about to be modified, so anything that
+    // uses it has to be drawn now.
+    if (! isFlushing)
+        flush();
+}
+
+void SoftwareRendererDisplayList::imageDataBeingDeleted (ImagePixelData*) {}
+
+//==============================================================================
+void SoftwareRendererDisplayList::flush()
+{
+    if (commands.empty() || isFlushing)
+        return;
+
+    const ScopedValueSetter<bool> flushing (isFlushing, true);
+
+    // The targets are opened here so that any listeners get told about the changes on
+    // this thread, and so that the rendering threads can all share the same pixel data.
+    OwnedArray<Image::BitmapData> targetData;
+    OwnedArray<SoftwareRendererSavedState> states;
+
+    for (auto& t : targets)
+    {
+        auto* data = targetData.add (new Image::BitmapData (t.image, Image::BitmapData::readWrite));
+        auto* state = states.add (new SoftwareRendererSavedState (t.image, t.image.getBounds()));
+        state->sharedTargetData = data;
+    }
+
+    Rectangle<int> totalArea;
+
+    for (auto& c : commands)
+        totalArea = totalArea.getUnion (c.bounds);
+
+    auto numBands = jlimit (1, numThreads * (int) bandsPerThread, totalArea.getHeight() / (int) minBandHeight);
+    auto bandHeight = (totalArea.getHeight() + numBands - 1) / numBands;
+    numBands = (totalArea.getHeight() + bandHeight - 1) / bandHeight;
+
+    std::vector<Array<int>> bands ((size_t) numBands);
+
+    for (int i = 0; i < (int) commands.size(); ++i)
+    {
+        auto& bounds = commands[(size_t) i].bounds;
+        auto firstBand = (bounds.getY() - totalArea.getY()) / bandHeight;
+        auto lastBand  = (bounds.getBottom() - 1 - totalArea.getY()) / bandHeight;
+
+        for (int band = firstBand; band <= lastBand; ++band)
+            bands[(size_t) band].add (i);
+    }
+
+    std::atomic<int> nextBand { 0 };
+
+    auto renderBands = [&]
+    {
+        for (;;)
+        {
+            auto band = nextBand++;
+
+            if (band >= numBands)
+                break;
+
+            renderBand (totalArea.withY (totalArea.getY() + band * bandHeight).withHeight (bandHeight),
+                        bands[(size_t) band], states);
+        }
+    };
+
+    auto numJobs = jmin (numThreads, numBands) - 1;
+    std::atomic<int> numJobsRunning { numJobs };
+    WaitableEvent jobsFinished;
+
+    for (int i = 0; i < numJobs; ++i)
+    {
+        SoftwareRendererThreadPool::getInstance()->addJob ([&]
+        {
+            renderBands();
+
+            if (--numJobsRunning == 0)
+                jobsFinished.signal();
+        });
+    }
+
+    renderBands();
+
+    if (numJobs > 0)
+        jobsFinished.wait();
+
+    commands.clear();
+    targets.removeRange (1, targets.size());
+
+    for (auto* image : watchedImages)
+        image->listeners.remove (this);
+
+    watchedImages.clear();
+}
+
+void SoftwareRendererDisplayList::renderBand (Rectangle<int> band, const Array<int>& commandIndexes,
+                                              const OwnedArray<SoftwareRendererSavedState>& states) const
+{
+    for (auto index : commandIndexes)
+    {
+        auto& c = commands[(size_t) index];
+        auto targetY = band.getY() - targets.getReference (c.targetIndex).offset.y;
+        auto clipBounds = c.region->getClipBounds();
+
+        // Only the lines are clipped, so that each one gets drawn exactly as it would have been
+        // if the whole region were rendered in one go.
+        if (auto clipped = c.region->cloneClippedTo ({ clipBounds.getX(), targetY, clipBounds.getWidth(), band.getHeight() }))
+            c.operation (*clipped, *states.getUnchecked (c.targetIndex));
+    }
+}
+
+} // namespace RenderingHelpers
+
+//==============================================================================
+static std::atomic<int> defaultNumRenderingThreads { 1 };
+
 LowLevelGraphicsSoftwareRenderer::LowLevelGraphicsSoftwareRenderer (const Image& image)
     : RenderingHelpers::StackBasedLowLevelGraphicsContext<RenderingHelpers::SoftwareRendererSavedState>
         (new RenderingHelpers::SoftwareRendererSavedState (image, image.getBounds()))
 {
+    setNumRenderingThreads (defaultNumRenderingThreads);
 }
 
 LowLevelGraphicsSoftwareRenderer::LowLevelGraphicsSoftwareRenderer (const Image& image, Point<int> origin,
@@ -38,8 +476,478 @@ LowLevelGraphicsSoftwareRenderer::LowLevelGraphicsSoftwareRenderer (const Image&
     : RenderingHelpers::StackBasedLowLevelGraphicsContext<RenderingHelpers::SoftwareRendererSavedState>
         (new RenderingHelpers::SoftwareRendererSavedState (image, initialClip, origin))
 {
+    setNumRenderingThreads (defaultNumRenderingThreads);
 }
 
 LowLevelGraphicsSoftwareRenderer::~LowLevelGraphicsSoftwareRenderer() {}
 
+void LowLevelGraphicsSoftwareRenderer::setNumRenderingThreads (int numThreads)
+{
+    if (numThreads == getNumRenderingThreads())
+        return;
+
+    stack->displayList = nullptr;
+    displayList.reset();
+
+    if (numThreads > 1)
+    {
+        displayList.reset (new RenderingHelpers::SoftwareRendererDisplayList (stack->image, numThreads));
+        stack->displayList = displayList.get();
+    }
+}
+
+bool LowLevelGraphicsSoftwareRenderer::getSoftwareRenderingTransform (AffineTransform& result) const
+{
+    result = stack->transform.getTransform();
+    return true;
+}
+
+int LowLevelGraphicsSoftwareRenderer::getNumRenderingThreads() const noexcept
+{
+    return displayList != nullptr ? displayList->getNumThreads() : 1;
+}
+
+void LowLevelGraphicsSoftwareRenderer::setDefaultNumRenderingThreads (int numThreads) noexcept
+{
+    defaultNumRenderingThreads = jmax (1, numThreads);
+}
+
+int LowLevelGraphicsSoftwareRenderer::getDefaultNumRenderingThreads() noexcept
+{
+    return defaultNumRenderingThreads;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class LowLevelGraphicsSoftwareRendererTests  : public UnitTest
+{
+public:
+    LowLevelGraphicsSoftwareRendererTests()
+        : UnitTest ("LowLevelGraphicsSoftwareRenderer", "Graphics")
+    {}
+
+    void runTest() override
+    {
+        const RectangleList<int> wholeImage (Rectangle<int> (size, size));
+
+        beginTest ("One pixel high fills");
+        {
+            auto oneRow   = render ({ 1.25f, 2.0f, 4.5f, 1.0f }, wholeImage, 1);
+            auto taller   = render ({ 1.25f, 2.0f, 4.5f, 3.0f }, wholeImage, 1);
+            auto opaque   = render ({ 1.25f, 2.0f, 4.5f, 1.0f }, wholeImage, 1, Colours::white, Colours::transparentBlack);
+            auto empty    = render ({}, wholeImage, 1);
+
+            // the row should be blended exactly as the same row of a taller rectangle is
+            for (int x = 0; x < size; ++x)
+            {
+                expect (getPixel (oneRow, x, 2) == getPixel (taller, x, 2));
+                expect (getPixel (oneRow, x, 1) == getPixel (empty, x, 1));
+                expect (getPixel (oneRow, x, 3) == getPixel (empty, x, 3));
+            }
+
+            expectWithinAbsoluteError ((int) opaque.getPixelAt (1, 2).getAlpha(), 191, 1);
+            expectEquals ((int) opaque.getPixelAt (3, 2).getAlpha(), 255);
+            expectWithinAbsoluteError ((int) opaque.getPixelAt (5, 2).getAlpha(), 191, 1);
+            expectEquals ((int) opaque.getPixelAt (6, 2).getAlpha(), 0);
+        }
+
+        RectangleList<int> rows;
+
+        for (int y = 0; y < size; ++y)
+            rows.addWithoutMerging ({ 0, y, size, 1 });
+
+        beginTest ("One pixel high fills against reference values");
+        {
+            const Colour fillColour (Colours::red.withAlpha (0.6f)), background (Colours::blue.withAlpha (0.5f));
+            const RectangleList<int>* clips[] = { &wholeImage, &rows };
+
+            for (auto area : { Rectangle<float> (1.25f, 2.0f, 4.5f, 1.0f),
+                               Rectangle<float> (1.25f, 2.5f, 4.5f, 1.0f),
+                               Rectangle<float> (0.6f, 5.75f, 9.1f, 1.0f),
+                               Rectangle<float> (3.3f, 8.0f, 0.4f, 1.0f) })
+            {
+                for (auto* clip : clips)
+                {
+                    auto image = render (area, *clip, 1, fillColour, background);
+                    int worstError = 0;
+
+                    for (int y = 0; y < size; ++y)
+                        for (int x = 0; x < size; ++x)
+                            worstError = jmax (worstError, getError (image.getPixelAt (x, y).getPixelARGB(),
+                                                                     getReferencePixel (area, x, y, fillColour, background)));
+
+                    // (the renderer's 8-bit blending divides by 256 rather than 255, so its results can
+                    // come out a few levels lower than the exact ones)
+                    expect (worstError <= 3, "pixels differ by " + String (worstError) + " when filling " + area.toString());
+                }
+            }
+        }
+
+        beginTest ("Fills don't depend on how the clip is split up");
+        {
+
+            for (auto area : { Rectangle<float> (0.5f, 0.25f, 10.5f, 9.5f),
+                               Rectangle<float> (2.75f, 4.0f, 7.5f, 1.0f),
+                               Rectangle<float> (3.25f, 6.5f, 0.5f, 0.25f) })
+            {
+                auto expected = render (area, wholeImage, 1);
+
+                expect (imagesAreIdentical (render (area, rows, 1), expected));
+                expect (imagesAreIdentical (render (area, rows, 4), expected));
+                expect (imagesAreIdentical (render (area, wholeImage, 4), expected));
+            }
+        }
+    }
+
+private:
+    enum { size = 16 };
+
+    static Image render (Rectangle<float> area, const RectangleList<int>& clip, int numThreads,
+                         Colour fillColour = Colours::red.withAlpha (0.6f),
+                         Colour background = Colours::blue.withAlpha (0.5f))
+    {
+        Image image (Image::ARGB, size, size, true, SoftwareImageType());
+
+        {
+            LowLevelGraphicsSoftwareRenderer context (image);
+            context.setNumRenderingThreads (numThreads);
+
+            Graphics g (context);
+            g.fillAll (background);
+            g.reduceClipRegion (clip);
+            g.setColour (fillColour);
+            g.fillRect (area);
+        }
+
+        return image;
+    }
+
+    static uint32 getPixel (const Image& image, int x, int y)
+    {
+        return image.getPixelAt (x, y).getARGB();
+    }
+
+    // Works out what a pixel should be from how much of it the rectangle covers, by blending
+    // the premultiplied colours in floating point.
+    static PixelARGB getReferencePixel (Rectangle<float> area, int x, int y, Colour fillColour, Colour background)
+    {
+        auto covered = area.getIntersection ({ (float) x, (float) y, 1.0f, 1.0f });
+        auto alpha = fillColour.getFloatAlpha() * covered.getWidth() * covered.getHeight();
+        auto backgroundAlpha = background.getFloatAlpha();
+
+        auto blend = [=] (float fillLevel, float backgroundLevel)
+        {
+            return (uint8) roundToInt (fillLevel * alpha + backgroundLevel * backgroundAlpha * (1.0f - alpha));
+        };
+
+        return PixelARGB (blend (255.0f, 255.0f),
+                          blend ((float) fillColour.getRed(),   (float) background.getRed()),
+                          blend ((float) fillColour.getGreen(), (float) background.getGreen()),
+                          blend ((float) fillColour.getBlue(),  (float) background.getBlue()));
+    }
+
+    static int getError (PixelARGB a, PixelARGB b)
+    {
+        return jmax (std::abs (a.getAlpha() - b.getAlpha()), std::abs (a.getRed()  - b.getRed()),
+                     std::abs (a.getGreen() - b.getGreen()), std::abs (a.getBlue() - b.getBlue()));
+    }
+
+    static bool imagesAreIdentical (const Image& a, const Image& b)
+    {
+        for (int y = 0; y < size; ++y)
+            for (int x = 0; x < size; ++x)
+                if (getPixel (a, x, y) != getPixel (b, x, y))
+                    return false;
+
+        return true;
+    }
+};
+
+static LowLevelGraphicsSoftwareRendererTests lowLevelGraphicsSoftwareRendererTests;
+
+//==============================================================================
+class SoftwareRendererGlyphCacheTests  : public UnitTest
+{
+public:
+    SoftwareRendererGlyphCacheTests()
+        : UnitTest ("GlyphCache", "Graphics")
+    {}
+
+    void runTest() override
+    {
+        Font font (createTypeface());
+        font.setHeight (17.0f);
+
+        beginTest ("Hits and misses");
+        {
+            TestCache cache;
+
+            auto g1 = cache.findOrCreateGlyph (font, 'a');
+            expect (g1 != nullptr && g1->glyph == 'a');
+            expect (cache.getNumHitsAndMisses() == Point<int> (0, 1));
+
+            expect (cache.findOrCreateGlyph (font, 'a') == g1);
+            expect (cache.getNumHitsAndMisses() == Point<int> (1, 1));
+
+            auto otherVariant = cache.findOrCreateGlyph (font, 'a', 3);
+            expect (otherVariant != g1 && otherVariant->variant == 3);
+
+            expect (cache.findOrCreateGlyph (font.withHeight (18.0f), 'a') != g1);
+            expect (cache.findOrCreateGlyph (font.withHorizontalScale (0.5f), 'a') != g1);
+            expect (cache.findOrCreateGlyph (font, 'b') != g1);
+            expect (cache.getNumHitsAndMisses() == Point<int> (1, 5));
+
+            Font otherTypeface (createTypeface());
+            otherTypeface.setHeight (font.getHeight());
+            expect (cache.findOrCreateGlyph (otherTypeface, 'a') != g1);
+
+            cache.reset();
+            expect (cache.getNumHitsAndMisses() == Point<int>());
+            expect (cache.findOrCreateGlyph (font, 'a') != g1);
+            expect (cache.getNumHitsAndMisses() == Point<int> (0, 1));
+        }
+
+        beginTest ("Least recently used glyphs are discarded");
+        {
+            TestCache cache;
+            cache.setMaximumNumGlyphs (3);
+
+            auto a = cache.findOrCreateGlyph (font, 'a');
+            cache.findOrCreateGlyph (font, 'b');
+            cache.findOrCreateGlyph (font, 'c');
+
+            cache.findOrCreateGlyph (font, 'a');  // now 'b' is the least recently used
+            cache.findOrCreateGlyph (font, 'd');
+            expect (cache.getNumHitsAndMisses() == Point<int> (1, 4));
+
+            for (auto c : { 'a', 'c', 'd' })
+                cache.findOrCreateGlyph (font, c);
+
+            expect (cache.getNumHitsAndMisses() == Point<int> (4, 4));
+
+            cache.findOrCreateGlyph (font, 'b');
+            expect (cache.getNumHitsAndMisses() == Point<int> (4, 5));
+
+            // shrinking the cache discards the oldest ones straight away, but they stay valid
+            // for as long as something's still using them
+            cache.setMaximumNumGlyphs (1);
+            expect (a->getReferenceCount() == 1 && a->glyph == 'a');
+
+            cache.findOrCreateGlyph (font, 'b');
+            cache.findOrCreateGlyph (font, 'd');
+            expect (cache.getNumHitsAndMisses() == Point<int> (5, 6));
+        }
+
+        beginTest ("Cached glyphs are drawn as their edge-tables are");
+        {
+            // At eighths of a pixel, and in colours whose brightness is one of the cache's steps,
+            // a mask holds exactly the edge-table's levels. (An edge-table's runs of pixels get
+            // blended with slightly different rounding from its single pixels, which a mask can't
+            // distinguish, so a component can be out by up to two)
+            auto random = getRandom();
+
+            for (auto colour : { Colours::black, Colours::red, Colours::white, Colour (0xff808080),
+                                 Colour (0xffb6b6b6), Colours::yellow.withAlpha (0.5f) })
+            {
+                for (int i = 0; i < 20; ++i)
+                {
+                    Point<float> pos (5.0f + (float) random.nextInt (80) / 8.0f, 20.0f + random.nextFloat() * 3.0f);
+
+                    if (i == 0)
+                        pos.x = -0.75f;  // (partly off the left-hand side)
+
+                    for (auto glyph : { 'a', 'b' })
+                        expect (getMaximumDifference (renderGlyph (font, glyph, pos, colour, true),
+                                                      renderGlyph (font, glyph, pos, colour, false)) <= 2,
+                                "glyph " + String::charToString ((juce_wchar) glyph) + " at " + pos.toString()
+                                  + " in " + colour.toDisplayString (true));
+                }
+            }
+        }
+
+        beginTest ("Glyphs are drawn at the nearest eighth of a pixel");
+        {
+            auto random = getRandom();
+
+            for (int i = 0; i < 50; ++i)
+            {
+                Point<float> pos (5.0f + random.nextFloat() * 10.0f, 20.0f);
+                Point<float> nearestEighth (std::floor (pos.x * 8.0f + 0.5f) / 8.0f, pos.y);
+
+                for (auto colour : { Colours::black, Colour (0xffd0e0f0) })
+                {
+                    auto image = renderGlyph (font, 'a', pos, colour, true);
+
+                    expect (getMaximumDifference (image, renderGlyph (font, 'a', nearestEighth, colour, true)) == 0);
+                    expect (getMaximumDifference (image, renderGlyph (font, 'a', pos, colour, false)) <= 24,
+                            "glyph at " + pos.toString() + " in " + colour.toDisplayString (true));
+                }
+            }
+        }
+
+        beginTest ("Each glyph has a limited number of versions");
+        {
+            Image image (Image::ARGB, 8, 8, true, SoftwareImageType());
+            RenderingHelpers::SoftwareRendererSavedState state (image, image.getBounds());
+            SortedSet<int> variants;
+
+            for (int level = 0; level < 256; ++level)
+            {
+                state.setFillType (Colour ((uint8) level, (uint8) (level / 2), (uint8) 0));
+
+                for (int x = 0; x < 128; ++x)
+                    variants.add (MaskGlyph::getVariant (state, *font.getTypeface(), { (float) x / 64.0f - 1.0f, 0.0f }));
+            }
+
+            // (8 sub-pixel positions, for each of the 8 brightness steps and for colours that aren't boosted)
+            expectEquals (variants.size(), 72);
+        }
+
+        beginTest ("Freed atlas space is re-used");
+        {
+            // If each batch's remaining glyphs kept all of its space, this would need far more
+            // shared pages than the atlas is allowed, and later glyphs would get pages of their own.
+            ReferenceCountedArray<RenderingHelpers::GlyphAtlas::Space> kept;
+            bool allShared = true;
+
+            for (int batch = 0; batch < 40; ++batch)
+            {
+                ReferenceCountedArray<RenderingHelpers::GlyphAtlas::Space> spaces;
+
+                for (int i = 0; i < 1000; ++i)
+                {
+                    auto* space = spaces.add (RenderingHelpers::GlyphAtlas::allocate (16 + i % 9, 24));
+                    allShared = allShared && space->page->isSharedPage();
+                }
+
+                for (int i = 0; i < spaces.size(); i += 10)
+                    kept.add (spaces[i]);
+            }
+
+            expect (allShared);
+
+            // ..and the space that's re-used is clear
+            ReferenceCountedArray<RenderingHelpers::GlyphAtlas::Space> spaces;
+
+            for (int i = 0; i < 200; ++i)
+                fill (*spaces.add (RenderingHelpers::GlyphAtlas::allocate (20, 20)), 255);
+
+            spaces.clear();
+            kept.clear();
+            bool allClear = true;
+
+            for (int i = 0; i < 1000; ++i)
+                allClear = allClear && isClear (*spaces.add (RenderingHelpers::GlyphAtlas::allocate (20, 20)));
+
+            expect (allClear);
+        }
+    }
+
+private:
+    //==============================================================================
+    struct TestTarget {};
+
+    struct TestGlyph  : public ReferenceCountedObject
+    {
+        enum { defaultMaxNumGlyphs = 4096 };
+
+        static int getVariant (const TestTarget&, Typeface&, Point<float>) noexcept  { return 0; }
+        void draw (TestTarget&, Point<float>) const {}
+
+        void generate (const Font&, int glyphNumber, int glyphVariant)
+        {
+            glyph = glyphNumber;
+            variant = glyphVariant;
+        }
+
+        int glyph = 0, variant = 0;
+    };
+
+    using TestCache = RenderingHelpers::GlyphCache<TestGlyph, TestTarget>;
+    using MaskGlyph = RenderingHelpers::CachedGlyphCoverageMask<RenderingHelpers::SoftwareRendererSavedState>;
+
+    static Typeface::Ptr createTypeface()
+    {
+        auto* typeface = new CustomTypeface();
+        typeface->setCharacteristics ("Test", 0.8f, false, false, 'a');
+
+        Path a;
+        a.addEllipse (0.05f, -0.6f, 0.5f, 0.6f);
+        a.addEllipse (0.15f, -0.45f, 0.3f, 0.3f);
+        a.setUsingNonZeroWinding (false);
+        typeface->addGlyph ('a', a, 0.6f);
+
+        Path b;
+        b.addTriangle (0.0f, 0.0f, 0.33f, -0.71f, 0.61f, 0.03f);
+        b.addRoundedRectangle (0.1f, -0.4f, 0.37f, 0.17f, 0.05f);
+        b.setUsingNonZeroWinding (false);
+        typeface->addGlyph ('b', b, 0.65f);
+
+        return typeface;
+    }
+
+    static Image renderGlyph (const Font& font, int glyph, Point<float> pos, Colour colour, bool useCache)
+    {
+        Image image (Image::ARGB, 32, 32, true, SoftwareImageType());
+        image.clear (image.getBounds(), Colours::darkblue.withAlpha (0.7f));
+
+        RenderingHelpers::SoftwareRendererSavedState state (image, image.getBounds());
+        state.font = font;
+        state.setFillType (colour);
+
+        if (useCache)
+        {
+            state.drawGlyph (glyph, AffineTransform::translation (pos));
+        }
+        else
+        {
+            auto height = font.getHeight();
+            std::unique_ptr<EdgeTable> edgeTable (font.getTypeface()->getEdgeTableForGlyph (glyph, AffineTransform::scale (height * font.getHorizontalScale(), height), height));
+            state.fillEdgeTable (*edgeTable, pos.x, roundToInt (pos.y));
+        }
+
+        return image;
+    }
+
+    static void fill (RenderingHelpers::GlyphAtlas::Space& space, uint8 level)
+    {
+        for (int y = space.area.getY(); y < space.area.getBottom(); ++y)
+            memset (space.page->getPixelPointer (space.area.getX(), y), level, (size_t) space.area.getWidth());
+    }
+
+    static bool isClear (const RenderingHelpers::GlyphAtlas::Space& space)
+    {
+        for (int y = space.area.getY(); y < space.area.getBottom(); ++y)
+            for (int x = space.area.getX(); x < space.area.getRight(); ++x)
+                if (*space.page->getPixelPointer (x, y) != 0)
+                    return false;
+
+        return true;
+    }
+
+    static int getMaximumDifference (const Image& a, const Image& b)
+    {
+        int maxDifference = 0;
+
+        for (int y = 0; y < a.getHeight(); ++y)
+        {
+            for (int x = 0; x < a.getWidth(); ++x)
+            {
+                auto p1 = a.getPixelAt (x, y), p2 = b.getPixelAt (x, y);
+
+                maxDifference = jmax (maxDifference,
+                                      jmax (std::abs (p1.getAlpha() - p2.getAlpha()), std::abs (p1.getRed()  - p2.getRed())),
+                                      jmax (std::abs (p1.getGreen() - p2.getGreen()), std::abs (p1.getBlue() - p2.getBlue())));
+            }
+        }
+
+        return maxDifference;
+    }
+};
+
+static SoftwareRendererGlyphCacheTests softwareRendererGlyphCacheTests;
+
+#endif
+
 } // namespace juce
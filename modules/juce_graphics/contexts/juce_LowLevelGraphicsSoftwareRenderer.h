@@ -51,7 +51,40 @@ public:
     /** Destructor. */
     ~LowLevelGraphicsSoftwareRenderer() override;
 
+    //==============================================================================
+    /** Sets the number of threads that this context uses to render.
+
+        With more than one thread, drawing operations are recorded rather than rendered
+        straight away. They're then drawn in parallel horizontal bands when the context is
+        deleted, or earlier if anything needs the pixels of the target image. The results
+        are identical to rendering on a single thread, but the target image's pixels
+        mustn't be accessed directly until the context has been deleted.
+
+        This must be called before anything has been drawn. The default for new contexts
+        is set with setDefaultNumRenderingThreads().
+    */
+    void setNumRenderingThreads (int numThreads);
+
+    /** Returns the number of threads that this context uses to render. */
+    int getNumRenderingThreads() const noexcept;
+
+    /** Sets the number of threads that newly-created contexts will render with.
+        This is 1 by default, which makes contexts render everything immediately on
+        the calling thread.
+        @see setNumRenderingThreads
+    */
+    static void setDefaultNumRenderingThreads (int numThreads) noexcept;
+
+    /** Returns the number of threads that newly-created contexts will render with. */
+    static int getDefaultNumRenderingThreads() noexcept;
+
+    //==============================================================================
+    /** @internal */
+    bool getSoftwareRenderingTransform (AffineTransform&) const override;
+
 private:
+    std::unique_ptr<RenderingHelpers::SoftwareRendererDisplayList> displayList;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LowLevelGraphicsSoftwareRenderer)
 };
 
@@ -27,44 +27,10 @@
 namespace juce
 {
 
-static inline void blurDataTriplets (uint8* d, int num, const int delta) noexcept
-{
-    uint32 last = d[0];
-    d[0] = (uint8) ((d[0] + d[delta] + 1) / 3);
-    d += delta;
-
-    num -= 2;
-
-    do
-    {
-        const uint32 newLast = d[0];
-        d[0] = (uint8) ((last + d[0] + d[delta] + 1) / 3);
-        d += delta;
-        last = newLast;
-    }
-    while (--num > 0);
-
-    d[0] = (uint8) ((last + d[0] + 1) / 3);
-}
-
-static void blurSingleChannelImage (uint8* const data, const int width, const int height,
-                                    const int lineStride, const int repetitions) noexcept
-{
-    jassert (width > 2 && height > 2);
-
-    for (int y = 0; y < height; ++y)
-        for (int i = repetitions; --i >= 0;)
-            blurDataTriplets (data + lineStride * y, width, 1);
-
-    for (int x = 0; x < width; ++x)
-        for (int i = repetitions; --i >= 0;)
-            blurDataTriplets (data + x, height, lineStride);
-}
-
 static void blurSingleChannelImage (Image& image, int radius)
 {
-    const Image::BitmapData bm (image, Image::BitmapData::readWrite);
-    blurSingleChannelImage (bm.data, bm.width, bm.height, bm.lineStride, 2 * radius);
+    // this gives the shadow the same spread as 2 * radius passes of a 3-pixel box blur
+    ImageOperations::applyGaussianBlur (image, image.getBounds(), std::sqrt (4.0f * (float) radius / 3.0f));
 }
 
 //==============================================================================
@@ -181,4 +147,86 @@ void DropShadowEffect::applyEffect (Image& image, Graphics& g, float scaleFactor
     g.drawImageAt (image, 0, 0);
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class DropShadowTests  : public UnitTest
+{
+public:
+    DropShadowTests()
+        : UnitTest ("DropShadow", "Graphics")
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Shadow spread");
+        {
+            for (auto radius : { 2, 5, 10 })
+            {
+                // The shadow of a vertical bar is the bar's profile convolved with a gaussian whose variance is
+                // 4 * radius / 3 (the spread of 2 * radius passes of a 3-pixel box blur). The bar's own variance
+                // is added to that, and the blur is made of boxes of whole pixels, so it can only get to within
+                // (radius + 2) / 6 of the ideal value.
+                const int size = 96, barX = 40, barWidth = 11, offsetX = 3;
+                auto profile = renderShadowOfBar (radius, barX, barWidth, offsetX, size);
+
+                double total = 0, mean = 0;
+
+                for (int x = 0; x < size; ++x)
+                {
+                    total += profile[(size_t) x];
+                    mean += profile[(size_t) x] * x;
+                }
+
+                mean /= total;
+                double variance = 0;
+
+                for (int x = 0; x < size; ++x)
+                    variance += profile[(size_t) x] * square (x - mean);
+
+                variance /= total;
+
+                auto centre = barX + offsetX + barWidth / 2;
+                auto barVariance = (barWidth * barWidth - 1) / 12.0;
+                auto shadowVariance = 4.0 * radius / 3.0;
+
+                expectWithinAbsoluteError (total, 255.0 * barWidth, 255.0 * barWidth * 0.02);
+                expectWithinAbsoluteError (mean, (double) centre, 0.1);
+                expectWithinAbsoluteError (variance - barVariance, shadowVariance, (radius + 2) / 6.0 + 0.1);
+
+                for (int d = 1; d < centre; ++d)
+                    expectWithinAbsoluteError (profile[(size_t) (centre - d)], profile[(size_t) (centre + d)], 1);
+
+                for (int x = centre; x < size - 1; ++x)
+                    expect (profile[(size_t) x] >= profile[(size_t) x + 1]);
+            }
+        }
+    }
+
+private:
+    static std::vector<int> renderShadowOfBar (int radius, int barX, int barWidth, int offsetX, int size)
+    {
+        Image source (Image::ARGB, size, size, true);
+        source.clear ({ barX, 0, barWidth, size }, Colours::white);
+
+        Image target (Image::ARGB, size, size, true);
+
+        {
+            Graphics g (target);
+            DropShadow (Colours::black, radius, { offsetX, 0 }).drawForImage (g, source);
+        }
+
+        std::vector<int> profile;
+
+        for (int x = 0; x < size; ++x)
+            profile.push_back (target.getPixelAt (x, size / 2).getAlpha());
+
+        return profile;
+    }
+};
+
+static DropShadowTests dropShadowTests;
+
+#endif
+
 } // namespace juce
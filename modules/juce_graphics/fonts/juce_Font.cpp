@@ -169,6 +169,7 @@ void (*clearOpenGLGlyphCache)() = nullptr;
 void Typeface::clearTypefaceCache()
 {
     TypefaceCache::getInstance()->clear();
+    TextLayoutCache::clear();
 
     RenderingHelpers::SoftwareRendererSavedState::clearGlyphCache();
 
@@ -0,0 +1,420 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+struct TextLayoutCache::Pimpl  : private DeletedAtShutdown
+{
+    Pimpl() {}
+    ~Pimpl() override { clearSingletonInstance(); }
+
+    JUCE_DECLARE_SINGLETON (TextLayoutCache::Pimpl, false)
+
+    //==============================================================================
+    enum class Kind
+    {
+        layout,
+        fittedText,
+        curtailedText,
+        justifiedText
+    };
+
+    struct Key
+    {
+        Kind kind;
+        AttributedString attributedText;
+        String text;
+        Font font;
+        float width, height;
+        int justification, maximumLines;
+        float minimumHorizontalScale;
+        bool useEllipses;
+        Array<Typeface::Ptr> typefaces;
+        size_t hash;
+
+        bool operator== (const Key& other) const
+        {
+            return kind == other.kind
+                && hash == other.hash
+                && width == other.width
+                && height == other.height
+                && justification == other.justification
+                && maximumLines == other.maximumLines
+                && minimumHorizontalScale == other.minimumHorizontalScale
+                && useEllipses == other.useEllipses
+                && typefaces == other.typefaces
+                && text == other.text
+                && font == other.font
+                && areIdentical (attributedText, other.attributedText);
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator() (const Key& key) const noexcept   { return key.hash; }
+    };
+
+    static size_t combine (size_t seed, size_t value) noexcept
+    {
+        return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+    }
+
+    static size_t hashFont (const Font& font) noexcept
+    {
+        auto h = (size_t) font.getTypefaceName().hashCode64();
+        h = combine (h, (size_t) font.getTypefaceStyle().hashCode64());
+        h = combine (h, std::hash<float>() (font.getHeight()));
+        h = combine (h, std::hash<float>() (font.getHorizontalScale()));
+        h = combine (h, std::hash<float>() (font.getExtraKerningFactor()));
+        return combine (h, font.isUnderlined() ? 1 : 0);
+    }
+
+    // Fonts that compare as equal may still have been given different typefaces (e.g. a
+    // CustomTypeface with the same name as another one), and a font's typeface is replaced
+    // when the typeface cache is cleared, so each key also holds the actual typefaces.
+    static void addTypeface (Key& key, const Font& font)
+    {
+        Typeface::Ptr typeface (font.getTypeface());
+        key.hash = combine (key.hash, std::hash<Typeface*>() (typeface.get()));
+        key.typefaces.add (typeface);
+    }
+
+    static size_t hashAttributedString (const AttributedString& s) noexcept
+    {
+        auto h = (size_t) s.getText().hashCode64();
+        h = combine (h, (size_t) s.getJustification().getFlags());
+        h = combine (h, (size_t) s.getWordWrap());
+        h = combine (h, (size_t) s.getReadingDirection());
+        h = combine (h, std::hash<float>() (s.getLineSpacing()));
+
+        for (int i = 0; i < s.getNumAttributes(); ++i)
+        {
+            auto& a = s.getAttribute (i);
+            h = combine (h, (size_t) a.range.getStart());
+            h = combine (h, (size_t) a.range.getEnd());
+            h = combine (h, (size_t) a.colour.getARGB());
+            h = combine (h, hashFont (a.font));
+        }
+
+        return h;
+    }
+
+    static bool areIdentical (const AttributedString& a, const AttributedString& b) noexcept
+    {
+        if (a.getText() != b.getText()
+             || a.getJustification() != b.getJustification()
+             || a.getWordWrap() != b.getWordWrap()
+             || a.getReadingDirection() != b.getReadingDirection()
+             || a.getLineSpacing() != b.getLineSpacing()
+             || a.getNumAttributes() != b.getNumAttributes())
+            return false;
+
+        for (int i = 0; i < a.getNumAttributes(); ++i)
+        {
+            auto& attA = a.getAttribute (i);
+            auto& attB = b.getAttribute (i);
+
+            if (attA.range != attB.range || attA.colour != attB.colour || attA.font != attB.font)
+                return false;
+        }
+
+        return true;
+    }
+
+    static Key createKey (Kind kind, const Font& font, const String& text,
+                          float width, float height, Justification justification,
+                          int maximumLines = 0, float minimumHorizontalScale = 0.0f,
+                          bool useEllipses = false)
+    {
+        auto h = combine ((size_t) kind, (size_t) text.hashCode64());
+        h = combine (h, hashFont (font));
+        h = combine (h, std::hash<float>() (width));
+        h = combine (h, std::hash<float>() (height));
+        h = combine (h, (size_t) justification.getFlags());
+        h = combine (h, (size_t) maximumLines);
+        h = combine (h, std::hash<float>() (minimumHorizontalScale));
+        h = combine (h, useEllipses ? 1 : 0);
+
+        Key key { kind, {}, text, font, width, height, justification.getFlags(),
+                  maximumLines, minimumHorizontalScale, useEllipses, {}, h };
+        addTypeface (key, font);
+        return key;
+    }
+
+    //==============================================================================
+    static size_t getSizeInBytes (const TextLayout& layout)
+    {
+        auto total = sizeof (TextLayout);
+
+        for (int i = 0; i < layout.getNumLines(); ++i)
+        {
+            auto& line = layout.getLine (i);
+            total += sizeof (TextLayout::Line);
+
+            for (auto* run : line.runs)
+                total += sizeof (TextLayout::Run) + (size_t) run->glyphs.size() * sizeof (TextLayout::Glyph);
+        }
+
+        return total;
+    }
+
+    static size_t getSizeInBytes (const GlyphArrangement& glyphs)
+    {
+        return sizeof (GlyphArrangement) + (size_t) glyphs.getNumGlyphs() * sizeof (PositionedGlyph);
+    }
+
+    template <typename ObjectType, typename CreatorFunction>
+    std::shared_ptr<const ObjectType> findOrCreate (Key&& key, CreatorFunction&& createObject)
+    {
+        return cache.findOrCreate<ObjectType> (std::move (key), [&] (Key& keyToStore, size_t& size)
+        {
+            auto newObject = std::make_shared<ObjectType>();
+            createObject (*newObject);
+
+            size += getSizeInBytes (*newObject)
+                      + keyToStore.text.getCharPointer().sizeInBytes()
+                      + keyToStore.attributedText.getText().getCharPointer().sizeInBytes()
+                      + (size_t) keyToStore.attributedText.getNumAttributes() * sizeof (AttributedString::Attribute);
+
+            return newObject;
+        });
+    }
+
+    LRUObjectCache<Key, KeyHash> cache { 4 * 1024 * 1024 };
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (Pimpl)
+};
+
+JUCE_IMPLEMENT_SINGLETON (TextLayoutCache::Pimpl)
+
+//==============================================================================
+std::shared_ptr<const TextLayout> TextLayoutCache::getLayout (const AttributedString& text,
+                                                             float maxWidth, float maxHeight)
+{
+    using Kind = Pimpl::Kind;
+
+    auto h = Pimpl::combine ((size_t) Kind::layout, Pimpl::hashAttributedString (text));
+    h = Pimpl::combine (h, std::hash<float>() (maxWidth));
+    h = Pimpl::combine (h, std::hash<float>() (maxHeight));
+
+    Pimpl::Key key { Kind::layout, text, {}, {}, maxWidth, maxHeight, 0, 0, 0.0f, false, {}, h };
+
+    for (int i = 0; i < text.getNumAttributes(); ++i)
+        Pimpl::addTypeface (key, text.getAttribute (i).font);
+
+    return Pimpl::getInstance()->findOrCreate<TextLayout> (std::move (key), [&] (TextLayout& layout)
+    {
+        layout.createLayout (text, maxWidth, maxHeight);
+    });
+}
+
+std::shared_ptr<const GlyphArrangement> TextLayoutCache::getFittedText (const Font& font, const String& text,
+                                                                       float width, float height,
+                                                                       Justification layout,
+                                                                       int maximumLinesToUse,
+                                                                       float minimumHorizontalScale)
+{
+    auto key = Pimpl::createKey (Pimpl::Kind::fittedText, font, text, width, height, layout,
+                                 maximumLinesToUse, minimumHorizontalScale);
+
+    return Pimpl::getInstance()->findOrCreate<GlyphArrangement> (std::move (key), [&] (GlyphArrangement& glyphs)
+    {
+        glyphs.addFittedText (font, text, 0.0f, 0.0f, width, height, layout,
+                              maximumLinesToUse, minimumHorizontalScale);
+    });
+}
+
+std::shared_ptr<const GlyphArrangement> TextLayoutCache::getCurtailedText (const Font& font, const String& text,
+                                                                          float width, float height,
+                                                                          Justification justification,
+                                                                          bool useEllipsesIfTooBig)
+{
+    auto key = Pimpl::createKey (Pimpl::Kind::curtailedText, font, text, width, height, justification,
+                                 0, 0.0f, useEllipsesIfTooBig);
+
+    return Pimpl::getInstance()->findOrCreate<GlyphArrangement> (std::move (key), [&] (GlyphArrangement& glyphs)
+    {
+        glyphs.addCurtailedLineOfText (font, text, 0.0f, 0.0f, width, useEllipsesIfTooBig);
+        glyphs.justifyGlyphs (0, glyphs.getNumGlyphs(), 0.0f, 0.0f, width, height, justification);
+    });
+}
+
+std::shared_ptr<const GlyphArrangement> TextLayoutCache::getJustifiedText (const Font& font, const String& text,
+                                                                          float maxLineWidth,
+                                                                          Justification horizontalLayout)
+{
+    auto key = Pimpl::createKey (Pimpl::Kind::justifiedText, font, text, maxLineWidth, 0.0f, horizontalLayout);
+
+    return Pimpl::getInstance()->findOrCreate<GlyphArrangement> (std::move (key), [&] (GlyphArrangement& glyphs)
+    {
+        glyphs.addJustifiedText (font, text, 0.0f, 0.0f, maxLineWidth, horizontalLayout);
+    });
+}
+
+void TextLayoutCache::setMaximumCacheSize (int numBytes)
+{
+    Pimpl::getInstance()->cache.setMaximumCacheSize ((size_t) jmax (0, numBytes));
+}
+
+void TextLayoutCache::clear()
+{
+    if (auto* instance = Pimpl::getInstanceWithoutCreating())
+        instance->cache.clear();
+}
+
+Point<int> TextLayoutCache::getNumHitsAndMisses()
+{
+    return Pimpl::getInstance()->cache.getNumHitsAndMisses();
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class TextLayoutCacheTests  : public UnitTest
+{
+public:
+    TextLayoutCacheTests()  : UnitTest ("TextLayoutCache", "Graphics") {}
+
+    void runTest() override
+    {
+        TextLayoutCache::clear();
+        TextLayoutCache::setMaximumCacheSize (4 * 1024 * 1024);
+
+        auto typeface = createTypeface();
+        Font font (typeface);
+        font.setHeight (20.0f);
+
+        beginTest ("Hits and misses");
+        {
+            auto first = getText (font, "abba");
+            expect (getNumNewHitsAndMisses() == Point<int> (0, 1));
+
+            auto second = getText (font, "abba");
+            expect (getNumNewHitsAndMisses() == Point<int> (1, 0));
+            expect (first == second);
+            expectEquals (first->getNumGlyphs(), 4);
+
+            getText (font, "baab");
+            getText (font.withHeight (21.0f), "abba");
+            getText (font, "abba", 101.0f);
+            expect (getNumNewHitsAndMisses() == Point<int> (0, 3));
+
+            AttributedString attributed;
+            attributed.append ("abba", font);
+
+            auto layout = TextLayoutCache::getLayout (attributed, 100.0f);
+            expect (TextLayoutCache::getLayout (attributed, 100.0f) == layout);
+            expect (getNumNewHitsAndMisses() == Point<int> (1, 1));
+        }
+
+        beginTest ("Keys include the typeface");
+        {
+            // A different typeface with the same name compares equal as a Font..
+            Font otherFont (createTypeface());
+            otherFont.setHeight (20.0f);
+            expect (otherFont == font);
+
+            auto first = getText (font, "abba");
+            auto second = getText (otherFont, "abba");
+            expect (getNumNewHitsAndMisses() == Point<int> (1, 1));
+            expect (first != second);
+
+            AttributedString attributed;
+            attributed.append ("abba", font);
+            TextLayoutCache::getLayout (attributed, 100.0f);
+
+            AttributedString otherAttributed;
+            otherAttributed.append ("abba", otherFont);
+            TextLayoutCache::getLayout (otherAttributed, 100.0f);
+
+            expect (getNumNewHitsAndMisses() == Point<int> (1, 1));
+        }
+
+        beginTest ("Invalidation");
+        {
+            auto first = getText (font, "abba");
+            TextLayoutCache::clear();
+
+            auto second = getText (font, "abba");
+            expect (getNumNewHitsAndMisses() == Point<int> (1, 1));
+            expect (first != second);
+
+            Typeface::clearTypefaceCache();
+            getText (font, "abba");
+            expect (getNumNewHitsAndMisses() == Point<int> (0, 1));
+
+            TextLayoutCache::setMaximumCacheSize (0);
+            getText (font, "abba");
+            getText (font, "abba");
+            expect (getNumNewHitsAndMisses() == Point<int> (0, 2));
+        }
+
+        TextLayoutCache::setMaximumCacheSize (4 * 1024 * 1024);
+        TextLayoutCache::clear();
+    }
+
+private:
+    Point<int> lastHitsAndMisses;
+
+    Point<int> getNumNewHitsAndMisses()
+    {
+        auto hitsAndMisses = TextLayoutCache::getNumHitsAndMisses();
+        auto result = hitsAndMisses - lastHitsAndMisses;
+        lastHitsAndMisses = hitsAndMisses;
+        return result;
+    }
+
+    std::shared_ptr<const GlyphArrangement> getText (const Font& font, const String& text, float width = 100.0f)
+    {
+        auto result = TextLayoutCache::getFittedText (font, text, width, 30.0f, Justification::centred, 1, 1.0f);
+        expect (result != nullptr);
+        return result;
+    }
+
+    static Typeface::Ptr createTypeface()
+    {
+        auto* typeface = new CustomTypeface();
+        typeface->setCharacteristics ("Test", 0.8f, false, false, 'a');
+
+        Path a;
+        a.addEllipse (0.05f, -0.6f, 0.5f, 0.6f);
+        typeface->addGlyph ('a', a, 0.6f);
+
+        Path b;
+        b.addRectangle (0.05f, -0.7f, 0.5f, 0.7f);
+        typeface->addGlyph ('b', b, 0.65f);
+
+        return typeface;
+    }
+};
+
+static TextLayoutCacheTests textLayoutCacheTests;
+
+#endif
+
+} // namespace juce
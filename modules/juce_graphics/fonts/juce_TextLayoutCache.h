@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A global cache of laid-out text.
+
+    Laying out a string means looking up its fonts, positioning its glyphs and
+    finding its line-breaks, which usually takes much longer than drawing it. Things
+    like labels and table cells tend to paint the same strings at the same sizes over
+    and over again, so the Graphics text-drawing methods and AttributedString::draw()
+    use this cache rather than re-doing that work every time.
+
+    The layouts that it returns are shared and must not be modified, but they can be
+    kept for as long as you like and drawn from any thread. When the cache grows beyond
+    its size limit, the layouts that were used least recently are discarded.
+
+    @see TextLayout, GlyphArrangement, Graphics::drawFittedText
+
+    @tags{Graphics}
+*/
+class JUCE_API  TextLayoutCache
+{
+public:
+    //==============================================================================
+    /** Returns a layout of an attributed string, as created by TextLayout::createLayout(). */
+    static std::shared_ptr<const TextLayout> getLayout (const AttributedString& text,
+                                                        float maxWidth,
+                                                        float maxHeight = 1.0e7f);
+
+    /** Returns the glyphs that GlyphArrangement::addFittedText() would create for a
+        piece of text placed in a box of the given size at the origin.
+
+        To draw the text somewhere else, draw the arrangement with a translation.
+    */
+    static std::shared_ptr<const GlyphArrangement> getFittedText (const Font& font,
+                                                                  const String& text,
+                                                                  float width, float height,
+                                                                  Justification layout,
+                                                                  int maximumLinesToUse,
+                                                                  float minimumHorizontalScale);
+
+    /** Returns a single line of text, curtailed to fit the given width and then
+        justified within a box of the given size at the origin, the way that
+        Graphics::drawText() lays it out.
+    */
+    static std::shared_ptr<const GlyphArrangement> getCurtailedText (const Font& font,
+                                                                     const String& text,
+                                                                     float width, float height,
+                                                                     Justification justification,
+                                                                     bool useEllipsesIfTooBig);
+
+    /** Returns the glyphs that GlyphArrangement::addJustifiedText() would create for a
+        piece of text whose first baseline starts at the origin.
+    */
+    static std::shared_ptr<const GlyphArrangement> getJustifiedText (const Font& font,
+                                                                     const String& text,
+                                                                     float maxLineWidth,
+                                                                     Justification horizontalLayout);
+
+    //==============================================================================
+    /** Changes the approximate number of bytes that the cache may use.
+        The default is 4MB. Setting this to 0 stops anything from being cached.
+    */
+    static void setMaximumCacheSize (int numBytes);
+
+    /** Discards all the layouts that are currently in the cache. */
+    static void clear();
+
+    /** Returns the number of lookups that found a layout in the cache (as the x value)
+        and that had to create a new one (as the y value).
+    */
+    static Point<int> getNumHitsAndMisses();
+
+private:
+    //==============================================================================
+    struct Pimpl;
+    friend struct Pimpl;
+
+    TextLayoutCache();
+    ~TextLayoutCache();
+
+    JUCE_DECLARE_NON_COPYABLE (TextLayoutCache)
+};
+
+} // namespace juce
@@ -275,6 +275,24 @@ EdgeTable::EdgeTable (const EdgeTable& other)
     operator= (other);
 }
 
+EdgeTable::EdgeTable (const EdgeTable& other, Rectangle<int> areaToCopy)
+   : maxEdgesPerLine (other.maxEdgesPerLine),
+     lineStrideElements (other.lineStrideElements)
+{
+    auto top = jmax (other.bounds.getY(), areaToCopy.getY());
+    auto bottom = jmin (other.bounds.getBottom(), areaToCopy.getBottom());
+
+    bounds = { other.bounds.getX(), top, other.bounds.getWidth(), jmax (0, bottom - top) };
+    allocate();
+
+    if (! bounds.isEmpty())
+        copyEdgeTableData (table, lineStrideElements,
+                           other.table + other.lineStrideElements * (top - other.bounds.getY()),
+                           other.lineStrideElements, bounds.getHeight());
+
+    clipToRectangle (areaToCopy);
+}
+
 EdgeTable& EdgeTable::operator= (const EdgeTable& other)
 {
     bounds = other.bounds;
@@ -298,6 +316,11 @@ static size_t getEdgeTableAllocationSize (int lineStride, int height) noexcept
     return (size_t) (lineStride * (2 + jmax (0, height)));
 }
 
+size_t EdgeTable::getSizeInBytes() const noexcept
+{
+    return sizeof (EdgeTable) + getEdgeTableAllocationSize (lineStrideElements, bounds.getHeight()) * sizeof (int);
+}
+
 void EdgeTable::allocate()
 {
     table.malloc (getEdgeTableAllocationSize (lineStrideElements, bounds.getHeight()));
@@ -67,6 +67,12 @@ public:
     /** Creates a copy of another edge table. */
     EdgeTable (const EdgeTable&);
 
+    /** Creates a copy of the part of another edge table that lies within a rectangle.
+        This is much quicker than copying the whole table and then clipping it when the
+        rectangle only covers a few of its lines.
+    */
+    EdgeTable (const EdgeTable& other, Rectangle<int> areaToCopy);
+
     /** Copies from another edge table. */
     EdgeTable& operator= (const EdgeTable&);
 
@@ -92,6 +98,9 @@ public:
     */
     void optimiseTable();
 
+    /** Returns the approximate number of bytes of memory that the table is using. */
+    size_t getSizeInBytes() const noexcept;
+
 
     //==============================================================================
     /** Iterates the lines in the table, for rendering.
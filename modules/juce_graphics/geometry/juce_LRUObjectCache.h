@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A thread-safe cache of shared, immutable objects, which discards the ones that
+    were used least recently when its total size goes over a limit.
+
+    This is the storage behind PathCache and TextLayoutCache. The KeyType must be
+    hashable by KeyHash and comparable with operator==.
+
+    @tags{Graphics}
+*/
+template <typename KeyType, typename KeyHash>
+class LRUObjectCache
+{
+public:
+    explicit LRUObjectCache (size_t maximumSizeInBytes)  : maximumBytes (maximumSizeInBytes) {}
+
+    //==============================================================================
+    /** Returns the object for a key, creating and storing a new one if it's not found.
+
+        The createObject function is called without the lock held, so that other threads
+        can carry on using the cache while it runs. It's given the key that's about to be
+        stored, so that it can make a copy of anything the key only refers to, and a size
+        in bytes, to which it must add the size of the object and of any data that the
+        key holds. Its signature should be:
+        @code
+        std::shared_ptr<const ObjectType> (KeyType& key, size_t& sizeInBytes)
+        @endcode
+    */
+    template <typename ObjectType, typename CreatorFunction>
+    std::shared_ptr<const ObjectType> findOrCreate (KeyType&& key, CreatorFunction&& createObject)
+    {
+        {
+            const ScopedLock sl (lock);
+            auto found = entries.find (key);
+
+            if (found != entries.end())
+            {
+                ++numHits;
+                leastRecentlyUsed.splice (leastRecentlyUsed.end(), leastRecentlyUsed, found->second.lruPosition);
+                return std::static_pointer_cast<const ObjectType> (found->second.object);
+            }
+
+            ++numMisses;
+        }
+
+        auto size = sizeof (KeyType) + sizeof (Entry);
+        std::shared_ptr<const ObjectType> newObject (createObject (key, size));
+
+        const ScopedLock sl (lock);
+
+        if (size > maximumBytes)
+            return newObject;
+
+        auto inserted = entries.emplace (std::move (key), Entry { newObject, size, {} });
+        auto& entry = inserted.first->second;
+
+        if (! inserted.second)
+        {
+            // Another thread got there first..
+            return std::static_pointer_cast<const ObjectType> (entry.object);
+        }
+
+        entry.lruPosition = leastRecentlyUsed.insert (leastRecentlyUsed.end(), &(inserted.first->first));
+        totalBytes += size;
+        removeLeastRecentlyUsed();
+
+        return newObject;
+    }
+
+    /** Changes the approximate number of bytes that the cache may use. */
+    void setMaximumCacheSize (size_t newSize)
+    {
+        const ScopedLock sl (lock);
+        maximumBytes = newSize;
+        removeLeastRecentlyUsed();
+    }
+
+    /** Discards all the objects in the cache. */
+    void clear()
+    {
+        const ScopedLock sl (lock);
+        leastRecentlyUsed.clear();
+        entries.clear();
+        totalBytes = 0;
+    }
+
+    /** Returns the number of lookups that found an object (as the x value) and that
+        had to create one (as the y value).
+    */
+    Point<int> getNumHitsAndMisses()
+    {
+        const ScopedLock sl (lock);
+        return { numHits, numMisses };
+    }
+
+private:
+    //==============================================================================
+    struct Entry
+    {
+        std::shared_ptr<const void> object;
+        size_t size;
+        typename std::list<const KeyType*>::iterator lruPosition;
+    };
+
+    std::unordered_map<KeyType, Entry, KeyHash> entries;
+    std::list<const KeyType*> leastRecentlyUsed;
+    size_t totalBytes = 0, maximumBytes;
+    int numHits = 0, numMisses = 0;
+    CriticalSection lock;
+
+    void removeLeastRecentlyUsed()
+    {
+        while (totalBytes > maximumBytes && ! leastRecentlyUsed.empty())
+        {
+            auto found = entries.find (*leastRecentlyUsed.front());
+            jassert (found != entries.end());
+
+            totalBytes -= found->second.size;
+            leastRecentlyUsed.pop_front();
+            entries.erase (found);
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (LRUObjectCache)
+};
+
+} // namespace juce
@@ -0,0 +1,332 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+struct PathCache::Pimpl  : private DeletedAtShutdown
+{
+    Pimpl() {}
+    ~Pimpl() override { clearSingletonInstance(); }
+
+    JUCE_DECLARE_SINGLETON (PathCache::Pimpl, false)
+
+    //==============================================================================
+    struct Key
+    {
+        bool isStroke;
+        const Path* path;
+        std::shared_ptr<const Path> ownedPath;
+        float transform[6];
+        float thickness, extraAccuracy;
+        int jointStyle, endStyle;
+        size_t hash;
+
+        bool operator== (const Key& other) const noexcept
+        {
+            return hash == other.hash
+                && isStroke == other.isStroke
+                && std::equal (transform, transform + 6, other.transform)
+                && thickness == other.thickness
+                && extraAccuracy == other.extraAccuracy
+                && jointStyle == other.jointStyle
+                && endStyle == other.endStyle
+                && *path == *other.path;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator() (const Key& key) const noexcept   { return key.hash; }
+    };
+
+    static size_t combine (size_t seed, size_t value) noexcept
+    {
+        return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+    }
+
+    // This just mixes the bit-patterns of the path's coordinates together, so it only
+    // costs a tiny fraction of the time it takes to flatten or stroke the path.
+    static size_t hashPath (const Path& path) noexcept
+    {
+        auto h = (uint64) (path.isUsingNonZeroWinding() ? 0xcbf29ce484222325ull : 0x84222325cbf29ce4ull);
+
+        for (auto value : path.data)
+        {
+            uint32 bits;
+            memcpy (&bits, &value, sizeof (bits));
+            h = (h ^ bits) * 0x100000001b3ull;
+        }
+
+        return (size_t) (h ^ (h >> 32));
+    }
+
+    static Key createKey (bool isStroke, const Path& path, const AffineTransform& t,
+                          float thickness = 0.0f, float extraAccuracy = 0.0f,
+                          int jointStyle = 0, int endStyle = 0)
+    {
+        Key key { isStroke, &path, {}, { t.mat00, t.mat01, t.mat02, t.mat10, t.mat11, t.mat12 },
+                  thickness, extraAccuracy, jointStyle, endStyle, 0 };
+
+        auto h = combine (hashPath (path), isStroke ? 1 : 0);
+
+        for (auto f : key.transform)
+            h = combine (h, std::hash<float>() (f));
+
+        h = combine (h, std::hash<float>() (thickness));
+        h = combine (h, std::hash<float>() (extraAccuracy));
+        h = combine (h, (size_t) jointStyle);
+        key.hash = combine (h, (size_t) endStyle);
+
+        return key;
+    }
+
+    //==============================================================================
+    static size_t getSizeInBytes (const Path& path)             { return sizeof (Path) + (size_t) path.data.size() * sizeof (float); }
+    static size_t getSizeInBytes (const EdgeTable& edgeTable)   { return edgeTable.getSizeInBytes(); }
+
+    template <typename ObjectType, typename CreatorFunction>
+    std::shared_ptr<const ObjectType> findOrCreate (Key&& key, CreatorFunction&& createObject)
+    {
+        return cache.findOrCreate<ObjectType> (std::move (key), [&] (Key& keyToStore, size_t& size)
+        {
+            std::shared_ptr<const ObjectType> newObject (createObject());
+            size += getSizeInBytes (*newObject) + getSizeInBytes (*keyToStore.path);
+
+            // The key that was used for the lookup only points to the caller's path, so
+            // the one that's stored needs its own copy.
+            keyToStore.ownedPath = std::make_shared<const Path> (*keyToStore.path);
+            keyToStore.path = keyToStore.ownedPath.get();
+
+            return newObject;
+        });
+    }
+
+    LRUObjectCache<Key, KeyHash> cache { 8 * 1024 * 1024 };
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (Pimpl)
+};
+
+JUCE_IMPLEMENT_SINGLETON (PathCache::Pimpl)
+
+//==============================================================================
+std::shared_ptr<const EdgeTable> PathCache::getEdgeTable (const Path& path,
+                                                         const AffineTransform& transform,
+                                                         Point<int>& offset)
+{
+    auto offsetX = std::floor (transform.getTranslationX());
+    auto offsetY = std::floor (transform.getTranslationY());
+
+    if (! (std::abs (offsetX) < 1.0e6f && std::abs (offsetY) < 1.0e6f))
+        return {};
+
+    // The table is created with only the fractional part of the translation, so that
+    // it can be shared by all the positions that are a whole number of pixels apart.
+    AffineTransform t (transform.mat00, transform.mat01, transform.mat02 - offsetX,
+                       transform.mat10, transform.mat11, transform.mat12 - offsetY);
+
+    auto area = path.getBoundsTransformed (t).getSmallestIntegerContainer().expanded (1);
+
+    // Very large tables would use a lot of memory, and scanning the whole of a path that's
+    // mostly clipped away can take longer than the caching saves.
+    if (area.getWidth() > 16384 || area.getHeight() > 4096)
+        return {};
+
+    offset = { (int) offsetX, (int) offsetY };
+
+    return Pimpl::getInstance()->findOrCreate<EdgeTable> (Pimpl::createKey (false, path, t), [&]
+    {
+        auto* edgeTable = new EdgeTable (area, path, t);
+        edgeTable->optimiseTable();
+        return edgeTable;
+    });
+}
+
+std::shared_ptr<const Path> PathCache::getStrokedPath (const Path& path,
+                                                      const PathStrokeType& strokeType,
+                                                      const AffineTransform& transform,
+                                                      float extraAccuracy)
+{
+    auto key = Pimpl::createKey (true, path, transform, strokeType.getStrokeThickness(), extraAccuracy,
+                                 (int) strokeType.getJointStyle(), (int) strokeType.getEndStyle());
+
+    return Pimpl::getInstance()->findOrCreate<Path> (std::move (key), [&]
+    {
+        auto* stroke = new Path();
+        strokeType.createStrokedPath (*stroke, path, transform, extraAccuracy);
+        return stroke;
+    });
+}
+
+void PathCache::setMaximumCacheSize (int numBytes)
+{
+    Pimpl::getInstance()->cache.setMaximumCacheSize ((size_t) jmax (0, numBytes));
+}
+
+void PathCache::clear()
+{
+    Pimpl::getInstance()->cache.clear();
+}
+
+Point<int> PathCache::getNumHitsAndMisses()
+{
+    return Pimpl::getInstance()->cache.getNumHitsAndMisses();
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class PathCacheTests  : public UnitTest
+{
+public:
+    PathCacheTests()  : UnitTest ("PathCache", "Graphics") {}
+
+    void runTest() override
+    {
+        PathCache::clear();
+        PathCache::setMaximumCacheSize (8 * 1024 * 1024);
+        lastHitsAndMisses = PathCache::getNumHitsAndMisses();
+
+        Path star;
+        star.addStar ({ 50.0f, 50.0f }, 7, 20.0f, 40.0f, 0.3f);
+        star.addEllipse (40.0f, 40.0f, 20.0f, 20.0f);
+
+        Point<int> offset;
+
+        beginTest ("Filled paths");
+        {
+            auto first = PathCache::getEdgeTable (star, AffineTransform::translation (0.25f, 0.5f), offset);
+            expect (first != nullptr);
+            expect (offset.isOrigin());
+            expect (getNumNewHitsAndMisses() == Point<int> (0, 1));
+
+            // A copy of the path with the same contents should find the same table..
+            Path copy (star);
+            expect (PathCache::getEdgeTable (copy, AffineTransform::translation (0.25f, 0.5f), offset) == first);
+            expect (getNumNewHitsAndMisses() == Point<int> (1, 0));
+
+            // ..and so should a transform that only moves it by whole pixels.
+            expect (PathCache::getEdgeTable (star, AffineTransform::translation (10.25f, -2.5f), offset) == first);
+            expect (offset == Point<int> (10, -3));
+            expect (getNumNewHitsAndMisses() == Point<int> (1, 0));
+
+            PathCache::getEdgeTable (star, AffineTransform::translation (0.5f, 0.5f), offset);
+            PathCache::getEdgeTable (star, AffineTransform::scale (2.0f), offset);
+            expect (getNumNewHitsAndMisses() == Point<int> (0, 2));
+
+            // The cached table should hold the same shape as one that's made directly.
+            EdgeTable direct (star.getBoundsTransformed (AffineTransform::translation (0.25f, 0.5f))
+                                  .getSmallestIntegerContainer().expanded (1),
+                              star, AffineTransform::translation (0.25f, 0.5f));
+
+            expect (getCoverage (*first) == getCoverage (direct));
+        }
+
+        beginTest ("Stroked paths");
+        {
+            PathStrokeType stroke (3.0f, PathStrokeType::curved, PathStrokeType::rounded);
+
+            auto first = PathCache::getStrokedPath (star, stroke, {}, 1.0f);
+            expect (PathCache::getStrokedPath (star, stroke, {}, 1.0f) == first);
+            expect (getNumNewHitsAndMisses() == Point<int> (1, 1));
+
+            Path direct;
+            stroke.createStrokedPath (direct, star, {}, 1.0f);
+            expect (*first == direct);
+
+            PathCache::getStrokedPath (star, PathStrokeType (4.0f, PathStrokeType::curved, PathStrokeType::rounded), {}, 1.0f);
+            PathCache::getStrokedPath (star, PathStrokeType (3.0f, PathStrokeType::mitered, PathStrokeType::rounded), {}, 1.0f);
+            PathCache::getStrokedPath (star, stroke, AffineTransform::translation (1.0f, 0.0f), 1.0f);
+            PathCache::getStrokedPath (star, stroke, {}, 2.0f);
+            expect (getNumNewHitsAndMisses() == Point<int> (0, 4));
+        }
+
+        beginTest ("Invalidation");
+        {
+            auto first = PathCache::getEdgeTable (star, {}, offset);
+            expect (getNumNewHitsAndMisses() == Point<int> (0, 1));
+
+            // Changing a path means that it no longer matches the cached one..
+            Path changed (star);
+            changed.lineTo (0.0f, 0.0f);
+            expect (PathCache::getEdgeTable (changed, {}, offset) != first);
+            expect (getNumNewHitsAndMisses() == Point<int> (0, 1));
+
+            changed.setUsingNonZeroWinding (false);
+            PathCache::getEdgeTable (changed, {}, offset);
+            expect (getNumNewHitsAndMisses() == Point<int> (0, 1));
+
+            PathCache::clear();
+            expect (PathCache::getEdgeTable (star, {}, offset) != first);
+            expect (getNumNewHitsAndMisses() == Point<int> (0, 1));
+
+            PathCache::setMaximumCacheSize (0);
+            expect (PathCache::getEdgeTable (star, {}, offset) != nullptr);
+            PathCache::getEdgeTable (star, {}, offset);
+            expect (getNumNewHitsAndMisses() == Point<int> (0, 2));
+        }
+
+        PathCache::setMaximumCacheSize (8 * 1024 * 1024);
+        PathCache::clear();
+    }
+
+private:
+    Point<int> lastHitsAndMisses;
+
+    Point<int> getNumNewHitsAndMisses()
+    {
+        auto hitsAndMisses = PathCache::getNumHitsAndMisses();
+        auto result = hitsAndMisses - lastHitsAndMisses;
+        lastHitsAndMisses = hitsAndMisses;
+        return result;
+    }
+
+    // Records everything that an EdgeTable produces when it's iterated.
+    struct CoverageRecorder
+    {
+        Array<int> values;
+
+        void setEdgeTableYPos (int y)                           { values.add (-1, y); }
+        void handleEdgeTablePixel (int x, int alpha)            { values.add (x, 1, alpha); }
+        void handleEdgeTablePixelFull (int x)                   { values.add (x, 1, 255); }
+        void handleEdgeTableLine (int x, int width, int alpha)  { values.add (x, width, alpha); }
+        void handleEdgeTableLineFull (int x, int width)         { values.add (x, width, 255); }
+    };
+
+    static Array<int> getCoverage (const EdgeTable& edgeTable)
+    {
+        CoverageRecorder recorder;
+        edgeTable.iterate (recorder);
+        return recorder.values;
+    }
+};
+
+static PathCacheTests pathCacheTests;
+
+#endif
+
+} // namespace juce
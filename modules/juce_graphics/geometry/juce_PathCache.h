@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A global cache of rasterised and stroked paths.
+
+    Filling a path means breaking its curves into lines and scanning them into an
+    EdgeTable, and stroking one means building a whole new outline path first, so
+    for complicated shapes that are drawn over and over again - icons, SVG drawings,
+    waveform outlines, etc - it can be much quicker to keep the results than to
+    re-create them on every repaint.
+
+    The renderer only uses this cache for paths that are drawn while it's enabled with
+    Graphics::setPathCachingEnabled(), because hashing and storing a path that is only
+    drawn once is a waste of time. Paths are matched by their contents, so there's no
+    need to keep the same Path object around, but if a path changes on every repaint,
+    it shouldn't be drawn with caching turned on.
+
+    The objects that it returns are shared and must not be modified, but they can be
+    kept for as long as you like and used from any thread. When the cache grows beyond
+    its size limit, the objects that were used least recently are discarded.
+
+    @see Graphics::setPathCachingEnabled, EdgeTable, PathStrokeType
+
+    @tags{Graphics}
+*/
+class JUCE_API  PathCache
+{
+public:
+    //==============================================================================
+    /** Returns an EdgeTable containing a transformed path, or nullptr if the path
+        is too big to be worth caching.
+
+        To save re-scanning a path that has only been moved by a whole number of pixels,
+        the same table is used for all the transforms that differ only in the integer
+        part of their translation. The table that's returned needs to be moved by the
+        amount that is returned in the offset parameter to put it in the right place.
+    */
+    static std::shared_ptr<const EdgeTable> getEdgeTable (const Path& path,
+                                                          const AffineTransform& transform,
+                                                          Point<int>& offset);
+
+    /** Returns the outline that PathStrokeType::createStrokedPath() would create
+        for a path.
+    */
+    static std::shared_ptr<const Path> getStrokedPath (const Path& path,
+                                                       const PathStrokeType& strokeType,
+                                                       const AffineTransform& transform,
+                                                       float extraAccuracy);
+
+    //==============================================================================
+    /** Changes the approximate number of bytes that the cache may use.
+        The default is 8MB. Setting this to 0 stops anything from being cached.
+    */
+    static void setMaximumCacheSize (int numBytes);
+
+    /** Discards all the objects that are currently in the cache. */
+    static void clear();
+
+    /** Returns the number of lookups that found an object in the cache (as the x value)
+        and that had to create a new one (as the y value).
+    */
+    static Point<int> getNumHitsAndMisses();
+
+private:
+    //==============================================================================
+    struct Pimpl;
+    friend struct Pimpl;
+
+    PathCache();
+    ~PathCache();
+
+    JUCE_DECLARE_NON_COPYABLE (PathCache)
+};
+
+} // namespace juce
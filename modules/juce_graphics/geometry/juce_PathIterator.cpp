@@ -34,7 +34,7 @@ namespace juce
 //==============================================================================
 PathFlatteningIterator::PathFlatteningIterator (const Path& pathToUse,
                                                 const AffineTransform& t,
-                                                float tolerance)
+                                                float toleranceToUse)
     : x2 (0),
       y2 (0),
       closesSubPath (false),
@@ -42,8 +42,10 @@ PathFlatteningIterator::PathFlatteningIterator (const Path& pathToUse,
       path (pathToUse),
       transform (t),
       source (path.data.begin()),
-      toleranceSquared (tolerance * tolerance),
-      isIdentityTransform (t.isIdentity())
+      toleranceSquared (toleranceToUse * toleranceToUse),
+      tolerance (toleranceToUse),
+      isIdentityTransform (t.isIdentity()),
+      usesFixedSteps (isFastCurveFlatteningEnabled())
 {
     stackPos = stackBase;
 }
@@ -54,11 +56,55 @@ PathFlatteningIterator::~PathFlatteningIterator()
 
 bool PathFlatteningIterator::isLastInSubpath() const noexcept
 {
-    return stackPos == stackBase.get()
+    return stackPos == stackBase.get() && curveSegment >= numCurveSegments
              && (source == path.data.end() || isMarker (*source, Path::moveMarker));
 }
 
+/*  Each curve is split into a number of equal steps that's worked out in advance using
+    Wang's formula, which bounds the distance between a polynomial curve and its chords by
+    the size of its second differences. The points are then evaluated directly from the
+    curve's polynomial, so no stack of sub-curves is needed, and each line that's produced
+    only costs a few multiply-adds.
+
+    The scale factor asks for more lines than the formula's minimum, so that curves are
+    flattened to within a small fraction of the tolerance, which keeps them looking
+    smooth when they're rendered.
+*/
+void PathFlatteningIterator::startCurve (float c1x, float c1y, float c2x, float c2y, float c3x, float c3y,
+                                         float endX, float endY, float secondDifferenceSquared, float scale) noexcept
+{
+    curveX0 = x2;   curveY0 = y2;
+    curveX1 = c1x;  curveY1 = c1y;
+    curveX2 = c2x;  curveY2 = c2y;
+    curveX3 = c3x;  curveY3 = c3y;
+    curveEndX = endX;
+    curveEndY = endY;
+
+    auto numSegments = std::ceil (std::sqrt (scale * std::sqrt (secondDifferenceSquared) / tolerance));
+
+    // (this is written so that a NaN will produce a single segment)
+    numCurveSegments = numSegments > 1.0f ? (numSegments < 65536.0f ? (int) numSegments : 65536) : 1;
+    curveSegment = 0;
+}
+
+static std::atomic<bool> fastCurveFlatteningEnabled { false };
+
+void PathFlatteningIterator::setFastCurveFlatteningEnabled (bool shouldBeEnabled) noexcept
+{
+    fastCurveFlatteningEnabled = shouldBeEnabled;
+}
+
+bool PathFlatteningIterator::isFastCurveFlatteningEnabled() noexcept
+{
+    return fastCurveFlatteningEnabled;
+}
+
 bool PathFlatteningIterator::next()
+{
+    return usesFixedSteps ? nextByFixedSteps() : nextBySubdivision();
+}
+
+bool PathFlatteningIterator::nextBySubdivision()
 {
     x1 = x2;
     y1 = y2;
@@ -279,8 +325,275 @@ bool PathFlatteningIterator::next()
     }
 }
 
+//==============================================================================
+bool PathFlatteningIterator::nextByFixedSteps()
+{
+    x1 = x2;
+    y1 = y2;
+
+    for (;;)
+    {
+        if (curveSegment < numCurveSegments)
+        {
+            if (++curveSegment < numCurveSegments)
+            {
+                auto t = (float) curveSegment / (float) numCurveSegments;
+
+                x2 = ((curveX3 * t + curveX2) * t + curveX1) * t + curveX0;
+                y2 = ((curveY3 * t + curveY2) * t + curveY1) * t + curveY0;
+                ++subPathIndex;
+                closesSubPath = false;
+                return true;
+            }
+
+            // the last segment goes exactly to the end-point of the curve, rather than
+            // to an evaluated point which might have a rounding error
+            x2 = curveEndX;
+            y2 = curveEndY;
+        }
+        else
+        {
+            if (source == path.data.end())
+                return false;
+
+            auto type = *source++;
+
+            if (isMarker (type, Path::lineMarker))
+            {
+                x2 = *source++;
+                y2 = *source++;
+
+                if (! isIdentityTransform)
+                    transform.transformPoint (x2, y2);
+            }
+            else if (isMarker (type, Path::quadMarker))
+            {
+                auto cx = *source++;
+                auto cy = *source++;
+                auto ex = *source++;
+                auto ey = *source++;
+
+                if (! isIdentityTransform)
+                    transform.transformPoints (cx, cy, ex, ey);
+
+                auto dx = x2 - 2.0f * cx + ex;
+                auto dy = y2 - 2.0f * cy + ey;
+
+                startCurve (2.0f * (cx - x2), 2.0f * (cy - y2), dx, dy, 0.0f, 0.0f, ex, ey,
+                            dx * dx + dy * dy, 2.0f);
+                continue;
+            }
+            else if (isMarker (type, Path::cubicMarker))
+            {
+                auto c1x = *source++;
+                auto c1y = *source++;
+                auto c2x = *source++;
+                auto c2y = *source++;
+                auto ex = *source++;
+                auto ey = *source++;
+
+                if (! isIdentityTransform)
+                    transform.transformPoints (c1x, c1y, c2x, c2y, ex, ey);
+
+                auto d1x = x2 - 2.0f * c1x + c2x;
+                auto d1y = y2 - 2.0f * c1y + c2y;
+                auto d2x = c1x - 2.0f * c2x + ex;
+                auto d2y = c1y - 2.0f * c2y + ey;
+
+                startCurve (3.0f * (c1x - x2), 3.0f * (c1y - y2), 3.0f * d1x, 3.0f * d1y,
+                            ex - x2 + 3.0f * (c1x - c2x), ey - y2 + 3.0f * (c1y - c2y), ex, ey,
+                            jmax (d1x * d1x + d1y * d1y, d2x * d2x + d2y * d2y), 3.0f);
+                continue;
+            }
+            else if (isMarker (type, Path::closeSubPathMarker))
+            {
+                if (x2 != subPathCloseX || y2 != subPathCloseY)
+                {
+                    x1 = x2;
+                    y1 = y2;
+                    x2 = subPathCloseX;
+                    y2 = subPathCloseY;
+                    closesSubPath = true;
+
+                    return true;
+                }
+
+                continue;
+            }
+            else
+            {
+                jassert (isMarker (type, Path::moveMarker));
+
+                x2 = *source++;
+                y2 = *source++;
+
+                if (! isIdentityTransform)
+                    transform.transformPoint (x2, y2);
+
+                subPathIndex = -1;
+                subPathCloseX = x1 = x2;
+                subPathCloseY = y1 = y2;
+                continue;
+            }
+        }
+
+        ++subPathIndex;
+
+        closesSubPath = source != path.data.end()
+                         && *source == Path::closeSubPathMarker
+                         && x2 == subPathCloseX
+                         && y2 == subPathCloseY;
+
+        return true;
+    }
+}
+
 #if JUCE_MSVC && JUCE_DEBUG
   #pragma optimize ("", on)  // resets optimisations to the project defaults
 #endif
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class PathFlatteningIteratorTests  : public UnitTest
+{
+public:
+    PathFlatteningIteratorTests()  : UnitTest ("PathFlatteningIterator", "Graphics") {}
+
+    void runTest() override
+    {
+        auto wasFastFlatteningEnabled = PathFlatteningIterator::isFastCurveFlatteningEnabled();
+
+        beginTest ("Fast flattening is off by default");
+        expect (! wasFastFlatteningEnabled);
+
+        for (auto fast : { false, true })
+        {
+            PathFlatteningIterator::setFastCurveFlatteningEnabled (fast);
+            auto method = String (fast ? "fast" : "recursive") + " flattening";
+
+            beginTest ("Lines are unchanged with " + method);
+            {
+                Path p;
+                p.startNewSubPath (1.0f, 2.0f);
+                p.lineTo (10.0f, 2.5f);
+                p.lineTo (5.0f, 20.0f);
+                p.closeSubPath();
+
+                Array<Line<float>> expected { Line<float> (1.0f, 2.0f, 10.0f, 2.5f),
+                                              Line<float> (10.0f, 2.5f, 5.0f, 20.0f),
+                                              Line<float> (5.0f, 20.0f, 1.0f, 2.0f) };
+                expect (flatten (p, {}, 0.6f) == expected);
+            }
+
+            beginTest ("Curves are flattened within the tolerance with " + method);
+            {
+                auto random = getRandom();
+
+                for (int i = 0; i < 200; ++i)
+                {
+                    Point<float> points[4];
+
+                    for (auto& point : points)
+                        point = { random.nextFloat() * 200.0f - 100.0f, random.nextFloat() * 200.0f - 100.0f };
+
+                    auto isCubic = (i & 1) != 0;
+                    auto tolerance = (i % 3 == 0) ? 0.1f : ((i % 3 == 1) ? 0.6f : 2.0f);
+
+                    Path p;
+                    p.startNewSubPath (points[0]);
+
+                    if (isCubic)
+                        p.cubicTo (points[1], points[2], points[3]);
+                    else
+                        p.quadraticTo (points[1], points[2]);
+
+                    auto lines = flatten (p, {}, tolerance);
+                    auto end = isCubic ? points[3] : points[2];
+
+                    expect (lines.getFirst().getStart() == points[0]);
+                    expect (lines.getLast().getEnd() == end);
+
+                    for (int j = 1; j < lines.size(); ++j)
+                        expect (lines.getReference (j).getStart() == lines.getReference (j - 1).getEnd());
+
+                    auto maxDistance = 0.0f;
+
+                    for (int j = 0; j <= 500; ++j)
+                        maxDistance = jmax (maxDistance, getDistance (lines, getPointOnCurve (points, isCubic, j / 500.0)));
+
+                    // (allowing a little extra for rounding errors and the gaps between the samples)
+                    expectLessOrEqual (maxDistance, tolerance * 1.05f + 0.01f);
+                }
+            }
+
+            beginTest ("Transforms are applied with " + method);
+            {
+                Path p;
+                p.addEllipse (-10.0f, -10.0f, 20.0f, 20.0f);
+
+                auto transform = AffineTransform::scale (3.0f, 2.0f).translated (50.0f, 40.0f);
+
+                for (auto& line : flatten (p, transform, 0.2f))
+                {
+                    auto point = line.getEnd().transformedBy (transform.inverted());
+                    expectWithinAbsoluteError (point.x * point.x + point.y * point.y, 100.0f, 2.0f);
+                }
+            }
+        }
+
+        PathFlatteningIterator::setFastCurveFlatteningEnabled (wasFastFlatteningEnabled);
+    }
+
+private:
+    static Array<Line<float>> flatten (const Path& p, const AffineTransform& transform, float tolerance)
+    {
+        Array<Line<float>> lines;
+
+        for (PathFlatteningIterator i (p, transform, tolerance); i.next();)
+            lines.add ({ i.x1, i.y1, i.x2, i.y2 });
+
+        return lines;
+    }
+
+    static Point<float> getPointOnCurve (const Point<float>* points, bool isCubic, double t)
+    {
+        auto u = 1.0 - t;
+        double weights[] = { u * u, 2.0 * u * t, t * t, 0.0 };
+
+        if (isCubic)
+        {
+            weights[0] = u * u * u;
+            weights[1] = 3.0 * u * u * t;
+            weights[2] = 3.0 * u * t * t;
+            weights[3] = t * t * t;
+        }
+
+        double x = 0, y = 0;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            x += weights[i] * points[i].x;
+            y += weights[i] * points[i].y;
+        }
+
+        return { (float) x, (float) y };
+    }
+
+    static float getDistance (const Array<Line<float>>& lines, Point<float> point)
+    {
+        auto distance = std::numeric_limits<float>::max();
+        Point<float> pointOnLine;
+
+        for (auto& line : lines)
+            distance = jmin (distance, line.getDistanceFromPoint (point, pointOnLine));
+
+        return distance;
+    }
+};
+
+static PathFlatteningIteratorTests pathFlatteningIteratorTests;
+
+#endif
+
 } // namespace juce
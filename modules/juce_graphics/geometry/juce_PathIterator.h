@@ -93,19 +93,51 @@ public:
     /** Returns true if the current segment is the last in the current sub-path. */
     bool isLastInSubpath() const noexcept;
 
+    //==============================================================================
+    /** Chooses the way that curves are broken down into lines by all the iterators
+        that are created after this call.
+
+        By default, each curve is recursively split in half until its pieces are flat
+        enough. When fast flattening is enabled, the number of lines is worked out in
+        advance from the curve's shape, and the points are evaluated directly, which is
+        several times quicker.
+
+        The two methods produce slightly different lines, so anti-aliased curves may be
+        rendered with small differences in their edge pixels, and the lengths and
+        positions measured along a path may change very slightly. That's why this is
+        disabled unless you turn it on.
+    */
+    static void setFastCurveFlatteningEnabled (bool shouldBeEnabled) noexcept;
+
+    /** Returns true if fast curve flattening has been turned on.
+        @see setFastCurveFlatteningEnabled
+    */
+    static bool isFastCurveFlatteningEnabled() noexcept;
+
 private:
     //==============================================================================
     const Path& path;
     const AffineTransform transform;
     const float* source;
-    const float toleranceSquared;
+    const float toleranceSquared, tolerance;
     float subPathCloseX = 0, subPathCloseY = 0;
-    const bool isIdentityTransform;
+    const bool isIdentityTransform, usesFixedSteps;
 
     HeapBlock<float> stackBase { 32 };
     float* stackPos;
     size_t stackSize = 32;
 
+    // the polynomial coefficients of the curve that is currently being split up
+    float curveX0 = 0, curveY0 = 0, curveX1 = 0, curveY1 = 0,
+          curveX2 = 0, curveY2 = 0, curveX3 = 0, curveY3 = 0,
+          curveEndX = 0, curveEndY = 0;
+    int curveSegment = 0, numCurveSegments = 0;
+
+    bool nextBySubdivision();
+    bool nextByFixedSteps();
+    void startCurve (float c1x, float c1y, float c2x, float c2y, float c3x, float c3y,
+                     float endX, float endY, float secondDifferenceSquared, float scale) noexcept;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PathFlatteningIterator)
 };
 
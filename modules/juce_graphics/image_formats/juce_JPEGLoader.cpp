@@ -238,6 +238,12 @@ void JPEGImageFormat::setQuality (const float newQuality)
     quality = newQuality;
 }
 
+void JPEGImageFormat::setMaximumDecodedSize (int maxWidth, int maxHeight)
+{
+    maxDecodedWidth  = jmax (0, maxWidth);
+    maxDecodedHeight = jmax (0, maxHeight);
+}
+
 String JPEGImageFormat::getFormatName()                   { return "JPEG"; }
 bool JPEGImageFormat::usesFileExtension (const File& f)   { return f.hasFileExtension ("jpeg;jpg"); }
 
@@ -308,6 +314,28 @@ Image JPEGImageFormat::decodeImage (InputStream& in)
 
         if (! hasFailed)
         {
+            if (maxDecodedWidth > 0 || maxDecodedHeight > 0)
+            {
+                auto scale = 1.0;
+
+                if (maxDecodedWidth > 0)
+                    scale = jmin (scale, maxDecodedWidth / (double) jmax (1u, (unsigned int) jpegDecompStruct.image_width));
+
+                if (maxDecodedHeight > 0)
+                    scale = jmin (scale, maxDecodedHeight / (double) jmax (1u, (unsigned int) jpegDecompStruct.image_height));
+
+                // the IDCT can scale by 1/2, 1/4 or 1/8 - use the smallest that's still big enough
+                for (unsigned int denom = 8; denom > 1; denom /= 2)
+                {
+                    if (1.0 / denom >= scale)
+                    {
+                        jpegDecompStruct.scale_num = 1;
+                        jpegDecompStruct.scale_denom = denom;
+                        break;
+                    }
+                }
+            }
+
             jpeg_calc_output_dimensions (&jpegDecompStruct);
 
             if (! hasFailed)
@@ -302,6 +302,9 @@ Image Image::rescaled (int newWidth, int newHeight, Graphics::ResamplingQuality
     if (image == nullptr || (image->width == newWidth && image->height == newHeight))
         return *this;
 
+    if (quality == Graphics::highResamplingQuality && newWidth > 0 && newHeight > 0)
+        return ImageOperations::resampled (*this, newWidth, newHeight, ImageOperations::lanczos3);
+
     const std::unique_ptr<ImageType> type (image->createType());
     Image newImage (type->create (image->pixelFormat, newWidth, newHeight, hasAlphaChannel()));
 
@@ -322,6 +325,19 @@ Image Image::convertedToFormat (PixelFormat newFormat) const
     const std::unique_ptr<ImageType> type (image->createType());
     Image newImage (type->create (newFormat, w, h, false));
 
+    // Converts the pixels of each line with the given function, splitting the lines among several threads
+    auto convertLines = [&] (std::function<void (const uint8* src, uint8* dest)> convertLine)
+    {
+        const BitmapData destData (newImage, 0, 0, w, h, BitmapData::writeOnly);
+        const BitmapData srcData (*this, 0, 0, w, h);
+
+        ImageOperationHelpers::processInParallel (h, w, [&] (int startY, int endY)
+        {
+            for (int y = startY; y < endY; ++y)
+                convertLine (srcData.getLinePointer (y), destData.getLinePointer (y));
+        });
+    };
+
     if (newFormat == SingleChannel)
     {
         if (! hasAlphaChannel())
@@ -330,32 +346,48 @@ Image Image::convertedToFormat (PixelFormat newFormat) const
         }
         else
         {
-            const BitmapData destData (newImage, 0, 0, w, h, BitmapData::writeOnly);
-            const BitmapData srcData (*this, 0, 0, w, h);
-
-            for (int y = 0; y < h; ++y)
+            convertLines ([w] (const uint8* srcLine, uint8* dst)
             {
-                auto src = reinterpret_cast<const PixelARGB*> (srcData.getLinePointer (y));
-                auto dst = destData.getLinePointer (y);
+                auto src = reinterpret_cast<const PixelARGB*> (srcLine);
 
                 for (int x = 0; x < w; ++x)
                     dst[x] = src[x].getAlpha();
-            }
+            });
         }
     }
     else if (image->pixelFormat == SingleChannel && newFormat == Image::ARGB)
     {
-        const BitmapData destData (newImage, 0, 0, w, h, BitmapData::writeOnly);
-        const BitmapData srcData (*this, 0, 0, w, h);
+        convertLines ([w] (const uint8* srcLine, uint8* destLine)
+        {
+            auto src = reinterpret_cast<const PixelAlpha*> (srcLine);
+            auto dst = reinterpret_cast<PixelARGB*> (destLine);
 
-        for (int y = 0; y < h; ++y)
+            for (int x = 0; x < w; ++x)
+                dst[x].set (src[x]);
+        });
+    }
+    else if (image->pixelFormat == ARGB && newFormat == RGB)
+    {
+        // (this is the same as drawing the premultiplied pixels onto black)
+        convertLines ([w] (const uint8* srcLine, uint8* destLine)
         {
-            auto src = reinterpret_cast<const PixelAlpha*> (srcData.getLinePointer (y));
-            auto dst = reinterpret_cast<PixelARGB*> (destData.getLinePointer (y));
+            auto src = reinterpret_cast<const PixelARGB*> (srcLine);
+            auto dst = reinterpret_cast<PixelRGB*> (destLine);
 
             for (int x = 0; x < w; ++x)
                 dst[x].set (src[x]);
-        }
+        });
+    }
+    else if (image->pixelFormat == RGB && newFormat == ARGB)
+    {
+        convertLines ([w] (const uint8* srcLine, uint8* destLine)
+        {
+            auto src = reinterpret_cast<const PixelRGB*> (srcLine);
+            auto dst = reinterpret_cast<PixelARGB*> (destLine);
+
+            for (int x = 0; x < w; ++x)
+                dst[x].set (src[x]);
+        });
     }
     else
     {
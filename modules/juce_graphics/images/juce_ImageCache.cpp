@@ -31,7 +31,13 @@ struct ImageCache::Pimpl     : private Timer,
                                private DeletedAtShutdown
 {
     Pimpl() {}
-    ~Pimpl() override { clearSingletonInstance(); }
+
+    ~Pimpl() override
+    {
+        // (this needs to happen first, so that any jobs finish before the rest is deleted)
+        decodingThreads.reset();
+        clearSingletonInstance();
+    }
 
     JUCE_DECLARE_SINGLETON_SINGLETHREADED_MINIMAL (ImageCache::Pimpl)
 
@@ -39,17 +45,14 @@ struct ImageCache::Pimpl     : private Timer,
     {
         const ScopedLock sl (lock);
 
-        for (auto& item : images)
-        {
-            if (item.hashCode == hashCode)
-            {
-                item.lastUseTime = Time::getApproximateMillisecondCounter();
-                return item.image;
-            }
-        }
+        auto found = images.find (hashCode);
 
-        return {};
-     }
+        if (found == images.end())
+            return {};
+
+        markAsUsed (found->second, Time::getApproximateMillisecondCounter());
+        return found->second.image;
+    }
 
     void addImageToCache (const Image& image, const int64 hashCode)
     {
@@ -59,7 +62,21 @@ struct ImageCache::Pimpl     : private Timer,
                 startTimer (2000);
 
             const ScopedLock sl (lock);
-            images.add ({ image, hashCode, Time::getApproximateMillisecondCounter() });
+
+            auto found = images.find (hashCode);
+
+            if (found == images.end())
+            {
+                found = images.emplace (hashCode, Item()).first;
+                found->second.lruPosition = leastRecentlyUsed.insert (leastRecentlyUsed.end(), hashCode);
+            }
+
+            auto& item = found->second;
+            totalBytes += getSizeInBytes (image) - getSizeInBytes (item.image);
+            item.image = image;
+            markAsUsed (item, Time::getApproximateMillisecondCounter());
+
+            releaseImagesOverBudget();
         }
     }
 
@@ -69,22 +86,27 @@ struct ImageCache::Pimpl     : private Timer,
 
         const ScopedLock sl (lock);
 
-        for (int i = images.size(); --i >= 0;)
+        for (auto i = images.begin(); i != images.end();)
         {
-            auto& item = images.getReference(i);
+            auto& item = i->second;
 
             if (item.image.getReferenceCount() <= 1)
             {
                 if (now > item.lastUseTime + cacheTimeout || now < item.lastUseTime - 1000)
-                    images.remove (i);
+                {
+                    i = removeImage (i);
+                    continue;
+                }
             }
             else
             {
-                item.lastUseTime = now; // multiply-referenced, so this image is still in use.
+                markAsUsed (item, now); // multiply-referenced, so this image is still in use.
             }
+
+            ++i;
         }
 
-        if (images.isEmpty())
+        if (images.empty())
             stopTimer();
     }
 
@@ -92,21 +114,182 @@ struct ImageCache::Pimpl     : private Timer,
     {
         const ScopedLock sl (lock);
 
-        for (int i = images.size(); --i >= 0;)
-            if (images.getReference(i).image.getReferenceCount() <= 1)
-                images.remove (i);
+        for (auto i = images.begin(); i != images.end();)
+        {
+            if (i->second.image.getReferenceCount() <= 1)
+                i = removeImage (i);
+            else
+                ++i;
+        }
     }
 
+    void setMaximumCacheSize (int64 numBytes)
+    {
+        const ScopedLock sl (lock);
+        maximumBytes = numBytes;
+        releaseImagesOverBudget();
+    }
+
+    //==============================================================================
+    using Callback = std::function<void (const Image&)>;
+
+    void loadAsync (const File& file, int64 hashCode, int maxWidth, int maxHeight, Callback&& callback)
+    {
+        {
+            const ScopedLock sl (lock);
+
+            auto& callbacks = pendingLoads[hashCode];
+            auto isAlreadyLoading = ! callbacks.isEmpty();
+            callbacks.add (std::move (callback));
+
+            if (isAlreadyLoading)
+                return;
+
+            if (decodingThreads == nullptr)
+                decodingThreads.reset (new ThreadPool (jlimit (1, 4, SystemStats::getNumCpus() - 1)));
+        }
+
+        decodingThreads->addJob (new DecodingJob (*this, file, hashCode, maxWidth, maxHeight), true);
+    }
+
+    static Image decodeImage (const File& file, int maxWidth, int maxHeight)
+    {
+        FileInputStream stream (file);
+
+        if (! stream.openedOk())
+            return {};
+
+        Image image;
+        JPEGImageFormat jpeg;
+
+        if (jpeg.canUnderstand (stream))
+        {
+            stream.setPosition (0);
+            jpeg.setMaximumDecodedSize (maxWidth, maxHeight);
+            image = jpeg.decodeImage (stream);
+        }
+        else
+        {
+            stream.setPosition (0);
+            image = ImageFileFormat::loadFrom (stream);
+        }
+
+        if (image.isValid() && (maxWidth > 0 || maxHeight > 0))
+        {
+            auto scale = 1.0;
+
+            if (maxWidth > 0)   scale = jmin (scale, maxWidth  / (double) image.getWidth());
+            if (maxHeight > 0)  scale = jmin (scale, maxHeight / (double) image.getHeight());
+
+            if (scale < 1.0)
+                image = ImageOperations::resampled (image,
+                                                    jmax (1, roundToInt (image.getWidth()  * scale)),
+                                                    jmax (1, roundToInt (image.getHeight() * scale)),
+                                                    ImageOperations::areaAverage);
+        }
+
+        return image;
+    }
+
+    void imageDecoded (const Image& image, int64 hashCode)
+    {
+        addImageToCache (image, hashCode);
+
+        Array<Callback> callbacks;
+
+        {
+            const ScopedLock sl (lock);
+
+            auto found = pendingLoads.find (hashCode);
+
+            if (found == pendingLoads.end())
+                return;
+
+            callbacks.swapWith (found->second);
+            pendingLoads.erase (found);
+        }
+
+        MessageManager::callAsync ([image, callbacks]
+        {
+            for (auto& callback : callbacks)
+                if (callback != nullptr)
+                    callback (image);
+        });
+    }
+
+    struct DecodingJob  : public ThreadPoolJob
+    {
+        DecodingJob (Pimpl& p, const File& f, int64 hash, int w, int h)
+            : ThreadPoolJob ("Image decoder"), owner (p), file (f),
+              hashCode (hash), maxWidth (w), maxHeight (h)
+        {
+        }
+
+        JobStatus runJob() override
+        {
+            owner.imageDecoded (decodeImage (file, maxWidth, maxHeight), hashCode);
+            return jobHasFinished;
+        }
+
+        Pimpl& owner;
+        const File file;
+        const int64 hashCode;
+        const int maxWidth, maxHeight;
+
+        JUCE_DECLARE_NON_COPYABLE (DecodingJob)
+    };
+
+    //==============================================================================
     struct Item
     {
         Image image;
-        int64 hashCode;
-        uint32 lastUseTime;
+        uint32 lastUseTime = 0;
+        std::list<int64>::iterator lruPosition;
     };
 
-    Array<Item> images;
+    void markAsUsed (Item& item, uint32 now)
+    {
+        item.lastUseTime = now;
+        leastRecentlyUsed.splice (leastRecentlyUsed.end(), leastRecentlyUsed, item.lruPosition);
+    }
+
+    static int64 getSizeInBytes (const Image& image) noexcept
+    {
+        if (image.isNull())
+            return 0;
+
+        auto bytesPerPixel = image.isARGB() ? 4 : (image.isRGB() ? 3 : 1);
+        return (int64) image.getWidth() * image.getHeight() * bytesPerPixel;
+    }
+
+    std::unordered_map<int64, Item>::iterator removeImage (std::unordered_map<int64, Item>::iterator i)
+    {
+        totalBytes -= getSizeInBytes (i->second.image);
+        leastRecentlyUsed.erase (i->second.lruPosition);
+        return images.erase (i);
+    }
+
+    void releaseImagesOverBudget()
+    {
+        for (auto i = leastRecentlyUsed.begin(); totalBytes > maximumBytes && i != leastRecentlyUsed.end();)
+        {
+            auto found = images.find (*i++);
+            jassert (found != images.end());
+
+            if (found->second.image.getReferenceCount() <= 1)
+                removeImage (found);
+        }
+    }
+
+    std::unordered_map<int64, Item> images;
+    std::list<int64> leastRecentlyUsed;
+    std::unordered_map<int64, Array<Callback>> pendingLoads;
     CriticalSection lock;
     unsigned int cacheTimeout = 5000;
+    int64 totalBytes = 0, maximumBytes = 64 * 1024 * 1024;
+
+    // (created when the first asynchronous load is requested)
+    std::unique_ptr<ThreadPool> decodingThreads;
 
     JUCE_DECLARE_NON_COPYABLE (Pimpl)
 };
@@ -142,6 +325,25 @@ Image ImageCache::getFromFile (const File& file)
     return image;
 }
 
+Image ImageCache::getFromFileAsync (const File& file, std::function<void (const Image&)> callback,
+                                    int maxWidth, int maxHeight)
+{
+    maxWidth  = jmax (0, maxWidth);
+    maxHeight = jmax (0, maxHeight);
+
+    auto hashCode = file.hashCode64();
+
+    if (maxWidth > 0 || maxHeight > 0)
+        hashCode = (int64) ((uint64) hashCode * 101 + (((uint64) maxWidth << 32) | (uint64) maxHeight));
+
+    auto image = getFromHashCode (hashCode);
+
+    if (image.isNull())
+        Pimpl::getInstance()->loadAsync (file, hashCode, maxWidth, maxHeight, std::move (callback));
+
+    return image;
+}
+
 Image ImageCache::getFromMemory (const void* imageData, const int dataSize)
 {
     auto hashCode = (int64) (pointer_sized_int) imageData;
@@ -162,9 +364,105 @@ void ImageCache::setCacheTimeout (const int millisecs)
     Pimpl::getInstance()->cacheTimeout = (unsigned int) millisecs;
 }
 
+void ImageCache::setMaximumCacheSize (const int64 numBytes)
+{
+    jassert (numBytes >= 0);
+    Pimpl::getInstance()->setMaximumCacheSize (numBytes);
+}
+
 void ImageCache::releaseUnusedImages()
 {
     Pimpl::getInstance()->releaseUnusedImages();
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ImageCacheTests  : public UnitTest
+{
+public:
+    ImageCacheTests()  : UnitTest ("ImageCache", "Graphics") {}
+
+    void runTest() override
+    {
+        // (these are arbitrary hash codes that nothing else should be using)
+        const int64 a = 0x1234567800000001, b = a + 1, c = a + 2, d = a + 3;
+
+        beginTest ("Least recently used images are released first");
+        {
+            // Each image takes 100 bytes, so there's room for two of them.
+            ImageCache::setMaximumCacheSize (250);
+
+            ImageCache::addImageToCache (createImage(), a);
+            ImageCache::addImageToCache (createImage(), b);
+            expect (ImageCache::getFromHashCode (a).isValid());
+
+            ImageCache::addImageToCache (createImage(), c);
+            expect (ImageCache::getFromHashCode (a).isValid());
+            expect (! ImageCache::getFromHashCode (b).isValid());
+            expect (ImageCache::getFromHashCode (c).isValid());
+        }
+
+        beginTest ("Images that are in use are kept");
+        {
+            auto held = ImageCache::getFromHashCode (a);
+            expect (ImageCache::getFromHashCode (c).isValid());
+
+            ImageCache::addImageToCache (createImage(), d);
+            expect (ImageCache::getFromHashCode (a) == held);
+            expect (! ImageCache::getFromHashCode (c).isValid());
+            expect (ImageCache::getFromHashCode (d).isValid());
+
+            ImageCache::setMaximumCacheSize (0);
+            expect (ImageCache::getFromHashCode (a) == held);
+            expect (! ImageCache::getFromHashCode (d).isValid());
+
+            held = {};
+            ImageCache::releaseUnusedImages();
+            expect (! ImageCache::getFromHashCode (a).isValid());
+
+            ImageCache::setMaximumCacheSize (64 * 1024 * 1024);
+        }
+
+        beginTest ("Asynchronous loading");
+        {
+            TemporaryFile tempFile (".png");
+            auto file = tempFile.getFile();
+
+            {
+                FileOutputStream out (file);
+                PNGImageFormat png;
+                expect (png.writeImageToStream (Image (Image::RGB, 40, 20, true), out));
+            }
+
+            expect (! ImageCache::getFromFileAsync (file, nullptr).isValid());
+
+            // The image is added to the cache by a background thread before the callback happens..
+            Image image;
+
+            for (int i = 0; i < 500 && image.isNull(); ++i)
+            {
+                Thread::sleep (10);
+                image = ImageCache::getFromHashCode (file.hashCode64());
+            }
+
+            expect (image.getWidth() == 40 && image.getHeight() == 20);
+            expect (ImageCache::getFromFileAsync (file, nullptr) == image);
+
+            image = {};
+            ImageCache::releaseUnusedImages();
+        }
+    }
+
+private:
+    static Image createImage()
+    {
+        return Image (Image::SingleChannel, 10, 10, true);
+    }
+};
+
+static ImageCacheTests imageCacheTests;
+
+#endif
+
 } // namespace juce
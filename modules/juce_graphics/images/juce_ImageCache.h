@@ -81,6 +81,41 @@ public:
     */
     static Image getFromMemory (const void* imageData, int dataSize);
 
+    //==============================================================================
+    /** Loads an image from a file on a background thread, (or just returns the image
+        if it's already cached).
+
+        If the cache already contains this image, it is returned straight away and the
+        callback isn't used. Otherwise, this returns an invalid image that you can treat
+        as a placeholder, and the file is decoded by one of the cache's worker threads.
+        When that's done, the new image is added to the cache and the callback is called
+        on the message thread. If the file couldn't be loaded, the image passed to the
+        callback will be invalid.
+
+        If you ask for the same file more than once before it has finished loading, it
+        will only be decoded once, and all the callbacks will be given the same image.
+
+        If maxWidth or maxHeight are greater than zero, the image will be shrunk (keeping
+        its proportions) so that it fits within that size. This is a good way to make
+        thumbnails, because JPEG files can be scaled down while they're being decoded,
+        which is much faster than loading them at full size. Each size is cached
+        separately from the full-size image.
+
+        Because the callback may happen after the object that requested the image has
+        been deleted, it's a good idea to capture a Component::SafePointer or
+        WeakReference rather than a raw pointer.
+
+        @param file         the file to try to load
+        @param callback     a function to call on the message thread with the loaded image
+        @param maxWidth     if greater than 0, the maximum width of the image that is created
+        @param maxHeight    if greater than 0, the maximum height of the image that is created
+        @returns            the image if it was already cached, or an invalid image
+        @see getFromFile, ImageFileFormat::loadFrom, JPEGImageFormat::setMaximumDecodedSize
+    */
+    static Image getFromFileAsync (const File& file,
+                                   std::function<void (const Image&)> callback,
+                                   int maxWidth = 0, int maxHeight = 0);
+
     //==============================================================================
     /** Checks the cache for an image with a particular hashcode.
 
@@ -109,6 +144,16 @@ public:
     */
     static void setCacheTimeout (int millisecs);
 
+    /** Sets the amount of memory that the cache may use for images that nothing else
+        is using.
+
+        When the total size of the cached images goes beyond this, images that aren't
+        being referenced elsewhere are released straight away, least recently used first,
+        rather than waiting for the cache timeout. Images that are still in use are never
+        released. By default this is 64MB.
+    */
+    static void setMaximumCacheSize (int64 numBytes);
+
     /** Releases any images in the cache that aren't being referenced by active
         Image objects.
     */
@@ -103,10 +103,53 @@ void ImageConvolutionKernel::createGaussianBlur (const float radius)
 }
 
 //==============================================================================
+/*  If the kernel is the product of a column and a row of values, this finds them, so that
+    the kernel can be applied as two one-dimensional passes.
+*/
+static bool findSeparableParts (const float* values, int size, float* horizontal, float* vertical) noexcept
+{
+    int largestIndex = 0;
+
+    for (int i = 1; i < size * size; ++i)
+        if (std::abs (values[i]) > std::abs (values[largestIndex]))
+            largestIndex = i;
+
+    auto largest = values[largestIndex];
+
+    if (largest == 0)
+        return false;
+
+    auto column = largestIndex % size;
+    auto row = largestIndex / size;
+
+    for (int i = 0; i < size; ++i)
+    {
+        horizontal[i] = values[i + row * size] / largest;
+        vertical[i] = values[column + i * size];
+    }
+
+    auto tolerance = std::abs (largest) * 1.0e-5f;
+
+    for (int y = 0; y < size; ++y)
+        for (int x = 0; x < size; ++x)
+            if (std::abs (values[x + y * size] - horizontal[x] * vertical[y]) > tolerance)
+                return false;
+
+    return true;
+}
+
 void ImageConvolutionKernel::applyToImage (Image& destImage,
                                            const Image& sourceImage,
                                            const Rectangle<int>& destinationArea) const
 {
+    HeapBlock<float> horizontal ((size_t) size), vertical ((size_t) size);
+
+    if (findSeparableParts (values, size, horizontal, vertical))
+    {
+        ImageOperations::applySeparableKernel (destImage, sourceImage, destinationArea, horizontal, vertical, size);
+        return;
+    }
+
     if (sourceImage == destImage)
     {
         destImage.duplicateIfShared();
@@ -127,171 +170,51 @@ void ImageConvolutionKernel::applyToImage (Image& destImage,
     if (area.isEmpty())
         return;
 
-    auto right = area.getRight();
-    auto bottom = area.getBottom();
+    // The lines are rendered in parallel, so if the source and destination share their
+    // pixels, the source has to be copied to keep the lines being read intact.
+    auto source = (sourceImage == destImage) ? sourceImage.createCopy() : sourceImage;
 
     const Image::BitmapData destData (destImage, area.getX(), area.getY(), area.getWidth(), area.getHeight(),
                                       Image::BitmapData::writeOnly);
-    uint8* line = destData.data;
+    const Image::BitmapData srcData (source, Image::BitmapData::readOnly);
+    auto numChannels = srcData.pixelStride;
+    auto centre = size >> 1;
 
-    const Image::BitmapData srcData (sourceImage, Image::BitmapData::readOnly);
-
-    if (destData.pixelStride == 4)
+    ImageOperationHelpers::processInParallel (area.getHeight(), area.getWidth() * size * size, [&] (int startY, int endY)
     {
-        for (int y = area.getY(); y < bottom; ++y)
-        {
-            uint8* dest = line;
-            line += destData.lineStride;
-
-            for (int x = area.getX(); x < right; ++x)
-            {
-                float c1 = 0;
-                float c2 = 0;
-                float c3 = 0;
-                float c4 = 0;
-
-                for (int yy = 0; yy < size; ++yy)
-                {
-                    const int sy = y + yy - (size >> 1);
-
-                    if (sy >= srcData.height)
-                        break;
+        using ImageOperationHelpers::PixelFloats;
 
-                    if (sy >= 0)
-                    {
-                        int sx = x - (size >> 1);
-                        const uint8* src = srcData.getPixelPointer (sx, sy);
-
-                        for (int xx = 0; xx < size; ++xx)
-                        {
-                            if (sx >= srcData.width)
-                                break;
-
-                            if (sx >= 0)
-                            {
-                                const float kernelMult = values [xx + yy * size];
-                                c1 += kernelMult * *src++;
-                                c2 += kernelMult * *src++;
-                                c3 += kernelMult * *src++;
-                                c4 += kernelMult * *src++;
-                            }
-                            else
-                            {
-                                src += 4;
-                            }
-
-                            ++sx;
-                        }
-                    }
-                }
-
-                *dest++ = (uint8) jmin (0xff, roundToInt (c1));
-                *dest++ = (uint8) jmin (0xff, roundToInt (c2));
-                *dest++ = (uint8) jmin (0xff, roundToInt (c3));
-                *dest++ = (uint8) jmin (0xff, roundToInt (c4));
-            }
-        }
-    }
-    else if (destData.pixelStride == 3)
-    {
-        for (int y = area.getY(); y < bottom; ++y)
+        for (int y = startY; y < endY; ++y)
         {
-            uint8* dest = line;
-            line += destData.lineStride;
+            auto* dest = destData.getLinePointer (y);
 
-            for (int x = area.getX(); x < right; ++x)
+            for (int x = area.getX(); x < area.getRight(); ++x)
             {
-                float c1 = 0;
-                float c2 = 0;
-                float c3 = 0;
+                auto total = PixelFloats::zero();
 
                 for (int yy = 0; yy < size; ++yy)
                 {
-                    const int sy = y + yy - (size >> 1);
+                    auto sy = area.getY() + y + yy - centre;
 
                     if (sy >= srcData.height)
                         break;
 
-                    if (sy >= 0)
-                    {
-                        int sx = x - (size >> 1);
-                        const uint8* src = srcData.getPixelPointer (sx, sy);
-
-                        for (int xx = 0; xx < size; ++xx)
-                        {
-                            if (sx >= srcData.width)
-                                break;
-
-                            if (sx >= 0)
-                            {
-                                const float kernelMult = values [xx + yy * size];
-                                c1 += kernelMult * *src++;
-                                c2 += kernelMult * *src++;
-                                c3 += kernelMult * *src++;
-                            }
-                            else
-                            {
-                                src += 3;
-                            }
-
-                            ++sx;
-                        }
-                    }
-                }
+                    if (sy < 0)
+                        continue;
 
-                *dest++ = (uint8) roundToInt (c1);
-                *dest++ = (uint8) roundToInt (c2);
-                *dest++ = (uint8) roundToInt (c3);
-            }
-        }
-    }
-    else if (destData.pixelStride == 1)
-    {
-        for (int y = area.getY(); y < bottom; ++y)
-        {
-            uint8* dest = line;
-            line += destData.lineStride;
-
-            for (int x = area.getX(); x < right; ++x)
-            {
-                float c1 = 0;
-
-                for (int yy = 0; yy < size; ++yy)
-                {
-                    const int sy = y + yy - (size >> 1);
-
-                    if (sy >= srcData.height)
-                        break;
+                    auto* src = srcData.getLinePointer (sy);
+                    auto sx = x - centre;
 
-                    if (sy >= 0)
-                    {
-                        int sx = x - (size >> 1);
-                        const uint8* src = srcData.getPixelPointer (sx, sy);
-
-                        for (int xx = 0; xx < size; ++xx)
-                        {
-                            if (sx >= srcData.width)
-                                break;
-
-                            if (sx >= 0)
-                            {
-                                const float kernelMult = values [xx + yy * size];
-                                c1 += kernelMult * *src++;
-                            }
-                            else
-                            {
-                                src += 3;
-                            }
-
-                            ++sx;
-                        }
-                    }
+                    for (int xx = jmax (0, -sx); xx < size && sx + xx < srcData.width; ++xx)
+                        total.addWeighted (PixelFloats::loadPixel (src + (sx + xx) * numChannels, numChannels),
+                                           values[xx + yy * size]);
                 }
 
-                *dest++ = (uint8) roundToInt (c1);
+                total.storePixel (dest, numChannels);
+                dest += destData.pixelStride;
             }
         }
-    }
+    });
 }
 
 } // namespace juce
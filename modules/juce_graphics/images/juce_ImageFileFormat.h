@@ -187,6 +187,18 @@ public:
     */
     void setQuality (float newQuality);
 
+    /** Asks the decoder to produce a smaller image than the one stored in the file.
+
+        When decoding, the image will be scaled down by 1/2, 1/4 or 1/8, choosing the
+        smallest of these that is still at least big enough to fill the given size
+        while keeping its proportions. This scaling is done as part of the decoding
+        itself, so it's much quicker than loading the full image and then resizing it.
+
+        Pass 0 for either dimension to leave it unconstrained. By default both are 0,
+        and images are decoded at their original size.
+    */
+    void setMaximumDecodedSize (int maxWidth, int maxHeight);
+
     //==============================================================================
     String getFormatName() override;
     bool usesFileExtension (const File&) override;
@@ -196,6 +208,7 @@ public:
 
 private:
     float quality;
+    int maxDecodedWidth = 0, maxDecodedHeight = 0;
 };
 
 //==============================================================================
@@ -0,0 +1,967 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+namespace ImageOperationHelpers
+{
+    //==============================================================================
+    enum { minPixelsPerThread = 32768 };
+
+    /*  Calls processRange (start, end) for a set of ranges that together cover the items
+        0 to numItems. If there's enough work, the ranges are shared out among the software
+        renderer's threads.
+    */
+    template <typename RangeFunction>
+    static void processInParallel (int numItems, int pixelsPerItem, RangeFunction&& processRange)
+    {
+        auto numThreads = (int) jmin ((int64) SystemStats::getNumCpus(), (int64) numItems,
+                                      (int64) numItems * pixelsPerItem / (int64) minPixelsPerThread);
+
+        // (jobs that started more jobs and waited for them could deadlock the pool)
+        if (numThreads <= 1 || ThreadPoolJob::getCurrentThreadPoolJob() != nullptr)
+        {
+            if (numItems > 0)
+                processRange (0, numItems);
+
+            return;
+        }
+
+        auto numChunks = jmin (numItems, numThreads * 4);
+        std::atomic<int> nextChunk { 0 };
+
+        auto processChunks = [&]
+        {
+            for (;;)
+            {
+                auto chunk = nextChunk++;
+
+                if (chunk >= numChunks)
+                    break;
+
+                processRange ((int) ((int64) numItems * chunk / numChunks),
+                              (int) ((int64) numItems * (chunk + 1) / numChunks));
+            }
+        };
+
+        auto numJobs = numThreads - 1;
+        std::atomic<int> numJobsRunning { numJobs };
+        WaitableEvent jobsFinished;
+
+        for (int i = 0; i < numJobs; ++i)
+        {
+            RenderingHelpers::SoftwareRendererThreadPool::getInstance()->addJob ([&]
+            {
+                processChunks();
+
+                if (--numJobsRunning == 0)
+                    jobsFinished.signal();
+            });
+        }
+
+        processChunks();
+        jobsFinished.wait();
+    }
+
+    //==============================================================================
+    /*  Holds the channels of a pixel as floats, so that weighted sums of pixels can
+        be calculated with one SIMD operation per pixel.
+    */
+    struct PixelFloats
+    {
+       #if JUCE_USE_SSE_INTRINSICS
+        __m128 value;
+
+        static forcedinline PixelFloats zero() noexcept             { return { _mm_setzero_ps() }; }
+        static forcedinline PixelFloats load (const float* src) noexcept  { return { _mm_loadu_ps (src) }; }
+        forcedinline void store (float* dest) const noexcept        { _mm_storeu_ps (dest, value); }
+
+        static forcedinline PixelFloats loadPixel (const uint8* src, int numChannels) noexcept
+        {
+            auto bytes = numChannels == 4 ? readUnaligned<int> (src)
+                                          : (numChannels == 3 ? (src[0] | (src[1] << 8) | (src[2] << 16))
+                                                              : (int) src[0]);
+            auto zeros = _mm_setzero_si128();
+            auto ints = _mm_unpacklo_epi16 (_mm_unpacklo_epi8 (_mm_cvtsi32_si128 (bytes), zeros), zeros);
+            return { _mm_cvtepi32_ps (ints) };
+        }
+
+        forcedinline void addWeighted (PixelFloats other, float weight) noexcept
+        {
+            value = _mm_add_ps (value, _mm_mul_ps (other.value, _mm_set1_ps (weight)));
+        }
+
+        forcedinline void storePixel (uint8* dest, int numChannels) const noexcept
+        {
+            auto shorts = _mm_packs_epi32 (_mm_cvtps_epi32 (value), _mm_setzero_si128());
+            writeBytes (dest, (uint32) _mm_cvtsi128_si32 (_mm_packus_epi16 (shorts, shorts)), numChannels);
+        }
+
+       #elif JUCE_USE_ARM_NEON
+        float32x4_t value;
+
+        static forcedinline PixelFloats zero() noexcept             { return { vdupq_n_f32 (0) }; }
+        static forcedinline PixelFloats load (const float* src) noexcept  { return { vld1q_f32 (src) }; }
+        forcedinline void store (float* dest) const noexcept        { vst1q_f32 (dest, value); }
+
+        static forcedinline PixelFloats loadPixel (const uint8* src, int numChannels) noexcept
+        {
+            const uint32_t channels[] = { src[0],
+                                          numChannels > 1 ? src[1] : 0u,
+                                          numChannels > 2 ? src[2] : 0u,
+                                          numChannels > 3 ? src[3] : 0u };
+            return { vcvtq_f32_u32 (vld1q_u32 (channels)) };
+        }
+
+        forcedinline void addWeighted (PixelFloats other, float weight) noexcept
+        {
+            value = vmlaq_n_f32 (value, other.value, weight);
+        }
+
+        forcedinline void storePixel (uint8* dest, int numChannels) const noexcept
+        {
+            auto rounded = vcvtq_u32_f32 (vaddq_f32 (vmaxq_f32 (value, vdupq_n_f32 (0)), vdupq_n_f32 (0.5f)));
+            auto bytes = vqmovn_u16 (vcombine_u16 (vqmovn_u32 (rounded), vdup_n_u16 (0)));
+            writeBytes (dest, vget_lane_u32 (vreinterpret_u32_u8 (bytes), 0), numChannels);
+        }
+
+       #else
+        float value[4];
+
+        static forcedinline PixelFloats zero() noexcept             { return { { 0, 0, 0, 0 } }; }
+        static forcedinline PixelFloats load (const float* src) noexcept  { return { { src[0], src[1], src[2], src[3] } }; }
+        forcedinline void store (float* dest) const noexcept        { for (int i = 0; i < 4; ++i) dest[i] = value[i]; }
+
+        static forcedinline PixelFloats loadPixel (const uint8* src, int numChannels) noexcept
+        {
+            PixelFloats p (zero());
+
+            for (int i = 0; i < numChannels; ++i)
+                p.value[i] = src[i];
+
+            return p;
+        }
+
+        forcedinline void addWeighted (PixelFloats other, float weight) noexcept
+        {
+            for (int i = 0; i < 4; ++i)
+                value[i] += other.value[i] * weight;
+        }
+
+        forcedinline void storePixel (uint8* dest, int numChannels) const noexcept
+        {
+            for (int i = 0; i < numChannels; ++i)
+                dest[i] = (uint8) jlimit (0, 255, roundToInt (value[i]));
+        }
+       #endif
+
+       #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+        static forcedinline void writeBytes (uint8* dest, uint32 bytes, int numChannels) noexcept
+        {
+            if (numChannels == 4)
+            {
+                writeUnaligned (dest, ByteOrder::swapIfBigEndian (bytes));
+            }
+            else
+            {
+                for (int i = 0; i < numChannels; ++i)
+                    dest[i] = (uint8) (bytes >> (8 * i));
+            }
+        }
+       #endif
+    };
+
+    //==============================================================================
+    /*  After a filter with negative lobes, the colour components of a premultiplied
+        pixel can end up larger than its alpha.
+    */
+    static void clampToAlpha (uint8* line, int numPixels) noexcept
+    {
+        auto* pixels = reinterpret_cast<PixelARGB*> (line);
+
+        for (int i = 0; i < numPixels; ++i)
+        {
+            auto& p = pixels[i];
+            auto alpha = p.getAlpha();
+
+            p.setARGB (alpha, jmin (alpha, p.getRed()), jmin (alpha, p.getGreen()), jmin (alpha, p.getBlue()));
+        }
+    }
+
+    //==============================================================================
+    /*  For each pixel along one axis of a resampled image, this holds the range of source
+        pixels that contribute to it, and their weights.
+    */
+    struct ResamplingWeights
+    {
+        ResamplingWeights (int sourceSize, int destSize, ImageOperations::ResamplingFilter filter)
+            : firstSource ((size_t) destSize), numSources ((size_t) destSize)
+        {
+            auto scale = destSize / (double) sourceSize;
+            auto filterScale = jmax (1.0, 1.0 / scale);
+            auto support = filter == ImageOperations::lanczos3 ? 3.0 * filterScale : 0.5 / scale + 1.0;
+
+            stride = (int) std::ceil (support * 2.0) + 2;
+            weights.resize ((size_t) (destSize * stride));
+
+            for (int i = 0; i < destSize; ++i)
+            {
+                auto centre = (i + 0.5) / scale;
+                auto first = (int) std::floor (centre - support);
+                auto last  = (int) std::ceil  (centre + support);
+                auto clippedFirst = jlimit (0, sourceSize - 1, first);
+                auto clippedLast  = jlimit (0, sourceSize - 1, last);
+
+                jassert (clippedLast - clippedFirst < stride);
+
+                auto* w = weights.data() + i * stride;
+                double total = 0;
+
+                for (int j = first; j <= last; ++j)
+                {
+                    double weight;
+
+                    if (filter == ImageOperations::lanczos3)
+                    {
+                        weight = lanczos3Kernel ((j + 0.5 - centre) / filterScale);
+                    }
+                    else
+                    {
+                        // the amount of source pixel j that's covered by this destination pixel
+                        weight = jmax (0.0, jmin ((double) (j + 1), (i + 1) / scale)
+                                              - jmax ((double) j, i / scale));
+                    }
+
+                    w[jlimit (0, sourceSize - 1, j) - clippedFirst] += (float) weight;
+                    total += weight;
+                }
+
+                if (total != 0)
+                    for (int j = 0; j <= clippedLast - clippedFirst; ++j)
+                        w[j] = (float) (w[j] / total);
+
+                firstSource[(size_t) i] = clippedFirst;
+                numSources[(size_t) i] = clippedLast - clippedFirst + 1;
+            }
+        }
+
+        const float* getWeights (int index) const noexcept    { return weights.data() + index * stride; }
+
+        static double lanczos3Kernel (double x) noexcept
+        {
+            if (x == 0)
+                return 1.0;
+
+            if (x <= -3.0 || x >= 3.0)
+                return 0;
+
+            auto px = MathConstants<double>::pi * x;
+            return 3.0 * std::sin (px) * std::sin (px / 3.0) / (px * px);
+        }
+
+        std::vector<int> firstSource, numSources;
+        std::vector<float> weights;
+        int stride;
+    };
+
+    //==============================================================================
+    /*  The running sums for box-blurring a strip of bytes down the columns of an image. */
+    static void addRowToSums (int32* sums, const uint8* row, int num) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        auto zeros = _mm_setzero_si128();
+
+        for (; i < num - 3; i += 4)
+        {
+            auto values = _mm_unpacklo_epi16 (_mm_unpacklo_epi8 (_mm_cvtsi32_si128 (readUnaligned<int> (row + i)), zeros), zeros);
+            _mm_storeu_si128 ((__m128i*) (sums + i), _mm_add_epi32 (_mm_loadu_si128 ((const __m128i*) (sums + i)), values));
+        }
+       #endif
+
+        for (; i < num; ++i)
+            sums[i] += row[i];
+    }
+
+    static void subtractRowFromSums (int32* sums, const uint8* row, int num) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        auto zeros = _mm_setzero_si128();
+
+        for (; i < num - 3; i += 4)
+        {
+            auto values = _mm_unpacklo_epi16 (_mm_unpacklo_epi8 (_mm_cvtsi32_si128 (readUnaligned<int> (row + i)), zeros), zeros);
+            _mm_storeu_si128 ((__m128i*) (sums + i), _mm_sub_epi32 (_mm_loadu_si128 ((const __m128i*) (sums + i)), values));
+        }
+       #endif
+
+        for (; i < num; ++i)
+            sums[i] -= row[i];
+    }
+
+    static void writeAverages (uint8* dest, const int32* sums, int num, float scale) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        auto scales = _mm_set1_ps (scale);
+
+        for (; i < num - 3; i += 4)
+        {
+            auto values = _mm_cvtps_epi32 (_mm_mul_ps (_mm_cvtepi32_ps (_mm_loadu_si128 ((const __m128i*) (sums + i))), scales));
+            auto shorts = _mm_packs_epi32 (values, values);
+            writeUnaligned (dest + i, _mm_cvtsi128_si32 (_mm_packus_epi16 (shorts, shorts)));
+        }
+       #endif
+
+        for (; i < num; ++i)
+            dest[i] = (uint8) jmin (255, roundToInt ((float) sums[i] * scale));
+    }
+
+    static void boxBlurRows (const Image::BitmapData& data, int radius)
+    {
+        auto numChannels = data.pixelStride;
+        auto width = data.width;
+        auto scale = 1.0f / (float) (radius * 2 + 1);
+
+        processInParallel (data.height, width, [&] (int startY, int endY)
+        {
+            HeapBlock<uint8> original ((size_t) (width * numChannels));
+
+            for (int y = startY; y < endY; ++y)
+            {
+                auto* line = data.getLinePointer (y);
+                memcpy (original, line, (size_t) (width * numChannels));
+
+                for (int c = 0; c < numChannels; ++c)
+                {
+                    auto* src = original + c;
+                    auto* dest = line + c;
+                    int32 sum = 0;
+
+                    for (int x = 0; x <= jmin (radius, width - 1); ++x)
+                        sum += src[x * numChannels];
+
+                    for (int x = 0; x < width; ++x)
+                    {
+                        dest[x * numChannels] = (uint8) jmin (255, roundToInt ((float) sum * scale));
+
+                        if (x + radius + 1 < width)
+                            sum += src[(x + radius + 1) * numChannels];
+
+                        if (x - radius >= 0)
+                            sum -= src[(x - radius) * numChannels];
+                    }
+                }
+            }
+        });
+    }
+
+    static void boxBlurColumns (const Image::BitmapData& data, int radius)
+    {
+        auto rowBytes = data.width * data.pixelStride;
+        auto height = data.height;
+        auto scale = 1.0f / (float) (radius * 2 + 1);
+        auto numSavedRows = radius + 1;
+
+        // The columns are split into strips of bytes, each of which is blurred from top to
+        // bottom, keeping copies of the last few rows that have been overwritten.
+        processInParallel (rowBytes, height, [&] (int start, int end)
+        {
+            auto num = end - start;
+            HeapBlock<int32> sums ((size_t) num, true);
+            HeapBlock<uint8> savedRows ((size_t) (num * numSavedRows));
+
+            for (int y = 0; y <= jmin (radius, height - 1); ++y)
+                addRowToSums (sums, data.getLinePointer (y) + start, num);
+
+            for (int y = 0; y < height; ++y)
+            {
+                auto* line = data.getLinePointer (y) + start;
+                memcpy (savedRows + (y % numSavedRows) * num, line, (size_t) num);
+
+                writeAverages (line, sums, num, scale);
+
+                if (y + radius + 1 < height)
+                    addRowToSums (sums, data.getLinePointer (y + radius + 1) + start, num);
+
+                if (y - radius >= 0)
+                    subtractRowFromSums (sums, savedRows + ((y - radius) % numSavedRows) * num, num);
+            }
+        });
+    }
+}
+
+//==============================================================================
+Image ImageOperations::resampled (const Image& sourceImage, int newWidth, int newHeight, ResamplingFilter filter)
+{
+    using namespace ImageOperationHelpers;
+
+    if (! sourceImage.isValid() || newWidth <= 0 || newHeight <= 0)
+        return {};
+
+    auto sourceWidth = sourceImage.getWidth();
+    auto sourceHeight = sourceImage.getHeight();
+
+    const std::unique_ptr<ImageType> type (sourceImage.getPixelData()->createType());
+    Image newImage (type->create (sourceImage.getFormat(), newWidth, newHeight, false));
+
+    const Image::BitmapData srcData (sourceImage, Image::BitmapData::readOnly);
+    const Image::BitmapData destData (newImage, Image::BitmapData::writeOnly);
+    auto numChannels = srcData.pixelStride;
+
+    const ResamplingWeights horizontal (sourceWidth, newWidth, filter);
+    const ResamplingWeights vertical (sourceHeight, newHeight, filter);
+
+    // The rows are first resampled horizontally into a buffer of floats..
+    HeapBlock<float> rows ((size_t) (newWidth * sourceHeight * 4));
+
+    processInParallel (sourceHeight, newWidth, [&] (int startY, int endY)
+    {
+        for (int y = startY; y < endY; ++y)
+        {
+            auto* src = srcData.getLinePointer (y);
+            auto* dest = rows + y * newWidth * 4;
+
+            for (int x = 0; x < newWidth; ++x)
+            {
+                auto* weights = horizontal.getWeights (x);
+                auto* srcPixel = src + horizontal.firstSource[(size_t) x] * numChannels;
+                auto total = PixelFloats::zero();
+
+                for (int i = 0; i < horizontal.numSources[(size_t) x]; ++i)
+                    total.addWeighted (PixelFloats::loadPixel (srcPixel + i * numChannels, numChannels), weights[i]);
+
+                total.store (dest + x * 4);
+            }
+        }
+    });
+
+    // ..and then the columns are resampled from that into the new image.
+    processInParallel (newHeight, sourceHeight * newWidth / newHeight + newWidth, [&] (int startY, int endY)
+    {
+        HeapBlock<float> totals ((size_t) (newWidth * 4));
+
+        for (int y = startY; y < endY; ++y)
+        {
+            auto* weights = vertical.getWeights (y);
+            auto firstRow = vertical.firstSource[(size_t) y];
+
+            totals.clear ((size_t) (newWidth * 4));
+
+            for (int i = 0; i < vertical.numSources[(size_t) y]; ++i)
+            {
+                auto* row = rows + (firstRow + i) * newWidth * 4;
+
+                for (int x = 0; x < newWidth * 4; x += 4)
+                {
+                    auto total = PixelFloats::load (totals + x);
+                    total.addWeighted (PixelFloats::load (row + x), weights[i]);
+                    total.store (totals + x);
+                }
+            }
+
+            auto* dest = destData.getLinePointer (y);
+
+            for (int x = 0; x < newWidth; ++x)
+                PixelFloats::load (totals + x * 4).storePixel (dest + x * numChannels, numChannels);
+
+            if (filter == lanczos3 && newImage.isARGB() && numChannels == 4)
+                clampToAlpha (dest, newWidth);
+        }
+    });
+
+    return newImage;
+}
+
+//==============================================================================
+void ImageOperations::applySeparableKernel (Image& destImage, const Image& sourceImage, Rectangle<int> destinationArea,
+                                            const float* horizontalKernel, const float* verticalKernel, int kernelSize)
+{
+    using namespace ImageOperationHelpers;
+
+    if (sourceImage == destImage)
+    {
+        destImage.duplicateIfShared();
+    }
+    else
+    {
+        if (sourceImage.getWidth() != destImage.getWidth()
+             || sourceImage.getHeight() != destImage.getHeight()
+             || sourceImage.getFormat() != destImage.getFormat())
+        {
+            jassertfalse;
+            return;
+        }
+    }
+
+    auto area = destinationArea.getIntersection (destImage.getBounds());
+
+    if (area.isEmpty() || kernelSize <= 0)
+        return;
+
+    auto centre = kernelSize >> 1;
+    auto width = area.getWidth();
+    auto firstRow = jmax (0, area.getY() - centre);
+    auto endRow = jmin (sourceImage.getHeight(), area.getBottom() - centre + kernelSize - 1);
+
+    // All the source rows that are needed are filtered horizontally before anything is
+    // written, so the source and destination can share the same pixels.
+    HeapBlock<float> rows ((size_t) (width * (endRow - firstRow) * 4));
+
+    {
+        const Image::BitmapData srcData (sourceImage, Image::BitmapData::readOnly);
+        auto numChannels = srcData.pixelStride;
+
+        processInParallel (endRow - firstRow, width * kernelSize, [&] (int start, int end)
+        {
+            for (int y = start; y < end; ++y)
+            {
+                auto* src = srcData.getLinePointer (firstRow + y);
+                auto* dest = rows + y * width * 4;
+
+                for (int x = 0; x < width; ++x)
+                {
+                    auto sx = area.getX() + x - centre;
+                    auto total = PixelFloats::zero();
+
+                    for (int i = jmax (0, -sx); i < kernelSize && sx + i < srcData.width; ++i)
+                        total.addWeighted (PixelFloats::loadPixel (src + (sx + i) * numChannels, numChannels),
+                                           horizontalKernel[i]);
+
+                    total.store (dest + x * 4);
+                }
+            }
+        });
+    }
+
+    const Image::BitmapData destData (destImage, area.getX(), area.getY(), width, area.getHeight(),
+                                      Image::BitmapData::writeOnly);
+    auto numChannels = destData.pixelStride;
+
+    processInParallel (area.getHeight(), width * kernelSize, [&] (int start, int end)
+    {
+        HeapBlock<float> totals ((size_t) (width * 4));
+
+        for (int y = start; y < end; ++y)
+        {
+            auto sy = area.getY() + y - centre;
+            totals.clear ((size_t) (width * 4));
+
+            for (int i = jmax (0, firstRow - sy); i < kernelSize && sy + i < endRow; ++i)
+            {
+                auto* row = rows + (sy + i - firstRow) * width * 4;
+
+                for (int x = 0; x < width * 4; x += 4)
+                {
+                    auto total = PixelFloats::load (totals + x);
+                    total.addWeighted (PixelFloats::load (row + x), verticalKernel[i]);
+                    total.store (totals + x);
+                }
+            }
+
+            auto* dest = destData.getLinePointer (y);
+
+            for (int x = 0; x < width; ++x)
+                PixelFloats::load (totals + x * 4).storePixel (dest + x * numChannels, numChannels);
+        }
+    });
+}
+
+//==============================================================================
+void ImageOperations::applyBoxBlur (Image& image, Rectangle<int> area, int radius)
+{
+    area = area.getIntersection (image.getBounds());
+
+    if (radius <= 0 || area.isEmpty())
+        return;
+
+    const Image::BitmapData data (image, area.getX(), area.getY(), area.getWidth(), area.getHeight(),
+                                  Image::BitmapData::readWrite);
+
+    ImageOperationHelpers::boxBlurRows (data, radius);
+    ImageOperationHelpers::boxBlurColumns (data, radius);
+}
+
+void ImageOperations::applyGaussianBlur (Image& image, Rectangle<int> area, float standardDeviation)
+{
+    if (standardDeviation <= 0)
+        return;
+
+    // Three box blurs whose variances add up to that of the gaussian are close enough to
+    // it for most purposes. The boxes have to be an odd number of pixels wide, so they're
+    // a mixture of the two odd sizes either side of the ideal width.
+    const int numBoxes = 3;
+    auto variance = (double) standardDeviation * standardDeviation;
+    auto idealWidth = std::sqrt (12.0 * variance / numBoxes + 1.0);
+
+    auto lowerWidth = (int) std::floor (idealWidth);
+
+    if ((lowerWidth & 1) == 0)
+        --lowerWidth;
+
+    auto numLowerBoxes = roundToInt ((12.0 * variance - numBoxes * lowerWidth * lowerWidth
+                                       - 4.0 * numBoxes * lowerWidth - 3.0 * numBoxes)
+                                      / (-4.0 * lowerWidth - 4.0));
+
+    for (int i = 0; i < numBoxes; ++i)
+    {
+        auto boxWidth = i < numLowerBoxes ? lowerWidth : lowerWidth + 2;
+        applyBoxBlur (image, area, (boxWidth - 1) / 2);
+    }
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ImageOperationsTests  : public UnitTest
+{
+public:
+    ImageOperationsTests()
+        : UnitTest ("ImageOperations", "Graphics")
+    {}
+
+    void runTest() override
+    {
+        auto random = getRandom();
+
+        beginTest ("Separable and non-separable kernels give the same results");
+        {
+            // A non-separable kernel is applied by ImageConvolutionKernel itself, so nudging one value
+            // of a separable kernel makes it take the other path, while changing the result by much
+            // less than a level.
+            ImageConvolutionKernel gaussian (5);
+            gaussian.createGaussianBlur (1.5f);
+
+            ImageConvolutionKernel sharpen (5);
+            const float horizontal[] = { -0.25f, 0.5f, 1.5f, 0.5f, -0.25f }, vertical[] = { 0.1f, 0.2f, 0.4f, 0.2f, 0.1f };
+
+            for (int y = 0; y < 5; ++y)
+                for (int x = 0; x < 5; ++x)
+                    sharpen.setKernelValue (x, y, horizontal[x] * vertical[y]);
+
+            for (auto* separable : { &gaussian, &sharpen })
+            {
+                ImageConvolutionKernel nonSeparable (5);
+
+                for (int y = 0; y < 5; ++y)
+                    for (int x = 0; x < 5; ++x)
+                        nonSeparable.setKernelValue (x, y, separable->getKernelValue (x, y) + (x == 0 && y == 0 ? 0.001f : 0.0f));
+
+                for (auto format : { Image::ARGB, Image::RGB, Image::SingleChannel })
+                {
+                    auto source = createRandomImage (format, 64, 48, random);
+
+                    // (the whole image, areas along each edge, and one in the middle)
+                    for (auto area : { source.getBounds(), Rectangle<int> (0, 0, 12, 48), Rectangle<int> (50, 0, 14, 48),
+                                       Rectangle<int> (0, 0, 64, 3), Rectangle<int> (40, 40, 30, 30), Rectangle<int> (20, 15, 9, 13) })
+                    {
+                        auto dest = createRandomImage (format, 64, 48, random);
+                        auto expected = convolve (dest, source, area, *separable);
+
+                        auto separableResult = dest.createCopy();
+                        separable->applyToImage (separableResult, source, area);
+
+                        auto nonSeparableResult = dest.createCopy();
+                        nonSeparable.applyToImage (nonSeparableResult, source, area);
+
+                        expect (getMaximumDifference (separableResult, nonSeparableResult) <= 1);
+                        expect (getMaximumDifference (separableResult, expected) <= 1);
+
+                        // ..and the same when the image is filtered in-place
+                        auto inPlace = source.createCopy();
+                        separable->applyToImage (inPlace, inPlace, area);
+                        expect (getMaximumDifference (inPlace, convolve (source, source, area, *separable)) <= 1);
+                    }
+                }
+            }
+        }
+
+        beginTest ("Gaussian blur");
+        {
+            // A standard deviation of sqrt (6) is exactly three passes of a 5-pixel box blur, so a
+            // vertical line should spread out into the binomial-like profile of three boxes. The
+            // pixels beyond the edges of the area count as transparent black, so the line also fades
+            // towards its ends, and loses some of its spread when it's next to an edge.
+            const int width = 64, height = 16;
+            auto column = blurWithThreeBoxes (std::vector<double> ((size_t) height, 1.0), 2);
+
+            for (auto lineX : { 32, 1 })
+            {
+                Image image (Image::ARGB, width, height, true);
+                image.clear ({ lineX, 0, 1, height }, Colours::white);
+
+                ImageOperations::applyGaussianBlur (image, image.getBounds(), std::sqrt (6.0f));
+
+                std::vector<double> line ((size_t) width, 0.0);
+                line[(size_t) lineX] = 255.0;
+                auto row = blurWithThreeBoxes (line, 2);
+
+                const Image::BitmapData data (image, Image::BitmapData::readOnly);
+                int maxError = 0;
+
+                for (int y = 0; y < height; ++y)
+                    for (int x = 0; x < width; ++x)
+                        for (int c = 0; c < 4; ++c)
+                            maxError = jmax (maxError, std::abs (data.getPixelPointer (x, y)[c] - roundToInt (row[(size_t) x] * column[(size_t) y])));
+
+                // (each pass rounds its results to whole levels)
+                expect (maxError <= 1, "line at x = " + String (lineX) + ": out by " + String (maxError));
+            }
+
+            // Only the given area is blurred
+            Image image (Image::SingleChannel, 40, 40, true);
+            image.clear ({ 0, 0, 40, 40 }, Colours::white);
+            image.clear ({ 10, 10, 20, 20 }, Colours::transparentBlack);
+            auto original = image.createCopy();
+
+            ImageOperations::applyGaussianBlur (image, { 10, 10, 20, 20 }, 3.0f);
+            expect (getMaximumDifference (image, original) == 0);
+
+            ImageOperations::applyGaussianBlur (image, { 5, 5, 10, 30 }, 3.0f);
+            expect (getMaximumDifference (image.getClippedImage ({ 15, 0, 25, 40 }), original.getClippedImage ({ 15, 0, 25, 40 })) == 0);
+            expect (getMaximumDifference (image.getClippedImage ({ 0, 0, 5, 40 }), original.getClippedImage ({ 0, 0, 5, 40 })) == 0);
+            expect (image.getPixelAt (14, 20).getAlpha() > 0);
+        }
+
+        beginTest ("Resampled images are the requested size");
+        {
+            for (auto format : { Image::ARGB, Image::RGB, Image::SingleChannel })
+            {
+                auto source = createRandomImage (format, 37, 23, random);
+
+                for (auto size : { Point<int> (37, 23), Point<int> (100, 80), Point<int> (10, 7), Point<int> (1, 1),
+                                   Point<int> (200, 5), Point<int> (3, 64) })
+                {
+                    for (auto filter : { ImageOperations::lanczos3, ImageOperations::areaAverage })
+                    {
+                        auto resampled = ImageOperations::resampled (source, size.x, size.y, filter);
+
+                        expectEquals (resampled.getWidth(), size.x);
+                        expectEquals (resampled.getHeight(), size.y);
+                        expect (resampled.getFormat() == format);
+                    }
+
+                    auto rescaled = source.rescaled (size.x, size.y, Graphics::highResamplingQuality);
+
+                    expectEquals (rescaled.getWidth(), size.x);
+                    expectEquals (rescaled.getHeight(), size.y);
+                    expect (rescaled.getFormat() == format);
+
+                    // (an image that's already the right size is returned as it is)
+                    if (size == Point<int> (source.getWidth(), source.getHeight()))
+                        expect (rescaled == source);
+                    else
+                        expect (getMaximumDifference (rescaled, ImageOperations::resampled (source, size.x, size.y, ImageOperations::lanczos3)) == 0);
+                }
+            }
+
+            expect (! ImageOperations::resampled (Image (Image::ARGB, 10, 10, true), 0, 10, ImageOperations::lanczos3).isValid());
+            expect (! ImageOperations::resampled (Image(), 10, 10, ImageOperations::lanczos3).isValid());
+
+            // A plain colour stays the same, and lanczos3's negative lobes don't leave any pixels
+            // whose colour components are larger than their alpha
+            Image plain (Image::ARGB, 30, 20, true);
+            plain.clear (plain.getBounds(), Colour (0x80402010));
+            auto enlarged = plain.rescaled (71, 45, Graphics::highResamplingQuality);
+            expect (getMaximumDifference (enlarged, createPlainImage (Image::ARGB, 71, 45, Colour (0x80402010))) <= 1);
+
+            auto edges = createRandomImage (Image::ARGB, 30, 20, random);
+            auto resampled = ImageOperations::resampled (edges, 77, 13, ImageOperations::lanczos3);
+            const Image::BitmapData data (resampled, Image::BitmapData::readOnly);
+            bool allValid = true;
+
+            for (int y = 0; y < data.height; ++y)
+            {
+                for (int x = 0; x < data.width; ++x)
+                {
+                    auto p = *reinterpret_cast<const PixelARGB*> (data.getPixelPointer (x, y));
+                    allValid = allValid && p.getRed() <= p.getAlpha() && p.getGreen() <= p.getAlpha() && p.getBlue() <= p.getAlpha();
+                }
+            }
+
+            expect (allValid);
+        }
+
+        beginTest ("Format conversions");
+        {
+            auto rgb = createRandomImage (Image::RGB, 33, 17, random);
+            auto argb = rgb.convertedToFormat (Image::ARGB);
+            expect (argb.getFormat() == Image::ARGB);
+            expect (getMaximumDifference (argb.convertedToFormat (Image::RGB), rgb) == 0);
+            expect (getMaximumDifference (argb.convertedToFormat (Image::SingleChannel),
+                                          createPlainImage (Image::SingleChannel, 33, 17, Colours::white)) == 0);
+
+            auto alpha = createRandomImage (Image::SingleChannel, 33, 17, random);
+            expect (getMaximumDifference (alpha.convertedToFormat (Image::ARGB).convertedToFormat (Image::SingleChannel), alpha) == 0);
+
+            // a translucent image loses its alpha when it's converted to RGB, as if it had been drawn onto black
+            auto translucent = createRandomImage (Image::ARGB, 33, 17, random);
+            auto onBlack = translucent.convertedToFormat (Image::RGB);
+            auto expected = createPlainImage (Image::RGB, 33, 17, Colours::black);
+
+            {
+                Graphics g (expected);
+                g.drawImageAt (translucent, 0, 0);
+            }
+
+            expect (getMaximumDifference (onBlack, expected) <= 1);
+
+            // ..and converting it to SingleChannel keeps just its alpha
+            auto alphaOnly = translucent.convertedToFormat (Image::SingleChannel);
+            bool alphasMatch = true;
+
+            for (int y = 0; y < 17; ++y)
+                for (int x = 0; x < 33; ++x)
+                    alphasMatch = alphasMatch && alphaOnly.getPixelAt (x, y).getAlpha() == translucent.getPixelAt (x, y).getAlpha();
+
+            expect (alphasMatch);
+            expect (translucent.convertedToFormat (Image::ARGB) == translucent);
+        }
+    }
+
+private:
+    static Image createRandomImage (Image::PixelFormat format, int width, int height, Random& random)
+    {
+        Image image (format, width, height, false);
+        const Image::BitmapData data (image, Image::BitmapData::writeOnly);
+
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                auto* pixel = data.getPixelPointer (x, y);
+
+                if (format == Image::ARGB)
+                {
+                    auto alpha = (uint8) random.nextInt (256);
+                    reinterpret_cast<PixelARGB*> (pixel)->setARGB (alpha, (uint8) random.nextInt (alpha + 1),
+                                                                   (uint8) random.nextInt (alpha + 1), (uint8) random.nextInt (alpha + 1));
+                }
+                else
+                {
+                    for (int c = 0; c < data.pixelStride; ++c)
+                        pixel[c] = (uint8) random.nextInt (256);
+                }
+            }
+        }
+
+        return image;
+    }
+
+    static Image createPlainImage (Image::PixelFormat format, int width, int height, Colour colour)
+    {
+        Image image (format, width, height, false);
+        image.clear (image.getBounds(), colour);
+        return image;
+    }
+
+    static std::vector<double> blurWithThreeBoxes (std::vector<double> values, int radius)
+    {
+        auto num = (int) values.size();
+
+        for (int pass = 0; pass < 3; ++pass)
+        {
+            auto previous = values;
+
+            for (int i = 0; i < num; ++i)
+            {
+                double total = 0;
+
+                for (int j = jmax (0, i - radius); j <= jmin (num - 1, i + radius); ++j)
+                    total += previous[(size_t) j];
+
+                values[(size_t) i] = total / (radius * 2 + 1);
+            }
+        }
+
+        return values;
+    }
+
+    // A straightforward version of what ImageConvolutionKernel::applyToImage should do
+    static Image convolve (const Image& dest, const Image& source, Rectangle<int> area, const ImageConvolutionKernel& kernel)
+    {
+        auto result = dest.createCopy();
+        area = area.getIntersection (result.getBounds());
+
+        const Image::BitmapData srcData (source, Image::BitmapData::readOnly);
+        const Image::BitmapData destData (result, Image::BitmapData::writeOnly);
+        auto size = kernel.getKernelSize();
+
+        for (int y = area.getY(); y < area.getBottom(); ++y)
+        {
+            for (int x = area.getX(); x < area.getRight(); ++x)
+            {
+                for (int c = 0; c < srcData.pixelStride; ++c)
+                {
+                    double total = 0;
+
+                    for (int ky = 0; ky < size; ++ky)
+                    {
+                        for (int kx = 0; kx < size; ++kx)
+                        {
+                            auto sx = x + kx - size / 2, sy = y + ky - size / 2;
+
+                            if (isPositiveAndBelow (sx, srcData.width) && isPositiveAndBelow (sy, srcData.height))
+                                total += srcData.getPixelPointer (sx, sy)[c] * (double) kernel.getKernelValue (kx, ky);
+                        }
+                    }
+
+                    destData.getPixelPointer (x, y)[c] = (uint8) jlimit (0, 255, roundToInt (total));
+                }
+            }
+        }
+
+        return result;
+    }
+
+    static int getMaximumDifference (const Image& a, const Image& b)
+    {
+        if (a.getBounds() != b.getBounds() || a.getFormat() != b.getFormat())
+            return 256;
+
+        const Image::BitmapData dataA (a, Image::BitmapData::readOnly);
+        const Image::BitmapData dataB (b, Image::BitmapData::readOnly);
+        int maxDifference = 0;
+
+        for (int y = 0; y < dataA.height; ++y)
+            for (int x = 0; x < dataA.width; ++x)
+                for (int c = 0; c < dataA.pixelStride; ++c)
+                    maxDifference = jmax (maxDifference, std::abs (dataA.getPixelPointer (x, y)[c] - dataB.getPixelPointer (x, y)[c]));
+
+        return maxDifference;
+    }
+};
+
+static ImageOperationsTests imageOperationsTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A collection of filtering and resampling operations that work directly on the
+    pixels of an Image.
+
+    These use SIMD instructions where they're available, and large images are split
+    into strips which are processed on several threads at once.
+
+    ARGB images are premultiplied, and all of these operations work directly on the
+    premultiplied values, so they don't produce any dark fringes around transparent
+    areas.
+
+    @see Image, ImageConvolutionKernel
+
+    @tags{Graphics}
+*/
+class JUCE_API  ImageOperations
+{
+public:
+    //==============================================================================
+    /** The filters that resampled() can use. */
+    enum ResamplingFilter
+    {
+        areaAverage,    /**< Each new pixel is the average of the area of the source image
+                             that it covers. This is fast, and good for making thumbnails. */
+        lanczos3        /**< A 3-lobed Lanczos filter, which keeps edges sharp when enlarging
+                             or reducing images, but is slower than areaAverage. */
+    };
+
+    /** Returns a copy of an image that has been resampled to a new size.
+
+        The new image has the same format and type as the source.
+    */
+    static Image resampled (const Image& sourceImage, int newWidth, int newHeight,
+                            ResamplingFilter filter);
+
+    //==============================================================================
+    /** Convolves an area of an image with a separable kernel.
+
+        This has the same effect as using an ImageConvolutionKernel whose value at (x, y) is
+        horizontalKernel[x] * verticalKernel[y], but it's much faster, because it applies
+        the two one-dimensional kernels in turn.
+
+        @param destImage        the image that will receive the resultant pixels
+        @param sourceImage      the image to read from - this can be the same image as the
+                                destination, but if different, it must be exactly the same
+                                size and format
+        @param destinationArea  the region of the image to apply the filter to
+        @param horizontalKernel the kernelSize values to apply along each row
+        @param verticalKernel   the kernelSize values to apply down each column
+        @param kernelSize       the number of values in each kernel
+    */
+    static void applySeparableKernel (Image& destImage, const Image& sourceImage,
+                                      Rectangle<int> destinationArea,
+                                      const float* horizontalKernel,
+                                      const float* verticalKernel,
+                                      int kernelSize);
+
+    /** Blurs an area of an image by replacing each pixel with the average of the
+        (radius * 2 + 1) x (radius * 2 + 1) square of pixels around it.
+
+        Pixels outside the area are treated as being transparent black. The time this
+        takes doesn't depend on the radius.
+    */
+    static void applyBoxBlur (Image& image, Rectangle<int> area, int radius);
+
+    /** Applies an approximate gaussian blur to an area of an image.
+
+        This is done with three successive box blurs, so the time it takes doesn't
+        depend on the size of the blur. Pixels outside the area are treated as being
+        transparent black.
+
+        @param image                the image to blur
+        @param area                 the region of the image to blur
+        @param standardDeviation    the standard deviation of the gaussian, in pixels
+    */
+    static void applyGaussianBlur (Image& image, Rectangle<int> area, float standardDeviation);
+
+private:
+    ImageOperations() = delete;
+};
+
+} // namespace juce
@@ -108,20 +108,64 @@
  #define JUCE_USING_COREIMAGE_LOADER 0
 #endif
 
+//==============================================================================
+#if JUCE_MINGW && ! defined (__SSE2__)
+ #define JUCE_USE_SSE_INTRINSICS 0
+#endif
+
+#ifndef JUCE_USE_SSE_INTRINSICS
+ #define JUCE_USE_SSE_INTRINSICS 1
+#endif
+
+#if ! JUCE_INTEL
+ #undef JUCE_USE_SSE_INTRINSICS
+#endif
+
+#if (__ARM_NEON__ || __ARM_NEON) && ! defined (JUCE_USE_ARM_NEON)
+ #define JUCE_USE_ARM_NEON 1
+#endif
+
+#if TARGET_IPHONE_SIMULATOR
+ #undef JUCE_USE_ARM_NEON
+#endif
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <emmintrin.h>
+
+ #if JUCE_MSVC || JUCE_CLANG || (JUCE_GCC && (__GNUC__ * 100 + __GNUC_MINOR__) >= 409)
+  #include <immintrin.h>
+  #define JUCE_PIXEL_SPAN_USE_AVX2 1
+
+  #if JUCE_MSVC
+   #define JUCE_AVX2_TARGET
+  #else
+   #define JUCE_AVX2_TARGET __attribute__ ((target ("avx2")))
+  #endif
+ #endif
+#endif
+
+#if JUCE_USE_ARM_NEON
+ #include <arm_neon.h>
+#endif
+
 //==============================================================================
 #include "colour/juce_Colour.cpp"
 #include "colour/juce_ColourGradient.cpp"
 #include "colour/juce_Colours.cpp"
 #include "colour/juce_FillType.cpp"
+#include "colour/juce_PixelSpanOperations.cpp"
 #include "geometry/juce_AffineTransform.cpp"
 #include "geometry/juce_EdgeTable.cpp"
 #include "geometry/juce_Path.cpp"
 #include "geometry/juce_PathIterator.cpp"
 #include "geometry/juce_PathStrokeType.cpp"
+#include "geometry/juce_LRUObjectCache.h"
+#include "geometry/juce_PathCache.cpp"
 #include "placement/juce_RectanglePlacement.cpp"
 #include "contexts/juce_GraphicsContext.cpp"
 #include "contexts/juce_LowLevelGraphicsPostScriptRenderer.cpp"
 #include "contexts/juce_LowLevelGraphicsSoftwareRenderer.cpp"
+#include "images/juce_ImageOperations.cpp"
 #include "images/juce_Image.cpp"
 #include "images/juce_ImageCache.cpp"
 #include "images/juce_ImageConvolutionKernel.cpp"
@@ -135,6 +179,7 @@
 #include "fonts/juce_Font.cpp"
 #include "fonts/juce_GlyphArrangement.cpp"
 #include "fonts/juce_TextLayout.cpp"
+#include "fonts/juce_TextLayoutCache.cpp"
 #include "effects/juce_DropShadowEffect.cpp"
 #include "effects/juce_GlowEffect.cpp"
 
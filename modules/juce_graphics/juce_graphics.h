@@ -119,6 +119,7 @@ namespace juce
 #include "geometry/juce_Path.h"
 #include "geometry/juce_RectangleList.h"
 #include "colour/juce_PixelFormats.h"
+#include "colour/juce_PixelSpanOperations.h"
 #include "colour/juce_Colour.h"
 #include "colour/juce_ColourGradient.h"
 #include "colour/juce_Colours.h"
@@ -126,15 +127,18 @@ namespace juce
 #include "geometry/juce_EdgeTable.h"
 #include "geometry/juce_PathIterator.h"
 #include "geometry/juce_PathStrokeType.h"
+#include "geometry/juce_PathCache.h"
 #include "placement/juce_RectanglePlacement.h"
 #include "images/juce_ImageCache.h"
 #include "images/juce_ImageConvolutionKernel.h"
+#include "images/juce_ImageOperations.h"
 #include "images/juce_ImageFileFormat.h"
 #include "fonts/juce_Typeface.h"
 #include "fonts/juce_Font.h"
 #include "fonts/juce_AttributedString.h"
 #include "fonts/juce_GlyphArrangement.h"
 #include "fonts/juce_TextLayout.h"
+#include "fonts/juce_TextLayoutCache.h"
 #include "fonts/juce_CustomTypeface.h"
 #include "contexts/juce_GraphicsContext.h"
 #include "contexts/juce_LowLevelGraphicsContext.h"
@@ -141,16 +141,23 @@ public:
 //==============================================================================
 /** Holds a cache of recently-used glyph objects of some type.
 
+    Glyphs are looked up by their typeface, size and glyph number, plus a variant number
+    that lets the glyph type keep different versions of a glyph, e.g. for different
+    sub-pixel positions. When the cache is full, the glyphs that were used least recently
+    get discarded. The glyph type's defaultMaxNumGlyphs says how many it holds to begin with.
+
+    The cache can be shared by renderers that are running on different threads. A glyph
+    that isn't in the cache gets created without holding the cache's lock, and a glyph
+    object stays valid for as long as something holds a pointer to it, even if the cache
+    discards it in the meantime.
+
     @tags{Graphics}
 */
 template <class CachedGlyphType, class RenderTargetType>
 class GlyphCache  : private DeletedAtShutdown
 {
 public:
-    GlyphCache()
-    {
-        reset();
-    }
+    GlyphCache() = default;
 
     ~GlyphCache() override
     {
@@ -161,10 +168,16 @@ public:
     {
         auto& g = getSingletonPointer();
 
-        if (g == nullptr)
+        if (auto* existing = g.load())
+            return *existing;
+
+        static SpinLock creationLock;
+        const SpinLock::ScopedLockType sl (creationLock);
+
+        if (g.load() == nullptr)
             g = new GlyphCache();
 
-        return *g;
+        return *g.load();
     }
 
     //==============================================================================
@@ -172,98 +185,135 @@ public:
     {
         const ScopedLock sl (lock);
         glyphs.clear();
-        addNewGlyphSlots (120);
+        leastRecentlyUsed.clear();
         hits = 0;
         misses = 0;
     }
 
+    /** Sets the number of glyphs that the cache can hold. */
+    void setMaximumNumGlyphs (int newMaximum)
+    {
+        jassert (newMaximum > 0);
+
+        const ScopedLock sl (lock);
+        maxNumGlyphs = jmax (1, newMaximum);
+        removeLeastRecentlyUsedGlyphs();
+    }
+
+    /** Returns the number of times that a glyph was found in the cache, and the number
+        of times one had to be created.
+    */
+    Point<int> getNumHitsAndMisses() const noexcept     { return { hits.get(), misses.get() }; }
+
     void drawGlyph (RenderTargetType& target, const Font& font, const int glyphNumber, Point<float> pos)
     {
-        if (auto glyph = findOrCreateGlyph (font, glyphNumber))
-        {
-            glyph->lastAccessCount = ++accessCounter;
-            glyph->draw (target, pos);
-        }
+        if (auto* typeface = font.getTypeface())
+            if (auto glyph = findOrCreateGlyph (font, glyphNumber, CachedGlyphType::getVariant (target, *typeface, pos)))
+                glyph->draw (target, pos);
     }
 
-    ReferenceCountedObjectPtr<CachedGlyphType> findOrCreateGlyph (const Font& font, int glyphNumber)
+    ReferenceCountedObjectPtr<CachedGlyphType> findOrCreateGlyph (const Font& font, int glyphNumber, int variant = 0)
     {
-        const ScopedLock sl (lock);
+        auto* typeface = font.getTypeface();
+
+        if (typeface == nullptr)
+            return {};
+
+        const GlyphKey key { typeface, font.getHeight(), font.getHorizontalScale(), glyphNumber, variant };
 
-        if (auto g = findExistingGlyph (font, glyphNumber))
         {
-            ++hits;
-            return g;
+            const ScopedLock sl (lock);
+
+            if (auto g = findExistingGlyph (key))
+            {
+                ++hits;
+                return g;
+            }
         }
 
         ++misses;
-        auto g = getGlyphForReuse();
-        jassert (g != nullptr);
-        g->generate (font, glyphNumber);
-        return g;
-    }
+        ReferenceCountedObjectPtr<CachedGlyphType> newGlyph (new CachedGlyphType());
+        newGlyph->generate (font, glyphNumber, variant);
 
-private:
-    ReferenceCountedArray<CachedGlyphType> glyphs;
-    Atomic<int> accessCounter, hits, misses;
-    CriticalSection lock;
+        const ScopedLock sl (lock);
 
-    ReferenceCountedObjectPtr<CachedGlyphType> findExistingGlyph (const Font& font, int glyphNumber) const noexcept
-    {
-        for (auto g : glyphs)
-            if (g->glyph == glyphNumber && g->font == font)
-                return *g;
+        // another thread may have added the same glyph while this one was being created
+        if (auto g = findExistingGlyph (key))
+            return g;
 
-        return {};
+        leastRecentlyUsed.push_front (key);
+        glyphs[key] = { newGlyph, leastRecentlyUsed.begin() };
+        removeLeastRecentlyUsedGlyphs();
+
+        return newGlyph;
     }
 
-    ReferenceCountedObjectPtr<CachedGlyphType> getGlyphForReuse()
+private:
+    //==============================================================================
+    struct GlyphKey
     {
-        if (hits.get() + misses.get() > glyphs.size() * 16)
+        // (the cached glyphs keep their typefaces alive, so this can't get re-used while it's a key)
+        const Typeface* typeface;
+        float height, horizontalScale;
+        int glyph, variant;
+
+        bool operator== (const GlyphKey& other) const noexcept
         {
-            if (misses.get() * 2 > hits.get())
-                addNewGlyphSlots (32);
+            return typeface == other.typeface
+                && glyph == other.glyph
+                && variant == other.variant
+                && height == other.height
+                && horizontalScale == other.horizontalScale;
+        }
+    };
 
-            hits = 0;
-            misses = 0;
+    struct GlyphKeyHash
+    {
+        size_t operator() (const GlyphKey& k) const noexcept
+        {
+            auto h = (size_t) (pointer_sized_uint) k.typeface;
+            h = h * 31 + (size_t) k.glyph;
+            h = h * 31 + (size_t) k.variant;
+            h = h * 31 + std::hash<float>() (k.height);
+            return h * 31 + std::hash<float>() (k.horizontalScale);
         }
+    };
 
-        if (auto g = findLeastRecentlyUsedGlyph())
-            return *g;
+    struct CacheEntry
+    {
+        ReferenceCountedObjectPtr<CachedGlyphType> glyph;
+        typename std::list<GlyphKey>::iterator lruPosition;
+    };
 
-        addNewGlyphSlots (32);
-        return glyphs.getLast();
-    }
+    std::unordered_map<GlyphKey, CacheEntry, GlyphKeyHash> glyphs;
+    std::list<GlyphKey> leastRecentlyUsed; // (the most recently used glyph is at the front)
+    int maxNumGlyphs = CachedGlyphType::defaultMaxNumGlyphs;
+    Atomic<int> hits, misses;
+    CriticalSection lock;
 
-    void addNewGlyphSlots (int num)
+    ReferenceCountedObjectPtr<CachedGlyphType> findExistingGlyph (const GlyphKey& key)
     {
-        glyphs.ensureStorageAllocated (glyphs.size() + num);
+        auto found = glyphs.find (key);
 
-        while (--num >= 0)
-            glyphs.add (new CachedGlyphType());
+        if (found == glyphs.end())
+            return {};
+
+        leastRecentlyUsed.splice (leastRecentlyUsed.begin(), leastRecentlyUsed, found->second.lruPosition);
+        return found->second.glyph;
     }
 
-    CachedGlyphType* findLeastRecentlyUsedGlyph() const noexcept
+    void removeLeastRecentlyUsedGlyphs()
     {
-        CachedGlyphType* oldest = nullptr;
-        auto oldestCounter = std::numeric_limits<int>::max();
-
-        for (auto* g : glyphs)
+        while ((int) glyphs.size() > maxNumGlyphs)
         {
-            if (g->lastAccessCount <= oldestCounter
-                 && g->getReferenceCount() == 1)
-            {
-                oldestCounter = g->lastAccessCount;
-                oldest = g;
-            }
+            glyphs.erase (leastRecentlyUsed.back());
+            leastRecentlyUsed.pop_back();
         }
-
-        return oldest;
     }
 
-    static GlyphCache*& getSingletonPointer() noexcept
+    static std::atomic<GlyphCache*>& getSingletonPointer() noexcept
     {
-        static GlyphCache* g = nullptr;
+        static std::atomic<GlyphCache*> g { nullptr };
         return g;
     }
 
@@ -281,6 +331,11 @@ class CachedGlyphEdgeTable  : public ReferenceCountedObject
 public:
     CachedGlyphEdgeTable() = default;
 
+    enum { defaultMaxNumGlyphs = 4096 };
+
+    // (edge-tables can be drawn at any sub-pixel position, so one version of a glyph does for all of them)
+    static int getVariant (const RendererType&, Typeface&, Point<float>) noexcept    { return 0; }
+
     void draw (RendererType& state, Point<float> pos) const
     {
         if (snapToIntegerCoordinate)
@@ -290,12 +345,10 @@ public:
             state.fillEdgeTable (*edgeTable, pos.x, roundToInt (pos.y));
     }
 
-    void generate (const Font& newFont, int glyphNumber)
+    void generate (const Font& font, int glyphNumber, int /*variant*/)
     {
-        font = newFont;
-        auto* typeface = newFont.getTypeface();
+        typeface = font.getTypeface();
         snapToIntegerCoordinate = typeface->isHinted();
-        glyph = glyphNumber;
 
         auto fontHeight = font.getHeight();
         edgeTable.reset (typeface->getEdgeTableForGlyph (glyphNumber,
@@ -303,14 +356,217 @@ public:
                                                                                  fontHeight), fontHeight));
     }
 
-    Font font;
+    Typeface::Ptr typeface;
     std::unique_ptr<EdgeTable> edgeTable;
-    int glyph = 0, lastAccessCount = 0;
     bool snapToIntegerCoordinate = false;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CachedGlyphEdgeTable)
 };
 
+//==============================================================================
+/** A set of 8-bit pages that the software renderer packs its glyph images into.
+
+    Glyphs get packed in rows into the shared pages. When a glyph's space is freed, it's
+    cleared and can be re-used by any glyph that fits into it, and a page gets freed when
+    the last of the glyphs that use it has been deleted. There's a limit on the total size
+    of the shared pages, and any glyphs that don't fit within it are given a page of their
+    own.
+
+    @tags{Graphics}
+*/
+class GlyphAtlas
+{
+public:
+    /** A block of 8-bit pixels that holds one or more glyph images. */
+    class Page  : public ReferenceCountedObject
+    {
+    public:
+        Page (int width, int height, bool isSharedPage);
+
+        using Ptr = ReferenceCountedObjectPtr<Page>;
+
+        const uint8* getPixelPointer (int x, int y) const noexcept  { return pixels + y * width + x; }
+        uint8* getPixelPointer (int x, int y) noexcept              { return pixels + y * width + x; }
+        int getLineStride() const noexcept                          { return width; }
+
+        /** Returns true if this page is one of the atlas's shared pages, rather than one
+            that was made for a single glyph.
+        */
+        bool isSharedPage() const noexcept                          { return isShared; }
+
+    private:
+        // A row of glyphs of no more than its height, with any gaps left by deleted glyphs
+        struct Row
+        {
+            int y, height, nextX, numSpaces;
+            Array<Range<int>> gaps;
+        };
+
+        HeapBlock<uint8> pixels;
+        const int width, height;
+        const bool isShared;
+        Array<Row> rows;
+        int numSpaces = 0;
+
+        bool allocate (int spaceWidth, int spaceHeight, Point<int>& position);
+        void release (Rectangle<int> area);
+        int findSpaceInRow (const Row&, int spaceWidth) const noexcept;
+
+        friend class GlyphAtlas;
+        JUCE_DECLARE_NON_COPYABLE (Page)
+    };
+
+    /** An area of a page that holds one glyph image. When the last reference to it goes
+        away, the area is cleared and given back to the page.
+    */
+    class Space  : public ReferenceCountedObject
+    {
+    public:
+        Space (Page::Ptr pageToUse, Rectangle<int> areaToUse);
+        ~Space() override;
+
+        using Ptr = ReferenceCountedObjectPtr<Space>;
+
+        const Page::Ptr page;
+        const Rectangle<int> area;
+
+        JUCE_DECLARE_NON_COPYABLE (Space)
+    };
+
+    /** Finds a space for an image of the given size. The space will initially be clear. */
+    static Space::Ptr allocate (int width, int height);
+
+private:
+    static void release (Space&);
+
+    GlyphAtlas() = delete;
+};
+
+//==============================================================================
+/** Caches a glyph as an 8-bit image in a GlyphAtlas, which can be blended straight
+    into the destination when the glyph is drawn in a solid colour.
+
+    Unless the typeface is hinted, a glyph is rendered at 8 horizontal sub-pixel positions,
+    and drawn from whichever is nearest, so it can be up to 1/16 of a pixel from where its
+    edge-table would be drawn. As the renderer makes light-coloured text slightly bolder,
+    a glyph drawn in a light colour also has a version for each of 8 brightness steps, so
+    its boost can be up to 6% away from the edge-table's. That makes at most 72 versions
+    of a glyph at each size.
+
+    @tags{Graphics}
+*/
+template <class RendererType>
+class CachedGlyphCoverageMask  : public ReferenceCountedObject
+{
+public:
+    CachedGlyphCoverageMask() = default;
+
+    enum
+    {
+        subPixelBits = 3,
+        numSubPixelPositions = 1 << subPixelBits,
+        numBrightnessSteps = 8,
+
+        // (a mask is much smaller than an edge-table, and a glyph can need several of them)
+        defaultMaxNumGlyphs = 16384
+    };
+
+    static int getVariant (const RendererType& state, Typeface& typeface, Point<float> pos) noexcept
+    {
+        auto subPixelPosition = typeface.isHinted() ? 0 : (getXInSubPixels (pos.x) & (numSubPixelPositions - 1));
+        return subPixelPosition + numSubPixelPositions * getBrightnessStep (state.getGlyphBrightnessLevel());
+    }
+
+    void draw (RendererType& state, Point<float> pos) const
+    {
+        if (space != nullptr)
+        {
+            auto x = snapToIntegerCoordinate ? (int) std::floor (pos.x + 0.5f)
+                                             : (getXInSubPixels (pos.x) >> subPixelBits);
+
+            state.drawGlyphCoverageMask (space, origin + Point<int> (x, roundToInt (pos.y)));
+        }
+    }
+
+    void generate (const Font& font, int glyphNumber, int variant)
+    {
+        typeface = font.getTypeface();
+        snapToIntegerCoordinate = typeface->isHinted();
+        subPixelPosition = variant % numSubPixelPositions;
+        auto brightnessLevel = getBrightnessLevelForStep (variant / numSubPixelPositions);
+
+        auto fontHeight = font.getHeight();
+        const std::unique_ptr<EdgeTable> edgeTable (typeface->getEdgeTableForGlyph (glyphNumber,
+                                                                                    AffineTransform::scale (fontHeight * font.getHorizontalScale(),
+                                                                                                            fontHeight), fontHeight));
+
+        if (edgeTable != nullptr && ! edgeTable->isEmpty())
+        {
+            // (the edge-table has a spare column on each side, so this doesn't move its bounds)
+            if (subPixelPosition != 0)
+                edgeTable->translate ((float) subPixelPosition / (float) numSubPixelPositions, 0);
+
+            if (brightnessLevel > 0)
+                edgeTable->multiplyLevels (RendererType::getGlyphLevelMultiplier (Colour ((uint8) brightnessLevel,
+                                                                                          (uint8) brightnessLevel,
+                                                                                          (uint8) brightnessLevel)));
+
+            auto bounds = edgeTable->getMaximumBounds();
+            space = GlyphAtlas::allocate (bounds.getWidth(), bounds.getHeight());
+            origin = bounds.getPosition();
+
+            MaskWriter writer { *space->page, space->area.getPosition() - origin, nullptr };
+            edgeTable->iterate (writer);
+        }
+    }
+
+    Typeface::Ptr typeface;
+    GlyphAtlas::Space::Ptr space;
+    Point<int> origin;
+    int subPixelPosition = 0;
+    bool snapToIntegerCoordinate = false;
+
+private:
+    static int getXInSubPixels (float x) noexcept    { return (int) std::floor (x * (float) numSubPixelPositions + 0.5f); }
+
+    // The renderer only boosts colours whose largest component is at least this level
+    enum { minBoostedLevel = 128 };
+
+    static int getBrightnessStep (int brightnessLevel) noexcept
+    {
+        if (brightnessLevel < minBoostedLevel)
+            return 0;
+
+        return 1 + roundToInt ((float) ((brightnessLevel - minBoostedLevel) * (numBrightnessSteps - 1))
+                                 / (float) (255 - minBoostedLevel));
+    }
+
+    static int getBrightnessLevelForStep (int step) noexcept
+    {
+        if (step == 0)
+            return 0;
+
+        return minBoostedLevel + roundToInt ((float) ((step - 1) * (255 - minBoostedLevel))
+                                               / (float) (numBrightnessSteps - 1));
+    }
+
+    // Writes the levels from an edge-table into the glyph's area of its page
+    struct MaskWriter
+    {
+        GlyphAtlas::Page& page;
+        const Point<int> offset;
+        uint8* line;
+
+        forcedinline void setEdgeTableYPos (int y) noexcept                               { line = page.getPixelPointer (offset.x, y + offset.y); }
+        forcedinline void handleEdgeTablePixel (int x, int alphaLevel) noexcept           { line[x] = (uint8) alphaLevel; }
+        forcedinline void handleEdgeTablePixelFull (int x) noexcept                       { line[x] = 255; }
+        forcedinline void handleEdgeTableLine (int x, int width, int alphaLevel) noexcept { memset (line + x, alphaLevel, (size_t) width); }
+        forcedinline void handleEdgeTableLineFull (int x, int width) noexcept             { memset (line + x, 255, (size_t) width); }
+    };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CachedGlyphCoverageMask)
+};
+
 //==============================================================================
 /** Calculates the alpha values and positions for rendering the edges of a
     non-pixel-aligned rectangle.
@@ -465,6 +721,14 @@ namespace GradientPixelIterators
                             : lookupTable[jlimit (0, numEntries, (x * scale - start) >> (int) numScaleBits)];
         }
 
+        void generate (PixelARGB* dest, int x, int numPixels) const noexcept
+        {
+            if (vertical)
+                std::fill (dest, dest + numPixels, linePix);
+            else
+                PixelSpanOperations::linearGradient (dest, lookupTable, numEntries, x, scale, start, numPixels);
+        }
+
         const PixelARGB* const lookupTable;
         const int numEntries;
         PixelARGB linePix;
@@ -509,6 +773,11 @@ namespace GradientPixelIterators
             return lookupTable[x >= maxDist ? numEntries : roundToInt (std::sqrt (x) * invScale)];
         }
 
+        void generate (PixelARGB* dest, int x, int numPixels) const noexcept
+        {
+            PixelSpanOperations::radialGradient (dest, lookupTable, numEntries, x, gx1, dy, maxDist, invScale, numPixels);
+        }
+
         const PixelARGB* const lookupTable;
         const int numEntries;
         const double gx1, gy1;
@@ -551,6 +820,12 @@ namespace GradientPixelIterators
             return lookupTable[jmin (numEntries, roundToInt (std::sqrt (x) * invScale))];
         }
 
+        void generate (PixelARGB* dest, int x, int numPixels) const noexcept
+        {
+            PixelSpanOperations::transformedRadialGradient (dest, lookupTable, numEntries, x, tM00, tM10,
+                                                            lineYM01, lineYM11, maxDist, invScale, numPixels);
+        }
+
     private:
         double tM10, tM00, lineYM01, lineYM11;
         const AffineTransform inverseTransform;
@@ -569,6 +844,74 @@ namespace GradientPixelIterators
 /** Contains classes for filling edge tables with various fill types. */
 namespace EdgeTableFillers
 {
+    /*  These use the PixelSpanOperations for runs of tightly-packed pixels in formats that
+        have them, and do the same operations pixel-by-pixel for everything else.
+    */
+    template <class PixelType>
+    forcedinline void blendSpan (PixelType* dest, PixelARGB colour, int width, int destStride) noexcept
+    {
+        do { dest->blend (colour); dest = addBytesToPointer (dest, destStride); } while (--width > 0);
+    }
+
+    template <class DestPixelType, class SrcPixelType>
+    forcedinline void blendSpan (DestPixelType* dest, const SrcPixelType* src, int width,
+                                 int destStride, int srcStride, uint32 extraAlpha) noexcept
+    {
+        if (extraAlpha >= 256)
+        {
+            do
+            {
+                dest->blend (*src);
+                dest = addBytesToPointer (dest, destStride);
+                src  = addBytesToPointer (src, srcStride);
+            } while (--width > 0);
+        }
+        else
+        {
+            do
+            {
+                dest->blend (*src, extraAlpha);
+                dest = addBytesToPointer (dest, destStride);
+                src  = addBytesToPointer (src, srcStride);
+            } while (--width > 0);
+        }
+    }
+
+    forcedinline void blendSpan (PixelARGB* dest, PixelARGB colour, int width, int destStride) noexcept
+    {
+        if (destStride == (int) sizeof (PixelARGB))
+            PixelSpanOperations::blend (dest, colour, width);
+        else
+            blendSpan<PixelARGB> (dest, colour, width, destStride);
+    }
+
+    forcedinline void blendSpan (PixelRGB* dest, PixelARGB colour, int width, int destStride) noexcept
+    {
+        if (destStride == (int) sizeof (PixelRGB))
+            PixelSpanOperations::blend (dest, colour, width);
+        else
+            blendSpan<PixelRGB> (dest, colour, width, destStride);
+    }
+
+    forcedinline void blendSpan (PixelARGB* dest, const PixelARGB* src, int width,
+                                 int destStride, int srcStride, uint32 extraAlpha) noexcept
+    {
+        if (destStride == (int) sizeof (PixelARGB) && srcStride == (int) sizeof (PixelARGB))
+            PixelSpanOperations::blend (dest, src, width, extraAlpha);
+        else
+            blendSpan<PixelARGB, PixelARGB> (dest, src, width, destStride, srcStride, extraAlpha);
+    }
+
+    forcedinline void blendSpan (PixelRGB* dest, const PixelARGB* src, int width,
+                                 int destStride, int srcStride, uint32 extraAlpha) noexcept
+    {
+        if (destStride == (int) sizeof (PixelRGB) && srcStride == (int) sizeof (PixelARGB))
+            PixelSpanOperations::blend (dest, src, width, extraAlpha);
+        else
+            blendSpan<PixelRGB, PixelARGB> (dest, src, width, destStride, srcStride, extraAlpha);
+    }
+
+    //==============================================================================
     /** Fills an edge-table with a solid colour. */
     template <class PixelType, bool replaceExisting = false>
     struct SolidColour
@@ -576,19 +919,6 @@ namespace EdgeTableFillers
         SolidColour (const Image::BitmapData& image, PixelARGB colour)
             : destData (image), sourceColour (colour)
         {
-            if (sizeof (PixelType) == 3 && (size_t) destData.pixelStride == sizeof (PixelType))
-            {
-                areRGBComponentsEqual = sourceColour.getRed() == sourceColour.getGreen()
-                                            && sourceColour.getGreen() == sourceColour.getBlue();
-                filler[0].set (sourceColour);
-                filler[1].set (sourceColour);
-                filler[2].set (sourceColour);
-                filler[3].set (sourceColour);
-            }
-            else
-            {
-                areRGBComponentsEqual = false;
-            }
         }
 
         forcedinline void setEdgeTableYPos (int y) noexcept
@@ -670,8 +1000,6 @@ namespace EdgeTableFillers
         const Image::BitmapData& destData;
         PixelType* linePixels;
         PixelARGB sourceColour;
-        PixelRGB filler[4];
-        bool areRGBComponentsEqual;
 
         forcedinline PixelType* getPixel (int x) const noexcept
         {
@@ -680,52 +1008,15 @@ namespace EdgeTableFillers
 
         inline void blendLine (PixelType* dest, PixelARGB colour, int width) const noexcept
         {
-            JUCE_PERFORM_PIXEL_OP_LOOP (blend (colour))
+            blendSpan (dest, colour, width, destData.pixelStride);
         }
 
         forcedinline void replaceLine (PixelRGB* dest, PixelARGB colour, int width) const noexcept
         {
             if ((size_t) destData.pixelStride == sizeof (*dest))
-            {
-                if (areRGBComponentsEqual)  // if all the component values are the same, we can cheat..
-                {
-                    memset ((void*) dest, colour.getRed(), (size_t) width * 3);
-                }
-                else
-                {
-                    if (width >> 5)
-                    {
-                        auto intFiller = reinterpret_cast<const int*> (filler);
-
-                        while (width > 8 && (((pointer_sized_int) dest) & 7) != 0)
-                        {
-                            dest->set (colour);
-                            ++dest;
-                            --width;
-                        }
-
-                        while (width > 4)
-                        {
-                            auto d = reinterpret_cast<int*> (dest);
-                            *d++ = intFiller[0];
-                            *d++ = intFiller[1];
-                            *d++ = intFiller[2];
-                            dest = reinterpret_cast<PixelRGB*> (d);
-                            width -= 4;
-                        }
-                    }
-
-                    while (--width >= 0)
-                    {
-                        dest->set (colour);
-                        ++dest;
-                    }
-                }
-            }
+                PixelSpanOperations::fill (dest, colour, width);
             else
-            {
                 JUCE_PERFORM_PIXEL_OP_LOOP (set (colour))
-            }
         }
 
         forcedinline void replaceLine (PixelAlpha* dest, const PixelARGB colour, int width) const noexcept
@@ -738,7 +1029,10 @@ namespace EdgeTableFillers
 
         forcedinline void replaceLine (PixelARGB* dest, const PixelARGB colour, int width) const noexcept
         {
-            JUCE_PERFORM_PIXEL_OP_LOOP (set (colour))
+            if ((size_t) destData.pixelStride == sizeof (*dest))
+                PixelSpanOperations::fill (dest, colour, width);
+            else
+                JUCE_PERFORM_PIXEL_OP_LOOP (set (colour))
         }
 
         JUCE_DECLARE_NON_COPYABLE (SolidColour)
@@ -774,18 +1068,12 @@ namespace EdgeTableFillers
 
         void handleEdgeTableLine (int x, int width, int alphaLevel) const noexcept
         {
-            auto* dest = getPixel (x);
-
-            if (alphaLevel < 0xff)
-                JUCE_PERFORM_PIXEL_OP_LOOP (blend (GradientType::getPixel (x++), (uint32) alphaLevel))
-            else
-                JUCE_PERFORM_PIXEL_OP_LOOP (blend (GradientType::getPixel (x++)))
+            blendLine (x, width, alphaLevel < 0xff ? (uint32) alphaLevel : 256);
         }
 
         void handleEdgeTableLineFull (int x, int width) const noexcept
         {
-            auto* dest = getPixel (x);
-            JUCE_PERFORM_PIXEL_OP_LOOP (blend (GradientType::getPixel (x++)))
+            blendLine (x, width, 256);
         }
 
         void handleEdgeTableRectangle (int x, int y, int width, int height, int alphaLevel) noexcept
@@ -815,6 +1103,23 @@ namespace EdgeTableFillers
             return addBytesToPointer (linePixels, x * destData.pixelStride);
         }
 
+        void blendLine (int x, int width, uint32 extraAlpha) const noexcept
+        {
+            auto* dest = getPixel (x);
+            PixelARGB colours[64];
+
+            while (width > 0)
+            {
+                auto num = jmin (width, (int) numElementsInArray (colours));
+                GradientType::generate (colours, x, num);
+                blendSpan (dest, colours, num, destData.pixelStride, (int) sizeof (PixelARGB), extraAlpha);
+
+                dest = addBytesToPointer (dest, num * destData.pixelStride);
+                x += num;
+                width -= num;
+            }
+        }
+
         JUCE_DECLARE_NON_COPYABLE (Gradient)
     };
 
@@ -860,49 +1165,12 @@ namespace EdgeTableFillers
 
         void handleEdgeTableLine (int x, int width, int alphaLevel) const noexcept
         {
-            auto* dest = getDestPixel (x);
-            alphaLevel = (alphaLevel * extraAlpha) >> 8;
-            x -= xOffset;
-
-            if (repeatPattern)
-            {
-                if (alphaLevel < 0xfe)
-                    JUCE_PERFORM_PIXEL_OP_LOOP (blend (*getSrcPixel (x++ % srcData.width), (uint32) alphaLevel))
-                else
-                    JUCE_PERFORM_PIXEL_OP_LOOP (blend (*getSrcPixel (x++ % srcData.width)))
-            }
-            else
-            {
-                jassert (x >= 0 && x + width <= srcData.width);
-
-                if (alphaLevel < 0xfe)
-                    JUCE_PERFORM_PIXEL_OP_LOOP (blend (*getSrcPixel (x++), (uint32) alphaLevel))
-                else
-                    copyRow (dest, getSrcPixel (x), width);
-            }
+            blendLine (x, width, (alphaLevel * extraAlpha) >> 8);
         }
 
         void handleEdgeTableLineFull (int x, int width) const noexcept
         {
-            auto* dest = getDestPixel (x);
-            x -= xOffset;
-
-            if (repeatPattern)
-            {
-                if (extraAlpha < 0xfe)
-                    JUCE_PERFORM_PIXEL_OP_LOOP (blend (*getSrcPixel (x++ % srcData.width), (uint32) extraAlpha))
-                else
-                    JUCE_PERFORM_PIXEL_OP_LOOP (blend (*getSrcPixel (x++ % srcData.width)))
-            }
-            else
-            {
-                jassert (x >= 0 && x + width <= srcData.width);
-
-                if (extraAlpha < 0xfe)
-                    JUCE_PERFORM_PIXEL_OP_LOOP (blend (*getSrcPixel (x++), (uint32) extraAlpha))
-                else
-                    copyRow (dest, getSrcPixel (x), width);
-            }
+            blendLine (x, width, extraAlpha);
         }
 
         void handleEdgeTableRectangle (int x, int y, int width, int height, int alphaLevel) noexcept
@@ -952,12 +1220,40 @@ namespace EdgeTableFillers
             return addBytesToPointer (sourceLineStart, x * srcData.pixelStride);
         }
 
-        forcedinline void copyRow (DestPixelType* dest, SrcPixelType const* src, int width) const noexcept
+        void blendLine (int x, int width, int alphaLevel) const noexcept
+        {
+            auto* dest = getDestPixel (x);
+            x -= xOffset;
+
+            if (repeatPattern)
+            {
+                // the source is blended in runs that don't wrap around its right-hand edge
+                x %= srcData.width;
+
+                while (width > 0)
+                {
+                    auto num = jmin (width, srcData.width - x);
+                    blendRow (dest, getSrcPixel (x), num, alphaLevel);
+
+                    dest = addBytesToPointer (dest, num * destData.pixelStride);
+                    x = 0;
+                    width -= num;
+                }
+            }
+            else
+            {
+                jassert (x >= 0 && x + width <= srcData.width);
+                blendRow (dest, getSrcPixel (x), width, alphaLevel);
+            }
+        }
+
+        forcedinline void blendRow (DestPixelType* dest, SrcPixelType const* src, int width, int alphaLevel) const noexcept
         {
             auto destStride = destData.pixelStride;
             auto srcStride  = srcData.pixelStride;
 
-            if (destStride == srcStride
+            if (alphaLevel >= 0xfe
+                 && destStride == srcStride
                  && srcData.pixelFormat  == Image::RGB
                  && destData.pixelFormat == Image::RGB)
             {
@@ -965,12 +1261,7 @@ namespace EdgeTableFillers
             }
             else
             {
-                do
-                {
-                    dest->blend (*src);
-                    dest = addBytesToPointer (dest, destStride);
-                    src  = addBytesToPointer (src, srcStride);
-                } while (--width > 0);
+                blendSpan (dest, src, width, destStride, srcStride, alphaLevel < 0xfe ? (uint32) alphaLevel : 256);
             }
         }
 
@@ -1030,14 +1321,11 @@ namespace EdgeTableFillers
             SrcPixelType* span = scratchBuffer;
             generate (span, x, width);
 
-            auto* dest = getDestPixel (x);
             alphaLevel *= extraAlpha;
             alphaLevel >>= 8;
 
-            if (alphaLevel < 0xfe)
-                JUCE_PERFORM_PIXEL_OP_LOOP (blend (*span++, (uint32) alphaLevel))
-            else
-                JUCE_PERFORM_PIXEL_OP_LOOP (blend (*span++))
+            blendSpan (getDestPixel (x), span, width, destData.pixelStride, (int) sizeof (SrcPixelType),
+                       alphaLevel < 0xfe ? (uint32) alphaLevel : 256);
         }
 
         forcedinline void handleEdgeTableLineFull (int x, int width) noexcept
@@ -1091,6 +1379,22 @@ namespace EdgeTableFillers
         {
             this->interpolator.setStartOfLine ((float) x, (float) currentY, numPixels);
 
+            // runs of pixels that lie inside the image get interpolated together
+            enum { maxBatchSize = 32 };
+            const uint8* batchSources[maxBatchSize];
+            uint8 batchSubPixelX[maxBatchSize], batchSubPixelY[maxBatchSize];
+            PixelType* batchStart = dest;
+            int batchSize = 0;
+
+            auto flushBatch = [&]
+            {
+                if (batchSize > 0)
+                {
+                    renderPixelAverages (batchStart, batchSources, batchSubPixelX, batchSubPixelY, batchSize);
+                    batchSize = 0;
+                }
+            };
+
             do
             {
                 int hiResX, hiResY;
@@ -1112,12 +1416,22 @@ namespace EdgeTableFillers
                         if (isPositiveAndBelow (loResY, maxY))
                         {
                             // In the centre of the image..
-                            render4PixelAverage (dest, this->srcData.getPixelPointer (loResX, loResY),
-                                                 hiResX & 255, hiResY & 255);
+                            if (batchSize == 0)
+                                batchStart = dest;
+
+                            batchSources[batchSize]   = this->srcData.getPixelPointer (loResX, loResY);
+                            batchSubPixelX[batchSize] = (uint8) (hiResX & 255);
+                            batchSubPixelY[batchSize] = (uint8) (hiResY & 255);
+
+                            if (++batchSize == (int) maxBatchSize)
+                                flushBatch();
+
                             ++dest;
                             continue;
                         }
 
+                        flushBatch();
+
                         if (! repeatPattern)
                         {
                             // At a top or bottom edge..
@@ -1132,6 +1446,8 @@ namespace EdgeTableFillers
                     }
                     else
                     {
+                        flushBatch();
+
                         if (isPositiveAndBelow (loResY, maxY) && ! repeatPattern)
                         {
                             // At a left or right hand edge..
@@ -1154,10 +1470,36 @@ namespace EdgeTableFillers
                     if (loResY > maxY)  loResY = maxY;
                 }
 
+                flushBatch();
                 dest->set (*(const PixelType*) this->srcData.getPixelPointer (loResX, loResY));
                 ++dest;
 
             } while (--numPixels > 0);
+
+            flushBatch();
+        }
+
+        //==============================================================================
+        void renderPixelAverages (PixelARGB* dest, const uint8* const* sources, const uint8* subPixelX,
+                                  const uint8* subPixelY, int num) noexcept
+        {
+            if (this->srcData.pixelStride == (int) sizeof (PixelARGB))
+            {
+                PixelSpanOperations::bilinearInterpolate (dest, sources, subPixelX, subPixelY, this->srcData.lineStride, num);
+            }
+            else
+            {
+                for (int i = 0; i < num; ++i)
+                    render4PixelAverage (dest + i, sources[i], subPixelX[i], subPixelY[i]);
+            }
+        }
+
+        template <class PixelType>
+        void renderPixelAverages (PixelType* dest, const uint8* const* sources, const uint8* subPixelX,
+                                  const uint8* subPixelY, int num) noexcept
+        {
+            for (int i = 0; i < num; ++i)
+                render4PixelAverage (dest + i, sources[i], subPixelX[i], subPixelY[i]);
         }
 
         //==============================================================================
@@ -1616,6 +1958,33 @@ namespace EdgeTableFillers
             iter.iterate (renderer);
         }
     }
+
+    /** Blends a colour into a rectangle of the destination, using the levels in an 8-bit mask
+        as the alpha of each pixel.
+    */
+    template <class DestPixelType>
+    void renderCoverageMask (const Image::BitmapData& destData, Rectangle<int> area, const uint8* mask, int maskLineStride,
+                             PixelARGB colour, DestPixelType*) noexcept
+    {
+        for (int y = area.getY(); y < area.getBottom(); ++y)
+        {
+            auto* dest = (DestPixelType*) destData.getPixelPointer (area.getX(), y);
+
+            for (int x = 0; x < area.getWidth(); ++x)
+            {
+                auto level = (int) mask[x];
+
+                if (level >= 255)
+                    dest->blend (colour);
+                else if (level > 0)
+                    dest->blend (colour, (uint32) level);
+
+                dest = addBytesToPointer (dest, destData.pixelStride);
+            }
+
+            mask += maskLineStride;
+        }
+    }
 }
 
 //==============================================================================
@@ -1630,6 +1999,7 @@ struct ClipRegions
         using Ptr = ReferenceCountedObjectPtr<Base>;
 
         virtual Ptr clone() const = 0;
+        virtual Ptr cloneClippedTo (Rectangle<int>) const = 0;
         virtual Ptr applyClipTo (const Ptr& target) const = 0;
 
         virtual Ptr clipToRectangle (Rectangle<int>) = 0;
@@ -1643,6 +2013,10 @@ struct ClipRegions
         virtual bool clipRegionIntersects (Rectangle<int>) const = 0;
         virtual Rectangle<int> getClipBounds() const = 0;
 
+        // (this is true if every pixel of the rectangle is fully inside the region - it's only
+        // used to choose faster ways of drawing, so a region can return false if it's not sure)
+        virtual bool coversRectangle (Rectangle<int>) const = 0;
+
         virtual void fillRectWithColour (SavedStateType&, Rectangle<int>, PixelARGB colour, bool replaceContents) const = 0;
         virtual void fillRectWithColour (SavedStateType&, Rectangle<float>, PixelARGB colour) const = 0;
         virtual void fillAllWithColour (SavedStateType&, PixelARGB colour, bool replaceContents) const = 0;
@@ -1660,6 +2034,7 @@ struct ClipRegions
         EdgeTableRegion (const RectangleList<int>& r)   : edgeTable (r) {}
         EdgeTableRegion (const RectangleList<float>& r) : edgeTable (r) {}
         EdgeTableRegion (Rectangle<int> bounds, const Path& p, const AffineTransform& t) : edgeTable (bounds, p, t) {}
+        EdgeTableRegion (const EdgeTable& e, Rectangle<int> area)   : edgeTable (e, area) {}
 
         EdgeTableRegion (const EdgeTableRegion& other)  : Base(), edgeTable (other.edgeTable) {}
         EdgeTableRegion& operator= (const EdgeTableRegion&) = delete;
@@ -1667,6 +2042,13 @@ struct ClipRegions
         using Ptr = typename Base::Ptr;
 
         Ptr clone() const override                           { return *new EdgeTableRegion (*this); }
+
+        Ptr cloneClippedTo (Rectangle<int> r) const override
+        {
+            Ptr c (*new EdgeTableRegion (edgeTable, r));
+            return c->getClipBounds().isEmpty() ? Ptr() : c;
+        }
+
         Ptr applyClipTo (const Ptr& target) const override   { return target->clipToEdgeTable (edgeTable); }
 
         Ptr clipToRectangle (Rectangle<int> r) override
@@ -1765,6 +2147,11 @@ struct ClipRegions
             return edgeTable.getMaximumBounds();
         }
 
+        bool coversRectangle (Rectangle<int>) const override
+        {
+            return false;
+        }
+
         void fillRectWithColour (SavedStateType& state, Rectangle<int> area, PixelARGB colour, bool replaceContents) const override
         {
             auto totalClip = edgeTable.getMaximumBounds();
@@ -1848,6 +2235,7 @@ struct ClipRegions
         using Ptr = typename Base::Ptr;
 
         Ptr clone() const override                           { return *new RectangleListRegion (*this); }
+        Ptr cloneClippedTo (Rectangle<int> r) const override  { return clone()->clipToRectangle (r); }
         Ptr applyClipTo (const Ptr& target) const override   { return target->clipToRectangleList (clip); }
 
         Ptr clipToRectangle (Rectangle<int> r) override
@@ -1880,6 +2268,15 @@ struct ClipRegions
         bool clipRegionIntersects (Rectangle<int> r) const override   { return clip.intersects (r); }
         Rectangle<int> getClipBounds() const override                 { return clip.getBounds(); }
 
+        bool coversRectangle (Rectangle<int> r) const override
+        {
+            for (auto& i : clip)
+                if (i.contains (r))
+                    return true;
+
+            return false;
+        }
+
         void fillRectWithColour (SavedStateType& state, Rectangle<int> area, PixelARGB colour, bool replaceContents) const override
         {
             SubRectangleIterator iter (clip, area);
@@ -2026,22 +2423,13 @@ struct ClipRegions
                             auto y2 = jmin (f.bottom, clipBottom);
                             auto h = y2 - y1;
 
+                            // N.B. single-row clip rectangles go through the same calls as taller ones, so that
+                            // the result doesn't depend on how the clip list happens to be split into rectangles
                             if (h > 0)
                             {
-                                if (h == 1)
-                                {
-                                    r.setEdgeTableYPos (y1);
-
-                                    if (doLeftAlpha)        r.handleEdgeTablePixel (f.totalLeft, f.leftAlpha);
-                                    if (clippedWidth > 0)   r.handleEdgeTableLineFull (clippedLeft, clippedWidth);
-                                    if (doRightAlpha)       r.handleEdgeTablePixel (f.right, f.rightAlpha);
-                                }
-                                else
-                                {
-                                    if (doLeftAlpha)        r.handleEdgeTableRectangle (f.totalLeft, y1, 1, h, f.leftAlpha);
-                                    if (clippedWidth > 0)   r.handleEdgeTableRectangleFull (clippedLeft, y1, clippedWidth, h);
-                                    if (doRightAlpha)       r.handleEdgeTableRectangle (f.right, y1, 1, h, f.rightAlpha);
-                                }
+                                if (doLeftAlpha)        r.handleEdgeTableRectangle (f.totalLeft, y1, 1, h, f.leftAlpha);
+                                if (clippedWidth > 0)   r.handleEdgeTableRectangleFull (clippedLeft, y1, clippedWidth, h);
+                                if (doRightAlpha)       r.handleEdgeTableRectangle (f.right, y1, 1, h, f.rightAlpha);
                             }
 
                             if (f.bottomAlpha != 0 && f.bottom < clipBottom)
@@ -2094,7 +2482,8 @@ public:
     SavedStateBase (const SavedStateBase& other)
         : clip (other.clip), transform (other.transform), fillType (other.fillType),
           interpolationQuality (other.interpolationQuality),
-          transparencyLayerAlpha (other.transparencyLayerAlpha)
+          transparencyLayerAlpha (other.transparencyLayerAlpha),
+          pathCachingEnabled (other.pathCachingEnabled)
     {
     }
 
@@ -2256,7 +2645,7 @@ public:
     {
         if (fillType.isColour())
         {
-            clip->fillRectWithColour (getThis(), r, fillType.colour.getPixelARGB(), replaceContents);
+            getThis().fillRegionRect (*clip, r, fillType.colour.getPixelARGB(), replaceContents);
         }
         else
         {
@@ -2271,7 +2660,7 @@ public:
     {
         if (fillType.isColour())
         {
-            clip->fillRectWithColour (getThis(), r, fillType.colour.getPixelARGB());
+            getThis().fillRegionRect (*clip, r, fillType.colour.getPixelARGB());
         }
         else
         {
@@ -2360,10 +2749,34 @@ public:
             auto clipRect = clip->getClipBounds();
 
             if (path.getBoundsTransformed (trans).getSmallestIntegerContainer().intersects (clipRect))
+            {
+                if (pathCachingEnabled)
+                {
+                    Point<int> offset;
+
+                    if (auto cached = PathCache::getEdgeTable (path, trans, offset))
+                    {
+                        auto* edgeTableClip = new EdgeTableRegionType (*cached, clipRect - offset);
+                        edgeTableClip->edgeTable.translate ((float) offset.x, offset.y);
+                        fillShape (*edgeTableClip, false);
+                        return;
+                    }
+                }
+
                 fillShape (*new EdgeTableRegionType (clipRect, path, trans), false);
+            }
         }
     }
 
+    /** Returns the amount by which fillEdgeTable() boosts the levels of a glyph that's
+        drawn in the given colour, as light-coloured text is drawn slightly bolder.
+    */
+    static float getGlyphLevelMultiplier (Colour colour) noexcept
+    {
+        auto brightness = colour.getBrightness() - 0.5f;
+        return brightness > 0.0f ? 1.0f + 1.6f * brightness : 1.0f;
+    }
+
     void fillEdgeTable (const EdgeTable& edgeTable, float x, int y)
     {
         if (clip != nullptr)
@@ -2373,10 +2786,10 @@ public:
 
             if (fillType.isColour())
             {
-                auto brightness = fillType.colour.getBrightness() - 0.5f;
+                auto multiplier = getGlyphLevelMultiplier (fillType.colour);
 
-                if (brightness > 0.0f)
-                    edgeTableClip->edgeTable.multiplyLevels (1.0f + 1.6f * brightness);
+                if (multiplier != 1.0f)
+                    edgeTableClip->edgeTable.multiplyLevels (multiplier);
             }
 
             fillShape (*edgeTableClip, false);
@@ -2422,7 +2835,7 @@ public:
 
                 if (tiledFillClipRegion != nullptr)
                 {
-                    tiledFillClipRegion->renderImageUntransformed (getThis(), sourceImage, alpha, tx, ty, true);
+                    getThis().renderRegionImageUntransformed (*tiledFillClipRegion, sourceImage, alpha, tx, ty, true);
                 }
                 else
                 {
@@ -2431,7 +2844,7 @@ public:
 
                     if (! area.isEmpty())
                         if (auto c = clip->applyClipTo (*new EdgeTableRegionType (area)))
-                            c->renderImageUntransformed (getThis(), sourceImage, alpha, tx, ty, false);
+                            getThis().renderRegionImageUntransformed (*c, sourceImage, alpha, tx, ty, false);
                 }
 
                 return;
@@ -2442,8 +2855,8 @@ public:
         {
             if (tiledFillClipRegion != nullptr)
             {
-                tiledFillClipRegion->renderImageTransformed (getThis(), sourceImage, alpha,
-                                                             t, interpolationQuality, true);
+                getThis().renderRegionImageTransformed (*tiledFillClipRegion, sourceImage, alpha,
+                                                        t, interpolationQuality, true);
             }
             else
             {
@@ -2451,8 +2864,8 @@ public:
                 p.addRectangle (sourceImage.getBounds());
 
                 if (auto c = clip->clone()->clipToPath (p, t))
-                    c->renderImageTransformed (getThis(), sourceImage, alpha,
-                                               t, interpolationQuality, false);
+                    getThis().renderRegionImageTransformed (*c, sourceImage, alpha,
+                                                            t, interpolationQuality, false);
             }
         }
     }
@@ -2482,7 +2895,7 @@ public:
                     t = {};
                 }
 
-                shapeToFill->fillAllWithGradient (getThis(), g2, t, isIdentity);
+                getThis().fillRegionWithGradient (*shapeToFill, g2, t, isIdentity);
             }
             else if (fillType.isTiledImage())
             {
@@ -2490,11 +2903,45 @@ public:
             }
             else
             {
-                shapeToFill->fillAllWithColour (getThis(), fillType.colour.getPixelARGB(), replaceContents);
+                getThis().fillRegionWithColour (*shapeToFill, fillType.colour.getPixelARGB(), replaceContents);
             }
         }
     }
 
+    //==============================================================================
+    // These are the points at which a region finally gets drawn into the target. A
+    // SavedStateType can provide its own versions of them if it needs to intercept them.
+    void fillRegionRect (const BaseRegionType& region, Rectangle<int> r, PixelARGB colour, bool replaceContents)
+    {
+        region.fillRectWithColour (getThis(), r, colour, replaceContents);
+    }
+
+    void fillRegionRect (const BaseRegionType& region, Rectangle<float> r, PixelARGB colour)
+    {
+        region.fillRectWithColour (getThis(), r, colour);
+    }
+
+    void fillRegionWithColour (const BaseRegionType& region, PixelARGB colour, bool replaceContents)
+    {
+        region.fillAllWithColour (getThis(), colour, replaceContents);
+    }
+
+    void fillRegionWithGradient (const BaseRegionType& region, ColourGradient& gradient, const AffineTransform& t, bool isIdentity)
+    {
+        region.fillAllWithGradient (getThis(), gradient, t, isIdentity);
+    }
+
+    void renderRegionImageTransformed (const BaseRegionType& region, const Image& src, int alpha, const AffineTransform& t,
+                                       Graphics::ResamplingQuality quality, bool tiledFill)
+    {
+        region.renderImageTransformed (getThis(), src, alpha, t, quality, tiledFill);
+    }
+
+    void renderRegionImageUntransformed (const BaseRegionType& region, const Image& src, int alpha, int x, int y, bool tiledFill)
+    {
+        region.renderImageUntransformed (getThis(), src, alpha, x, y, tiledFill);
+    }
+
     void cloneClipIfMultiplyReferenced()
     {
         if (clip->getReferenceCount() > 1)
@@ -2506,6 +2953,86 @@ public:
     FillType fillType;
     Graphics::ResamplingQuality interpolationQuality;
     float transparencyLayerAlpha;
+    bool pathCachingEnabled = false;
+};
+
+//==============================================================================
+class SoftwareRendererSavedState;
+
+/** Collects the drawing operations of a software renderer, so that they can be rendered
+    later using several threads.
+
+    Each operation is a clip region plus a function that draws it. When the list is
+    flushed, the operations are binned into horizontal bands spanning the whole width of
+    the target, and each band is drawn on its own thread by replaying its operations with
+    their regions clipped to the band. As every scanline is still rendered by exactly the
+    same code, the results are identical to rendering the operations directly.
+
+    @tags{Graphics}
+*/
+class SoftwareRendererDisplayList  : private ImagePixelData::Listener
+{
+public:
+    using RegionType = ClipRegions<SoftwareRendererSavedState>::Base;
+    using Operation  = std::function<void (const RegionType&, SoftwareRendererSavedState&)>;
+
+    SoftwareRendererDisplayList (const Image& mainTarget, int numThreadsToUse);
+    ~SoftwareRendererDisplayList() override;
+
+    /** Adds an operation that draws a region into one of the target images.
+        The target's position relative to the main target must be given, and areaAffected
+        is the area of the target that the operation could touch.
+    */
+    void add (const Image& target, Point<int> targetOffset, const RegionType& region,
+              Rectangle<int> areaAffected, Operation operation);
+
+    /** Returns true if the image is one of the ones being drawn into. */
+    bool isTarget (const Image&) const noexcept;
+
+    /** Returns the position of one of the target images relative to the main target. */
+    Point<int> getTargetOffset (const Image&) const noexcept;
+
+    /** Returns an image that can safely be read by the rendering threads in place of the
+        one supplied. If the source image gets modified before the list is flushed, the
+        pending operations will be flushed first.
+    */
+    Image prepareSourceImage (const Image&);
+
+    /** Renders all the pending operations, and returns when they're complete. */
+    void flush();
+
+    /** Returns the number of threads that the list renders with. */
+    int getNumThreads() const noexcept      { return numThreads; }
+
+private:
+    //==============================================================================
+    struct Target
+    {
+        Image image;
+        Point<int> offset;
+    };
+
+    struct Command
+    {
+        int targetIndex;
+        RegionType::Ptr region;
+        Rectangle<int> bounds;  // relative to the main target
+        Operation operation;
+    };
+
+    Array<Target> targets;
+    std::vector<Command> commands;
+    ReferenceCountedArray<ImagePixelData> watchedImages;
+    const int numThreads;
+    bool isFlushing = false;
+
+    int getTargetIndex (const Image&) const noexcept;
+    void renderBand (Rectangle<int> band, const Array<int>& commandIndexes, const OwnedArray<SoftwareRendererSavedState>&) const;
+
+    void imageDataChanged (ImagePixelData*) override;
+    void imageDataBeingDeleted (ImagePixelData*) override;
+
+    JUCE_DECLARE_NON_COPYABLE (SoftwareRendererDisplayList)
 };
 
 //==============================================================================
@@ -2539,6 +3066,7 @@ public:
             s->transform.moveOriginInDeviceSpace (-layerBounds.getPosition());
             s->cloneClipIfMultiplyReferenced();
             s->clip->translate (-layerBounds.getPosition());
+            s->displayListOffset += layerBounds.getPosition();
         }
 
         return s;
@@ -2550,13 +3078,25 @@ public:
         {
             auto layerBounds = clip->getClipBounds();
 
+            if (displayList != nullptr)
+            {
+                // (this does the same as drawing the layer using a new context on our image, but
+                // adds the operation to our display list rather than rendering it immediately)
+                SoftwareRendererSavedState s (image, image.getBounds());
+                s.displayList = displayList;
+                s.displayListOffset = displayListOffset;
+                s.fillType.setOpacity (finishedLayerState.transparencyLayerAlpha);
+                s.drawImage (finishedLayerState.image, AffineTransform::translation (layerBounds.getPosition()));
+                return;
+            }
+
             const std::unique_ptr<LowLevelGraphicsContext> g (image.createLowLevelContext());
             g->setOpacity (finishedLayerState.transparencyLayerAlpha);
             g->drawImage (finishedLayerState.image, AffineTransform::translation (layerBounds.getPosition()));
         }
     }
 
-    using GlyphCacheType = GlyphCache<CachedGlyphEdgeTable<SoftwareRendererSavedState>, SoftwareRendererSavedState>;
+    using GlyphCacheType = GlyphCache<CachedGlyphCoverageMask<SoftwareRendererSavedState>, SoftwareRendererSavedState>;
 
     static void clearGlyphCache()
     {
@@ -2607,36 +3147,217 @@ public:
         }
     }
 
+    /** Returns the brightness level (the largest of the colour's components) of the current
+        fill if it's light enough for glyphs to be boosted by getGlyphLevelMultiplier(), or 0
+        if not. As the multiplier only depends on this, cached glyphs are told apart by a
+        rounded version of it.
+    */
+    int getGlyphBrightnessLevel() const noexcept
+    {
+        if (fillType.isColour() && getGlyphLevelMultiplier (fillType.colour) != 1.0f)
+        {
+            auto& c = fillType.colour;
+            return jmax (c.getRed(), c.getGreen(), c.getBlue());
+        }
+
+        return 0;
+    }
+
+    void drawGlyphCoverageMask (const GlyphAtlas::Space::Ptr& space, Point<int> position)
+    {
+        auto maskArea = space->area;
+        auto area = maskArea.withPosition (position);
+
+        if (clip == nullptr || ! clip->clipRegionIntersects (area))
+            return;
+
+        auto maskOffset = maskArea.getPosition() - position;
+
+        if (fillType.isColour() && clip->coversRectangle (area))
+        {
+            auto colour = fillType.colour.getPixelARGB();
+
+            if (displayList == nullptr)
+                return blendCoverageMask (area, *space->page, maskOffset, colour);
+
+            typename BaseRegionType::Ptr region (new RectangleListRegionType (area));
+
+            // (holding the space stops it being re-used before this gets drawn)
+            addToDisplayList (*region, area, [space, maskOffset, colour] (const BaseRegionType& clipped, SoftwareRendererSavedState& s)
+            {
+                s.blendCoverageMask (clipped.getClipBounds(), *space->page, maskOffset, colour);
+            });
+
+            return;
+        }
+
+        // Anything else gets drawn by turning the mask into an edge-table..
+        auto* shape = new EdgeTableRegionType (area);
+
+        for (int y = 0; y < area.getHeight(); ++y)
+            shape->edgeTable.clipLineToMask (area.getX(), area.getY() + y,
+                                             space->page->getPixelPointer (maskArea.getX(), maskArea.getY() + y),
+                                             1, area.getWidth());
+
+        fillShape (*shape, false);
+    }
+
     Rectangle<int> getMaximumBounds() const     { return image.getBounds(); }
 
+    void clipToImageAlpha (const Image& sourceImage, const AffineTransform& t)
+    {
+        // the image's pixels are needed right now, so make sure any drawing into it is finished
+        if (displayList != nullptr && displayList->isTarget (sourceImage))
+            displayList->flush();
+
+        BaseClass::clipToImageAlpha (sourceImage, t);
+    }
+
+    //==============================================================================
+    void fillRegionRect (const BaseRegionType& region, Rectangle<int> r, PixelARGB colour, bool replaceContents)
+    {
+        if (displayList == nullptr)
+            return BaseClass::fillRegionRect (region, r, colour, replaceContents);
+
+        addToDisplayList (region, r, [r, colour, replaceContents] (const BaseRegionType& clipped, SoftwareRendererSavedState& s)
+        {
+            clipped.fillRectWithColour (s, r, colour, replaceContents);
+        });
+    }
+
+    void fillRegionRect (const BaseRegionType& region, Rectangle<float> r, PixelARGB colour)
+    {
+        if (displayList == nullptr)
+            return BaseClass::fillRegionRect (region, r, colour);
+
+        addToDisplayList (region, r.getSmallestIntegerContainer(), [r, colour] (const BaseRegionType& clipped, SoftwareRendererSavedState& s)
+        {
+            clipped.fillRectWithColour (s, r, colour);
+        });
+    }
+
+    void fillRegionWithColour (const BaseRegionType& region, PixelARGB colour, bool replaceContents)
+    {
+        if (displayList == nullptr)
+            return BaseClass::fillRegionWithColour (region, colour, replaceContents);
+
+        addToDisplayList (region, region.getClipBounds(), [colour, replaceContents] (const BaseRegionType& clipped, SoftwareRendererSavedState& s)
+        {
+            clipped.fillAllWithColour (s, colour, replaceContents);
+        });
+    }
+
+    void fillRegionWithGradient (const BaseRegionType& region, ColourGradient& gradient, const AffineTransform& t, bool isIdentity)
+    {
+        if (displayList == nullptr)
+            return BaseClass::fillRegionWithGradient (region, gradient, t, isIdentity);
+
+        addToDisplayList (region, region.getClipBounds(), [gradient, t, isIdentity] (const BaseRegionType& clipped, SoftwareRendererSavedState& s)
+        {
+            auto g = gradient;
+            clipped.fillAllWithGradient (s, g, t, isIdentity);
+        });
+    }
+
+    void renderRegionImageTransformed (const BaseRegionType& region, const Image& src, int alpha, const AffineTransform& t,
+                                       Graphics::ResamplingQuality quality, bool tiledFill)
+    {
+        if (displayList != nullptr)
+        {
+            if (! displayList->isTarget (src))
+            {
+                auto source = displayList->prepareSourceImage (src);
+
+                addToDisplayList (region, region.getClipBounds(), [source, alpha, t, quality, tiledFill] (const BaseRegionType& clipped, SoftwareRendererSavedState& s)
+                {
+                    clipped.renderImageTransformed (s, source, alpha, t, quality, tiledFill);
+                });
+
+                return;
+            }
+
+            displayList->flush();
+        }
+
+        BaseClass::renderRegionImageTransformed (region, src, alpha, t, quality, tiledFill);
+    }
+
+    void renderRegionImageUntransformed (const BaseRegionType& region, const Image& src, int alpha, int x, int y, bool tiledFill)
+    {
+        if (displayList != nullptr)
+        {
+            // An image that is itself being drawn into can only be used by the display list if each
+            // of its lines lands on the same line of the main target, as happens when a transparency
+            // layer gets composited. Anything else needs all the pending drawing to be finished first.
+            auto isSafeToDefer = ! displayList->isTarget (src)
+                                  || (! tiledFill && displayList->getTargetOffset (src).y == displayListOffset.y + y);
+
+            if (isSafeToDefer)
+            {
+                auto source = displayList->isTarget (src) ? src : displayList->prepareSourceImage (src);
+
+                addToDisplayList (region, region.getClipBounds(), [source, alpha, x, y, tiledFill] (const BaseRegionType& clipped, SoftwareRendererSavedState& s)
+                {
+                    clipped.renderImageUntransformed (s, source, alpha, x, y, tiledFill);
+                });
+
+                return;
+            }
+
+            displayList->flush();
+        }
+
+        BaseClass::renderRegionImageUntransformed (region, src, alpha, x, y, tiledFill);
+    }
+
     //==============================================================================
     template <typename IteratorType>
     void renderImageTransformed (IteratorType& iter, const Image& src, int alpha, const AffineTransform& trans, Graphics::ResamplingQuality quality, bool tiledFill) const
     {
-        Image::BitmapData destData (image, Image::BitmapData::readWrite);
-        const Image::BitmapData srcData (src, Image::BitmapData::readOnly);
-        EdgeTableFillers::renderImageTransformed (iter, destData, srcData, alpha, trans, quality, tiledFill);
+        renderIntoTarget ([&] (const Image::BitmapData& destData)
+        {
+            const Image::BitmapData srcData (src, Image::BitmapData::readOnly);
+            EdgeTableFillers::renderImageTransformed (iter, destData, srcData, alpha, trans, quality, tiledFill);
+        });
     }
 
     template <typename IteratorType>
     void renderImageUntransformed (IteratorType& iter, const Image& src, int alpha, int x, int y, bool tiledFill) const
     {
-        Image::BitmapData destData (image, Image::BitmapData::readWrite);
-        const Image::BitmapData srcData (src, Image::BitmapData::readOnly);
-        EdgeTableFillers::renderImageUntransformed (iter, destData, srcData, alpha, x, y, tiledFill);
+        renderIntoTarget ([&] (const Image::BitmapData& destData)
+        {
+            const Image::BitmapData srcData (src, Image::BitmapData::readOnly);
+            EdgeTableFillers::renderImageUntransformed (iter, destData, srcData, alpha, x, y, tiledFill);
+        });
+    }
+
+    void blendCoverageMask (Rectangle<int> area, const GlyphAtlas::Page& page, Point<int> maskOffset, PixelARGB colour) const
+    {
+        auto* mask = page.getPixelPointer (area.getX() + maskOffset.x, area.getY() + maskOffset.y);
+
+        renderIntoTarget ([&] (const Image::BitmapData& destData)
+        {
+            switch (destData.pixelFormat)
+            {
+                case Image::ARGB:   EdgeTableFillers::renderCoverageMask (destData, area, mask, page.getLineStride(), colour, (PixelARGB*) nullptr); break;
+                case Image::RGB:    EdgeTableFillers::renderCoverageMask (destData, area, mask, page.getLineStride(), colour, (PixelRGB*) nullptr); break;
+                default:            EdgeTableFillers::renderCoverageMask (destData, area, mask, page.getLineStride(), colour, (PixelAlpha*) nullptr); break;
+            }
+        });
     }
 
     template <typename IteratorType>
     void fillWithSolidColour (IteratorType& iter, PixelARGB colour, bool replaceContents) const
     {
-        Image::BitmapData destData (image, Image::BitmapData::readWrite);
-
-        switch (destData.pixelFormat)
+        renderIntoTarget ([&] (const Image::BitmapData& destData)
         {
-            case Image::ARGB:   EdgeTableFillers::renderSolidFill (iter, destData, colour, replaceContents, (PixelARGB*) nullptr); break;
-            case Image::RGB:    EdgeTableFillers::renderSolidFill (iter, destData, colour, replaceContents, (PixelRGB*) nullptr); break;
-            default:            EdgeTableFillers::renderSolidFill (iter, destData, colour, replaceContents, (PixelAlpha*) nullptr); break;
-        }
+            switch (destData.pixelFormat)
+            {
+                case Image::ARGB:   EdgeTableFillers::renderSolidFill (iter, destData, colour, replaceContents, (PixelARGB*) nullptr); break;
+                case Image::RGB:    EdgeTableFillers::renderSolidFill (iter, destData, colour, replaceContents, (PixelRGB*) nullptr); break;
+                default:            EdgeTableFillers::renderSolidFill (iter, destData, colour, replaceContents, (PixelAlpha*) nullptr); break;
+            }
+        });
     }
 
     template <typename IteratorType>
@@ -2646,21 +3367,50 @@ public:
         auto numLookupEntries = gradient.createLookupTable (trans, lookupTable);
         jassert (numLookupEntries > 0);
 
-        Image::BitmapData destData (image, Image::BitmapData::readWrite);
-
-        switch (destData.pixelFormat)
+        renderIntoTarget ([&] (const Image::BitmapData& destData)
         {
-            case Image::ARGB:   EdgeTableFillers::renderGradient (iter, destData, gradient, trans, lookupTable, numLookupEntries, isIdentity, (PixelARGB*) nullptr); break;
-            case Image::RGB:    EdgeTableFillers::renderGradient (iter, destData, gradient, trans, lookupTable, numLookupEntries, isIdentity, (PixelRGB*) nullptr); break;
-            default:            EdgeTableFillers::renderGradient (iter, destData, gradient, trans, lookupTable, numLookupEntries, isIdentity, (PixelAlpha*) nullptr); break;
-        }
+            switch (destData.pixelFormat)
+            {
+                case Image::ARGB:   EdgeTableFillers::renderGradient (iter, destData, gradient, trans, lookupTable, numLookupEntries, isIdentity, (PixelARGB*) nullptr); break;
+                case Image::RGB:    EdgeTableFillers::renderGradient (iter, destData, gradient, trans, lookupTable, numLookupEntries, isIdentity, (PixelRGB*) nullptr); break;
+                default:            EdgeTableFillers::renderGradient (iter, destData, gradient, trans, lookupTable, numLookupEntries, isIdentity, (PixelAlpha*) nullptr); break;
+            }
+        });
     }
 
     //==============================================================================
     Image image;
     Font font;
 
+    /** If this is set, drawing operations get added to the list rather than rendered. */
+    SoftwareRendererDisplayList* displayList = nullptr;
+    /** The position of this state's image relative to the display list's main target. */
+    Point<int> displayListOffset;
+    /** While a display list is being replayed, all its threads share one BitmapData for each
+        target, so that the image only gets opened (and its listeners told about it) once.
+    */
+    const Image::BitmapData* sharedTargetData = nullptr;
+
 private:
+    template <typename RenderFunction>
+    void renderIntoTarget (RenderFunction&& render) const
+    {
+        if (sharedTargetData != nullptr)
+        {
+            render (*sharedTargetData);
+        }
+        else
+        {
+            Image::BitmapData destData (image, Image::BitmapData::readWrite);
+            render (destData);
+        }
+    }
+
+    void addToDisplayList (const BaseRegionType& region, Rectangle<int> areaAffected, SoftwareRendererDisplayList::Operation operation)
+    {
+        displayList->add (image, displayListOffset, region, region.getClipBounds().getIntersection (areaAffected), std::move (operation));
+    }
+
     SoftwareRendererSavedState& operator= (const SoftwareRendererSavedState&) = delete;
 };
 
@@ -2745,6 +3495,8 @@ public:
     void setFill (const FillType& fillType) override                             { stack->setFillType (fillType); }
     void setOpacity (float newOpacity) override                                  { stack->fillType.setOpacity (newOpacity); }
     void setInterpolationQuality (Graphics::ResamplingQuality quality) override  { stack->interpolationQuality = quality; }
+    void setPathCachingEnabled (bool shouldCache) override                      { stack->pathCachingEnabled = shouldCache; }
+    bool isPathCachingEnabled() const override                                  { return stack->pathCachingEnabled; }
     void fillRect (const Rectangle<int>& r, bool replace) override               { stack->fillRect (r, replace); }
     void fillRect (const Rectangle<float>& r) override                           { stack->fillRect (r); }
     void fillRectList (const RectangleList<float>& list) override                { stack->fillRectList (list); }
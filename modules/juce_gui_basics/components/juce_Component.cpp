@@ -253,6 +253,125 @@ struct ScalingHelpers
 
 static const char colourPropertyPrefix[] = "jcclr_";
 
+//==============================================================================
+/*  A layer holds the output of a component's paint() method, so that it can be drawn
+    again without calling paint(). Only the layers' images count towards the size limit,
+    as the rest is just a record of the area that has been painted since the component
+    was last invalidated, which is used to decide whether it's worth caching.
+
+    The layers that have images are kept in order of use, with the least recently used
+    one at the front of the list.
+
+    A layer's image holds the component's area in the device space of the context that
+    it's drawn into, and is painted with the same transform as that context, so that when
+    the context is a software renderer the pixels come out exactly as if the component
+    had been painted directly.
+*/
+struct Component::Layer
+{
+    Layer()     { ++numLayers; }
+    ~Layer()    { releaseImage(); --numLayers; }
+
+    bool allocateImage (Rectangle<int> newDeviceArea, const AffineTransform& newTransform)
+    {
+        auto numBytes = (int64) newDeviceArea.getWidth() * newDeviceArea.getHeight() * 4;
+
+        if (numBytes > maximumBytes / 4)
+            return false;
+
+        releaseLeastRecentlyUsed (maximumBytes - numBytes);
+
+        image = Image (Image::RGB, jmax (1, newDeviceArea.getWidth()), jmax (1, newDeviceArea.getHeight()), true);
+        deviceArea = newDeviceArea;
+        transform = newTransform;
+        sizeInBytes = numBytes;
+        validArea.clear();
+
+        totalBytes += sizeInBytes;
+        position = layersWithImages.insert (layersWithImages.end(), this);
+        return true;
+    }
+
+    void markAsUsed()
+    {
+        jassert (image.isValid());
+        layersWithImages.splice (layersWithImages.end(), layersWithImages, position);
+    }
+
+    void releaseImage()
+    {
+        if (image.isValid())
+        {
+            image = {};
+            validArea.clear();
+            totalBytes -= sizeInBytes;
+            layersWithImages.erase (position);
+        }
+    }
+
+    static void releaseLeastRecentlyUsed (int64 maximumTotalBytes)
+    {
+        while (totalBytes > maximumTotalBytes && ! layersWithImages.empty())
+            layersWithImages.front()->releaseImage();
+    }
+
+    /*  Makes the layer's image look like the part of a larger image that starts at the
+        device origin, so that a software renderer can draw into it using device coordinates.
+    */
+    struct DeviceSpacePixelData  : public ImagePixelData
+    {
+        DeviceSpacePixelData (const Image& im, Point<int> pos)
+            : ImagePixelData (im.getFormat(), pos.x + im.getWidth(), pos.y + im.getHeight()),
+              source (im.getPixelData()), origin (pos)
+        {
+        }
+
+        LowLevelGraphicsContext* createLowLevelContext() override
+        {
+            return new LowLevelGraphicsSoftwareRenderer (Image (this), {}, Rectangle<int> (origin.x, origin.y, width - origin.x, height - origin.y));
+        }
+
+        void initialiseBitmapData (Image::BitmapData& bitmap, int x, int y, Image::BitmapData::ReadWriteMode mode) override
+        {
+            source->initialiseBitmapData (bitmap, x - origin.x, y - origin.y, mode);
+        }
+
+        ImagePixelData::Ptr clone() override        { return new DeviceSpacePixelData (Image (source->clone()), origin); }
+        ImageType* createType() const override      { return source->createType(); }
+
+        const ImagePixelData::Ptr source;
+        const Point<int> origin;
+
+        JUCE_DECLARE_NON_COPYABLE (DeviceSpacePixelData)
+    };
+
+    void draw (Graphics& g) const
+    {
+        g.setOpacity (1.0f);
+        g.drawImageTransformed (image, AffineTransform::translation ((float) deviceArea.getX(), (float) deviceArea.getY())
+                                                      .followedBy (transform.inverted()), false);
+    }
+
+    Image image;
+    RectangleList<int> validArea;
+    Rectangle<int> deviceArea;
+    AffineTransform transform;
+    int64 sizeInBytes = 0;
+    std::list<Layer*>::iterator position;
+
+    // (these are only used on the message thread)
+    static std::list<Layer*> layersWithImages;
+    static int64 totalBytes, maximumBytes;
+    static int numLayers;
+
+    JUCE_DECLARE_NON_COPYABLE (Layer)
+};
+
+std::list<Component::Layer*> Component::Layer::layersWithImages;
+int64 Component::Layer::totalBytes = 0;
+int64 Component::Layer::maximumBytes = 64 * 1024 * 1024;
+int Component::Layer::numLayers = 0;
+
 //==============================================================================
 struct Component::ComponentHelpers
 {
@@ -445,9 +564,148 @@ struct Component::ComponentHelpers
         if (auto* cached = c.getCachedComponentImage())
             cached->releaseResources();
 
+        c.layer.reset();
+
         for (auto* child : c.childComponentList)
             releaseAllCachedImageResources (*child);
     }
+
+    //==============================================================================
+    static void invalidateLayers (Component& c, Rectangle<int> area)
+    {
+        if (c.layer != nullptr)
+            c.layer->validArea.subtract (area);
+
+        for (auto* child : c.childComponentList)
+        {
+            auto childArea = convertFromParentSpace (*child, area).getIntersection (child->getLocalBounds());
+
+            if (! childArea.isEmpty())
+                invalidateLayers (*child, childArea);
+        }
+    }
+
+    static bool canUseLayer (const Component& c)
+    {
+        if (! (c.flags.opaqueFlag && c.effect == nullptr && c.cachedImage == nullptr
+                 && c.componentTransparency == 0 && ! c.flags.dontClipGraphicsFlag))
+            return false;
+
+        bool isEnabled = false;
+
+        for (auto* p = &c; p != nullptr; p = p->parentComponent)
+        {
+            if (p->isTransformed())
+                return false;
+
+            isEnabled = isEnabled || p->flags.layerCachingFlag;
+        }
+
+        return isEnabled;
+    }
+
+    static bool getLayerDeviceArea (const Component& c, LowLevelGraphicsContext& context,
+                                    AffineTransform& transform, Rectangle<int>& deviceArea)
+    {
+        // A layer would have to be resampled when drawn at a fractional position or scale,
+        // or with a rotation, so that would look worse than painting the component directly..
+        if (! context.getSoftwareRenderingTransform (transform))
+        {
+            // Other renderers can only be matched approximately, so the layer just holds
+            // the component at the context's pixel scale..
+            auto scale = context.getPhysicalPixelScaleFactor();
+
+            if (scale != std::floor (scale))
+                return false;
+
+            transform = AffineTransform::scale (scale);
+        }
+
+        if (transform.mat01 != 0.0f || transform.mat10 != 0.0f)
+            return false;
+
+        auto area = c.getLocalBounds().toFloat().transformedBy (transform);
+        deviceArea = area.getSmallestIntegerContainer();
+
+        return area == deviceArea.toFloat()
+                && deviceArea.getX() >= 0 && deviceArea.getY() >= 0;
+    }
+
+    static void addToPaintStatistics (int ComponentPeer::PaintStatistics::* counter)
+    {
+        if (auto* stats = ComponentPeer::currentPaintStatistics)
+            ++(stats->*counter);
+    }
+
+    static void paint (Component& c, Graphics& g)
+    {
+        addToPaintStatistics (&ComponentPeer::PaintStatistics::numComponentsPainted);
+        c.paint (g);
+    }
+
+    static bool paintFromLayer (Component& c, Graphics& g, Rectangle<int> clipBounds)
+    {
+        AffineTransform transform;
+        Rectangle<int> deviceArea;
+
+        if (! (canUseLayer (c) && getLayerDeviceArea (c, g.getInternalContext(), transform, deviceArea)))
+        {
+            c.layer.reset();
+            return false;
+        }
+
+        auto area = clipBounds.getIntersection (c.getLocalBounds());
+
+        if (c.layer == nullptr)
+            c.layer.reset (new Layer());
+
+        auto& layer = *c.layer;
+
+        if (layer.image.isNull() || layer.image.getBounds() != deviceArea.withZeroOrigin())
+        {
+            // There's no point caching a component until it gets painted again in an
+            // area that hasn't been invalidated since the last time..
+            auto isRepaintingValidArea = layer.image.isNull() && layer.validArea.intersectsRectangle (area);
+            layer.releaseImage();
+            layer.validArea.add (area);
+
+            if (! (isRepaintingValidArea && layer.allocateImage (deviceArea, transform)))
+                return false;
+        }
+        else if (layer.transform != transform)
+        {
+            // Moving the component within its peer changes the rounding of its edges, so
+            // the image has to be painted again to keep the pixels exactly the same..
+            layer.deviceArea = deviceArea;
+            layer.transform = transform;
+            layer.validArea.clear();
+        }
+
+        RectangleList<int> areaToRender (area);
+        areaToRender.subtract (layer.validArea);
+
+        if (areaToRender.isEmpty())
+        {
+            addToPaintStatistics (&ComponentPeer::PaintStatistics::numLayersReused);
+        }
+        else
+        {
+            addToPaintStatistics (&ComponentPeer::PaintStatistics::numLayersUpdated);
+
+            Image target (new Layer::DeviceSpacePixelData (layer.image, deviceArea.getPosition()));
+            LowLevelGraphicsSoftwareRenderer lg (target, {}, deviceArea);
+            lg.addTransform (transform);
+            lg.clipToRectangleList (areaToRender);
+
+            Graphics imG (lg);
+            paint (c, imG);
+            layer.validArea.add (area);
+        }
+
+        layer.markAsUsed();
+        layer.draw (g);
+        return true;
+    }
 };
 
 //==============================================================================
@@ -854,6 +1112,41 @@ void Component::setBufferedToImage (bool shouldBeBuffered)
     }
 }
 
+//==============================================================================
+void Component::setLayerCachingEnabled (bool shouldCacheLayers)
+{
+    if (flags.layerCachingFlag != shouldCacheLayers)
+    {
+        flags.layerCachingFlag = shouldCacheLayers;
+
+        if (! shouldCacheLayers)
+            ComponentHelpers::releaseAllCachedImageResources (*this);
+    }
+}
+
+bool Component::isLayerCachingEnabled() const noexcept
+{
+    for (auto* c = this; c != nullptr; c = c->parentComponent)
+        if (c->flags.layerCachingFlag)
+            return true;
+
+    return false;
+}
+
+void Component::setMaximumLayerCacheSize (int64 numBytes)
+{
+    JUCE_ASSERT_MESSAGE_MANAGER_IS_LOCKED
+
+    Layer::maximumBytes = jmax ((int64) 0, numBytes);
+
+    Layer::releaseLeastRecentlyUsed (Layer::maximumBytes);
+}
+
+int64 Component::getLayerCacheSize() noexcept
+{
+    return Layer::totalBytes;
+}
+
 //==============================================================================
 void Component::reorderChildInternal (int sourceIndex, int destIndex)
 {
@@ -1823,6 +2116,16 @@ void Component::internalRepaintUnchecked (Rectangle<int> area, bool isEntireComp
     // thread, you'll need to use a MessageManagerLock object to make sure it's thread-safe.
     JUCE_ASSERT_MESSAGE_MANAGER_IS_LOCKED
 
+    if (flags.visibleFlag && Layer::numLayers > 0)
+        ComponentHelpers::invalidateLayers (*this, area);
+
+    internalRepaintFromChild (area, isEntireComponent);
+}
+
+void Component::internalRepaintFromChild (Rectangle<int> area, bool isEntireComponent)
+{
+    // (when a child repaints itself, this component's own layer is still valid, but any
+    // buffer that contains the child needs to be updated)
     if (flags.visibleFlag)
     {
         if (cachedImage != nullptr)
@@ -1845,7 +2148,13 @@ void Component::internalRepaintUnchecked (Rectangle<int> area, bool isEntireComp
         else
         {
             if (parentComponent != nullptr)
-                parentComponent->internalRepaint (ComponentHelpers::convertToParentSpace (*this, area));
+            {
+                auto areaInParent = ComponentHelpers::convertToParentSpace (*this, area)
+                                        .getIntersection (parentComponent->getLocalBounds());
+
+                if (! areaInParent.isEmpty())
+                    parentComponent->internalRepaintFromChild (areaInParent, false);
+            }
         }
     }
 }
@@ -1880,14 +2189,15 @@ void Component::paintComponentAndChildren (Graphics& g)
 
     if (flags.dontClipGraphicsFlag)
     {
-        paint (g);
+        ComponentHelpers::paint (*this, g);
     }
     else
     {
         g.saveState();
 
         if (! (ComponentHelpers::clipObscuredRegions (*this, g, clipBounds, {}) && g.isClipEmpty()))
-            paint (g);
+            if (! ComponentHelpers::paintFromLayer (*this, g, clipBounds))
+                ComponentHelpers::paint (*this, g);
 
         g.restoreState();
     }
@@ -2990,4 +3300,213 @@ bool Component::BailOutChecker::shouldBailOut() const noexcept
     return safePointer == nullptr;
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ComponentLayerTests  : public UnitTest
+{
+public:
+    ComponentLayerTests()  : UnitTest ("Component layers", "GUI") {}
+
+    void runTest() override
+    {
+        ScopedJuceInitialiser_GUI libraryInitialiser;
+
+        // Only components that are visible can have their layers invalidated, and making
+        // a component visible needs the Desktop, which can't be created without a display.
+        if (canShowComponents())
+        {
+            beginTest ("Layers give pixel-identical output");
+
+            const MessageManagerLock mmLock;
+
+            for (auto scale : { 1.0f, 2.0f })
+            {
+                TestScene cached (true), uncached (false);
+
+                for (int frame = 0; frame < 10; ++frame)
+                {
+                    for (auto* scene : { &cached, &uncached })
+                    {
+                        scene->overlay.position = (float) frame * 3.0f;
+                        scene->overlay.repaint();
+
+                        if (frame == 5)
+                        {
+                            scene->panel.colour = Colours::darkgreen;
+                            scene->panel.repaint();
+                        }
+
+                        if (frame == 7)
+                            scene->panel.setTopLeftPosition (23, 21);
+                    }
+
+                    expect (areIdentical (cached.createSnapshot (scale), uncached.createSnapshot (scale)),
+                            "frame " + String (frame) + " at scale " + String (scale));
+                }
+
+                expectEquals (uncached.background.numPaints, 10);
+                expectEquals (uncached.panel.numPaints, 10);
+                expect (cached.background.numPaints <= 3);
+                expect (cached.panel.numPaints <= 8);
+                expectEquals (cached.overlay.numPaints, 10);
+            }
+
+            expect (Component::getLayerCacheSize() == 0);
+        }
+
+        beginTest ("Least recently used layers are released first");
+        {
+            const MessageManagerLock mmLock;
+
+            // Each layer takes 10000 bytes, so there's room for four of them.
+            Component::setMaximumLayerCacheSize (40000);
+
+            OwnedArray<TestBox> boxes;
+
+            for (int i = 0; i < 5; ++i)
+            {
+                auto* box = boxes.add (new TestBox());
+                box->setSize (50, 50);
+                box->setLayerCachingEnabled (true);
+            }
+
+            auto& a = *boxes[0];
+            auto& b = *boxes[1];
+            auto& c = *boxes[2];
+            auto& d = *boxes[3];
+            auto& e = *boxes[4];
+
+            // A layer is created when a component is painted for the second time..
+            for (auto* box : { &a, &b, &c, &d })
+            {
+                expect (paintAndCount (*box) == 1);
+                expect (paintAndCount (*box) == 1);
+                expect (paintAndCount (*box) == 0);
+            }
+
+            expect (Component::getLayerCacheSize() == 40000);
+
+            expect (paintAndCount (a) == 0);
+            expect (paintAndCount (e) == 1);
+            expect (paintAndCount (e) == 1);
+            expect (Component::getLayerCacheSize() == 40000);
+
+            expect (paintAndCount (a) == 0);
+            expect (paintAndCount (c) == 0);
+            expect (paintAndCount (d) == 0);
+            expect (paintAndCount (e) == 0);
+            expect (paintAndCount (b) == 1);
+
+            // (b's layer was released to make room for e, so the order of use is now
+            // a, c, d, e, and a and c are the oldest)
+            Component::setMaximumLayerCacheSize (20000);
+            expect (Component::getLayerCacheSize() == 20000);
+
+            expect (paintAndCount (d) == 0);
+            expect (paintAndCount (e) == 0);
+            expect (paintAndCount (a) == 1);
+            expect (paintAndCount (c) == 1);
+
+            Component::setMaximumLayerCacheSize (64 * 1024 * 1024);
+        }
+    }
+
+private:
+    //==============================================================================
+    static bool canShowComponents()
+    {
+       #if JUCE_LINUX
+        return SystemStats::getEnvironmentVariable ("DISPLAY", {}).isNotEmpty();
+       #else
+        return true;
+       #endif
+    }
+
+    //==============================================================================
+    struct TestBox  : public Component
+    {
+        TestBox()    { setOpaque (true); }
+
+        void paint (Graphics& g) override
+        {
+            ++numPaints;
+            g.fillAll (colour);
+
+            g.setGradientFill (ColourGradient (Colours::white, 0.0f, 0.0f,
+                                               Colours::black, (float) getWidth(), (float) getHeight(), false));
+            g.fillEllipse (getLocalBounds().reduced (5).toFloat());
+
+            g.setColour (colour.contrasting());
+            g.drawLine (0.0f, 0.0f, (float) getWidth(), (float) getHeight() * 0.7f, 1.5f);
+        }
+
+        Colour colour { Colours::darkblue };
+        int numPaints = 0;
+    };
+
+    struct TestOverlay  : public Component
+    {
+        void paint (Graphics& g) override
+        {
+            ++numPaints;
+            g.setColour (Colours::orange.withAlpha (0.6f));
+            g.fillEllipse (position, position * 0.5f, 20.5f, 15.5f);
+        }
+
+        float position = 0;
+        int numPaints = 0;
+    };
+
+    // An opaque background and panel, with a non-opaque component being animated over them
+    struct TestScene
+    {
+        TestScene (bool useLayers)
+        {
+            background.setBounds (0, 0, 200, 150);
+            background.setVisible (true);
+            background.setLayerCachingEnabled (useLayers);
+
+            background.addAndMakeVisible (panel);
+            panel.setBounds (20, 20, 120, 90);
+            panel.colour = Colours::darkred;
+
+            background.addAndMakeVisible (overlay);
+            overlay.setBounds (40, 30, 120, 100);
+        }
+
+        Image createSnapshot (float scale)
+        {
+            return background.createComponentSnapshot (background.getLocalBounds(), true, scale);
+        }
+
+        TestBox background, panel;
+        TestOverlay overlay;
+    };
+
+    static int paintAndCount (TestBox& box)
+    {
+        auto numPaintsBefore = box.numPaints;
+        box.createComponentSnapshot (box.getLocalBounds());
+        return box.numPaints - numPaintsBefore;
+    }
+
+    static bool areIdentical (const Image& a, const Image& b)
+    {
+        if (a.getBounds() != b.getBounds())
+            return false;
+
+        for (int y = 0; y < a.getHeight(); ++y)
+            for (int x = 0; x < a.getWidth(); ++x)
+                if (a.getPixelAt (x, y) != b.getPixelAt (x, y))
+                    return false;
+
+        return true;
+    }
+};
+
+static ComponentLayerTests componentLayerTests;
+
+#endif
+
 } // namespace juce
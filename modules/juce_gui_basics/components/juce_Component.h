@@ -1007,6 +1007,49 @@ public:
     */
     void setBufferedToImage (bool shouldBeBuffered);
 
+    /** Enables automatic layer caching for this component and all of its children.
+
+        When this is enabled, an opaque component that gets painted again in an area
+        which hasn't been repainted since the last time (e.g. because a non-opaque
+        component on top of it is being animated) is given a layer. This is an image
+        holding the output of its paint() method, which is drawn instead of calling
+        paint() until repaint() is called on the component or one of its parents.
+
+        Unlike setBufferedToImage(), only the component's own paint() method is cached,
+        so a layer stays valid when its children or siblings are repainted.
+
+        This relies on a component's appearance only changing when repaint() is called
+        on it or one of its parents, so it shouldn't be enabled for components whose
+        paint() method depends on the state of their children.
+
+        When the component is drawn by the software renderer, its layer is painted in
+        the same pixel positions as the window, so the output is exactly the same as it
+        would have been without a layer. With other renderers, a layer is only used at
+        whole-number scale factors, and anti-aliased edges may differ very slightly.
+
+        @see setBufferedToImage, setMaximumLayerCacheSize, ComponentPeer::getLastPaintStatistics
+    */
+    void setLayerCachingEnabled (bool shouldCacheLayers);
+
+    /** Returns true if layer caching is enabled for this component or one of its parents.
+        @see setLayerCachingEnabled
+    */
+    bool isLayerCachingEnabled() const noexcept;
+
+    /** Sets the approximate number of bytes that all the components' layers may use.
+
+        The default is 64MB. When the limit is reached, the layers that were used least
+        recently are discarded.
+
+        @see setLayerCachingEnabled
+    */
+    static void setMaximumLayerCacheSize (int64 numBytes);
+
+    /** Returns the number of bytes that all the components' layers are currently using.
+        @see setMaximumLayerCacheSize
+    */
+    static int64 getLayerCacheSize() noexcept;
+
     /** Generates a snapshot of part of this component.
 
         This will return a new Image, the size of the rectangle specified,
@@ -2279,6 +2322,9 @@ private:
     ImageEffectFilter* effect = nullptr;
     std::unique_ptr<CachedComponentImage> cachedImage;
 
+    struct Layer;
+    std::unique_ptr<Layer> layer;
+
     class MouseListenerList;
     std::unique_ptr<MouseListenerList> mouseListeners;
     std::unique_ptr<Array<KeyListener*>> keyListeners;
@@ -2309,6 +2355,7 @@ private:
         bool isMoveCallbackPending      : 1;
         bool isResizeCallbackPending    : 1;
         bool viewportIgnoreDragFlag     : 1;
+        bool layerCachingFlag           : 1;
        #if JUCE_DEBUG
         bool isInsidePaintCall          : 1;
        #endif
@@ -2342,6 +2389,7 @@ private:
     void internalHierarchyChanged();
     void internalRepaint (Rectangle<int>);
     void internalRepaintUnchecked (Rectangle<int>, bool);
+    void internalRepaintFromChild (Rectangle<int>, bool);
     Component* removeChildComponent (int index, bool sendParentEvents, bool sendChildEvents);
     void reorderChildInternal (int sourceIndex, int destIndex);
     void paintComponentAndChildren (Graphics&);
@@ -41,6 +41,7 @@ Drawable::Drawable (const Drawable& other)
 
     setComponentID (other.getComponentID());
     setTransform (other.getTransform());
+    pathCachingEnabled = other.pathCachingEnabled;
 
     if (auto* clipPath = other.drawableClipPath.get())
         setClipPath (clipPath->createCopy());
@@ -119,6 +120,24 @@ void Drawable::setClipPath (Drawable* clipPath)
     }
 }
 
+void Drawable::setPathCachingEnabled (bool shouldCachePaths)
+{
+    if (pathCachingEnabled != shouldCachePaths)
+    {
+        pathCachingEnabled = shouldCachePaths;
+        repaint();
+    }
+}
+
+bool Drawable::shouldCachePaths() const
+{
+    for (auto* d = this; d != nullptr; d = d->getParent())
+        if (d->pathCachingEnabled)
+            return true;
+
+    return false;
+}
+
 void Drawable::transformContextToCorrectOrigin (Graphics& g)
 {
     g.setOrigin (originRelativeToComponent);
@@ -127,6 +127,22 @@ public:
     */
     void setClipPath (Drawable* drawableClipPath);
 
+    /** Turns on path caching for the shapes in this drawable and in any drawables inside it.
+
+        When this is enabled, the shapes are drawn with Graphics::setPathCachingEnabled()
+        turned on, so that their rasterised paths can be re-used each time they're repainted,
+        rather than being re-built from scratch. It's a good idea for things like icons and
+        SVG drawings that are repainted often but whose shapes don't change.
+
+        @see Graphics::setPathCachingEnabled, PathCache
+    */
+    void setPathCachingEnabled (bool shouldCachePaths);
+
+    /** Returns true if setPathCachingEnabled() has been used to turn on path caching
+        for this drawable (but not if it's only been turned on for one of its parents).
+    */
+    bool isPathCachingEnabled() const noexcept          { return pathCachingEnabled; }
+
     //==============================================================================
     /** Tries to turn some kind of image file into a drawable.
 
@@ -205,6 +221,9 @@ protected:
 
     Point<int> originRelativeToComponent;
     std::unique_ptr<Drawable> drawableClipPath;
+    bool pathCachingEnabled = false;
+
+    bool shouldCachePaths() const;
 
     void nonConstDraw (Graphics&, float opacity, const AffineTransform&);
 
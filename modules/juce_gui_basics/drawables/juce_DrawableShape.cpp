@@ -100,6 +100,9 @@ void DrawableShape::paint (Graphics& g)
     transformContextToCorrectOrigin (g);
     applyDrawableClipPath (g);
 
+    if (shouldCachePaths())
+        g.setPathCachingEnabled (true);
+
     g.setFillType (mainFill);
     g.fillPath (path);
 
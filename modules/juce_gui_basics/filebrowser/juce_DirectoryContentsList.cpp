@@ -27,6 +27,241 @@
 namespace juce
 {
 
+//==============================================================================
+class DirectoryScannerThreadPool  : public ThreadPool,
+                                    private DeletedAtShutdown
+{
+public:
+    // scanning spends most of its time waiting for the file system, so it's worth
+    // having more threads than there are CPUs
+    DirectoryScannerThreadPool()  : ThreadPool (jlimit (4, 16, SystemStats::getNumCpus() * 2)) {}
+    ~DirectoryScannerThreadPool() override   { clearSingletonInstance(); }
+
+    JUCE_DECLARE_SINGLETON (DirectoryScannerThreadPool, false)
+};
+
+JUCE_IMPLEMENT_SINGLETON (DirectoryScannerThreadPool)
+
+//==============================================================================
+struct DirectoryContentsList::RecursiveScan  : public std::enable_shared_from_this<RecursiveScan>
+{
+    RecursiveScan (const File& rootDirectory, bool shouldIgnoreHiddenFiles, const File& cache)
+        : root (rootDirectory), ignoreHiddenFiles (shouldIgnoreHiddenFiles), cacheFile (cache)
+    {
+    }
+
+    void start()
+    {
+        addJob ({});
+    }
+
+    bool isFinished() const noexcept
+    {
+        return numPendingJobs == 0;
+    }
+
+    void takeResults (OwnedArray<FileInfo>& dest)
+    {
+        const ScopedLock sl (lock);
+        dest.swapWith (results);
+    }
+
+    std::atomic<bool> cancelled { false };
+
+private:
+    struct CachedDirectory
+    {
+        int64 modificationTime;
+        Array<FileInfo> entries;
+    };
+
+    struct ScanJob  : public ThreadPoolJob
+    {
+        ScanJob (std::shared_ptr<RecursiveScan> s, const String& path)
+            : ThreadPoolJob ("Directory scanner"), scan (std::move (s)), relativePath (path)
+        {
+        }
+
+        JobStatus runJob() override
+        {
+            scan->scanDirectory (relativePath);
+            return jobHasFinished;
+        }
+
+        std::shared_ptr<RecursiveScan> scan;
+        const String relativePath;
+
+        JUCE_DECLARE_NON_COPYABLE (ScanJob)
+    };
+
+    void addJob (const String& relativePath)
+    {
+        ++numPendingJobs;
+        DirectoryScannerThreadPool::getInstance()->addJob (new ScanJob (shared_from_this(), relativePath), true);
+    }
+
+    void scanDirectory (const String& relativePath)
+    {
+        if (! cancelled)
+        {
+            if (relativePath.isEmpty() && cacheFile != File())
+                loadCache();
+
+            auto directory = relativePath.isEmpty() ? root : root.getChildFile (relativePath);
+            auto modificationTime = directory.getLastModificationTime().toMilliseconds();
+            auto cached = previousCache.find (relativePath);
+
+            auto entries = (cached != previousCache.end() && cached->second.modificationTime == modificationTime)
+                              ? cached->second.entries
+                              : readDirectory (directory);
+
+            OwnedArray<FileInfo> found;
+            found.ensureStorageAllocated (entries.size());
+
+            for (auto& entry : entries)
+            {
+                auto* info = found.add (new FileInfo (entry));
+
+                if (relativePath.isNotEmpty())
+                    info->filename = relativePath + File::getSeparatorString() + entry.filename;
+
+                if (entry.isDirectory && ! cancelled
+                     && ! directory.getChildFile (entry.filename).isSymbolicLink())
+                    addJob (info->filename);
+            }
+
+            const ScopedLock sl (lock);
+
+            if (cacheFile != File())
+                newCache[relativePath] = { modificationTime, std::move (entries) };
+
+            results.ensureStorageAllocated (results.size() + found.size());
+
+            for (auto* info : found)
+                results.add (info);
+
+            found.clear (false);
+        }
+
+        if (--numPendingJobs == 0 && ! cancelled && cacheFile != File())
+            saveCache();
+    }
+
+    Array<FileInfo> readDirectory (const File& directory) const
+    {
+        Array<FileInfo> entries;
+        DirectoryIterator iter (directory, false, "*",
+                                File::findFilesAndDirectories | (ignoreHiddenFiles ? File::ignoreHiddenFiles : 0));
+
+        FileInfo info;
+
+        while (! cancelled && iter.next (&info.isDirectory, nullptr, &info.fileSize,
+                                         &info.modificationTime, &info.creationTime, &info.isReadOnly))
+        {
+            info.filename = iter.getFile().getFileName();
+            entries.add (info);
+        }
+
+        return entries;
+    }
+
+    //==============================================================================
+    enum
+    {
+        cacheFileMagicNumber = 0x4c434444,
+        cacheFileVersion = 1
+    };
+
+    void loadCache()
+    {
+        FileInputStream in (cacheFile);
+
+        if (! (in.openedOk()
+                && in.readInt() == cacheFileMagicNumber
+                && in.readInt() == cacheFileVersion
+                && in.readBool() == ignoreHiddenFiles
+                && in.readString() == root.getFullPathName()))
+            return;
+
+        for (auto numDirectories = in.readInt(); --numDirectories >= 0 && ! in.isExhausted();)
+        {
+            auto& directory = previousCache[in.readString()];
+            directory.modificationTime = in.readInt64();
+
+            for (auto numEntries = in.readInt(); --numEntries >= 0;)
+            {
+                FileInfo info;
+                info.filename         = in.readString();
+                info.fileSize         = in.readInt64();
+                info.modificationTime = Time (in.readInt64());
+                info.creationTime     = Time (in.readInt64());
+
+                auto flags = in.readByte();
+                info.isDirectory      = (flags & 1) != 0;
+                info.isReadOnly       = (flags & 2) != 0;
+
+                directory.entries.add (info);
+            }
+        }
+    }
+
+    void saveCache()
+    {
+        const ScopedLock sl (lock);
+        TemporaryFile temp (cacheFile);
+
+        {
+            FileOutputStream out (temp.getFile());
+
+            if (! out.openedOk())
+                return;
+
+            out.writeInt (cacheFileMagicNumber);
+            out.writeInt (cacheFileVersion);
+            out.writeBool (ignoreHiddenFiles);
+            out.writeString (root.getFullPathName());
+            out.writeInt ((int) newCache.size());
+
+            for (auto& directory : newCache)
+            {
+                out.writeString (directory.first);
+                out.writeInt64 (directory.second.modificationTime);
+                out.writeInt (directory.second.entries.size());
+
+                for (auto& info : directory.second.entries)
+                {
+                    out.writeString (info.filename);
+                    out.writeInt64 (info.fileSize);
+                    out.writeInt64 (info.modificationTime.toMilliseconds());
+                    out.writeInt64 (info.creationTime.toMilliseconds());
+                    out.writeByte ((char) ((info.isDirectory ? 1 : 0) | (info.isReadOnly ? 2 : 0)));
+                }
+            }
+
+            out.flush();
+
+            if (out.getStatus().failed())
+                return;
+        }
+
+        temp.overwriteTargetFileWithTemporary();
+    }
+
+    //==============================================================================
+    const File root;
+    const bool ignoreHiddenFiles;
+    const File cacheFile;
+
+    std::map<String, CachedDirectory> previousCache, newCache;
+    std::atomic<int> numPendingJobs { 0 };
+
+    CriticalSection lock;
+    OwnedArray<FileInfo> results;
+
+    JUCE_DECLARE_NON_COPYABLE (RecursiveScan)
+};
+
+//==============================================================================
 DirectoryContentsList::DirectoryContentsList (const FileFilter* f, TimeSliceThread& t)
    : fileFilter (f), thread (t)
 {
@@ -76,6 +311,21 @@ void DirectoryContentsList::setDirectory (const File& directory,
     setTypeFlags (newFlags);
 }
 
+void DirectoryContentsList::setRecursive (const bool shouldScanSubdirectories)
+{
+    if (recursive != shouldScanSubdirectories)
+    {
+        stopSearching();
+        recursive = shouldScanSubdirectories;
+        refresh();
+    }
+}
+
+void DirectoryContentsList::setScanCacheFile (const File& cacheFile)
+{
+    scanCacheFile = cacheFile;
+}
+
 void DirectoryContentsList::setTypeFlags (const int newFlags)
 {
     if (fileTypeFlags != newFlags)
@@ -90,6 +340,15 @@ void DirectoryContentsList::stopSearching()
     shouldStop = true;
     thread.removeTimeSliceClient (this);
     fileFindHandle.reset();
+    pendingFiles.clear();
+
+    if (recursiveScan != nullptr)
+    {
+        // any jobs that are still running will notice this and give up, but there's
+        // no need to wait for them
+        recursiveScan->cancelled = true;
+        recursiveScan.reset();
+    }
 }
 
 void DirectoryContentsList::clear()
@@ -111,7 +370,16 @@ void DirectoryContentsList::refresh()
 
     if (root.isDirectory())
     {
-        fileFindHandle.reset (new DirectoryIterator (root, false, "*", fileTypeFlags));
+        if (recursive)
+        {
+            recursiveScan = std::make_shared<RecursiveScan> (root, ignoresHiddenFiles(), scanCacheFile);
+            recursiveScan->start();
+        }
+        else
+        {
+            fileFindHandle.reset (new DirectoryIterator (root, false, "*", fileTypeFlags));
+        }
+
         shouldStop = false;
         thread.addTimeSliceClient (this);
     }
@@ -166,7 +434,7 @@ bool DirectoryContentsList::contains (const File& targetFile) const
 
 bool DirectoryContentsList::isStillLoading() const
 {
-    return fileFindHandle != nullptr;
+    return fileFindHandle != nullptr || recursiveScan != nullptr;
 }
 
 void DirectoryContentsList::changed()
@@ -180,6 +448,16 @@ int DirectoryContentsList::useTimeSlice()
     auto startTime = Time::getApproximateMillisecondCounter();
     bool hasChanged = false;
 
+    if (recursive)
+    {
+        auto isScanning = checkRecursiveScan (hasChanged);
+
+        if (hasChanged)
+            changed();
+
+        return isScanning ? 50 : 500;
+    }
+
     for (int i = 100; --i >= 0;)
     {
         if (! checkNextFile (hasChanged))
@@ -194,12 +472,55 @@ int DirectoryContentsList::useTimeSlice()
             break;
     }
 
+    if (mergePendingFiles())
+        hasChanged = true;
+
     if (hasChanged)
         changed();
 
     return 0;
 }
 
+bool DirectoryContentsList::checkRecursiveScan (bool& hasChanged)
+{
+    if (recursiveScan == nullptr)
+        return false;
+
+    // (this must be checked before taking the results, so that none get left behind)
+    auto isFinished = recursiveScan->isFinished();
+
+    OwnedArray<FileInfo> found;
+    recursiveScan->takeResults (found);
+
+    auto typesWanted = fileTypeFlags & File::findFilesAndDirectories;
+
+    for (int i = found.size(); --i >= 0;)
+    {
+        auto* info = found.getUnchecked (i);
+
+        if ((typesWanted & (info->isDirectory ? File::findDirectories : File::findFiles)) == 0
+             || ! isSuitable (root.getChildFile (info->filename), info->isDirectory))
+            found.remove (i);
+    }
+
+    pendingFiles.swapWith (found);
+
+    if (mergePendingFiles())
+        hasChanged = true;
+
+    if (isFinished)
+    {
+        recursiveScan.reset();
+
+        if (! wasEmpty && files.isEmpty())
+            hasChanged = true;
+
+        return false;
+    }
+
+    return true;
+}
+
 bool DirectoryContentsList::checkNextFile (bool& hasChanged)
 {
     if (fileFindHandle != nullptr)
@@ -222,6 +543,9 @@ bool DirectoryContentsList::checkNextFile (bool& hasChanged)
 
         fileFindHandle.reset();
 
+        if (mergePendingFiles())
+            hasChanged = true;
+
         if (! wasEmpty && files.isEmpty())
             hasChanged = true;
     }
@@ -229,18 +553,23 @@ bool DirectoryContentsList::checkNextFile (bool& hasChanged)
     return false;
 }
 
+bool DirectoryContentsList::isSuitable (const File& file, const bool isDir) const
+{
+    const ScopedLock sl (fileListLock);
+
+    return fileFilter == nullptr
+            || ((! isDir) && fileFilter->isFileSuitable (file))
+            || (isDir && fileFilter->isDirectorySuitable (file));
+}
+
 bool DirectoryContentsList::addFile (const File& file, const bool isDir,
                                      const int64 fileSize,
                                      Time modTime, Time creationTime,
                                      const bool isReadOnly)
 {
-    const ScopedLock sl (fileListLock);
-
-    if (fileFilter == nullptr
-         || ((! isDir) && fileFilter->isFileSuitable (file))
-         || (isDir && fileFilter->isDirectorySuitable (file)))
+    if (isSuitable (file, isDir))
     {
-        auto info = std::make_unique<FileInfo>();
+        auto* info = pendingFiles.add (new FileInfo());
 
         info->filename         = file.getFileName();
         info->fileSize         = fileSize;
@@ -249,26 +578,188 @@ bool DirectoryContentsList::addFile (const File& file, const bool isDir,
         info->isDirectory      = isDir;
         info->isReadOnly       = isReadOnly;
 
-        for (int i = files.size(); --i >= 0;)
-            if (files.getUnchecked(i)->filename == info->filename)
-                return false;
+        return true;
+    }
+
+    return false;
+}
+
+static bool isFileInfoBefore (const DirectoryContentsList::FileInfo* a,
+                              const DirectoryContentsList::FileInfo* b)
+{
+   #if JUCE_WINDOWS
+    if (a->isDirectory != b->isDirectory)
+        return a->isDirectory;
+   #endif
+
+    return a->filename.compareNatural (b->filename) < 0;
+}
+
+bool DirectoryContentsList::mergePendingFiles()
+{
+    if (pendingFiles.isEmpty())
+        return false;
+
+    // Rather than re-sorting the whole list for each new file, the new ones are
+    // sorted on their own and then merged in, which keeps big directories quick.
+    std::sort (pendingFiles.begin(), pendingFiles.end(), isFileInfoBefore);
+
+    const ScopedLock sl (fileListLock);
+
+    auto numExisting = files.size();
+    files.ensureStorageAllocated (numExisting + pendingFiles.size());
+
+    for (auto* info : pendingFiles)
+        files.add (info);
+
+    pendingFiles.clear (false);
+
+    std::inplace_merge (files.begin(), files.begin() + numExisting, files.end(), isFileInfoBefore);
 
-        files.add (info.release());
+    for (int i = files.size(); --i > 0;)
+        if (files.getUnchecked (i)->filename == files.getUnchecked (i - 1)->filename)
+            files.remove (i);
 
-        std::sort (files.begin(), files.end(), [] (const FileInfo* a, const FileInfo* b)
+    return true;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class DirectoryContentsListTests  : public UnitTest
+{
+public:
+    DirectoryContentsListTests()  : UnitTest ("DirectoryContentsList", "GUI") {}
+
+    void runTest() override
+    {
+        TimeSliceThread thread ("DirectoryContentsList test");
+        thread.startThread();
+
+        TemporaryFile tempRoot, tempCache;
+        auto root = tempRoot.getFile();
+        auto cacheFile = tempCache.getFile();
+
+        beginTest ("Recursive scan");
         {
-           #if JUCE_WINDOWS
-            if (a->isDirectory != b->isDirectory)
-                return a->isDirectory;
-           #endif
+            for (auto path : { "a.txt", "sub/b.txt", "sub/deeper/c.txt", "sub2/d.wav" })
+                expect (root.getChildFile (path).create().wasOk());
 
-            return a->filename.compareNatural (b->filename) < 0;
-        });
+            DirectoryContentsList list (nullptr, thread);
+            list.setRecursive (true);
+            list.setDirectory (root, true, true);
 
-        return true;
+            expect (waitForFiles (list, { "a.txt", "sub", "sub/b.txt", "sub/deeper", "sub/deeper/c.txt", "sub2", "sub2/d.wav" }));
+
+            for (int i = 0; i < list.getNumFiles(); ++i)
+                expect (list.getFile (i).exists());
+
+            expect (findInfo (list, "sub/deeper").isDirectory);
+            expect (! findInfo (list, "sub/deeper/c.txt").isDirectory);
+            expect (list.contains (root.getChildFile ("sub/deeper/c.txt")));
+
+            list.setDirectory (root, false, true);
+            expect (waitForFiles (list, { "a.txt", "sub/b.txt", "sub/deeper/c.txt", "sub2/d.wav" }));
+
+            WildcardFileFilter filter ("*.txt", "*", "text files");
+            list.setFileFilter (&filter);
+            list.refresh();
+            expect (waitForFiles (list, { "a.txt", "sub/b.txt", "sub/deeper/c.txt" }));
+            list.setFileFilter (nullptr);
+
+            list.setRecursive (false);
+            list.setDirectory (root, true, true);
+            expect (waitForFiles (list, { "a.txt", "sub", "sub2" }));
+        }
+
+        beginTest ("Scan cache");
+        {
+            {
+                DirectoryContentsList list (nullptr, thread);
+                list.setScanCacheFile (cacheFile);
+                list.setRecursive (true);
+                list.setDirectory (root, false, true);
+
+                expect (waitForFiles (list, { "a.txt", "sub/b.txt", "sub/deeper/c.txt", "sub2/d.wav" }));
+            }
+
+            for (int i = 0; i < 500 && ! cacheFile.existsAsFile(); ++i)
+                Thread::sleep (10);
+
+            expect (cacheFile.existsAsFile());
+
+            // A file whose contents change doesn't change its directory's time, so its
+            // cached details are re-used, but new files are found.
+            expect (root.getChildFile ("sub/b.txt").appendText ("changed"));
+            expect (root.getChildFile ("sub/deeper/new.txt").create().wasOk());
+            expect (root.getChildFile ("sub/deeper").setLastModificationTime (Time::getCurrentTime() + RelativeTime::hours (1)));
+
+            DirectoryContentsList list (nullptr, thread);
+            list.setScanCacheFile (cacheFile);
+            list.setRecursive (true);
+            list.setDirectory (root, false, true);
+
+            expect (waitForFiles (list, { "a.txt", "sub/b.txt", "sub/deeper/c.txt", "sub/deeper/new.txt", "sub2/d.wav" }));
+
+            auto cachedInfo = findInfo (list, "sub/b.txt");
+            expect (cachedInfo.filename.isNotEmpty() && cachedInfo.fileSize == 0);
+        }
+
+        thread.stopThread (5000);
+        root.deleteRecursively();
     }
 
-    return false;
-}
+private:
+    static String toNativePath (const char* path)
+    {
+        return String (path).replaceCharacter ('/', File::getSeparatorChar());
+    }
+
+    static DirectoryContentsList::FileInfo findInfo (const DirectoryContentsList& list, const char* path)
+    {
+        DirectoryContentsList::FileInfo info;
+
+        for (int i = 0; list.getFileInfo (i, info); ++i)
+            if (info.filename == toNativePath (path))
+                return info;
+
+        return {};
+    }
+
+    bool waitForFiles (const DirectoryContentsList& list, std::initializer_list<const char*> expected)
+    {
+        StringArray expectedNames;
+
+        for (auto path : expected)
+            expectedNames.add (toNativePath (path));
+
+        expectedNames.sort (false);
+
+        StringArray names;
+
+        for (int i = 0; i < 500; ++i)
+        {
+            names.clear();
+            DirectoryContentsList::FileInfo info;
+
+            for (int j = 0; list.getFileInfo (j, info); ++j)
+                names.add (info.filename);
+
+            names.sort (false);
+
+            if (names == expectedNames)
+                return true;
+
+            Thread::sleep (10);
+        }
+
+        logMessage ("Found: " + names.joinIntoString (", "));
+        return false;
+    }
+};
+
+static DirectoryContentsListTests directoryContentsListTests;
+
+#endif
 
 } // namespace juce
@@ -120,6 +120,44 @@ public:
     */
     void setFileFilter (const FileFilter* newFileFilter);
 
+    //==============================================================================
+    /** Makes the list include the contents of all the subdirectories of its directory.
+
+        In this mode, the filename of each FileInfo is its path relative to the list's
+        directory, and the subdirectories are scanned concurrently on a shared pool of
+        background threads, which is much quicker for large trees, particularly on network
+        drives. Hidden subdirectories and symbolic links to directories aren't searched.
+
+        By default this is false, and only the directory itself is scanned. Changing it
+        will refresh the list.
+
+        @see isRecursive, setScanCacheFile
+    */
+    void setRecursive (bool shouldScanSubdirectories);
+
+    /** Returns true if the list includes the contents of subdirectories.
+        @see setRecursive
+    */
+    bool isRecursive() const noexcept                       { return recursive; }
+
+    /** Gives the list a file in which it can keep the results of its recursive scans.
+
+        When a recursive scan finishes, the details of all the files that were found are
+        written to this file. The next time the same directory is scanned, any subdirectory
+        whose modification time hasn't changed since then is read from this cache rather
+        than from the disk.
+
+        Bear in mind that a directory's modification time only changes when files are
+        added, removed or renamed, so the sizes and times of files in directories that
+        came from the cache may be out of date.
+
+        Pass File() to stop using a cache file. This has no effect unless the list is
+        recursive.
+
+        @see setRecursive
+    */
+    void setScanCacheFile (const File& cacheFile);
+
     //==============================================================================
     /** Contains cached information about one of the files in a DirectoryContentsList.
     */
@@ -132,6 +170,9 @@ public:
             get from File::getFileName().
 
             To get the full pathname, use DirectoryContentsList::getDirectory().getChildFile (filename).
+
+            If the list is recursive, this is the path of the file relative to the list's
+            directory.
         */
         String filename;
 
@@ -206,19 +247,26 @@ private:
     int fileTypeFlags = File::ignoreHiddenFiles | File::findFiles;
 
     CriticalSection fileListLock;
-    OwnedArray<FileInfo> files;
+    OwnedArray<FileInfo> files, pendingFiles;
 
     std::unique_ptr<DirectoryIterator> fileFindHandle;
     std::atomic<bool> shouldStop { true };
 
-    bool wasEmpty = true;
+    bool wasEmpty = true, recursive = false;
+    File scanCacheFile;
+
+    struct RecursiveScan;
+    std::shared_ptr<RecursiveScan> recursiveScan;
 
     int useTimeSlice() override;
     void stopSearching();
     void changed();
     bool checkNextFile (bool& hasChanged);
+    bool checkRecursiveScan (bool& hasChanged);
+    bool isSuitable (const File&, bool isDir) const;
     bool addFile (const File&, bool isDir, int64 fileSize, Time modTime,
                   Time creationTime, bool isReadOnly);
+    bool mergePendingFiles();
     void setTypeFlags (int);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DirectoryContentsList)
@@ -248,6 +248,7 @@ namespace juce
 #include "widgets/juce_Toolbar.cpp"
 #include "widgets/juce_ToolbarItemPalette.cpp"
 #include "widgets/juce_TreeView.cpp"
+#include "widgets/juce_VirtualTreeView.cpp"
 #include "windows/juce_AlertWindow.cpp"
 #include "windows/juce_CallOutBox.cpp"
 #include "windows/juce_ComponentPeer.cpp"
@@ -255,6 +255,7 @@ namespace juce
 #include "misc/juce_DropShadower.h"
 #include "misc/juce_JUCESplashScreen.h"
 #include "widgets/juce_TreeView.h"
+#include "widgets/juce_VirtualTreeView.h"
 #include "windows/juce_TopLevelWindow.h"
 #include "windows/juce_AlertWindow.h"
 #include "windows/juce_CallOutBox.h"
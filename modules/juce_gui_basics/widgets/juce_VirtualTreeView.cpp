@@ -0,0 +1,957 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+/*  Each open node keeps a binary indexed (Fenwick) tree of the number of rows that its
+    children take up - one for a closed child, or one plus the child's own total for an
+    open one. This lets us find the child that contains a row, and the number of rows
+    before a child, in O(log n) time.
+
+    When a node is closed, its OpenNode is moved into its parent's list of closed children,
+    so that the nodes inside it will still be open if it gets re-opened.
+*/
+struct VirtualTreeView::OpenNode
+{
+    OpenNode (int64 nodeId, OpenNode* parentNode, int index, int numChildNodes)
+        : id (nodeId), parent (parentNode), indexInParent (index),
+          depth (parentNode != nullptr ? parentNode->depth + 1 : -1)
+    {
+        setAllChildrenClosed (numChildNodes);
+    }
+
+    void setAllChildrenClosed (int numChildNodes)
+    {
+        openChildren.clear();
+        closedChildren.clear();
+        numChildren = jmax (0, numChildNodes);
+        numRows = numChildren;
+        rowCounts.resize (numChildren);
+
+        // for a tree of ones, each entry just holds the size of the range that it covers
+        for (int i = 1; i <= numChildren; ++i)
+            rowCounts.set (i - 1, i & -i);
+    }
+
+    void setChildRowCounts (const Array<int>& counts)
+    {
+        numChildren = counts.size();
+        rowCounts = counts;
+        numRows = 0;
+
+        for (int i = 1; i <= numChildren; ++i)
+        {
+            numRows += counts.getUnchecked (i - 1);
+            auto next = i + (i & -i);
+
+            if (next <= numChildren)
+                rowCounts.getReference (next - 1) += rowCounts.getUnchecked (i - 1);
+        }
+    }
+
+    void addRows (int childIndex, int numRowsToAdd) noexcept
+    {
+        for (int i = childIndex + 1; i <= numChildren; i += (i & -i))
+            rowCounts.getReference (i - 1) += numRowsToAdd;
+
+        numRows += numRowsToAdd;
+    }
+
+    int getNumRowsBefore (int childIndex) const noexcept
+    {
+        int total = 0;
+
+        for (int i = childIndex; i > 0; i -= (i & -i))
+            total += rowCounts.getUnchecked (i - 1);
+
+        return total;
+    }
+
+    int findChildContainingRow (int row, int& rowWithinChild) const noexcept
+    {
+        int index = 0;
+
+        for (int step = (int) nextPowerOfTwo (numChildren + 1) >> 1; step > 0; step >>= 1)
+        {
+            if (index + step <= numChildren && rowCounts.getUnchecked (index + step - 1) <= row)
+            {
+                index += step;
+                row -= rowCounts.getUnchecked (index - 1);
+            }
+        }
+
+        rowWithinChild = row;
+        return index;
+    }
+
+    // Re-reads the number of children, and finds where the open ones have moved to
+    void refresh (TreeViewModel& model)
+    {
+        Array<int> counts;
+        counts.insertMultiple (0, 1, jmax (0, model.getNumChildren (id)));
+
+        refreshChildren (model, openChildren, counts.size());
+        refreshChildren (model, closedChildren, counts.size());
+
+        for (auto& child : openChildren)
+            counts.getReference (child.first) += child.second->numRows;
+
+        setChildRowCounts (counts);
+    }
+
+    using ChildMap = std::unordered_map<int, std::unique_ptr<OpenNode>>;
+
+    void refreshChildren (TreeViewModel& model, ChildMap& children, int newNumChildren)
+    {
+        auto oldChildren = std::move (children);
+        children.clear();
+
+        for (auto& child : oldChildren)
+        {
+            auto newIndex = model.getIndexOfChild (id, child.second->id);
+
+            if (isPositiveAndBelow (newIndex, newNumChildren)
+                 && findOpenChild (newIndex) == nullptr
+                 && children.find (newIndex) == children.end())
+            {
+                child.second->indexInParent = newIndex;
+                child.second->refresh (model);
+                children[newIndex] = std::move (child.second);
+            }
+        }
+    }
+
+    // Adds the IDs of all the nodes inside this one that have been opened, including
+    // the ones that will re-appear when a closed parent is re-opened
+    void getOpenNodeIds (Array<int64>& ids) const
+    {
+        for (auto& child : openChildren)
+        {
+            ids.add (child.second->id);
+            child.second->getOpenNodeIds (ids);
+        }
+
+        for (auto& child : closedChildren)
+            child.second->getOpenNodeIds (ids);
+    }
+
+    OpenNode* findOpenChild (int childIndex) const
+    {
+        auto found = openChildren.find (childIndex);
+        return found != openChildren.end() ? found->second.get() : nullptr;
+    }
+
+    int64 id;
+    OpenNode* parent;
+    int indexInParent, depth, numChildren = 0, numRows = 0;
+    Array<int> rowCounts;
+    ChildMap openChildren, closedChildren;
+
+    JUCE_DECLARE_NON_COPYABLE (OpenNode)
+};
+
+struct VirtualTreeView::RowPosition
+{
+    OpenNode* parent;
+    int index;
+
+    bool isValid() const noexcept       { return parent != nullptr; }
+    int getDepth() const noexcept       { return parent->depth + 1; }
+    bool isOpen() const                 { return parent->findOpenChild (index) != nullptr; }
+};
+
+//==============================================================================
+class VirtualTreeView::RowComp  : public Component
+{
+public:
+    RowComp (VirtualTreeView& tv)  : owner (tv)
+    {
+        setInterceptsMouseClicks (false, true);
+    }
+
+    void paint (Graphics& g) override
+    {
+        if (auto* m = owner.getModel())
+        {
+            if (isValidRow)
+            {
+                auto indent = owner.getIndentSize();
+
+                if (hasOpenCloseButton)
+                {
+                    auto backgroundColour = owner.findColour (ListBox::backgroundColourId);
+
+                    getLookAndFeel().drawTreeviewPlusMinusBox (g, Rectangle<float> ((float) (depth * indent), 0,
+                                                                                    (float) indent, (float) getHeight()),
+                                                               backgroundColour.isTransparent() ? Colours::white : backgroundColour,
+                                                               isOpen, false);
+                }
+
+                auto x = (depth + 1) * indent;
+                g.reduceClipRegion (x, 0, getWidth() - x, getHeight());
+                g.setOrigin (x, 0);
+                m->paintNode (nodeId, g, getWidth() - x, getHeight(), isSelected);
+            }
+        }
+    }
+
+    void update (int newRow, bool nowSelected)
+    {
+        auto* m = owner.getModel();
+        auto pos = owner.findRow (newRow);
+
+        isValidRow = m != nullptr && pos.isValid();
+        isSelected = nowSelected;
+        repaint();
+
+        if (isValidRow)
+        {
+            nodeId = m->getChildNodeId (pos.parent->id, pos.index);
+            depth = pos.getDepth();
+            isOpen = pos.isOpen();
+            hasOpenCloseButton = m->mightHaveChildren (nodeId);
+
+            customComponent.reset (m->refreshComponentForNode (nodeId, nowSelected, customComponent.release()));
+
+            if (customComponent != nullptr)
+            {
+                addAndMakeVisible (customComponent.get());
+                resized();
+            }
+        }
+        else
+        {
+            customComponent.reset();
+        }
+    }
+
+    void resized() override
+    {
+        if (customComponent != nullptr)
+            customComponent->setBounds (getLocalBounds().withTrimmedLeft ((depth + 1) * owner.getIndentSize()));
+    }
+
+private:
+    VirtualTreeView& owner;
+    std::unique_ptr<Component> customComponent;
+    int64 nodeId = 0;
+    int depth = 0;
+    bool isValidRow = false, isSelected = false, isOpen = false, hasOpenCloseButton = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RowComp)
+};
+
+//==============================================================================
+VirtualTreeView::VirtualTreeView (const String& name, TreeViewModel* const m)
+    : ListBox (name, nullptr), model (m)
+{
+    ListBox::setModel (this);
+    resetRoot();
+}
+
+VirtualTreeView::~VirtualTreeView()
+{
+}
+
+void VirtualTreeView::setModel (TreeViewModel* newModel)
+{
+    if (model != newModel)
+    {
+        model = newModel;
+        resetRoot();
+    }
+}
+
+void VirtualTreeView::resetRoot()
+{
+    if (model != nullptr)
+    {
+        auto rootId = model->getRootNodeId();
+        root.reset (new OpenNode (rootId, nullptr, 0, model->getNumChildren (rootId)));
+    }
+    else
+    {
+        root.reset();
+    }
+
+    deselectAllRows();
+    updateContent();
+}
+
+void VirtualTreeView::refreshTree()
+{
+    if (model == nullptr || root == nullptr)
+        return;
+
+    // remember the selected node by the IDs of the nodes that lead to it..
+    Array<int64> selectedPath;
+    auto pos = findRow (getLastRowSelected());
+
+    if (pos.isValid())
+    {
+        selectedPath.add (model->getChildNodeId (pos.parent->id, pos.index));
+
+        for (auto* p = pos.parent; p->parent != nullptr; p = p->parent)
+            selectedPath.insert (0, p->id);
+    }
+
+    auto rootId = model->getRootNodeId();
+
+    if (root->id != rootId)
+        root.reset (new OpenNode (rootId, nullptr, 0, 0));
+
+    root->refresh (*model);
+
+    deselectAllRows();
+    updateContent();
+
+    if (! selectedPath.isEmpty())
+    {
+        auto* node = root.get();
+
+        for (int i = 0; i < selectedPath.size() - 1 && node != nullptr; ++i)
+        {
+            auto* parent = node;
+            node = nullptr;
+
+            for (auto& child : parent->openChildren)
+            {
+                if (child.second->id == selectedPath.getUnchecked (i))
+                {
+                    node = child.second.get();
+                    break;
+                }
+            }
+        }
+
+        if (node != nullptr)
+        {
+            auto index = model->getIndexOfChild (node->id, selectedPath.getLast());
+
+            if (isPositiveAndBelow (index, node->numChildren))
+                selectRow (getRowOf (*node, index), true);
+        }
+    }
+}
+
+//==============================================================================
+VirtualTreeView::RowPosition VirtualTreeView::findRow (int row) const
+{
+    if (root == nullptr || ! isPositiveAndBelow (row, root->numRows))
+        return { nullptr, -1 };
+
+    auto* node = root.get();
+
+    for (;;)
+    {
+        int rowWithinChild;
+        auto index = node->findChildContainingRow (row, rowWithinChild);
+
+        if (rowWithinChild == 0)
+            return { node, index };
+
+        node = node->findOpenChild (index);
+        jassert (node != nullptr);
+        row = rowWithinChild - 1;
+    }
+}
+
+int VirtualTreeView::getRowOf (const OpenNode& node, int childIndex) const
+{
+    auto row = node.getNumRowsBefore (childIndex);
+
+    for (auto* n = &node; n->parent != nullptr; n = n->parent)
+        row += n->parent->getNumRowsBefore (n->indexInParent) + 1;
+
+    return row;
+}
+
+int64 VirtualTreeView::getNodeIdForRow (int row) const
+{
+    auto pos = findRow (row);
+
+    if (pos.isValid())
+        return model->getChildNodeId (pos.parent->id, pos.index);
+
+    return root != nullptr ? root->id : 0;
+}
+
+int VirtualTreeView::getDepthOfRow (int row) const
+{
+    auto pos = findRow (row);
+    return pos.isValid() ? pos.getDepth() : -1;
+}
+
+int VirtualTreeView::getParentRow (int row) const
+{
+    auto pos = findRow (row);
+
+    if (pos.isValid() && pos.parent->parent != nullptr)
+        return getRowOf (*pos.parent->parent, pos.parent->indexInParent);
+
+    return -1;
+}
+
+Array<int> VirtualTreeView::getIndexPathForRow (int row) const
+{
+    Array<int> path;
+    auto pos = findRow (row);
+
+    if (pos.isValid())
+    {
+        path.add (pos.index);
+
+        for (auto* p = pos.parent; p->parent != nullptr; p = p->parent)
+            path.insert (0, p->indexInParent);
+    }
+
+    return path;
+}
+
+int VirtualTreeView::getRowForIndexPath (const Array<int>& childIndexes, bool openParentsIfNeeded)
+{
+    auto* node = root.get();
+
+    for (int i = 0; i < childIndexes.size() && node != nullptr; ++i)
+    {
+        auto index = childIndexes.getUnchecked (i);
+
+        if (! isPositiveAndBelow (index, node->numChildren))
+            break;
+
+        if (i == childIndexes.size() - 1)
+            return getRowOf (*node, index);
+
+        auto* child = node->findOpenChild (index);
+
+        if (child == nullptr && openParentsIfNeeded)
+        {
+            setNodeOpen ({ node, index }, getRowOf (*node, index), true);
+            child = node->findOpenChild (index);
+        }
+
+        node = child;
+    }
+
+    return -1;
+}
+
+//==============================================================================
+void VirtualTreeView::setRowOpen (int row, bool shouldBeOpen)
+{
+    auto pos = findRow (row);
+
+    if (pos.isValid())
+        setNodeOpen (pos, row, shouldBeOpen);
+}
+
+bool VirtualTreeView::isRowOpen (int row) const
+{
+    auto pos = findRow (row);
+    return pos.isValid() && pos.isOpen();
+}
+
+void VirtualTreeView::closeAllNodes()
+{
+    if (root != nullptr)
+    {
+        Array<int64> closedNodeIds;
+        root->getOpenNodeIds (closedNodeIds);
+
+        root->setAllChildrenClosed (root->numChildren);
+        deselectAllRows();
+        updateContent();
+
+        if (model != nullptr)
+            for (auto nodeId : closedNodeIds)
+                model->nodeOpennessChanged (nodeId, false);
+    }
+}
+
+void VirtualTreeView::setNodeOpen (const RowPosition& pos, int row, bool shouldBeOpen)
+{
+    if (model == nullptr || pos.isOpen() == shouldBeOpen)
+        return;
+
+    auto nodeId = model->getChildNodeId (pos.parent->id, pos.index);
+    int numRowsAdded;
+
+    auto& openChildren = pos.parent->openChildren;
+    auto& closedChildren = pos.parent->closedChildren;
+
+    if (shouldBeOpen)
+    {
+        auto& child = openChildren[pos.index];
+        auto closed = closedChildren.find (pos.index);
+
+        if (closed != closedChildren.end())
+        {
+            child = std::move (closed->second);
+            closedChildren.erase (closed);
+        }
+        else
+        {
+            child.reset (new OpenNode (nodeId, pos.parent, pos.index, model->getNumChildren (nodeId)));
+        }
+
+        numRowsAdded = child->numRows;
+    }
+    else
+    {
+        auto open = openChildren.find (pos.index);
+        numRowsAdded = -open->second->numRows;
+        closedChildren[pos.index] = std::move (open->second);
+        openChildren.erase (open);
+    }
+
+    for (auto* node = pos.parent, *child = (OpenNode*) nullptr; node != nullptr; child = node, node = node->parent)
+        node->addRows (child != nullptr ? child->indexInParent : pos.index, numRowsAdded);
+
+    rowsInsertedOrRemoved (row + 1, numRowsAdded);
+    model->nodeOpennessChanged (nodeId, shouldBeOpen);
+}
+
+void VirtualTreeView::rowsInsertedOrRemoved (int firstRow, int numRows)
+{
+    auto oldSelection = getSelectedRows();
+    auto lastSelected = getLastRowSelected();
+
+    updateContent();
+
+    if (oldSelection.isEmpty() || numRows == 0)
+        return;
+
+    // The rows below the node that was opened or closed have all moved, so the selection
+    // has to be moved with them. If the rows that were removed contained the last one
+    // that was selected, the node that was closed gets selected instead.
+    if (numRows < 0)
+    {
+        oldSelection.removeRange ({ firstRow, firstRow - numRows });
+
+        if (lastSelected >= firstRow && lastSelected < firstRow - numRows)
+            lastSelected = firstRow - 1;
+    }
+
+    SparseSet<int> newSelection;
+
+    for (int i = 0; i < oldSelection.getNumRanges(); ++i)
+    {
+        auto range = oldSelection.getRange (i);
+
+        if (range.getEnd() <= firstRow)
+        {
+            newSelection.addRange (range);
+        }
+        else if (range.getStart() >= firstRow)
+        {
+            newSelection.addRange (range + numRows);
+        }
+        else
+        {
+            newSelection.addRange (range.withEnd (firstRow));
+            newSelection.addRange (range.withStart (firstRow) + numRows);
+        }
+    }
+
+    if (lastSelected >= firstRow)
+        lastSelected += numRows;
+
+    if (lastSelected >= 0)
+    {
+        // (this is deselected first so that selectRow() will update the ListBox's last-selected row)
+        newSelection.removeRange ({ lastSelected, lastSelected + 1 });
+        setSelectedRows (newSelection, dontSendNotification);
+        selectRow (lastSelected, true, false);
+    }
+    else
+    {
+        setSelectedRows (newSelection, sendNotification);
+    }
+}
+
+void VirtualTreeView::setIndentSize (int newIndentSize)
+{
+    if (indentSize != newIndentSize)
+    {
+        indentSize = newIndentSize;
+        updateContent();
+        repaint();
+    }
+}
+
+//==============================================================================
+int VirtualTreeView::getNumRows()
+{
+    return root != nullptr ? root->numRows : 0;
+}
+
+void VirtualTreeView::paintListBoxItem (int, Graphics&, int, int, bool)
+{
+}
+
+Component* VirtualTreeView::refreshComponentForRow (int rowNumber, bool rowSelected, Component* existingComponentToUpdate)
+{
+    if (existingComponentToUpdate == nullptr)
+        existingComponentToUpdate = new RowComp (*this);
+
+    static_cast<RowComp*> (existingComponentToUpdate)->update (rowNumber, rowSelected);
+
+    return existingComponentToUpdate;
+}
+
+void VirtualTreeView::listBoxItemClicked (int row, const MouseEvent& e)
+{
+    auto pos = findRow (row);
+
+    if (model != nullptr && pos.isValid())
+    {
+        auto nodeId = model->getChildNodeId (pos.parent->id, pos.index);
+        auto x = (pos.getDepth() + 1) * indentSize;
+
+        if (e.x >= x)
+            model->nodeClicked (nodeId, e);
+        else if (e.x >= x - indentSize && model->mightHaveChildren (nodeId))
+            setNodeOpen (pos, row, ! pos.isOpen());
+    }
+}
+
+void VirtualTreeView::listBoxItemDoubleClicked (int row, const MouseEvent& e)
+{
+    auto pos = findRow (row);
+
+    if (model != nullptr && pos.isValid() && e.x >= (pos.getDepth() + 1) * indentSize)
+        model->nodeDoubleClicked (model->getChildNodeId (pos.parent->id, pos.index), e);
+}
+
+void VirtualTreeView::selectedRowsChanged (int row)
+{
+    if (model != nullptr)
+        model->selectedRowsChanged (row);
+}
+
+void VirtualTreeView::deleteKeyPressed (int row)
+{
+    if (model != nullptr)
+        model->deleteKeyPressed (row);
+}
+
+void VirtualTreeView::returnKeyPressed (int row)
+{
+    auto pos = findRow (row);
+
+    if (model != nullptr && pos.isValid() && model->mightHaveChildren (model->getChildNodeId (pos.parent->id, pos.index)))
+        setNodeOpen (pos, row, ! pos.isOpen());
+}
+
+String VirtualTreeView::getTooltipForRow (int row)
+{
+    auto pos = findRow (row);
+
+    if (model != nullptr && pos.isValid())
+        return model->getTooltipForNode (model->getChildNodeId (pos.parent->id, pos.index));
+
+    return {};
+}
+
+var VirtualTreeView::getDragSourceDescription (const SparseSet<int>& rows)
+{
+    return model != nullptr ? model->getDragSourceDescription (rows) : var();
+}
+
+bool VirtualTreeView::keyPressed (const KeyPress& key)
+{
+    auto row = getLastRowSelected();
+    auto pos = findRow (row);
+
+    if (model != nullptr && pos.isValid())
+    {
+        if (key == KeyPress::leftKey)
+        {
+            if (pos.isOpen())
+                setNodeOpen (pos, row, false);
+            else if (pos.parent->parent != nullptr)
+                selectRow (getParentRow (row));
+
+            return true;
+        }
+
+        if (key == KeyPress::rightKey)
+        {
+            if (pos.isOpen())
+                selectRow (row + 1);
+            else if (model->mightHaveChildren (model->getChildNodeId (pos.parent->id, pos.index)))
+                setNodeOpen (pos, row, true);
+
+            return true;
+        }
+    }
+
+    return ListBox::keyPressed (key);
+}
+
+//==============================================================================
+int64 TreeViewModel::getRootNodeId()                                    { return 0; }
+bool TreeViewModel::mightHaveChildren (int64 nodeId)                    { return getNumChildren (nodeId) > 0; }
+void TreeViewModel::nodeClicked (int64, const MouseEvent&)              {}
+void TreeViewModel::nodeDoubleClicked (int64, const MouseEvent&)        {}
+void TreeViewModel::nodeOpennessChanged (int64, bool)                   {}
+void TreeViewModel::selectedRowsChanged (int)                           {}
+void TreeViewModel::deleteKeyPressed (int)                              {}
+
+String TreeViewModel::getTooltipForNode (int64)                         { return {}; }
+var TreeViewModel::getDragSourceDescription (const SparseSet<int>&)     { return {}; }
+
+int TreeViewModel::getIndexOfChild (int64 parentNodeId, int64 childNodeId)
+{
+    auto numChildren = getNumChildren (parentNodeId);
+
+    for (int i = 0; i < numChildren; ++i)
+        if (getChildNodeId (parentNodeId, i) == childNodeId)
+            return i;
+
+    return -1;
+}
+
+Component* TreeViewModel::refreshComponentForNode (int64, bool, Component* existingComponentToUpdate)
+{
+    ignoreUnused (existingComponentToUpdate);
+    jassert (existingComponentToUpdate == nullptr); // indicates a failure in the code that recycles the components
+    return nullptr;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class VirtualTreeViewTests  : public UnitTest
+{
+public:
+    VirtualTreeViewTests()  : UnitTest ("VirtualTreeView", "GUI") {}
+
+    void runTest() override
+    {
+        // The tree is a ListBox, and making its contents visible needs the Desktop, which
+        // can't be created without a display.
+        if (! canShowComponents())
+            return;
+
+        ScopedJuceInitialiser_GUI libraryInitialiser;
+
+        beginTest ("Rows of a closed tree");
+        {
+            const MessageManagerLock mmLock;
+            TestModel model;
+            VirtualTreeView tree ({}, &model);
+
+            expectEquals (tree.getNumRows(), 5);
+            checkRows (tree, model);
+            expect (tree.getNodeIdForRow (5) == 0 && tree.getDepthOfRow (5) == -1);
+        }
+
+        beginTest ("Opening and closing nodes");
+        {
+            const MessageManagerLock mmLock;
+            TestModel model;
+            VirtualTreeView tree ({}, &model);
+
+            openRow (tree, model, 1);
+            expectEquals (tree.getNumRows(), 8);
+            expect (tree.getNodeIdForRow (2) == 21 && tree.getParentRow (2) == 1);
+
+            openRow (tree, model, 3);
+            expect (tree.getNodeIdForRow (4) == 221 && tree.getDepthOfRow (4) == 2);
+            expect (tree.getIndexPathForRow (4) == Array<int> (1, 1, 0));
+
+            // closing a node hides the nodes inside it, but they're still open when it re-opens
+            closeRow (tree, model, 1);
+            expectEquals (tree.getNumRows(), 5);
+            expect (model.openNodes.contains (22));
+
+            openRow (tree, model, 1);
+            expectEquals (tree.getNumRows(), 11);
+            expect (tree.isRowOpen (3));
+        }
+
+        beginTest ("Index paths");
+        {
+            const MessageManagerLock mmLock;
+            TestModel model;
+            VirtualTreeView tree ({}, &model);
+
+            expectEquals (tree.getRowForIndexPath ({ 4, 2, 1 }, false), -1);
+
+            auto row = tree.getRowForIndexPath ({ 4, 2, 1 }, true);
+            expect (tree.getNodeIdForRow (row) == 532);
+            expect (model.openNodes.contains (5) && model.openNodes.contains (53));
+            checkRows (tree, model);
+        }
+
+        beginTest ("Random opening and closing");
+        {
+            const MessageManagerLock mmLock;
+            TestModel model;
+            VirtualTreeView tree ({}, &model);
+
+            auto random = getRandom();
+
+            for (int i = 0; i < 200; ++i)
+            {
+                auto row = random.nextInt (tree.getNumRows());
+                auto nodeId = tree.getNodeIdForRow (row);
+
+                if (model.getNumChildren (nodeId) == 0)
+                    continue;
+
+                if (tree.isRowOpen (row))
+                    closeRow (tree, model, row);
+                else
+                    openRow (tree, model, row);
+            }
+        }
+
+        beginTest ("Closing all nodes");
+        {
+            const MessageManagerLock mmLock;
+            TestModel model;
+            VirtualTreeView tree ({}, &model);
+
+            tree.getRowForIndexPath ({ 0, 0, 0 }, true);
+            tree.setRowOpen (0, false);
+            expect (! model.openNodes.isEmpty());
+
+            tree.closeAllNodes();
+            expect (model.openNodes.isEmpty());
+            expectEquals (tree.getNumRows(), 5);
+            checkRows (tree, model);
+        }
+    }
+
+private:
+    //==============================================================================
+    static bool canShowComponents()
+    {
+       #if JUCE_LINUX
+        return SystemStats::getEnvironmentVariable ("DISPLAY", {}).isNotEmpty();
+       #else
+        return true;
+       #endif
+    }
+
+    //==============================================================================
+    // Node IDs are made from the child indexes that lead to them, so that node 21 is the
+    // first child of the second top-level node, etc.
+    struct TestModel  : public TreeViewModel
+    {
+        int getNumChildren (int64 parentNodeId) override
+        {
+            return parentNodeId == 0 ? 5 : (parentNodeId < 100 ? 3 : 0);
+        }
+
+        int64 getChildNodeId (int64 parentNodeId, int childIndex) override
+        {
+            return parentNodeId * 10 + childIndex + 1;
+        }
+
+        void paintNode (int64, Graphics&, int, int, bool) override {}
+
+        void nodeOpennessChanged (int64 nodeId, bool isNowOpen) override
+        {
+            if (isNowOpen)
+                openNodes.add (nodeId);
+            else
+                openNodes.removeValue (nodeId);
+        }
+
+        SortedSet<int64> openNodes;
+    };
+
+    void openRow (VirtualTreeView& tree, TestModel& model, int row)
+    {
+        tree.setRowOpen (row, true);
+        expect (tree.isRowOpen (row));
+        expect (model.openNodes.contains (tree.getNodeIdForRow (row)));
+        checkRows (tree, model);
+    }
+
+    void closeRow (VirtualTreeView& tree, TestModel& model, int row)
+    {
+        tree.setRowOpen (row, false);
+        expect (! tree.isRowOpen (row));
+        expect (! model.openNodes.contains (tree.getNodeIdForRow (row)));
+        checkRows (tree, model);
+    }
+
+    // Compares the tree's rows with a list of the nodes that the model has been told are
+    // open, and checks that each row can be found again from its index path.
+    void checkRows (VirtualTreeView& tree, TestModel& model)
+    {
+        struct Row
+        {
+            int64 nodeId;
+            int depth, parentRow;
+            Array<int> indexPath;
+        };
+
+        Array<Row> expected;
+
+        std::function<void (int64, int, int, Array<int>)> addRows = [&] (int64 parentId, int depth, int parentRow, Array<int> path)
+        {
+            for (int i = 0; i < model.getNumChildren (parentId); ++i)
+            {
+                auto nodeId = model.getChildNodeId (parentId, i);
+                auto indexPath = path;
+                indexPath.add (i);
+
+                expected.add ({ nodeId, depth, parentRow, indexPath });
+
+                if (model.openNodes.contains (nodeId))
+                    addRows (nodeId, depth + 1, expected.size() - 1, indexPath);
+            }
+        };
+
+        addRows (0, 0, -1, {});
+
+        expectEquals (tree.getNumRows(), expected.size());
+
+        for (int row = 0; row < expected.size(); ++row)
+        {
+            auto& r = expected.getReference (row);
+
+            expect (tree.getNodeIdForRow (row) == r.nodeId);
+            expectEquals (tree.getDepthOfRow (row), r.depth);
+            expectEquals (tree.getParentRow (row), r.parentRow);
+            expect (tree.getIndexPathForRow (row) == r.indexPath);
+            expectEquals (tree.getRowForIndexPath (r.indexPath, false), row);
+            expect (tree.isRowOpen (row) == model.openNodes.contains (r.nodeId));
+        }
+    }
+};
+
+static VirtualTreeViewTests virtualTreeViewTests;
+
+#endif
+
+} // namespace juce
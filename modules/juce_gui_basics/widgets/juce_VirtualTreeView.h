@@ -0,0 +1,297 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    One of these is used by a VirtualTreeView as the data model for the tree's contents.
+
+    Each node in the tree is identified by an ID number that the model chooses. The
+    tree only asks for the nodes that it needs to show, so the model doesn't need to
+    create any objects for the nodes that are out of sight or inside closed parents.
+
+    @see VirtualTreeView
+
+    @tags{GUI}
+*/
+class JUCE_API  TreeViewModel
+{
+public:
+    //==============================================================================
+    TreeViewModel() = default;
+
+    /** Destructor. */
+    virtual ~TreeViewModel() = default;
+
+    //==============================================================================
+    /** Returns the ID of the tree's root node.
+
+        The root node itself isn't shown - its children are the top-level rows of the tree.
+    */
+    virtual int64 getRootNodeId();
+
+    /** This must return the number of children that a node has.
+
+        This is only called when the node is opened, or when VirtualTreeView::refreshTree()
+        is called, so it doesn't matter if it takes a little while to work out.
+    */
+    virtual int getNumChildren (int64 parentNodeId) = 0;
+
+    /** This must return the ID of one of a node's children. */
+    virtual int64 getChildNodeId (int64 parentNodeId, int childIndex) = 0;
+
+    /** Returns the index of a child within its parent, or -1 if it's no longer there.
+
+        This is used by VirtualTreeView::refreshTree() to find the nodes that were open
+        before the tree changed. The default implementation searches through all the
+        parent's children, so if your nodes have a lot of children, you should override
+        it to do something quicker.
+    */
+    virtual int getIndexOfChild (int64 parentNodeId, int64 childNodeId);
+
+    /** Tells the tree whether a node should be given an open/close button.
+
+        The default implementation calls getNumChildren(), so if that's slow for a node
+        that hasn't been opened yet, you may want to override this with something cheaper.
+    */
+    virtual bool mightHaveChildren (int64 nodeId);
+
+    //==============================================================================
+    /** This must draw the contents of one of the tree's rows.
+
+        The graphics context's origin will already be set to the left-hand edge of the
+        node, just to the right of its open/close button, and your method should fill
+        the area specified by the width and height parameters.
+    */
+    virtual void paintNode (int64 nodeId, Graphics&, int width, int height, bool isSelected) = 0;
+
+    /** This is used to create or update a custom component to go in a row of the tree.
+
+        This works in the same way as ListBoxModel::refreshComponentForRow(). The component
+        will be placed to the right of the node's open/close button.
+    */
+    virtual Component* refreshComponentForNode (int64 nodeId, bool isSelected,
+                                                Component* existingComponentToUpdate);
+
+    //==============================================================================
+    /** This callback is made when the user clicks on a node, but not on its open/close button.
+
+        The mouse event's coordinates will be relative to the entire row.
+        @see nodeDoubleClicked
+    */
+    virtual void nodeClicked (int64 nodeId, const MouseEvent&);
+
+    /** This callback is made when the user double-clicks on a node.
+
+        The mouse event's coordinates will be relative to the entire row.
+        @see nodeClicked
+    */
+    virtual void nodeDoubleClicked (int64 nodeId, const MouseEvent&);
+
+    /** Called when a node is opened or closed.
+
+        When a node is closed, this isn't called for any open nodes inside it, because
+        they'll still be open when it's re-opened.
+    */
+    virtual void nodeOpennessChanged (int64 nodeId, bool isNowOpen);
+
+    /** Returns a tooltip for a node. */
+    virtual String getTooltipForNode (int64 nodeId);
+
+    //==============================================================================
+    /** Override this to be informed when rows are selected or deselected.
+
+        Rows are renumbered whenever a node above them is opened or closed, so if you
+        need to keep track of the selection, use VirtualTreeView::getNodeIdForRow() to
+        find out which nodes the rows refer to.
+
+        @see ListBoxModel::selectedRowsChanged()
+    */
+    virtual void selectedRowsChanged (int lastRowSelected);
+
+    /** Override this to be informed when the delete key is pressed.
+        @see ListBoxModel::deleteKeyPressed()
+    */
+    virtual void deleteKeyPressed (int lastRowSelected);
+
+    /** To allow rows from your tree to be dragged-and-dropped, implement this method.
+        @see ListBoxModel::getDragSourceDescription
+    */
+    virtual var getDragSourceDescription (const SparseSet<int>& currentlySelectedRows);
+};
+
+
+//==============================================================================
+/**
+    A tree view which gets its contents from a TreeViewModel, and which only
+    creates components for the rows that are on-screen.
+
+    Unlike a TreeView, which needs a TreeViewItem object for every node, this only keeps
+    track of the nodes that have been opened, and of the number of rows that each of
+    their children takes up.
+    The rows of each open node are kept in a binary indexed tree, so finding the node
+    on a given row, or the row of a given node, takes time proportional to the depth of
+    the tree and the logarithm of the number of rows, which makes it practical to browse
+    hierarchies containing millions of nodes.
+
+    All the rows are the same height, and the tree's selection is managed by the
+    ListBox base class.
+
+    @see TreeViewModel, TreeView, ListBox
+
+    @tags{GUI}
+*/
+class JUCE_API  VirtualTreeView   : public ListBox,
+                                    private ListBoxModel
+{
+public:
+    //==============================================================================
+    /** Creates a VirtualTreeView.
+
+        The model pointer passed-in can be null, in which case you can set it later
+        with setModel(). The VirtualTreeView does not take ownership of the model - it's
+        the caller's responsibility to manage its lifetime and make sure it
+        doesn't get deleted while still being used.
+    */
+    VirtualTreeView (const String& componentName = String(),
+                     TreeViewModel* model = nullptr);
+
+    /** Destructor. */
+    ~VirtualTreeView() override;
+
+    //==============================================================================
+    /** Changes the TreeViewModel that is being used for this tree.
+        All the nodes are closed when the model is changed.
+    */
+    void setModel (TreeViewModel* newModel);
+
+    /** Returns the model currently in use. */
+    TreeViewModel* getModel() const noexcept                        { return model; }
+
+    /** Re-reads the structure of the tree from the model.
+
+        Call this when nodes have been added or removed. Nodes that were open will stay
+        open if the model can still find them with TreeViewModel::getIndexOfChild(), and
+        the row that was last selected stays selected if its node still exists - the rest
+        of the selection is cleared.
+    */
+    void refreshTree();
+
+    //==============================================================================
+    /** Returns the ID of the node shown on a row, or the root's ID if the row is out of range. */
+    int64 getNodeIdForRow (int row) const;
+
+    /** Returns the number of parents that the node on a row has, not counting the root
+        (so the top-level nodes have a depth of 0), or -1 if the row is out of range.
+    */
+    int getDepthOfRow (int row) const;
+
+    /** Returns the row of the parent of the node on a given row, or -1 if it's a top-level node. */
+    int getParentRow (int row) const;
+
+    /** Returns the list of child indexes that lead from the root to the node on a given row. */
+    Array<int> getIndexPathForRow (int row) const;
+
+    /** Returns the row of the node at the end of a list of child indexes.
+
+        If the node is inside a parent that's closed, this will either open its parents
+        (if openParentsIfNeeded is true), or return -1.
+    */
+    int getRowForIndexPath (const Array<int>& childIndexes, bool openParentsIfNeeded);
+
+    //==============================================================================
+    /** Opens or closes the node on a given row.
+
+        When a node is closed, any nodes inside it that were open will be open again when
+        it's re-opened.
+    */
+    void setRowOpen (int row, bool shouldBeOpen);
+
+    /** Returns true if the node on a given row is open. */
+    bool isRowOpen (int row) const;
+
+    /** Closes all the nodes in the tree.
+
+        TreeViewModel::nodeOpennessChanged() is called for each of the nodes that was
+        open, including any that were inside a closed parent.
+    */
+    void closeAllNodes();
+
+    //==============================================================================
+    /** Changes the distance by which each level of the tree is indented.
+        The default is 24 pixels.
+    */
+    void setIndentSize (int newIndentSize);
+
+    /** Returns the distance by which each level of the tree is indented. */
+    int getIndentSize() const noexcept                              { return indentSize; }
+
+    //==============================================================================
+    /** @internal */
+    int getNumRows() override;
+    /** @internal */
+    void paintListBoxItem (int, Graphics&, int, int, bool) override;
+    /** @internal */
+    Component* refreshComponentForRow (int rowNumber, bool isRowSelected, Component* existingComponentToUpdate) override;
+    /** @internal */
+    void listBoxItemClicked (int row, const MouseEvent&) override;
+    /** @internal */
+    void listBoxItemDoubleClicked (int row, const MouseEvent&) override;
+    /** @internal */
+    void selectedRowsChanged (int row) override;
+    /** @internal */
+    void deleteKeyPressed (int currentSelectedRow) override;
+    /** @internal */
+    void returnKeyPressed (int currentSelectedRow) override;
+    /** @internal */
+    String getTooltipForRow (int row) override;
+    /** @internal */
+    var getDragSourceDescription (const SparseSet<int>&) override;
+    /** @internal */
+    bool keyPressed (const KeyPress&) override;
+
+private:
+    //==============================================================================
+    struct OpenNode;
+    struct RowPosition;
+    class RowComp;
+
+    TreeViewModel* model;
+    std::unique_ptr<OpenNode> root;
+    int indentSize = 24;
+
+    RowPosition findRow (int row) const;
+    int getRowOf (const OpenNode&, int childIndex) const;
+    void setNodeOpen (const RowPosition&, int row, bool shouldBeOpen);
+    void rowsInsertedOrRemoved (int firstRow, int numRows);
+    void resetRoot();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VirtualTreeView)
+};
+
+} // namespace juce
@@ -101,8 +101,16 @@ void ComponentPeer::handleMagnifyGesture (MouseInputSource::InputSourceType type
 }
 
 //==============================================================================
+ComponentPeer::PaintStatistics* ComponentPeer::currentPaintStatistics = nullptr;
+
 void ComponentPeer::handlePaint (LowLevelGraphicsContext& contextToPaintTo)
 {
+    auto startTime = Time::getMillisecondCounterHiRes();
+
+    PaintStatistics statistics;
+    auto* previousStatistics = currentPaintStatistics;
+    currentPaintStatistics = &statistics;
+
     Graphics g (contextToPaintTo);
 
     if (component.isTransformed())
@@ -128,12 +136,19 @@ void ComponentPeer::handlePaint (LowLevelGraphicsContext& contextToPaintTo)
     }
   #endif
 
+    statistics.numPixelsPainted = (int64) g.getClipBounds().getWidth() * g.getClipBounds().getHeight();
+
     JUCE_TRY
     {
         component.paintEntireComponent (g, true);
     }
     JUCE_CATCH_EXCEPTION
 
+    currentPaintStatistics = previousStatistics;
+    statistics.layerCacheSize = Component::getLayerCacheSize();
+    statistics.paintTimeMs = Time::getMillisecondCounterHiRes() - startTime;
+    lastPaintStatistics = statistics;
+
   #if JUCE_ENABLE_REPAINT_DEBUGGING
    #ifdef JUCE_IS_REPAINT_DEBUGGING_ACTIVE
     if (JUCE_IS_REPAINT_DEBUGGING_ACTIVE)
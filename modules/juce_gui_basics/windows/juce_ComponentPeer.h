@@ -235,6 +235,22 @@ public:
     /** This is called to repaint the component into the given context. */
     void handlePaint (LowLevelGraphicsContext& contextToPaintTo);
 
+    /** Some measurements of the work that was done to paint a frame.
+        @see getLastPaintStatistics, Component::setLayerCachingEnabled
+    */
+    struct PaintStatistics
+    {
+        int numComponentsPainted = 0;   /**< The number of calls that were made to Component::paint(). */
+        int numLayersReused = 0;        /**< The number of components that were drawn from their layer without calling paint(). */
+        int numLayersUpdated = 0;       /**< The number of components whose layer had to be painted before it was drawn. */
+        int64 numPixelsPainted = 0;     /**< The area of the bounding box of the region that was painted. */
+        int64 layerCacheSize = 0;       /**< The number of bytes used by all the layers at the end of the frame. */
+        double paintTimeMs = 0;         /**< The time that handlePaint() took. */
+    };
+
+    /** Returns the statistics for the last time that handlePaint() was called. */
+    const PaintStatistics& getLastPaintStatistics() const noexcept      { return lastPaintStatistics; }
+
     //==============================================================================
     /** Sets this window to either be always-on-top or normal.
         Some kinds of window might not be able to do this, so should return false.
@@ -422,8 +438,12 @@ private:
     Component* lastDragAndDropCompUnderMouse = nullptr;
     const uint32 uniqueID;
     bool isWindowMinimised = false;
+    PaintStatistics lastPaintStatistics;
     Component* getTargetForKeyPress();
 
+    friend class Component;
+    static PaintStatistics* currentPaintStatistics;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ComponentPeer)
 };
 
@@ -35,6 +35,10 @@
 
 #include "juce_osc.h"
 
+#if JUCE_LINUX
+ #include <sys/socket.h>
+#endif
+
 #include "osc/juce_OSCTypes.cpp"
 #include "osc/juce_OSCTimeTag.cpp"
 #include "osc/juce_OSCArgument.cpp"
@@ -382,11 +382,13 @@ struct OSCReceiver::Pimpl   : private Thread,
                       OSCAddress addressToMatch)
     {
         addListenerWithAddress (listenerToAdd, addressToMatch, listenersWithAddress);
+        addressTrie.rebuild (listenersWithAddress);
     }
 
     void addListener (ListenerWithOSCAddress<RealtimeCallback>* listenerToAdd, OSCAddress addressToMatch)
     {
         addListenerWithAddress (listenerToAdd, addressToMatch, realtimeListenersWithAddress);
+        realtimeAddressTrie.rebuild (realtimeListenersWithAddress);
     }
 
     void removeListener (OSCReceiver::Listener<MessageLoopCallback>* listenerToRemove)
@@ -402,21 +404,19 @@ struct OSCReceiver::Pimpl   : private Thread,
     void removeListener (ListenerWithOSCAddress<MessageLoopCallback>* listenerToRemove)
     {
         removeListenerWithAddress (listenerToRemove, listenersWithAddress);
+        addressTrie.rebuild (listenersWithAddress);
     }
 
     void removeListener (ListenerWithOSCAddress<RealtimeCallback>* listenerToRemove)
     {
         removeListenerWithAddress (listenerToRemove, realtimeListenersWithAddress);
+        realtimeAddressTrie.rebuild (realtimeListenersWithAddress);
     }
 
     //==============================================================================
-    struct CallbackMessage   : public Message
-    {
-        CallbackMessage (OSCBundle::Element oscElement)  : content (oscElement) {}
-
-        // the payload of the message. Can be either an OSCMessage or an OSCBundle.
-        OSCBundle::Element content;
-    };
+    // Posted to the message thread when the queue of received content goes from empty
+    // to non-empty, so that a burst of packets only needs one message to be delivered.
+    struct CallbackMessage   : public Message {};
 
     //==============================================================================
     void handleBuffer (const char* data, size_t dataSize)
@@ -434,10 +434,10 @@ struct OSCReceiver::Pimpl   : private Thread,
             if (content.isMessage())
                 callRealtimeListenersWithAddress (content.getMessage());
 
-            // now post the message that will trigger the handleMessage callback
-            // dealing with the non-realtime listeners.
+            // now queue the content for the non-realtime listeners, which will be called
+            // from the handleMessage callback.
             if (listeners.size() > 0 || listenersWithAddress.size() > 0)
-                postMessage (new CallbackMessage (content));
+                queueForMessageThread (content);
         }
         catch (const OSCFormatError&)
         {
@@ -456,8 +456,26 @@ private:
     //==============================================================================
     void run() override
     {
-        int bufferSize = 65535;
+        const int bufferSize = 65535;
+
+       #if JUCE_LINUX
+        // On Linux, all the datagrams that have queued up are fetched with a single
+        // recvmmsg() call rather than waking up and reading them one at a time.
+        const int maxPacketsPerRead = 16;
+        HeapBlock<char> oscBuffer (bufferSize * maxPacketsPerRead);
+        HeapBlock<iovec> ioVectors (maxPacketsPerRead, true);
+        HeapBlock<mmsghdr> messageHeaders (maxPacketsPerRead, true);
+
+        for (int i = 0; i < maxPacketsPerRead; ++i)
+        {
+            ioVectors[i].iov_base = oscBuffer + i * bufferSize;
+            ioVectors[i].iov_len = (size_t) bufferSize;
+            messageHeaders[i].msg_hdr.msg_iov = ioVectors + i;
+            messageHeaders[i].msg_hdr.msg_iovlen = 1;
+        }
+       #else
         HeapBlock<char> oscBuffer (bufferSize);
+       #endif
 
         while (! threadShouldExit())
         {
@@ -470,6 +488,20 @@ private:
             if (ready == 0)
                 continue;
 
+           #if JUCE_LINUX
+            auto numPackets = recvmmsg (socket->getRawSocketHandle(), messageHeaders,
+                                        (unsigned int) maxPacketsPerRead, MSG_DONTWAIT, nullptr);
+
+            if (numPackets > 0)
+            {
+                for (int i = 0; i < numPackets; ++i)
+                    if (messageHeaders[i].msg_len >= 4)
+                        handleBuffer (oscBuffer + i * bufferSize, (size_t) messageHeaders[i].msg_len);
+
+                continue;
+            }
+           #endif
+
             auto bytesRead = (size_t) socket->read (oscBuffer.getData(), bufferSize, false);
 
             if (bytesRead >= 4)
@@ -477,6 +509,186 @@ private:
         }
     }
 
+    //==============================================================================
+    void queueForMessageThread (const OSCBundle::Element& content)
+    {
+        bool needsCallbackMessage;
+
+        {
+            const ScopedLock sl (pendingContentLock);
+            needsCallbackMessage = pendingContent.isEmpty();
+            pendingContent.add (content);
+        }
+
+        if (needsCallbackMessage)
+            postMessage (new CallbackMessage());
+    }
+
+    //==============================================================================
+    /*  The address listeners, arranged as a tree of the parts of their addresses. A part
+        of an incoming address pattern that has no wildcards is looked up directly among the
+        names at its level of the tree, and a part that does is only matched against those
+        names, rather than every listener's whole address being matched against the pattern.
+
+        The tree is rebuilt by whichever thread adds or removes listeners, and is only read
+        by the thread that delivers messages to them, so finding the listeners for a message
+        doesn't allocate anything.
+    */
+    template <typename ListenerType>
+    class AddressTrie
+    {
+    public:
+        void rebuild (const Array<std::pair<OSCAddress, ListenerType*>>& listenersWithAddress)
+        {
+            std::unique_ptr<Node> newRoot (new Node());
+
+            for (auto& entry : listenersWithAddress)
+            {
+                auto* node = newRoot.get();
+
+                for (auto& part : StringArray::fromTokens (entry.first.toString(), "/", {}))
+                    if (part.isNotEmpty())
+                        node = &node->getOrAddChild (part);
+
+                node->listeners.add (entry.second);
+            }
+
+            {
+                const SpinLock::ScopedLockType sl (lock);
+                std::swap (root, newRoot);
+            }
+
+            numListeners = listenersWithAddress.size();
+        }
+
+        void callMatchingListeners (const OSCMessage& message)
+        {
+            // (this only allocates when listeners have been added since the last message)
+            matches.clearQuick();
+            matches.ensureStorageAllocated (numListeners);
+
+            {
+                auto pattern = message.getAddressPattern().toString();
+                auto start = pattern.getCharPointer();
+
+                const SpinLock::ScopedLockType sl (lock);
+
+                if (root != nullptr)
+                    addMatches (*root, start, start.findTerminatingNull());
+            }
+
+            for (auto* listener : matches)
+                listener->oscMessageReceived (message);
+        }
+
+    private:
+        using CharPtr = String::CharPointerType;
+
+        static int compare (CharPtr start, CharPtr end, const String& name) noexcept
+        {
+            auto other = name.getCharPointer();
+
+            while (start != end)
+            {
+                auto c1 = start.getAndAdvance();
+                auto c2 = other.getAndAdvance();
+
+                if (c1 != c2)
+                    return c1 < c2 ? -1 : 1;
+            }
+
+            return other.isEmpty() ? 0 : -1;
+        }
+
+        struct Node
+        {
+            // (the children are sorted by name)
+            int findIndex (CharPtr start, CharPtr end) const noexcept
+            {
+                int low = 0, high = children.size();
+
+                while (low < high)
+                {
+                    auto mid = (low + high) / 2;
+
+                    if (compare (start, end, children.getUnchecked (mid)->name) > 0)
+                        low = mid + 1;
+                    else
+                        high = mid;
+                }
+
+                return low;
+            }
+
+            const Node* findChild (CharPtr start, CharPtr end) const noexcept
+            {
+                if (auto* child = children[findIndex (start, end)])
+                    if (compare (start, end, child->name) == 0)
+                        return child;
+
+                return nullptr;
+            }
+
+            Node& getOrAddChild (const String& childName)
+            {
+                auto start = childName.getCharPointer();
+                auto end = start.findTerminatingNull();
+                auto index = findIndex (start, end);
+
+                if (auto* child = children[index])
+                    if (compare (start, end, child->name) == 0)
+                        return *child;
+
+                auto* child = children.insert (index, new Node());
+                child->name = childName;
+                return *child;
+            }
+
+            String name;
+            OwnedArray<Node> children;
+            Array<ListenerType*> listeners;
+        };
+
+        void addMatches (const Node& node, CharPtr partStart, CharPtr end)
+        {
+            while (partStart != end && *partStart == '/')
+                ++partStart;
+
+            if (partStart == end)
+            {
+                matches.addArray (node.listeners);
+                return;
+            }
+
+            auto partEnd = partStart;
+            bool hasWildcards = false;
+
+            for (; partEnd != end && *partEnd != '/'; ++partEnd)
+            {
+                auto c = *partEnd;
+                hasWildcards = hasWildcards || c == '*' || c == '?' || c == '[' || c == '{';
+            }
+
+            if (! hasWildcards)
+            {
+                if (auto* child = node.findChild (partStart, partEnd))
+                    addMatches (*child, partEnd, end);
+
+                return;
+            }
+
+            for (auto* child : node.children)
+                if (OSCPatternMatcherImpl<CharPtr>::match (partStart, partEnd, child->name.getCharPointer(),
+                                                           child->name.getCharPointer().findTerminatingNull()))
+                    addMatches (*child, partEnd, end);
+        }
+
+        std::unique_ptr<Node> root;
+        SpinLock lock;
+        std::atomic<int> numListeners { 0 };
+        Array<ListenerType*> matches;
+    };
+
     //==============================================================================
     template <typename ListenerType>
     void addListenerWithAddress (ListenerType* listenerToAdd,
@@ -512,14 +724,22 @@ private:
     //==============================================================================
     void handleMessage (const Message& msg) override
     {
-        if (auto* callbackMessage = dynamic_cast<const CallbackMessage*> (&msg))
+        if (dynamic_cast<const CallbackMessage*> (&msg) != nullptr)
         {
-            auto& content = callbackMessage->content;
+            {
+                const ScopedLock sl (pendingContentLock);
+                pendingContent.swapWith (contentToDeliver);
+            }
 
-            callListeners (content);
+            for (auto& content : contentToDeliver)
+            {
+                callListeners (content);
 
-            if (content.isMessage())
-                callListenersWithAddress (content.getMessage());
+                if (content.isMessage())
+                    callListenersWithAddress (content.getMessage());
+            }
+
+            contentToDeliver.clearQuick();
         }
     }
 
@@ -559,18 +779,18 @@ private:
     //==============================================================================
     void callListenersWithAddress (const OSCMessage& message)
     {
-        for (auto& entry : listenersWithAddress)
-            if (auto* listener = entry.second)
-                if (message.getAddressPattern().matches (entry.first))
-                    listener->oscMessageReceived (message);
+        if (listenersWithAddress.isEmpty())
+            return;
+
+        addressTrie.callMatchingListeners (message);
     }
 
     void callRealtimeListenersWithAddress (const OSCMessage& message)
     {
-        for (auto& entry : realtimeListenersWithAddress)
-            if (auto* listener = entry.second)
-                if (message.getAddressPattern().matches (entry.first))
-                    listener->oscMessageReceived (message);
+        if (realtimeListenersWithAddress.isEmpty())
+            return;
+
+        realtimeAddressTrie.callMatchingListeners (message);
     }
 
     //==============================================================================
@@ -580,6 +800,12 @@ private:
     Array<std::pair<OSCAddress, OSCReceiver::ListenerWithOSCAddress<OSCReceiver::MessageLoopCallback>*>> listenersWithAddress;
     Array<std::pair<OSCAddress, OSCReceiver::ListenerWithOSCAddress<OSCReceiver::RealtimeCallback>*>>    realtimeListenersWithAddress;
 
+    AddressTrie<OSCReceiver::ListenerWithOSCAddress<OSCReceiver::MessageLoopCallback>> addressTrie;
+    AddressTrie<OSCReceiver::ListenerWithOSCAddress<OSCReceiver::RealtimeCallback>>    realtimeAddressTrie;
+
+    CriticalSection pendingContentLock;
+    Array<OSCBundle::Element> pendingContent, contentToDeliver;
+
     OptionalScopedPointer<DatagramSocket> socket;
     OSCReceiver::FormatErrorHandler formatErrorHandler { nullptr };
 
@@ -1188,6 +1414,156 @@ public:
 
 static OSCInputStreamTests OSCInputStreamUnitTests;
 
+//==============================================================================
+class OSCReceiverTests  : public UnitTest
+{
+public:
+    OSCReceiverTests() : UnitTest ("OSCReceiver class", "OSC") {}
+
+    struct CountingListener  : public OSCReceiver::ListenerWithOSCAddress<OSCReceiver::RealtimeCallback>
+    {
+        void oscMessageReceived (const OSCMessage&) override   { ++numMessages; }
+
+        std::atomic<int> numMessages { 0 };
+    };
+
+    struct RealtimeCounter  : public OSCReceiver::Listener<OSCReceiver::RealtimeCallback>
+    {
+        void oscMessageReceived (const OSCMessage&) override   { ++numMessages; }
+
+        std::atomic<int> numMessages { 0 };
+    };
+
+    // Keeps the integer argument of each message it gets on the message thread
+    template <typename ListenerType>
+    struct RecordingListener  : public ListenerType
+    {
+        void oscMessageReceived (const OSCMessage& message) override
+        {
+            jassert (MessageManager::getInstance()->isThisTheMessageThread());
+            values.add (message[0].getInt32());
+        }
+
+        Array<int> values;
+    };
+
+    void runTest() override
+    {
+        beginTest ("realtime address listeners");
+        {
+            ScopedJuceInitialiser_GUI libraryInitialiser;
+            OSCReceiver receiver;
+            CountingListener fader1, fader2, knob;
+
+            receiver.addListener (&fader1, "/mixer/fader1");
+            receiver.addListener (&fader2, "/mixer/fader2");
+            receiver.addListener (&knob,   "/mixer/knob");
+
+            auto port = connectToRandomPort (receiver);
+            expect (port != 0);
+
+            OSCSender sender;
+            expect (sender.connect ("127.0.0.1", port));
+
+            for (int i = 0; i < 10; ++i)
+            {
+                sender.send ("/mixer/fader1", (float) i);
+                sender.send ("/mixer/fader*", (float) i);
+            }
+
+            for (int i = 0; i < 5; ++i)
+                sender.send ("/mixer/knob", i);
+
+            sender.send ("/mixer/unknown", 1);
+
+            for (int i = 0; i < 500 && fader1.numMessages + fader2.numMessages + knob.numMessages < 35; ++i)
+                Thread::sleep (10);
+
+            expectEquals (fader1.numMessages.load(), 20);
+            expectEquals (fader2.numMessages.load(), 10);
+            expectEquals (knob.numMessages.load(), 5);
+
+            receiver.removeListener (&fader1);
+            sender.send ("/mixer/fader*", 0.0f);
+
+            for (int i = 0; i < 500 && fader2.numMessages < 11; ++i)
+                Thread::sleep (10);
+
+            expectEquals (fader1.numMessages.load(), 20);
+            expectEquals (fader2.numMessages.load(), 11);
+        }
+
+       #if JUCE_MODAL_LOOPS_PERMITTED
+        beginTest ("message thread listeners get a whole burst of messages, in order");
+        {
+            ScopedJuceInitialiser_GUI libraryInitialiser;
+            OSCReceiver receiver;
+            RealtimeCounter realtimeCounter;
+            RecordingListener<OSCReceiver::Listener<OSCReceiver::MessageLoopCallback>> allMessages;
+            RecordingListener<OSCReceiver::ListenerWithOSCAddress<OSCReceiver::MessageLoopCallback>> fader, knob, unused;
+
+            receiver.addListener (&realtimeCounter);
+            receiver.addListener (&allMessages);
+            receiver.addListener (&fader, "/mixer/fader1");
+            receiver.addListener (&knob, "/mixer/knob");
+            receiver.addListener (&unused, "/mixer/fader2/extra");
+
+            auto port = connectToRandomPort (receiver);
+            expect (port != 0);
+
+            OSCSender sender;
+            expect (sender.connect ("127.0.0.1", port));
+
+            const int numMessages = 200;
+
+            for (int i = 0; i < numMessages; ++i)
+                sender.send ((i & 1) == 0 ? "/mixer/fader1" : "/mixer/{knob,fader9}", i);
+
+            // Everything arrives on the receiving thread before this thread gets round to
+            // dispatching any messages, so it should all be delivered together.
+            for (int i = 0; i < 500 && realtimeCounter.numMessages < numMessages; ++i)
+                Thread::sleep (10);
+
+            expectEquals (realtimeCounter.numMessages.load(), numMessages);
+            expect (allMessages.values.isEmpty());
+
+            for (int i = 0; i < 50 && allMessages.values.size() < numMessages; ++i)
+                MessageManager::getInstance()->runDispatchLoopUntil (10);
+
+            Array<int> expectedAll, expectedFader, expectedKnob;
+
+            for (int i = 0; i < numMessages; ++i)
+            {
+                expectedAll.add (i);
+                ((i & 1) == 0 ? expectedFader : expectedKnob).add (i);
+            }
+
+            expect (allMessages.values == expectedAll);
+            expect (fader.values == expectedFader);
+            expect (knob.values == expectedKnob);
+            expect (unused.values.isEmpty());
+        }
+       #endif
+    }
+
+    static int connectToRandomPort (OSCReceiver& receiver)
+    {
+        Random random;
+
+        for (int attempt = 0; attempt < 20; ++attempt)
+        {
+            auto candidatePort = 40000 + random.nextInt (20000);
+
+            if (receiver.connect (candidatePort))
+                return candidatePort;
+        }
+
+        return 0;
+    }
+};
+
+static OSCReceiverTests OSCReceiverUnitTests;
+
 #endif // JUCE_UNIT_TESTS
 
 } // namespace juce